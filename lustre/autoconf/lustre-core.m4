@@ -1532,6 +1532,37 @@ LB_LINUX_TRY_COMPILE([
 ])
 ])
 
+#
+# 2.6.23 inode_operations.fallocate
+# 2.6.38 moved to file_operations.fallocate
+#
+AC_DEFUN([LC_FILE_FALLOCATE],
+[AC_MSG_CHECKING([if file_operations has fallocate])
+LB_LINUX_TRY_COMPILE([
+	#include <linux/fs.h>
+],[
+	((struct file_operations *)0)->fallocate(NULL, 0, 0, 0);
+],[
+	AC_DEFINE(HAVE_FILE_FALLOCATE, 1,
+		[file_operations has fallocate])
+	AC_MSG_RESULT([yes])
+],[
+	AC_MSG_RESULT([no])
+	AC_MSG_CHECKING([if inode_operations has fallocate])
+	LB_LINUX_TRY_COMPILE([
+		#include <linux/fs.h>
+	],[
+		((struct inode_operations *)0)->fallocate(NULL, 0, 0, 0);
+	],[
+		AC_DEFINE(HAVE_INODE_FALLOCATE, 1,
+			[inode_operations has fallocate])
+		AC_MSG_RESULT([yes])
+	],[
+		AC_MSG_RESULT([no])
+	])
+])
+])
+
 #
 # 2.6.35 file_operations.fsync taken 2 arguments.
 # 3.0.0 file_operations.fsync takes 4 arguments.
@@ -1702,6 +1733,27 @@ LB_LINUX_TRY_COMPILE([
 ])
 ])
 
+#
+# 2.6.39 replace queue plugging with on-stack struct blk_plug
+#
+AC_DEFUN([LC_HAVE_BLK_PLUG],
+[AC_MSG_CHECKING([if kernel has struct blk_plug])
+LB_LINUX_TRY_COMPILE([
+        #include <linux/blkdev.h>
+],[
+        struct blk_plug plug;
+
+        blk_start_plug(&plug);
+        blk_finish_plug(&plug);
+],[
+        AC_DEFINE(HAVE_BLK_PLUG, 1,
+                  [kernel has struct blk_plug])
+        AC_MSG_RESULT([yes])
+],[
+        AC_MSG_RESULT([no])
+])
+])
+
 #
 # 2.6.39 replace get_sb with mount in struct file_system_type
 #
@@ -2346,9 +2398,11 @@ AC_DEFUN([LC_PROG_LINUX],
          LC_DCACHE_LOCK
          LC_D_COMPARE_7ARGS
          LC_D_DELETE_CONST
+         LC_FILE_FALLOCATE
 
          # 2.6.39
          LC_REQUEST_QUEUE_UNPLUG_FN
+         LC_HAVE_BLK_PLUG
 	 LC_HAVE_FSTYPE_MOUNT
 
 	 # 3.0
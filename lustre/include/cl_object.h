@@ -2338,6 +2338,12 @@ struct cl_io {
                         struct ost_lvb   sa_attr;
                         unsigned int     sa_valid;
                         struct obd_capa *sa_capa;
+			/** fallocate(): OST_FALLOC_* flags and the range
+			 * [sa_falloc_offset, sa_falloc_end) to allocate,
+			 * sa_falloc_end is 0 for other setattrs */
+			int              sa_falloc_mode;
+			loff_t           sa_falloc_offset;
+			loff_t           sa_falloc_end;
                 } ci_setattr;
                 struct cl_fault_io {
                         /** page index within file. */
@@ -3095,6 +3101,12 @@ static inline int cl_io_is_trunc(const struct cl_io *io)
                 (io->u.ci_setattr.sa_valid & ATTR_SIZE);
 }
 
+static inline int cl_io_is_fallocate(const struct cl_io *io)
+{
+	return io->ci_type == CIT_SETATTR &&
+	       io->u.ci_setattr.sa_falloc_end != 0;
+}
+
 struct cl_io *cl_io_top(struct cl_io *io);
 
 void cl_io_print(const struct lu_env *env, void *cookie,
@@ -112,6 +112,39 @@ struct dt_txn_commit_cb {
 	char		dcb_name[MAX_COMMIT_CB_STR_LEN];
 };
 
+/**
+ * Commit callback coalescing the transactions committed together, for the
+ * callers which only need the highest transno committed: dtct_func is run
+ * once per batch of committed transactions, with the highest transno of
+ * those registered through dt_trans_transno_add() in the batch and how many
+ * registrations it covers. The batches of several threads may report out of
+ * order, so dtct_func keeps the highest transno it was given itself.
+ *
+ * Owned by the caller, who has to keep it until dtct_func reported all the
+ * registrations, e.g. with a reference taken for each of them.
+ */
+struct dt_txn_commit_transno;
+typedef void (*dt_transno_cb_t)(struct dt_txn_commit_transno *dtct,
+				__u64 transno, int count);
+
+struct dt_txn_commit_transno {
+	spinlock_t		dtct_lock;
+	/* highest transno committed, not reported yet, under dtct_lock */
+	__u64			dtct_transno;
+	/* registrations committed, not reported yet, under dtct_lock */
+	int			dtct_count;
+	/* in the batch of the thread which reports it, if dtct_queued */
+	cfs_list_t		dtct_linkage;
+	unsigned int		dtct_queued:1;
+	dt_transno_cb_t		dtct_func;
+};
+
+void dt_txn_transno_init(struct dt_txn_commit_transno *dtct,
+			 dt_transno_cb_t func);
+void dt_txn_transno_commit(struct dt_txn_commit_transno *dtct, __u64 transno,
+			   int count, cfs_list_t *batch);
+void dt_txn_transno_run(cfs_list_t *batch);
+
 /**
  * Operations on dt device.
  */
@@ -141,6 +174,13 @@ struct dt_device_operations {
          */
         int   (*dt_trans_cb_add)(struct thandle *th,
                                  struct dt_txn_commit_cb *dcb);
+	/**
+	 * Add coalesced commit callback to the transaction, see
+	 * struct dt_txn_commit_transno.
+	 */
+	int   (*dt_trans_transno_add)(struct thandle *th,
+				      struct dt_txn_commit_transno *dtct,
+				      __u64 transno);
         /**
          * Return fid of root index object.
          */
@@ -532,6 +572,21 @@ struct dt_body_operations {
         int   (*dbo_punch)(const struct lu_env *env, struct dt_object *dt,
                           __u64 start, __u64 end, struct thandle *th,
                           struct lustre_capa *capa);
+	/**
+	 * Allocate the blocks of [start, end) of the object, and extend its
+	 * size to end unless OST_FALLOC_KEEP_SIZE is set in \a mode. Done in
+	 * transactions of the OSD's own, so called outside of any.
+	 * precondition: regular object, not index
+	 */
+	int   (*dbo_fallocate)(const struct lu_env *env, struct dt_object *dt,
+			       __u64 start, __u64 end, int mode);
+	/**
+	 * Reserve the quota for dbo_fallocate() of [start, end) in \a th,
+	 * which is started only once the blocks are allocated.
+	 */
+	int   (*dbo_declare_fallocate)(const struct lu_env *env,
+				       struct dt_object *dt, __u64 start,
+				       __u64 end, int mode, struct thandle *th);
 };
 
 /**
@@ -974,6 +1029,20 @@ static inline int dt_trans_cb_add(struct thandle *th,
 	dcb->dcb_magic = TRANS_COMMIT_CB_MAGIC;
 	return th->th_dev->dd_ops->dt_trans_cb_add(th, dcb);
 }
+
+/**
+ * \retval -EOPNOTSUPP	if the device has no coalesced commit callbacks,
+ *			or no room left for another one in \a th: the caller
+ *			then falls back to a per-transaction callback
+ */
+static inline int dt_trans_transno_add(struct thandle *th,
+				       struct dt_txn_commit_transno *dtct,
+				       __u64 transno)
+{
+	if (th->th_dev->dd_ops->dt_trans_transno_add == NULL)
+		return -EOPNOTSUPP;
+	return th->th_dev->dd_ops->dt_trans_transno_add(th, dtct, transno);
+}
 /** @} dt */
 
 
@@ -1241,6 +1310,28 @@ static inline int dt_punch(const struct lu_env *env, struct dt_object *dt,
         return dt->do_body_ops->dbo_punch(env, dt, start, end, th, capa);
 }
 
+static inline int dt_fallocate(const struct lu_env *env, struct dt_object *dt,
+			       __u64 start, __u64 end, int mode)
+{
+	LASSERT(dt);
+	LASSERT(dt->do_body_ops);
+	if (dt->do_body_ops->dbo_fallocate == NULL)
+		return -EOPNOTSUPP;
+	return dt->do_body_ops->dbo_fallocate(env, dt, start, end, mode);
+}
+
+static inline int dt_declare_fallocate(const struct lu_env *env,
+				       struct dt_object *dt, __u64 start,
+				       __u64 end, int mode, struct thandle *th)
+{
+	LASSERT(dt);
+	LASSERT(dt->do_body_ops);
+	if (dt->do_body_ops->dbo_declare_fallocate == NULL)
+		return -EOPNOTSUPP;
+	return dt->do_body_ops->dbo_declare_fallocate(env, dt, start, end,
+						      mode, th);
+}
+
 static inline int dt_fiemap_get(const struct lu_env *env, struct dt_object *d,
                                 struct ll_user_fiemap *fm)
 {
@@ -379,6 +379,8 @@ struct ccc_object  *cl_inode2ccc    (struct inode *inode);
 
 int cl_setattr_ost(struct inode *inode, const struct iattr *attr,
                    struct obd_capa *capa);
+int cl_falloc(struct inode *inode, int mode, loff_t offset, loff_t len,
+	      struct obd_capa *capa);
 
 struct cl_page *ccc_vmpage_page_transient(struct page *vmpage);
 int ccc_object_invariant(const struct cl_object *obj);
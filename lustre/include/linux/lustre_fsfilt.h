@@ -63,7 +63,8 @@ struct fsfilt_operations {
         int     (* fs_commit)(struct inode *inode, void *handle,int force_sync);
         int     (* fs_map_inode_pages)(struct inode *inode, struct page **page,
 				       int pages, unsigned long *blocks,
-				       int create, struct mutex *sem);
+				       int create, unsigned long goal,
+				       struct mutex *sem);
         int     (* fs_write_record)(struct file *, void *, int size, loff_t *,
                                     int force_sync);
         int     (* fs_read_record)(struct file *, void *, int size, loff_t *);
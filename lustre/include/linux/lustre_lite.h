@@ -94,6 +94,10 @@ enum {
          LPROC_LL_LISTXATTR,
          LPROC_LL_REMOVEXATTR,
          LPROC_LL_INODE_PERM,
+	 LPROC_LL_GETXATTR_HITS,
+	 LPROC_LL_GETXATTR_MISSES,
+	 LPROC_LL_GETATTR_LAZY,
+	 LPROC_LL_FALLOCATE,
          LPROC_LL_FILE_OPCODES
 };
 
@@ -93,6 +93,10 @@ enum {
         BRW_W_DISK_IOSIZE,
         BRW_R_DIO_FRAGS,
         BRW_W_DIO_FRAGS,
+        BRW_R_RPC_BIOS,
+        BRW_W_RPC_BIOS,
+        BRW_R_RPC_BIOSIZE,
+        BRW_W_RPC_BIOSIZE,
         BRW_LAST,
 };
 
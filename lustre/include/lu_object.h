@@ -911,6 +911,8 @@ struct lu_rdpg {
         unsigned int            rp_npages;
         /** requested attr */
         __u32                   rp_attrs;
+	/** number of entries to pack LUDA_ATTRS for */
+	__u32			rp_attrs_count;
         /** pointers to pages */
         struct page           **rp_pages;
 };
@@ -365,6 +365,30 @@ extern void lustre_som_swab(struct som_attrs *attrs);
 
 #define SOM_INCOMPAT_SUPP 0x0
 
+/**
+ * Lazy size-on-MDT attributes stored in a separate xattr.  Unlike SOM they
+ * are not kept coherent with the OST objects: the MDT updates them when a
+ * writer closes the file or when "lfs som_sync" reconciles them, so they
+ * may lag behind the real size in between.
+ */
+struct lsom_attrs {
+	/** LSOM_FL_* */
+	__u32	lsa_flags;
+	__u32	lsa_padding;
+	/** file size when the attributes were last updated */
+	__u64	lsa_size;
+	/** fs blocks in objects when the attributes were last updated */
+	__u64	lsa_blocks;
+	/** seconds since epoch of the last update */
+	__u64	lsa_time;
+};
+extern void lustre_lsom_swab(struct lsom_attrs *attrs);
+
+enum lsom_flags {
+	/* the size was changed after the last update */
+	LSOM_FL_STALE	= 0x00000001,
+};
+
 /**
  * HSM on-disk attributes stored in a separate xattr.
  */
@@ -950,6 +974,8 @@ enum lu_dirent_attrs {
 	LUDA_FID		= 0x0001,
 	LUDA_TYPE		= 0x0002,
 	LUDA_64BITHASH		= 0x0004,
+	/* readdir-plus: inode attributes and lock of the entry */
+	LUDA_ATTRS		= 0x0008,
 
 	/* The following attrs are used for MDT interanl only,
 	 * not visible to client */
@@ -1019,6 +1045,33 @@ struct luda_type {
         __u16 lt_type;
 };
 
+/**
+ * Inode attributes of the entry, packed by readdir-plus (MDS_READPAGE
+ * with LUDA_ATTRS set). The attributes are valid only if lda_valid is non
+ * zero, in which case the client lock lda_lock_idx of the request has been
+ * granted a PR LOOKUP|UPDATE lock on the entry, whose handle cookie is
+ * lda_cookie. The LOV EA of a regular file follows, lda_lmm_size bytes.
+ *
+ * Aligned to 8 bytes.
+ */
+struct luda_attrs {
+	__u64			lda_cookie;	/* lock handle */
+	__u64			lda_valid;	/* OBD_MD_FL* */
+	__u64			lda_size;
+	__u64			lda_blocks;
+	obd_time		lda_mtime;
+	obd_time		lda_atime;
+	obd_time		lda_ctime;
+	__u32			lda_mode;
+	__u32			lda_uid;
+	__u32			lda_gid;
+	__u32			lda_flags;
+	__u32			lda_nlink;
+	__u32			lda_rdev;
+	__u32			lda_lock_idx;
+	__u32			lda_lmm_size;
+};
+
 struct lu_dirpage {
         __u64            ldp_hash_start;
         __u64            ldp_hash_end;
@@ -1069,7 +1122,26 @@ static inline int lu_dirent_calc_size(int namelen, __u16 attr)
         } else
                 size = sizeof(struct lu_dirent) + namelen;
 
-        return (size + 7) & ~7;
+	size = (size + 7) & ~7;
+	if (attr & LUDA_ATTRS)
+		size += sizeof(struct luda_attrs);
+
+	return size;
+}
+
+/**
+ * Return the readdir-plus attributes of the entry, NULL if there are none.
+ */
+static inline struct luda_attrs *lu_dirent_attrs(struct lu_dirent *ent)
+{
+	__u32 attrs = le32_to_cpu(ent->lde_attrs);
+
+	if (!(attrs & LUDA_ATTRS))
+		return NULL;
+
+	return (void *)ent +
+	       lu_dirent_calc_size(le16_to_cpu(ent->lde_namelen),
+				   attrs & ~LUDA_ATTRS);
 }
 
 static inline int lu_dirent_size(struct lu_dirent *ent)
@@ -1310,6 +1382,15 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 #define OBD_CONNECT_LIGHTWEIGHT 0x1000000000000ULL/* lightweight connection */
 #define OBD_CONNECT_SHORTIO     0x2000000000000ULL/* short io */
 #define OBD_CONNECT_PINGLESS	0x4000000000000ULL/* pings not required */
+#define OBD_CONNECT_READDIR_PLUS 0x8000000000000ULL/* readdir with attrs and
+							* entry locks */
+#define OBD_CONNECT_XATTR_ALL  0x10000000000000ULL/* getxattr of all xattrs */
+#define OBD_CONNECT_LAZY_SIZE  0x20000000000000ULL/* lazy size-on-MDT */
+#define OBD_CONNECT_GLIMPSE_BATCH 0x40000000000000ULL/* OST_GLIMPSE_BATCH */
+#define OBD_CONNECT_UNLINK_BATCH 0x80000000000000ULL/* REINT_UNLINK_BATCH */
+#define OBD_CONNECT_DIR_STRIPE 0x100000000000000ULL/* striped directories */
+#define OBD_CONNECT_SYNC_BATCH 0x200000000000000ULL/* OST_SYNC_BATCH */
+#define OBD_CONNECT_FALLOCATE  0x400000000000000ULL/* OST_FALLOCATE */
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
  * flag value is not in use on some other branch.  Please clear any such
@@ -1351,7 +1432,9 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_EINPROGRESS | \
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_UMASK | \
 				OBD_CONNECT_LVB_TYPE | OBD_CONNECT_LAYOUTLOCK |\
-				OBD_CONNECT_PINGLESS)
+				OBD_CONNECT_PINGLESS | OBD_CONNECT_READDIR_PLUS |\
+				OBD_CONNECT_XATTR_ALL | OBD_CONNECT_LAZY_SIZE |\
+				OBD_CONNECT_UNLINK_BATCH | OBD_CONNECT_DIR_STRIPE)
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
                                 OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
                                 OBD_CONNECT_TRUNCLOCK | OBD_CONNECT_INDEX | \
@@ -1368,7 +1451,8 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_JOBSTATS | \
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_LVB_TYPE|\
 				OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_FID | \
-				OBD_CONNECT_PINGLESS)
+				OBD_CONNECT_PINGLESS | OBD_CONNECT_GLIMPSE_BATCH | \
+				OBD_CONNECT_SYNC_BATCH | OBD_CONNECT_FALLOCATE)
 #define ECHO_CONNECT_SUPPORTED (0)
 #define MGS_CONNECT_SUPPORTED  (OBD_CONNECT_VERSION | OBD_CONNECT_AT | \
 				OBD_CONNECT_FULL20 | OBD_CONNECT_IMP_RECOV | \
@@ -1493,6 +1577,9 @@ typedef enum {
         OST_QUOTACHECK = 18,
         OST_QUOTACTL   = 19,
 	OST_QUOTA_ADJUST_QUNIT = 20, /* not used since 2.4 */
+	OST_GLIMPSE_BATCH = 21,
+	OST_SYNC_BATCH = 22,
+	OST_FALLOCATE  = 23,
         OST_LAST_OPC
 } ost_cmd_t;
 #define OST_FIRST_OPC  OST_REPLY
@@ -1554,6 +1641,7 @@ enum obdo_flags {
 #define LOV_PATTERN_RAID1	0x002   /* stripes are mirrors of each other */
 #define LOV_PATTERN_FIRST	0x100   /* first stripe is not in round-robin */
 #define LOV_PATTERN_CMOBD	0x200
+#define LOV_PATTERN_MDT		0x400	/* data is stored on the MDT (DoM) */
 
 #define LOV_PATTERN_F_MASK	0xffff0000
 #define LOV_PATTERN_F_RELEASED	0x80000000 /* HSM released file */
@@ -1659,6 +1747,7 @@ static inline void lmm_oi_cpu_to_le(struct ost_id *dst_oi,
 #define XATTR_NAME_FID          "trusted.fid"
 #define XATTR_NAME_VERSION      "trusted.version"
 #define XATTR_NAME_SOM		"trusted.som"
+#define XATTR_NAME_LSOM		"trusted.lsom"
 #define XATTR_NAME_HSM		"trusted.hsm"
 #define XATTR_NAME_LFSCK_NAMESPACE "trusted.lfsck_namespace"
 
@@ -1738,6 +1827,7 @@ static inline __u32 lov_mds_md_size(__u16 stripes, __u32 lmm_magic)
 #define OBD_MD_FLGETATTRLOCK (0x0000200000000000ULL) /* Get IOEpoch attributes
                                                       * under lock */
 #define OBD_MD_FLOBJCOUNT    (0x0000400000000000ULL) /* for multiple destroy */
+#define OBD_MD_FLXATTRALL    (0x0000800000000000ULL) /* all xattrs with values */
 
 #define OBD_MD_FLRMTLSETFACL (0x0001000000000000ULL) /* lfs lsetfacl case */
 #define OBD_MD_FLRMTLGETFACL (0x0002000000000000ULL) /* lfs lgetfacl case */
@@ -1745,6 +1835,7 @@ static inline __u32 lov_mds_md_size(__u16 stripes, __u32 lmm_magic)
 #define OBD_MD_FLRMTRGETFACL (0x0008000000000000ULL) /* lfs rgetfacl case */
 
 #define OBD_MD_FLDATAVERSION (0x0010000000000000ULL) /* iversion sum */
+#define OBD_MD_FLLAZYSIZE    (0x0020000000000000ULL) /* lazy size and blocks */
 
 #define OBD_MD_FLGETATTR (OBD_MD_FLID    | OBD_MD_FLATIME | OBD_MD_FLMTIME | \
                           OBD_MD_FLCTIME | OBD_MD_FLSIZE  | OBD_MD_FLBLKSZ | \
@@ -1858,6 +1949,49 @@ struct ost_lvb {
 
 extern void lustre_swab_ost_lvb(struct ost_lvb *lvb);
 
+/* Maximum number of objects in one OST_GLIMPSE_BATCH request */
+#define OST_GLIMPSE_BATCH_MAX	128
+
+/*
+ * One object of an OST_GLIMPSE_BATCH request and reply, which returns the
+ * attributes of many objects at once, e.g. for AGL. If the client sends the
+ * handle of a lock it prepared, the OST grants a PR lock on the whole object
+ * to it before reading the attributes, and returns the server lock handle.
+ */
+struct ost_glimpse {
+	struct ost_id		og_oi;		/* in: object */
+	struct lustre_handle	og_handle;	/* in: client lock or 0,
+						 * out: server lock or 0 */
+	struct ost_lvb		og_lvb;		/* out: object attributes */
+	__s32			og_rc;		/* out: -EAGAIN if a conflicting
+						 * lock is held */
+	__u32			og_padding;
+};
+
+extern void lustre_swab_ost_glimpse(struct ost_glimpse *og);
+
+/* Maximum number of objects in one OST_SYNC_BATCH request */
+#define OST_SYNC_BATCH_MAX	128
+
+/*
+ * One change of an OST_SYNC_BATCH request and reply, which applies many of
+ * the object destroys and ownership changes the MDT logged in its OSP sync
+ * llog at once. The request also carries the llog cookies of the changes,
+ * which the OST does not interpret, like o_lcookie of single changes.
+ */
+struct ost_sync_rec {
+	struct ost_id		osr_oi;		/* in: (first) object */
+	__u32			osr_opc;	/* in: OST_DESTROY or OST_SETATTR */
+	__u32			osr_count;	/* in: destroy: objects from
+						 * osr_oi on, 0 for one */
+	__u32			osr_uid;	/* in: setattr: new owner */
+	__u32			osr_gid;	/* in: setattr: new group */
+	__s32			osr_rc;		/* out: result of the change */
+	__u32			osr_padding;
+};
+
+extern void lustre_swab_ost_sync_rec(struct ost_sync_rec *osr);
+
 /*
  *   lquota data structures
  */
@@ -2100,6 +2234,7 @@ typedef enum {
 	REINT_SETXATTR = 7,
 	REINT_RMENTRY  = 8,
 //      REINT_WRITE    = 9,
+	REINT_UNLINK_BATCH = 10,
         REINT_MAX
 } mds_reint_t, mdt_reint_t;
 
@@ -2123,8 +2258,9 @@ extern void lustre_swab_generic_32s (__u32 *val);
 #define MDS_INODELOCK_OPEN   0x000004       /* For opened files */
 #define MDS_INODELOCK_LAYOUT 0x000008       /* for layout */
 #define MDS_INODELOCK_PERM   0x000010       /* for permission */
+#define MDS_INODELOCK_DOM    0x000020       /* Data-on-MDT file body */
 
-#define MDS_INODELOCK_MAXSHIFT 4
+#define MDS_INODELOCK_MAXSHIFT 5
 /* This FULL lock is useful to take on unlink sort of operations */
 #define MDS_INODELOCK_FULL ((1<<(MDS_INODELOCK_MAXSHIFT+1))-1)
 
@@ -2235,7 +2371,8 @@ struct mdt_body {
         __u32          uid_h; /* high 32-bits of uid, for FUID */
         __u32          gid_h; /* high 32-bits of gid, for FUID */
         __u32          padding_5; /* also fix lustre_swab_mdt_body */
-        __u64          padding_6;
+	__u64	       lazytime; /* time of the lazy size update, with
+				  * OBD_MD_FLLAZYSIZE */
         __u64          padding_7;
         __u64          padding_8;
         __u64          padding_9;
@@ -2499,6 +2636,13 @@ struct mdt_rec_unlink {
         __u32           ul_padding_9;   /* rr_padding_4 */
 };
 
+/* REINT_UNLINK_BATCH sends an mdt_rec_unlink with the names to unlink from
+ * ul_fid1 in RMF_NAMES, each NUL terminated, at most MDS_UNLINK_BATCH_MAX
+ * of them in at most MDS_UNLINK_BATCH_SIZE bytes. The result of each name
+ * is returned in RMF_RCS. */
+#define MDS_UNLINK_BATCH_MAX	256
+#define MDS_UNLINK_BATCH_SIZE	32768
+
 /* instance of mdt_reint_rec */
 struct mdt_rec_rename {
         __u32           rn_opcode;
@@ -2617,6 +2761,18 @@ struct lmv_stripe_md {
         struct lu_fid mea_ids[0];
 };
 
+static inline int lmv_stripe_md_size(int count)
+{
+	return sizeof(struct lmv_stripe_md) + count * sizeof(struct lu_fid);
+}
+
+/* A striped directory keeps its lmv_stripe_md, little-endian, in the
+ * XATTR_NAME_LMV of the master directory. Shard i is a subdirectory of the
+ * master named LMV_SHARD_NAME_FMT with the shard FID and i, and the names
+ * in the directory are spread over the shards by mea_name2idx(). */
+#define LMV_SHARD_NAME_FMT	DFID":%u"
+#define LMV_SHARD_NAME_LEN	64
+
 extern void lustre_swab_lmv_stripe_md(struct lmv_stripe_md *mea);
 
 /* lmv structures */
@@ -3218,7 +3374,8 @@ struct obdo {
         obd_flag                o_flags;
         obd_count               o_nlink;        /* brw: checksum */
         obd_count               o_parent_oid;
-	obd_count		o_misc;		/* brw: o_dropped */
+	obd_count		o_misc;		/* brw: o_dropped,
+						 * fallocate: o_falloc_mode */
 
         __u64                   o_ioepoch;      /* epoch in ost writes */
         __u32                   o_stripe_idx;   /* holds stripe idx */
@@ -3242,9 +3399,14 @@ struct obdo {
 #define o_dirty   o_blocks
 #define o_undirty o_mode
 #define o_dropped o_misc
+#define o_falloc_mode o_misc
 #define o_cksum   o_nlink
 #define o_grant_used o_data_version
 
+/* o_falloc_mode flags of OST_FALLOCATE, the FALLOC_FL_* of fallocate(2);
+ * the range is [o_size, o_blocks) */
+#define OST_FALLOC_KEEP_SIZE	0x01	/* do not extend the object size */
+
 static inline void lustre_set_wire_obdo(struct obd_connect_data *ocd,
 					struct obdo *wobdo, struct obdo *lobdo)
 {
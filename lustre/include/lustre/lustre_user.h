@@ -99,7 +99,8 @@ struct obd_statfs {
 	__u32           os_fprecreated;	/* objs available now to the caller */
 					/* used in QoS code to find preferred
 					 * OSTs */
-        __u32           os_spare2;
+	__u32           os_req_rate;	/* MDT requests per second lately,
+					 * used in LMV QoS placement */
         __u32           os_spare3;
         __u32           os_spare4;
         __u32           os_spare5;
@@ -255,6 +256,9 @@ struct ost_id {
 #define LL_IOC_LMV_SETSTRIPE	    _IOWR('f', 240, struct lmv_user_md)
 #define LL_IOC_LMV_GETSTRIPE	    _IOWR('f', 241, struct lmv_user_md)
 #define LL_IOC_REMOVE_ENTRY	    _IOWR('f', 242, __u64)
+#define LL_IOC_LAZYSTAT		    _IOWR('f', 243, struct ioc_lazystat)
+#define LL_IOC_SOM_SYNC		    _IOW('f', 244, long)
+#define LL_IOC_UNLINK_BATCH	    _IOWR('f', 245, struct ll_unlink_batch)
 
 #define LL_STATFS_LMV           1
 #define LL_STATFS_LOV           2
@@ -299,6 +303,7 @@ struct ost_id {
 #define LOV_PATTERN_RAID0 0x001
 #define LOV_PATTERN_RAID1 0x002
 #define LOV_PATTERN_FIRST 0x100
+#define LOV_PATTERN_MDT   0x400
 
 #define LOV_MAXPOOLNAME 16
 #define LOV_POOLNAMEF "%.16s"
@@ -850,6 +855,35 @@ struct ioc_data_version {
 #define LL_DV_NOFLUSH 0x01   /* Do not take READ EXTENT LOCK before sampling
                                 version. Dirty caches are left unchanged. */
 
+struct ioc_lazystat {
+	__u64 ils_flags;	/* See LL_LAZY_xxx */
+	__u64 ils_size;
+	__u64 ils_blocks;
+	__u64 ils_age;		/* seconds since the MDT updated a lazy size */
+};
+#define LL_LAZY_OK    0x01	/* In: the lazy size-on-MDT is acceptable.
+				 * Out: ils_size and ils_blocks are lazy. */
+
+/* LL_IOC_UNLINK_BATCH unlinks lub_count names from the directory the ioctl
+ * is issued on. The names follow lub_rcs, each NUL terminated, taking
+ * lub_namelen bytes in all. The result of each is returned in lub_rcs. */
+struct ll_unlink_batch {
+	__u32 lub_count;
+	__u32 lub_namelen;
+	__s32 lub_rcs[0];
+};
+#define LL_UNLINK_BATCH_MAX_SIZE (1 << 20)
+
+static inline size_t ll_unlink_batch_size(__u32 count, __u32 namelen)
+{
+	return sizeof(struct ll_unlink_batch) + count * sizeof(__s32) + namelen;
+}
+
+static inline char *ll_unlink_batch_names(struct ll_unlink_batch *lub)
+{
+	return (char *)&lub->lub_rcs[lub->lub_count];
+}
+
 #ifndef offsetof
 # define offsetof(typ,memb)     ((unsigned long)((char *)&(((typ *)0)->memb)))
 #endif
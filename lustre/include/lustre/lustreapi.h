@@ -241,6 +241,10 @@ extern int llapi_fd2fid(const int fd, lustre_fid *fid);
 
 extern int llapi_get_version(char *buffer, int buffer_size, char **version);
 extern int llapi_get_data_version(int fd, __u64 *data_version, __u64 flags);
+extern int llapi_get_lazystat(int fd, struct ioc_lazystat *ils);
+extern int llapi_som_sync(int fd);
+extern int llapi_unlink_batch(int dirfd, char **names, int count, int *rcs);
+extern int llapi_remove_tree(const char *path);
 extern int llapi_hsm_state_get(const char *path, struct hsm_user_state *hus);
 extern int llapi_hsm_state_set(const char *path, __u64 setmask, __u64 clearmask,
 			       __u32 archive_id);
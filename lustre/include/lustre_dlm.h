@@ -1403,10 +1403,25 @@ struct ptlrpc_request *ldlm_enqueue_pack(struct obd_export *exp, int lvb_len);
 int ldlm_handle_enqueue0(struct ldlm_namespace *ns, struct ptlrpc_request *req,
 			 const struct ldlm_request *dlm_req,
 			 const struct ldlm_callback_suite *cbs);
+int ldlm_lock_grant_remote(struct ldlm_namespace *ns, struct obd_export *exp,
+			   const struct ldlm_res_id *res_id, ldlm_type_t type,
+			   const ldlm_policy_data_t *policy, ldlm_mode_t mode,
+			   const struct lustre_handle *remote,
+			   struct lustre_handle *lockh);
 int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
                           ldlm_type_t type, __u8 with_policy, ldlm_mode_t mode,
 			  __u64 *flags, void *lvb, __u32 lvb_len,
                           struct lustre_handle *lockh, int rc);
+int ldlm_cli_lock_prep(struct obd_export *exp, const struct ldlm_res_id *res_id,
+		       const struct ldlm_enqueue_info *einfo, __u32 lvb_len,
+		       enum lvb_type lvb_type, struct lustre_handle *lockh);
+int ldlm_cli_lock_adopt(struct obd_export *exp,
+			const struct lustre_handle *lockh,
+			const struct ldlm_res_id *res_id,
+			const ldlm_policy_data_t *policy,
+			const struct lustre_handle *remote,
+			const void *lvb, __u32 lvb_len);
+void ldlm_cli_lock_abort(const struct lustre_handle *lockh, ldlm_mode_t mode);
 int ldlm_cli_enqueue_local(struct ldlm_namespace *ns,
                            const struct ldlm_res_id *res_id,
                            ldlm_type_t type, ldlm_policy_data_t *policy,
@@ -67,6 +67,9 @@ struct tg_export_data {
 	loff_t			ted_lr_off;
 	/** Client index in last_rcvd file */
 	int			ted_lr_idx;
+	/** Coalesced commit callback of the export, see
+	 * tgt_last_commit_cb_add() */
+	struct tgt_export_committed *ted_committed;
 };
 
 /**
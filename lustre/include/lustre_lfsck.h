@@ -54,6 +54,8 @@ int lfsck_stop(const struct lu_env *env, struct dt_device *key,
 
 int lfsck_get_speed(struct dt_device *key, void *buf, int len);
 int lfsck_set_speed(struct dt_device *key, int val);
+int lfsck_get_latency_target(struct dt_device *key, void *buf, int len);
+int lfsck_set_latency_target(struct dt_device *key, int val);
 
 int lfsck_dump(struct dt_device *key, void *buf, int len, __u16 type);
 
@@ -84,6 +84,10 @@ int target_queue_recovery_request(struct ptlrpc_request *req,
                                   struct obd_device *obd);
 int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
                    struct l_wait_info *lwi);
+int target_bulk_start(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
+		      struct l_wait_info *lwi);
+int target_bulk_wait(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
+		     struct l_wait_info *lwi, int mdidx);
 #endif
 
 int target_pack_pool_reply(struct ptlrpc_request *req);
@@ -2290,6 +2290,10 @@ struct ptlrpc_bulk_desc {
 	int			bd_md_max_brw;	/* max entries in bd_mds */
 	/** array of associated MDs */
 	lnet_handle_md_t	bd_mds[PTLRPC_BULK_OPS_COUNT];
+	/** server side: a bit per MD whose transfer is over */
+	unsigned long		bd_md_done;
+	/** server side: # bytes GOT/PUT by each MD */
+	int			bd_md_nob[PTLRPC_BULK_OPS_COUNT];
 
 #if defined(__KERNEL__)
 	/*
@@ -180,6 +180,7 @@ extern struct req_format RQF_MDS_REINT_CREATE_SLAVE;
 extern struct req_format RQF_MDS_REINT_CREATE_SYM;
 extern struct req_format RQF_MDS_REINT_OPEN;
 extern struct req_format RQF_MDS_REINT_UNLINK;
+extern struct req_format RQF_MDS_REINT_UNLINK_BATCH;
 extern struct req_format RQF_MDS_REINT_LINK;
 extern struct req_format RQF_MDS_REINT_RENAME;
 extern struct req_format RQF_MDS_REINT_SETATTR;
@@ -203,9 +204,12 @@ extern struct req_format RQF_OST_DISCONNECT;
 extern struct req_format RQF_OST_QUOTACHECK;
 extern struct req_format RQF_OST_QUOTACTL;
 extern struct req_format RQF_OST_GETATTR;
+extern struct req_format RQF_OST_GLIMPSE_BATCH;
+extern struct req_format RQF_OST_SYNC_BATCH;
 extern struct req_format RQF_OST_SETATTR;
 extern struct req_format RQF_OST_CREATE;
 extern struct req_format RQF_OST_PUNCH;
+extern struct req_format RQF_OST_FALLOCATE;
 extern struct req_format RQF_OST_SYNC;
 extern struct req_format RQF_OST_DESTROY;
 extern struct req_format RQF_OST_BRW_READ;
@@ -251,6 +255,7 @@ extern struct req_msg_field RMF_MDT_BODY;
 extern struct req_msg_field RMF_MDT_EPOCH;
 extern struct req_msg_field RMF_OBD_STATFS;
 extern struct req_msg_field RMF_NAME;
+extern struct req_msg_field RMF_NAMES;
 extern struct req_msg_field RMF_SYMTGT;
 extern struct req_msg_field RMF_TGTUUID;
 extern struct req_msg_field RMF_CLUUID;
@@ -267,6 +272,7 @@ extern struct req_msg_field RMF_IDX_INFO;
 extern struct req_msg_field RMF_CONN;
 extern struct req_msg_field RMF_CONNECT_DATA;
 extern struct req_msg_field RMF_DLM_REQ;
+extern struct req_msg_field RMF_DLM_HANDLES;
 extern struct req_msg_field RMF_DLM_REP;
 extern struct req_msg_field RMF_DLM_LVB;
 extern struct req_msg_field RMF_DLM_GL_DESC;
@@ -275,6 +281,8 @@ extern struct req_msg_field RMF_LAYOUT_INTENT;
 extern struct req_msg_field RMF_MDT_MD;
 extern struct req_msg_field RMF_REC_REINT;
 extern struct req_msg_field RMF_EADATA;
+extern struct req_msg_field RMF_EAVALS;
+extern struct req_msg_field RMF_EAVALS_LENS;
 extern struct req_msg_field RMF_ACL;
 extern struct req_msg_field RMF_LOGCOOKIES;
 extern struct req_msg_field RMF_CAPA1;
@@ -311,6 +319,8 @@ extern struct req_msg_field RMF_MGS_SEND_PARAM;
 
 extern struct req_msg_field RMF_OST_BODY;
 extern struct req_msg_field RMF_OBD_IOOBJ;
+extern struct req_msg_field RMF_OST_GLIMPSE;
+extern struct req_msg_field RMF_OST_SYNC_REC;
 extern struct req_msg_field RMF_OBD_ID;
 extern struct req_msg_field RMF_FID;
 extern struct req_msg_field RMF_NIOBUF_REMOTE;
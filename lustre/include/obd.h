@@ -68,6 +68,7 @@
 #include <lustre_fid.h>
 #include <lustre_fld.h>
 #include <lustre_capa.h>
+#include <wrand_table.h>
 
 #define MAX_OBD_DEVICES 8192
 
@@ -135,12 +136,19 @@ static inline bool lsm_is_released(struct lov_stripe_md *lsm)
 	return !!(lsm->lsm_pattern & LOV_PATTERN_F_RELEASED);
 }
 
+static inline bool lsm_is_dom(struct lov_stripe_md *lsm)
+{
+	return lov_pattern(lsm->lsm_pattern) == LOV_PATTERN_MDT;
+}
+
 static inline bool lsm_has_objects(struct lov_stripe_md *lsm)
 {
 	if (lsm == NULL)
 		return false;
 	if (lsm_is_released(lsm))
 		return false;
+	if (lsm_is_dom(lsm))
+		return false;
 	return true;
 }
 
@@ -181,6 +189,23 @@ struct obd_info {
 	char                   *oi_jobid;
 };
 
+/* do not take extent locks, the attributes are a snapshot only */
+#define OBD_GLIMPSE_NOLOCK	0x0001
+
+/* One item of obd_glimpse_batch(): a file at the LOV level, one of its
+ * objects at the OSC level. */
+struct obd_glimpse {
+	/* LOV: layout of the file */
+	struct lov_stripe_md	*og_lsm;
+	/* OSC: the object, its lvb and kms are updated if a lock is granted */
+	struct lov_oinfo	*og_oinfo;
+	/* size, blocks and times of the file or object */
+	struct ost_lvb		 og_lvb;
+	/* -EAGAIN if the OST would not grant a lock or saw a conflicting one,
+	 * the caller should glimpse the file the usual way then */
+	int			 og_rc;
+};
+
 /* compare all relevant fields. */
 static inline int lov_stripe_md_cmp(struct lov_stripe_md *m1,
                                     struct lov_stripe_md *m2)
@@ -495,6 +520,17 @@ struct lov_qos_rr {
         unsigned long       lqr_dirty:1;     /* recalc round-robin list */
 };
 
+/* Weighted random allocator data: alias table over the OSTs of a pool */
+struct lov_qos_wrand {
+	struct wrand_table  lqw_table;
+	__u32		   *lqw_idx;	     /* OST index of each choice */
+	__u64		   *lqw_weight;      /* scratch for wrand_build() */
+	__u32		   *lqw_work;	     /* scratch for wrand_build() */
+	__u32		    lqw_size;	     /* allocated choices */
+	__u32		    lqw_gen;	     /* lq_gen the table was built at */
+	unsigned long	    lqw_dirty:1;     /* pool changed, rebuild it */
+};
+
 /* allow statfs data caching for 1 second */
 #define OBD_STATFS_CACHE_SECONDS 1
 
@@ -510,6 +546,8 @@ struct lov_qos {
         unsigned int        lq_prio_free;   /* priority for free space */
         unsigned int        lq_threshold_rr;/* priority for rr */
         struct lov_qos_rr   lq_rr;          /* round robin qos data */
+	struct lov_qos_wrand lq_wrand;	    /* weighted random qos data */
+	__u32		    lq_gen;	    /* bumped as weights are updated */
         unsigned long       lq_dirty:1,     /* recalc qos data */
                             lq_same_space:1,/* the ost's all have approx.
                                                the same space avail */
@@ -546,6 +584,7 @@ struct pool_desc {
         struct ost_pool       pool_obds;              /* pool members */
         cfs_atomic_t          pool_refcount;          /* pool ref. counter */
         struct lov_qos_rr     pool_rr;                /* round robin qos */
+	struct lov_qos_wrand  pool_wrand;	      /* weighted random qos */
         cfs_hlist_node_t      pool_hash;              /* access by poolname */
         cfs_list_t            pool_list;              /* serial access */
         cfs_proc_dir_entry_t *pool_proc_entry;        /* file in /proc */
@@ -584,12 +623,15 @@ struct lmv_tgt_desc {
 	int			ltd_idx;
 	struct mutex		ltd_fid_mutex;
 	unsigned long		ltd_active:1; /* target up for requests */
+	struct obd_statfs	ltd_statfs;   /* last statfs, for QOS */
+	__u64			ltd_weight;   /* QOS weight from ltd_statfs */
 };
 
 enum placement_policy {
         PLACEMENT_CHAR_POLICY   = 0,
         PLACEMENT_NID_POLICY    = 1,
-        PLACEMENT_INVAL_POLICY  = 2,
+	PLACEMENT_QOS_POLICY	= 2,
+	PLACEMENT_INVAL_POLICY	= 3,
         PLACEMENT_MAX_POLICY
 };
 
@@ -600,6 +642,7 @@ struct lmv_obd {
 	struct lu_client_fld	lmv_fld;
 	spinlock_t		lmv_lock;
 	placement_policy_t	lmv_placement;
+	unsigned int		lmv_qos_maxage; /* max statfs age for QOS */
 	struct lmv_desc		desc;
 	struct obd_uuid		cluuid;
 	struct obd_export	*exp;
@@ -709,6 +752,9 @@ struct obd_trans_info {
         int                      oti_numcookies;
 	/** synchronous write is needed */
 	unsigned long		 oti_sync_write:1;
+	/** obd_commitrw() of only some of the pages obd_preprw() prepared,
+	 * the others are committed by later calls */
+	unsigned long		 oti_brw_partial:1;
 
         /* initial thread handling transaction */
         struct ptlrpc_thread *   oti_thread;
@@ -1106,6 +1152,12 @@ struct md_op_data {
 	/* Used by readdir */
 	__u32                   op_npages;
 
+	/* Used by Data-on-MDT I/O, bytes to transfer at op_offset */
+	__u32			op_count;
+
+	/* Used by readdir-plus, blocking callback of the entry locks */
+	ldlm_blocking_callback	op_cb_blocking;
+
 	/* used to transfer info between the stacks of MD client
 	 * see enum op_cli_flags */
 	__u32			op_cli_flags;
@@ -1114,6 +1166,7 @@ struct md_op_data {
 enum op_cli_flags {
 	CLI_SET_MEA	= 1 << 0,
 	CLI_RM_ENTRY	= 1 << 1,
+	CLI_READDIR_PLUS = 1 << 2,
 };
 
 struct md_enqueue_info;
@@ -1214,6 +1267,9 @@ struct obd_ops {
                          struct obd_info *oinfo);
         int (*o_getattr_async)(struct obd_export *exp, struct obd_info *oinfo,
                                struct ptlrpc_request_set *set);
+	int (*o_glimpse_batch)(const struct lu_env *env, struct obd_export *exp,
+			       struct obd_glimpse *ogs, int count, __u32 flags,
+			       struct ptlrpc_request_set *set);
         int (*o_brw)(int rw, struct obd_export *exp, struct obd_info *oinfo,
                      obd_count oa_bufs, struct brw_page *pgarr,
                      struct obd_trans_info *oti);
@@ -1224,6 +1280,8 @@ struct obd_ops {
         int (*o_punch)(const struct lu_env *, struct obd_export *exp,
                        struct obd_info *oinfo, struct obd_trans_info *oti,
                        struct ptlrpc_request_set *rqset);
+	int (*o_fallocate)(const struct lu_env *env, struct obd_export *exp,
+			   struct obd_info *oinfo, struct obd_trans_info *oti);
         int (*o_sync)(const struct lu_env *env, struct obd_export *exp,
                       struct obd_info *oinfo, obd_size start, obd_size end,
                       struct ptlrpc_request_set *set);
@@ -1437,6 +1495,13 @@ struct md_ops {
         int (*m_revalidate_lock)(struct obd_export *, struct lookup_intent *,
                                  struct lu_fid *, __u64 *bits);
 
+	int (*m_dom_rw)(struct obd_export *, struct md_op_data *,
+			struct page **, int rw, struct ptlrpc_request **);
+
+	/* names packed in op_name/op_namelen, results returned in rcs */
+	int (*m_unlink_batch)(struct obd_export *, struct md_op_data *,
+			      int count, __s32 *rcs);
+
         /*
          * NOTE: If adding ops, add another LPROCFS_MD_OP_INIT() line to
          * lprocfs_alloc_md_stats() in obdclass/lprocfs_status.c. Also, add a
@@ -894,6 +894,26 @@ static inline int obd_getattr_async(struct obd_export *exp,
         RETURN(rc);
 }
 
+/**
+ * Get the size, blocks and times of \a count files (LOV) or objects (OSC)
+ * with OST_GLIMPSE_BATCH RPCs. The LOV waits for the RPCs itself and is
+ * called with a NULL \a set, the OSC adds its RPCs to \a set.
+ */
+static inline int obd_glimpse_batch(const struct lu_env *env,
+				    struct obd_export *exp,
+				    struct obd_glimpse *ogs, int count,
+				    __u32 flags, struct ptlrpc_request_set *set)
+{
+	int rc;
+	ENTRY;
+
+	EXP_CHECK_DT_OP(exp, glimpse_batch);
+	EXP_COUNTER_INCREMENT(exp, glimpse_batch);
+
+	rc = OBP(exp->exp_obd, glimpse_batch)(env, exp, ogs, count, flags, set);
+	RETURN(rc);
+}
+
 static inline int obd_setattr(const struct lu_env *env, struct obd_export *exp,
                               struct obd_info *oinfo,
                               struct obd_trans_info *oti)
@@ -1384,6 +1404,21 @@ static inline int obd_punch(const struct lu_env *env, struct obd_export *exp,
         RETURN(rc);
 }
 
+static inline int obd_fallocate(const struct lu_env *env,
+				struct obd_export *exp,
+				struct obd_info *oinfo,
+				struct obd_trans_info *oti)
+{
+	int rc;
+	ENTRY;
+
+	EXP_CHECK_DT_OP(exp, fallocate);
+	EXP_COUNTER_INCREMENT(exp, fallocate);
+
+	rc = OBP(exp->exp_obd, fallocate)(env, exp, oinfo, oti);
+	RETURN(rc);
+}
+
 static inline int obd_brw(int cmd, struct obd_export *exp,
                           struct obd_info *oinfo, obd_count oa_bufs,
                           struct brw_page *pg, struct obd_trans_info *oti)
@@ -2231,6 +2266,30 @@ static inline int md_revalidate_lock(struct obd_export *exp,
         RETURN(rc);
 }
 
+static inline int md_dom_rw(struct obd_export *exp,
+			    struct md_op_data *op_data, struct page **pages,
+			    int rw, struct ptlrpc_request **request)
+{
+	int rc;
+	ENTRY;
+	EXP_CHECK_MD_OP(exp, dom_rw);
+	EXP_MD_COUNTER_INCREMENT(exp, dom_rw);
+	rc = MDP(exp->exp_obd, dom_rw)(exp, op_data, pages, rw, request);
+	RETURN(rc);
+}
+
+static inline int md_unlink_batch(struct obd_export *exp,
+				  struct md_op_data *op_data, int count,
+				  __s32 *rcs)
+{
+	int rc;
+	ENTRY;
+	EXP_CHECK_MD_OP(exp, unlink_batch);
+	EXP_MD_COUNTER_INCREMENT(exp, unlink_batch);
+	rc = MDP(exp->exp_obd, unlink_batch)(exp, op_data, count, rcs);
+	RETURN(rc);
+}
+
 
 /* OBD Metadata Support */
 
@@ -2285,6 +2344,29 @@ void lustre_deregister_lwp_item(struct obd_export **exp);
 int tgt_name2lwpname(const char *tgt_name, char *lwp_name);
 #endif /* HAVE_SERVER_SUPPORT */
 
+/* class_obd.c */
+void obd_svc_latency_add(long usec);
+long obd_svc_latency(void);
+
+/* Least rate, in objects per second, background scans are slowed down to. */
+#define OBD_SCAN_RATE_MIN	100
+/* Disk I/Os in flight from which a node is considered loaded. */
+#define OBD_SCAN_IO_DEPTH	64
+
+/* The speed of a background scan (LFSCK, OI scrub) adapted to the load of
+ * the node, see obd_scan_rate_update(). */
+struct obd_scan_rate {
+	/* Objects per second, 0 for no limit. */
+	__u32		osr_rate;
+
+	/* Objects scanned since osr_time. */
+	__u32		osr_scanned;
+	cfs_time_t	osr_time;
+};
+
+void obd_scan_rate_init(struct obd_scan_rate *osr);
+bool obd_scan_rate_update(struct obd_scan_rate *osr, __u32 target);
+
 /* sysctl.c */
 extern void obd_sysctl_init (void);
 extern void obd_sysctl_clean (void);
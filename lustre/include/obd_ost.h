@@ -87,6 +87,12 @@ struct osc_enqueue_args {
         unsigned int              oa_agl:1;
 };
 
+struct osc_glimpse_args {
+	struct obd_export	*ga_exp;
+	struct obd_glimpse	*ga_ogs;
+	int			 ga_count;
+};
+
 #if 0
 int osc_extent_blocking_cb(struct ldlm_lock *lock,
                            struct ldlm_lock_desc *new, void *data,
@@ -77,6 +77,7 @@ extern unsigned int obd_sync_filter;
 extern unsigned int obd_max_dirty_pages;
 extern cfs_atomic_t obd_dirty_pages;
 extern cfs_atomic_t obd_dirty_transit_pages;
+extern cfs_atomic_t obd_io_in_flight;
 extern unsigned int obd_alloc_fail_rate;
 extern char obd_jobid_var[];
 
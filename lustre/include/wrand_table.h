@@ -0,0 +1,70 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/include/wrand_table.h
+ *
+ * Alias table for weighted random selection in constant time, used by the
+ * QoS allocator of LOD to pick OSTs by their weights.
+ */
+
+#ifndef _WRAND_TABLE_H__
+#define _WRAND_TABLE_H__
+
+#include <libcfs/libcfs.h>
+
+/* largest range of the second random number of wrand_pick(), small enough
+ * next to 32-bit random numbers for the modulo not to bias the picks */
+#define WRAND_TOTAL_MAX		0xffffffU
+
+struct wrand_table {
+	__u32	 wt_count;	/** number of choices */
+	__u32	 wt_total;	/** sum of the scaled weights */
+	__u32	*wt_thresh;	/** keep choice i if rand < wt_thresh[i] */
+	__u32	*wt_alias;	/** otherwise take wt_alias[i] */
+};
+
+int wrand_build(struct wrand_table *wt, __u64 *weight, __u32 *work,
+		__u32 count);
+
+/**
+ * Pick a choice of \a wt with probability proportional to its weight,
+ * from the two random numbers \a rand1 and \a rand2.
+ */
+static inline __u32 wrand_pick(const struct wrand_table *wt, __u32 rand1,
+			       __u32 rand2)
+{
+	__u32 i = rand1 % wt->wt_count;
+
+	return rand2 % wt->wt_total < wt->wt_thresh[i] ? i : wt->wt_alias[i];
+}
+
+#endif
@@ -1042,6 +1042,52 @@ again:
 	RETURN(result);
 }
 
+/**
+ * Allocate the blocks of [offset, offset + len) of \a inode on the OSTs,
+ * extending the file unless OST_FALLOC_KEEP_SIZE is set in \a mode, as a
+ * CIT_SETATTR io which write locks the range.
+ */
+int cl_falloc(struct inode *inode, int mode, loff_t offset, loff_t len,
+	      struct obd_capa *capa)
+{
+	struct lu_env	*env;
+	struct cl_io	*io;
+	obd_time	 now = cfs_time_current_sec();
+	int		 result;
+	int		 refcheck;
+
+	ENTRY;
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		RETURN(PTR_ERR(env));
+
+	io = ccc_env_thread_io(env);
+	io->ci_obj = cl_i2info(inode)->lli_clob;
+
+	io->u.ci_setattr.sa_attr.lvb_ctime = now;
+	io->u.ci_setattr.sa_valid = ATTR_CTIME;
+	if (!(mode & OST_FALLOC_KEEP_SIZE)) {
+		io->u.ci_setattr.sa_attr.lvb_mtime = now;
+		io->u.ci_setattr.sa_valid |= ATTR_MTIME | ATTR_MTIME_SET;
+	}
+	io->u.ci_setattr.sa_capa = capa;
+	io->u.ci_setattr.sa_falloc_mode = mode;
+	io->u.ci_setattr.sa_falloc_offset = offset;
+	io->u.ci_setattr.sa_falloc_end = offset + len;
+
+again:
+	if (cl_io_init(env, io, CIT_SETATTR, io->ci_obj) == 0)
+		result = cl_io_loop(env, io);
+	else
+		result = io->ci_result;
+	cl_io_fini(env, io);
+	if (unlikely(io->ci_need_restart))
+		goto again;
+	cl_env_put(env, &refcheck);
+	RETURN(result);
+}
+
 /*****************************************************************************
  *
  * Type conversions.
@@ -2636,92 +2636,152 @@ static inline char *bulk2type(struct ptlrpc_bulk_desc *desc)
         return desc->bd_type == BULK_GET_SINK ? "GET" : "PUT";
 }
 
-int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
-                   struct l_wait_info *lwi)
+/**
+ * Start the transfer of bulk \a desc, once any eviction in progress is over.
+ */
+int target_bulk_start(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
+		      struct l_wait_info *lwi)
 {
-        struct ptlrpc_request *req = desc->bd_req;
-        int rc = 0;
-        ENTRY;
+	struct ptlrpc_request *req = desc->bd_req;
+	int rc = 0;
+	ENTRY;
 
 	/* If there is eviction in progress, wait for it to finish. */
-        if (unlikely(cfs_atomic_read(&exp->exp_obd->obd_evict_inprogress))) {
-                *lwi = LWI_INTR(NULL, NULL);
-                rc = l_wait_event(exp->exp_obd->obd_evict_inprogress_waitq,
-                                  !cfs_atomic_read(&exp->exp_obd->
-                                                   obd_evict_inprogress),
-                                  lwi);
-        }
+	if (unlikely(cfs_atomic_read(&exp->exp_obd->obd_evict_inprogress))) {
+		*lwi = LWI_INTR(NULL, NULL);
+		rc = l_wait_event(exp->exp_obd->obd_evict_inprogress_waitq,
+				  !cfs_atomic_read(&exp->exp_obd->
+						   obd_evict_inprogress),
+				  lwi);
+	}
 
 	/* Check if client was evicted or tried to reconnect already. */
-        if (exp->exp_failed || exp->exp_abort_active_req) {
-                rc = -ENOTCONN;
-        } else {
-                if (desc->bd_type == BULK_PUT_SINK)
-                        rc = sptlrpc_svc_wrap_bulk(req, desc);
-                if (rc == 0)
-                        rc = ptlrpc_start_bulk_transfer(desc);
-        }
-
-        if (rc == 0 && OBD_FAIL_CHECK(OBD_FAIL_MDS_SENDPAGE)) {
-                ptlrpc_abort_bulk(desc);
-        } else if (rc == 0) {
-                time_t start = cfs_time_current_sec();
-                do {
-                        long timeoutl = req->rq_deadline - cfs_time_current_sec();
-                        cfs_duration_t timeout = timeoutl <= 0 ?
-                                CFS_TICK : cfs_time_seconds(timeoutl);
-                        *lwi = LWI_TIMEOUT_INTERVAL(timeout,
-                                                    cfs_time_seconds(1),
-                                                   target_bulk_timeout,
-                                                   desc);
-                        rc = l_wait_event(desc->bd_waitq,
-                                          !ptlrpc_server_bulk_active(desc) ||
-                                          exp->exp_failed ||
-                                          exp->exp_abort_active_req,
-                                          lwi);
-                        LASSERT(rc == 0 || rc == -ETIMEDOUT);
-			/* Wait again if we changed deadline. */
-                } while ((rc == -ETIMEDOUT) &&
-                         (req->rq_deadline > cfs_time_current_sec()));
-
-                if (rc == -ETIMEDOUT) {
-                        DEBUG_REQ(D_ERROR, req,
-                                  "timeout on bulk %s after %ld%+lds",
-                                  bulk2type(desc),
-                                  req->rq_deadline - start,
-                                  cfs_time_current_sec() -
-                                  req->rq_deadline);
-                        ptlrpc_abort_bulk(desc);
-                } else if (exp->exp_failed) {
-                        DEBUG_REQ(D_ERROR, req, "Eviction on bulk %s",
-                                  bulk2type(desc));
-                        rc = -ENOTCONN;
-                        ptlrpc_abort_bulk(desc);
-                } else if (exp->exp_abort_active_req) {
-                        DEBUG_REQ(D_ERROR, req, "Reconnect on bulk %s",
-                                  bulk2type(desc));
-			/* We don't reply anyway. */
-                        rc = -ETIMEDOUT;
-                        ptlrpc_abort_bulk(desc);
-		} else if (desc->bd_failure ||
-			   desc->bd_nob_transferred != desc->bd_nob) {
-			DEBUG_REQ(D_ERROR, req, "%s bulk %s %d(%d)",
-				  desc->bd_failure ?
-				  "network error on" : "truncated",
-				  bulk2type(desc),
-				  desc->bd_nob_transferred,
-				  desc->bd_nob);
-			/* XXX Should this be a different errno? */
-			rc = -ETIMEDOUT;
-                } else if (desc->bd_type == BULK_GET_SINK) {
-                        rc = sptlrpc_svc_unwrap_bulk(req, desc);
-                }
-        } else {
-                DEBUG_REQ(D_ERROR, req, "bulk %s failed: rc %d",
-                          bulk2type(desc), rc);
-        }
+	if (exp->exp_failed || exp->exp_abort_active_req) {
+		rc = -ENOTCONN;
+	} else {
+		if (desc->bd_type == BULK_PUT_SINK)
+			rc = sptlrpc_svc_wrap_bulk(req, desc);
+		if (rc == 0)
+			rc = ptlrpc_start_bulk_transfer(desc);
+	}
 
-        RETURN(rc);
+	if (rc != 0)
+		DEBUG_REQ(D_ERROR, req, "bulk %s failed: rc %d",
+			  bulk2type(desc), rc);
+	RETURN(rc);
+}
+EXPORT_SYMBOL(target_bulk_start);
+
+/* # bytes the MD \a mdidx of \a desc covers */
+static int target_bulk_md_nob(struct ptlrpc_bulk_desc *desc, int mdidx)
+{
+	int nob = 0;
+	int i;
+
+	for (i = mdidx * LNET_MAX_IOV;
+	     i < min((mdidx + 1) * LNET_MAX_IOV, desc->bd_iov_count); i++)
+		nob += desc->bd_iov[i].kiov_len;
+	return nob;
+}
+
+static int target_bulk_done(struct ptlrpc_bulk_desc *desc, int mdidx)
+{
+	int done;
+
+	if (mdidx < 0)
+		return !ptlrpc_server_bulk_active(desc);
+
+	spin_lock(&desc->bd_lock);
+	done = desc->bd_md_done & (1UL << mdidx);
+	spin_unlock(&desc->bd_lock);
+	return done || !ptlrpc_server_bulk_active(desc);
+}
+
+/**
+ * Wait for the transfer of bulk \a desc started by target_bulk_start() and
+ * check that all its data went through.
+ *
+ * With \a mdidx >= 0, only wait for the MD \a mdidx, so that a write can
+ * commit the pages of an MD while the next ones are still on the network.
+ * The whole bulk is aborted on failure.
+ */
+int target_bulk_wait(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
+		     struct l_wait_info *lwi, int mdidx)
+{
+	struct ptlrpc_request *req = desc->bd_req;
+	time_t start = cfs_time_current_sec();
+	int rc;
+	ENTRY;
+
+	LASSERT(mdidx < desc->bd_md_max_brw);
+
+	do {
+		long timeoutl = req->rq_deadline - cfs_time_current_sec();
+		cfs_duration_t timeout = timeoutl <= 0 ?
+			CFS_TICK : cfs_time_seconds(timeoutl);
+		*lwi = LWI_TIMEOUT_INTERVAL(timeout, cfs_time_seconds(1),
+					    target_bulk_timeout, desc);
+		rc = l_wait_event(desc->bd_waitq,
+				  target_bulk_done(desc, mdidx) ||
+				  exp->exp_failed ||
+				  exp->exp_abort_active_req,
+				  lwi);
+		LASSERT(rc == 0 || rc == -ETIMEDOUT);
+		/* Wait again if we changed deadline. */
+	} while ((rc == -ETIMEDOUT) &&
+		 (req->rq_deadline > cfs_time_current_sec()));
+
+	if (rc == -ETIMEDOUT) {
+		DEBUG_REQ(D_ERROR, req, "timeout on bulk %s after %ld%+lds",
+			  bulk2type(desc), req->rq_deadline - start,
+			  cfs_time_current_sec() - req->rq_deadline);
+		ptlrpc_abort_bulk(desc);
+	} else if (exp->exp_failed) {
+		DEBUG_REQ(D_ERROR, req, "Eviction on bulk %s",
+			  bulk2type(desc));
+		rc = -ENOTCONN;
+		ptlrpc_abort_bulk(desc);
+	} else if (exp->exp_abort_active_req) {
+		DEBUG_REQ(D_ERROR, req, "Reconnect on bulk %s",
+			  bulk2type(desc));
+		/* We don't reply anyway. */
+		rc = -ETIMEDOUT;
+		ptlrpc_abort_bulk(desc);
+	} else if (desc->bd_failure ||
+		   (mdidx < 0 &&
+		    desc->bd_nob_transferred != desc->bd_nob) ||
+		   (mdidx >= 0 &&
+		    desc->bd_md_nob[mdidx] != target_bulk_md_nob(desc, mdidx))) {
+		DEBUG_REQ(D_ERROR, req, "%s bulk %s %d(%d)",
+			  desc->bd_failure ?
+			  "network error on" : "truncated",
+			  bulk2type(desc),
+			  desc->bd_nob_transferred,
+			  desc->bd_nob);
+		/* XXX Should this be a different errno? */
+		rc = -ETIMEDOUT;
+		ptlrpc_abort_bulk(desc);
+	} else if (mdidx < 0 && desc->bd_type == BULK_GET_SINK) {
+		rc = sptlrpc_svc_unwrap_bulk(req, desc);
+	}
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(target_bulk_wait);
+
+int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
+                   struct l_wait_info *lwi)
+{
+	int rc;
+	ENTRY;
+
+	rc = target_bulk_start(exp, desc, lwi);
+	if (rc == 0 && OBD_FAIL_CHECK(OBD_FAIL_MDS_SENDPAGE))
+		ptlrpc_abort_bulk(desc);
+	else if (rc == 0)
+		rc = target_bulk_wait(exp, desc, lwi, -1);
+
+	RETURN(rc);
 }
 EXPORT_SYMBOL(target_bulk_io);
 
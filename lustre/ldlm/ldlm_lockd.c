@@ -1476,6 +1476,107 @@ existing_lock:
 }
 EXPORT_SYMBOL(ldlm_handle_enqueue0);
 
+/**
+ * Grant to the client \a exp a lock it did not enqueue.
+ *
+ * The client created the lock beforehand, see ldlm_cli_lock_prep(), and
+ * sent its handle \a remote along with a request whose reply hands out the
+ * lock, e.g. MDS_READPAGE with readdir-plus or OST_GLIMPSE_BATCH. The lock
+ * is granted only if it is compatible with all granted and waiting locks on
+ * the resource, this never blocks nor sends blocking ASTs.
+ *
+ * \retval 0 the lock is granted, its handle is returned in \a lockh
+ * \retval -EWOULDBLOCK the lock conflicts with another one
+ * \retval -EEXIST \a remote is already used by another lock of \a exp
+ */
+int ldlm_lock_grant_remote(struct ldlm_namespace *ns, struct obd_export *exp,
+			   const struct ldlm_res_id *res_id, ldlm_type_t type,
+			   const ldlm_policy_data_t *policy, ldlm_mode_t mode,
+			   const struct lustre_handle *remote,
+			   struct lustre_handle *lockh)
+{
+	const struct ldlm_callback_suite cbs = {
+		.lcs_completion	= ldlm_server_completion_ast,
+		.lcs_blocking	= ldlm_server_blocking_ast,
+		.lcs_glimpse	= ldlm_server_glimpse_ast
+	};
+	ldlm_processing_policy	 process;
+	struct ldlm_lock	*lock;
+	__u64			 flags = 0;
+	ldlm_error_t		 err;
+	int			 rc = 0;
+	ENTRY;
+
+	/* A resent request carries the same handles, reuse the lock granted
+	 * for the first attempt. */
+	if (exp->exp_lock_hash != NULL) {
+		/* In the function below, .hs_keycmp resolves to
+		 * ldlm_export_lock_keycmp() */
+		/* coverity[overrun-buffer-val] */
+		lock = cfs_hash_lookup(exp->exp_lock_hash, (void *)remote);
+		if (lock != NULL) {
+			if (lock->l_granted_mode == mode &&
+			    memcmp(&lock->l_resource->lr_name, res_id,
+				   sizeof(*res_id)) == 0)
+				ldlm_lock2handle(lock, lockh);
+			else
+				rc = -EEXIST;
+			LDLM_LOCK_RELEASE(lock);
+			RETURN(rc);
+		}
+	}
+
+	lock = ldlm_lock_create(ns, res_id, type, mode, &cbs, NULL, 0,
+				LVB_T_NONE);
+	if (lock == NULL)
+		RETURN(-ENOMEM);
+
+	lock->l_last_activity = cfs_time_current_sec();
+	lock->l_remote_handle = *remote;
+	if (policy != NULL)
+		lock->l_policy_data = *policy;
+
+	/* Don't enqueue a lock onto the export if it is being disconnected,
+	 * see ldlm_handle_enqueue0() */
+	if (exp->exp_disconnected)
+		GOTO(out_destroy, rc = -ENOTCONN);
+
+	lock->l_export = class_export_lock_get(exp, lock);
+	if (exp->exp_lock_hash != NULL)
+		cfs_hash_add(exp->exp_lock_hash, &lock->l_remote_handle,
+			     &lock->l_exp_hash);
+
+	/* Check the lock against the granted and waiting locks the way
+	 * ldlm_reprocess_queue() does: it is granted if it is compatible with
+	 * all of them, and no blocking AST is ever sent. */
+	process = ldlm_get_processing_policy(lock->l_resource);
+	lock_res_and_lock(lock);
+	if (process(lock, &flags, 0, &err, NULL) != LDLM_ITER_CONTINUE) {
+		unlock_res_and_lock(lock);
+		GOTO(out_destroy, rc = -EWOULDBLOCK);
+	}
+	if (unlikely(exp->exp_disconnected)) {
+		unlock_res_and_lock(lock);
+		LDLM_ERROR(lock, "lock on destroyed export %p", exp);
+		ldlm_lock_cancel(lock);
+		LDLM_LOCK_RELEASE(lock);
+		RETURN(-ENOTCONN);
+	}
+	unlock_res_and_lock(lock);
+
+	LDLM_DEBUG(lock, "server-side lock granted to remote "LPX64,
+		   remote->cookie);
+	ldlm_lock2handle(lock, lockh);
+	LDLM_LOCK_RELEASE(lock);
+	RETURN(0);
+
+out_destroy:
+	ldlm_lock_destroy(lock);
+	LDLM_LOCK_RELEASE(lock);
+	RETURN(rc);
+}
+EXPORT_SYMBOL(ldlm_lock_grant_remote);
+
 /**
  * Old-style LDLM main entry point for server code enqueue.
  */
@@ -713,6 +713,123 @@ cleanup:
 }
 EXPORT_SYMBOL(ldlm_cli_enqueue_fini);
 
+/**
+ * Create a client lock that the server grants without an enqueue RPC.
+ *
+ * The handle of the new lock is sent to the server with some request, the
+ * server may grant it on any resource of type einfo->ei_type with
+ * ldlm_lock_grant_remote() and return the result in the reply, the lock is
+ * then granted locally by ldlm_cli_lock_adopt(). A lock that is not granted
+ * by the server has to be dropped with ldlm_cli_lock_abort(). Until then,
+ * the lock is referenced in einfo->ei_mode, like a lock being enqueued.
+ */
+int ldlm_cli_lock_prep(struct obd_export *exp, const struct ldlm_res_id *res_id,
+		       const struct ldlm_enqueue_info *einfo, __u32 lvb_len,
+		       enum lvb_type lvb_type, struct lustre_handle *lockh)
+{
+	const struct ldlm_callback_suite cbs = {
+		.lcs_completion	= einfo->ei_cb_cp ? : ldlm_completion_ast,
+		.lcs_blocking	= einfo->ei_cb_bl,
+		.lcs_glimpse	= einfo->ei_cb_gl
+	};
+	struct ldlm_lock *lock;
+	ENTRY;
+
+	lock = ldlm_lock_create(exp->exp_obd->obd_namespace, res_id,
+				einfo->ei_type, einfo->ei_mode, &cbs,
+				einfo->ei_cbdata, lvb_len, lvb_type);
+	if (lock == NULL)
+		RETURN(-ENOMEM);
+
+	ldlm_lock_addref_internal(lock, einfo->ei_mode);
+	ldlm_lock2handle(lock, lockh);
+	lock->l_conn_export = exp;
+	lock->l_export = NULL;
+	lock->l_blocking_ast = einfo->ei_cb_bl;
+	LDLM_DEBUG(lock, "client-side lock prepared");
+	LDLM_LOCK_RELEASE(lock);
+
+	RETURN(0);
+}
+EXPORT_SYMBOL(ldlm_cli_lock_prep);
+
+/**
+ * Grant locally a lock prepared by ldlm_cli_lock_prep(), that the server has
+ * granted on resource \a res_id with \a policy and handle \a remote, and
+ * returned the LVB \a lvb of \a lvb_len bytes, if any, along with it.
+ *
+ * The lock keeps the reference taken by ldlm_cli_lock_prep(), the caller
+ * drops it with ldlm_lock_decref() once done.
+ */
+int ldlm_cli_lock_adopt(struct obd_export *exp,
+			const struct lustre_handle *lockh,
+			const struct ldlm_res_id *res_id,
+			const ldlm_policy_data_t *policy,
+			const struct lustre_handle *remote,
+			const void *lvb, __u32 lvb_len)
+{
+	struct ldlm_namespace	*ns = exp->exp_obd->obd_namespace;
+	struct ldlm_lock	*lock;
+	__u64			 flags = 0;
+	int			 rc;
+	ENTRY;
+
+	lock = ldlm_handle2lock(lockh);
+	if (lock == NULL)
+		RETURN(-ENOENT);
+
+	lock_res_and_lock(lock);
+	/* Key change rehash lock in per-export hash with new key */
+	if (exp->exp_lock_hash) {
+		/* In the function below, .hs_keycmp resolves to
+		 * ldlm_export_lock_keycmp() */
+		/* coverity[overrun-buffer-val] */
+		cfs_hash_rehash_key(exp->exp_lock_hash,
+				    &lock->l_remote_handle,
+				    (void *)remote, &lock->l_exp_hash);
+	} else {
+		lock->l_remote_handle = *remote;
+	}
+	if (lvb_len > 0 && lock->l_lvb_data != NULL)
+		memcpy(lock->l_lvb_data, lvb, min(lvb_len, lock->l_lvb_len));
+	unlock_res_and_lock(lock);
+
+	if (memcmp(res_id, &lock->l_resource->lr_name, sizeof(*res_id))) {
+		rc = ldlm_lock_change_resource(ns, lock, res_id);
+		if (rc || lock->l_resource == NULL)
+			GOTO(out, rc = -ENOMEM);
+	}
+	if (policy != NULL)
+		lock->l_policy_data = *policy;
+
+	rc = ldlm_lock_enqueue(ns, &lock, NULL, &flags);
+	if (rc == ELDLM_OK && lock->l_completion_ast != NULL)
+		rc = lock->l_completion_ast(lock, flags, NULL);
+	LDLM_DEBUG(lock, "client-side lock adopted: rc = %d", rc);
+	EXIT;
+out:
+	LDLM_LOCK_PUT(lock);
+	return rc;
+}
+EXPORT_SYMBOL(ldlm_cli_lock_adopt);
+
+/**
+ * Drop a lock prepared by ldlm_cli_lock_prep() that the server did not
+ * grant, it is destroyed locally without any RPC.
+ */
+void ldlm_cli_lock_abort(const struct lustre_handle *lockh, ldlm_mode_t mode)
+{
+	struct ldlm_lock *lock;
+
+	lock = ldlm_handle2lock(lockh);
+	if (lock == NULL)
+		return;
+
+	failed_lock_cleanup(ldlm_lock_to_ns(lock), lock, mode);
+	LDLM_LOCK_PUT(lock);
+}
+EXPORT_SYMBOL(ldlm_cli_lock_abort);
+
 /**
  * Estimate number of lock handles that would fit into request of given
  * size.  PAGE_SIZE-512 is to allow TCP/IP and LNET headers to fit into
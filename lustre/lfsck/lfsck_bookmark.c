@@ -51,6 +51,7 @@ static void lfsck_bookmark_le_to_cpu(struct lfsck_bookmark *des,
 	des->lb_version = le16_to_cpu(src->lb_version);
 	des->lb_param = le16_to_cpu(src->lb_param);
 	des->lb_speed_limit = le32_to_cpu(src->lb_speed_limit);
+	des->lb_latency_target = le32_to_cpu(src->lb_latency_target);
 }
 
 static void lfsck_bookmark_cpu_to_le(struct lfsck_bookmark *des,
@@ -60,6 +61,7 @@ static void lfsck_bookmark_cpu_to_le(struct lfsck_bookmark *des,
 	des->lb_version = cpu_to_le16(src->lb_version);
 	des->lb_param = cpu_to_le16(src->lb_param);
 	des->lb_speed_limit = cpu_to_le32(src->lb_speed_limit);
+	des->lb_latency_target = cpu_to_le32(src->lb_latency_target);
 }
 
 static int lfsck_bookmark_load(const struct lu_env *env,
@@ -96,6 +96,331 @@ static void lfsck_close_dir(const struct lu_env *env,
 	lfsck_object_put(env, dir_obj);
 }
 
+static int lfsck_threads_per_cpt = 1;
+CFS_MODULE_PARM(lfsck_threads_per_cpt, "i", int, 0644,
+		"threads per CPU partition checking the name entries for "
+		"namespace LFSCK, 0 to check them on the LFSCK thread");
+
+/* Parallel name entries check.
+ *
+ * The master engine keeps traversing the otable and the directories, and
+ * queues each name entry to a worker, chosen by the FID of the child: all
+ * the links to an object are checked by the same worker, one at a time.
+ * An entry stays at the head of its worker queue until checked, so that the
+ * checkpoint never goes past the directory of the oldest unchecked entry. */
+
+static void lfsck_dir_item_free(const struct lu_env *env,
+				struct lfsck_dir_item *ldi)
+{
+	lfsck_object_put(env, ldi->ldi_dir);
+	OBD_FREE(ldi, sizeof(*ldi) + ldi->ldi_ent.lde_namelen + 1);
+}
+
+static int lfsck_dir_item_exec(const struct lu_env *env,
+			       struct lfsck_instance *lfsck,
+			       struct lfsck_dir_item *ldi)
+{
+	struct dt_object	*child;
+	int			 rc	= 0;
+
+	child = lfsck_object_find(env, lfsck, &ldi->ldi_ent.lde_fid);
+	if (child == NULL) {
+		return 0;
+	} else if (IS_ERR(child)) {
+		lfsck_fail(env, lfsck, true, &ldi->ldi_pos);
+		return PTR_ERR(child);
+	}
+
+	/* XXX: Currently, skip remote object, the consistency for
+	 *	remote object will be processed in LFSCK phase III. */
+	if (dt_object_exists(child) && !dt_object_remote(child))
+		rc = lfsck_exec_dir(env, lfsck, ldi->ldi_dir, child,
+				    &ldi->ldi_pos, &ldi->ldi_ent);
+	lfsck_object_put(env, child);
+	return rc;
+}
+
+static int lfsck_worker_main(void *args)
+{
+	struct lfsck_worker	*lw	= args;
+	struct lfsck_instance	*lfsck	= lw->lw_lfsck;
+	struct lfsck_bookmark	*bk	= &lfsck->li_bookmark_ram;
+	struct ptlrpc_thread	*thread = &lw->lw_thread;
+	struct lfsck_dir_item	*ldi;
+	struct l_wait_info	 lwi	= { 0 };
+	struct lu_env		 env;
+	int			 rc;
+	ENTRY;
+
+	rc = cfs_cpt_bind(cfs_cpt_table, lw->lw_cpt);
+	if (rc != 0)
+		CWARN("%s: LFSCK, fail to bind worker on CPT %d, rc = %d\n",
+		      lfsck_lfsck2name(lfsck), lw->lw_cpt, rc);
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0) {
+		CERROR("%s: LFSCK, fail to init worker env, rc = %d\n",
+		       lfsck_lfsck2name(lfsck), rc);
+		GOTO(noenv, rc);
+	}
+
+	spin_lock(&lw->lw_lock);
+	thread_set_flags(thread, SVC_RUNNING);
+	spin_unlock(&lw->lw_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+	while (1) {
+		l_wait_event(thread->t_ctl_waitq,
+			     !cfs_list_empty(&lw->lw_items) ||
+			     !thread_is_running(thread),
+			     &lwi);
+		if (unlikely(!thread_is_running(thread)))
+			break;
+
+		spin_lock(&lw->lw_lock);
+		ldi = cfs_list_entry(lw->lw_items.next, struct lfsck_dir_item,
+				     ldi_link);
+		spin_unlock(&lw->lw_lock);
+
+		rc = lfsck_dir_item_exec(&env, lfsck, ldi);
+
+		spin_lock(&lw->lw_lock);
+		cfs_list_del(&ldi->ldi_link);
+		lw->lw_count--;
+		spin_unlock(&lw->lw_lock);
+		lfsck_dir_item_free(&env, ldi);
+		/* The master engine may wait for room in the queue. */
+		cfs_waitq_broadcast(&lfsck->li_thread.t_ctl_waitq);
+
+		if (rc != 0 && bk->lb_param & LPF_FAILOUT) {
+			spin_lock(&lfsck->li_lock);
+			if (lfsck->li_workers_rc == 0)
+				lfsck->li_workers_rc = rc;
+			spin_unlock(&lfsck->li_lock);
+			break;
+		}
+		rc = 0;
+	}
+
+	lu_env_fini(&env);
+
+noenv:
+	spin_lock(&lw->lw_lock);
+	thread_set_flags(thread, SVC_STOPPED);
+	spin_unlock(&lw->lw_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	cfs_waitq_broadcast(&lfsck->li_thread.t_ctl_waitq);
+	return rc;
+}
+
+static void lfsck_workers_start(struct lfsck_instance *lfsck)
+{
+	struct lfsck_worker	*lw;
+	struct l_wait_info	 lwi	= { 0 };
+	cfs_task_t		*task;
+	int			 ncpt	= cfs_cpt_number(cfs_cpt_table);
+	int			 count;
+	int			 i;
+
+	if (!lfsck->li_master || cfs_list_empty(&lfsck->li_list_dir) ||
+	    lfsck_threads_per_cpt <= 0)
+		return;
+
+	count = min(ncpt * lfsck_threads_per_cpt, LFSCK_WORKERS_MAX);
+	OBD_ALLOC(lfsck->li_workers, LFSCK_WORKERS_MAX * sizeof(*lw));
+	if (lfsck->li_workers == NULL)
+		return;
+
+	lfsck->li_workers_rc = 0;
+	for (i = 0; i < count; i++) {
+		lw = &lfsck->li_workers[i];
+		lw->lw_lfsck = lfsck;
+		lw->lw_cpt = i % ncpt;
+		spin_lock_init(&lw->lw_lock);
+		CFS_INIT_LIST_HEAD(&lw->lw_items);
+		cfs_waitq_init(&lw->lw_thread.t_ctl_waitq);
+		thread_set_flags(&lw->lw_thread, 0);
+
+		task = kthread_run(lfsck_worker_main, lw, "lfsck_%02d", i);
+		if (IS_ERR(task)) {
+			CERROR("%s: cannot start LFSCK worker, rc = %ld\n",
+			       lfsck_lfsck2name(lfsck), PTR_ERR(task));
+			break;
+		}
+
+		l_wait_event(lw->lw_thread.t_ctl_waitq,
+			     thread_is_running(&lw->lw_thread) ||
+			     thread_is_stopped(&lw->lw_thread),
+			     &lwi);
+		if (!thread_is_running(&lw->lw_thread))
+			break;
+	}
+
+	/* The name entries are checked by the master engine itself if no
+	 * worker started. */
+	if (i == 0) {
+		OBD_FREE(lfsck->li_workers, LFSCK_WORKERS_MAX * sizeof(*lw));
+		lfsck->li_workers = NULL;
+		return;
+	}
+
+	lfsck->li_worker_count = i;
+	CDEBUG(D_LFSCK, "%s: LFSCK, %d threads checking name entries\n",
+	       lfsck_lfsck2name(lfsck), i);
+}
+
+static bool lfsck_workers_idle(struct lfsck_instance *lfsck)
+{
+	int i;
+
+	for (i = 0; i < lfsck->li_worker_count; i++) {
+		if (lfsck->li_workers[i].lw_count != 0)
+			return false;
+	}
+	return true;
+}
+
+/* Wait for the workers to check the queued entries if the scanning is over,
+ * then stop them. Returns the result of the first-step scanning. */
+static int lfsck_workers_stop(struct lfsck_instance *lfsck, int result)
+{
+	struct ptlrpc_thread	*thread = &lfsck->li_thread;
+	struct ptlrpc_thread	*wthread;
+	struct l_wait_info	 lwi	= { 0 };
+	int			 i;
+
+	if (result > 0)
+		l_wait_event(thread->t_ctl_waitq,
+			     lfsck_workers_idle(lfsck) ||
+			     lfsck->li_workers_rc != 0 ||
+			     !thread_is_running(thread),
+			     &lwi);
+
+	for (i = 0; i < lfsck->li_worker_count; i++) {
+		wthread = &lfsck->li_workers[i].lw_thread;
+		spin_lock(&lfsck->li_workers[i].lw_lock);
+		if (!thread_is_stopped(wthread))
+			thread_set_flags(wthread, SVC_STOPPING);
+		spin_unlock(&lfsck->li_workers[i].lw_lock);
+		cfs_waitq_broadcast(&wthread->t_ctl_waitq);
+		l_wait_event(wthread->t_ctl_waitq,
+			     thread_is_stopped(wthread),
+			     &lwi);
+	}
+
+	if (lfsck->li_workers_rc != 0 && result >= 0)
+		return lfsck->li_workers_rc;
+
+	/* Stopped with unchecked entries: not completed. */
+	if (result > 0 && !lfsck_workers_idle(lfsck))
+		return 0;
+
+	return result;
+}
+
+static void lfsck_workers_fini(const struct lu_env *env,
+			       struct lfsck_instance *lfsck)
+{
+	struct lfsck_worker	*lw;
+	struct lfsck_dir_item	*ldi;
+	int			 i;
+
+	for (i = 0; i < lfsck->li_worker_count; i++) {
+		lw = &lfsck->li_workers[i];
+		while (!cfs_list_empty(&lw->lw_items)) {
+			ldi = cfs_list_entry(lw->lw_items.next,
+					     struct lfsck_dir_item, ldi_link);
+			cfs_list_del(&ldi->ldi_link);
+			lfsck_dir_item_free(env, ldi);
+		}
+		lw->lw_count = 0;
+	}
+
+	OBD_FREE(lfsck->li_workers, LFSCK_WORKERS_MAX * sizeof(*lw));
+	lfsck->li_workers = NULL;
+	lfsck->li_worker_count = 0;
+}
+
+/**
+ * Move \a pos back to the position of the oldest name entry not yet checked
+ * by the workers, if any is before it.
+ */
+void lfsck_workers_pos(struct lfsck_instance *lfsck,
+		       struct lfsck_position *pos)
+{
+	struct lfsck_worker	*lw;
+	struct lfsck_dir_item	*ldi;
+	int			 i;
+
+	for (i = 0; i < lfsck->li_worker_count; i++) {
+		lw = &lfsck->li_workers[i];
+		spin_lock(&lw->lw_lock);
+		if (!cfs_list_empty(&lw->lw_items)) {
+			ldi = cfs_list_entry(lw->lw_items.next,
+					     struct lfsck_dir_item, ldi_link);
+			if (lfsck_pos_is_eq(&ldi->ldi_pos, pos) < 0)
+				*pos = ldi->ldi_pos;
+		}
+		spin_unlock(&lw->lw_lock);
+	}
+}
+
+static int lfsck_dir_item_queue(const struct lu_env *env,
+				struct lfsck_instance *lfsck,
+				struct lu_dirent *ent)
+{
+	struct ptlrpc_thread	*thread = &lfsck->li_thread;
+	struct dt_object	*dir	= lfsck->li_obj_dir;
+	struct lfsck_worker	*lw;
+	struct lfsck_dir_item	*ldi;
+	struct l_wait_info	 lwi	= { 0 };
+	bool			 queued = false;
+
+	if (unlikely(lfsck->li_workers_rc != 0))
+		return lfsck->li_workers_rc;
+
+	OBD_ALLOC(ldi, sizeof(*ldi) + ent->lde_namelen + 1);
+	if (ldi == NULL) {
+		lfsck_fail(env, lfsck, true, NULL);
+		return -ENOMEM;
+	}
+
+	memcpy(&ldi->ldi_ent, ent, sizeof(*ent) + ent->lde_namelen + 1);
+	ldi->ldi_dir = lfsck_object_get(dir);
+	/* Until the entry is checked, restart from the head of its
+	 * directory: it is harmless to check the entries again. */
+	lfsck_pos_fill(env, lfsck, &ldi->ldi_pos, false);
+	ldi->ldi_pos.lp_dir_parent = *lfsck_dto2fid(dir);
+	ldi->ldi_pos.lp_dir_cookie = 0;
+
+	lw = &lfsck->li_workers[fid_hash(&ent->lde_fid, 16) %
+				lfsck->li_worker_count];
+	l_wait_event(thread->t_ctl_waitq,
+		     lw->lw_count < LFSCK_WORKER_QUEUE ||
+		     !thread_is_running(&lw->lw_thread) ||
+		     lfsck->li_workers_rc != 0 ||
+		     !thread_is_running(thread),
+		     &lwi);
+
+	spin_lock(&lw->lw_lock);
+	if (likely(lw->lw_count < LFSCK_WORKER_QUEUE &&
+		   thread_is_running(&lw->lw_thread))) {
+		cfs_list_add_tail(&ldi->ldi_link, &lw->lw_items);
+		lw->lw_count++;
+		queued = true;
+	}
+	spin_unlock(&lw->lw_lock);
+
+	if (queued) {
+		cfs_waitq_broadcast(&lw->lw_thread.t_ctl_waitq);
+		return 0;
+	}
+
+	/* Stopping, the entry will be checked when the LFSCK resumes. */
+	lfsck_dir_item_free(env, ldi);
+	return lfsck->li_workers_rc;
+}
+
 static int lfsck_master_dir_engine(const struct lu_env *env,
 				   struct lfsck_instance *lfsck)
 {
@@ -129,7 +454,7 @@ static int lfsck_master_dir_engine(const struct lu_env *env,
 			       lfsck->li_args_dir);
 		lfsck_unpack_ent(ent, &lfsck->li_cookie_dir);
 		if (rc != 0) {
-			lfsck_fail(env, lfsck, true);
+			lfsck_fail(env, lfsck, true, NULL);
 			if (bk->lb_param & LPF_FAILOUT)
 				RETURN(rc);
 			else
@@ -139,12 +464,19 @@ static int lfsck_master_dir_engine(const struct lu_env *env,
 		if (ent->lde_attrs & LUDA_IGNORE)
 			goto checkpoint;
 
+		if (lfsck->li_worker_count > 0) {
+			rc = lfsck_dir_item_queue(env, lfsck, ent);
+			if (rc != 0 && bk->lb_param & LPF_FAILOUT)
+				RETURN(rc);
+			goto checkpoint;
+		}
+
 		*fid = ent->lde_fid;
 		child = lfsck_object_find(env, lfsck, fid);
 		if (child == NULL) {
 			goto checkpoint;
 		} else if (IS_ERR(child)) {
-			lfsck_fail(env, lfsck, true);
+			lfsck_fail(env, lfsck, true, NULL);
 			if (bk->lb_param & LPF_FAILOUT)
 				RETURN(PTR_ERR(child));
 			else
@@ -154,7 +486,8 @@ static int lfsck_master_dir_engine(const struct lu_env *env,
 		/* XXX: Currently, skip remote object, the consistency for
 		 *	remote object will be processed in LFSCK phase III. */
 		if (dt_object_exists(child) && !dt_object_remote(child))
-			rc = lfsck_exec_dir(env, lfsck, child, ent);
+			rc = lfsck_exec_dir(env, lfsck, lfsck->li_obj_dir,
+					    child, NULL, ent);
 		lfsck_object_put(env, child);
 		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
 			RETURN(rc);
@@ -228,7 +561,7 @@ static int lfsck_master_oit_engine(const struct lu_env *env,
 		lfsck->li_new_scanned++;
 		rc = iops->rec(env, di, (struct dt_rec *)fid, 0);
 		if (rc != 0) {
-			lfsck_fail(env, lfsck, true);
+			lfsck_fail(env, lfsck, true, NULL);
 			if (bk->lb_param & LPF_FAILOUT)
 				RETURN(rc);
 			else
@@ -239,7 +572,7 @@ static int lfsck_master_oit_engine(const struct lu_env *env,
 		if (target == NULL) {
 			goto checkpoint;
 		} else if (IS_ERR(target)) {
-			lfsck_fail(env, lfsck, true);
+			lfsck_fail(env, lfsck, true, NULL);
 			if (bk->lb_param & LPF_FAILOUT)
 				RETURN(PTR_ERR(target));
 			else
@@ -323,6 +656,8 @@ int lfsck_master_engine(void *args)
 	       PFID(&lfsck->li_pos_current.lp_dir_parent),
 	       cfs_curproc_pid());
 
+	lfsck_workers_start(lfsck);
+
 	spin_lock(&lfsck->li_lock);
 	thread_set_flags(thread, SVC_RUNNING);
 	spin_unlock(&lfsck->li_lock);
@@ -342,10 +677,15 @@ int lfsck_master_engine(void *args)
 	       PFID(&lfsck->li_pos_current.lp_dir_parent),
 	       cfs_curproc_pid(), rc);
 
+	if (lfsck->li_worker_count > 0)
+		rc = lfsck_workers_stop(lfsck, rc);
+
 	if (!OBD_FAIL_CHECK(OBD_FAIL_LFSCK_CRASH))
 		rc = lfsck_post(&env, lfsck, rc);
 	if (lfsck->li_di_dir != NULL)
 		lfsck_close_dir(&env, lfsck);
+	if (lfsck->li_workers != NULL)
+		lfsck_workers_fini(&env, lfsck);
 
 fini_oit:
 	lfsck_di_oit_put(&env, lfsck);
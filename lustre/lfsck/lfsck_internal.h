@@ -42,6 +42,7 @@
 #include <lustre_net.h>
 #include <lustre_dlm.h>
 #include <lustre_fid.h>
+#include <obd_class.h>
 
 #define HALF_SEC			(CFS_HZ >> 1)
 #define LFSCK_CHECKPOINT_INTERVAL	60
@@ -114,8 +115,9 @@ struct lfsck_bookmark {
 	/* How many items can be scanned at most per second. */
 	__u32	lb_speed_limit;
 
-	/* For 64-bits aligned. */
-	__u32	lb_padding;
+	/* Latency of the requests handled on the node, in microseconds,
+	 * that the speed of the LFSCK adapts to. 0 for a fixed speed. */
+	__u32	lb_latency_target;
 
 	/* For future using. */
 	__u64	lb_reserved[6];
@@ -204,7 +206,8 @@ struct lfsck_operations {
 
 	void (*lfsck_fail)(const struct lu_env *env,
 			   struct lfsck_component *com,
-			   bool new_checked);
+			   bool new_checked,
+			   const struct lfsck_position *pos);
 
 	int (*lfsck_checkpoint)(const struct lu_env *env,
 				struct lfsck_component *com,
@@ -219,7 +222,9 @@ struct lfsck_operations {
 
 	int (*lfsck_exec_dir)(const struct lu_env *env,
 			      struct lfsck_component *com,
+			      struct dt_object *dir,
 			      struct dt_object *obj,
+			      const struct lfsck_position *pos,
 			      struct lu_dirent *ent);
 
 	int (*lfsck_post)(const struct lu_env *env,
@@ -259,6 +264,35 @@ struct lfsck_component {
 	__u16			 lc_type;
 };
 
+/* A name entry queued by the master engine for a worker to check. */
+struct lfsck_dir_item {
+	/* into lfsck_worker::lw_items */
+	cfs_list_t		 ldi_link;
+
+	/* The directory holding the entry. */
+	struct dt_object	*ldi_dir;
+
+	/* Where to restart from if the entry has not been checked yet. */
+	struct lfsck_position	 ldi_pos;
+
+	/* Must be the last, followed by the name. */
+	struct lu_dirent	 ldi_ent;
+};
+
+#define LFSCK_WORKERS_MAX	32
+#define LFSCK_WORKER_QUEUE	512
+
+struct lfsck_worker {
+	struct lfsck_instance	*lw_lfsck;
+	struct ptlrpc_thread	 lw_thread;
+	spinlock_t		 lw_lock;
+
+	/* The items to be checked, the first one is being checked. */
+	cfs_list_t		 lw_items;
+	__u32			 lw_count;
+	int			 lw_cpt;
+};
+
 struct lfsck_instance {
 	struct mutex		  li_mutex;
 	spinlock_t		  li_lock;
@@ -330,6 +364,16 @@ struct lfsck_instance {
 	/* How many objects have been scanned since last sleep. */
 	__u32			  li_new_scanned;
 
+	/* Speed adapted to the load, if li_bookmark_ram::lb_latency_target. */
+	struct obd_scan_rate	  li_scan_rate;
+
+	/* Threads checking the name entries for the master engine. */
+	struct lfsck_worker	 *li_workers;
+	int			  li_worker_count;
+
+	/* The first failure of the workers, stops the master engine. */
+	int			  li_workers_rc;
+
 	unsigned int		  li_paused:1, /* The lfsck is paused. */
 				  li_oit_over:1, /* oit is finished. */
 				  li_drop_dryrun:1, /* Ever dryrun, not now. */
@@ -364,6 +408,7 @@ void lfsck_component_cleanup(const struct lu_env *env,
 int lfsck_bits_dump(char **buf, int *len, int bits, const char *names[],
 		    const char *prefix);
 int lfsck_time_dump(char **buf, int *len, __u64 time, const char *prefix);
+int lfsck_speed_dump(char **buf, int *len, struct lfsck_instance *lfsck);
 int lfsck_pos_dump(char **buf, int *len, struct lfsck_position *pos,
 		   const char *prefix);
 void lfsck_pos_fill(const struct lu_env *env, struct lfsck_instance *lfsck,
@@ -372,18 +417,21 @@ void lfsck_control_speed(struct lfsck_instance *lfsck);
 int lfsck_reset(const struct lu_env *env, struct lfsck_instance *lfsck,
 		bool init);
 void lfsck_fail(const struct lu_env *env, struct lfsck_instance *lfsck,
-		bool new_checked);
+		bool new_checked, const struct lfsck_position *pos);
 int lfsck_checkpoint(const struct lu_env *env, struct lfsck_instance *lfsck);
 int lfsck_prep(const struct lu_env *env, struct lfsck_instance *lfsck);
 int lfsck_exec_oit(const struct lu_env *env, struct lfsck_instance *lfsck,
 		   struct dt_object *obj);
 int lfsck_exec_dir(const struct lu_env *env, struct lfsck_instance *lfsck,
-		   struct dt_object *obj, struct lu_dirent *ent);
+		   struct dt_object *dir, struct dt_object *obj,
+		   const struct lfsck_position *pos, struct lu_dirent *ent);
 int lfsck_post(const struct lu_env *env, struct lfsck_instance *lfsck,
 	       int result);
 int lfsck_double_scan(const struct lu_env *env, struct lfsck_instance *lfsck);
 
 /* lfsck_engine.c */
+void lfsck_workers_pos(struct lfsck_instance *lfsck,
+		       struct lfsck_position *pos);
 int lfsck_master_engine(void *args);
 
 /* lfsck_bookmark.c */
@@ -312,6 +312,38 @@ int lfsck_time_dump(char **buf, int *len, __u64 time, const char *prefix)
 	return rc;
 }
 
+/* The speed limit in force: the fixed one, or the adaptive one if lower. */
+static __u32 lfsck_speed_current(struct lfsck_instance *lfsck)
+{
+	__u32 limit = lfsck->li_bookmark_ram.lb_speed_limit;
+	__u32 rate  = lfsck->li_scan_rate.osr_rate;
+
+	if (lfsck->li_bookmark_ram.lb_latency_target == 0 || rate == 0)
+		return limit;
+
+	if (limit != LFSCK_SPEED_NO_LIMIT && limit < rate)
+		return limit;
+
+	return rate;
+}
+
+int lfsck_speed_dump(char **buf, int *len, struct lfsck_instance *lfsck)
+{
+	__u32 limit = lfsck_speed_current(lfsck);
+	int   rc;
+
+	if (limit != LFSCK_SPEED_NO_LIMIT)
+		rc = snprintf(*buf, *len, "speed_limit: %u items/sec\n", limit);
+	else
+		rc = snprintf(*buf, *len, "speed_limit: N/A\n");
+	if (rc <= 0)
+		return -ENOSPC;
+
+	*buf += rc;
+	*len -= rc;
+	return rc;
+}
+
 int lfsck_pos_dump(char **buf, int *len, struct lfsck_position *pos,
 		   const char *prefix)
 {
@@ -371,9 +403,8 @@ void lfsck_pos_fill(const struct lu_env *env, struct lfsck_instance *lfsck,
 	}
 }
 
-static void __lfsck_set_speed(struct lfsck_instance *lfsck, __u32 limit)
+static void lfsck_set_sleep(struct lfsck_instance *lfsck, __u32 limit)
 {
-	lfsck->li_bookmark_ram.lb_speed_limit = limit;
 	if (limit != LFSCK_SPEED_NO_LIMIT) {
 		if (limit > CFS_HZ) {
 			lfsck->li_sleep_rate = limit / CFS_HZ;
@@ -388,11 +419,33 @@ static void __lfsck_set_speed(struct lfsck_instance *lfsck, __u32 limit)
 	}
 }
 
+static void __lfsck_set_speed(struct lfsck_instance *lfsck, __u32 limit)
+{
+	lfsck->li_bookmark_ram.lb_speed_limit = limit;
+	lfsck_set_sleep(lfsck, lfsck_speed_current(lfsck));
+}
+
+static void __lfsck_set_latency_target(struct lfsck_instance *lfsck,
+				       __u32 target)
+{
+	lfsck->li_bookmark_ram.lb_latency_target = target;
+	obd_scan_rate_init(&lfsck->li_scan_rate);
+	lfsck_set_sleep(lfsck, lfsck_speed_current(lfsck));
+}
+
 void lfsck_control_speed(struct lfsck_instance *lfsck)
 {
 	struct ptlrpc_thread *thread = &lfsck->li_thread;
 	struct l_wait_info    lwi;
 
+	if (lfsck->li_bookmark_ram.lb_latency_target != 0 &&
+	    obd_scan_rate_update(&lfsck->li_scan_rate,
+				 lfsck->li_bookmark_ram.lb_latency_target)) {
+		spin_lock(&lfsck->li_lock);
+		lfsck_set_sleep(lfsck, lfsck_speed_current(lfsck));
+		spin_unlock(&lfsck->li_lock);
+	}
+
 	if (lfsck->li_sleep_jif > 0 &&
 	    lfsck->li_new_scanned >= lfsck->li_sleep_rate) {
 		spin_lock(&lfsck->li_lock);
@@ -513,12 +566,12 @@ static int lfsck_needs_scan_dir(const struct lu_env *env,
 /* LFSCK wrap functions */
 
 void lfsck_fail(const struct lu_env *env, struct lfsck_instance *lfsck,
-		bool new_checked)
+		bool new_checked, const struct lfsck_position *pos)
 {
 	struct lfsck_component *com;
 
 	cfs_list_for_each_entry(com, &lfsck->li_list_scan, lc_link) {
-		com->lc_ops->lfsck_fail(env, com, new_checked);
+		com->lc_ops->lfsck_fail(env, com, new_checked, pos);
 	}
 }
 
@@ -532,6 +585,7 @@ int lfsck_checkpoint(const struct lu_env *env, struct lfsck_instance *lfsck)
 		return 0;
 
 	lfsck_pos_fill(env, lfsck, &lfsck->li_pos_current, false);
+	lfsck_workers_pos(lfsck, &lfsck->li_pos_current);
 	cfs_list_for_each_entry(com, &lfsck->li_list_scan, lc_link) {
 		rc = com->lc_ops->lfsck_checkpoint(env, com, false);
 		if (rc != 0)
@@ -559,6 +613,8 @@ int lfsck_prep(const struct lu_env *env, struct lfsck_instance *lfsck)
 	LASSERT(lfsck->li_obj_dir == NULL);
 	LASSERT(lfsck->li_di_dir == NULL);
 
+	obd_scan_rate_init(&lfsck->li_scan_rate);
+	lfsck_set_sleep(lfsck, lfsck_speed_current(lfsck));
 	lfsck->li_current_oit_processed = 0;
 	cfs_list_for_each_entry_safe(com, next, &lfsck->li_list_scan, lc_link) {
 		com->lc_new_checked = 0;
@@ -716,18 +772,19 @@ int lfsck_exec_oit(const struct lu_env *env, struct lfsck_instance *lfsck,
 
 out:
 	if (rc < 0)
-		lfsck_fail(env, lfsck, false);
+		lfsck_fail(env, lfsck, false, NULL);
 	return (rc > 0 ? 0 : rc);
 }
 
 int lfsck_exec_dir(const struct lu_env *env, struct lfsck_instance *lfsck,
-		   struct dt_object *obj, struct lu_dirent *ent)
+		   struct dt_object *dir, struct dt_object *obj,
+		   const struct lfsck_position *pos, struct lu_dirent *ent)
 {
 	struct lfsck_component *com;
 	int			rc;
 
 	cfs_list_for_each_entry(com, &lfsck->li_list_scan, lc_link) {
-		rc = com->lc_ops->lfsck_exec_dir(env, com, obj, ent);
+		rc = com->lc_ops->lfsck_exec_dir(env, com, dir, obj, pos, ent);
 		if (rc != 0)
 			return rc;
 	}
@@ -742,6 +799,7 @@ int lfsck_post(const struct lu_env *env, struct lfsck_instance *lfsck,
 	int			rc;
 
 	lfsck_pos_fill(env, lfsck, &lfsck->li_pos_current, false);
+	lfsck_workers_pos(lfsck, &lfsck->li_pos_current);
 	cfs_list_for_each_entry_safe(com, next, &lfsck->li_list_scan, lc_link) {
 		rc = com->lc_ops->lfsck_post(env, com, result, false);
 		if (rc != 0)
@@ -829,6 +887,62 @@ out:
 }
 EXPORT_SYMBOL(lfsck_set_speed);
 
+int lfsck_get_latency_target(struct dt_device *key, void *buf, int len)
+{
+	struct lu_env		env;
+	struct lfsck_instance  *lfsck;
+	int			rc;
+	ENTRY;
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (unlikely(lfsck == NULL))
+		RETURN(-ENODEV);
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	rc = snprintf(buf, len, "%u\n",
+		      lfsck->li_bookmark_ram.lb_latency_target);
+	lu_env_fini(&env);
+
+	GOTO(out, rc);
+
+out:
+	lfsck_instance_put(&env, lfsck);
+	return rc;
+}
+EXPORT_SYMBOL(lfsck_get_latency_target);
+
+int lfsck_set_latency_target(struct dt_device *key, int val)
+{
+	struct lu_env		env;
+	struct lfsck_instance  *lfsck;
+	int			rc;
+	ENTRY;
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (unlikely(lfsck == NULL))
+		RETURN(-ENODEV);
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	mutex_lock(&lfsck->li_mutex);
+	__lfsck_set_latency_target(lfsck, val);
+	rc = lfsck_bookmark_store(&env, lfsck);
+	mutex_unlock(&lfsck->li_mutex);
+	lu_env_fini(&env);
+
+	GOTO(out, rc);
+
+out:
+	lfsck_instance_put(&env, lfsck);
+	return rc;
+}
+EXPORT_SYMBOL(lfsck_set_latency_target);
+
 int lfsck_dump(struct dt_device *key, void *buf, int len, __u16 type)
 {
 	struct lu_env		env;
@@ -336,10 +336,9 @@ out:
 }
 
 static int lfsck_namespace_check_exist(const struct lu_env *env,
-				       struct lfsck_instance *lfsck,
+				       struct dt_object *dir,
 				       struct dt_object *obj, const char *name)
 {
-	struct dt_object *dir = lfsck->li_obj_dir;
 	struct lu_fid	 *fid = &lfsck_env_info(env)->lti_fid;
 	int		  rc;
 	ENTRY;
@@ -701,7 +700,7 @@ out:
 
 static void
 lfsck_namespace_fail(const struct lu_env *env, struct lfsck_component *com,
-		     bool new_checked)
+		     bool new_checked, const struct lfsck_position *pos)
 {
 	struct lfsck_namespace *ns = (struct lfsck_namespace *)com->lc_file_ram;
 
@@ -709,9 +708,13 @@ lfsck_namespace_fail(const struct lu_env *env, struct lfsck_component *com,
 	if (new_checked)
 		com->lc_new_checked++;
 	ns->ln_items_failed++;
-	if (lfsck_pos_is_zero(&ns->ln_pos_first_inconsistent))
-		lfsck_pos_fill(env, com->lc_lfsck,
-			       &ns->ln_pos_first_inconsistent, false);
+	if (lfsck_pos_is_zero(&ns->ln_pos_first_inconsistent)) {
+		if (pos != NULL)
+			ns->ln_pos_first_inconsistent = *pos;
+		else
+			lfsck_pos_fill(env, com->lc_lfsck,
+				       &ns->ln_pos_first_inconsistent, false);
+	}
 	up_write(&com->lc_sem);
 }
 
@@ -827,9 +830,14 @@ static int lfsck_namespace_exec_oit(const struct lu_env *env,
 	return 0;
 }
 
+/* Called by the master engine or by its workers: several name entries can
+ * be checked at the same time, but all the links to an object are checked
+ * by the same thread. com::lc_sem only covers the component fields. */
 static int lfsck_namespace_exec_dir(const struct lu_env *env,
 				    struct lfsck_component *com,
+				    struct dt_object *dir,
 				    struct dt_object *obj,
+				    const struct lfsck_position *pos,
 				    struct lu_dirent *ent)
 {
 	struct lfsck_thread_info   *info     = lfsck_env_info(env);
@@ -839,13 +847,15 @@ static int lfsck_namespace_exec_dir(const struct lu_env *env,
 	struct lfsck_namespace	   *ns	     =
 				(struct lfsck_namespace *)com->lc_file_ram;
 	struct linkea_data	    ldata    = { 0 };
-	const struct lu_fid	   *pfid     =
-				lu_object_fid(&lfsck->li_obj_dir->do_lu);
+	const struct lu_fid	   *pfid     = lfsck_dto2fid(dir);
 	const struct lu_fid	   *cfid     = lfsck_dto2fid(obj);
 	const struct lu_name	   *cname;
 	struct thandle		   *handle   = NULL;
+	__u32			    flags    = 0;
 	bool			    repaired = false;
+	bool			    mlinked  = false;
 	bool			    locked   = false;
+	bool			    journal;
 	bool			    remove;
 	bool			    newdata;
 	int			    count    = 0;
@@ -855,12 +865,14 @@ static int lfsck_namespace_exec_dir(const struct lu_env *env,
 	cname = lfsck_name_get_const(env, ent->lde_name, ent->lde_namelen);
 	down_write(&com->lc_sem);
 	com->lc_new_checked++;
+	journal = com->lc_journal;
+	up_write(&com->lc_sem);
 
 	if (ent->lde_attrs & LUDA_UPGRADE) {
-		ns->ln_flags |= LF_UPGRADE;
+		flags |= LF_UPGRADE;
 		repaired = true;
 	} else if (ent->lde_attrs & LUDA_REPAIR) {
-		ns->ln_flags |= LF_INCONSISTENT;
+		flags |= LF_INCONSISTENT;
 		repaired = true;
 	}
 
@@ -870,13 +882,12 @@ static int lfsck_namespace_exec_dir(const struct lu_env *env,
 	     fid_is_dot_lustre(&ent->lde_fid)))
 		GOTO(out, rc = 0);
 
-	if (!(bk->lb_param & LPF_DRYRUN) &&
-	    (com->lc_journal || repaired)) {
+	if (!(bk->lb_param & LPF_DRYRUN) && (journal || repaired)) {
 
 again:
 		LASSERT(!locked);
 
-		com->lc_journal = 1;
+		journal = true;
 		handle = dt_trans_create(env, lfsck->li_next);
 		if (IS_ERR(handle))
 			GOTO(out, rc = PTR_ERR(handle));
@@ -893,7 +904,7 @@ again:
 		locked = true;
 	}
 
-	rc = lfsck_namespace_check_exist(env, lfsck, obj, ent->lde_name);
+	rc = lfsck_namespace_check_exist(env, dir, obj, ent->lde_name);
 	if (rc != 0)
 		GOTO(stop, rc);
 
@@ -905,7 +916,7 @@ again:
 		    (count == 1 || !S_ISDIR(lfsck_object_type(obj))))
 			goto record;
 
-		ns->ln_flags |= LF_INCONSISTENT;
+		flags |= LF_INCONSISTENT;
 		/* For dir, if there are more than one linkea entries, or the
 		 * linkea entry does not match the name entry, then remove all
 		 * and add the correct one. */
@@ -919,7 +930,7 @@ again:
 		goto nodata;
 	} else if (unlikely(rc == -EINVAL)) {
 		count = 1;
-		ns->ln_flags |= LF_INCONSISTENT;
+		flags |= LF_INCONSISTENT;
 		/* The magic crashed, we are not sure whether there are more
 		 * corrupt data in the linkea, so remove all linkea entries. */
 		remove = true;
@@ -927,7 +938,7 @@ again:
 		goto nodata;
 	} else if (rc == -ENODATA) {
 		count = 1;
-		ns->ln_flags |= LF_UPGRADE;
+		flags |= LF_UPGRADE;
 		remove = false;
 		newdata = true;
 
@@ -937,7 +948,7 @@ nodata:
 			goto record;
 		}
 
-		if (!com->lc_journal)
+		if (!journal)
 			goto again;
 
 		if (remove) {
@@ -993,7 +1004,7 @@ record:
 		handle = NULL;
 	}
 
-	ns->ln_mlinked_checked++;
+	mlinked = true;
 	rc = lfsck_namespace_update(env, com, cfid,
 			count != la->la_nlink ? LLF_UNMATCH_NLINKS : 0, false);
 
@@ -1007,18 +1018,29 @@ stop:
 		dt_trans_stop(env, lfsck->li_next, handle);
 
 out:
+	down_write(&com->lc_sem);
+	ns->ln_flags |= flags;
+	if (mlinked)
+		ns->ln_mlinked_checked++;
 	if (rc < 0) {
+		com->lc_journal = journal;
 		ns->ln_items_failed++;
-		if (lfsck_pos_is_zero(&ns->ln_pos_first_inconsistent))
-			lfsck_pos_fill(env, lfsck,
-				       &ns->ln_pos_first_inconsistent, false);
+		if (lfsck_pos_is_zero(&ns->ln_pos_first_inconsistent)) {
+			if (pos != NULL)
+				ns->ln_pos_first_inconsistent = *pos;
+			else
+				lfsck_pos_fill(env, lfsck,
+					&ns->ln_pos_first_inconsistent, false);
+		}
 		if (!(bk->lb_param & LPF_FAILOUT))
 			rc = 0;
 	} else {
-		if (repaired)
+		if (repaired) {
+			com->lc_journal = journal;
 			ns->ln_items_repaired++;
-		else
+		} else {
 			com->lc_journal = 0;
+		}
 		rc = 0;
 	}
 	up_write(&com->lc_sem);
@@ -1227,6 +1249,10 @@ lfsck_namespace_dump(const struct lu_env *env, struct lfsck_component *com,
 		rc = lfsck_pos_dump(&buf, &len, &pos, "current_position");
 		if (rc <= 0)
 			goto out;
+
+		rc = lfsck_speed_dump(&buf, &len, lfsck);
+		if (rc <= 0)
+			goto out;
 	} else if (ns->ln_status == LS_SCANNING_PHASE2) {
 		cfs_duration_t duration = cfs_time_current() -
 					  lfsck->li_time_last_checkpoint;
@@ -1285,6 +1311,9 @@ lfsck_namespace_dump(const struct lu_env *env, struct lfsck_component *com,
 
 		buf += rc;
 		len -= rc;
+		rc = lfsck_speed_dump(&buf, &len, lfsck);
+		if (rc <= 0)
+			goto out;
 	} else {
 		__u64 speed1 = ns->ln_items_checked;
 		__u64 speed2 = ns->ln_objs_checked_phase2;
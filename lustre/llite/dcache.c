@@ -509,6 +509,10 @@ do_lock:
 
         if (!IS_POSIXACL(parent) || !exp_connect_umask(exp))
                 it->it_create_mode &= ~cfs_curproc_umask();
+	/* reopen of a file, its open handle may be worth caching */
+	if (it->it_op & IT_OPEN && de->d_inode != NULL &&
+	    ll_need_open_lock(de->d_inode))
+		it->it_flags |= MDS_OPEN_LOCK;
         it->it_create_mode |= M_CHECK_STALE;
         rc = md_intent_lock(exp, op_data, NULL, 0, it,
                             lookup_flags,
@@ -141,6 +141,173 @@
  */
 
 /* returns the page unlocked, but with a reference */
+/**
+ * Instantiate the inode and dentry of one readdir-plus entry.
+ *
+ * \a lda carries the attributes of the entry and the handle of the
+ * LOOKUP|UPDATE lock granted on it, its PR reference is dropped here.
+ */
+static void ll_readdir_plus_entry(struct inode *dir, struct dentry *parent,
+				  struct lu_dirent *ent,
+				  struct luda_attrs *lda, struct mdt_body *body)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(dir);
+	struct lustre_handle	 lockh = { .cookie = lda->lda_cookie };
+	__u64			 bits = MDS_INODELOCK_LOOKUP |
+					MDS_INODELOCK_UPDATE;
+	struct lustre_md	 md;
+	struct inode		*inode;
+	struct dentry		*dentry;
+	struct dentry		*alias;
+	struct qstr		 name;
+	__u32			 lmm_size;
+	int			 rc;
+	ENTRY;
+
+	memset(body, 0, sizeof(*body));
+	memset(&md, 0, sizeof(md));
+	fid_le_to_cpu(&body->fid1, &ent->lde_fid);
+	body->valid = le64_to_cpu(lda->lda_valid) | OBD_MD_FLID;
+	body->size = le64_to_cpu(lda->lda_size);
+	body->blocks = le64_to_cpu(lda->lda_blocks);
+	body->mtime = le64_to_cpu(lda->lda_mtime);
+	body->atime = le64_to_cpu(lda->lda_atime);
+	body->ctime = le64_to_cpu(lda->lda_ctime);
+	body->mode = le32_to_cpu(lda->lda_mode);
+	body->uid = le32_to_cpu(lda->lda_uid);
+	body->gid = le32_to_cpu(lda->lda_gid);
+	body->flags = le32_to_cpu(lda->lda_flags);
+	body->nlink = le32_to_cpu(lda->lda_nlink);
+	body->rdev = le32_to_cpu(lda->lda_rdev);
+	md.body = body;
+
+	if (!fid_is_sane(&body->fid1))
+		GOTO(out_lock, rc = -EPROTO);
+
+	lmm_size = le32_to_cpu(lda->lda_lmm_size);
+	if (lmm_size > 0) {
+		if (!S_ISREG(body->mode))
+			GOTO(out_lock, rc = -EPROTO);
+
+		rc = obd_unpackmd(sbi->ll_dt_exp, &md.lsm,
+				  (struct lov_mds_md *)(lda + 1), lmm_size);
+		if (rc < 0)
+			GOTO(out_lock, rc);
+		if (rc < sizeof(*md.lsm))
+			GOTO(out_lsm, rc = -EPROTO);
+		body->valid |= OBD_MD_FLEASIZE;
+		body->eadatasize = lmm_size;
+	}
+
+	inode = ll_iget(dir->i_sb, cl_fid_build_ino(&body->fid1,
+					sbi->ll_flags & LL_SBI_32BIT_API), &md);
+	if (inode == NULL || IS_ERR(inode))
+		GOTO(out_lsm, rc = inode == NULL ? -ENOMEM : PTR_ERR(inode));
+
+	md_set_lock_data(sbi->ll_md_exp, &lockh.cookie, inode, &bits);
+
+	if (parent == NULL || !(bits & MDS_INODELOCK_LOOKUP))
+		GOTO(out_inode, rc = 0);
+
+	name.name = (const unsigned char *)ent->lde_name;
+	name.len = le16_to_cpu(ent->lde_namelen);
+	name.hash = full_name_hash(name.name, name.len);
+	dentry = d_lookup(parent, &name);
+	if (dentry != NULL) {
+		/* a lookup got here first, only revalidate a matching
+		 * dentry */
+		if (dentry->d_inode == inode && ll_d2d(dentry) != NULL)
+			d_lustre_revalidate(dentry);
+		dput(dentry);
+		GOTO(out_inode, rc = 0);
+	}
+
+	dentry = d_alloc(parent, &name);
+	if (dentry == NULL)
+		GOTO(out_inode, rc = -ENOMEM);
+
+	/* ll_splice_alias() takes over the inode reference, a racing
+	 * lookup finds this dentry in ll_find_alias() */
+	alias = ll_splice_alias(inode, dentry);
+	d_lustre_revalidate(alias);
+	if (alias != dentry)
+		dput(alias);
+	dput(dentry);
+	GOTO(out_lsm, rc = 0);
+
+out_inode:
+	iput(inode);
+out_lsm:
+	if (md.lsm != NULL)
+		obd_free_memmd(sbi->ll_dt_exp, &md.lsm);
+out_lock:
+	if (rc != 0)
+		CDEBUG(D_READA, "%s: skip readdir-plus entry "DFID": rc = %d\n",
+		       ll_get_fsname(dir->i_sb, NULL, 0), PFID(&body->fid1),
+		       rc);
+	ldlm_lock_decref(&lockh, LCK_PR);
+}
+
+/**
+ * Consume the entry attributes and locks of the readdir-plus pages just
+ * read, see mdc_readpage(). Every entry with lda_valid set holds a lock
+ * reference which has to be dropped.
+ */
+static void ll_readdir_plus(struct inode *dir, struct page **pages,
+			    int npages)
+{
+	struct mdt_body	*body;
+	struct dentry	*parent;
+	int		 locked = 0;
+	int		 i;
+	ENTRY;
+
+	OBD_ALLOC_PTR(body);
+	/* dentries are only instantiated under the i_mutex of @dir: the VFS
+	 * holds it for ll_readdir(), the statahead threads have to take it.
+	 * Called with a directory page locked, so never wait for it, just
+	 * leave the dentries to the next lookup if it is busy. */
+	parent = d_find_alias(dir);
+	if (parent != NULL && ll_i2info(dir)->lli_readdir_owner != current) {
+		locked = mutex_trylock(&dir->i_mutex);
+		if (!locked) {
+			dput(parent);
+			parent = NULL;
+		}
+	}
+	for (i = 0; i < npages; i++) {
+		struct lu_dirpage	*dp = kmap(pages[i]);
+		struct lu_dirent	*ent;
+
+		for (ent = lu_dirent_start(dp); ent != NULL;
+		     ent = lu_dirent_next(ent)) {
+			struct luda_attrs *lda = lu_dirent_attrs(ent);
+
+			if (lda == NULL || lda->lda_valid == 0)
+				continue;
+
+			if (body != NULL) {
+				ll_readdir_plus_entry(dir, parent, ent, lda,
+						      body);
+			} else {
+				struct lustre_handle lockh = {
+					.cookie = lda->lda_cookie };
+
+				ldlm_lock_decref(&lockh, LCK_PR);
+			}
+			lda->lda_valid = 0;
+		}
+		kunmap(pages[i]);
+	}
+	if (locked)
+		mutex_unlock(&dir->i_mutex);
+	if (parent != NULL)
+		dput(parent);
+	if (body != NULL)
+		OBD_FREE_PTR(body);
+	EXIT;
+}
+
 static int ll_dir_filler(void *_hash, struct page *page0)
 {
         struct inode *inode = page0->mapping->host;
@@ -186,8 +353,11 @@ static int ll_dir_filler(void *_hash, struct page *page0)
                                      LUSTRE_OPC_ANY, NULL);
         op_data->op_npages = npages;
         op_data->op_offset = hash;
+	if (ll_i2sbi(inode)->ll_flags & LL_SBI_READDIR_PLUS) {
+		op_data->op_cli_flags |= CLI_READDIR_PLUS;
+		op_data->op_cb_blocking = ll_md_blocking_ast;
+	}
         rc = md_readpage(exp, op_data, page_pool, &request);
-        ll_finish_md_op_data(op_data);
         if (rc == 0) {
                 body = req_capsule_server_get(&request->rq_pill, &RMF_MDT_BODY);
                 /* Checked by mdc_readpage() */
@@ -198,8 +368,11 @@ static int ll_dir_filler(void *_hash, struct page *page0)
 
 		nrdpgs = (request->rq_bulk->bd_nob_transferred +
 			  PAGE_CACHE_SIZE - 1) >> PAGE_CACHE_SHIFT;
+		if (op_data->op_cli_flags & CLI_READDIR_PLUS)
+			ll_readdir_plus(inode, page_pool, nrdpgs);
                 SetPageUptodate(page0);
         }
+        ll_finish_md_op_data(op_data);
         unlock_page(page0);
         ptlrpc_req_finished(request);
 
@@ -338,6 +511,28 @@ static struct page *ll_dir_page_locate(struct inode *dir, __u64 *hash,
         return page;
 }
 
+/**
+ * Return the cached page of \a dir containing \a hash as ll_get_dir_page()
+ * does, or NULL if it is not cached or the directory is being read. Never
+ * sends an RPC: the pages are dropped when the UPDATE lock of \a dir is
+ * cancelled, so a cached page is valid.
+ */
+struct page *ll_get_dir_page_cached(struct inode *dir, __u64 hash)
+{
+	struct ll_inode_info	*lli = ll_i2info(dir);
+	struct page		*page;
+	__u64			 lhash = hash;
+	__u64			 start = 0;
+	__u64			 end = 0;
+
+	if (!mutex_trylock(&lli->lli_readdir_mutex))
+		return NULL;
+	page = ll_dir_page_locate(dir, &lhash, &start, &end);
+	mutex_unlock(&lli->lli_readdir_mutex);
+
+	return IS_ERR(page) ? NULL : page;
+}
+
 struct page *ll_get_dir_page(struct inode *dir, __u64 hash,
                              struct ll_dir_chain *chain)
 {
@@ -482,6 +677,220 @@ fail:
         goto out_unlock;
 }
 
+/*
+ * Readdir of a striped directory.
+ *
+ * The entries of a striped directory live in its shards, each one read
+ * a page at a time into a private page, and they are returned merged in
+ * hash order so the hash of the next entry still works as the directory
+ * offset. The master itself only adds "." and "..", the shard entries it
+ * holds are hidden.
+ */
+struct ll_dir_stream {
+	struct lu_fid		 lds_fid;
+	struct page		*lds_page;
+	struct lu_dirent	*lds_ent;	/* next entry, NULL at the end */
+	__u64			 lds_next;	/* hash of the next page */
+	int			 lds_shard;	/* is this a shard? */
+};
+
+static int ll_dir_stream_skip(struct lmv_stripe_md *mea,
+			      struct ll_dir_stream *s, struct lu_dirent *ent,
+			      __u64 pos)
+{
+	int		namelen = le16_to_cpu(ent->lde_namelen);
+	struct lu_fid	fid;
+	int		i;
+
+	if (le64_to_cpu(ent->lde_hash) < pos || namelen == 0)
+		return 1;
+
+	if (s->lds_shard)
+		return (namelen == 1 && ent->lde_name[0] == '.') ||
+		       (namelen == 2 && ent->lde_name[0] == '.' &&
+			ent->lde_name[1] == '.');
+
+	fid_le_to_cpu(&fid, &ent->lde_fid);
+	for (i = 0; i < mea->mea_count; i++)
+		if (lu_fid_eq(&fid, &mea->mea_ids[i]))
+			return 1;
+	return 0;
+}
+
+/* read the page of stream \a s at \a pos and find its first entry */
+static int ll_dir_stream_fill(struct inode *dir, struct ll_dir_stream *s,
+			      __u64 pos)
+{
+	struct lmv_stripe_md	*mea = ll_i2info(dir)->lli_lmv;
+	struct ptlrpc_request	*request = NULL;
+	struct md_op_data	*op_data;
+	struct lu_dirpage	*dp;
+	struct lu_dirent	*ent;
+	int			 rc;
+
+	for (;;) {
+		op_data = ll_prep_md_op_data(NULL, dir, NULL, NULL, 0, 0,
+					     LUSTRE_OPC_ANY, NULL);
+		if (IS_ERR(op_data))
+			return PTR_ERR(op_data);
+
+		op_data->op_fid1 = s->lds_fid;
+		op_data->op_mea1 = NULL;
+		op_data->op_npages = 1;
+		op_data->op_offset = pos;
+		rc = md_readpage(ll_i2sbi(dir)->ll_md_exp, op_data,
+				 &s->lds_page, &request);
+		ll_finish_md_op_data(op_data);
+		ptlrpc_req_finished(request);
+		request = NULL;
+		if (rc != 0)
+			return rc;
+
+		dp = page_address(s->lds_page);
+		s->lds_next = le64_to_cpu(dp->ldp_hash_end);
+		for (ent = lu_dirent_start(dp); ent != NULL;
+		     ent = lu_dirent_next(ent)) {
+			if (!ll_dir_stream_skip(mea, s, ent, pos)) {
+				s->lds_ent = ent;
+				return 0;
+			}
+		}
+
+		if (s->lds_next == MDS_DIR_END_OFF) {
+			s->lds_ent = NULL;
+			return 0;
+		}
+		pos = s->lds_next;
+	}
+}
+
+static int ll_dir_stream_next(struct inode *dir, struct ll_dir_stream *s)
+{
+	struct lmv_stripe_md	*mea = ll_i2info(dir)->lli_lmv;
+	struct lu_dirent	*ent;
+
+	for (ent = lu_dirent_next(s->lds_ent); ent != NULL;
+	     ent = lu_dirent_next(ent)) {
+		if (!ll_dir_stream_skip(mea, s, ent, 0)) {
+			s->lds_ent = ent;
+			return 0;
+		}
+	}
+
+	s->lds_ent = NULL;
+	if (s->lds_next == MDS_DIR_END_OFF)
+		return 0;
+	return ll_dir_stream_fill(dir, s, s->lds_next);
+}
+
+static void ll_dir_streams_fini(struct ll_dir_stream *streams, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (streams[i].lds_page != NULL)
+			__free_page(streams[i].lds_page);
+	OBD_FREE(streams, sizeof(*streams) * count);
+}
+
+static struct ll_dir_stream *ll_dir_streams_init(struct inode *dir,
+						 int count)
+{
+	struct lmv_stripe_md	*mea = ll_i2info(dir)->lli_lmv;
+	struct ll_dir_stream	*streams;
+	int			 i;
+
+	OBD_ALLOC(streams, sizeof(*streams) * count);
+	if (streams == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		streams[i].lds_page = alloc_page(GFP_KERNEL);
+		if (streams[i].lds_page == NULL) {
+			ll_dir_streams_fini(streams, count);
+			return ERR_PTR(-ENOMEM);
+		}
+		if (i == 0) {
+			streams[i].lds_fid = *ll_inode2fid(dir);
+		} else {
+			streams[i].lds_fid = mea->mea_ids[i - 1];
+			streams[i].lds_shard = 1;
+		}
+	}
+	return streams;
+}
+
+static int ll_dir_read_striped(struct inode *dir, __u64 *_pos, void *cookie,
+			       filldir_t filldir)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(dir);
+	struct lmv_stripe_md	*mea = ll_i2info(dir)->lli_lmv;
+	int			 api32 = ll_need_32bit_api(sbi);
+	int			 hash64 = sbi->ll_flags & LL_SBI_64BIT_HASH;
+	int			 count = mea->mea_count + 1;
+	struct ll_dir_stream	*streams;
+	__u64			 pos = *_pos;
+	int			 done = 0;
+	int			 rc = 0;
+	int			 i;
+	ENTRY;
+
+	streams = ll_dir_streams_init(dir, count);
+	if (IS_ERR(streams))
+		RETURN(PTR_ERR(streams));
+
+	for (i = 0; i < count && rc == 0; i++)
+		rc = ll_dir_stream_fill(dir, &streams[i], pos);
+
+	while (rc == 0) {
+		struct ll_dir_stream	*best = NULL;
+		struct lu_dirent	*ent;
+		struct lu_fid		 fid;
+		__u64			 hash;
+		__u64			 lhash;
+
+		/* the lowest hash, the first stream on a tie */
+		for (i = 0; i < count; i++) {
+			if (streams[i].lds_ent == NULL)
+				continue;
+			if (best == NULL ||
+			    le64_to_cpu(streams[i].lds_ent->lde_hash) <
+			    le64_to_cpu(best->lds_ent->lde_hash))
+				best = &streams[i];
+		}
+		if (best == NULL) {
+			pos = MDS_DIR_END_OFF;
+			break;
+		}
+
+		ent = best->lds_ent;
+		hash = le64_to_cpu(ent->lde_hash);
+		if (api32 && hash64)
+			lhash = hash >> 32;
+		else
+			lhash = hash;
+		fid_le_to_cpu(&fid, &ent->lde_fid);
+		done = filldir(cookie, ent->lde_name,
+			       le16_to_cpu(ent->lde_namelen), lhash,
+			       cl_fid_build_ino(&fid, api32),
+			       ll_dirent_type_get(ent));
+		if (done) {
+			pos = hash;
+			break;
+		}
+		rc = ll_dir_stream_next(dir, best);
+	}
+
+	if (rc != 0)
+		CERROR("%s: error reading striped dir "DFID" at "LPX64
+		       ": rc = %d\n", ll_get_fsname(dir->i_sb, NULL, 0),
+		       PFID(ll_inode2fid(dir)), pos, rc);
+	else
+		*_pos = pos;
+	ll_dir_streams_fini(streams, count);
+	RETURN(rc);
+}
+
 int ll_dir_read(struct inode *inode, __u64 *_pos, void *cookie,
 		filldir_t filldir)
 {
@@ -496,6 +905,9 @@ int ll_dir_read(struct inode *inode, __u64 *_pos, void *cookie,
 	int                   rc = 0;
         ENTRY;
 
+	if (info->lli_lmv != NULL)
+		RETURN(ll_dir_read_striped(inode, _pos, cookie, filldir));
+
         ll_dir_chain_init(&chain);
 
 	page = ll_get_dir_page(inode, pos, &chain);
@@ -622,7 +1034,9 @@ static int ll_readdir(struct file *filp, void *cookie, filldir_t filldir)
 		 */
 		GOTO(out, rc = 0);
 
+	ll_i2info(inode)->lli_readdir_owner = current;
 	rc = ll_dir_read(inode, &pos, cookie, filldir);
+	ll_i2info(inode)->lli_readdir_owner = NULL;
 	lfd->lfd_pos = pos;
         if (pos == MDS_DIR_END_OFF) {
                 if (api32)
@@ -877,9 +1291,9 @@ out:
 }
 
 /*
- *  Get MDT index for the inode.
+ *  Get MDT index for the object \a fid of the filesystem of \a inode.
  */
-int ll_get_mdt_idx(struct inode *inode)
+static int ll_get_mdt_idx_by_fid(struct inode *inode, const struct lu_fid *fid)
 {
         struct ll_sb_info *sbi = ll_i2sbi(inode);
         struct md_op_data *op_data;
@@ -891,6 +1305,7 @@ int ll_get_mdt_idx(struct inode *inode)
         if (IS_ERR(op_data))
                 RETURN(PTR_ERR(op_data));
 
+	op_data->op_fid1 = *fid;
 	op_data->op_flags |= MF_GET_MDT_IDX;
         rc = md_getattr(sbi->ll_md_exp, op_data, NULL);
         mdtidx = op_data->op_mds;
@@ -902,6 +1317,14 @@ int ll_get_mdt_idx(struct inode *inode)
         return mdtidx;
 }
 
+/*
+ *  Get MDT index for the inode.
+ */
+int ll_get_mdt_idx(struct inode *inode)
+{
+	return ll_get_mdt_idx_by_fid(inode, ll_inode2fid(inode));
+}
+
 /**
  * Generic handler to do any pre-copy work.
  *
@@ -1403,11 +1826,14 @@ lmv_out_free:
         }
 	case LL_IOC_LMV_GETSTRIPE: {
 		struct lmv_user_md *lump = (struct lmv_user_md *)arg;
+		struct lmv_stripe_md *mea = ll_i2info(inode)->lli_lmv;
 		struct lmv_user_md lum;
-		struct lmv_user_md *tmp;
+		struct lmv_user_md *tmp = NULL;
+		int stripe_count;
 		int lum_size;
 		int rc = 0;
 		int mdtindex;
+		int i;
 
 		if (copy_from_user(&lum, lump, sizeof(struct lmv_user_md)))
 			RETURN(-EFAULT);
@@ -1415,22 +1841,39 @@ lmv_out_free:
 		if (lum.lum_magic != LMV_MAGIC_V1)
 			RETURN(-EINVAL);
 
-		lum_size = lmv_user_md_size(1, LMV_MAGIC_V1);
+		/* lum_stripe_count is the room for stripes the caller has */
+		stripe_count = mea != NULL ? mea->mea_count : 1;
+		if (lum.lum_stripe_count == 0)
+			lum.lum_stripe_count = 1;
+		if (stripe_count > lum.lum_stripe_count)
+			RETURN(-E2BIG);
+
+		lum_size = lmv_user_md_size(stripe_count, LMV_MAGIC_V1);
 		OBD_ALLOC(tmp, lum_size);
 		if (tmp == NULL)
 			GOTO(free_lmv, rc = -ENOMEM);
 
 		memcpy(tmp, &lum, sizeof(lum));
 		tmp->lum_type = LMV_STRIPE_TYPE;
-		tmp->lum_stripe_count = 1;
+		tmp->lum_stripe_count = stripe_count;
 		mdtindex = ll_get_mdt_idx(inode);
 		if (mdtindex < 0)
 			GOTO(free_lmv, rc = -ENOMEM);
 
 		tmp->lum_stripe_offset = mdtindex;
 		tmp->lum_objects[0].lum_mds = mdtindex;
-		memcpy(&tmp->lum_objects[0].lum_fid, ll_inode2fid(inode),
-		       sizeof(struct lu_fid));
+		tmp->lum_objects[0].lum_fid = *ll_inode2fid(inode);
+
+		/* a striped directory lists its shards */
+		for (i = 0; mea != NULL && i < stripe_count; i++) {
+			mdtindex = ll_get_mdt_idx_by_fid(inode,
+							 &mea->mea_ids[i]);
+			if (mdtindex < 0)
+				GOTO(free_lmv, rc = mdtindex);
+			tmp->lum_objects[i].lum_mds = mdtindex;
+			tmp->lum_objects[i].lum_fid = mea->mea_ids[i];
+		}
+		tmp->lum_stripe_offset = tmp->lum_objects[0].lum_mds;
 		if (copy_to_user((void *)arg, tmp, lum_size))
 			GOTO(free_lmv, rc = -EFAULT);
 free_lmv:
@@ -1465,6 +1908,9 @@ out_rmdir:
                         ll_putname(filename);
 		RETURN(rc);
 	}
+	case LL_IOC_UNLINK_BATCH:
+		RETURN(ll_unlink_batch(inode,
+				       (struct ll_unlink_batch __user *)arg));
 	case LL_IOC_LOV_SWAP_LAYOUTS:
 		RETURN(-EPERM);
         case LL_IOC_OBD_STATFS:
@@ -45,6 +45,7 @@
 #include <lustre_lite.h>
 #include <linux/pagemap.h>
 #include <linux/file.h>
+#include <linux/falloc.h>
 #include "llite_internal.h"
 #include <lustre/ll_fiemap.h>
 
@@ -164,12 +165,14 @@ static int ll_close_inode_openhandle(struct obd_export *md_exp,
         }
 
 	/* DATA_MODIFIED flag was successfully sent on close, cancel data
-	 * modification flag. */
+	 * modification flag. The lazy size got before is out of date. */
 	if (rc == 0 && (op_data->op_bias & MDS_DATA_MODIFIED)) {
 		struct ll_inode_info *lli = ll_i2info(inode);
 
 		spin_lock(&lli->lli_lock);
 		lli->lli_flags &= ~LLIF_DATA_MODIFIED;
+		if (S_ISREG(inode->i_mode))
+			lli->lli_lazy_stamp = 0;
 		spin_unlock(&lli->lli_lock);
 	}
 
@@ -239,6 +242,55 @@ int ll_md_real_close(struct inode *inode, int flags)
         RETURN(rc);
 }
 
+static inline cfs_duration_t ll_oc_thrsh(struct ll_sb_info *sbi)
+{
+	return cfs_time_seconds(sbi->ll_oc_thrsh_ms / 1000) +
+	       cfs_time_seconds(sbi->ll_oc_thrsh_ms % 1000) / 1000;
+}
+
+/**
+ * Whether an open of \a inode should ask the MDS for an OPEN lock. With the
+ * lock granted, ll_md_close() keeps the open handle cached instead of closing
+ * it on the MDS, and the next opens in the same mode are served locally until
+ * the lock is cancelled, by a conflicting access or by the LRU under memory
+ * pressure. It is asked for the files opened ll_oc_thrsh_count times in a
+ * row, each open within ll_oc_thrsh_ms of the previous one.
+ */
+int ll_need_open_lock(struct inode *inode)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	unsigned int		 count;
+
+	if (sbi->ll_oc_thrsh_count == 0 || !S_ISREG(inode->i_mode))
+		return 0;
+
+	/* this open counts as well */
+	count = 1;
+	if (lli->lli_oc_count != 0 &&
+	    cfs_time_before(cfs_time_current(),
+			    cfs_time_add(lli->lli_oc_time, ll_oc_thrsh(sbi))))
+		count += lli->lli_oc_count;
+
+	return count >= sbi->ll_oc_thrsh_count;
+}
+
+/* account an open of \a inode for ll_need_open_lock(), under lli_och_mutex */
+static void ll_oc_open(struct inode *inode)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	cfs_time_t		 now = cfs_time_current();
+
+	if (lli->lli_oc_count != 0 &&
+	    cfs_time_before(now, cfs_time_add(lli->lli_oc_time,
+					      ll_oc_thrsh(sbi))))
+		lli->lli_oc_count++;
+	else
+		lli->lli_oc_count = 1;
+	lli->lli_oc_time = now;
+}
+
 int ll_md_close(struct obd_export *md_exp, struct inode *inode,
                 struct file *file)
 {
@@ -381,7 +433,8 @@ static int ll_intent_file_open(struct file *file, void *lmm,
         /* If lmmsize & lmm are not 0, we are just setting stripe info
          * parameters. No need for the open lock */
         if (lmm == NULL && lmmsize == 0) {
-                itp->it_flags |= MDS_OPEN_LOCK;
+		if (ll_need_open_lock(file->f_dentry->d_inode))
+			itp->it_flags |= MDS_OPEN_LOCK;
                 if (itp->it_flags & FMODE_WRITE)
                         opc = LUSTRE_OPC_CREATE;
         }
@@ -648,6 +701,8 @@ restart:
                 if (rc)
                         GOTO(out_och_free, rc);
         }
+	if (S_ISREG(inode->i_mode))
+		ll_oc_open(inode);
 	mutex_unlock(&lli->lli_och_mutex);
         fd = NULL;
 
@@ -855,6 +910,195 @@ void ll_io_init(struct cl_io *io, const struct file *file, int write)
         }
 }
 
+/**
+ * Return the maximum size of a Data-on-MDT file, or 0 if \a inode is not
+ * a DoM file.
+ */
+__u32 ll_dom_stripesize(struct inode *inode)
+{
+	struct lov_stripe_md	*lsm;
+	__u32			 size = 0;
+
+	lsm = ccc_inode_lsm_get(inode);
+	if (lsm != NULL && lsm_is_dom(lsm))
+		size = lsm->lsm_stripe_size;
+	ccc_inode_lsm_put(inode, lsm);
+	return size;
+}
+
+/* copy \a nob bytes between \a pages and the user iovec at (\a seg,
+ * \a seg_off), advancing the iovec cursor */
+static int ll_dom_copy(struct page **pages, size_t nob,
+		       const struct iovec *iov, unsigned long nrsegs,
+		       unsigned long *seg, size_t *seg_off, int write)
+{
+	size_t done = 0;
+
+	while (done < nob) {
+		struct page	*page = pages[done >> PAGE_CACHE_SHIFT];
+		size_t		 poff = done & ~CFS_PAGE_MASK;
+		size_t		 len;
+		char		*addr;
+		int		 rc;
+
+		LASSERT(*seg < nrsegs);
+		len = min_t(size_t, nob - done, PAGE_CACHE_SIZE - poff);
+		len = min_t(size_t, len, iov[*seg].iov_len - *seg_off);
+
+		addr = kmap(page) + poff;
+		if (write)
+			rc = copy_from_user(addr,
+					    iov[*seg].iov_base + *seg_off, len);
+		else
+			rc = copy_to_user(iov[*seg].iov_base + *seg_off,
+					  addr, len);
+		kunmap(page);
+		if (rc != 0)
+			return -EFAULT;
+
+		done += len;
+		*seg_off += len;
+		if (*seg_off == iov[*seg].iov_len) {
+			(*seg)++;
+			*seg_off = 0;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Read or write a Data-on-MDT file.
+ *
+ * The body of a DoM file lives in the MDT inode and is bounded by its
+ * layout stripe size (\a maxsize), so the IO is done synchronously and
+ * uncached through the MDC in chunks of ll_md_brw_size, bypassing the
+ * cl_io stack which has no objects to work with.
+ */
+static ssize_t ll_dom_io(struct file *file, struct vvp_io_args *args,
+			 enum cl_io_type iot, loff_t *ppos, size_t count,
+			 __u32 maxsize)
+{
+	struct inode		*inode = file->f_dentry->d_inode;
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	const struct iovec	*iov = args->u.normal.via_iov;
+	unsigned long		 nrsegs = args->u.normal.via_nrsegs;
+	unsigned long		 seg = 0;
+	size_t			 seg_off = 0;
+	int			 rw = iot == CIT_WRITE ? OBD_BRW_WRITE :
+							 OBD_BRW_READ;
+	int			 npages;
+	struct page		**pages;
+	struct md_op_data	*op_data;
+	struct ptlrpc_request	*req;
+	struct mdt_body		*body;
+	loff_t			 pos = *ppos;
+	ssize_t			 done = 0;
+	int			 i;
+	int			 rc = 0;
+	ENTRY;
+
+	if (rw == OBD_BRW_WRITE) {
+		if (mutex_lock_interruptible(&lli->lli_write_mutex))
+			RETURN(-ERESTARTSYS);
+		if (file->f_flags & O_APPEND) {
+			/* fetch the current size from the MDT */
+			rc = __ll_inode_revalidate_it(file->f_dentry, NULL,
+						      MDS_INODELOCK_UPDATE);
+			if (rc)
+				GOTO(out_unlock, rc);
+			pos = i_size_read(inode);
+		}
+		if (pos >= maxsize)
+			GOTO(out_unlock, rc = -EFBIG);
+		count = min_t(loff_t, count, maxsize - pos);
+	} else {
+		down_read(&lli->lli_trunc_sem);
+		if (pos >= maxsize)
+			GOTO(out_unlock, rc = 0);
+		count = min_t(loff_t, count, maxsize - pos);
+	}
+
+	npages = min_t(int, sbi->ll_md_brw_size >> PAGE_CACHE_SHIFT,
+		       (count + PAGE_CACHE_SIZE - 1) >> PAGE_CACHE_SHIFT);
+	if (npages == 0)
+		GOTO(out_unlock, rc = 0);
+
+	OBD_ALLOC(pages, npages * sizeof(*pages));
+	if (pages == NULL)
+		GOTO(out_unlock, rc = -ENOMEM);
+
+	for (i = 0; i < npages; i++) {
+		pages[i] = alloc_page(GFP_IOFS);
+		if (pages[i] == NULL)
+			GOTO(out_pages, rc = -ENOMEM);
+	}
+
+	op_data = ll_prep_md_op_data(NULL, inode, NULL, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, NULL);
+	if (IS_ERR(op_data))
+		GOTO(out_pages, rc = PTR_ERR(op_data));
+
+	while (count > 0) {
+		size_t chunk = min_t(size_t, count,
+				     npages << PAGE_CACHE_SHIFT);
+
+		if (rw == OBD_BRW_WRITE) {
+			rc = ll_dom_copy(pages, chunk, iov, nrsegs, &seg,
+					 &seg_off, 1);
+			if (rc)
+				break;
+		}
+
+		op_data->op_offset = pos;
+		op_data->op_count = chunk;
+		op_data->op_npages = npages;
+		rc = md_dom_rw(sbi->ll_md_exp, op_data, pages, rw, &req);
+		if (rc <= 0)
+			break;
+
+		body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+		if (rw == OBD_BRW_WRITE && body != NULL &&
+		    body->valid & OBD_MD_FLSIZE)
+			cl_isize_write(inode, body->size);
+		ptlrpc_req_finished(req);
+
+		if (rw == OBD_BRW_READ) {
+			int nob = rc;
+
+			rc = ll_dom_copy(pages, nob, iov, nrsegs, &seg,
+					 &seg_off, 0);
+			if (rc)
+				break;
+			rc = nob;
+		}
+
+		pos += rc;
+		done += rc;
+		count -= rc;
+		if (rc < chunk) /* short read at EOF */
+			break;
+	}
+	ll_finish_md_op_data(op_data);
+
+	if (done > 0) {
+		*ppos = pos;
+		rc = done;
+	}
+	EXIT;
+out_pages:
+	for (i = 0; i < npages; i++)
+		if (pages[i] != NULL)
+			__free_page(pages[i]);
+	OBD_FREE(pages, npages * sizeof(*pages));
+out_unlock:
+	if (rw == OBD_BRW_WRITE)
+		mutex_unlock(&lli->lli_write_mutex);
+	else
+		up_read(&lli->lli_trunc_sem);
+	return rc;
+}
+
 static ssize_t
 ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 		   struct file *file, enum cl_io_type iot,
@@ -864,8 +1108,17 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 	struct ll_file_data  *fd  = LUSTRE_FPRIVATE(file);
         struct cl_io         *io;
         ssize_t               result;
+	__u32		      dom_size;
         ENTRY;
 
+	dom_size = ll_dom_stripesize(file->f_dentry->d_inode);
+	if (dom_size != 0) {
+		if (args->via_io_subtype != IO_NORMAL)
+			RETURN(-EOPNOTSUPP);
+		result = ll_dom_io(file, args, iot, ppos, count, dom_size);
+		goto stats;
+	}
+
 restart:
         io = ccc_env_thread_io(env);
         ll_io_init(io, file, iot == CIT_WRITE);
@@ -935,6 +1188,7 @@ out:
 		goto restart;
 	}
 
+stats:
         if (iot == CIT_READ) {
                 if (result >= 0)
                         ll_stats_ops_tally(ll_i2sbi(file->f_dentry->d_inode),
@@ -2129,6 +2383,21 @@ long ll_file_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 	}
 	case OBD_IOC_FID2PATH:
 		RETURN(ll_fid2path(inode, (void *)arg));
+	case LL_IOC_LAZYSTAT: {
+		struct ioc_lazystat	ils;
+		int			rc;
+
+		if (copy_from_user(&ils, (char *)arg, sizeof(ils)))
+			RETURN(-EFAULT);
+
+		rc = ll_lazystat(inode, &ils);
+		if (rc == 0 && copy_to_user((char *)arg, &ils, sizeof(ils)))
+			RETURN(-EFAULT);
+
+		RETURN(rc);
+	}
+	case LL_IOC_SOM_SYNC:
+		RETURN(ll_som_sync(inode));
 	case LL_IOC_DATA_VERSION: {
 		struct ioc_data_version	idv;
 		int			rc;
@@ -2509,6 +2778,57 @@ int ll_fsync(struct file *file, struct dentry *dentry, int datasync)
 	RETURN(rc);
 }
 
+#if defined(HAVE_FILE_FALLOCATE) || defined(HAVE_INODE_FALLOCATE)
+/*
+ * Preallocate the blocks of the range on the OSTs. Only plain allocation
+ * is supported, with or without FALLOC_FL_KEEP_SIZE.
+ */
+static long ll_do_fallocate(struct inode *inode, int mode, loff_t offset,
+			    loff_t len)
+{
+	struct obd_capa	*capa;
+	int		 ost_mode = 0;
+	long		 rc;
+	ENTRY;
+
+	CDEBUG(D_VFSTRACE, "VFS Op:inode=%lu/%u(%p), mode %#x, offset "
+	       "%lld, len %lld\n", inode->i_ino, inode->i_generation, inode,
+	       mode, offset, len);
+
+	if (mode & ~FALLOC_FL_KEEP_SIZE)
+		RETURN(-EOPNOTSUPP);
+	if (mode & FALLOC_FL_KEEP_SIZE)
+		ost_mode |= OST_FALLOC_KEEP_SIZE;
+
+	if (offset < 0 || len <= 0)
+		RETURN(-EINVAL);
+	if (offset + len < offset || offset + len > ll_file_maxbytes(inode))
+		RETURN(-EFBIG);
+
+	ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_FALLOCATE, 1);
+
+	capa = ll_osscapa_get(inode, CAPA_OPC_OSS_WRITE);
+	rc = cl_falloc(inode, ost_mode, offset, len, capa);
+	capa_put(capa);
+
+	RETURN(rc);
+}
+
+#ifdef HAVE_FILE_FALLOCATE
+static long ll_fallocate(struct file *file, int mode, loff_t offset,
+			 loff_t len)
+{
+	return ll_do_fallocate(file->f_dentry->d_inode, mode, offset, len);
+}
+#else
+static long ll_fallocate(struct inode *inode, int mode, loff_t offset,
+			 loff_t len)
+{
+	return ll_do_fallocate(inode, mode, offset, len);
+}
+#endif
+#endif
+
 int ll_file_flock(struct file *file, int cmd, struct file_lock *file_lock)
 {
 	struct inode *inode = file->f_dentry->d_inode;
@@ -2733,6 +3053,40 @@ static int ll_inode_revalidate_fini(struct inode *inode, int rc)
 	return rc;
 }
 
+/**
+ * Get the lazy size-on-MDT of \a inode fetched with its attributes, if it
+ * is recent enough and this client did not change the file data since.
+ *
+ * \param age	set to the seconds since the MDT updated the lazy size
+ *
+ * \retval 1	\a size, \a blocks and \a age are set
+ * \retval 0	there is no usable lazy size, the OSTs must be glimpsed
+ */
+static int ll_lazy_size_get(struct inode *inode, __u64 *size, __u64 *blocks,
+			    __u64 *age)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	cfs_time_t		 expiry;
+	obd_time		 now = cfs_time_current_sec();
+	int			 rc = 0;
+
+	spin_lock(&lli->lli_lock);
+	expiry = cfs_time_add(lli->lli_lazy_stamp,
+		      cfs_time_seconds(ll_i2sbi(inode)->ll_lazy_size_max_age));
+	if (lli->lli_lazy_stamp != 0 &&
+	    cfs_time_before(cfs_time_current(), expiry) &&
+	    !(lli->lli_flags & LLIF_DATA_MODIFIED) &&
+	    lli->lli_open_fd_write_count == 0) {
+		*size = lli->lli_lazysize;
+		*blocks = lli->lli_lazyblocks;
+		*age = now > lli->lli_lazytime ? now - lli->lli_lazytime : 0;
+		rc = 1;
+	}
+	spin_unlock(&lli->lli_lock);
+
+	return rc;
+}
+
 int __ll_inode_revalidate_it(struct dentry *dentry, struct lookup_intent *it,
                              __u64 ibits)
 {
@@ -2766,6 +3120,10 @@ int __ll_inode_revalidate_it(struct dentry *dentry, struct lookup_intent *it,
                 if (IS_ERR(op_data))
                         RETURN(PTR_ERR(op_data));
 
+		if (S_ISREG(inode->i_mode) &&
+		    ll_lazy_size_enabled(ll_i2sbi(inode)))
+			op_data->op_valid |= OBD_MD_FLLAZYSIZE;
+
                 oit.it_create_mode |= M_CHECK_STALE;
                 rc = md_intent_lock(exp, op_data, NULL, 0,
                                     /* we are not interested in name
@@ -2805,6 +3163,15 @@ int __ll_inode_revalidate_it(struct dentry *dentry, struct lookup_intent *it,
                                 RETURN(rc);
                         valid |= OBD_MD_FLEASIZE | OBD_MD_FLMODEASIZE;
                 }
+		/* fetch the stripe EA of a directory not known to be striped */
+		if (S_ISDIR(inode->i_mode) && ll_i2info(inode)->lli_lmv == NULL) {
+			rc = ll_get_max_mdsize(sbi, &ealen);
+			if (rc)
+				RETURN(rc);
+			valid |= OBD_MD_MEA;
+		}
+		if (S_ISREG(inode->i_mode) && ll_lazy_size_enabled(sbi))
+			valid |= OBD_MD_FLLAZYSIZE;
 
                 op_data = ll_prep_md_op_data(NULL, inode, NULL, NULL,
                                              0, ealen, LUSTRE_OPC_ANY,
@@ -2830,6 +3197,23 @@ out:
         return rc;
 }
 
+/* Refresh the size of \a inode from the OSTs after its attributes are
+ * revalidated with the MDT. */
+static int ll_inode_revalidate_size(struct inode *inode)
+{
+	int rc = 0;
+
+	/* if object isn't regular file, don't validate size */
+	if (!S_ISREG(inode->i_mode)) {
+		LTIME_S(inode->i_atime) = ll_i2info(inode)->lli_lvb.lvb_atime;
+		LTIME_S(inode->i_mtime) = ll_i2info(inode)->lli_lvb.lvb_mtime;
+		LTIME_S(inode->i_ctime) = ll_i2info(inode)->lli_lvb.lvb_ctime;
+	} else {
+		rc = ll_glimpse_size(inode);
+	}
+	return rc;
+}
+
 int ll_inode_revalidate_it(struct dentry *dentry, struct lookup_intent *it,
                            __u64 ibits)
 {
@@ -2841,14 +3225,7 @@ int ll_inode_revalidate_it(struct dentry *dentry, struct lookup_intent *it,
 	if (rc != 0)
 		RETURN(rc);
 
-	/* if object isn't regular file, don't validate size */
-	if (!S_ISREG(inode->i_mode)) {
-		LTIME_S(inode->i_atime) = ll_i2info(inode)->lli_lvb.lvb_atime;
-		LTIME_S(inode->i_mtime) = ll_i2info(inode)->lli_lvb.lvb_mtime;
-		LTIME_S(inode->i_ctime) = ll_i2info(inode)->lli_lvb.lvb_ctime;
-	} else {
-		rc = ll_glimpse_size(inode);
-	}
+	rc = ll_inode_revalidate_size(inode);
         RETURN(rc);
 }
 
@@ -2858,10 +3235,19 @@ int ll_getattr_it(struct vfsmount *mnt, struct dentry *de,
         struct inode *inode = de->d_inode;
         struct ll_sb_info *sbi = ll_i2sbi(inode);
         struct ll_inode_info *lli = ll_i2info(inode);
+	__u64 lazysize;
+	__u64 lazyblocks;
+	__u64 age;
+	int lazy = 0;
         int res = 0;
 
-        res = ll_inode_revalidate_it(de, it, MDS_INODELOCK_UPDATE |
-                                             MDS_INODELOCK_LOOKUP);
+	res = __ll_inode_revalidate_it(de, it, MDS_INODELOCK_UPDATE |
+					       MDS_INODELOCK_LOOKUP);
+	/* an approximate size from the MDT saves glimpsing every stripe */
+	if (res == 0 && S_ISREG(inode->i_mode) && ll_lazy_size_enabled(sbi))
+		lazy = ll_lazy_size_get(inode, &lazysize, &lazyblocks, &age);
+	if (res == 0 && !lazy)
+		res = ll_inode_revalidate_size(inode);
         ll_stats_ops_tally(sbi, LPROC_LL_GETATTR, 1);
 
         if (res)
@@ -2882,8 +3268,16 @@ int ll_getattr_it(struct vfsmount *mnt, struct dentry *de,
         stat->ctime = inode->i_ctime;
 	stat->blksize = 1 << inode->i_blkbits;
 
-        stat->size = i_size_read(inode);
-        stat->blocks = inode->i_blocks;
+	if (lazy) {
+		ll_stats_ops_tally(sbi, LPROC_LL_GETATTR_LAZY, 1);
+		CDEBUG(D_INODE, DFID": lazy size "LPU64", "LPU64"s old\n",
+		       PFID(&lli->lli_fid), lazysize, age);
+		stat->size = lazysize;
+		stat->blocks = lazyblocks;
+	} else {
+		stat->size = i_size_read(inode);
+		stat->blocks = inode->i_blocks;
+	}
 
         return 0;
 }
@@ -2894,6 +3288,117 @@ int ll_getattr(struct vfsmount *mnt, struct dentry *de, struct kstat *stat)
         return ll_getattr_it(mnt, de, &it, stat);
 }
 
+/* Get the attributes and the lazy size of \a inode from the MDT. */
+static int ll_lazy_size_fetch(struct inode *inode)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	struct ptlrpc_request	*req = NULL;
+	struct md_op_data	*op_data;
+	int			 ealen = 0;
+	int			 rc;
+	ENTRY;
+
+	rc = ll_get_max_mdsize(sbi, &ealen);
+	if (rc)
+		RETURN(rc);
+
+	op_data = ll_prep_md_op_data(NULL, inode, NULL, NULL, 0, ealen,
+				     LUSTRE_OPC_ANY, NULL);
+	if (IS_ERR(op_data))
+		RETURN(PTR_ERR(op_data));
+
+	op_data->op_valid = OBD_MD_FLGETATTR | OBD_MD_FLEASIZE |
+			    OBD_MD_FLMODEASIZE | OBD_MD_FLLAZYSIZE;
+	rc = md_getattr(sbi->ll_md_exp, op_data, &req);
+	ll_finish_md_op_data(op_data);
+	if (rc == 0)
+		rc = ll_prep_inode(&inode, req, NULL, NULL);
+
+	ptlrpc_req_finished(req);
+	RETURN(rc);
+}
+
+/**
+ * Get the size and blocks of \a inode for LL_IOC_LAZYSTAT: the lazy
+ * size-on-MDT if LL_LAZY_OK is asked for and the MDT has one, otherwise
+ * the exact size glimpsed from the OSTs. LL_LAZY_OK is cleared in
+ * ils_flags if the size is exact.
+ */
+int ll_lazystat(struct inode *inode, struct ioc_lazystat *ils)
+{
+	int rc;
+	ENTRY;
+
+	if (!S_ISREG(inode->i_mode))
+		RETURN(-EINVAL);
+
+	if (ils->ils_flags & LL_LAZY_OK &&
+	    exp_connect_flags(ll_i2mdexp(inode)) & OBD_CONNECT_LAZY_SIZE) {
+		rc = ll_lazy_size_fetch(inode);
+		if (rc)
+			RETURN(rc);
+
+		if (ll_lazy_size_get(inode, &ils->ils_size, &ils->ils_blocks,
+				     &ils->ils_age)) {
+			ll_stats_ops_tally(ll_i2sbi(inode),
+					   LPROC_LL_GETATTR_LAZY, 1);
+			RETURN(0);
+		}
+	}
+
+	rc = ll_glimpse_size(inode);
+	if (rc)
+		RETURN(rc);
+
+	ils->ils_flags &= ~LL_LAZY_OK;
+	ils->ils_size = i_size_read(inode);
+	ils->ils_blocks = inode->i_blocks;
+	ils->ils_age = 0;
+	RETURN(0);
+}
+
+/**
+ * Reconcile the lazy size-on-MDT of \a inode with the size glimpsed from
+ * the OSTs, for LL_IOC_SOM_SYNC.
+ */
+int ll_som_sync(struct inode *inode)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	struct ptlrpc_request	*req = NULL;
+	struct lsom_attrs	 lsa;
+	struct obd_capa		*oc;
+	int			 rc;
+	ENTRY;
+
+	if (!cfs_capable(CFS_CAP_SYS_ADMIN))
+		RETURN(-EPERM);
+
+	if (!S_ISREG(inode->i_mode))
+		RETURN(-EINVAL);
+
+	if (!(exp_connect_flags(sbi->ll_md_exp) & OBD_CONNECT_LAZY_SIZE))
+		RETURN(-EOPNOTSUPP);
+
+	rc = ll_glimpse_size(inode);
+	if (rc)
+		RETURN(rc);
+
+	/* the MDT sets the flags and the time */
+	memset(&lsa, 0, sizeof(lsa));
+	lsa.lsa_size = i_size_read(inode);
+	lsa.lsa_blocks = inode->i_blocks;
+	lustre_lsom_swab(&lsa);
+
+	oc = ll_mdscapa_get(inode);
+	rc = md_setxattr(sbi->ll_md_exp, ll_inode2fid(inode), oc,
+			 OBD_MD_FLXATTR, XATTR_NAME_LSOM, (char *)&lsa,
+			 sizeof(lsa), 0, 0, ll_i2suppgid(inode), &req);
+	capa_put(oc);
+	ptlrpc_req_finished(req);
+
+	RETURN(rc);
+}
+
 #ifdef HAVE_LINUX_FIEMAP_H
 int ll_fiemap(struct inode *inode, struct fiemap_extent_info *fieinfo,
                 __u64 start, __u64 len)
@@ -3050,6 +3555,9 @@ struct file_operations ll_file_operations = {
         .splice_read    = ll_file_splice_read,
 #endif
         .fsync          = ll_fsync,
+#ifdef HAVE_FILE_FALLOCATE
+	.fallocate	= ll_fallocate,
+#endif
         .flush          = ll_flush
 };
 
@@ -3070,6 +3578,9 @@ struct file_operations ll_file_operations_flock = {
         .splice_read    = ll_file_splice_read,
 #endif
         .fsync          = ll_fsync,
+#ifdef HAVE_FILE_FALLOCATE
+	.fallocate	= ll_fallocate,
+#endif
         .flush          = ll_flush,
         .flock          = ll_file_flock,
         .lock           = ll_file_flock
@@ -3093,6 +3604,9 @@ struct file_operations ll_file_operations_noflock = {
         .splice_read    = ll_file_splice_read,
 #endif
         .fsync          = ll_fsync,
+#ifdef HAVE_FILE_FALLOCATE
+	.fallocate	= ll_fallocate,
+#endif
         .flush          = ll_flush,
         .flock          = ll_file_noflock,
         .lock           = ll_file_noflock
@@ -3112,6 +3626,9 @@ struct inode_operations ll_file_inode_operations = {
 #ifdef HAVE_IOP_GET_ACL
 	.get_acl	= ll_get_acl,
 #endif
+#ifdef HAVE_INODE_FALLOCATE
+	.fallocate	= ll_fallocate,
+#endif
 };
 
 /* dynamic ioctl number support routins */
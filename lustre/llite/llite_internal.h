@@ -123,6 +123,9 @@ enum lli_flags {
         LLIF_SRVLOCK            = (1 << 5),
 	/* File data is modified. */
 	LLIF_DATA_MODIFIED      = (1 << 6),
+	/* The xattrs do not fit in the xattr cache, until the UPDATE lock
+	 * they were fetched under is cancelled. */
+	LLIF_XATTR_UNCACHED	= (1 << 7),
 };
 
 struct ll_inode_info {
@@ -132,6 +135,10 @@ struct ll_inode_info {
 
 	spinlock_t			lli_lock;
 	struct posix_acl		*lli_posix_acl;
+	/* all the xattrs, valid under an UPDATE lock; lli_xattr_gen is
+	 * bumped when it is invalidated. Protected by lli_lock. */
+	struct ll_xattr_cache		*lli_xattr_cache;
+	__u32				 lli_xattr_gen;
 
 	cfs_hlist_head_t		*lli_remote_perms;
 	struct mutex				lli_rmtperm_mutex;
@@ -163,6 +170,11 @@ struct ll_inode_info {
         __u64                           lli_open_fd_read_count;
         __u64                           lli_open_fd_write_count;
         __u64                           lli_open_fd_exec_count;
+	/* opens of the file in a row, each within ll_oc_thrsh_ms of the
+	 * previous one, and the time of the last one; protected by
+	 * lli_och_mutex, see ll_need_open_lock() */
+	unsigned int			lli_oc_count;
+	cfs_time_t			lli_oc_time;
         /* Protects access to och pointers and their usage counters */
 	struct mutex			lli_och_mutex;
 
@@ -193,6 +205,15 @@ struct ll_inode_info {
 			/* "opendir_pid" is the token when lookup/revalid
 			 * -- I am the owner of dir statahead. */
 			pid_t                           d_opendir_pid;
+			/* lookups tracked to start statahead without
+			 * opendir, see ll_sa_predict() */
+			struct ll_sa_predict	       *d_sa_predict;
+			/* stripe EA of a striped directory, set once from
+			 * the MDT and kept until the inode is cleared */
+			struct lmv_stripe_md	       *d_lmv;
+			/* task in ll_readdir(), which the VFS calls with
+			 * i_mutex held, see ll_readdir_plus() */
+			void			       *d_readdir_owner;
 		} d;
 
 #define lli_readdir_mutex       u.d.d_readdir_mutex
@@ -201,6 +222,9 @@ struct ll_inode_info {
 #define lli_def_acl             u.d.d_def_acl
 #define lli_sa_lock             u.d.d_sa_lock
 #define lli_opendir_pid         u.d.d_opendir_pid
+#define lli_sa_predict          u.d.d_sa_predict
+#define lli_lmv                 u.d.d_lmv
+#define lli_readdir_owner       u.d.d_readdir_owner
 
 		/* for non-directory */
 		struct {
@@ -240,6 +264,15 @@ struct ll_inode_info {
 			 * accurate if the file is shared by different jobs.
 			 */
 			char                     f_jobid[JOBSTATS_JOBID_SIZE];
+
+			/* lazy size-on-MDT from the last getattr that asked
+			 * for it, the MDT update time, and when it was
+			 * received (0 if none); protected by lli_lock, see
+			 * ll_lazy_size_get() */
+			__u64				f_lazysize;
+			__u64				f_lazyblocks;
+			obd_time			f_lazytime;
+			cfs_time_t			f_lazy_stamp;
                 } f;
 
 #define lli_size_sem            u.f.f_size_sem
@@ -255,6 +288,10 @@ struct ll_inode_info {
 #define lli_async_rc		u.f.f_async_rc
 #define lli_jobid		u.f.f_jobid
 #define lli_volatile		u.f.f_volatile
+#define lli_lazysize		u.f.f_lazysize
+#define lli_lazyblocks		u.f.f_lazyblocks
+#define lli_lazytime		u.f.f_lazytime
+#define lli_lazy_stamp		u.f.f_lazy_stamp
 
 	} u;
 
@@ -398,6 +435,9 @@ enum stats_track_type {
 #define LL_SBI_VERBOSE        0x10000 /* verbose mount/umount */
 #define LL_SBI_LAYOUT_LOCK    0x20000 /* layout lock support */
 #define LL_SBI_USER_FID2PATH  0x40000 /* allow fid2path by unprivileged users */
+#define LL_SBI_READDIR_PLUS   0x80000 /* fetch attrs and locks with readdir */
+#define LL_SBI_XATTR_CACHE   0x100000 /* cache xattrs under UPDATE lock */
+#define LL_SBI_LAZY_SIZE     0x200000 /* stat may use lazy size-on-MDT */
 
 #define LL_SBI_FLAGS { 	\
 	"nolck",	\
@@ -417,7 +457,10 @@ enum stats_track_type {
 	"agl",		\
 	"verbose",	\
 	"layout",	\
-	"user_fid2path" }
+	"user_fid2path",\
+	"readdir_plus",	\
+	"xattr_cache",	\
+	"lazy_size" }
 
 /* default value for ll_sb_info->contention_time */
 #define SBI_DEFAULT_CONTENTION_SECONDS     60
@@ -451,6 +494,16 @@ struct eacl_table {
 	cfs_list_t	et_entries[EE_HASHES];
 };
 
+/* access patterns statahead prefetches for */
+enum ll_sa_pattern {
+	SA_PATTERN_LS	= 0,	/* readdir order from the first entry */
+	SA_PATTERN_HASH	= 1,	/* readdir order from any entry */
+	SA_PATTERN_NAME	= 2,	/* ascending name order */
+	SA_PATTERN_MAX
+};
+
+#define SA_PATTERN_NAMES { "ls", "hash", "name" }
+
 struct ll_sb_info {
 	cfs_list_t		  ll_list;
 	/* this protects pglist and ra_info.  It isn't safe to
@@ -507,6 +560,21 @@ struct ll_sb_info {
         atomic_t                  ll_sa_wrong;   /* statahead thread stopped for
                                                   * low hit ratio */
         atomic_t                  ll_agl_total;  /* AGL thread started count */
+	/* open handle caching: opens in a row, each within ll_oc_thrsh_ms
+	 * of the previous one, before an OPEN lock is asked for the file;
+	 * 0 never asks for it */
+	unsigned int		  ll_oc_thrsh_count;
+	unsigned int		  ll_oc_thrsh_ms;
+	/* statahead started, hit and miss count per access pattern */
+	atomic_t		  ll_sa_pattern_total[SA_PATTERN_MAX];
+	atomic_t		  ll_sa_pattern_hit[SA_PATTERN_MAX];
+	atomic_t		  ll_sa_pattern_miss[SA_PATTERN_MAX];
+	/* oldest lazy size-on-MDT stat may use, in seconds since it was
+	 * fetched from the MDT */
+	unsigned int		  ll_lazy_size_max_age;
+	/* files AGL glimpses with one OST_GLIMPSE_BATCH RPC per OST, 0 glimpses
+	 * each object with its own lock enqueue */
+	unsigned int		  ll_agl_batch;
 
         dev_t                     ll_sdev_orig; /* save s_dev before assign for
                                                  * clustred nfs */
@@ -516,6 +584,17 @@ struct ll_sb_info {
 
 #define LL_DEFAULT_MAX_RW_CHUNK      (32 * 1024 * 1024)
 
+/* defaults of opencache_threshold_count and opencache_threshold_ms */
+#define LL_OC_THRSH_COUNT_DEF		5
+#define LL_OC_THRSH_MS_DEF		10000
+
+/* default of lazy_size_max_age */
+#define LL_LAZY_SIZE_MAX_AGE_DEF	30
+
+/* default and maximum of statahead_agl_batch */
+#define LL_AGL_BATCH_DEF		32
+#define LL_AGL_BATCH_MAX		1024
+
 struct ll_ra_read {
         pgoff_t             lrr_start;
         pgoff_t             lrr_count;
@@ -644,6 +723,13 @@ struct it_cb_data {
 __u32 ll_i2suppgid(struct inode *i);
 void ll_i2gids(__u32 *suppgids, struct inode *i1,struct inode *i2);
 
+/* Whether getattr asks the MDT for the lazy size of regular files */
+static inline int ll_lazy_size_enabled(struct ll_sb_info *sbi)
+{
+	return sbi->ll_flags & LL_SBI_LAZY_SIZE &&
+	       exp_connect_flags(sbi->ll_md_exp) & OBD_CONNECT_LAZY_SIZE;
+}
+
 static inline int ll_need_32bit_api(struct ll_sb_info *sbi)
 {
 #if BITS_PER_LONG == 32
@@ -687,6 +773,7 @@ extern struct file_operations ll_dir_operations;
 extern struct inode_operations ll_dir_inode_operations;
 struct page *ll_get_dir_page(struct inode *dir, __u64 hash,
                              struct ll_dir_chain *chain);
+struct page *ll_get_dir_page_cached(struct inode *dir, __u64 hash);
 int ll_dir_read(struct inode *inode, __u64 *_pos, void *cookie,
 		filldir_t filldir);
 
@@ -704,6 +791,7 @@ struct lookup_intent *ll_convert_intent(struct open_intent *oit,
 #endif
 struct dentry *ll_splice_alias(struct inode *inode, struct dentry *de);
 int ll_rmdir_entry(struct inode *dir, char *name, int namelen);
+int ll_unlink_batch(struct inode *dir, struct ll_unlink_batch __user *ulub);
 
 /* llite/rw.c */
 int ll_prepare_write(struct file *, struct page *, unsigned from, unsigned to);
@@ -741,6 +829,7 @@ int ll_revalidate_nd(struct dentry *dentry, struct nameidata *nd);
 #endif
 int ll_file_open(struct inode *inode, struct file *file);
 int ll_file_release(struct inode *inode, struct file *file);
+__u32 ll_dom_stripesize(struct inode *inode);
 int ll_glimpse_ioctl(struct ll_sb_info *sbi,
                      struct lov_stripe_md *lsm, lstat_t *st);
 void ll_ioepoch_open(struct ll_inode_info *lli, __u64 ioepoch);
@@ -751,6 +840,7 @@ int ll_release_openhandle(struct dentry *, struct lookup_intent *);
 int ll_md_close(struct obd_export *md_exp, struct inode *inode,
                 struct file *file);
 int ll_md_real_close(struct inode *inode, int flags);
+int ll_need_open_lock(struct inode *inode);
 void ll_ioepoch_close(struct inode *inode, struct md_op_data *op_data,
                       struct obd_client_handle **och, unsigned long flags);
 void ll_done_writing_attr(struct inode *inode, struct md_op_data *op_data);
@@ -804,6 +894,8 @@ int ll_get_grouplock(struct inode *inode, struct file *file, unsigned long arg);
 int ll_put_grouplock(struct inode *inode, struct file *file, unsigned long arg);
 int ll_fid2path(struct inode *inode, void *arg);
 int ll_data_version(struct inode *inode, __u64 *data_version, int extent_lock);
+int ll_lazystat(struct inode *inode, struct ioc_lazystat *ils);
+int ll_som_sync(struct inode *inode);
 
 /* llite/dcache.c */
 
@@ -1168,6 +1260,7 @@ ssize_t ll_getxattr(struct dentry *dentry, const char *name,
                     void *buffer, size_t size);
 ssize_t ll_listxattr(struct dentry *dentry, char *buffer, size_t size);
 int ll_removexattr(struct dentry *dentry, const char *name);
+void ll_xattr_cache_invalidate(struct inode *inode);
 
 /* llite/remote_perm.c */
 extern struct kmem_cache *ll_remote_perm_cachep;
@@ -1274,7 +1367,13 @@ struct ll_statahead_info {
         unsigned int            sai_ls_all:1,   /* "ls -al", do stat-ahead for
                                                  * hidden entries */
                                 sai_in_readpage:1,/* statahead is in readdir()*/
-                                sai_agl_valid:1;/* AGL is valid for the dir */
+                                sai_agl_valid:1,/* AGL is valid for the dir */
+				sai_predicted:1;/* started by ll_sa_predict()
+						 * not by opendir */
+	enum ll_sa_pattern	sai_pattern;	/* access pattern followed */
+	__u64			sai_start_hash;	/* HASH: start after it */
+	char		       *sai_start_name;	/* NAME: start after it */
+	int			sai_start_namelen;
         cfs_waitq_t             sai_waitq;      /* stat-ahead wait queue */
         struct ptlrpc_thread    sai_thread;     /* stat-ahead thread */
         struct ptlrpc_thread    sai_agl_thread; /* AGL thread */
@@ -1290,6 +1389,8 @@ struct ll_statahead_info {
 int do_statahead_enter(struct inode *dir, struct dentry **dentry,
                        int only_unplug);
 void ll_stop_statahead(struct inode *dir, void *key);
+void ll_sa_predict(struct inode *dir, struct dentry *dentry);
+void ll_sa_predict_fini(struct inode *dir);
 
 static inline int ll_glimpse_size(struct inode *inode)
 {
@@ -1328,10 +1429,15 @@ ll_need_statahead(struct inode *dir, struct dentry *dentryp)
 		return -EAGAIN;
 
 	lli = ll_i2info(dir);
-	/* not the same process, don't statahead */
-	if (lli->lli_opendir_pid != cfs_curproc_pid())
+	/* the statahead thread only walks the pages of one directory */
+	if (lli->lli_lmv != NULL)
 		return -EAGAIN;
 
+	/* not the same process, don't statahead; nobody runs statahead for
+	 * the dir, let the predictor track the lookup */
+	if (lli->lli_opendir_pid != cfs_curproc_pid())
+		return lli->lli_opendir_pid == 0 ? 0 : -EAGAIN;
+
 	/* statahead has been stopped */
 	if (lli->lli_opendir_key == NULL)
 		return -EAGAIN;
@@ -1365,8 +1471,10 @@ ll_statahead_enter(struct inode *dir, struct dentry **dentryp, int only_unplug)
 	int ret;
 
 	ret = ll_need_statahead(dir, *dentryp);
+	if (ret == 0 && !only_unplug)
+		ll_sa_predict(dir, *dentryp);
 	if (ret <= 0)
-		return ret;
+		return -EAGAIN;
 
 	return do_statahead_enter(dir, dentryp, only_unplug);
 }
@@ -143,8 +143,20 @@ static struct ll_sb_info *ll_init_sbi(void)
         cfs_atomic_set(&sbi->ll_sa_total, 0);
         cfs_atomic_set(&sbi->ll_sa_wrong, 0);
         cfs_atomic_set(&sbi->ll_agl_total, 0);
+	for (i = 0; i < SA_PATTERN_MAX; i++) {
+		cfs_atomic_set(&sbi->ll_sa_pattern_total[i], 0);
+		cfs_atomic_set(&sbi->ll_sa_pattern_hit[i], 0);
+		cfs_atomic_set(&sbi->ll_sa_pattern_miss[i], 0);
+	}
         sbi->ll_flags |= LL_SBI_AGL_ENABLED;
 
+	sbi->ll_flags |= LL_SBI_XATTR_CACHE;
+
+	sbi->ll_oc_thrsh_count = LL_OC_THRSH_COUNT_DEF;
+	sbi->ll_oc_thrsh_ms = LL_OC_THRSH_MS_DEF;
+	sbi->ll_lazy_size_max_age = LL_LAZY_SIZE_MAX_AGE_DEF;
+	sbi->ll_agl_batch = LL_AGL_BATCH_DEF;
+
         RETURN(sbi);
 }
 
@@ -218,7 +230,10 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                                   OBD_CONNECT_FULL20   | OBD_CONNECT_64BITHASH|
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
-				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS;
+				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS |
+				  OBD_CONNECT_READDIR_PLUS |
+				  OBD_CONNECT_XATTR_ALL | OBD_CONNECT_LAZY_SIZE |
+				  OBD_CONNECT_UNLINK_BATCH | OBD_CONNECT_DIR_STRIPE;
 
         if (sbi->ll_flags & LL_SBI_SOM_PREVIEW)
                 data->ocd_connect_flags |= OBD_CONNECT_SOM;
@@ -410,7 +425,9 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                                   OBD_CONNECT_MAXBYTES |
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
-				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS;
+				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS |
+				  OBD_CONNECT_GLIMPSE_BATCH |
+				  OBD_CONNECT_FALLOCATE;
 
         if (sbi->ll_flags & LL_SBI_SOM_PREVIEW)
                 data->ocd_connect_flags |= OBD_CONNECT_SOM;
@@ -881,6 +898,16 @@ static int ll_options(char *options, int *flags)
                         *flags &= ~tmp;
                         goto next;
                 }
+		tmp = ll_set_opt("lazy_size", s1, LL_SBI_LAZY_SIZE);
+		if (tmp) {
+			*flags |= tmp;
+			goto next;
+		}
+		tmp = ll_set_opt("nolazy_size", s1, LL_SBI_LAZY_SIZE);
+		if (tmp) {
+			*flags &= ~tmp;
+			goto next;
+		}
                 tmp = ll_set_opt("som_preview", s1, LL_SBI_SOM_PREVIEW);
                 if (tmp) {
                         *flags |= tmp;
@@ -923,6 +950,8 @@ void ll_lli_init(struct ll_inode_info *lli)
 	lli->lli_maxbytes = MAX_LFS_FILESIZE;
 	spin_lock_init(&lli->lli_lock);
 	lli->lli_posix_acl = NULL;
+	lli->lli_xattr_cache = NULL;
+	lli->lli_xattr_gen = 0;
 	lli->lli_remote_perms = NULL;
 	mutex_init(&lli->lli_rmtperm_mutex);
         /* Do not set lli_fid, it has been initialized already. */
@@ -939,6 +968,8 @@ void ll_lli_init(struct ll_inode_info *lli)
         lli->lli_open_fd_read_count = 0;
         lli->lli_open_fd_write_count = 0;
         lli->lli_open_fd_exec_count = 0;
+	lli->lli_oc_count = 0;
+	lli->lli_oc_time = 0;
 	mutex_init(&lli->lli_och_mutex);
 	spin_lock_init(&lli->lli_agl_lock);
 	lli->lli_has_smd = false;
@@ -953,6 +984,9 @@ void ll_lli_init(struct ll_inode_info *lli)
 		lli->lli_def_acl = NULL;
 		spin_lock_init(&lli->lli_sa_lock);
 		lli->lli_opendir_pid = 0;
+		lli->lli_sa_predict = NULL;
+		lli->lli_lmv = NULL;
+		lli->lli_readdir_owner = NULL;
 	} else {
 		sema_init(&lli->lli_size_sem, 1);
 		lli->lli_size_sem_owner = NULL;
@@ -965,6 +999,7 @@ void ll_lli_init(struct ll_inode_info *lli)
 		lli->lli_agl_index = 0;
 		lli->lli_async_rc = 0;
 		lli->lli_volatile = false;
+		lli->lli_lazy_stamp = 0;
 	}
 	mutex_init(&lli->lli_layout_mutex);
 }
@@ -1209,6 +1244,10 @@ void ll_clear_inode(struct inode *inode)
                 LASSERT(lli->lli_opendir_key == NULL);
                 LASSERT(lli->lli_sai == NULL);
                 LASSERT(lli->lli_opendir_pid == 0);
+		ll_sa_predict_fini(inode);
+		if (lli->lli_lmv != NULL)
+			obd_free_memmd(sbi->ll_md_exp,
+				       (struct lov_stripe_md **)&lli->lli_lmv);
         }
 
         ll_i2info(inode)->lli_flags &= ~LLIF_MDS_SIZE_LOCK;
@@ -1225,6 +1264,8 @@ void ll_clear_inode(struct inode *inode)
         if (lli->lli_mds_read_och)
                 ll_md_real_close(inode, FMODE_READ);
 
+	ll_xattr_cache_invalidate(inode);
+
         if (S_ISLNK(inode->i_mode) && lli->lli_symlink_name) {
                 OBD_FREE(lli->lli_symlink_name,
                          strlen(lli->lli_symlink_name) + 1);
@@ -1529,6 +1570,8 @@ int ll_setattr_raw(struct dentry *dentry, struct iattr *attr)
 	if (rc == 0 && (op_data->op_bias & MDS_DATA_MODIFIED)) {
 		spin_lock(&lli->lli_lock);
 		lli->lli_flags &= ~LLIF_DATA_MODIFIED;
+		if (S_ISREG(inode->i_mode))
+			lli->lli_lazy_stamp = 0;
 		spin_unlock(&lli->lli_lock);
 	}
 
@@ -1726,6 +1769,17 @@ void ll_update_inode(struct inode *inode, struct lustre_md *md)
 			lli->lli_maxbytes = MAX_LFS_FILESIZE;
 	}
 
+	/* the striping of a directory never changes once created */
+	if (md->mea != NULL && S_ISDIR(inode->i_mode) &&
+	    lli->lli_lmv == NULL) {
+		spin_lock(&lli->lli_lock);
+		if (lli->lli_lmv == NULL) {
+			lli->lli_lmv = md->mea;
+			md->mea = NULL;
+		}
+		spin_unlock(&lli->lli_lock);
+	}
+
         if (sbi->ll_flags & LL_SBI_RMT_CLIENT) {
                 if (body->valid & OBD_MD_FLRMTPERM)
                         ll_update_remote_perm(inode, md->remote_perm);
@@ -1838,6 +1892,17 @@ void ll_update_inode(struct inode *inode, struct lustre_md *md)
                         inode->i_blocks = body->blocks;
         }
 
+	/* a zero lazytime means the MDT has no up to date lazy size */
+	if (body->valid & OBD_MD_FLLAZYSIZE && S_ISREG(inode->i_mode)) {
+		spin_lock(&lli->lli_lock);
+		lli->lli_lazysize = body->size;
+		lli->lli_lazyblocks = body->blocks;
+		lli->lli_lazytime = body->lazytime;
+		lli->lli_lazy_stamp = body->lazytime != 0 ?
+				      cfs_time_current() : 0;
+		spin_unlock(&lli->lli_lock);
+	}
+
         if (body->valid & OBD_MD_FLMDSCAPA) {
                 LASSERT(md->mds_capa);
                 ll_add_capa(inode, md->mds_capa);
@@ -2341,6 +2406,9 @@ struct md_op_data * ll_prep_md_op_data(struct md_op_data *op_data,
 	op_data->op_opc = opc;
 	op_data->op_mds = 0;
 	op_data->op_data = data;
+	op_data->op_mea1 = S_ISDIR(i1->i_mode) ? ll_i2info(i1)->lli_lmv : NULL;
+	op_data->op_mea2 = i2 != NULL && S_ISDIR(i2->i_mode) ?
+			   ll_i2info(i2)->lli_lmv : NULL;
 
         /* If the file is being opened after mknod() (normally due to NFS)
          * try to use the default stripe data from parent directory for
@@ -2404,6 +2472,9 @@ int ll_show_options(struct seq_file *seq, struct vfsmount *vfs)
 	if (sbi->ll_flags & LL_SBI_USER_FID2PATH)
 		seq_puts(seq, ",user_fid2path");
 
+	if (sbi->ll_flags & LL_SBI_LAZY_SIZE)
+		seq_puts(seq, ",lazy_size");
+
         RETURN(0);
 }
 
@@ -629,6 +629,10 @@ int ll_file_mmap(struct file *file, struct vm_area_struct * vma)
         if (ll_file_nolock(file))
                 RETURN(-EOPNOTSUPP);
 
+	/* Data-on-MDT files are not cached on the client */
+	if (ll_dom_stripesize(inode) != 0)
+		RETURN(-EOPNOTSUPP);
+
         ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_MAP, 1);
         rc = generic_file_mmap(file, vma);
         if (rc == 0) {
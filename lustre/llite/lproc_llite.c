@@ -657,19 +657,238 @@ static int ll_wr_statahead_agl(struct file *file, const char *buffer,
         return count;
 }
 
+static int ll_rd_statahead_agl_batch(char *page, char **start, off_t off,
+				     int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_agl_batch);
+}
+
+static int ll_wr_statahead_agl_batch(struct file *file, const char *buffer,
+				     unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > LL_AGL_BATCH_MAX)
+		return -ERANGE;
+
+	sbi->ll_agl_batch = val;
+
+	return count;
+}
+
+static int ll_rd_readdir_plus(char *page, char **start, off_t off,
+			      int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n",
+			sbi->ll_flags & LL_SBI_READDIR_PLUS ? 1 : 0);
+}
+
+static int ll_wr_readdir_plus(struct file *file, const char *buffer,
+			      unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		sbi->ll_flags |= LL_SBI_READDIR_PLUS;
+	else
+		sbi->ll_flags &= ~LL_SBI_READDIR_PLUS;
+
+	return count;
+}
+
+static int ll_rd_xattr_cache(char *page, char **start, off_t off,
+			     int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n",
+			sbi->ll_flags & LL_SBI_XATTR_CACHE ? 1 : 0);
+}
+
+static int ll_wr_xattr_cache(struct file *file, const char *buffer,
+			     unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		sbi->ll_flags |= LL_SBI_XATTR_CACHE;
+	else
+		sbi->ll_flags &= ~LL_SBI_XATTR_CACHE;
+
+	return count;
+}
+
+static int ll_rd_lazy_size(char *page, char **start, off_t off,
+			   int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n",
+			sbi->ll_flags & LL_SBI_LAZY_SIZE ? 1 : 0);
+}
+
+static int ll_wr_lazy_size(struct file *file, const char *buffer,
+			   unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		sbi->ll_flags |= LL_SBI_LAZY_SIZE;
+	else
+		sbi->ll_flags &= ~LL_SBI_LAZY_SIZE;
+
+	return count;
+}
+
+static int ll_rd_lazy_size_max_age(char *page, char **start, off_t off,
+				   int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_lazy_size_max_age);
+}
+
+static int ll_wr_lazy_size_max_age(struct file *file, const char *buffer,
+				   unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	sbi->ll_lazy_size_max_age = val;
+
+	return count;
+}
+
+static int ll_rd_oc_thrsh_count(char *page, char **start, off_t off,
+				int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_oc_thrsh_count);
+}
+
+static int ll_wr_oc_thrsh_count(struct file *file, const char *buffer,
+				unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	sbi->ll_oc_thrsh_count = val;
+	return count;
+}
+
+static int ll_rd_oc_thrsh_ms(char *page, char **start, off_t off,
+			     int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_oc_thrsh_ms);
+}
+
+static int ll_wr_oc_thrsh_ms(struct file *file, const char *buffer,
+			     unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	sbi->ll_oc_thrsh_ms = val;
+	return count;
+}
+
 static int ll_rd_statahead_stats(char *page, char **start, off_t off,
                                  int count, int *eof, void *data)
 {
         struct super_block *sb = data;
         struct ll_sb_info *sbi = ll_s2sbi(sb);
-
-        return snprintf(page, count,
-                        "statahead total: %u\n"
-                        "statahead wrong: %u\n"
-                        "agl total: %u\n",
-                        atomic_read(&sbi->ll_sa_total),
-                        atomic_read(&sbi->ll_sa_wrong),
-                        atomic_read(&sbi->ll_agl_total));
+	static const char *names[] = SA_PATTERN_NAMES;
+	int len;
+	int i;
+
+	len = snprintf(page, count,
+		       "statahead total: %u\n"
+		       "statahead wrong: %u\n"
+		       "agl total: %u\n",
+		       atomic_read(&sbi->ll_sa_total),
+		       atomic_read(&sbi->ll_sa_wrong),
+		       atomic_read(&sbi->ll_agl_total));
+
+	for (i = 0; i < SA_PATTERN_MAX && len < count; i++) {
+		unsigned int hit = atomic_read(&sbi->ll_sa_pattern_hit[i]);
+		unsigned int miss = atomic_read(&sbi->ll_sa_pattern_miss[i]);
+		__u64 ratio = (__u64)hit * 100;
+
+		if (hit + miss != 0)
+			do_div(ratio, hit + miss);
+		len += snprintf(page + len, count - len,
+				"%s started: %u\n"
+				"%s hit: %u\n"
+				"%s miss: %u\n"
+				"%s hit ratio: %u%%\n",
+				names[i],
+				atomic_read(&sbi->ll_sa_pattern_total[i]),
+				names[i], hit, names[i], miss, names[i],
+				(unsigned int)ratio);
+	}
+	return len;
 }
 
 static int ll_rd_lazystatfs(char *page, char **start, off_t off,
@@ -769,7 +988,17 @@ static struct lprocfs_vars lprocfs_llite_obd_vars[] = {
         { "stats_track_gid",  ll_rd_track_gid, ll_wr_track_gid, 0 },
         { "statahead_max",    ll_rd_statahead_max, ll_wr_statahead_max, 0 },
         { "statahead_agl",    ll_rd_statahead_agl, ll_wr_statahead_agl, 0 },
+	{ "statahead_agl_batch", ll_rd_statahead_agl_batch,
+				 ll_wr_statahead_agl_batch, 0 },
         { "statahead_stats",  ll_rd_statahead_stats, 0, 0 },
+	{ "readdir_plus",     ll_rd_readdir_plus, ll_wr_readdir_plus, 0 },
+	{ "xattr_cache",      ll_rd_xattr_cache, ll_wr_xattr_cache, 0 },
+	{ "lazy_size",        ll_rd_lazy_size, ll_wr_lazy_size, 0 },
+	{ "lazy_size_max_age", ll_rd_lazy_size_max_age,
+			       ll_wr_lazy_size_max_age, 0 },
+	{ "opencache_threshold_count", ll_rd_oc_thrsh_count,
+				       ll_wr_oc_thrsh_count, 0 },
+	{ "opencache_threshold_ms", ll_rd_oc_thrsh_ms, ll_wr_oc_thrsh_ms, 0 },
         { "lazystatfs",       ll_rd_lazystatfs, ll_wr_lazystatfs, 0 },
         { "max_easize",       ll_rd_maxea_size, 0, 0 },
 	{ "sbi_flags",        ll_rd_sbi_flags, 0, 0 },
@@ -827,6 +1056,10 @@ struct llite_file_opcode {
         { LPROC_LL_LISTXATTR,      LPROCFS_TYPE_REGS, "listxattr" },
         { LPROC_LL_REMOVEXATTR,    LPROCFS_TYPE_REGS, "removexattr" },
         { LPROC_LL_INODE_PERM,     LPROCFS_TYPE_REGS, "inode_permission" },
+	{ LPROC_LL_GETXATTR_HITS,  LPROCFS_TYPE_REGS, "getxattr_hits" },
+	{ LPROC_LL_GETXATTR_MISSES, LPROCFS_TYPE_REGS, "getxattr_misses" },
+	{ LPROC_LL_GETATTR_LAZY,   LPROCFS_TYPE_REGS, "getattr_lazy" },
+	{ LPROC_LL_FALLOCATE,      LPROCFS_TYPE_REGS, "fallocate" },
 };
 
 void ll_stats_ops_tally(struct ll_sb_info *sbi, int op, int count)
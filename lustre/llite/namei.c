@@ -195,6 +195,29 @@ static void ll_invalidate_negative_children(struct inode *dir)
 	ll_unlock_dcache(dir);
 }
 
+/* Is \a lock on one of the shards of striped directory \a inode? */
+static int ll_lock_on_shard(struct inode *inode, struct ldlm_lock *lock)
+{
+	struct lmv_stripe_md	*mea;
+	struct ldlm_res_id	*name = &lock->l_resource->lr_name;
+	int			 i;
+
+	if (!S_ISDIR(inode->i_mode))
+		return 0;
+
+	mea = ll_i2info(inode)->lli_lmv;
+	if (mea == NULL)
+		return 0;
+
+	for (i = 0; i < mea->mea_count; i++) {
+		if (name->name[0] == fid_seq(&mea->mea_ids[i]) &&
+		    name->name[1] == fid_oid(&mea->mea_ids[i]) &&
+		    name->name[2] == fid_ver(&mea->mea_ids[i]))
+			return 1;
+	}
+	return 0;
+}
+
 int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
                        void *data, int flag)
 {
@@ -227,6 +250,17 @@ int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
                         break;
 
                 LASSERT(lock->l_flags & LDLM_FL_CANCELING);
+
+		/* names of a striped directory are looked up under the
+		 * locks of its shards, which only cover the negative
+		 * dentries hashed to that shard */
+		if (ll_lock_on_shard(inode, lock)) {
+			if (bits & MDS_INODELOCK_UPDATE)
+				ll_invalidate_negative_children(inode);
+			iput(inode);
+			break;
+		}
+
                 /* For OPEN locks we differentiate between lock modes
 		 * LCK_CR, LCK_CW, LCK_PR - bug 22891 */
 		if (bits & (MDS_INODELOCK_LOOKUP | MDS_INODELOCK_UPDATE |
@@ -275,8 +309,10 @@ int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 				CDEBUG(D_INODE, "invaliding layout %d.\n", rc);
 		}
 
-                if (bits & MDS_INODELOCK_UPDATE)
-                        lli->lli_flags &= ~LLIF_MDS_SIZE_LOCK;
+		if (bits & MDS_INODELOCK_UPDATE) {
+			lli->lli_flags &= ~LLIF_MDS_SIZE_LOCK;
+			ll_xattr_cache_invalidate(inode);
+		}
 
                 if (S_ISDIR(inode->i_mode) &&
                      (bits & MDS_INODELOCK_UPDATE)) {
@@ -1172,6 +1208,115 @@ int ll_rmdir_entry(struct inode *dir, char *name, int namelen)
 	RETURN(rc);
 }
 
+/**
+ * Unlink the names passed with LL_IOC_UNLINK_BATCH from \a dir, sending
+ * them to the MDT in batches of up to MDS_UNLINK_BATCH_MAX names instead
+ * of one RPC per name.
+ *
+ * \retval -EOPNOTSUPP	the MDT does not support batched unlink, nothing
+ *			was unlinked
+ */
+int ll_unlink_batch(struct inode *dir, struct ll_unlink_batch __user *ulub)
+{
+	struct ll_sb_info	*sbi = ll_i2sbi(dir);
+	struct ll_unlink_batch	 hdr;
+	struct ll_unlink_batch	*lub;
+	struct md_op_data	*op_data;
+	char			*names;
+	char			*name;
+	char			*end;
+	size_t			 size;
+	int			 first;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	if (copy_from_user(&hdr, ulub, sizeof(hdr)))
+		RETURN(-EFAULT);
+
+	if (hdr.lub_count == 0 || hdr.lub_namelen == 0 ||
+	    hdr.lub_namelen > LL_UNLINK_BATCH_MAX_SIZE ||
+	    hdr.lub_count > hdr.lub_namelen / 2)
+		RETURN(-EINVAL);
+
+	size = ll_unlink_batch_size(hdr.lub_count, hdr.lub_namelen);
+	OBD_ALLOC_LARGE(lub, size);
+	if (lub == NULL)
+		RETURN(-ENOMEM);
+
+	if (copy_from_user(lub, ulub, size))
+		GOTO(out_free, rc = -EFAULT);
+
+	lub->lub_count = hdr.lub_count;
+	lub->lub_namelen = hdr.lub_namelen;
+	names = ll_unlink_batch_names(lub);
+	end = names + lub->lub_namelen;
+	if (end[-1] != '\0')
+		GOTO(out_free, rc = -EINVAL);
+
+	/* check every name before unlinking any of them */
+	for (i = 0, name = names; name < end; i++, name += strlen(name) + 1) {
+		size_t len = strlen(name);
+
+		if (len == 0 || len > sbi->ll_namelen ||
+		    strchr(name, '/') != NULL ||
+		    (name[0] == '.' &&
+		     (len == 1 || (len == 2 && name[1] == '.'))))
+			GOTO(out_free, rc = -EINVAL);
+	}
+	if (i != lub->lub_count)
+		GOTO(out_free, rc = -EINVAL);
+
+	op_data = ll_prep_md_op_data(NULL, dir, NULL, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, NULL);
+	if (IS_ERR(op_data))
+		GOTO(out_free, rc = PTR_ERR(op_data));
+
+	for (first = 0, name = names; first < lub->lub_count; first = i) {
+		op_data->op_name = name;
+		for (i = first; i < lub->lub_count &&
+		     i - first < MDS_UNLINK_BATCH_MAX; i++) {
+			size_t len = strlen(name) + 1;
+
+			if (name + len - op_data->op_name >
+			    MDS_UNLINK_BATCH_SIZE)
+				break;
+			name += len;
+		}
+		op_data->op_namelen = name - op_data->op_name;
+
+		CDEBUG(D_VFSTRACE, "VFS Op:unlink %d names,dir=%lu/%u(%p)\n",
+		       i - first, dir->i_ino, dir->i_generation, dir);
+
+		rc = md_unlink_batch(sbi->ll_md_exp, op_data, i - first,
+				     &lub->lub_rcs[first]);
+		if (rc != 0)
+			break;
+
+		/* the MDT leaves the names it had no room for in the reply,
+		 * or whose result it lost on resend, to the next batch */
+		for (i = first, name = op_data->op_name;
+		     name < op_data->op_name + op_data->op_namelen &&
+		     lub->lub_rcs[i] != -EAGAIN;
+		     i++, name += strlen(name) + 1)
+			;
+	}
+	ll_finish_md_op_data(op_data);
+
+	/* report what was done even if a later batch failed */
+	for (i = 0; i < first; i++) {
+		if (lub->lub_rcs[i] == 0)
+			ll_stats_ops_tally(sbi, LPROC_LL_UNLINK, 1);
+	}
+	if (first > 0 &&
+	    copy_to_user(ulub->lub_rcs, lub->lub_rcs, first * sizeof(__s32)))
+		rc = -EFAULT;
+	EXIT;
+out_free:
+	OBD_FREE_LARGE(lub, size);
+	return rc;
+}
+
 int ll_objects_destroy(struct ptlrpc_request *request, struct inode *dir)
 {
         struct mdt_body *body;
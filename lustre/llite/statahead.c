@@ -39,6 +39,7 @@
 #include <linux/mm.h>
 #include <linux/highmem.h>
 #include <linux/pagemap.h>
+#include <linux/sort.h>
 
 #define DEBUG_SUBSYSTEM S_LLITE
 
@@ -49,6 +50,44 @@
 
 #define SA_OMITTED_ENTRY_MAX 8ULL
 
+/* lookups the predictor tracks before giving up on a process */
+#define SA_PREDICT_LOOKUPS_MAX	16
+/* consecutive lookups in readdir order that start HASH pattern statahead */
+#define SA_PREDICT_HASH_SEQ	2
+/* consecutive lookups in name order that start NAME pattern statahead */
+#define SA_PREDICT_NAME_SEQ	4
+/* dir pages the predictor reads to locate a name */
+#define SA_PREDICT_SCAN_PAGES	8
+/* seconds a predicted statahead waits for its process */
+#define SA_PREDICT_IDLE		5
+/* name prefix the predictor compares the lookups with */
+#define SA_PREDICT_NAME_LEN	32
+/* max entries NAME pattern statahead sorts */
+#define SA_NAME_ENTRIES_MAX	65536
+
+/**
+ * Lookups of one process in a dir nobody runs statahead for, tracked to
+ * start statahead if they follow a pattern, see ll_sa_predict().
+ */
+struct ll_sa_predict {
+	/* process whose lookups are tracked */
+	pid_t		sap_pid;
+	/* time of its last lookup, another process takes over once it has
+	 * been idle for SA_PREDICT_IDLE seconds */
+	cfs_time_t	sap_time;
+	/* lookups tracked without finding a pattern */
+	unsigned int	sap_lookups;
+	/* consecutive lookups following readdir order */
+	unsigned int	sap_hash_seq;
+	/* consecutive lookups in ascending name order */
+	unsigned int	sap_name_seq;
+	/* dir hash of the last name looked up, 0 if unknown */
+	__u64		sap_hash;
+	/* length and prefix of the last name looked up */
+	int		sap_namelen;
+	char		sap_name[SA_PREDICT_NAME_LEN];
+};
+
 typedef enum {
         /** negative values are for error cases */
         SA_ENTRY_INIT = 0,      /** init entry */
@@ -499,6 +538,13 @@ static struct ll_statahead_info *ll_sai_alloc(void)
         RETURN(sai);
 }
 
+static void ll_sai_free(struct ll_statahead_info *sai)
+{
+	if (sai->sai_start_name != NULL)
+		OBD_FREE(sai->sai_start_name, sai->sai_start_namelen);
+	OBD_FREE_PTR(sai);
+}
+
 static inline struct ll_statahead_info *
 ll_sai_get(struct ll_statahead_info *sai)
 {
@@ -548,19 +594,23 @@ static void ll_sai_put(struct ll_statahead_info *sai)
                 LASSERT(agl_list_empty(sai));
 
                 iput(inode);
-                OBD_FREE_PTR(sai);
+		ll_sai_free(sai);
         }
 
         EXIT;
 }
 
-/* Do NOT forget to drop inode refcount when into sai_entries_agl. */
-static void ll_agl_trigger(struct inode *inode, struct ll_statahead_info *sai)
+/**
+ * Check whether AGL has to glimpse \a inode, taken off sai_entries_agl.
+ *
+ * \retval 1	it has to, lli_glimpse_sem is held until ll_agl_done()
+ * \retval 0	it does not, the inode refcount is dropped
+ */
+static int ll_agl_prep(struct inode *inode, struct ll_statahead_info *sai)
 {
         struct ll_inode_info *lli   = ll_i2info(inode);
         __u64                 index = lli->lli_agl_index;
         int                   rc;
-        ENTRY;
 
         LASSERT(cfs_list_empty(&lli->lli_agl_list));
 
@@ -568,7 +618,7 @@ static void ll_agl_trigger(struct inode *inode, struct ll_statahead_info *sai)
         if (is_omitted_entry(sai, index + 1)) {
                 lli->lli_agl_index = 0;
                 iput(inode);
-                RETURN_EXIT;
+                return 0;
         }
 
         /* Someone is in glimpse (sync or async), do nothing. */
@@ -576,7 +626,7 @@ static void ll_agl_trigger(struct inode *inode, struct ll_statahead_info *sai)
         if (rc == 0) {
                 lli->lli_agl_index = 0;
                 iput(inode);
-                RETURN_EXIT;
+                return 0;
         }
 
         /*
@@ -597,26 +647,134 @@ static void ll_agl_trigger(struct inode *inode, struct ll_statahead_info *sai)
 		up_write(&lli->lli_glimpse_sem);
                 lli->lli_agl_index = 0;
                 iput(inode);
-                RETURN_EXIT;
+                return 0;
         }
 
+	return 1;
+}
+
+static void ll_agl_done(struct inode *inode)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+
+	lli->lli_agl_index = 0;
+	lli->lli_glimpse_time = cfs_time_current();
+	up_write(&lli->lli_glimpse_sem);
+	iput(inode);
+}
+
+/* Do NOT forget to drop inode refcount when into sai_entries_agl. */
+static void ll_agl_trigger(struct inode *inode, struct ll_statahead_info *sai)
+{
+        struct ll_inode_info *lli   = ll_i2info(inode);
+        __u64                 index = lli->lli_agl_index;
+        int                   rc;
+        ENTRY;
+
+	if (!ll_agl_prep(inode, sai))
+		RETURN_EXIT;
+
         CDEBUG(D_READA, "Handling (init) async glimpse: inode = "
                DFID", idx = "LPU64"\n", PFID(&lli->lli_fid), index);
 
-        cl_agl(inode);
-        lli->lli_agl_index = 0;
-        lli->lli_glimpse_time = cfs_time_current();
-	up_write(&lli->lli_glimpse_sem);
+	rc = cl_agl(inode);
 
         CDEBUG(D_READA, "Handled (init) async glimpse: inode= "
                DFID", idx = "LPU64", rc = %d\n",
                PFID(&lli->lli_fid), index, rc);
 
-        iput(inode);
-
+	ll_agl_done(inode);
         EXIT;
 }
 
+/**
+ * Glimpse up to \a max AGL entries of \a sai at once, with one
+ * OST_GLIMPSE_BATCH RPC per OST holding any of their objects instead of one
+ * glimpse enqueue per object. The OSTs grant the glimpse locks along, so
+ * that stat finds them cached, unless the lazy size is enabled: the files
+ * are glimpsed without locks then and stat returns the results as their
+ * lazy size. The entries a batch fails for are glimpsed the usual way.
+ */
+static void ll_agl_batch(struct ll_statahead_info *sai,
+			 struct obd_glimpse *ogs, struct inode **inodes,
+			 int max)
+{
+	struct ll_inode_info	*plli	  = ll_i2info(sai->sai_inode);
+	struct ll_sb_info	*sbi	  = ll_i2sbi(sai->sai_inode);
+	int			 lockless = ll_lazy_size_enabled(sbi);
+	struct ll_inode_info	*clli;
+	struct inode		*inode;
+	struct lov_stripe_md	*lsm;
+	int			 count	  = 0;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	spin_lock(&plli->lli_agl_lock);
+	while (!agl_list_empty(sai) && count < max) {
+		clli = agl_first_entry(sai);
+		cfs_list_del_init(&clli->lli_agl_list);
+		spin_unlock(&plli->lli_agl_lock);
+
+		inode = &clli->lli_vfs_inode;
+		if (!ll_agl_prep(inode, sai))
+			goto next;
+
+		lsm = ccc_inode_lsm_get(inode);
+		if (!lsm_has_objects(lsm)) {
+			ccc_inode_lsm_put(inode, lsm);
+			cl_agl(inode);
+			ll_agl_done(inode);
+			goto next;
+		}
+
+		/* the MDT returned a lazy size along with the attributes */
+		if (lockless && clli->lli_lazy_stamp != 0) {
+			ccc_inode_lsm_put(inode, lsm);
+			ll_agl_done(inode);
+			goto next;
+		}
+
+		memset(&ogs[count], 0, sizeof(ogs[count]));
+		ogs[count].og_lsm = lsm;
+		inodes[count] = inode;
+		count++;
+next:
+		spin_lock(&plli->lli_agl_lock);
+	}
+	spin_unlock(&plli->lli_agl_lock);
+
+	if (count == 0)
+		RETURN_EXIT;
+
+	rc = obd_glimpse_batch(NULL, sbi->ll_dt_exp, ogs, count,
+			       lockless ? OBD_GLIMPSE_NOLOCK : 0, NULL);
+	CDEBUG(D_READA, "batched async glimpse of %d files: rc = %d\n",
+	       count, rc);
+
+	for (i = 0; i < count; i++) {
+		inode = inodes[i];
+		clli = ll_i2info(inode);
+
+		if (rc != 0 || ogs[i].og_rc != 0) {
+			CDEBUG(D_READA, "async glimpse "DFID" again: rc = %d\n",
+			       PFID(&clli->lli_fid), rc ?: ogs[i].og_rc);
+			cl_agl(inode);
+		} else if (lockless) {
+			spin_lock(&clli->lli_lock);
+			clli->lli_lazysize = ogs[i].og_lvb.lvb_size;
+			clli->lli_lazyblocks = ogs[i].og_lvb.lvb_blocks;
+			clli->lli_lazytime = cfs_time_current_sec();
+			clli->lli_lazy_stamp = cfs_time_current();
+			spin_unlock(&clli->lli_lock);
+		}
+
+		ccc_inode_lsm_put(inode, ogs[i].og_lsm);
+		ll_agl_done(inode);
+	}
+	EXIT;
+}
+
 static void ll_post_statahead(struct ll_statahead_info *sai)
 {
         struct inode           *dir   = sai->sai_inode;
@@ -824,6 +982,9 @@ static int sa_args_init(struct inode *dir, struct inode *child,
                 OBD_FREE_PTR(minfo);
                 return PTR_ERR(op_data);
         }
+	/* the MDT only packs it for regular files */
+	if (ll_lazy_size_enabled(ll_i2sbi(dir)))
+		op_data->op_valid |= OBD_MD_FLLAZYSIZE;
 
         minfo->mi_it.it_op = IT_GETATTR;
         minfo->mi_dir = igrab(dir);
@@ -979,11 +1140,23 @@ static int ll_agl_thread(void *arg)
         struct ll_statahead_info *sai    = ll_sai_get(plli->lli_sai);
         struct ptlrpc_thread     *thread = &sai->sai_agl_thread;
         struct l_wait_info        lwi    = { 0 };
+	struct obd_glimpse	 *ogs	 = NULL;
+	struct inode		**inodes = NULL;
+	int			  max	 = sbi->ll_agl_batch;
+	int			  batch	 = 0;
         ENTRY;
 
         CDEBUG(D_READA, "agl thread started: [pid %d] [parent %.*s]\n",
                cfs_curproc_pid(), parent->d_name.len, parent->d_name.name);
 
+	if (max > 0) {
+		OBD_ALLOC_LARGE(ogs, max * sizeof(*ogs));
+		OBD_ALLOC_LARGE(inodes, max * sizeof(*inodes));
+		/* glimpse each file on its own otherwise */
+		if (ogs != NULL && inodes != NULL)
+			batch = max;
+	}
+
         atomic_inc(&sbi->ll_agl_total);
 	spin_lock(&plli->lli_agl_lock);
 	sai->sai_agl_valid = 1;
@@ -1000,6 +1173,13 @@ static int ll_agl_thread(void *arg)
                 if (!thread_is_running(thread))
                         break;
 
+		/* Entries queue up while a batch is in flight, so the batches
+		 * grow with the rate statahead feeds AGL. */
+		if (batch > 0) {
+			ll_agl_batch(sai, ogs, inodes, batch);
+			continue;
+		}
+
 		spin_lock(&plli->lli_agl_lock);
 		/* The statahead thread maybe help to process AGL entries,
 		 * so check whether list empty again. */
@@ -1027,6 +1207,10 @@ static int ll_agl_thread(void *arg)
 	spin_unlock(&plli->lli_agl_lock);
 	cfs_waitq_signal(&thread->t_ctl_waitq);
 	ll_sai_put(sai);
+	if (ogs != NULL)
+		OBD_FREE_LARGE(ogs, max * sizeof(*ogs));
+	if (inodes != NULL)
+		OBD_FREE_LARGE(inodes, max * sizeof(*inodes));
 	CDEBUG(D_READA, "agl thread stopped: [pid %d] [parent %.*s]\n",
 	       cfs_curproc_pid(), parent->d_name.len, parent->d_name.name);
 	RETURN(0);
@@ -1058,37 +1242,360 @@ static void ll_start_agl(struct dentry *parent, struct ll_statahead_info *sai)
 	EXIT;
 }
 
+/**
+ * Wait for room in the statahead window, handling the replies and helping
+ * the AGL meanwhile.
+ *
+ * \retval 0		one more entry can be sent
+ * \retval -ESRCH	the statahead thread is stopping
+ */
+static int ll_sa_window_wait(struct ll_statahead_info *sai)
+{
+	struct ptlrpc_thread	*thread = &sai->sai_thread;
+	struct ll_inode_info	*plli	= ll_i2info(sai->sai_inode);
+	struct ll_inode_info	*clli;
+	struct l_wait_info	 lwi	= { 0 };
+	int			 rc;
+
+	if (sai->sai_predicted)
+		lwi = LWI_TIMEOUT(cfs_time_seconds(SA_PREDICT_IDLE), NULL,
+				  NULL);
+
+	while (1) {
+		rc = l_wait_event(thread->t_ctl_waitq,
+				  !sa_sent_full(sai) ||
+				  !sa_received_empty(sai) ||
+				  !agl_list_empty(sai) ||
+				  !thread_is_running(thread),
+				  &lwi);
+
+		while (!sa_received_empty(sai))
+			ll_post_statahead(sai);
+
+		if (unlikely(!thread_is_running(thread)))
+			return -ESRCH;
+
+		if (rc == -ETIMEDOUT) {
+			/* the process the statahead was predicted for does
+			 * not consume the entries any more */
+			CDEBUG(D_READA, "statahead for dir "DFID" idle, "
+			       "stopping: hit/miss "LPU64"/"LPU64"\n",
+			       PFID(&plli->lli_fid), sai->sai_hit,
+			       sai->sai_miss);
+			spin_lock(&plli->lli_sa_lock);
+			thread_set_flags(thread, SVC_STOPPING);
+			spin_unlock(&plli->lli_sa_lock);
+			return -ESRCH;
+		}
+
+		if (!sa_sent_full(sai))
+			return 0;
+
+		/* If no window for metadata statahead, but there are
+		 * some AGL entries to be triggered, then try to help
+		 * to process the AGL entries. */
+		spin_lock(&plli->lli_agl_lock);
+		while (!agl_list_empty(sai)) {
+			clli = agl_first_entry(sai);
+			cfs_list_del_init(&clli->lli_agl_list);
+			spin_unlock(&plli->lli_agl_lock);
+			ll_agl_trigger(&clli->lli_vfs_inode, sai);
+
+			spin_lock(&plli->lli_agl_lock);
+			if (!sa_received_empty(sai) ||
+			    unlikely(!thread_is_running(thread)) ||
+			    !sa_sent_full(sai))
+				break;
+		}
+		spin_unlock(&plli->lli_agl_lock);
+	}
+}
+
+/**
+ * All the entries are sent, wait for their replies and run the remaining
+ * AGL entries.
+ */
+static void ll_statahead_drain(struct ll_statahead_info *sai)
+{
+	struct ptlrpc_thread	*thread = &sai->sai_thread;
+	struct ll_inode_info	*plli	= ll_i2info(sai->sai_inode);
+	struct ll_inode_info	*clli;
+	struct l_wait_info	 lwi	= { 0 };
+
+	while (1) {
+		l_wait_event(thread->t_ctl_waitq,
+			     !sa_received_empty(sai) ||
+			     sai->sai_sent == sai->sai_replied ||
+			     !thread_is_running(thread),
+			     &lwi);
+
+		while (!sa_received_empty(sai))
+			ll_post_statahead(sai);
+
+		if (unlikely(!thread_is_running(thread)))
+			return;
+
+		if (sai->sai_sent == sai->sai_replied &&
+		    sa_received_empty(sai))
+			break;
+	}
+
+	spin_lock(&plli->lli_agl_lock);
+	while (!agl_list_empty(sai) &&
+	       thread_is_running(thread)) {
+		clli = agl_first_entry(sai);
+		cfs_list_del_init(&clli->lli_agl_list);
+		spin_unlock(&plli->lli_agl_lock);
+		ll_agl_trigger(&clli->lli_vfs_inode, sai);
+		spin_lock(&plli->lli_agl_lock);
+	}
+	spin_unlock(&plli->lli_agl_lock);
+
+	/* A predicted statahead is released when its thread exits, give the
+	 * process some time to consume the stated entries. */
+	if (sai->sai_predicted) {
+		lwi = LWI_TIMEOUT(cfs_time_seconds(SA_PREDICT_IDLE), NULL,
+				  NULL);
+		l_wait_event(thread->t_ctl_waitq,
+			     cfs_list_empty(&sai->sai_entries_stated) ||
+			     !thread_is_running(thread),
+			     &lwi);
+	}
+}
+
+/**
+ * Call \a cb for each entry of \a dir but "." and "..", in readdir order
+ * from hash \a pos, until it returns non-zero or \a max_pages pages were
+ * walked. With \a cached only the pages in cache are walked, the walk stops
+ * at the first missing one.
+ *
+ * \retval	the last value returned by \a cb, or a negative errno if the
+ *		directory could not be read
+ */
+static int ll_sa_dir_walk(struct inode *dir, __u64 pos, int max_pages,
+			  int cached,
+			  int (*cb)(struct lu_dirent *, __u64, void *),
+			  void *data)
+{
+	struct ll_dir_chain	 chain;
+	struct page		*page;
+	int			 pages = 0;
+	int			 rc    = 0;
+	ENTRY;
+
+	ll_dir_chain_init(&chain);
+	while (1) {
+		struct lu_dirpage *dp;
+		struct lu_dirent  *ent;
+
+		if (cached) {
+			page = ll_get_dir_page_cached(dir, pos);
+			if (page == NULL)
+				break;
+		} else {
+			page = ll_get_dir_page(dir, pos, &chain);
+		}
+		if (IS_ERR(page)) {
+			rc = PTR_ERR(page);
+			CDEBUG(D_READA, "error reading dir "DFID" at "LPU64
+			       ": rc = %d\n", PFID(ll_inode2fid(dir)), pos, rc);
+			break;
+		}
+
+		dp = page_address(page);
+		for (ent = lu_dirent_start(dp); ent != NULL && rc == 0;
+		     ent = lu_dirent_next(ent)) {
+			__u64	 hash	 = le64_to_cpu(ent->lde_hash);
+			int	 namelen = le16_to_cpu(ent->lde_namelen);
+			char	*name	 = ent->lde_name;
+
+			/* The ll_get_dir_page() can return any page containing
+			 * the given hash which may be not the start hash. */
+			if (unlikely(hash < pos || namelen == 0))
+				continue;
+
+			if (name[0] == '.' &&
+			    (namelen == 1 || (namelen == 2 && name[1] == '.')))
+				continue;
+
+			rc = cb(ent, hash, data);
+		}
+
+		pos = le64_to_cpu(dp->ldp_hash_end);
+		if (pos == MDS_DIR_END_OFF) {
+			ll_release_page(page, 0);
+			break;
+		}
+		ll_release_page(page, le32_to_cpu(dp->ldp_flags) &
+				      LDF_COLLIDE);
+		if (rc != 0 || ++pages >= max_pages)
+			break;
+	}
+	ll_dir_chain_fini(&chain);
+
+	RETURN(rc);
+}
+
+static int ll_sa_namecmp(const char *name1, int len1,
+			 const char *name2, int len2)
+{
+	int rc = memcmp(name1, name2, min(len1, len2));
+
+	return rc != 0 ? rc : len1 - len2;
+}
+
+struct ll_sa_name {
+	char	*sn_name;
+	int	 sn_len;
+};
+
+static int ll_sa_name_cmp(const void *a, const void *b)
+{
+	const struct ll_sa_name *n1 = a;
+	const struct ll_sa_name *n2 = b;
+
+	return ll_sa_namecmp(n1->sn_name, n1->sn_len, n2->sn_name, n2->sn_len);
+}
+
+/* names gathered by the NAME pattern statahead */
+struct ll_sa_names {
+	struct ll_statahead_info *sns_sai;
+	struct ll_sa_name	 *sns_names;	/* NULL while counting */
+	int			  sns_count;
+	int			  sns_max;
+	char			 *sns_buf;
+	int			  sns_buf_used;
+	int			  sns_buf_size;
+};
+
+static int ll_sa_names_cb(struct lu_dirent *ent, __u64 hash, void *data)
+{
+	struct ll_sa_names	 *sns	  = data;
+	struct ll_statahead_info *sai	  = sns->sns_sai;
+	int			  namelen = le16_to_cpu(ent->lde_namelen);
+
+	if (ent->lde_name[0] == '.' && !sai->sai_ls_all)
+		return 0;
+
+	if (ll_sa_namecmp(ent->lde_name, namelen, sai->sai_start_name,
+			  sai->sai_start_namelen) <= 0)
+		return 0;
+
+	if (sns->sns_names == NULL) {
+		sns->sns_count++;
+		sns->sns_buf_size += namelen;
+		return sns->sns_count > SA_NAME_ENTRIES_MAX ? -EFBIG : 0;
+	}
+
+	/* the directory grew since it was counted */
+	if (sns->sns_count == sns->sns_max ||
+	    sns->sns_buf_used + namelen > sns->sns_buf_size)
+		return 1;
+
+	sns->sns_names[sns->sns_count].sn_name = sns->sns_buf +
+						 sns->sns_buf_used;
+	sns->sns_names[sns->sns_count].sn_len = namelen;
+	memcpy(sns->sns_buf + sns->sns_buf_used, ent->lde_name, namelen);
+	sns->sns_buf_used += namelen;
+	sns->sns_count++;
+	return 0;
+}
+
+/**
+ * NAME pattern: stat the entries whose name sorts after sai_start_name, in
+ * ascending name order.
+ *
+ * \retval 0		all the entries are sent
+ * \retval -ESRCH	the statahead thread is stopping
+ */
+static int ll_statahead_by_name(struct dentry *parent,
+				struct ll_statahead_info *sai)
+{
+	struct inode		*dir = parent->d_inode;
+	struct ll_sa_names	 sns = { .sns_sai = sai };
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	rc = ll_sa_dir_walk(dir, 0, INT_MAX, 0, ll_sa_names_cb, &sns);
+	if (rc < 0 || sns.sns_count == 0) {
+		CDEBUG(D_READA, "dir "DFID" has %d names to stat: rc = %d\n",
+		       PFID(ll_inode2fid(dir)), sns.sns_count, rc);
+		RETURN(rc);
+	}
+
+	sns.sns_max = sns.sns_count;
+	OBD_ALLOC_LARGE(sns.sns_names, sns.sns_max * sizeof(*sns.sns_names));
+	if (sns.sns_names == NULL)
+		RETURN(-ENOMEM);
+
+	OBD_ALLOC_LARGE(sns.sns_buf, sns.sns_buf_size);
+	if (sns.sns_buf == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	sns.sns_count = 0;
+	rc = ll_sa_dir_walk(dir, 0, INT_MAX, 0, ll_sa_names_cb, &sns);
+	if (rc < 0)
+		GOTO(out, rc);
+
+	sort(sns.sns_names, sns.sns_count, sizeof(*sns.sns_names),
+	     ll_sa_name_cmp, NULL);
+
+	for (i = 0, rc = 0; i < sns.sns_count && rc == 0; i++) {
+		rc = ll_sa_window_wait(sai);
+		if (rc == 0)
+			ll_statahead_one(parent, sns.sns_names[i].sn_name,
+					 sns.sns_names[i].sn_len);
+	}
+	EXIT;
+out:
+	if (sns.sns_buf != NULL)
+		OBD_FREE_LARGE(sns.sns_buf, sns.sns_buf_size);
+	OBD_FREE_LARGE(sns.sns_names, sns.sns_max * sizeof(*sns.sns_names));
+	return rc;
+}
+
 static int ll_statahead_thread(void *arg)
 {
         struct dentry            *parent = (struct dentry *)arg;
         struct inode             *dir    = parent->d_inode;
         struct ll_inode_info     *plli   = ll_i2info(dir);
-        struct ll_inode_info     *clli;
         struct ll_sb_info        *sbi    = ll_i2sbi(dir);
         struct ll_statahead_info *sai    = ll_sai_get(plli->lli_sai);
         struct ptlrpc_thread     *thread = &sai->sai_thread;
         struct ptlrpc_thread *agl_thread = &sai->sai_agl_thread;
         struct page              *page;
-        __u64                     pos    = 0;
-        int                       first  = 0;
+	__u64			  pos	 = sai->sai_start_hash;
+	/* the entry in lookup is the first one of the LS pattern */
+	int			  first  = sai->sai_pattern != SA_PATTERN_LS;
+	int			  release = 0;
         int                       rc     = 0;
         struct ll_dir_chain       chain;
         struct l_wait_info        lwi    = { 0 };
         ENTRY;
 
-        CDEBUG(D_READA, "statahead thread started: [pid %d] [parent %.*s]\n",
-               cfs_curproc_pid(), parent->d_name.len, parent->d_name.name);
+	CDEBUG(D_READA, "statahead thread started: [pid %d] [parent %.*s] "
+	       "[pattern %d]\n", cfs_curproc_pid(), parent->d_name.len,
+	       parent->d_name.name, sai->sai_pattern);
 
         if (sbi->ll_flags & LL_SBI_AGL_ENABLED)
                 ll_start_agl(parent, sai);
 
         atomic_inc(&sbi->ll_sa_total);
+	atomic_inc(&sbi->ll_sa_pattern_total[sai->sai_pattern]);
 	spin_lock(&plli->lli_sa_lock);
 	thread_set_flags(thread, SVC_RUNNING);
 	spin_unlock(&plli->lli_sa_lock);
 	cfs_waitq_signal(&thread->t_ctl_waitq);
 
 	ll_dir_chain_init(&chain);
+	if (sai->sai_pattern == SA_PATTERN_NAME) {
+		rc = ll_statahead_by_name(parent, sai);
+		if (rc == 0)
+			ll_statahead_drain(sai);
+		GOTO(out, rc = 0);
+	}
+
 	page = ll_get_dir_page(dir, pos, &chain);
 
         while (1) {
@@ -1118,6 +1625,11 @@ static int ll_statahead_thread(void *arg)
                                  */
                                 continue;
 
+			/* HASH pattern: skip up to the entry in lookup */
+			if (sai->sai_start_hash != 0 &&
+			    hash <= sai->sai_start_hash)
+				continue;
+
                         namelen = le16_to_cpu(ent->lde_namelen);
                         if (unlikely(namelen == 0))
                                 /*
@@ -1152,55 +1664,11 @@ static int ll_statahead_thread(void *arg)
                         if (unlikely(++first == 1))
                                 continue;
 
-keep_it:
-                        l_wait_event(thread->t_ctl_waitq,
-                                     !sa_sent_full(sai) ||
-                                     !sa_received_empty(sai) ||
-                                     !agl_list_empty(sai) ||
-                                     !thread_is_running(thread),
-                                     &lwi);
-
-interpret_it:
-                        while (!sa_received_empty(sai))
-				ll_post_statahead(sai);
-
-                        if (unlikely(!thread_is_running(thread))) {
-                                ll_release_page(page, 0);
-                                GOTO(out, rc = 0);
-                        }
-
-                        /* If no window for metadata statahead, but there are
-                         * some AGL entries to be triggered, then try to help
-                         * to process the AGL entries. */
-                        if (sa_sent_full(sai)) {
-				spin_lock(&plli->lli_agl_lock);
-				while (!agl_list_empty(sai)) {
-					clli = agl_first_entry(sai);
-					cfs_list_del_init(&clli->lli_agl_list);
-					spin_unlock(&plli->lli_agl_lock);
-                                        ll_agl_trigger(&clli->lli_vfs_inode,
-                                                       sai);
-
-                                        if (!sa_received_empty(sai))
-                                                goto interpret_it;
-
-                                        if (unlikely(
-                                                !thread_is_running(thread))) {
-                                                ll_release_page(page, 0);
-                                                GOTO(out, rc = 0);
-                                        }
-
-                                        if (!sa_sent_full(sai))
-                                                goto do_it;
-
-					spin_lock(&plli->lli_agl_lock);
-				}
-				spin_unlock(&plli->lli_agl_lock);
-
-                                goto keep_it;
-                        }
+			if (ll_sa_window_wait(sai) != 0) {
+				ll_release_page(page, 0);
+				GOTO(out, rc = 0);
+			}
 
-do_it:
                         ll_statahead_one(parent, name, namelen);
                 }
                 pos = le64_to_cpu(dp->ldp_hash_end);
@@ -1209,35 +1677,7 @@ do_it:
                          * End of directory reached.
                          */
                         ll_release_page(page, 0);
-                        while (1) {
-                                l_wait_event(thread->t_ctl_waitq,
-                                             !sa_received_empty(sai) ||
-                                             sai->sai_sent == sai->sai_replied||
-                                             !thread_is_running(thread),
-                                             &lwi);
-
-                                while (!sa_received_empty(sai))
-					ll_post_statahead(sai);
-
-                                if (unlikely(!thread_is_running(thread)))
-                                        GOTO(out, rc = 0);
-
-                                if (sai->sai_sent == sai->sai_replied &&
-                                    sa_received_empty(sai))
-                                        break;
-                        }
-
-			spin_lock(&plli->lli_agl_lock);
-			while (!agl_list_empty(sai) &&
-			       thread_is_running(thread)) {
-				clli = agl_first_entry(sai);
-				cfs_list_del_init(&clli->lli_agl_list);
-				spin_unlock(&plli->lli_agl_lock);
-				ll_agl_trigger(&clli->lli_vfs_inode, sai);
-				spin_lock(&plli->lli_agl_lock);
-			}
-			spin_unlock(&plli->lli_agl_lock);
-
+			ll_statahead_drain(sai);
                         GOTO(out, rc = 0);
                 } else if (1) {
                         /*
@@ -1288,9 +1728,16 @@ out:
 		spin_lock(&plli->lli_sa_lock);
 	}
 	thread_set_flags(thread, SVC_STOPPED);
+	/* no dir close releases a predicted statahead, do it here */
+	if (sai->sai_predicted && plli->lli_opendir_key == sai) {
+		plli->lli_opendir_key = NULL;
+		release = 1;
+	}
 	spin_unlock(&plli->lli_sa_lock);
         cfs_waitq_signal(&sai->sai_waitq);
         cfs_waitq_signal(&thread->t_ctl_waitq);
+	if (release)
+		ll_sai_put(sai);
         ll_sai_put(sai);
         dput(parent);
         CDEBUG(D_READA, "statahead thread stopped: [pid %d] [parent %.*s]\n",
@@ -1490,12 +1937,14 @@ ll_sai_unplug(struct ll_statahead_info *sai, struct ll_sa_entry *entry)
 
         ll_sa_entry_fini(sai, entry);
         if (hit) {
+		atomic_inc(&sbi->ll_sa_pattern_hit[sai->sai_pattern]);
                 sai->sai_hit++;
                 sai->sai_consecutive_miss = 0;
                 sai->sai_max = min(2 * sai->sai_max, sbi->ll_sa_max);
         } else {
                 struct ll_inode_info *lli = ll_i2info(sai->sai_inode);
 
+		atomic_inc(&sbi->ll_sa_pattern_miss[sai->sai_pattern]);
                 sai->sai_miss++;
                 sai->sai_consecutive_miss++;
                 if (sa_low_hit(sai) && thread_is_running(thread)) {
@@ -1520,6 +1969,277 @@ ll_sai_unplug(struct ll_statahead_info *sai, struct ll_sa_entry *entry)
 	EXIT;
 }
 
+/**
+ * Start the statahead thread of \a sai for \a dir, in lookup of \a dentry.
+ * The caller owns the statahead of \a dir; on failure \a sai is freed and
+ * the ownership dropped.
+ */
+static int ll_sa_start(struct inode *dir, struct dentry *dentry,
+		       struct ll_statahead_info *sai)
+{
+	struct ll_inode_info	*lli = ll_i2info(dir);
+	struct ll_inode_info	*plli;
+	struct ptlrpc_thread	*thread;
+	struct dentry		*parent;
+	struct l_wait_info	 lwi = { 0 };
+	int			 rc;
+	ENTRY;
+
+        sai->sai_inode = igrab(dir);
+        if (unlikely(sai->sai_inode == NULL)) {
+                CWARN("Do not start stat ahead on dying inode "DFID"\n",
+                      PFID(&lli->lli_fid));
+                GOTO(out, rc = -ESTALE);
+        }
+
+        /* get parent reference count here, and put it in ll_statahead_thread */
+	parent = dget(dentry->d_parent);
+        if (unlikely(sai->sai_inode != parent->d_inode)) {
+                struct ll_inode_info *nlli = ll_i2info(parent->d_inode);
+
+                CWARN("Race condition, someone changed %.*s just now: "
+                      "old parent "DFID", new parent "DFID"\n",
+		      dentry->d_name.len, dentry->d_name.name,
+                      PFID(&lli->lli_fid), PFID(&nlli->lli_fid));
+                dput(parent);
+                iput(sai->sai_inode);
+                GOTO(out, rc = -EAGAIN);
+        }
+
+        CDEBUG(D_READA, "start statahead thread: [pid %d] [parent %.*s]\n",
+               cfs_curproc_pid(), parent->d_name.len, parent->d_name.name);
+
+        lli->lli_sai = sai;
+
+	plli = ll_i2info(parent->d_inode);
+	rc = PTR_ERR(kthread_run(ll_statahead_thread, parent,
+				 "ll_sa_%u", plli->lli_opendir_pid));
+	thread = &sai->sai_thread;
+	if (IS_ERR_VALUE(rc)) {
+		CERROR("can't start ll_sa thread, rc: %d\n", rc);
+		dput(parent);
+		spin_lock(&lli->lli_sa_lock);
+                lli->lli_opendir_key = NULL;
+		spin_unlock(&lli->lli_sa_lock);
+                thread_set_flags(thread, SVC_STOPPED);
+                thread_set_flags(&sai->sai_agl_thread, SVC_STOPPED);
+                ll_sai_put(sai);
+                LASSERT(lli->lli_sai == NULL);
+                RETURN(-EAGAIN);
+        }
+
+        l_wait_event(thread->t_ctl_waitq,
+                     thread_is_running(thread) || thread_is_stopped(thread),
+                     &lwi);
+	RETURN(0);
+
+out:
+	ll_sai_free(sai);
+	spin_lock(&lli->lli_sa_lock);
+	lli->lli_opendir_key = NULL;
+	lli->lli_opendir_pid = 0;
+	spin_unlock(&lli->lli_sa_lock);
+	return rc;
+}
+
+/* locate a name in the dir for the predictor */
+struct ll_sa_locate {
+	const struct qstr	*sl_name;
+	/* hash of the previous name looked up, 0 if unknown */
+	__u64			 sl_prev;
+	/* hash of sl_name, 0 if not found */
+	__u64			 sl_hash;
+	/* first entry after sl_prev is checked, and is sl_name */
+	int			 sl_checked;
+	int			 sl_next;
+};
+
+static int ll_sa_locate_cb(struct lu_dirent *ent, __u64 hash, void *data)
+{
+	struct ll_sa_locate	*sl	 = data;
+	const struct qstr	*name	 = sl->sl_name;
+	int			 namelen = le16_to_cpu(ent->lde_namelen);
+	int			 match;
+
+	/* hidden entries are skipped, unless a hidden one is looked up */
+	if (ent->lde_name[0] == '.' && name->name[0] != '.')
+		return 0;
+
+	if (sl->sl_prev != 0 && hash <= sl->sl_prev)
+		return 0;
+
+	match = namelen == name->len &&
+		memcmp(ent->lde_name, name->name, namelen) == 0;
+	if (sl->sl_prev != 0 && !sl->sl_checked) {
+		sl->sl_checked = 1;
+		sl->sl_next = match;
+	}
+	if (!match)
+		return 0;
+
+	sl->sl_hash = hash;
+	return 1;
+}
+
+/**
+ * Track the lookups of a process in \a dir nobody runs statahead for, that
+ * is without the "ls -l" pattern is_first_dirent() detects, and start
+ * statahead when they follow:
+ * - readdir order from any entry (HASH pattern), e.g. "find", "du" or a
+ *   resumed "ls -l", detected on SA_PREDICT_HASH_SEQ lookups of the entries
+ *   following each other;
+ * - ascending name order (NAME pattern), e.g. rsync or a sorted list of
+ *   files, detected on SA_PREDICT_NAME_SEQ lookups of ascending names.
+ * The state is kept per dir, so a traversal hopping between a dir and its
+ * subdirs is still tracked when it comes back to the dir.
+ */
+void ll_sa_predict(struct inode *dir, struct dentry *dentry)
+{
+	struct ll_inode_info	 *lli  = ll_i2info(dir);
+	const struct qstr	 *name = &dentry->d_name;
+	struct ll_sa_locate	  sl   = { .sl_name = name };
+	struct ll_sa_predict	 *sap;
+	struct ll_statahead_info *sai;
+	enum ll_sa_pattern	  pattern;
+	char			  prev[SA_PREDICT_NAME_LEN];
+	int			  prevlen;
+	int			  cmp = 0;
+	ENTRY;
+
+	sap = lli->lli_sa_predict;
+	if (sap == NULL) {
+		OBD_ALLOC_PTR(sap);
+		if (sap == NULL)
+			RETURN_EXIT;
+
+		spin_lock(&lli->lli_sa_lock);
+		if (lli->lli_sa_predict == NULL) {
+			lli->lli_sa_predict = sap;
+			sap = NULL;
+		}
+		spin_unlock(&lli->lli_sa_lock);
+		if (sap != NULL)
+			OBD_FREE_PTR(sap);
+		sap = lli->lli_sa_predict;
+	}
+
+	spin_lock(&lli->lli_sa_lock);
+	if (sap->sap_pid != cfs_curproc_pid()) {
+		if (sap->sap_pid != 0 &&
+		    sap->sap_lookups < SA_PREDICT_LOOKUPS_MAX &&
+		    cfs_time_before(cfs_time_current(),
+				    cfs_time_add(sap->sap_time,
+				    cfs_time_seconds(SA_PREDICT_IDLE)))) {
+			spin_unlock(&lli->lli_sa_lock);
+			RETURN_EXIT;
+		}
+		memset(sap, 0, sizeof(*sap));
+		sap->sap_pid = cfs_curproc_pid();
+	}
+	sap->sap_time = cfs_time_current();
+	if (sap->sap_lookups >= SA_PREDICT_LOOKUPS_MAX) {
+		spin_unlock(&lli->lli_sa_lock);
+		RETURN_EXIT;
+	}
+	sl.sl_prev = sap->sap_hash;
+	prevlen = sap->sap_namelen;
+	memcpy(prev, sap->sap_name, min(prevlen, SA_PREDICT_NAME_LEN));
+	spin_unlock(&lli->lli_sa_lock);
+
+	/* a lookup must not wait for directory pages, only the cached ones
+	 * are scanned: the traversals followed here read the dir first */
+	ll_sa_dir_walk(dir, sl.sl_prev, SA_PREDICT_SCAN_PAGES, 1,
+		       ll_sa_locate_cb, &sl);
+
+	/* only the prefix of a long previous name is known, a name with the
+	 * same prefix is taken as following it */
+	if (prevlen > 0) {
+		cmp = memcmp(name->name, prev,
+			     min_t(int, name->len,
+				   min(prevlen, SA_PREDICT_NAME_LEN)));
+		if (cmp == 0)
+			cmp = prevlen > SA_PREDICT_NAME_LEN &&
+			      name->len >= SA_PREDICT_NAME_LEN ? 1 :
+			      name->len - prevlen;
+	}
+
+	spin_lock(&lli->lli_sa_lock);
+	if (sap->sap_pid != cfs_curproc_pid()) {
+		/* another process took over the predictor */
+		spin_unlock(&lli->lli_sa_lock);
+		RETURN_EXIT;
+	}
+	sap->sap_lookups++;
+	sap->sap_hash_seq = sl.sl_next ? sap->sap_hash_seq + 1 : 0;
+	sap->sap_name_seq = cmp > 0 ? sap->sap_name_seq + 1 : 0;
+	sap->sap_hash = sl.sl_hash;
+	sap->sap_namelen = name->len;
+	memcpy(sap->sap_name, name->name,
+	       min_t(int, name->len, SA_PREDICT_NAME_LEN));
+
+	if (sap->sap_hash_seq >= SA_PREDICT_HASH_SEQ) {
+		pattern = SA_PATTERN_HASH;
+	} else if (sap->sap_name_seq >= SA_PREDICT_NAME_SEQ) {
+		pattern = SA_PATTERN_NAME;
+	} else {
+		spin_unlock(&lli->lli_sa_lock);
+		RETURN_EXIT;
+	}
+	/* track the process again once this statahead is over */
+	sap->sap_lookups = 0;
+	sap->sap_hash_seq = 0;
+	sap->sap_name_seq = 0;
+	spin_unlock(&lli->lli_sa_lock);
+
+	sai = ll_sai_alloc();
+	if (sai == NULL)
+		RETURN_EXIT;
+
+	sai->sai_pattern = pattern;
+	sai->sai_predicted = 1;
+	sai->sai_ls_all = name->name[0] == '.';
+	if (pattern == SA_PATTERN_HASH) {
+		sai->sai_start_hash = sl.sl_hash;
+	} else {
+		OBD_ALLOC(sai->sai_start_name, name->len);
+		if (sai->sai_start_name == NULL) {
+			ll_sai_free(sai);
+			RETURN_EXIT;
+		}
+		memcpy(sai->sai_start_name, name->name, name->len);
+		sai->sai_start_namelen = name->len;
+	}
+
+	/* no dir close stops a predicted statahead, \a sai itself is the key
+	 * the statahead thread releases it with on exit */
+	spin_lock(&lli->lli_sa_lock);
+	if (lli->lli_opendir_key != NULL || lli->lli_opendir_pid != 0 ||
+	    lli->lli_sai != NULL) {
+		spin_unlock(&lli->lli_sa_lock);
+		ll_sai_free(sai);
+		RETURN_EXIT;
+	}
+	lli->lli_opendir_key = sai;
+	lli->lli_opendir_pid = cfs_curproc_pid();
+	spin_unlock(&lli->lli_sa_lock);
+
+	CDEBUG(D_READA, "predicted pattern %d for lookups in dir "DFID
+	       ": [pid %d] [name %.*s]\n", pattern, PFID(&lli->lli_fid),
+	       cfs_curproc_pid(), name->len, name->name);
+	ll_sa_start(dir, dentry, sai);
+	EXIT;
+}
+
+void ll_sa_predict_fini(struct inode *dir)
+{
+	struct ll_inode_info *lli = ll_i2info(dir);
+
+	if (lli->lli_sa_predict != NULL) {
+		OBD_FREE_PTR(lli->lli_sa_predict);
+		lli->lli_sa_predict = NULL;
+	}
+}
+
 /**
  * Start statahead thread if this is the first dir entry.
  * Otherwise if a thread is started already, wait it until it is ahead of me.
@@ -1533,24 +2253,28 @@ int do_statahead_enter(struct inode *dir, struct dentry **dentryp,
                        int only_unplug)
 {
         struct ll_inode_info     *lli   = ll_i2info(dir);
-        struct ll_statahead_info *sai   = lli->lli_sai;
-        struct dentry            *parent;
+	struct ll_statahead_info *sai   = NULL;
         struct ll_sa_entry       *entry;
         struct ptlrpc_thread     *thread;
         struct l_wait_info        lwi   = { 0 };
         int                       rc    = 0;
-	struct ll_inode_info     *plli;
         ENTRY;
 
         LASSERT(lli->lli_opendir_pid == cfs_curproc_pid());
 
+	/* the statahead thread may release a predicted statahead anytime */
+	spin_lock(&lli->lli_sa_lock);
+	if (lli->lli_sai != NULL)
+		sai = ll_sai_get(lli->lli_sai);
+	spin_unlock(&lli->lli_sa_lock);
+
         if (sai) {
                 thread = &sai->sai_thread;
                 if (unlikely(thread_is_stopped(thread) &&
                              cfs_list_empty(&sai->sai_entries_stated))) {
                         /* to release resource */
                         ll_stop_statahead(dir, lli->lli_opendir_key);
-                        RETURN(-EAGAIN);
+                        GOTO(out_put, rc = -EAGAIN);
                 }
 
                 if ((*dentryp)->d_name.name[0] == '.') {
@@ -1576,14 +2300,14 @@ int do_statahead_enter(struct inode *dir, struct dentry **dentryp,
                                  * "sai_ls_all" enabled as above.
                                  */
                                 sai->sai_miss_hidden++;
-                                RETURN(-EAGAIN);
+                                GOTO(out_put, rc = -EAGAIN);
                         }
                 }
 
                 entry = ll_sa_entry_get_byname(sai, &(*dentryp)->d_name);
                 if (entry == NULL || only_unplug) {
                         ll_sai_unplug(sai, entry);
-                        RETURN(entry ? 1 : -EAGAIN);
+                        GOTO(out_put, rc = entry ? 1 : -EAGAIN);
                 }
 
 		/* if statahead is busy in readdir, help it do post-work */
@@ -1602,7 +2326,7 @@ int do_statahead_enter(struct inode *dir, struct dentry **dentryp,
                                           &lwi);
                         if (rc < 0) {
                                 ll_sai_unplug(sai, entry);
-                                RETURN(-EAGAIN);
+                                GOTO(out_put, rc = -EAGAIN);
                         }
                 }
 
@@ -1632,7 +2356,7 @@ int do_statahead_enter(struct inode *dir, struct dentry **dentryp,
                                               inode->i_ino,
                                               inode->i_generation);
                                         ll_sai_unplug(sai, entry);
-                                        RETURN(-ESTALE);
+                                        GOTO(out_put, rc = -ESTALE);
                                 } else {
 					iput(inode);
 				}
@@ -1646,77 +2370,41 @@ int do_statahead_enter(struct inode *dir, struct dentry **dentryp,
                 }
 
                 ll_sai_unplug(sai, entry);
-                RETURN(rc);
+		EXIT;
+out_put:
+		ll_sai_put(sai);
+		return rc;
         }
 
         /* I am the "lli_opendir_pid" owner, only me can set "lli_sai". */
         rc = is_first_dirent(dir, *dentryp);
-        if (rc == LS_NONE_FIRST_DE)
-                /* It is not "ls -{a}l" operation, no need statahead for it. */
-                GOTO(out, rc = -EAGAIN);
+	if (rc == LS_NONE_FIRST_DE) {
+		/* It is not "ls -{a}l" operation, but the lookups may still
+		 * follow another pattern. */
+		spin_lock(&lli->lli_sa_lock);
+		lli->lli_opendir_key = NULL;
+		lli->lli_opendir_pid = 0;
+		spin_unlock(&lli->lli_sa_lock);
+		ll_sa_predict(dir, *dentryp);
+		RETURN(-EAGAIN);
+	}
 
         sai = ll_sai_alloc();
-        if (sai == NULL)
-                GOTO(out, rc = -ENOMEM);
+	if (sai == NULL) {
+		spin_lock(&lli->lli_sa_lock);
+		lli->lli_opendir_key = NULL;
+		lli->lli_opendir_pid = 0;
+		spin_unlock(&lli->lli_sa_lock);
+		RETURN(-ENOMEM);
+	}
 
         sai->sai_ls_all = (rc == LS_FIRST_DOT_DE);
-        sai->sai_inode = igrab(dir);
-        if (unlikely(sai->sai_inode == NULL)) {
-                CWARN("Do not start stat ahead on dying inode "DFID"\n",
-                      PFID(&lli->lli_fid));
-                GOTO(out, rc = -ESTALE);
-        }
-
-        /* get parent reference count here, and put it in ll_statahead_thread */
-        parent = dget((*dentryp)->d_parent);
-        if (unlikely(sai->sai_inode != parent->d_inode)) {
-                struct ll_inode_info *nlli = ll_i2info(parent->d_inode);
-
-                CWARN("Race condition, someone changed %.*s just now: "
-                      "old parent "DFID", new parent "DFID"\n",
-                      (*dentryp)->d_name.len, (*dentryp)->d_name.name,
-                      PFID(&lli->lli_fid), PFID(&nlli->lli_fid));
-                dput(parent);
-                iput(sai->sai_inode);
-                GOTO(out, rc = -EAGAIN);
-        }
-
-        CDEBUG(D_READA, "start statahead thread: [pid %d] [parent %.*s]\n",
-               cfs_curproc_pid(), parent->d_name.len, parent->d_name.name);
-
-        lli->lli_sai = sai;
-
-	plli = ll_i2info(parent->d_inode);
-	rc = PTR_ERR(kthread_run(ll_statahead_thread, parent,
-				 "ll_sa_%u", plli->lli_opendir_pid));
-	thread = &sai->sai_thread;
-	if (IS_ERR_VALUE(rc)) {
-		CERROR("can't start ll_sa thread, rc: %d\n", rc);
-		dput(parent);
-                lli->lli_opendir_key = NULL;
-                thread_set_flags(thread, SVC_STOPPED);
-                thread_set_flags(&sai->sai_agl_thread, SVC_STOPPED);
-                ll_sai_put(sai);
-                LASSERT(lli->lli_sai == NULL);
-                RETURN(-EAGAIN);
-        }
-
-        l_wait_event(thread->t_ctl_waitq,
-                     thread_is_running(thread) || thread_is_stopped(thread),
-                     &lwi);
+	sai->sai_pattern = SA_PATTERN_LS;
+	rc = ll_sa_start(dir, *dentryp, sai);
 
         /*
          * We don't stat-ahead for the first dirent since we are already in
          * lookup.
          */
-        RETURN(-EAGAIN);
-
-out:
-        if (sai != NULL)
-                OBD_FREE_PTR(sai);
-	spin_lock(&lli->lli_sa_lock);
-	lli->lli_opendir_key = NULL;
-	lli->lli_opendir_pid = 0;
-	spin_unlock(&lli->lli_sa_lock);
-	return rc;
+	RETURN(rc == 0 ? -EAGAIN : rc);
 }
@@ -338,6 +338,13 @@ static int vvp_io_setattr_lock(const struct lu_env *env,
 	__u64 new_size;
 	__u32 enqflags = 0;
 
+	if (cl_io_is_fallocate(io)) {
+		cio->u.setattr.cui_local_lock = SETATTR_EXTENT_LOCK;
+		return ccc_io_one_lock(env, io, 0, CLM_WRITE,
+				       io->u.ci_setattr.sa_falloc_offset,
+				       io->u.ci_setattr.sa_falloc_end - 1);
+	}
+
         if (cl_io_is_trunc(io)) {
                 new_size = io->u.ci_setattr.sa_attr.lvb_size;
                 if (new_size == 0)
@@ -437,6 +444,13 @@ static void vvp_io_setattr_end(const struct lu_env *env,
 		 * because osc has already notified to destroy osc_extents. */
 		vvp_do_vmtruncate(inode, io->u.ci_setattr.sa_attr.lvb_size);
 		inode_dio_write_done(inode);
+	} else if (cl_io_is_fallocate(io) && io->ci_result == 0 &&
+		   !(io->u.ci_setattr.sa_falloc_mode & OST_FALLOC_KEEP_SIZE)) {
+		/* the OSTs extended the objects, do the same for the file */
+		ll_inode_size_lock(inode);
+		if (i_size_read(inode) < io->u.ci_setattr.sa_falloc_end)
+			i_size_write(inode, io->u.ci_setattr.sa_falloc_end);
+		ll_inode_size_unlock(inode);
 	}
 	mutex_unlock(&inode->i_mutex);
 }
@@ -105,6 +105,253 @@ int xattr_type_filter(struct ll_sb_info *sbi, int xattr_type)
         return 0;
 }
 
+/* names and values the MDS packs for the xattr cache, at most */
+#define LL_XATTR_CACHE_SIZE	4096
+
+/**
+ * All the xattrs of an inode, fetched in one getxattr RPC and valid as long
+ * as the client holds an UPDATE lock on the inode: any xattr or mode change
+ * on the MDS revokes it, see ll_md_blocking_ast().
+ */
+struct ll_xattr_cache {
+	int	 lxc_count;
+	int	 lxc_names_len;
+	int	 lxc_size;
+	/* value lengths */
+	__u32	*lxc_lens;
+	/* names, as listxattr returns them */
+	char	*lxc_names;
+	/* values, in the order of the names */
+	char	*lxc_vals;
+	char	 lxc_buf[0];
+};
+
+void ll_xattr_cache_invalidate(struct inode *inode)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ll_xattr_cache	*lxc;
+
+	spin_lock(&lli->lli_lock);
+	lxc = lli->lli_xattr_cache;
+	lli->lli_xattr_cache = NULL;
+	lli->lli_xattr_gen++;
+	lli->lli_flags &= ~LLIF_XATTR_UNCACHED;
+	spin_unlock(&lli->lli_lock);
+
+	if (lxc != NULL)
+		OBD_FREE_LARGE(lxc, lxc->lxc_size);
+}
+
+/**
+ * Get xattr \a name, or the list of the names if \a name is NULL, from the
+ * xattr cache of \a inode.
+ *
+ * \retval -EAGAIN	the xattrs are not cached
+ */
+static int ll_xattr_cache_get(struct inode *inode, const char *name,
+			      void *buffer, size_t size)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ll_xattr_cache	*lxc;
+	const char		*xname;
+	const char		*xval = NULL;
+	int			 len = -ENODATA;
+	int			 i;
+
+	spin_lock(&lli->lli_lock);
+	lxc = lli->lli_xattr_cache;
+	if (lxc == NULL) {
+		spin_unlock(&lli->lli_lock);
+		return -EAGAIN;
+	}
+
+	if (name == NULL) {
+		len = lxc->lxc_names_len;
+		xval = lxc->lxc_names;
+	} else {
+		xname = lxc->lxc_names;
+		xval = lxc->lxc_vals;
+		for (i = 0; i < lxc->lxc_count; i++) {
+			if (strcmp(xname, name) == 0) {
+				len = lxc->lxc_lens[i];
+				break;
+			}
+			xname += strlen(xname) + 1;
+			xval += lxc->lxc_lens[i];
+		}
+	}
+
+	if (len >= 0 && size != 0) {
+		if (size < len)
+			len = -ERANGE;
+		else
+			memcpy(buffer, xval, len);
+	}
+	spin_unlock(&lli->lli_lock);
+
+	return len;
+}
+
+/**
+ * Fetch all the xattrs of \a inode into its xattr cache, if the client
+ * holds an UPDATE lock on it.
+ */
+static int ll_xattr_cache_refill(struct inode *inode)
+{
+	struct ll_sb_info	*sbi  = ll_i2sbi(inode);
+	struct ll_inode_info	*lli  = ll_i2info(inode);
+	ldlm_policy_data_t	 policy = {
+				.l_inodebits = { MDS_INODELOCK_UPDATE } };
+	struct ptlrpc_request	*req  = NULL;
+	struct ll_xattr_cache	*lxc  = NULL;
+	struct lustre_handle	 lockh;
+	struct obd_capa		*oc;
+	struct mdt_body		*body;
+	ldlm_mode_t		 mode;
+	__u32			*lens;
+	char			*names = NULL;
+	char			*vals  = NULL;
+	int			 lens_size;
+	int			 vals_len;
+	int			 count;
+	int			 size;
+	int			 gen;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	if (lli->lli_flags & LLIF_XATTR_UNCACHED)
+		RETURN(-EFBIG);
+
+	/* the UPDATE lock cannot be cancelled while it is referenced, so the
+	 * xattrs are invalidated after they are cached */
+	mode = md_lock_match(sbi->ll_md_exp, LDLM_FL_BLOCK_GRANTED,
+			     ll_inode2fid(inode), LDLM_IBITS, &policy,
+			     LCK_CR | LCK_CW | LCK_PR | LCK_PW, &lockh);
+	if (mode == 0)
+		RETURN(-ENOLCK);
+
+	spin_lock(&lli->lli_lock);
+	gen = lli->lli_xattr_gen;
+	spin_unlock(&lli->lli_lock);
+
+	oc = ll_mdscapa_get(inode);
+	rc = md_getxattr(sbi->ll_md_exp, ll_inode2fid(inode), oc,
+			 OBD_MD_FLXATTRALL, NULL, NULL, 0,
+			 LL_XATTR_CACHE_SIZE, 0, &req);
+	capa_put(oc);
+	if (rc == -ERANGE) {
+		spin_lock(&lli->lli_lock);
+		if (lli->lli_xattr_gen == gen)
+			lli->lli_flags |= LLIF_XATTR_UNCACHED;
+		spin_unlock(&lli->lli_lock);
+	}
+	if (rc != 0)
+		GOTO(out, rc);
+
+	body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+	lens_size = req_capsule_get_size(&req->rq_pill, &RMF_EAVALS_LENS,
+					 RCL_SERVER);
+	lens = req_capsule_server_sized_get(&req->rq_pill, &RMF_EAVALS_LENS,
+					    lens_size);
+	vals_len = req_capsule_get_size(&req->rq_pill, &RMF_EAVALS,
+					RCL_SERVER);
+	if (body == NULL || (lens_size != 0 && lens == NULL))
+		GOTO(out, rc = -EPROTO);
+
+	count = lens_size / sizeof(*lens);
+	if (body->eadatasize != 0) {
+		names = req_capsule_server_sized_get(&req->rq_pill,
+						     &RMF_EADATA,
+						     body->eadatasize);
+		vals = req_capsule_server_sized_get(&req->rq_pill, &RMF_EAVALS,
+						    vals_len);
+		if (names == NULL || (vals_len != 0 && vals == NULL))
+			GOTO(out, rc = -EPROTO);
+	}
+
+	/* check that the names and values match */
+	for (i = 0, rc = 0, size = 0; i < body->eadatasize; i++)
+		if (names[i] == '\0')
+			rc++;
+	for (i = 0; i < count; i++)
+		size += lens[i];
+	if (rc != count || size != vals_len ||
+	    (count != 0 && names[body->eadatasize - 1] != '\0')) {
+		CERROR("%s: bad xattrs of "DFID": %d names, %d values of %d "
+		       "bytes\n", ll_get_fsname(inode->i_sb, NULL, 0),
+		       PFID(ll_inode2fid(inode)), rc, count, vals_len);
+		GOTO(out, rc = -EPROTO);
+	}
+
+	size = sizeof(*lxc) + lens_size + body->eadatasize + vals_len;
+	OBD_ALLOC_LARGE(lxc, size);
+	if (lxc == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	lxc->lxc_count = count;
+	lxc->lxc_names_len = body->eadatasize;
+	lxc->lxc_size = size;
+	lxc->lxc_lens = (__u32 *)lxc->lxc_buf;
+	lxc->lxc_names = lxc->lxc_buf + lens_size;
+	lxc->lxc_vals = lxc->lxc_names + body->eadatasize;
+	if (count != 0) {
+		memcpy(lxc->lxc_lens, lens, lens_size);
+		memcpy(lxc->lxc_names, names, body->eadatasize);
+		memcpy(lxc->lxc_vals, vals, vals_len);
+	}
+
+	spin_lock(&lli->lli_lock);
+	if (lli->lli_xattr_gen == gen && lli->lli_xattr_cache == NULL) {
+		lli->lli_xattr_cache = lxc;
+		lxc = NULL;
+	}
+	spin_unlock(&lli->lli_lock);
+	if (lxc != NULL)
+		OBD_FREE_LARGE(lxc, size);
+	rc = 0;
+	EXIT;
+out:
+	if (req != NULL)
+		ptlrpc_req_finished(req);
+	ldlm_lock_decref(&lockh, mode);
+	return rc;
+}
+
+/**
+ * Serve getxattr of \a name, or listxattr if \a name is NULL, from the
+ * xattr cache, filling it first if needed.
+ *
+ * \retval -EAGAIN	the xattrs cannot be cached, ask the MDS
+ */
+static int ll_xattr_cache_lookup(struct inode *inode, const char *name,
+				 void *buffer, size_t size)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	int		   rc;
+
+	if (!(sbi->ll_flags & LL_SBI_XATTR_CACHE) ||
+	    sbi->ll_flags & LL_SBI_RMT_CLIENT ||
+	    !(exp_connect_flags(sbi->ll_md_exp) & OBD_CONNECT_XATTR_ALL))
+		return -EAGAIN;
+
+	rc = ll_xattr_cache_get(inode, name, buffer, size);
+	if (rc != -EAGAIN) {
+		ll_stats_ops_tally(sbi, LPROC_LL_GETXATTR_HITS, 1);
+		return rc;
+	}
+
+	ll_stats_ops_tally(sbi, LPROC_LL_GETXATTR_MISSES, 1);
+	rc = ll_xattr_cache_refill(inode);
+	if (rc != 0) {
+		CDEBUG(D_CACHE, "cannot cache xattrs of "DFID": rc = %d\n",
+		       PFID(ll_inode2fid(inode)), rc);
+		return -EAGAIN;
+	}
+
+	return ll_xattr_cache_get(inode, name, buffer, size);
+}
+
 static
 int ll_setxattr_common(struct inode *inode, const char *name,
                        const void *value, size_t size,
@@ -204,6 +451,8 @@ int ll_setxattr_common(struct inode *inode, const char *name,
                 RETURN(rc);
         }
 
+	/* the MDS revokes the UPDATE lock too, do not wait for it */
+	ll_xattr_cache_invalidate(inode);
         ptlrpc_req_finished(req);
         RETURN(0);
 }
@@ -354,6 +603,12 @@ int ll_getxattr_common(struct inode *inode, const char *name,
 #endif
 
 do_getxattr:
+	if (rce == NULL) {
+		rc = ll_xattr_cache_lookup(inode, name, buffer, size);
+		if (rc != -EAGAIN)
+			RETURN(rc);
+	}
+
         oc = ll_mdscapa_get(inode);
         rc = md_getxattr(sbi->ll_md_exp, ll_inode2fid(inode), oc,
                          valid | (rce ? rce_ops2valid(rce->rce_ops) : 0),
@@ -42,6 +42,11 @@
 
 #define LMV_MAX_TGT_COUNT 128
 
+/* seconds a target statfs is used for QOS placement before refreshing it */
+#define LMV_QOS_DEFAULT_MAXAGE	5
+/* request rate (per second) under which an MDT counts as lightly loaded */
+#define LMV_QOS_RATE_BASE	1000
+
 #define lmv_init_lock(lmv)   mutex_lock(&lmv->init_mutex);
 #define lmv_init_unlock(lmv) mutex_unlock(&lmv->init_mutex);
 
@@ -142,9 +147,16 @@ lmv_find_target(struct lmv_obd *lmv, const struct lu_fid *fid)
         return lmv_get_target(lmv, mds);
 }
 
+void lmv_stripe_fid(struct lmv_stripe_md *mea, struct lu_fid *fid,
+		    const char *name, int namelen);
 struct lmv_tgt_desc
 *lmv_locate_mds(struct lmv_obd *lmv, struct md_op_data *op_data,
 		struct lu_fid *fid);
+/* lmv_qos.c */
+void lmv_qos_tgt_update(struct lmv_obd *lmv, struct lmv_tgt_desc *tgt,
+			const struct obd_statfs *osfs);
+int lmv_qos_choose(struct lmv_obd *lmv, mdsno_t *mds);
+
 /* lproc_lmv.c */
 #ifdef LPROCFS
 void lprocfs_lmv_init_vars(struct lprocfs_static_vars *lvars);
@@ -299,6 +299,10 @@ static int lmv_init_ea_size(struct obd_export *exp, int easize,
         int                  change = 0;
         ENTRY;
 
+	/* replies must have room for a directory striped over all MDTs */
+	if (easize < lmv_stripe_md_size(lmv->desc.ld_tgt_count))
+		easize = lmv_stripe_md_size(lmv->desc.ld_tgt_count);
+
         if (lmv->max_easize < easize) {
                 lmv->max_easize = easize;
                 change = 1;
@@ -1274,6 +1278,12 @@ static int lmv_placement_policy(struct obd_device *obd,
 			*mds = lum->lum_stripe_offset;
 			RETURN(0);
 		}
+
+		/* no MDT given, spread the remote directories over them */
+		if (lum->lum_type == LMV_STRIPE_TYPE &&
+		    lmv->lmv_placement == PLACEMENT_QOS_POLICY &&
+		    lmv_qos_choose(lmv, mds) == 0)
+			RETURN(0);
 	}
 
 	/* Allocate new fid on target according to operation type and parent
@@ -1377,6 +1387,7 @@ static int lmv_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	lmv->max_def_easize = 0;
 	lmv->max_easize = 0;
 	lmv->lmv_placement = PLACEMENT_CHAR_POLICY;
+	lmv->lmv_qos_maxage = LMV_QOS_DEFAULT_MAXAGE;
 
 	spin_lock_init(&lmv->lmv_lock);
 	mutex_init(&lmv->init_mutex);
@@ -1487,6 +1498,7 @@ static int lmv_statfs(const struct lu_env *env, struct obd_export *exp,
 			       rc);
 			GOTO(out_free_temp, rc);
 		}
+		lmv_qos_tgt_update(lmv, lmv->tgts[i], temp);
 
 		if (i == 0) {
 			*osfs = *temp;
@@ -1690,12 +1702,34 @@ static int lmv_close(struct obd_export *exp, struct md_op_data *op_data,
         RETURN(rc);
 }
 
+/**
+ * Replace \a fid, the FID of a directory striped as \a mea, with the FID of
+ * the shard holding \a name. Nothing to do for a plain directory.
+ */
+void lmv_stripe_fid(struct lmv_stripe_md *mea, struct lu_fid *fid,
+		    const char *name, int namelen)
+{
+	if (mea == NULL || mea->mea_count <= 1 || name == NULL || namelen == 0)
+		return;
+
+	*fid = mea->mea_ids[mea_name2idx(mea, name, namelen)];
+}
+
+/**
+ * Find the MDT to send an operation on \a fid to. The parent of a name
+ * operation, op_fid1 striped as op_mea1, is first replaced by the shard
+ * holding op_name.
+ */
 struct lmv_tgt_desc
 *lmv_locate_mds(struct lmv_obd *lmv, struct md_op_data *op_data,
 		struct lu_fid *fid)
 {
 	struct lmv_tgt_desc *tgt;
 
+	if (fid == &op_data->op_fid1)
+		lmv_stripe_fid(op_data->op_mea1, fid, op_data->op_name,
+			       op_data->op_namelen);
+
 	tgt = lmv_find_target(lmv, fid);
 	if (IS_ERR(tgt))
 		return tgt;
@@ -1705,6 +1739,69 @@ struct lmv_tgt_desc
 	return tgt;
 }
 
+/**
+ * Allocate the FIDs of a new directory striped over lum_stripe_count MDTs
+ * and pack the stripe EA that the MDT creating it is sent. The master stays
+ * on the MDT of the parent, which creates the shards: shard 0 on
+ * lum_stripe_offset (or the parent MDT, or the one the QOS placement chose)
+ * and the others on the next MDTs.
+ */
+static int lmv_create_stripes(struct lmv_obd *lmv, struct lmv_tgt_desc *tgt,
+			      struct md_op_data *op_data,
+			      const struct lmv_user_md *lum,
+			      struct lmv_stripe_md **meap, int *measize)
+{
+	struct lmv_stripe_md	*mea;
+	struct lu_fid		 fid;
+	__u32			 count = lum->lum_stripe_count;
+	__u32			 offset = lum->lum_stripe_offset;
+	int			 size;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	if (!(exp_connect_flags(tgt->ltd_exp) & OBD_CONNECT_DIR_STRIPE))
+		RETURN(-EOPNOTSUPP);
+
+	if (count > lmv->desc.ld_tgt_count)
+		RETURN(-EINVAL);
+
+	if (offset == (__u32)-1 &&
+	    (lmv->lmv_placement != PLACEMENT_QOS_POLICY ||
+	     lmv_qos_choose(lmv, &offset) != 0))
+		offset = tgt->ltd_idx;
+	if (offset >= lmv->desc.ld_tgt_count)
+		RETURN(-ERANGE);
+
+	size = lmv_stripe_md_size(count);
+	OBD_ALLOC_LARGE(mea, size);
+	if (mea == NULL)
+		RETURN(-ENOMEM);
+
+	rc = __lmv_fid_alloc(lmv, &op_data->op_fid2, tgt->ltd_idx);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	mea->mea_magic = cpu_to_le32(MEA_MAGIC_ALL_CHARS);
+	mea->mea_count = cpu_to_le32(count);
+	mea->mea_master = cpu_to_le32(tgt->ltd_idx);
+	for (i = 0; i < count; i++) {
+		rc = __lmv_fid_alloc(lmv, &fid,
+				     (offset + i) % lmv->desc.ld_tgt_count);
+		if (rc != 0)
+			GOTO(out, rc);
+		fid_cpu_to_le(&mea->mea_ids[i], &fid);
+	}
+
+	*meap = mea;
+	*measize = size;
+	EXIT;
+out:
+	if (rc != 0)
+		OBD_FREE_LARGE(mea, size);
+	return rc;
+}
+
 int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
                const void *data, int datalen, int mode, __u32 uid,
                __u32 gid, cfs_cap_t cap_effective, __u64 rdev,
@@ -1713,6 +1810,8 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	struct obd_device       *obd = exp->exp_obd;
 	struct lmv_obd          *lmv = &obd->u.lmv;
 	struct lmv_tgt_desc     *tgt;
+	struct lmv_stripe_md	*mea = NULL;
+	int			 measize = 0;
 	int                      rc;
 	ENTRY;
 
@@ -1727,9 +1826,19 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
 
-	rc = lmv_fid_alloc(exp, &op_data->op_fid2, op_data);
-	if (rc)
-		RETURN(rc);
+	if (op_data->op_cli_flags & CLI_SET_MEA && S_ISDIR(mode) &&
+	    ((const struct lmv_user_md *)data)->lum_stripe_count > 1) {
+		rc = lmv_create_stripes(lmv, tgt, op_data, data, &mea,
+					&measize);
+		if (rc)
+			RETURN(rc);
+		data = mea;
+		datalen = measize;
+	} else {
+		rc = lmv_fid_alloc(exp, &op_data->op_fid2, op_data);
+		if (rc)
+			RETURN(rc);
+	}
 
 	CDEBUG(D_INODE, "CREATE '%*s' on "DFID" -> mds #%x\n",
 	       op_data->op_namelen, op_data->op_name, PFID(&op_data->op_fid1),
@@ -1738,6 +1847,8 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	op_data->op_flags |= MF_MDC_CANCEL_FID1;
 	rc = md_create(tgt->ltd_exp, op_data, data, datalen, mode, uid, gid,
 		       cap_effective, rdev, request);
+	if (mea != NULL)
+		OBD_FREE_LARGE(mea, measize);
 
 	if (rc == 0) {
 		if (*request == NULL)
@@ -1987,6 +2098,8 @@ static int lmv_link(struct obd_export *exp, struct md_op_data *op_data,
 	op_data->op_fsuid = cfs_curproc_fsuid();
 	op_data->op_fsgid = cfs_curproc_fsgid();
 	op_data->op_cap = cfs_curproc_cap_pack();
+	lmv_stripe_fid(op_data->op_mea2, &op_data->op_fid2, op_data->op_name,
+		       op_data->op_namelen);
 	tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid2);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
@@ -2029,6 +2142,10 @@ static int lmv_rename(struct obd_export *exp, struct md_op_data *op_data,
 	op_data->op_fsuid = cfs_curproc_fsuid();
 	op_data->op_fsgid = cfs_curproc_fsgid();
 	op_data->op_cap = cfs_curproc_cap_pack();
+	/* the old and new names pick the shards of striped parents, a rename
+	 * between shards on different MDTs is not supported */
+	lmv_stripe_fid(op_data->op_mea1, &op_data->op_fid1, old, oldlen);
+	lmv_stripe_fid(op_data->op_mea2, &op_data->op_fid2, new, newlen);
 	src_tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid1);
 	if (IS_ERR(src_tgt))
 		RETURN(PTR_ERR(src_tgt));
@@ -2036,6 +2153,10 @@ static int lmv_rename(struct obd_export *exp, struct md_op_data *op_data,
 	tgt_tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid2);
 	if (IS_ERR(tgt_tgt))
 		RETURN(PTR_ERR(tgt_tgt));
+
+	if ((op_data->op_mea1 != NULL || op_data->op_mea2 != NULL) &&
+	    src_tgt != tgt_tgt)
+		RETURN(-EXDEV);
 	/*
 	 * LOOKUP lock on src child (fid3) should also be cancelled for
 	 * src_tgt in mdc_rename.
@@ -2266,6 +2387,61 @@ static int lmv_readpage(struct obd_export *exp, struct md_op_data *op_data,
 	RETURN(rc);
 }
 
+static int lmv_dom_rw(struct obd_export *exp, struct md_op_data *op_data,
+		      struct page **pages, int rw,
+		      struct ptlrpc_request **request)
+{
+	struct obd_device	*obd = exp->exp_obd;
+	struct lmv_obd		*lmv = &obd->u.lmv;
+	struct lmv_tgt_desc	*tgt;
+	int			 rc;
+	ENTRY;
+
+	rc = lmv_check_connect(obd);
+	if (rc)
+		RETURN(rc);
+
+	tgt = lmv_find_target(lmv, &op_data->op_fid1);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	rc = md_dom_rw(tgt->ltd_exp, op_data, pages, rw, request);
+	RETURN(rc);
+}
+
+static int lmv_unlink_batch(struct obd_export *exp,
+			    struct md_op_data *op_data, int count, __s32 *rcs)
+{
+	struct obd_device	*obd = exp->exp_obd;
+	struct lmv_obd		*lmv = &obd->u.lmv;
+	struct lmv_tgt_desc	*tgt;
+	int			 rc;
+	ENTRY;
+
+	rc = lmv_check_connect(obd);
+	if (rc)
+		RETURN(rc);
+
+	/* the names of a striped directory are spread over its shards, let
+	 * the caller unlink them one by one */
+	if (op_data->op_mea1 != NULL && op_data->op_mea1->mea_count > 1)
+		RETURN(-EOPNOTSUPP);
+
+	/* the names are on the MDT of the directory, remote children among
+	 * them come back with -EREMOTE and are unlinked one by one */
+	tgt = lmv_find_target(lmv, &op_data->op_fid1);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	op_data->op_fsuid = cfs_curproc_fsuid();
+	op_data->op_fsgid = cfs_curproc_fsgid();
+	op_data->op_cap = cfs_curproc_cap_pack();
+	op_data->op_flags |= MF_MDC_CANCEL_FID1;
+
+	rc = md_unlink_batch(tgt->ltd_exp, op_data, count, rcs);
+	RETURN(rc);
+}
+
 static int lmv_unlink(struct obd_export *exp, struct md_op_data *op_data,
                       struct ptlrpc_request **request)
 {
@@ -2281,6 +2457,8 @@ static int lmv_unlink(struct obd_export *exp, struct md_op_data *op_data,
 		RETURN(rc);
 retry:
 	/* Send unlink requests to the MDT where the child is located */
+	lmv_stripe_fid(op_data->op_mea1, &op_data->op_fid1, op_data->op_name,
+		       op_data->op_namelen);
 	if (likely(!fid_is_zero(&op_data->op_fid2)))
 		tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid2);
 	else
@@ -2491,35 +2669,35 @@ int lmv_packmd(struct obd_export *exp, struct lov_mds_md **lmmp,
                 RETURN(mea_size);
 
         if (*lmmp && !lsm) {
-                OBD_FREE_LARGE(*lmmp, mea_size);
+		meap = (struct lmv_stripe_md *)*lmmp;
+		OBD_FREE_LARGE(*lmmp,
+			       lmv_stripe_md_size(le32_to_cpu(meap->mea_count)));
                 *lmmp = NULL;
                 RETURN(0);
         }
 
+	lsmp = (struct lmv_stripe_md *)lsm;
+	if (lsmp == NULL)
+		RETURN(-EINVAL);
+
+        if (lsmp->mea_magic != MEA_MAGIC_LAST_CHAR &&
+            lsmp->mea_magic != MEA_MAGIC_ALL_CHARS)
+                RETURN(-EINVAL);
+
+	mea_size = lmv_stripe_md_size(lsmp->mea_count);
         if (*lmmp == NULL) {
                 OBD_ALLOC_LARGE(*lmmp, mea_size);
                 if (*lmmp == NULL)
                         RETURN(-ENOMEM);
         }
-
-        if (!lsm)
-                RETURN(mea_size);
-
-        lsmp = (struct lmv_stripe_md *)lsm;
         meap = (struct lmv_stripe_md *)*lmmp;
 
-        if (lsmp->mea_magic != MEA_MAGIC_LAST_CHAR &&
-            lsmp->mea_magic != MEA_MAGIC_ALL_CHARS)
-                RETURN(-EINVAL);
-
         meap->mea_magic = cpu_to_le32(lsmp->mea_magic);
         meap->mea_count = cpu_to_le32(lsmp->mea_count);
         meap->mea_master = cpu_to_le32(lsmp->mea_master);
 
-	for (i = 0; i < lmv->desc.ld_tgt_count; i++) {
-		meap->mea_ids[i] = lsmp->mea_ids[i];
+	for (i = 0; i < lsmp->mea_count; i++)
 		fid_cpu_to_le(&meap->mea_ids[i], &lsmp->mea_ids[i]);
-	}
 
         RETURN(mea_size);
 }
@@ -2534,6 +2712,7 @@ int lmv_unpackmd(struct obd_export *exp, struct lov_stripe_md **lsmp,
         int                         mea_size;
         int                         i;
         __u32                       magic;
+	__u32			    count;
         ENTRY;
 
         mea_size = lmv_get_easize(lmv);
@@ -2541,41 +2720,41 @@ int lmv_unpackmd(struct obd_export *exp, struct lov_stripe_md **lsmp,
                 return mea_size;
 
         if (*lsmp != NULL && lmm == NULL) {
-                OBD_FREE_LARGE(*tmea, mea_size);
+		OBD_FREE_LARGE(*tmea, lmv_stripe_md_size((*tmea)->mea_count));
                 *lsmp = NULL;
                 RETURN(0);
         }
 
-        LASSERT(mea_size == lmm_size);
+	if (lmm == NULL || lmm_size < sizeof(*mea))
+		RETURN(-EINVAL);
+
+	magic = le32_to_cpu(mea->mea_magic);
+	count = le32_to_cpu(mea->mea_count);
+	if (magic != MEA_MAGIC_LAST_CHAR && magic != MEA_MAGIC_ALL_CHARS) {
+		CERROR("%s: unsupported stripe EA magic %#x\n",
+		       obd->obd_name, magic);
+		RETURN(-EPROTO);
+	}
+
+	mea_size = lmv_stripe_md_size(count);
+	if (count == 0 || count > lmv->desc.ld_tgt_count ||
+	    lmm_size < mea_size) {
+		CERROR("%s: bad stripe EA, %u stripes in %d bytes\n",
+		       obd->obd_name, count, lmm_size);
+		RETURN(-EPROTO);
+	}
 
         OBD_ALLOC_LARGE(*tmea, mea_size);
         if (*tmea == NULL)
                 RETURN(-ENOMEM);
 
-        if (!lmm)
-                RETURN(mea_size);
-
-        if (mea->mea_magic == MEA_MAGIC_LAST_CHAR ||
-            mea->mea_magic == MEA_MAGIC_ALL_CHARS ||
-            mea->mea_magic == MEA_MAGIC_HASH_SEGMENT)
-        {
-                magic = le32_to_cpu(mea->mea_magic);
-        } else {
-                /*
-                 * Old mea is not handled here.
-                 */
-                CERROR("Old not supportable EA is found\n");
-                LBUG();
-        }
-
         (*tmea)->mea_magic = magic;
-        (*tmea)->mea_count = le32_to_cpu(mea->mea_count);
+        (*tmea)->mea_count = count;
         (*tmea)->mea_master = le32_to_cpu(mea->mea_master);
 
-        for (i = 0; i < (*tmea)->mea_count; i++) {
-                (*tmea)->mea_ids[i] = mea->mea_ids[i];
-                fid_le_to_cpu(&(*tmea)->mea_ids[i], &(*tmea)->mea_ids[i]);
-        }
+	for (i = 0; i < count; i++)
+		fid_le_to_cpu(&(*tmea)->mea_ids[i], &mea->mea_ids[i]);
+
         RETURN(mea_size);
 }
 
@@ -2768,7 +2947,7 @@ int lmv_intent_getattr_async(struct obd_export *exp,
 	if (rc)
 		RETURN(rc);
 
-	tgt = lmv_find_target(lmv, &op_data->op_fid1);
+	tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid1);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
 
@@ -2913,6 +3092,8 @@ struct md_ops lmv_md_ops = {
         .m_setxattr             = lmv_setxattr,
         .m_sync                 = lmv_sync,
         .m_readpage             = lmv_readpage,
+	.m_dom_rw               = lmv_dom_rw,
+	.m_unlink_batch		= lmv_unlink_batch,
         .m_unlink               = lmv_unlink,
         .m_init_ea_size         = lmv_init_ea_size,
         .m_cancel_unused        = lmv_cancel_unused,
@@ -0,0 +1,164 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/lmv/lmv_qos.c
+ *
+ * QOS placement of new directories over the MDTs: like lod_qos does for
+ * OST objects, each MDT is weighted by its free inodes and space, and
+ * lowered by the rate of requests it reported in its last statfs.
+ */
+
+#define DEBUG_SUBSYSTEM S_LMV
+#ifdef __KERNEL__
+#include <linux/module.h>
+#else
+#include <liblustre.h>
+#endif
+
+#include <obd_support.h>
+#include <obd_class.h>
+#include "lmv_internal.h"
+
+/**
+ * Weight of an MDT with statfs \a osfs: free kilo-inodes times free MB,
+ * divided by its request rate plus LMV_QOS_RATE_BASE, so that the load of
+ * an MDT only starts to count once it handles that many requests a second.
+ */
+static __u64 lmv_qos_weight(const struct obd_statfs *osfs)
+{
+	__u64	inodes = min_t(__u64, osfs->os_ffree >> 10, 1ULL << 31);
+	__u64	space = min_t(__u64, (osfs->os_bavail * osfs->os_bsize) >> 20,
+			      1ULL << 31);
+	__u64	weight = inodes * space;
+	__u32	rate = min_t(__u32, osfs->os_req_rate, 1U << 30);
+
+	do_div(weight, LMV_QOS_RATE_BASE + rate);
+	return weight;
+}
+
+/**
+ * Record the statfs \a osfs of \a tgt, from lmv_statfs() or a QOS refresh.
+ */
+void lmv_qos_tgt_update(struct lmv_obd *lmv, struct lmv_tgt_desc *tgt,
+			const struct obd_statfs *osfs)
+{
+	__u64 weight = lmv_qos_weight(osfs);
+
+	spin_lock(&lmv->lmv_lock);
+	tgt->ltd_statfs = *osfs;
+	tgt->ltd_weight = weight;
+	spin_unlock(&lmv->lmv_lock);
+}
+
+/**
+ * Refresh the statfs of the active targets older than lmv_qos_maxage.
+ * Their MDCs cache it, so this only sends RPCs that often.
+ */
+static void lmv_qos_statfs_update(struct lmv_obd *lmv)
+{
+	struct obd_statfs	*osfs;
+	struct lmv_tgt_desc	*tgt;
+	__u64			 max_age;
+	int			 i;
+
+	OBD_ALLOC_PTR(osfs);
+	if (osfs == NULL)
+		return;
+
+	max_age = cfs_time_shift_64(-lmv->lmv_qos_maxage);
+	for (i = 0; i < lmv->desc.ld_tgt_count; i++) {
+		tgt = lmv->tgts[i];
+		if (tgt == NULL || tgt->ltd_exp == NULL)
+			continue;
+
+		if (!tgt->ltd_active ||
+		    obd_statfs(NULL, tgt->ltd_exp, osfs, max_age, 0) != 0) {
+			spin_lock(&lmv->lmv_lock);
+			tgt->ltd_weight = 0;
+			spin_unlock(&lmv->lmv_lock);
+			continue;
+		}
+		lmv_qos_tgt_update(lmv, tgt, osfs);
+	}
+	OBD_FREE_PTR(osfs);
+}
+
+/**
+ * Choose the MDT of a new directory by weighted random selection among the
+ * active targets, so that the emptier and less loaded MDTs get more of them.
+ *
+ * \retval -EAGAIN	no target has any weight, use the default placement
+ */
+int lmv_qos_choose(struct lmv_obd *lmv, mdsno_t *mds)
+{
+	struct lmv_tgt_desc	*tgt;
+	__u64			 total = 0;
+	__u64			 cur = 0;
+	__u32			 rand;
+	int			 shift = 0;
+	int			 i;
+	ENTRY;
+
+	lmv_qos_statfs_update(lmv);
+
+	spin_lock(&lmv->lmv_lock);
+	for (i = 0; i < lmv->desc.ld_tgt_count; i++) {
+		tgt = lmv->tgts[i];
+		if (tgt != NULL && tgt->ltd_active)
+			total += tgt->ltd_weight;
+	}
+	if (total == 0) {
+		spin_unlock(&lmv->lmv_lock);
+		RETURN(-EAGAIN);
+	}
+
+	/* draw from 32 bits, which is plenty to tell the targets apart */
+	while ((total >> shift) > 0x7fffffffULL)
+		shift++;
+	rand = cfs_rand() % (__u32)((total >> shift) + 1);
+
+	for (i = 0; i < lmv->desc.ld_tgt_count; i++) {
+		tgt = lmv->tgts[i];
+		if (tgt == NULL || !tgt->ltd_active || tgt->ltd_weight == 0)
+			continue;
+
+		*mds = tgt->ltd_idx;
+		cur += tgt->ltd_weight;
+		if ((cur >> shift) >= rand)
+			break;
+	}
+	spin_unlock(&lmv->lmv_lock);
+
+	CDEBUG(D_INODE, "QOS chose mds #%u of total weight "LPU64"\n",
+	       *mds, total);
+	RETURN(0);
+}
@@ -62,6 +62,7 @@ static int lmv_rd_numobd(char *page, char **start, off_t off, int count,
 static const char *placement_name[] = {
         [PLACEMENT_CHAR_POLICY] = "CHAR",
 	[PLACEMENT_NID_POLICY]  = "NID",
+	[PLACEMENT_QOS_POLICY]  = "QOS",
 	[PLACEMENT_INVAL_POLICY]  = "INVAL"
 };
 
@@ -132,6 +133,66 @@ static int lmv_wr_placement(struct file *file, const char *buffer,
         return count;
 }
 
+static int lmv_rd_qos_maxage(char *page, char **start, off_t off, int count,
+			     int *eof, void *data)
+{
+	struct obd_device	*dev = (struct obd_device *)data;
+
+	LASSERT(dev != NULL);
+	*eof = 1;
+	return snprintf(page, count, "%u Sec\n", dev->u.lmv.lmv_qos_maxage);
+}
+
+static int lmv_wr_qos_maxage(struct file *file, const char *buffer,
+			     unsigned long count, void *data)
+{
+	struct obd_device	*dev = (struct obd_device *)data;
+	int			 val;
+	int			 rc;
+
+	LASSERT(dev != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+	if (val <= 0)
+		return -EINVAL;
+	dev->u.lmv.lmv_qos_maxage = val;
+	return count;
+}
+
+/* the QOS weight of each MDT and the statfs it was computed from */
+static int lmv_rd_qos_weights(char *page, char **start, off_t off, int count,
+			      int *eof, void *data)
+{
+	struct obd_device	*dev = (struct obd_device *)data;
+	struct lmv_obd		*lmv;
+	struct lmv_tgt_desc	*tgt;
+	int			 len = 0;
+	int			 i;
+
+	LASSERT(dev != NULL);
+	lmv = &dev->u.lmv;
+	*eof = 1;
+
+	spin_lock(&lmv->lmv_lock);
+	for (i = 0; i < lmv->desc.ld_tgt_count && len < count; i++) {
+		tgt = lmv->tgts[i];
+		if (tgt == NULL)
+			continue;
+		len += snprintf(page + len, count - len,
+				"%d: %s weight="LPU64" ffree="LPU64
+				" kbavail="LPU64" req_rate=%u\n",
+				tgt->ltd_idx, tgt->ltd_uuid.uuid,
+				tgt->ltd_weight, tgt->ltd_statfs.os_ffree,
+				(tgt->ltd_statfs.os_bavail *
+				 tgt->ltd_statfs.os_bsize) >> 10,
+				tgt->ltd_statfs.os_req_rate);
+	}
+	spin_unlock(&lmv->lmv_lock);
+
+	return min(len, count);
+}
+
 static int lmv_rd_activeobd(char *page, char **start, off_t off, int count,
                             int *eof, void *data)
 {
@@ -212,6 +273,8 @@ static int lmv_target_seq_open(struct inode *inode, struct file *file)
 struct lprocfs_vars lprocfs_lmv_obd_vars[] = {
         { "numobd",             lmv_rd_numobd,          0, 0 },
         { "placement",          lmv_rd_placement,       lmv_wr_placement, 0 },
+	{ "qos_maxage",		lmv_rd_qos_maxage,	lmv_wr_qos_maxage, 0 },
+	{ "qos_weights",	lmv_rd_qos_weights,	0, 0 },
         { "activeobd",          lmv_rd_activeobd,       0, 0 },
         { "uuid",               lprocfs_rd_uuid,        0, 0 },
         { "desc_uuid",          lmv_rd_desc_uuid,       0, 0 },
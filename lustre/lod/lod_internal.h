@@ -45,6 +45,11 @@
 #define LOV_USES_ASSIGNED_STRIPE        0
 #define LOV_USES_DEFAULT_STRIPE         1
 
+/* default and upper limit of the Data-on-MDT file size: the MDT journals
+ * the data of these files, so they are kept small */
+#define LOD_DOM_DEF_STRIPESIZE		(1 << 16)
+#define LOD_DOM_MAX_STRIPESIZE		(1 << 20)
+
 struct lod_tgt_desc {
 	struct dt_device  *ltd_tgt;
 	struct list_head   ltd_kill;
@@ -115,6 +120,9 @@ struct lod_device {
 	/* maximum EA size underlied OSD may have */
 	unsigned int	      lod_osd_max_easize;
 
+	/* maximum size of a Data-on-MDT file, 0 disables DoM */
+	__u32		      lod_dom_max_stripesize;
+
 	/*FIXME: When QOS and pool is implemented for MDT, probably these
 	 * structure should be moved to lod_tgt_descs as well.
 	 */
@@ -315,6 +323,7 @@ int lod_qos_prep_create(const struct lu_env *env, struct lod_object *lo,
 			struct thandle *th);
 int qos_add_tgt(struct lod_device*, struct lod_tgt_desc *);
 int qos_del_tgt(struct lod_device *, struct lod_tgt_desc *);
+void lod_qos_wrand_free(struct lov_qos_wrand *lqw);
 
 /* lproc_lod.c */
 void lprocfs_lod_init_vars(struct lprocfs_static_vars *lvars);
@@ -228,7 +228,8 @@ int lod_add_device(const struct lu_env *env, struct lod_device *lod,
 					   OBD_CONNECT_FID |
 					   OBD_CONNECT_LVB_TYPE |
 					   OBD_CONNECT_VERSION |
-					   OBD_CONNECT_PINGLESS;
+					   OBD_CONNECT_PINGLESS |
+					   OBD_CONNECT_SYNC_BATCH;
 
 		data->ocd_group = tgt_index;
 		ltd = &lod->lod_ost_descs;
@@ -764,7 +765,8 @@ int lod_parse_striping(const struct lu_env *env, struct lod_object *lo,
 
 	if (magic != LOV_MAGIC_V1 && magic != LOV_MAGIC_V3)
 		GOTO(out, rc = -EINVAL);
-	if (lov_pattern(pattern) != LOV_PATTERN_RAID0)
+	if (lov_pattern(pattern) != LOV_PATTERN_RAID0 &&
+	    lov_pattern(pattern) != LOV_PATTERN_MDT)
 		GOTO(out, rc = -EINVAL);
 
 	lo->ldo_pattern = pattern;
@@ -772,7 +774,8 @@ int lod_parse_striping(const struct lu_env *env, struct lod_object *lo,
 	lo->ldo_layout_gen = le16_to_cpu(lmm->lmm_layout_gen);
 	lo->ldo_stripenr = le16_to_cpu(lmm->lmm_stripe_count);
 	/* released file stripenr fixup. */
-	if (pattern & LOV_PATTERN_F_RELEASED)
+	if (pattern & LOV_PATTERN_F_RELEASED ||
+	    lov_pattern(pattern) == LOV_PATTERN_MDT)
 		lo->ldo_stripenr = 0;
 
 	LASSERT(buf->lb_len >= lov_mds_md_size(lo->ldo_stripenr, magic));
@@ -875,7 +878,9 @@ int lod_verify_striping(struct lod_device *d, const struct lu_buf *buf,
 		GOTO(out, rc = -EINVAL);
 	}
 
-	if ((specific && le32_to_cpu(lum->lmm_pattern) != LOV_PATTERN_RAID0) ||
+	if ((specific &&
+	     lov_pattern(le32_to_cpu(lum->lmm_pattern)) != LOV_PATTERN_RAID0 &&
+	     lov_pattern(le32_to_cpu(lum->lmm_pattern)) != LOV_PATTERN_MDT) ||
 	    (!specific && lum->lmm_pattern != 0)) {
 		CDEBUG(D_IOCTL, "bad userland stripe pattern: %#x\n",
 		       le32_to_cpu(lum->lmm_pattern));
@@ -910,6 +915,13 @@ int lod_verify_striping(struct lod_device *d, const struct lu_buf *buf,
 	}
 
 	stripe_count = le16_to_cpu(lum->lmm_stripe_count);
+	if (lov_pattern(le32_to_cpu(lum->lmm_pattern)) == LOV_PATTERN_MDT &&
+	    (stripe_count != 0 || stripe_size > d->lod_dom_max_stripesize)) {
+		CDEBUG(D_IOCTL, "bad DoM layout: stripe count %u, size %u\n",
+		       stripe_count, stripe_size);
+		GOTO(out, rc = -EINVAL);
+	}
+
 	if (magic == LOV_USER_MAGIC_V1 || magic == LOV_MAGIC_V1_DEF)
 		lum_size = offsetof(struct lov_user_md_v1,
 				    lmm_objects[stripe_count]);
@@ -1057,7 +1069,7 @@ int lod_pools_init(struct lod_device *lod, struct lustre_cfg *lcfg)
 	init_rwsem(&lod->lod_qos.lq_rw_sem);
 	lod->lod_qos.lq_dirty = 1;
 	lod->lod_qos.lq_rr.lqr_dirty = 1;
-	lod->lod_qos.lq_reset = 1;
+	lod->lod_qos.lq_wrand.lqw_dirty = 1;
 	/* Default priority is toward free space balance */
 	lod->lod_qos.lq_prio_free = 232;
 	/* Default threshold for rr (roughly 17%) */
@@ -1117,6 +1129,7 @@ int lod_pools_fini(struct lod_device *lod)
 
 	cfs_hash_putref(lod->lod_pools_hash_body);
 	lod_ost_pool_free(&(lod->lod_qos.lq_rr.lqr_pool));
+	lod_qos_wrand_free(&lod->lod_qos.lq_wrand);
 	lod_ost_pool_free(&lod->lod_pool_info);
 	OBD_FREE_PTR(lod->lod_qos.lq_statfs_data);
 	RETURN(0);
@@ -809,6 +809,10 @@ static int lod_declare_init_size(const struct lu_env *env,
 	if (size == 0)
 		RETURN(0);
 
+	/* Data-on-MDT and released files have no stripes to resize */
+	if (lo->ldo_stripenr == 0)
+		RETURN(0);
+
 	/* ll_do_div64(a, b) returns a % b, and a = a / b */
 	ll_do_div64(size, (__u64) lo->ldo_stripe_size);
 	stripe = ll_do_div64(size, (__u64) lo->ldo_stripenr);
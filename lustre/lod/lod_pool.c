@@ -65,6 +65,7 @@ void lod_pool_putref(struct pool_desc *pool)
 		LASSERT(cfs_list_empty(&pool->pool_list));
 		LASSERT(pool->pool_proc_entry == NULL);
 		lod_ost_pool_free(&(pool->pool_rr.lqr_pool));
+		lod_qos_wrand_free(&(pool->pool_wrand));
 		lod_ost_pool_free(&(pool->pool_obds));
 		OBD_FREE_PTR(pool);
 		EXIT;
@@ -457,6 +458,9 @@ int lod_pool_new(struct obd_device *obd, char *poolname)
 	if (rc)
 		GOTO(out_free_pool_obds, rc);
 
+	memset(&(new_pool->pool_wrand), 0, sizeof(struct lov_qos_wrand));
+	new_pool->pool_wrand.lqw_dirty = 1;
+
 	INIT_HLIST_NODE(&new_pool->pool_hash);
 
 #ifdef LPROCFS
@@ -565,6 +569,7 @@ int lod_pool_add(struct obd_device *obd, char *poolname, char *ostname)
 		GOTO(out, rc);
 
 	pool->pool_rr.lqr_dirty = 1;
+	pool->pool_wrand.lqw_dirty = 1;
 
 	CDEBUG(D_CONFIG, "Added %s to "LOV_POOLNAMEF" as member %d\n",
 			ostname, poolname,  pool_tgt_count(pool));
@@ -607,6 +612,7 @@ int lod_pool_remove(struct obd_device *obd, char *poolname, char *ostname)
 	lod_ost_pool_remove(&pool->pool_obds, idx);
 
 	pool->pool_rr.lqr_dirty = 1;
+	pool->pool_wrand.lqw_dirty = 1;
 
 	CDEBUG(D_CONFIG, "%s removed from "LOV_POOLNAMEF"\n", ostname,
 	       poolname);
@@ -230,22 +230,21 @@ out:
 	EXIT;
 }
 
-/* Recalculate per-object penalties for OSSs and OSTs,
-   depends on size of each ost in an oss */
-static int lod_qos_calc_ppo(struct lod_device *lod)
+/* Recalculate the weight of each OST for the weighted random allocation,
+   from its free space and that of its OSS */
+static int lod_qos_calc_weights(struct lod_device *lod)
 {
-	struct lov_qos_oss *oss;
-	__u64		    ba_max, ba_min, temp;
-	__u32		    num_active;
-	int		    rc, i, prio_wide;
-	time_t		    now, age;
+	struct lov_qos_oss  *oss;
+	struct lod_tgt_desc *ost;
+	__u64		     ba_max, ba_min, ba_total, temp, share;
+	__u32		     shares;
+	int		     rc, i, prio_wide;
 	ENTRY;
 
 	if (!lod->lod_qos.lq_dirty)
 		GOTO(out, rc = 0);
 
-	num_active = lod->lod_desc.ld_active_tgt_count - 1;
-	if (num_active < 1)
+	if (lod->lod_desc.ld_active_tgt_count < 2)
 		GOTO(out, rc = -EAGAIN);
 
 	/* find bavail on each OSS */
@@ -253,18 +252,9 @@ static int lod_qos_calc_ppo(struct lod_device *lod)
 				oss->lqo_bavail = 0;
 	lod->lod_qos.lq_active_oss_count = 0;
 
-	/*
-	 * How badly user wants to select OSTs "widely" (not recently chosen
-	 * and not on recent OSS's).  As opposed to "freely" (free space
-	 * avail.) 0-256
-	 */
-	prio_wide = 256 - lod->lod_qos.lq_prio_free;
-
 	ba_min = (__u64)(-1);
 	ba_max = 0;
-	now = cfs_time_current_sec();
-	/* Calculate OST penalty per object
-	 * (lod ref taken in lod_qos_prep_create()) */
+	ba_total = 0;
 	cfs_foreach_bit(lod->lod_ost_bitmap, i) {
 		LASSERT(OST_TGT(lod,i));
 		temp = TGT_BAVAIL(i);
@@ -272,71 +262,50 @@ static int lod_qos_calc_ppo(struct lod_device *lod)
 			continue;
 		ba_min = min(temp, ba_min);
 		ba_max = max(temp, ba_max);
+		ba_total += temp;
 
 		/* Count the number of usable OSS's */
 		if (OST_TGT(lod,i)->ltd_qos.ltq_oss->lqo_bavail == 0)
 			lod->lod_qos.lq_active_oss_count++;
 		OST_TGT(lod,i)->ltd_qos.ltq_oss->lqo_bavail += temp;
-
-		/* per-OST penalty is prio * TGT_bavail / (num_ost - 1) / 2 */
-		temp >>= 1;
-		lov_do_div64(temp, num_active);
-		OST_TGT(lod,i)->ltd_qos.ltq_penalty_per_obj =
-			(temp * prio_wide) >> 8;
-
-		age = (now - OST_TGT(lod,i)->ltd_qos.ltq_used) >> 3;
-		if (lod->lod_qos.lq_reset ||
-		    age > 32 * lod->lod_desc.ld_qos_maxage)
-			OST_TGT(lod,i)->ltd_qos.ltq_penalty = 0;
-		else if (age > lod->lod_desc.ld_qos_maxage)
-			/* Decay the penalty by half for every 8x the update
-			 * interval that the device has been idle.  That gives
-			 * lots of time for the statfs information to be
-			 * updated (which the penalty is only a proxy for),
-			 * and avoids penalizing OSS/OSTs under light load. */
-			OST_TGT(lod,i)->ltd_qos.ltq_penalty >>=
-				(age / lod->lod_desc.ld_qos_maxage);
 	}
 
-	num_active = lod->lod_qos.lq_active_oss_count - 1;
-	if (num_active < 1) {
-		/* If there's only 1 OSS, we can't penalize it, so instead
-		   we have to double the OST penalty */
-		num_active = 1;
-		cfs_foreach_bit(lod->lod_ost_bitmap, i)
-			OST_TGT(lod,i)->ltd_qos.ltq_penalty_per_obj <<= 1;
-	}
+	/*
+	 * How badly user wants to select OSTs "widely" (evenly over the
+	 * OSS's) as opposed to "freely" (free space avail.) 0-256
+	 */
+	prio_wide = 256 - lod->lod_qos.lq_prio_free;
 
-	/* Per-OSS penalty is prio * oss_avail / oss_osts / (num_oss - 1) / 2 */
-	cfs_list_for_each_entry(oss, &lod->lod_qos.lq_oss_list, lqo_oss_list) {
-		temp = oss->lqo_bavail >> 1;
-		lov_do_div64(temp, oss->lqo_ost_count * num_active);
-		oss->lqo_penalty_per_obj = (temp * prio_wide) >> 8;
-
-		age = (now - oss->lqo_used) >> 3;
-		if (lod->lod_qos.lq_reset ||
-		    age > 32 * lod->lod_desc.ld_qos_maxage)
-			oss->lqo_penalty = 0;
-		else if (age > lod->lod_desc.ld_qos_maxage)
-			/* Decay the penalty by half for every 8x the update
-			 * interval that the device has been idle.  That gives
-			 * lots of time for the statfs information to be
-			 * updated (which the penalty is only a proxy for),
-			 * and avoids penalizing OSS/OSTs under light load. */
-			oss->lqo_penalty >>= age / lod->lod_desc.ld_qos_maxage;
+	/* OST weight = prio_free * TGT_bavail + prio_wide * even share of
+	 * the free space, the same for each OSS and split among its OSTs */
+	cfs_foreach_bit(lod->lod_ost_bitmap, i) {
+		ost = OST_TGT(lod,i);
+		temp = TGT_BAVAIL(i);
+		ost->ltd_qos.ltq_weight = 0;
+		if (!temp)
+			continue;
+
+		share = ba_total;
+		shares = lod->lod_qos.lq_active_oss_count *
+			 ost->ltd_qos.ltq_oss->lqo_ost_count;
+		lov_do_div64(share, shares);
+		ost->ltd_qos.ltq_weight = (temp * lod->lod_qos.lq_prio_free +
+					   min(temp, share) * prio_wide) >> 8;
+
+		QOS_DEBUG("tgt %d avail="LPU64" share="LPU64" wt="LPU64"\n",
+			  i, temp >> 10, share >> 10,
+			  ost->ltd_qos.ltq_weight >> 10);
 	}
 
 	lod->lod_qos.lq_dirty = 0;
-	lod->lod_qos.lq_reset = 0;
+	/* the alias tables of the pools are stale now */
+	lod->lod_qos.lq_gen++;
 
 	/* If each ost has almost same free space,
 	 * do rr allocation for better creation performance */
 	lod->lod_qos.lq_same_space = 0;
-	if ((ba_max * (256 - lod->lod_qos.lq_threshold_rr)) >> 8 < ba_min) {
+	if ((ba_max * (256 - lod->lod_qos.lq_threshold_rr)) >> 8 < ba_min)
 		lod->lod_qos.lq_same_space = 1;
-		/* Reset weights for the next time we enter qos mode */
-		lod->lod_qos.lq_reset = 1;
-	}
 	rc = 0;
 
 out:
@@ -347,96 +316,87 @@ out:
 	RETURN(rc);
 }
 
-static int lod_qos_calc_weight(struct lod_device *lod, int i)
+void lod_qos_wrand_free(struct lov_qos_wrand *lqw)
+{
+	if (lqw->lqw_size == 0)
+		return;
+
+	OBD_FREE_LARGE(lqw->lqw_table.wt_thresh,
+		       lqw->lqw_size * sizeof(lqw->lqw_table.wt_thresh[0]));
+	OBD_FREE_LARGE(lqw->lqw_table.wt_alias,
+		       lqw->lqw_size * sizeof(lqw->lqw_table.wt_alias[0]));
+	OBD_FREE_LARGE(lqw->lqw_idx, lqw->lqw_size * sizeof(lqw->lqw_idx[0]));
+	OBD_FREE_LARGE(lqw->lqw_weight,
+		       lqw->lqw_size * sizeof(lqw->lqw_weight[0]));
+	OBD_FREE_LARGE(lqw->lqw_work, lqw->lqw_size * sizeof(lqw->lqw_work[0]));
+	memset(lqw, 0, sizeof(*lqw));
+	lqw->lqw_dirty = 1;
+}
+
+static int lod_qos_wrand_extend(struct lov_qos_wrand *lqw, __u32 count)
 {
-	__u64 temp, temp2;
-
-	/* Final ost weight = TGT_BAVAIL - ost_penalty - oss_penalty */
-	temp = TGT_BAVAIL(i);
-	temp2 = OST_TGT(lod,i)->ltd_qos.ltq_penalty +
-		OST_TGT(lod,i)->ltd_qos.ltq_oss->lqo_penalty;
-	if (temp < temp2)
-		OST_TGT(lod,i)->ltd_qos.ltq_weight = 0;
-	else
-		OST_TGT(lod,i)->ltd_qos.ltq_weight = temp - temp2;
+	if (count <= lqw->lqw_size)
+		return 0;
+
+	lod_qos_wrand_free(lqw);
+	OBD_ALLOC_LARGE(lqw->lqw_table.wt_thresh,
+			count * sizeof(lqw->lqw_table.wt_thresh[0]));
+	OBD_ALLOC_LARGE(lqw->lqw_table.wt_alias,
+			count * sizeof(lqw->lqw_table.wt_alias[0]));
+	OBD_ALLOC_LARGE(lqw->lqw_idx, count * sizeof(lqw->lqw_idx[0]));
+	OBD_ALLOC_LARGE(lqw->lqw_weight, count * sizeof(lqw->lqw_weight[0]));
+	OBD_ALLOC_LARGE(lqw->lqw_work, count * sizeof(lqw->lqw_work[0]));
+	lqw->lqw_size = count;
+	if (lqw->lqw_table.wt_thresh == NULL ||
+	    lqw->lqw_table.wt_alias == NULL || lqw->lqw_idx == NULL ||
+	    lqw->lqw_weight == NULL || lqw->lqw_work == NULL) {
+		lod_qos_wrand_free(lqw);
+		return -ENOMEM;
+	}
 	return 0;
 }
 
-/* We just used this index for a stripe; adjust everyone's weights */
-static int lod_qos_used(struct lod_device *lod, struct ost_pool *osts,
-			__u32 index, __u64 *total_wt)
+/* build the alias table of the OSTs of @src_pool from their weights, once
+   per change of the weights or of the pool, so that each stripe is then
+   picked in constant time. Called under the write lock of lq_rw_sem. */
+static int lod_qos_calc_wrand(struct lod_device *lod, struct ost_pool *src_pool,
+			      struct lov_qos_wrand *lqw)
 {
 	struct lod_tgt_desc *ost;
-	struct lov_qos_oss  *oss;
-	int j;
+	__u32		     count = 0;
+	int		     i, idx, rc;
 	ENTRY;
 
-	ost = OST_TGT(lod,index);
-	LASSERT(ost);
-
-	/* Don't allocate on this devuce anymore, until the next alloc_qos */
-	ost->ltd_qos.ltq_usable = 0;
-
-	oss = ost->ltd_qos.ltq_oss;
-
-	/* Decay old penalty by half (we're adding max penalty, and don't
-	   want it to run away.) */
-	ost->ltd_qos.ltq_penalty >>= 1;
-	oss->lqo_penalty >>= 1;
-
-	/* mark the OSS and OST as recently used */
-	ost->ltd_qos.ltq_used = oss->lqo_used = cfs_time_current_sec();
-
-	/* Set max penalties for this OST and OSS */
-	ost->ltd_qos.ltq_penalty +=
-		ost->ltd_qos.ltq_penalty_per_obj * lod->lod_ostnr;
-	oss->lqo_penalty += oss->lqo_penalty_per_obj *
-		lod->lod_qos.lq_active_oss_count;
+	if (!lqw->lqw_dirty && lqw->lqw_gen == lod->lod_qos.lq_gen)
+		RETURN(0);
 
-	/* Decrease all OSS penalties */
-	cfs_list_for_each_entry(oss, &lod->lod_qos.lq_oss_list, lqo_oss_list) {
-		if (oss->lqo_penalty < oss->lqo_penalty_per_obj)
-			oss->lqo_penalty = 0;
-		else
-			oss->lqo_penalty -= oss->lqo_penalty_per_obj;
-	}
+	rc = lod_qos_wrand_extend(lqw, src_pool->op_count);
+	if (rc)
+		RETURN(rc);
 
-	*total_wt = 0;
-	/* Decrease all OST penalties */
-	for (j = 0; j < osts->op_count; j++) {
-		int i;
+	for (i = 0; i < src_pool->op_count; i++) {
+		idx = src_pool->op_array[i];
+		if (!cfs_bitmap_check(lod->lod_ost_bitmap, idx))
+			continue;
 
-		i = osts->op_array[j];
-		if (!cfs_bitmap_check(lod->lod_ost_bitmap, i))
+		ost = OST_TGT(lod,idx);
+		if (!ost->ltd_active || ost->ltd_qos.ltq_weight == 0)
 			continue;
 
-		ost = OST_TGT(lod,i);
-		LASSERT(ost);
-
-		if (ost->ltd_qos.ltq_penalty <
-				ost->ltd_qos.ltq_penalty_per_obj)
-			ost->ltd_qos.ltq_penalty = 0;
-		else
-			ost->ltd_qos.ltq_penalty -=
-				ost->ltd_qos.ltq_penalty_per_obj;
-
-		lod_qos_calc_weight(lod, i);
-
-		/* Recalc the total weight of usable osts */
-		if (ost->ltd_qos.ltq_usable)
-			*total_wt += ost->ltd_qos.ltq_weight;
-
-		QOS_DEBUG("recalc tgt %d usable=%d avail="LPU64
-			  " ostppo="LPU64" ostp="LPU64" ossppo="LPU64
-			  " ossp="LPU64" wt="LPU64"\n",
-			  i, ost->ltd_qos.ltq_usable, TGT_BAVAIL(i) >> 10,
-			  ost->ltd_qos.ltq_penalty_per_obj >> 10,
-			  ost->ltd_qos.ltq_penalty >> 10,
-			  ost->ltd_qos.ltq_oss->lqo_penalty_per_obj >> 10,
-			  ost->ltd_qos.ltq_oss->lqo_penalty >> 10,
-			  ost->ltd_qos.ltq_weight >> 10);
+		lqw->lqw_idx[count] = idx;
+		lqw->lqw_weight[count] = ost->ltd_qos.ltq_weight;
+		count++;
 	}
 
+	lqw->lqw_table.wt_count = 0;
+	if (count > 0 && wrand_build(&lqw->lqw_table, lqw->lqw_weight,
+				     lqw->lqw_work, count) != 0)
+		lqw->lqw_table.wt_count = 0;
+
+	lqw->lqw_gen = lod->lod_qos.lq_gen;
+	lqw->lqw_dirty = 0;
+	QOS_DEBUG("built alias table of %u of %u osts\n",
+		  lqw->lqw_table.wt_count, src_pool->op_count);
 	RETURN(0);
 }
 
@@ -972,24 +932,29 @@ static inline int lod_qos_is_usable(struct lod_device *lod)
 	return 1;
 }
 
+/* draws from the alias table before giving up on the weighted allocation */
+#define LOD_QOS_MAX_DRAWS(stripes)	(4 * (stripes) + 16)
+
 /* Alloc objects on OSTs with optimization based on:
    - free space
    - network resources (shared OSS's)
+   The weights are only recalculated when the statfs data change, into an
+   alias table from which each stripe is drawn in constant time.
  */
 static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 			 struct dt_object **stripe, int flags,
 			 struct thandle *th)
 {
-	struct lod_device   *m = lu2lod_dev(lo->ldo_obj.do_lu.lo_dev);
-	struct obd_statfs   *sfs = &lod_env_info(env)->lti_osfs;
-	struct lod_tgt_desc *ost;
-	struct dt_object    *o;
-	__u64		     total_weight = 0;
-	int		     nfound, good_osts, i, rc = 0;
-	int		     stripe_cnt = lo->ldo_stripenr;
-	int		     stripe_cnt_min;
-	struct pool_desc    *pool = NULL;
-	struct ost_pool    *osts;
+	struct lod_device    *m = lu2lod_dev(lo->ldo_obj.do_lu.lo_dev);
+	struct obd_statfs    *sfs = &lod_env_info(env)->lti_osfs;
+	struct dt_object     *o;
+	int		      nfound, draws, idx, i, rc = 0;
+	int		      stripe_cnt = lo->ldo_stripenr;
+	int		      stripe_cnt_min;
+	struct pool_desc     *pool = NULL;
+	struct ost_pool      *osts;
+	struct lov_qos_wrand *lqw;
+	struct wrand_table   *wt;
 	ENTRY;
 
 	stripe_cnt_min = min_stripe_count(stripe_cnt, flags);
@@ -1002,16 +967,29 @@ static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 	if (pool != NULL) {
 		down_read(&pool_tgt_rw_sem(pool));
 		osts = &(pool->pool_obds);
+		lqw = &(pool->pool_wrand);
 	} else {
 		osts = &(m->lod_pool_info);
+		lqw = &(m->lod_qos.lq_wrand);
 	}
 
 	/* Detect -EAGAIN early, before expensive lock is taken. */
 	if (!lod_qos_is_usable(m))
 		GOTO(out_nolock, rc = -EAGAIN);
 
-	/* Do actual allocation, use write lock here. */
-	down_write(&m->lod_qos.lq_rw_sem);
+	if (m->lod_qos.lq_dirty || lqw->lqw_dirty ||
+	    lqw->lqw_gen != m->lod_qos.lq_gen) {
+		down_write(&m->lod_qos.lq_rw_sem);
+		rc = lod_qos_calc_weights(m);
+		if (rc == 0)
+			rc = lod_qos_calc_wrand(m, osts, lqw);
+		up_write(&m->lod_qos.lq_rw_sem);
+		if (rc)
+			GOTO(out_nolock, rc);
+	}
+
+	/* Many creates can draw from the same table at once. */
+	down_read(&m->lod_qos.lq_rw_sem);
 
 	/*
 	 * Check again, while we were sleeping on @lq_rw_sem things could
@@ -1020,136 +998,63 @@ static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 	if (!lod_qos_is_usable(m))
 		GOTO(out, rc = -EAGAIN);
 
-	rc = lod_qos_calc_ppo(m);
-	if (rc)
-		GOTO(out, rc);
+	wt = &lqw->lqw_table;
+	QOS_DEBUG("found %u good osts\n", wt->wt_count);
+
+	/* Drawing the OSTs not used yet by the file would take too many
+	 * draws for a stripe over most of them, which round-robin spreads
+	 * as well. */
+	if (wt->wt_count < stripe_cnt_min || 2 * stripe_cnt > wt->wt_count)
+		GOTO(out, rc = -EAGAIN);
 
 	rc = lod_qos_ost_in_use_clear(env, lo->ldo_stripenr);
 	if (rc)
 		GOTO(out, rc);
 
-	good_osts = 0;
-	/* Find all the OSTs that are valid stripe candidates */
-	for (i = 0; i < osts->op_count; i++) {
-		if (!cfs_bitmap_check(m->lod_ost_bitmap, osts->op_array[i]))
-			continue;
+	/* Find enough OSTs with weighted random allocation. */
+	nfound = 0;
+	for (draws = 0; nfound < stripe_cnt &&
+			draws < LOD_QOS_MAX_DRAWS(stripe_cnt); draws++) {
+		idx = lqw->lqw_idx[wrand_pick(wt, cfs_rand(), cfs_rand())];
 
-		rc = lod_statfs_and_check(env, m, osts->op_array[i], sfs);
-		if (rc) {
-			/* this OSP doesn't feel well */
+		if (!cfs_bitmap_check(m->lod_ost_bitmap, idx))
 			continue;
-		}
 
 		/*
-		 * skip full devices
+		 * do not put >1 objects on a single OST
 		 */
-		if (lod_qos_dev_is_full(sfs))
+		if (lod_qos_is_ost_used(env, idx, nfound))
 			continue;
 
 		/* Fail Check before osc_precreate() is called
 		   so we can only 'fail' single OSC. */
-		if (OBD_FAIL_CHECK(OBD_FAIL_MDS_OSC_PRECREATE) &&
-				   osts->op_array[i] == 0)
+		if (OBD_FAIL_CHECK(OBD_FAIL_MDS_OSC_PRECREATE) && idx == 0)
 			continue;
 
-		ost = OST_TGT(m,osts->op_array[i]);
-		ost->ltd_qos.ltq_usable = 1;
-		lod_qos_calc_weight(m, osts->op_array[i]);
-		total_weight += ost->ltd_qos.ltq_weight;
-
-		good_osts++;
-	}
-
-	QOS_DEBUG("found %d good osts\n", good_osts);
-
-	if (good_osts < stripe_cnt_min)
-		GOTO(out, rc = -EAGAIN);
-
-	/* We have enough osts */
-	if (good_osts < stripe_cnt)
-		stripe_cnt = good_osts;
-
-	/* Find enough OSTs with weighted random allocation. */
-	nfound = 0;
-	while (nfound < stripe_cnt) {
-		__u64 rand, cur_weight;
-
-		cur_weight = 0;
-		rc = -ENOSPC;
-
-		if (total_weight) {
-#if BITS_PER_LONG == 32
-			rand = cfs_rand() % (unsigned)total_weight;
-			/* If total_weight > 32-bit, first generate the high
-			 * 32 bits of the random number, then add in the low
-			 * 32 bits (truncated to the upper limit, if needed) */
-			if (total_weight > 0xffffffffULL)
-				rand = (__u64)(cfs_rand() %
-					(unsigned)(total_weight >> 32)) << 32;
-			else
-				rand = 0;
-
-			if (rand == (total_weight & 0xffffffff00000000ULL))
-				rand |= cfs_rand() % (unsigned)total_weight;
-			else
-				rand |= cfs_rand();
-
-#else
-			rand = ((__u64)cfs_rand() << 32 | cfs_rand()) %
-				total_weight;
-#endif
-		} else {
-			rand = 0;
+		rc = lod_statfs_and_check(env, m, idx, sfs);
+		if (rc) {
+			/* this OSP doesn't feel well */
+			continue;
 		}
 
-		/* On average, this will hit larger-weighted osts more often.
-		   0-weight osts will always get used last (only when rand=0) */
-		for (i = 0; i < osts->op_count; i++) {
-			int idx = osts->op_array[i];
-
-			if (!cfs_bitmap_check(m->lod_ost_bitmap, idx))
-				continue;
-
-			ost = OST_TGT(m,idx);
-
-			if (!ost->ltd_qos.ltq_usable)
-				continue;
-
-			cur_weight += ost->ltd_qos.ltq_weight;
-			QOS_DEBUG("stripe_cnt=%d nfound=%d cur_weight="LPU64
-				  " rand="LPU64" total_weight="LPU64"\n",
-				  stripe_cnt, nfound, cur_weight, rand,
-				  total_weight);
-
-			if (cur_weight < rand)
-				continue;
-
-			QOS_DEBUG("stripe=%d to idx=%d\n", nfound, idx);
-
-			/*
-			 * do not put >1 objects on a single OST
-			 */
-			if (lod_qos_is_ost_used(env, idx, nfound))
-				continue;
-			lod_qos_ost_in_use(env, nfound, idx);
+		/*
+		 * skip full devices
+		 */
+		if (lod_qos_dev_is_full(sfs))
+			continue;
 
-			o = lod_qos_declare_object_on(env, m, idx, th);
-			if (IS_ERR(o)) {
-				QOS_DEBUG("can't declare object on #%u: %d\n",
-					  idx, (int) PTR_ERR(o));
-				continue;
-			}
-			stripe[nfound++] = o;
-			lod_qos_used(m, osts, idx, &total_weight);
-			rc = 0;
-			break;
-		}
+		QOS_DEBUG("stripe=%d to idx=%d\n", nfound, idx);
 
-		if (rc) {
-			/* no OST found on this iteration, give up */
-			break;
+		lod_qos_ost_in_use(env, nfound, idx);
+		o = lod_qos_declare_object_on(env, m, idx, th);
+		if (IS_ERR(o)) {
+			QOS_DEBUG("can't declare object on #%u: %d\n",
+				  idx, (int) PTR_ERR(o));
+			continue;
 		}
+		stripe[nfound++] = o;
 	}
+	rc = 0;
 
 	if (unlikely(nfound != stripe_cnt)) {
 		/*
@@ -1159,7 +1064,7 @@ static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 		 * so it's possible OSP won't be able to provide us with
 		 * an object due to just changed state
 		 */
-		LCONSOLE_INFO("wanted %d, found %d\n", stripe_cnt, nfound);
+		CDEBUG(D_QOS, "wanted %d, found %d\n", stripe_cnt, nfound);
 		for (i = 0; i < nfound; i++) {
 			LASSERT(stripe[i] != NULL);
 			lu_object_put(env, &stripe[i]->do_lu);
@@ -1174,7 +1079,7 @@ static int lod_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 	}
 
 out:
-	up_write(&m->lod_qos.lq_rw_sem);
+	up_read(&m->lod_qos.lq_rw_sem);
 
 out_nolock:
 	if (pool != NULL) {
@@ -1286,7 +1191,32 @@ static int lod_qos_parse_config(const struct lu_env *env,
 	v1->lmm_magic = magic;
 	if (v1->lmm_pattern == 0)
 		v1->lmm_pattern = LOV_PATTERN_RAID0;
-	if (lov_pattern(v1->lmm_pattern) != LOV_PATTERN_RAID0) {
+	switch (lov_pattern(v1->lmm_pattern)) {
+	case LOV_PATTERN_RAID0:
+		break;
+	case LOV_PATTERN_MDT:
+		/* Data-on-MDT: no OST objects, the stripe size is the
+		 * maximum file size and is limited by dom_stripesize */
+		if (d->lod_dom_max_stripesize == 0) {
+			CDEBUG(D_OTHER, "DoM is disabled on %s\n",
+			       lod2obd(d)->obd_name);
+			RETURN(-EINVAL);
+		}
+		if (v1->lmm_stripe_size == 0)
+			v1->lmm_stripe_size = d->lod_dom_max_stripesize;
+		if (v1->lmm_stripe_size > d->lod_dom_max_stripesize ||
+		    v1->lmm_stripe_size & (LOV_MIN_STRIPE_SIZE - 1)) {
+			CDEBUG(D_OTHER, "invalid DoM size %u, max %u\n",
+			       v1->lmm_stripe_size,
+			       d->lod_dom_max_stripesize);
+			RETURN(-EINVAL);
+		}
+		lo->ldo_pattern = v1->lmm_pattern;
+		lo->ldo_stripe_size = v1->lmm_stripe_size;
+		lo->ldo_stripenr = 0;
+		lod_object_set_pool(lo, NULL);
+		RETURN(0);
+	default:
 		CERROR("invalid pattern: %x\n", v1->lmm_pattern);
 		RETURN(-EINVAL);
 	}
@@ -1369,12 +1299,6 @@ int lod_qos_prep_create(const struct lu_env *env, struct lod_object *lo,
 
 	LASSERT(lo);
 
-	/* no OST available */
-	/* XXX: should we be waiting a bit to prevent failures during
-	 * cluster initialization? */
-	if (d->lod_ostnr == 0)
-		GOTO(out, rc = -EIO);
-
 	/*
 	 * by this time, the object's ldo_stripenr and ldo_stripe_size
 	 * contain default value for striping: taken from the parent
@@ -1387,6 +1311,16 @@ int lod_qos_prep_create(const struct lu_env *env, struct lod_object *lo,
 	if (rc)
 		GOTO(out, rc);
 
+	/* A Data-on-MDT file is being created, no OST objects needed */
+	if (lov_pattern(lo->ldo_pattern) == LOV_PATTERN_MDT)
+		GOTO(out, rc = 0);
+
+	/* no OST available */
+	/* XXX: should we be waiting a bit to prevent failures during
+	 * cluster initialization? */
+	if (d->lod_ostnr == 0)
+		GOTO(out, rc = -EIO);
+
 	/* A released file is being created */
 	if (lo->ldo_stripenr == 0)
 		GOTO(out, rc = 0);
@@ -74,6 +74,41 @@ static int lod_wr_stripesize(struct file *file, const char *buffer,
 	return count;
 }
 
+static int lod_rd_dom_stripesize(char *page, char **start, off_t off,
+				 int count, int *eof, void *data)
+{
+	struct obd_device *dev  = (struct obd_device *)data;
+	struct lod_device *lod;
+
+	LASSERT(dev != NULL);
+	lod  = lu2lod_dev(dev->obd_lu_dev);
+	*eof = 1;
+	return snprintf(page, count, "%u\n", lod->lod_dom_max_stripesize);
+}
+
+static int lod_wr_dom_stripesize(struct file *file, const char *buffer,
+				 unsigned long count, void *data)
+{
+	struct obd_device *dev = (struct obd_device *)data;
+	struct lod_device *lod;
+	__u64 val;
+	int rc;
+
+	LASSERT(dev != NULL);
+	lod  = lu2lod_dev(dev->obd_lu_dev);
+	rc = lprocfs_write_u64_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val > LOD_DOM_MAX_STRIPESIZE)
+		return -ERANGE;
+	if (val & (LOV_MIN_STRIPE_SIZE - 1))
+		return -EINVAL;
+
+	lod->lod_dom_max_stripesize = val;
+	return count;
+}
+
 static int lod_rd_stripeoffset(char *page, char **start, off_t off, int count,
 			       int *eof, void *data)
 {
@@ -235,7 +270,6 @@ static int lod_wr_qos_priofree(struct file *file, const char *buffer,
 		return -EINVAL;
 	lod->lod_qos.lq_prio_free = (val << 8) / 100;
 	lod->lod_qos.lq_dirty = 1;
-	lod->lod_qos.lq_reset = 1;
 	return count;
 }
 
@@ -434,6 +468,7 @@ static struct lprocfs_vars lprocfs_lod_obd_vars[] = {
 	{ "uuid",         lprocfs_rd_uuid,        0, 0 },
 	{ "stripesize",   lod_rd_stripesize,      lod_wr_stripesize, 0 },
 	{ "stripeoffset", lod_rd_stripeoffset,    lod_wr_stripeoffset, 0 },
+	{ "dom_stripesize", lod_rd_dom_stripesize, lod_wr_dom_stripesize, 0 },
 	{ "stripecount",  lod_rd_stripecount,     lod_wr_stripecount, 0 },
 	{ "stripetype",   lod_rd_stripetype,      lod_wr_stripetype, 0 },
 	{ "numobd",       lod_rd_numobd,          0, 0 },
@@ -0,0 +1,116 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/lod/wrand_table.c
+ *
+ * Alias table (Walker/Vose) for weighted random selection: built in O(n)
+ * from the weights, after which each pick costs two random numbers and one
+ * comparison, whatever the number of choices. Also built in userspace by
+ * lustre/tests/wrand_test.
+ */
+
+#include <wrand_table.h>
+
+/**
+ * Build the alias table \a wt of \a count choices from their weights.
+ *
+ * \a weight is clobbered, and \a work is scratch space of \a count entries;
+ * wt_thresh and wt_alias must have room for \a count entries.
+ *
+ * \retval -EINVAL	no choice has any weight
+ */
+int wrand_build(struct wrand_table *wt, __u64 *weight, __u32 *work,
+		__u32 count)
+{
+	__u64	total = 0;
+	__u64	scaled_total = 0;
+	__u32	nsmall = 0;
+	__u32	nlarge = 0;
+	__u32	s, l;
+	int	shift = 0;
+	__u32	i;
+
+	for (i = 0; i < count; i++)
+		total += weight[i];
+	if (total == 0)
+		return -EINVAL;
+
+	/* scale the weights down so that their sum fits WRAND_TOTAL_MAX */
+	while ((total >> shift) > WRAND_TOTAL_MAX)
+		shift++;
+	for (i = 0; i < count; i++) {
+		weight[i] >>= shift;
+		scaled_total += weight[i];
+	}
+	if (scaled_total == 0)
+		return -EINVAL;
+
+	/* each column holds scaled_total: the choices below that are the
+	 * "small" ones at the start of work[], the others at its end */
+	for (i = 0; i < count; i++) {
+		weight[i] *= count;
+		if (weight[i] < scaled_total)
+			work[nsmall++] = i;
+		else
+			work[count - ++nlarge] = i;
+	}
+
+	/* fill the column of each small choice up with a large one */
+	while (nsmall > 0 && nlarge > 0) {
+		s = work[--nsmall];
+		l = work[count - nlarge];
+
+		wt->wt_thresh[s] = weight[s];
+		wt->wt_alias[s] = l;
+		weight[l] -= scaled_total - weight[s];
+		if (weight[l] < scaled_total) {
+			nlarge--;
+			work[nsmall++] = l;
+		}
+	}
+
+	/* the rest fill their own column, up to rounding */
+	while (nlarge > 0) {
+		l = work[count - nlarge--];
+		wt->wt_thresh[l] = scaled_total;
+		wt->wt_alias[l] = l;
+	}
+	while (nsmall > 0) {
+		s = work[--nsmall];
+		wt->wt_thresh[s] = scaled_total;
+		wt->wt_alias[s] = s;
+	}
+
+	wt->wt_count = count;
+	wt->wt_total = scaled_total;
+	return 0;
+}
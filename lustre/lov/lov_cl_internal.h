@@ -169,6 +169,7 @@ enum lov_layout_type {
 	LLT_EMPTY,	/** empty file without body (mknod + truncate) */
 	LLT_RAID0,	/** striped file */
 	LLT_RELEASED,	/** file with no objects (data in HSM) */
+	LLT_DOM,	/** file with no objects (data on MDT) */
 	LLT_NR
 };
 
@@ -260,6 +261,8 @@ struct lov_object {
                 } empty;
 		struct lov_layout_state_released {
 		} released;
+		struct lov_layout_state_dom {
+		} dom;
         } u;
         /**
          * Thread that acquired lov_object::lo_type_guard in an exclusive
@@ -589,6 +592,8 @@ int   lov_io_init_empty   (const struct lu_env *env, struct cl_object *obj,
                            struct cl_io *io);
 int   lov_io_init_released(const struct lu_env *env, struct cl_object *obj,
                            struct cl_io *io);
+int   lov_io_init_dom     (const struct lu_env *env, struct cl_object *obj,
+                           struct cl_io *io);
 void  lov_lock_unlink     (const struct lu_env *env, struct lov_lock_link *link,
                            struct lovsub_lock *sub);
 
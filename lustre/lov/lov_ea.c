@@ -73,7 +73,15 @@ static int lsm_lmm_verify_common(struct lov_mds_md *lmm, int lmm_bytes,
 		return -EINVAL;
 	}
 
-	if (lov_pattern(le32_to_cpu(lmm->lmm_pattern)) != LOV_PATTERN_RAID0) {
+	switch (lov_pattern(le32_to_cpu(lmm->lmm_pattern))) {
+	case LOV_PATTERN_RAID0:
+		break;
+	case LOV_PATTERN_MDT:
+		/* Data-on-MDT files have no OST objects */
+		if (stripe_count == 0)
+			break;
+		/* fall through */
+	default:
 		CERROR("bad striping pattern\n");
 		lov_dump_lmm_common(D_WARNING, lmm);
 		return -EINVAL;
@@ -201,7 +209,8 @@ static int lsm_lmm_verify_v1(struct lov_mds_md_v1 *lmm, int lmm_bytes,
 	}
 
 	*stripe_count = le16_to_cpu(lmm->lmm_stripe_count);
-	if (le32_to_cpu(lmm->lmm_pattern) & LOV_PATTERN_F_RELEASED)
+	if (le32_to_cpu(lmm->lmm_pattern) & LOV_PATTERN_F_RELEASED ||
+	    lov_pattern(le32_to_cpu(lmm->lmm_pattern)) == LOV_PATTERN_MDT)
 		*stripe_count = 0;
 
 	if (lmm_bytes < lov_mds_md_size(*stripe_count, LOV_MAGIC_V1)) {
@@ -224,7 +233,7 @@ int lsm_unpackmd_v1(struct lov_obd *lov, struct lov_stripe_md *lsm,
 
         lsm_unpackmd_common(lsm, lmm);
 
-	stripe_count = lsm_is_released(lsm) ? 0 : lsm->lsm_stripe_count;
+	stripe_count = lsm_has_objects(lsm) ? lsm->lsm_stripe_count : 0;
 
 	for (i = 0; i < stripe_count; i++) {
 		/* XXX LOV STACKING call down to osc_unpackmd() */
@@ -251,6 +260,8 @@ int lsm_unpackmd_v1(struct lov_obd *lov, struct lov_stripe_md *lsm,
 	lsm->lsm_maxbytes = stripe_maxbytes * lsm->lsm_stripe_count;
 	if (lsm->lsm_stripe_count == 0)
 		lsm->lsm_maxbytes = stripe_maxbytes * lov->desc.ld_tgt_count;
+	if (lsm_is_dom(lsm))
+		lsm->lsm_maxbytes = lsm->lsm_stripe_size;
 
 	return 0;
 }
@@ -278,7 +289,8 @@ static int lsm_lmm_verify_v3(struct lov_mds_md *lmmv1, int lmm_bytes,
 	}
 
 	*stripe_count = le16_to_cpu(lmm->lmm_stripe_count);
-	if (le32_to_cpu(lmm->lmm_pattern) & LOV_PATTERN_F_RELEASED)
+	if (le32_to_cpu(lmm->lmm_pattern) & LOV_PATTERN_F_RELEASED ||
+	    lov_pattern(le32_to_cpu(lmm->lmm_pattern)) == LOV_PATTERN_MDT)
 		*stripe_count = 0;
 
 	if (lmm_bytes < lov_mds_md_size(*stripe_count, LOV_MAGIC_V3)) {
@@ -306,7 +318,7 @@ int lsm_unpackmd_v3(struct lov_obd *lov, struct lov_stripe_md *lsm,
 
         lsm_unpackmd_common(lsm, (struct lov_mds_md_v1 *)lmm);
 
-	stripe_count = lsm_is_released(lsm) ? 0 : lsm->lsm_stripe_count;
+	stripe_count = lsm_has_objects(lsm) ? lsm->lsm_stripe_count : 0;
 
 	cplen = strlcpy(lsm->lsm_pool_name, lmm->lmm_pool_name,
 			sizeof(lsm->lsm_pool_name));
@@ -338,6 +350,8 @@ int lsm_unpackmd_v3(struct lov_obd *lov, struct lov_stripe_md *lsm,
 	lsm->lsm_maxbytes = stripe_maxbytes * lsm->lsm_stripe_count;
 	if (lsm->lsm_stripe_count == 0)
 		lsm->lsm_maxbytes = stripe_maxbytes * lov->desc.ld_tgt_count;
+	if (lsm_is_dom(lsm))
+		lsm->lsm_maxbytes = lsm->lsm_stripe_size;
 
 	return 0;
 }
@@ -93,6 +93,16 @@ static void lov_io_sub_inherit(struct cl_io *io, struct lov_io *lio,
                 io->u.ci_setattr.sa_attr = parent->u.ci_setattr.sa_attr;
                 io->u.ci_setattr.sa_valid = parent->u.ci_setattr.sa_valid;
                 io->u.ci_setattr.sa_capa = parent->u.ci_setattr.sa_capa;
+		io->u.ci_setattr.sa_falloc_mode =
+			parent->u.ci_setattr.sa_falloc_mode;
+		if (cl_io_is_fallocate(parent)) {
+			/* the part of the range in this stripe */
+			io->u.ci_setattr.sa_falloc_offset = start;
+			io->u.ci_setattr.sa_falloc_end = end;
+		} else {
+			io->u.ci_setattr.sa_falloc_offset = 0;
+			io->u.ci_setattr.sa_falloc_end = 0;
+		}
                 if (cl_io_is_trunc(io)) {
                         loff_t new_size = parent->u.ci_setattr.sa_attr.lvb_size;
 
@@ -325,6 +335,11 @@ static void lov_io_slice_init(struct lov_io *lio,
                 break;
 
         case CIT_SETATTR:
+		if (cl_io_is_fallocate(io)) {
+			lio->lis_pos = io->u.ci_setattr.sa_falloc_offset;
+			lio->lis_endpos = io->u.ci_setattr.sa_falloc_end;
+			break;
+		}
                 if (cl_io_is_trunc(io))
                         lio->lis_pos = io->u.ci_setattr.sa_attr.lvb_size;
                 else
@@ -1002,4 +1017,44 @@ int lov_io_init_released(const struct lu_env *env, struct cl_object *obj,
 	io->ci_result = result < 0 ? result : 0;
 	RETURN(result != 0);
 }
+
+/**
+ * Data-on-MDT files have no OST objects: the body is read and written by
+ * llite through the MDC (see ll_dom_io()) and truncated by the MDT as part
+ * of setattr, so there is nothing for the cl_io stack to do here.
+ */
+int lov_io_init_dom(const struct lu_env *env, struct cl_object *obj,
+		    struct cl_io *io)
+{
+	struct lov_object *lov = cl2lov(obj);
+	struct lov_io *lio = lov_env_io(env);
+	int result;
+	ENTRY;
+
+	LASSERT(lov->lo_lsm != NULL);
+	lio->lis_object = lov;
+
+	switch (io->ci_type) {
+	default:
+		LASSERTF(0, "invalid type %d\n", io->ci_type);
+	case CIT_SETATTR:
+		/* the MDT has no way to preallocate the body */
+		if (cl_io_is_fallocate(io)) {
+			result = -EOPNOTSUPP;
+			break;
+		}
+	case CIT_MISC:
+	case CIT_FSYNC:
+		result = +1;
+		break;
+	case CIT_READ:
+	case CIT_WRITE:
+	case CIT_FAULT:
+		result = -EBADF;
+		break;
+	}
+
+	io->ci_result = result < 0 ? result : 0;
+	RETURN(result != 0);
+}
 /** @} lov */
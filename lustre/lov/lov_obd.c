@@ -1275,6 +1275,158 @@ out:
         RETURN(rc ? rc : err);
 }
 
+/**
+ * Glimpse the files of \a ogs with one OST_GLIMPSE_BATCH RPC per OST that
+ * holds any of their objects, sent in parallel, and merge the attributes of
+ * the objects of each file into its og_lvb. A file fails with the error of
+ * any of its objects, the caller falls back to a regular glimpse for it.
+ */
+static int lov_glimpse_batch(const struct lu_env *env, struct obd_export *exp,
+			     struct obd_glimpse *ogs, int count, __u32 flags,
+			     struct ptlrpc_request_set *set)
+{
+	struct obd_device		*obd = exp->exp_obd;
+	struct lov_obd			*lov = &obd->u.lov;
+	struct ptlrpc_request_set	*rqset;
+	struct obd_glimpse		*sub = NULL;
+	int				*start = NULL;
+	int				*pos = NULL;
+	int				 nr_tgts;
+	int				 nr = 0;
+	int				 base;
+	int				 i;
+	int				 j;
+	int				 k;
+	int				 rc = 0;
+	ENTRY;
+
+	LASSERT(set == NULL);
+
+	lov_getref(obd);
+	nr_tgts = lov->desc.ld_tgt_count;
+	for (i = 0; i < count; i++) {
+		struct lov_stripe_md *lsm = ogs[i].og_lsm;
+
+		ogs[i].og_rc = 0;
+		if (!lsm_has_objects(lsm) || lsm->lsm_stripe_count == 0) {
+			ogs[i].og_rc = -ENODATA;
+			continue;
+		}
+
+		for (k = 0; k < lsm->lsm_stripe_count; k++) {
+			j = lsm->lsm_oinfo[k]->loi_ost_idx;
+			if (j >= nr_tgts || lov->lov_tgts[j] == NULL ||
+			    !lov->lov_tgts[j]->ltd_active) {
+				ogs[i].og_rc = -EIO;
+				break;
+			}
+		}
+		if (ogs[i].og_rc == 0)
+			nr += lsm->lsm_stripe_count;
+	}
+	if (nr == 0)
+		GOTO(out, rc = 0);
+
+	OBD_ALLOC_LARGE(sub, nr * sizeof(*sub));
+	OBD_ALLOC_LARGE(pos, nr * sizeof(*pos));
+	OBD_ALLOC_LARGE(start, (nr_tgts + 1) * sizeof(*start));
+	if (sub == NULL || pos == NULL || start == NULL) {
+		for (i = 0; i < count; i++)
+			if (ogs[i].og_rc == 0)
+				ogs[i].og_rc = -ENOMEM;
+		GOTO(out, rc = -ENOMEM);
+	}
+
+	/* Sort the objects by OST: start[j] is where the objects of OST j
+	 * begin in sub[], then pos[] tells where each object of each file
+	 * went, in the order of the files and their stripes. */
+	for (i = 0; i < count; i++) {
+		struct lov_stripe_md *lsm = ogs[i].og_lsm;
+
+		if (ogs[i].og_rc != 0)
+			continue;
+		for (k = 0; k < lsm->lsm_stripe_count; k++)
+			start[lsm->lsm_oinfo[k]->loi_ost_idx + 1]++;
+	}
+	for (j = 0; j < nr_tgts; j++)
+		start[j + 1] += start[j];
+
+	for (i = 0, base = 0; i < count; i++) {
+		struct lov_stripe_md *lsm = ogs[i].og_lsm;
+
+		if (ogs[i].og_rc != 0)
+			continue;
+		for (k = 0; k < lsm->lsm_stripe_count; k++) {
+			j = start[lsm->lsm_oinfo[k]->loi_ost_idx]++;
+			sub[j].og_oinfo = lsm->lsm_oinfo[k];
+			pos[base + k] = j;
+		}
+		base += lsm->lsm_stripe_count;
+	}
+
+	/* start[j] is now where the objects of OST j end */
+	rqset = ptlrpc_prep_set();
+	if (rqset == NULL) {
+		for (i = 0; i < count; i++)
+			if (ogs[i].og_rc == 0)
+				ogs[i].og_rc = -ENOMEM;
+		GOTO(out, rc = -ENOMEM);
+	}
+
+	for (j = 0; j < nr_tgts; j++) {
+		int first = j == 0 ? 0 : start[j - 1];
+
+		if (start[j] == first)
+			continue;
+		/* failures are reported in og_rc of each object */
+		obd_glimpse_batch(env, lov->lov_tgts[j]->ltd_exp, &sub[first],
+				  start[j] - first, flags, rqset);
+	}
+	/* ditto, each request is completed or aborted when this returns */
+	ptlrpc_set_wait(rqset);
+	ptlrpc_set_destroy(rqset);
+
+	for (i = 0, base = 0; i < count; i++) {
+		struct lov_stripe_md	*lsm = ogs[i].og_lsm;
+		struct ost_lvb		*lvb = &ogs[i].og_lvb;
+
+		if (ogs[i].og_rc != 0)
+			continue;
+
+		memset(lvb, 0, sizeof(*lvb));
+		for (k = 0; k < lsm->lsm_stripe_count; k++) {
+			struct obd_glimpse	*og = &sub[pos[base + k]];
+			obd_size		 size;
+
+			if (og->og_rc != 0) {
+				ogs[i].og_rc = og->og_rc;
+				continue;
+			}
+
+			size = lov_stripe_size(lsm, og->og_lvb.lvb_size, k);
+			lvb->lvb_size = max(lvb->lvb_size, size);
+			lvb->lvb_blocks += og->og_lvb.lvb_blocks;
+			lvb->lvb_mtime = max(lvb->lvb_mtime,
+					     og->og_lvb.lvb_mtime);
+			lvb->lvb_atime = max(lvb->lvb_atime,
+					     og->og_lvb.lvb_atime);
+			lvb->lvb_ctime = max(lvb->lvb_ctime,
+					     og->og_lvb.lvb_ctime);
+		}
+		base += lsm->lsm_stripe_count;
+	}
+	EXIT;
+out:
+	lov_putref(obd);
+	if (start != NULL)
+		OBD_FREE_LARGE(start, (nr_tgts + 1) * sizeof(*start));
+	if (pos != NULL)
+		OBD_FREE_LARGE(pos, nr * sizeof(*pos));
+	if (sub != NULL)
+		OBD_FREE_LARGE(sub, nr * sizeof(*sub));
+	return rc;
+}
+
 static int lov_setattr(const struct lu_env *env, struct obd_export *exp,
                        struct obd_info *oinfo, struct obd_trans_info *oti)
 {
@@ -2850,6 +3002,7 @@ struct obd_ops lov_obd_ops = {
         .o_destroy             = lov_destroy,
         .o_getattr             = lov_getattr,
         .o_getattr_async       = lov_getattr_async,
+	.o_glimpse_batch       = lov_glimpse_batch,
         .o_setattr             = lov_setattr,
         .o_setattr_async       = lov_setattr_async,
         .o_brw                 = lov_brw,
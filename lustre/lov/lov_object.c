@@ -273,10 +273,26 @@ static int lov_init_released(const struct lu_env *env,
 	return 0;
 }
 
+static int lov_init_dom(const struct lu_env *env,
+			struct lov_device *dev, struct lov_object *lov,
+			const struct cl_object_conf *conf,
+			union  lov_layout_state *state)
+{
+	struct lov_stripe_md *lsm = conf->u.coc_md->lsm;
+
+	LASSERT(lsm != NULL);
+	LASSERT(lsm_is_dom(lsm));
+	LASSERT(lov->lo_lsm == NULL);
+
+	lov->lo_lsm = lsm_addref(lsm);
+	return 0;
+}
+
 static int lov_delete_empty(const struct lu_env *env, struct lov_object *lov,
 			    union lov_layout_state *state)
 {
-	LASSERT(lov->lo_type == LLT_EMPTY || lov->lo_type == LLT_RELEASED);
+	LASSERT(lov->lo_type == LLT_EMPTY || lov->lo_type == LLT_RELEASED ||
+		lov->lo_type == LLT_DOM);
 
 	lov_layout_wait(env, lov);
 
@@ -364,7 +380,8 @@ static int lov_delete_raid0(const struct lu_env *env, struct lov_object *lov,
 static void lov_fini_empty(const struct lu_env *env, struct lov_object *lov,
                            union lov_layout_state *state)
 {
-	LASSERT(lov->lo_type == LLT_EMPTY || lov->lo_type == LLT_RELEASED);
+	LASSERT(lov->lo_type == LLT_EMPTY || lov->lo_type == LLT_RELEASED ||
+		lov->lo_type == LLT_DOM);
 }
 
 static void lov_fini_raid0(const struct lu_env *env, struct lov_object *lov,
@@ -431,6 +448,15 @@ static int lov_print_released(const struct lu_env *env, void *cookie,
 	return 0;
 }
 
+static int lov_print_dom(const struct lu_env *env, void *cookie,
+			 lu_printer_t p, const struct lu_object *o)
+{
+	struct lov_stripe_md *lsm = lu2lov(o)->lo_lsm;
+
+	(*p)(env, cookie, "dom: max size %u\n", lsm->lsm_stripe_size);
+	return 0;
+}
+
 /**
  * Implements cl_object_operations::coo_attr_get() method for an object
  * without stripes (LLT_EMPTY layout type).
@@ -545,7 +571,18 @@ const static struct lov_layout_operations lov_dispatch[] = {
                 .llo_lock_init = lov_lock_init_empty,
                 .llo_io_init   = lov_io_init_released,
                 .llo_getattr   = lov_attr_get_empty
-        }
+	},
+	[LLT_DOM] = {
+		.llo_init      = lov_init_dom,
+		.llo_delete    = lov_delete_empty,
+		.llo_fini      = lov_fini_released,
+		.llo_install   = lov_install_empty,
+		.llo_print     = lov_print_dom,
+		.llo_page_init = lov_page_init_empty,
+		.llo_lock_init = lov_lock_init_empty,
+		.llo_io_init   = lov_io_init_dom,
+		.llo_getattr   = lov_attr_get_empty
+	}
 };
 
 /**
@@ -570,6 +607,8 @@ enum lov_layout_type lov_type(struct lov_stripe_md *lsm)
 		return LLT_EMPTY;
 	if (lsm_is_released(lsm))
 		return LLT_RELEASED;
+	if (lsm_is_dom(lsm))
+		return LLT_DOM;
 	return LLT_RAID0;
 }
 
@@ -981,6 +1020,7 @@ int lov_read_and_clear_async_rc(struct cl_object *clob)
 			}
 		}
 		case LLT_RELEASED:
+		case LLT_DOM:
 		case LLT_EMPTY:
 			break;
 		default:
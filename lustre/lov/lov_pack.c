@@ -437,7 +437,8 @@ static int __lov_setstripe(struct obd_export *exp, int max_lmm_size,
                         lov->desc.ld_pattern : LOV_PATTERN_RAID0;
         }
 
-        if (lov_pattern(lumv1->lmm_pattern) != LOV_PATTERN_RAID0) {
+        if (lov_pattern(lumv1->lmm_pattern) != LOV_PATTERN_RAID0 &&
+	    lov_pattern(lumv1->lmm_pattern) != LOV_PATTERN_MDT) {
                 CDEBUG(D_IOCTL, "bad userland stripe pattern: %#x\n",
                        lumv1->lmm_pattern);
                 RETURN(-EINVAL);
@@ -497,7 +498,8 @@ static int __lov_setstripe(struct obd_export *exp, int max_lmm_size,
                 }
         }
 
-	if (lumv1->lmm_pattern & LOV_PATTERN_F_RELEASED)
+	if (lumv1->lmm_pattern & LOV_PATTERN_F_RELEASED ||
+	    lov_pattern(lumv1->lmm_pattern) == LOV_PATTERN_MDT)
 		stripe_count = 0;
 
         rc = lov_alloc_memmd(lsmp, stripe_count, lumv1->lmm_pattern, lmm_magic);
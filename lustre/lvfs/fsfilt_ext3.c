@@ -204,6 +204,7 @@ struct bpointers {
         int num;
         int init_num;
         int create;
+        unsigned long goal;	/* for the first blocks allocated, if set */
 };
 
 static long ext3_ext_find_goal(struct inode *inode, struct ext3_ext_path *path,
@@ -242,13 +243,15 @@ static long ext3_ext_find_goal(struct inode *inode, struct ext3_ext_path *path,
 #ifndef EXT3_MB_HINT_GROUP_ALLOC
 static unsigned long new_blocks(handle_t *handle, struct ext3_ext_base *base,
                                 struct ext3_ext_path *path, unsigned long block,
-                                unsigned long *count, int *err)
+                                unsigned long *count, unsigned long goal,
+                                int *err)
 {
-        unsigned long pblock, goal;
+        unsigned long pblock;
         int aflags = 0;
         struct inode *inode = ext3_ext_base2inode(base);
 
-        goal = ext3_ext_find_goal(inode, path, block, &aflags);
+        if (goal == 0)
+                goal = ext3_ext_find_goal(inode, path, block, &aflags);
         aflags |= 2; /* block have been already reserved */
         pblock = ext3_mb_new_blocks(handle, inode, goal, count, aflags, err);
         return pblock;
@@ -257,7 +260,8 @@ static unsigned long new_blocks(handle_t *handle, struct ext3_ext_base *base,
 #else
 static unsigned long new_blocks(handle_t *handle, struct ext3_ext_base *base,
                                 struct ext3_ext_path *path, unsigned long block,
-                                unsigned long *count, int *err)
+                                unsigned long *count, unsigned long goal,
+                                int *err)
 {
         struct inode *inode = ext3_ext_base2inode(base);
         struct ext3_allocation_request ar;
@@ -275,7 +279,10 @@ static unsigned long new_blocks(handle_t *handle, struct ext3_ext_base *base,
                 return 0;
 
         /* allocate new block */
-        ar.goal = ext3_ext_find_goal(inode, path, block, &aflags);
+        if (goal != 0)
+                ar.goal = goal;
+        else
+                ar.goal = ext3_ext_find_goal(inode, path, block, &aflags);
         ar.inode = inode;
         ar.logical = block;
         ar.len = *count;
@@ -358,9 +365,12 @@ static int ext3_ext_new_extent_cb(struct ext3_ext_base *base,
         }
 
         count = cex->ec_len;
-        pblock = new_blocks(handle, base, path, cex->ec_block, &count, &err);
+        pblock = new_blocks(handle, base, path, cex->ec_block, &count,
+                            bp->goal, &err);
         if (!pblock)
                 goto out;
+        /* the next blocks follow these ones */
+        bp->goal = 0;
         EXT_ASSERT(count <= cex->ec_len);
 
         /* insert new extent */
@@ -445,7 +455,7 @@ map:
 
 int fsfilt_map_nblocks(struct inode *inode, unsigned long block,
 		       unsigned long num, unsigned long *blocks,
-		       int create)
+		       int create, unsigned long *goal)
 {
         struct ext3_ext_base *base = inode;
         struct bpointers bp;
@@ -458,17 +468,19 @@ int fsfilt_map_nblocks(struct inode *inode, unsigned long block,
         bp.start = block;
         bp.init_num = bp.num = num;
         bp.create = create;
+        bp.goal = *goal;
 
 	err = fsfilt_ext3_ext_walk_space(base, block, num,
 					 ext3_ext_new_extent_cb, &bp);
 	ext3_ext_invalidate_cache(base);
+	*goal = bp.goal;
 
         return err;
 }
 
 int fsfilt_ext3_map_ext_inode_pages(struct inode *inode, struct page **page,
 				    int pages, unsigned long *blocks,
-				    int create)
+				    int create, unsigned long goal)
 {
 	int blocks_per_page = PAGE_CACHE_SIZE >> inode->i_blkbits;
         int rc = 0, i = 0;
@@ -498,7 +510,7 @@ int fsfilt_ext3_map_ext_inode_pages(struct inode *inode, struct page **page,
                 /* process found extent */
                 rc = fsfilt_map_nblocks(inode, fp->index * blocks_per_page,
 					clen * blocks_per_page, blocks,
-					create);
+					create, &goal);
                 if (rc)
                         GOTO(cleanup, rc);
 
@@ -510,7 +522,7 @@ int fsfilt_ext3_map_ext_inode_pages(struct inode *inode, struct page **page,
         if (fp)
                 rc = fsfilt_map_nblocks(inode, fp->index * blocks_per_page,
 					clen * blocks_per_page, blocks,
-					create);
+					create, &goal);
 cleanup:
         return rc;
 }
@@ -536,15 +548,21 @@ int fsfilt_ext3_map_bm_inode_pages(struct inode *inode, struct page **page,
         return rc;
 }
 
+/*
+ * Map \a pages of \a inode to \a blocks, allocating the missing ones when
+ * \a create is set. A non-zero \a goal is where the first new blocks of an
+ * extent-mapped inode are looked for, instead of after its nearest extent.
+ */
 int fsfilt_ext3_map_inode_pages(struct inode *inode, struct page **page,
 				int pages, unsigned long *blocks,
-				int create, struct mutex *optional_mutex)
+				int create, unsigned long goal,
+				struct mutex *optional_mutex)
 {
         int rc;
 
         if (EXT3_I(inode)->i_flags & EXT3_EXTENTS_FL) {
 		rc = fsfilt_ext3_map_ext_inode_pages(inode, page, pages,
-						     blocks, create);
+						     blocks, create, goal);
                 return rc;
         }
         if (optional_mutex != NULL)
@@ -72,6 +72,8 @@ void mdc_open_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
                    __u32 mode, __u64 rdev, __u32 flags, const void *data,
                    int datalen);
 void mdc_unlink_pack(struct ptlrpc_request *req, struct md_op_data *op_data);
+void mdc_unlink_batch_pack(struct ptlrpc_request *req,
+			   struct md_op_data *op_data);
 void mdc_link_pack(struct ptlrpc_request *req, struct md_op_data *op_data);
 void mdc_rename_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
                      const char *old, int oldlen, const char *new, int newlen);
@@ -142,6 +144,8 @@ int mdc_setattr(struct obd_export *exp, struct md_op_data *op_data,
                 struct ptlrpc_request **request, struct md_open_data **mod);
 int mdc_unlink(struct obd_export *exp, struct md_op_data *op_data,
                struct ptlrpc_request **request);
+int mdc_unlink_batch(struct obd_export *exp, struct md_op_data *op_data,
+		     int count, __s32 *rcs);
 int mdc_cancel_unused(struct obd_export *exp, const struct lu_fid *fid,
                       ldlm_policy_data_t *policy, ldlm_mode_t mode,
                       ldlm_cancel_flags_t flags, void *opaque);
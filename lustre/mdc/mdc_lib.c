@@ -413,6 +413,32 @@ void mdc_unlink_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
         LOGL0(op_data->op_name, op_data->op_namelen, tmp);
 }
 
+void mdc_unlink_batch_pack(struct ptlrpc_request *req,
+			   struct md_op_data *op_data)
+{
+	struct mdt_rec_unlink	*rec;
+	char			*tmp;
+
+	rec = req_capsule_client_get(&req->rq_pill, &RMF_REC_REINT);
+	LASSERT(rec != NULL);
+
+	rec->ul_opcode	= REINT_UNLINK_BATCH;
+	rec->ul_fsuid	= op_data->op_fsuid;
+	rec->ul_fsgid	= op_data->op_fsgid;
+	rec->ul_cap	= op_data->op_cap;
+	rec->ul_suppgid1 = op_data->op_suppgids[0];
+	rec->ul_suppgid2 = -1;
+	rec->ul_fid1	= op_data->op_fid1;
+	rec->ul_time	= op_data->op_mod_time;
+	rec->ul_bias	= op_data->op_bias;
+
+	mdc_pack_capa(req, &RMF_CAPA1, op_data->op_capa1);
+
+	tmp = req_capsule_client_get(&req->rq_pill, &RMF_NAMES);
+	LASSERT(tmp != NULL);
+	memcpy(tmp, op_data->op_name, op_data->op_namelen);
+}
+
 void mdc_link_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
 {
         struct mdt_rec_link *rec;
@@ -434,6 +434,9 @@ static struct ptlrpc_request *mdc_intent_getattr_pack(struct obd_export *exp,
         lit = req_capsule_client_get(&req->rq_pill, &RMF_LDLM_INTENT);
         lit->opc = (__u64)it->it_op;
 
+	/* ask for the lazy size-on-MDT of a regular file */
+	valid |= op_data->op_valid & OBD_MD_FLLAZYSIZE;
+
         /* pack the intended request */
         mdc_getattr_pack(req, valid, it->it_flags, op_data,
                          obddev->u.cli.cl_max_mds_easize);
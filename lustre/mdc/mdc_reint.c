@@ -377,6 +377,69 @@ int mdc_unlink(struct obd_export *exp, struct md_op_data *op_data,
         RETURN(rc);
 }
 
+/**
+ * Unlink the \a count names packed in op_data->op_name from the directory
+ * op_data->op_fid1 in one RPC, returning the result of each in \a rcs.
+ */
+int mdc_unlink_batch(struct obd_export *exp, struct md_op_data *op_data,
+		     int count, __s32 *rcs)
+{
+	CFS_LIST_HEAD(cancels);
+	struct obd_device	*obd = class_exp2obd(exp);
+	struct ptlrpc_request	*req;
+	__s32			*reply_rcs;
+	int			 cancel = 0;
+	int			 rc;
+	ENTRY;
+
+	if (!(exp_connect_flags(exp) & OBD_CONNECT_UNLINK_BATCH))
+		RETURN(-EOPNOTSUPP);
+
+	LASSERT(count > 0 && count <= MDS_UNLINK_BATCH_MAX);
+	LASSERT(op_data->op_namelen <= MDS_UNLINK_BATCH_SIZE);
+
+	if ((op_data->op_flags & MF_MDC_CANCEL_FID1) &&
+	    (fid_is_sane(&op_data->op_fid1)))
+		cancel = mdc_resource_get_unused(exp, &op_data->op_fid1,
+						 &cancels, LCK_EX,
+						 MDS_INODELOCK_UPDATE);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_MDS_REINT_UNLINK_BATCH);
+	if (req == NULL) {
+		ldlm_lock_list_put(&cancels, l_bl_ast, cancel);
+		RETURN(-ENOMEM);
+	}
+	mdc_set_capa_size(req, &RMF_CAPA1, op_data->op_capa1);
+	req_capsule_set_size(&req->rq_pill, &RMF_NAMES, RCL_CLIENT,
+			     op_data->op_namelen);
+
+	rc = mdc_prep_elc_req(exp, req, MDS_REINT, &cancels, cancel);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+
+	mdc_unlink_batch_pack(req, op_data);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_RCS, RCL_SERVER,
+			     count * sizeof(__s32));
+	ptlrpc_request_set_replen(req);
+
+	rc = mdc_reint(req, obd->u.cli.cl_rpc_lock, LUSTRE_IMP_FULL);
+	if (rc == 0) {
+		reply_rcs = req_capsule_server_sized_get(&req->rq_pill,
+							 &RMF_RCS,
+							 count * sizeof(__s32));
+		if (reply_rcs == NULL)
+			rc = -EPROTO;
+		else
+			memcpy(rcs, reply_rcs, count * sizeof(__s32));
+	}
+	ptlrpc_req_finished(req);
+	RETURN(rc);
+}
+
 int mdc_link(struct obd_export *exp, struct md_op_data *op_data,
              struct ptlrpc_request **request)
 {
@@ -413,6 +413,15 @@ static int mdc_xattr_common(struct obd_export *exp,const struct req_format *fmt,
         if (req_capsule_has_field(&req->rq_pill, &RMF_EADATA, RCL_SERVER))
                 req_capsule_set_size(&req->rq_pill, &RMF_EADATA,
                                      RCL_SERVER, output_size);
+	if (req_capsule_has_field(&req->rq_pill, &RMF_EAVALS, RCL_SERVER)) {
+		/* a larger reply is resent with a larger buffer */
+		req_capsule_set_size(&req->rq_pill, &RMF_EAVALS, RCL_SERVER,
+				     valid & OBD_MD_FLXATTRALL ?
+				     output_size : 0);
+		req_capsule_set_size(&req->rq_pill, &RMF_EAVALS_LENS,
+				     RCL_SERVER, valid & OBD_MD_FLXATTRALL ?
+				     output_size / 8 : 0);
+	}
         ptlrpc_request_set_replen(req);
 
         /* make rpc */
@@ -631,6 +640,8 @@ out:
 #endif
                 if (md->lsm)
                         obd_free_memmd(dt_exp, &md->lsm);
+		if (md->mea)
+			obd_free_memmd(md_exp, (void *)&md->mea);
         }
         return rc;
 }
@@ -1036,11 +1047,113 @@ out:
 EXPORT_SYMBOL(mdc_sendpage);
 #endif
 
+/* Maximum number of entry locks offered by one readdir-plus request, the
+ * handles have to fit into the MDS_MAXREQSIZE request buffer. */
+#define MDC_READDIR_PLUS_LOCKS	256
+
+/**
+ * Prepare the locks the MDT may grant on the entries of a readdir-plus page.
+ *
+ * The locks are created on the directory resource with a PR reference held,
+ * and are moved onto the resource of the entry they are granted for in
+ * mdc_readdir_plus_fini().
+ *
+ * \retval number of locks prepared
+ */
+static int mdc_readdir_plus_prep(struct obd_export *exp,
+				 struct md_op_data *op_data,
+				 struct lustre_handle *lockh, int count)
+{
+	struct ldlm_enqueue_info einfo = {
+		.ei_type	= LDLM_IBITS,
+		.ei_mode	= LCK_PR,
+		.ei_cb_bl	= op_data->op_cb_blocking
+	};
+	struct ldlm_res_id	 res_id;
+	int			 i;
+
+	fid_build_reg_res_name(&op_data->op_fid1, &res_id);
+	for (i = 0; i < count; i++) {
+		if (ldlm_cli_lock_prep(exp, &res_id, &einfo, 0, LVB_T_NONE,
+				       &lockh[i]) != 0)
+			break;
+	}
+	return i;
+}
+
+/**
+ * Adopt the entry locks granted by the MDT and drop the unused ones.
+ *
+ * On return lda_cookie of every entry with non-zero lda_valid holds the
+ * handle of a granted local lock, referenced in LCK_PR mode for the caller.
+ */
+static void mdc_readdir_plus_fini(struct obd_export *exp,
+				  struct page **pages, int nob,
+				  struct lustre_handle *lockh, int count)
+{
+	ldlm_policy_data_t	policy = {
+		.l_inodebits = { MDS_INODELOCK_LOOKUP | MDS_INODELOCK_UPDATE } };
+	int			granted = 0;
+	int			i;
+
+	for (i = 0; nob > 0; i++) {
+		struct lu_dirpage *dp = cfs_kmap(pages[i]);
+		int		   j;
+
+		for (j = 0; j < LU_PAGE_COUNT && nob > 0;
+		     j++, nob -= LU_PAGE_SIZE) {
+			struct lu_dirent *ent;
+
+			for (ent = lu_dirent_start(dp); ent != NULL;
+			     ent = lu_dirent_next(ent)) {
+				struct luda_attrs	*lda;
+				struct lu_fid		 fid;
+				struct ldlm_res_id	 res_id;
+				struct lustre_handle	 remote;
+				__u32			 idx;
+
+				lda = lu_dirent_attrs(ent);
+				if (lda == NULL || lda->lda_valid == 0)
+					continue;
+
+				idx = le32_to_cpu(lda->lda_lock_idx);
+				if (idx >= count || lockh[idx].cookie == 0) {
+					lda->lda_valid = 0;
+					continue;
+				}
+
+				fid_le_to_cpu(&fid, &ent->lde_fid);
+				fid_build_reg_res_name(&fid, &res_id);
+				remote.cookie = le64_to_cpu(lda->lda_cookie);
+				if (ldlm_cli_lock_adopt(exp, &lockh[idx],
+							&res_id, &policy,
+							&remote, NULL, 0) != 0) {
+					lda->lda_valid = 0;
+					continue;
+				}
+				lda->lda_cookie = lockh[idx].cookie;
+				lockh[idx].cookie = 0;
+				granted++;
+			}
+			dp = (struct lu_dirpage *)((char *)dp + LU_PAGE_SIZE);
+		}
+		cfs_kunmap(pages[i]);
+	}
+	CDEBUG(D_DLMTRACE, "adopted %d/%d readdir-plus locks\n",
+	       granted, count);
+
+	for (i = 0; i < count; i++)
+		if (lockh[i].cookie != 0)
+			ldlm_cli_lock_abort(&lockh[i], LCK_PR);
+}
+
 int mdc_readpage(struct obd_export *exp, struct md_op_data *op_data,
                  struct page **pages, struct ptlrpc_request **request)
 {
         struct ptlrpc_request   *req;
         struct ptlrpc_bulk_desc *desc;
+	struct lustre_handle	*lockh = NULL;
+	int			 nlocks = 0;
         int                      i;
         cfs_waitq_t              waitq;
         int                      resends = 0;
@@ -1051,17 +1164,27 @@ int mdc_readpage(struct obd_export *exp, struct md_op_data *op_data,
         *request = NULL;
         cfs_waitq_init(&waitq);
 
+	if (op_data->op_cli_flags & CLI_READDIR_PLUS &&
+	    exp_connect_flags(exp) & OBD_CONNECT_READDIR_PLUS) {
+		OBD_ALLOC(lockh, MDC_READDIR_PLUS_LOCKS * sizeof(*lockh));
+		if (lockh != NULL)
+			nlocks = mdc_readdir_plus_prep(exp, op_data, lockh,
+						       MDC_READDIR_PLUS_LOCKS);
+	}
+
 restart_bulk:
         req = ptlrpc_request_alloc(class_exp2cliimp(exp), &RQF_MDS_READPAGE);
         if (req == NULL)
-                RETURN(-ENOMEM);
+		GOTO(out_locks, rc = -ENOMEM);
 
         mdc_set_capa_size(req, &RMF_CAPA1, op_data->op_capa1);
+	req_capsule_set_size(&req->rq_pill, &RMF_DLM_HANDLES, RCL_CLIENT,
+			     nlocks * sizeof(*lockh));
 
         rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, MDS_READPAGE);
         if (rc) {
                 ptlrpc_request_free(req);
-                RETURN(rc);
+		GOTO(out_locks, rc);
         }
 
         req->rq_request_portal = MDS_READPAGE_PORTAL;
@@ -1071,7 +1194,7 @@ restart_bulk:
 				    MDS_BULK_PORTAL);
         if (desc == NULL) {
                 ptlrpc_request_free(req);
-                RETURN(-ENOMEM);
+		GOTO(out_locks, rc = -ENOMEM);
         }
 
         /* NB req now owns desc and will free it when it gets freed */
@@ -1081,18 +1204,26 @@ restart_bulk:
         mdc_readdir_pack(req, op_data->op_offset,
 			 PAGE_CACHE_SIZE * op_data->op_npages,
                          &op_data->op_fid1, op_data->op_capa1);
+	if (nlocks > 0) {
+		struct mdt_body *body;
+
+		body = req_capsule_client_get(&req->rq_pill, &RMF_MDT_BODY);
+		body->mode |= LUDA_ATTRS;
+		memcpy(req_capsule_client_get(&req->rq_pill, &RMF_DLM_HANDLES),
+		       lockh, nlocks * sizeof(*lockh));
+	}
 
         ptlrpc_request_set_replen(req);
         rc = ptlrpc_queue_wait(req);
         if (rc) {
                 ptlrpc_req_finished(req);
                 if (rc != -ETIMEDOUT)
-                        RETURN(rc);
+			GOTO(out_locks, rc);
 
                 resends++;
                 if (!client_should_resend(resends, &exp->exp_obd->u.cli)) {
                         CERROR("too many resend retries, returning error\n");
-                        RETURN(-EIO);
+			GOTO(out_locks, rc = -EIO);
                 }
                 lwi = LWI_TIMEOUT_INTR(cfs_time_seconds(resends), NULL, NULL, NULL);
                 l_wait_event(waitq, 0, &lwi);
@@ -1104,7 +1235,7 @@ restart_bulk:
                                           req->rq_bulk->bd_nob_transferred);
         if (rc < 0) {
                 ptlrpc_req_finished(req);
-                RETURN(rc);
+		GOTO(out_locks, rc);
         }
 
         if (req->rq_bulk->bd_nob_transferred & ~LU_PAGE_MASK) {
@@ -1112,11 +1243,113 @@ restart_bulk:
                         req->rq_bulk->bd_nob_transferred,
 			PAGE_CACHE_SIZE * op_data->op_npages);
                 ptlrpc_req_finished(req);
-                RETURN(-EPROTO);
+		GOTO(out_locks, rc = -EPROTO);
         }
 
+	if (nlocks > 0)
+		mdc_readdir_plus_fini(exp, pages,
+				      req->rq_bulk->bd_nob_transferred,
+				      lockh, nlocks);
+	nlocks = 0;
         *request = req;
-        RETURN(0);
+	rc = 0;
+out_locks:
+	/* locks the MDT could not have granted */
+	for (i = 0; i < nlocks; i++)
+		ldlm_cli_lock_abort(&lockh[i], LCK_PR);
+	if (lockh != NULL)
+		OBD_FREE(lockh, MDC_READDIR_PLUS_LOCKS * sizeof(*lockh));
+	RETURN(rc);
+}
+
+/**
+ * Read or write the body of a Data-on-MDT file.
+ *
+ * op_data->op_offset is the file offset, op_data->op_count the number of
+ * bytes, \a pages are filled from offset 0. A read at or beyond EOF returns
+ * 0 bytes, otherwise the number of bytes transferred is returned and the
+ * reply (carrying the file size) is left in \a request.
+ */
+static int mdc_dom_rw(struct obd_export *exp, struct md_op_data *op_data,
+		      struct page **pages, int rw,
+		      struct ptlrpc_request **request)
+{
+	struct ptlrpc_request	*req;
+	struct ptlrpc_bulk_desc	*desc;
+	int			 opc = rw == OBD_BRW_WRITE ? MDS_WRITEPAGE :
+						      MDS_READPAGE;
+	int			 npages;
+	int			 nob;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	*request = NULL;
+	npages = (op_data->op_count + PAGE_CACHE_SIZE - 1) >>
+		 PAGE_CACHE_SHIFT;
+	LASSERT(npages > 0 && npages <= op_data->op_npages);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   rw == OBD_BRW_WRITE ? &RQF_MDS_WRITEPAGE :
+							 &RQF_MDS_READPAGE);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	mdc_set_capa_size(req, &RMF_CAPA1, op_data->op_capa1);
+	if (rw == OBD_BRW_READ)
+		req_capsule_set_size(&req->rq_pill, &RMF_DLM_HANDLES,
+				     RCL_CLIENT, 0);
+
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, opc);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+
+	req->rq_request_portal = MDS_READPAGE_PORTAL;
+	ptlrpc_at_set_req_timeout(req);
+
+	desc = ptlrpc_prep_bulk_imp(req, npages, 1,
+				    rw == OBD_BRW_WRITE ? BULK_GET_SOURCE :
+							  BULK_PUT_SINK,
+				    MDS_BULK_PORTAL);
+	if (desc == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	/* NB req now owns desc and will free it when it gets freed */
+	for (i = 0, nob = op_data->op_count; i < npages; i++) {
+		ptlrpc_prep_bulk_page_pin(desc, pages[i], 0,
+					  min_t(int, nob, PAGE_CACHE_SIZE));
+		nob -= PAGE_CACHE_SIZE;
+	}
+
+	mdc_readdir_pack(req, op_data->op_offset, op_data->op_count,
+			 &op_data->op_fid1, op_data->op_capa1);
+
+	ptlrpc_request_set_replen(req);
+	rc = ptlrpc_queue_wait(req);
+	if (rc == -ENODATA && rw == OBD_BRW_READ)
+		/* the MDT has no data at op_offset */
+		GOTO(out, rc = 0);
+	if (rc)
+		GOTO(out, rc);
+
+	if (rw == OBD_BRW_WRITE) {
+		rc = sptlrpc_cli_unwrap_bulk_write(req, req->rq_bulk);
+		if (rc == 0)
+			rc = op_data->op_count;
+	} else {
+		rc = sptlrpc_cli_unwrap_bulk_read(req, req->rq_bulk,
+					req->rq_bulk->bd_nob_transferred);
+	}
+	if (rc < 0)
+		GOTO(out, rc);
+
+	*request = req;
+	RETURN(rc);
+out:
+	ptlrpc_req_finished(req);
+	return rc;
 }
 
 static int mdc_statfs(const struct lu_env *env,
@@ -2759,6 +2992,8 @@ struct md_ops mdc_md_ops = {
         .m_getxattr         = mdc_getxattr,
         .m_sync             = mdc_sync,
         .m_readpage         = mdc_readpage,
+	.m_dom_rw           = mdc_dom_rw,
+	.m_unlink_batch     = mdc_unlink_batch,
         .m_unlink           = mdc_unlink,
         .m_cancel_unused    = mdc_cancel_unused,
         .m_init_ea_size     = mdc_init_ea_size,
@@ -206,8 +206,9 @@ int mdd_is_subdir(const struct lu_env *env, struct md_object *mo,
  *           -ve        other error
  *
  */
-static int mdd_dir_is_empty(const struct lu_env *env,
-                            struct mdd_object *dir)
+/* check \a dir has no entry but "." and ".." and \a extra other ones */
+static int __mdd_dir_is_empty(const struct lu_env *env,
+			      struct mdd_object *dir, int extra)
 {
         struct dt_it     *it;
         struct dt_object *obj;
@@ -225,7 +226,8 @@ static int mdd_dir_is_empty(const struct lu_env *env,
                 result = iops->get(env, it, (const void *)"");
                 if (result > 0) {
                         int i;
-                        for (result = 0, i = 0; result == 0 && i < 3; ++i)
+                        for (result = 0, i = 0;
+			     result == 0 && i < 3 + extra; ++i)
                                 result = iops->next(env, it);
                         if (result == 0)
                                 result = -ENOTEMPTY;
@@ -244,6 +246,12 @@ static int mdd_dir_is_empty(const struct lu_env *env,
         RETURN(result);
 }
 
+static inline int mdd_dir_is_empty(const struct lu_env *env,
+				   struct mdd_object *dir)
+{
+	return __mdd_dir_is_empty(env, dir, 0);
+}
+
 static int __mdd_may_link(const struct lu_env *env, struct mdd_object *obj)
 {
         struct mdd_device *m = mdd_obj2mdd_dev(obj);
@@ -1334,6 +1342,215 @@ int mdd_unlink_sanity_check(const struct lu_env *env, struct mdd_object *pobj,
         RETURN(rc);
 }
 
+/*
+ * Striped directories.
+ *
+ * The client allocates the FIDs of the shards and sends them in the
+ * lmv_stripe_md of a striped mkdir, see lmv_create(). Each shard is a
+ * directory, possibly on another MDT, inserted into the master directory
+ * under LMV_SHARD_NAME_FMT, and the stripe EA is kept as XATTR_NAME_LMV of
+ * the master. All of it is done in the transaction creating the master,
+ * and undone in the one removing it.
+ */
+static const struct lu_name *mdd_shard_name(const struct lu_env *env,
+					    struct mdd_object *shard, int i)
+{
+	char *key = mdd_env_info(env)->mti_key;
+
+	snprintf(key, sizeof(mdd_env_info(env)->mti_key), LMV_SHARD_NAME_FMT,
+		 PFID(mdo2fid(shard)), i);
+	return mdd_name_get_const(env, key, strlen(key));
+}
+
+static void mdd_shards_put(const struct lu_env *env,
+			   struct mdd_object **shards, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (shards[i] != NULL && !IS_ERR(shards[i]))
+			mdd_object_put(env, shards[i]);
+	OBD_FREE(shards, sizeof(*shards) * count);
+}
+
+/**
+ * Find the shards of directory \a c from its stripe EA.
+ *
+ * \retval	the \a count shards, to be released with mdd_shards_put()
+ * \retval	NULL if \a c is not striped
+ */
+static struct mdd_object **mdd_shards_find(const struct lu_env *env,
+					   struct mdd_device *mdd,
+					   struct mdd_object *c, int *count)
+{
+	struct lu_fid		 *fid = &mdd_env_info(env)->mti_fid2;
+	struct lmv_stripe_md	 *mea;
+	struct mdd_object	**shards = NULL;
+	struct lu_buf		  buf;
+	int			  size;
+	int			  rc;
+	int			  i;
+
+	size = mdo_xattr_get(env, c, &LU_BUF_NULL, XATTR_NAME_LMV,
+			     BYPASS_CAPA);
+	if (size == -ENODATA)
+		return NULL;
+	if (size < 0)
+		return ERR_PTR(size);
+	if (size < sizeof(*mea))
+		return ERR_PTR(-EINVAL);
+
+	OBD_ALLOC_LARGE(mea, size);
+	if (mea == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	buf.lb_buf = mea;
+	buf.lb_len = size;
+	rc = mdo_xattr_get(env, c, &buf, XATTR_NAME_LMV, BYPASS_CAPA);
+	if (rc >= 0 && (rc != size || le32_to_cpu(mea->mea_count) == 0 ||
+			size != lmv_stripe_md_size(le32_to_cpu(mea->mea_count))))
+		rc = -EINVAL;
+	if (rc < 0)
+		GOTO(out, shards = ERR_PTR(rc));
+
+	*count = le32_to_cpu(mea->mea_count);
+	OBD_ALLOC(shards, sizeof(*shards) * *count);
+	if (shards == NULL)
+		GOTO(out, shards = ERR_PTR(-ENOMEM));
+
+	for (i = 0; i < *count; i++) {
+		fid_le_to_cpu(fid, &mea->mea_ids[i]);
+		shards[i] = mdd_object_find(env, mdd, fid);
+		if (IS_ERR(shards[i])) {
+			rc = PTR_ERR(shards[i]);
+			mdd_shards_put(env, shards, *count);
+			GOTO(out, shards = ERR_PTR(rc));
+		}
+	}
+out:
+	OBD_FREE_LARGE(mea, size);
+	return shards;
+}
+
+/**
+ * Check striped directory \a c can be removed: its shards are empty and it
+ * has no other entry. Called before the transaction starts, as the updates
+ * of the remote shards are sent with its start; the MDT holds the locks of
+ * the shards so that nothing is created in them meanwhile.
+ */
+static int mdd_unlink_stripes_check(const struct lu_env *env,
+				    struct mdd_object *c,
+				    struct mdd_object **shards, int count)
+{
+	struct lu_attr	*la = &mdd_env_info(env)->mti_la;
+	int		 rc;
+	int		 i;
+
+	for (i = 0; i < count; i++) {
+		if (!mdd_object_exists(shards[i]))
+			continue;
+
+		/* refresh the emptiness of a remote shard, see
+		 * osp_md_attr_get() */
+		if (mdd_object_remote(shards[i])) {
+			rc = mdo_attr_get(env, shards[i], la, BYPASS_CAPA);
+			if (rc == -ENOENT)
+				continue;
+			if (rc != 0)
+				return rc;
+		}
+
+		rc = mdd_dir_is_empty(env, shards[i]);
+		if (rc != 0)
+			return rc;
+	}
+
+	return __mdd_dir_is_empty(env, c, count);
+}
+
+static int mdd_declare_unlink_stripes(const struct lu_env *env,
+				      struct mdd_object *c,
+				      struct mdd_object **shards, int count,
+				      struct thandle *handle)
+{
+	const struct lu_name	*lname;
+	int			 rc;
+	int			 i;
+
+	for (i = 0; i < count; i++) {
+		lname = mdd_shard_name(env, shards[i], i);
+		rc = mdo_declare_index_delete(env, c, lname->ln_name, handle);
+		if (rc)
+			return rc;
+
+		rc = mdo_declare_ref_del(env, c, handle);
+		if (rc)
+			return rc;
+
+		if (!mdd_object_exists(shards[i]))
+			continue;
+
+		rc = mdo_declare_ref_del(env, shards[i], handle);
+		if (rc)
+			return rc;
+
+		rc = mdo_declare_ref_del(env, shards[i], handle);
+		if (rc)
+			return rc;
+
+		rc = mdo_declare_destroy(env, shards[i], handle);
+		if (rc)
+			return rc;
+	}
+
+	return 0;
+}
+
+/*
+ * Remove the shards of \a c, checked by mdd_unlink_stripes_check(). Called
+ * with \a c write locked.
+ */
+static int mdd_unlink_stripes(const struct lu_env *env, struct mdd_object *c,
+			      struct mdd_object **shards, int count,
+			      struct thandle *handle)
+{
+	const struct lu_name	*lname;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	for (i = 0; i < count; i++) {
+		lname = mdd_shard_name(env, shards[i], i);
+		rc = __mdd_index_delete_only(env, c, lname->ln_name, handle,
+					     BYPASS_CAPA);
+		/* already gone after a failed striped mkdir */
+		if (rc == -ENOENT)
+			continue;
+		if (rc != 0)
+			RETURN(rc);
+
+		/* ".." of the shard */
+		rc = mdo_ref_del(env, c, handle);
+		if (rc != 0)
+			RETURN(rc);
+
+		if (!mdd_object_exists(shards[i]))
+			continue;
+
+		mdd_write_lock(env, shards[i], MOR_TGT_CHILD);
+		rc = mdo_ref_del(env, shards[i], handle);
+		if (rc == 0)
+			rc = mdo_ref_del(env, shards[i], handle);
+		if (rc == 0)
+			rc = mdo_destroy(env, shards[i], handle);
+		mdd_write_unlock(env, shards[i]);
+		if (rc != 0)
+			RETURN(rc);
+	}
+
+	RETURN(0);
+}
+
 static int mdd_declare_unlink(const struct lu_env *env, struct mdd_device *mdd,
 			      struct mdd_object *p, struct mdd_object *c,
 			      const struct lu_name *name, struct md_attr *ma,
@@ -1407,9 +1624,11 @@ static int mdd_unlink(const struct lu_env *env, struct md_object *pobj,
         struct mdd_object *mdd_pobj = md2mdd_obj(pobj);
 	struct mdd_object *mdd_cobj = NULL;
         struct mdd_device *mdd = mdo2mdd(pobj);
+	struct mdd_object **shards = NULL;
         struct dynlock_handle *dlh;
         struct thandle    *handle;
 	int rc, is_dir = 0;
+	int nr_shards = 0;
         ENTRY;
 
 	/* cobj == NULL means only delete name entry */
@@ -1422,15 +1641,42 @@ static int mdd_unlink(const struct lu_env *env, struct md_object *pobj,
 		is_dir = 1;
 	}
 
+	if (likely(mdd_cobj != NULL) && !mdd_object_remote(mdd_cobj) &&
+	    S_ISDIR(mdd_object_type(mdd_cobj))) {
+		shards = mdd_shards_find(env, mdd, mdd_cobj, &nr_shards);
+		if (IS_ERR(shards))
+			RETURN(PTR_ERR(shards));
+	}
+
+	/* nothing can be checked once the remote shards are gone */
+	if (shards != NULL) {
+		rc = mdd_la_get(env, mdd_cobj, cattr, BYPASS_CAPA);
+		if (rc == 0)
+			rc = mdd_may_delete(env, mdd_pobj, mdd_cobj, cattr,
+					    NULL, 1, 0);
+		if (rc == 0)
+			rc = mdd_unlink_stripes_check(env, mdd_cobj, shards,
+						      nr_shards);
+		if (rc)
+			GOTO(out_shards, rc);
+	}
+
 	handle = mdd_trans_create(env, mdd);
-        if (IS_ERR(handle))
-                RETURN(PTR_ERR(handle));
+	if (IS_ERR(handle))
+		GOTO(out_shards, rc = PTR_ERR(handle));
 
 	rc = mdd_declare_unlink(env, mdd, mdd_pobj, mdd_cobj,
 				lname, ma, handle, no_name);
 	if (rc)
 		GOTO(stop, rc);
 
+	if (shards != NULL) {
+		rc = mdd_declare_unlink_stripes(env, mdd_cobj, shards,
+						nr_shards, handle);
+		if (rc)
+			GOTO(stop, rc);
+	}
+
 	rc = mdd_trans_start(env, mdd, handle);
 	if (rc)
 		GOTO(stop, rc);
@@ -1452,7 +1698,15 @@ static int mdd_unlink(const struct lu_env *env, struct md_object *pobj,
 
 	}
 
-	rc = mdd_unlink_sanity_check(env, mdd_pobj, mdd_cobj, cattr);
+	if (shards != NULL) {
+		/* the shards were checked before the transaction started */
+		rc = mdd_may_delete(env, mdd_pobj, mdd_cobj, cattr, NULL, 1, 0);
+		if (rc == 0)
+			rc = mdd_unlink_stripes(env, mdd_cobj, shards,
+						nr_shards, handle);
+	} else {
+		rc = mdd_unlink_sanity_check(env, mdd_pobj, mdd_cobj, cattr);
+	}
 	if (rc)
 		GOTO(cleanup, rc);
 
@@ -1545,6 +1799,9 @@ cleanup:
 
 stop:
         mdd_trans_stop(env, mdd, rc, handle);
+out_shards:
+	if (shards != NULL)
+		mdd_shards_put(env, shards, nr_shards);
 
         return rc;
 }
@@ -1976,6 +2233,208 @@ static int mdd_acl_init(const struct lu_env *env, struct mdd_object *pobj,
 	RETURN(rc);
 }
 
+/* striped mkdir, see "Striped directories" above */
+static inline int mdd_create_striped(const struct lu_attr *attr,
+				     const struct md_op_spec *spec)
+{
+	return S_ISDIR(attr->la_mode) && spec->u.sp_ea.eadatalen > 0;
+}
+
+static struct mdd_object **mdd_shards_new(const struct lu_env *env,
+					  struct mdd_device *mdd,
+					  const struct lmv_stripe_md *mea,
+					  int count)
+{
+	struct lu_object_conf	 conf = { .loc_flags = LOC_F_NEW };
+	struct lu_fid		*fid = &mdd_env_info(env)->mti_fid2;
+	struct mdd_object	**shards;
+	struct lu_object	*o;
+	int			 i;
+
+	OBD_ALLOC(shards, sizeof(*shards) * count);
+	if (shards == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		fid_le_to_cpu(fid, &mea->mea_ids[i]);
+		o = lu_object_find_slice(env, mdd2lu_dev(mdd), fid, &conf);
+		if (IS_ERR(o)) {
+			mdd_shards_put(env, shards, count);
+			return ERR_PTR(PTR_ERR(o));
+		}
+		shards[i] = lu2mdd_obj(o);
+	}
+	return shards;
+}
+
+static int mdd_declare_create_stripes(const struct lu_env *env,
+				      struct mdd_object *c,
+				      struct mdd_object **shards, int count,
+				      struct lu_attr *attr,
+				      struct thandle *handle,
+				      const struct md_op_spec *spec)
+{
+	const struct lu_name	*lname;
+	int			 rc;
+	int			 i;
+
+	for (i = 0; i < count; i++) {
+		mdd_object_make_hint(env, c, shards[i], attr);
+		rc = mdd_declare_object_create_internal(env, c, shards[i],
+							attr, handle, spec);
+		if (rc)
+			return rc;
+
+		rc = mdd_declare_object_initialize(env, c, shards[i], attr,
+						   handle, NULL);
+		if (rc)
+			return rc;
+
+		lname = mdd_shard_name(env, shards[i], i);
+		rc = mdo_declare_index_insert(env, c, mdo2fid(shards[i]),
+					      lname->ln_name, handle);
+		if (rc)
+			return rc;
+
+		rc = mdo_declare_ref_add(env, c, handle);
+		if (rc)
+			return rc;
+	}
+
+	return mdo_declare_xattr_set(env, c,
+				     mdd_buf_get_const(env,
+						       spec->u.sp_ea.eadata,
+						       spec->u.sp_ea.eadatalen),
+				     XATTR_NAME_LMV, 0, handle);
+}
+
+/* drop the two links of a shard created in \a handle and destroy it */
+static int mdd_shard_destroy(const struct lu_env *env,
+			     struct mdd_object *shard, int nlink,
+			     struct thandle *handle)
+{
+	int rc = 0;
+
+	mdd_write_lock(env, shard, MOR_TGT_CHILD);
+	while (rc == 0 && nlink-- > 0)
+		rc = mdo_ref_del(env, shard, handle);
+	if (rc == 0)
+		rc = mdo_destroy(env, shard, handle);
+	mdd_write_unlock(env, shard);
+	return rc;
+}
+
+static int mdd_create_stripes(const struct lu_env *env, struct mdd_object *c,
+			      struct mdd_object **shards, int count,
+			      struct lu_attr *attr, struct thandle *handle,
+			      const struct md_op_spec *spec)
+{
+	const struct lu_name	*lname;
+	int			 initialized = 0;
+	int			 rc = 0;
+	int			 i;
+	ENTRY;
+
+	for (i = 0; i < count; i++) {
+		mdd_object_make_hint(env, c, shards[i], attr);
+		lname = mdd_shard_name(env, shards[i], i);
+
+		mdd_write_lock(env, shards[i], MOR_TGT_CHILD);
+		rc = mdd_object_create_internal(env, c, shards[i], attr,
+						handle, spec);
+		if (rc == 0) {
+			rc = mdd_object_initialize(env, mdo2fid(c), lname,
+						   shards[i], attr, handle,
+						   spec, NULL);
+			initialized = rc == 0;
+		}
+		mdd_write_unlock(env, shards[i]);
+		if (rc)
+			GOTO(undo, rc);
+
+		rc = __mdd_index_insert(env, c, mdo2fid(shards[i]),
+					lname->ln_name, 1, handle, BYPASS_CAPA);
+		if (rc)
+			GOTO(undo, rc);
+	}
+
+	mdd_write_lock(env, c, MOR_TGT_CHILD);
+	rc = mdo_xattr_set(env, c,
+			   mdd_buf_get_const(env, spec->u.sp_ea.eadata,
+					     spec->u.sp_ea.eadatalen),
+			   XATTR_NAME_LMV, 0, handle, BYPASS_CAPA);
+	mdd_write_unlock(env, c);
+	if (rc == 0)
+		RETURN(0);
+undo:
+	/* the local shards are destroyed in this transaction, the remote
+	 * ones were created when it started and are destroyed by
+	 * mdd_shards_destroy_remote() once it is stopped */
+	if (i < count && !mdd_object_remote(shards[i]) &&
+	    mdd_object_exists(shards[i]))
+		mdd_shard_destroy(env, shards[i], initialized ? 2 : 1, handle);
+	while (--i >= 0) {
+		lname = mdd_shard_name(env, shards[i], i);
+		__mdd_index_delete(env, c, lname->ln_name, 1, handle,
+				   BYPASS_CAPA);
+		if (!mdd_object_remote(shards[i]))
+			mdd_shard_destroy(env, shards[i], 2, handle);
+	}
+	RETURN(rc);
+}
+
+/**
+ * Destroy the remote shards of a striped mkdir which failed after its
+ * transaction started, see mdd_create_stripes().
+ */
+static void mdd_shards_destroy_remote(const struct lu_env *env,
+				      struct mdd_device *mdd,
+				      struct mdd_object **shards, int count)
+{
+	struct thandle	*handle;
+	int		 rc;
+	int		 i;
+	ENTRY;
+
+	handle = mdd_trans_create(env, mdd);
+	if (IS_ERR(handle))
+		GOTO(out, rc = PTR_ERR(handle));
+
+	for (i = 0; i < count; i++) {
+		if (!mdd_object_remote(shards[i]))
+			continue;
+
+		rc = mdo_declare_ref_del(env, shards[i], handle);
+		if (rc == 0)
+			rc = mdo_declare_ref_del(env, shards[i], handle);
+		if (rc == 0)
+			rc = mdo_declare_destroy(env, shards[i], handle);
+		if (rc != 0)
+			GOTO(stop, rc);
+	}
+
+	rc = mdd_trans_start(env, mdd, handle);
+	if (rc != 0)
+		GOTO(stop, rc);
+
+	for (i = 0; i < count; i++) {
+		if (!mdd_object_remote(shards[i]))
+			continue;
+
+		rc = mdd_shard_destroy(env, shards[i], 2, handle);
+		if (rc != 0)
+			GOTO(stop, rc);
+	}
+	EXIT;
+stop:
+	mdd_trans_stop(env, mdd, rc, handle);
+out:
+	if (rc != 0)
+		CERROR("%s: cannot destroy the remote shards of a failed "
+		       "striped mkdir: rc = %d\n", mdd2obd_dev(mdd)->obd_name,
+		       rc);
+}
+
 /*
  * Create object and insert it into namespace.
  */
@@ -1994,10 +2453,13 @@ static int mdd_create(const struct lu_env *env, struct md_object *pobj,
 	struct lu_buf		acl_buf;
 	struct linkea_data	*ldata = &info->mti_link_data;
 	struct dynlock_handle	*dlh;
+	struct mdd_object	**shards = NULL;
 	const char		*name = lname->ln_name;
 	int			 rc, created = 0, initialized = 0, inserted = 0;
 	int			 got_def_acl = 0;
 	int			 reset_acl = 0;
+	int			 nr_shards = 0;
+	int			 started = 0;
 	ENTRY;
 
         /*
@@ -2055,6 +2517,18 @@ static int mdd_create(const struct lu_env *env, struct md_object *pobj,
 	if (rc < 0)
 		GOTO(out_free, rc);
 
+	if (mdd_create_striped(attr, spec)) {
+		const struct lmv_stripe_md *mea = spec->u.sp_ea.eadata;
+
+		nr_shards = le32_to_cpu(mea->mea_count);
+		shards = mdd_shards_new(env, mdd, mea, nr_shards);
+		if (IS_ERR(shards)) {
+			rc = PTR_ERR(shards);
+			shards = NULL;
+			GOTO(out_free, rc);
+		}
+	}
+
 	mdd_object_make_hint(env, mdd_pobj, son, attr);
 
         handle = mdd_trans_create(env, mdd);
@@ -2069,9 +2543,19 @@ static int mdd_create(const struct lu_env *env, struct md_object *pobj,
         if (rc)
                 GOTO(out_stop, rc);
 
+	if (shards != NULL) {
+		rc = mdd_declare_create_stripes(env, son, shards, nr_shards,
+						attr, handle, spec);
+		if (rc)
+			GOTO(out_stop, rc);
+		/* the hint of the master was replaced by the shards' */
+		mdd_object_make_hint(env, mdd_pobj, son, attr);
+	}
+
         rc = mdd_trans_start(env, mdd, handle);
         if (rc)
                 GOTO(out_stop, rc);
+	started = 1;
 
 	dlh = mdd_pdo_write_lock(env, mdd_pobj, name, MOR_TGT_PARENT);
 	if (dlh == NULL)
@@ -2152,6 +2636,13 @@ static int mdd_create(const struct lu_env *env, struct md_object *pobj,
 
 	initialized = 1;
 
+	if (shards != NULL) {
+		rc = mdd_create_stripes(env, son, shards, nr_shards, attr,
+					handle, spec);
+		if (rc != 0)
+			GOTO(cleanup, rc);
+	}
+
 	if (!(spec->sp_cr_flags & MDS_OPEN_VOLATILE))
 		rc = __mdd_index_insert(env, mdd_pobj, mdo2fid(son),
 					name, S_ISDIR(attr->la_mode), handle,
@@ -2240,11 +2731,16 @@ out_trans:
 			0, son, mdd_pobj, lname, handle);
 out_stop:
         mdd_trans_stop(env, mdd, rc, handle);
+	if (rc != 0 && started != 0 && shards != NULL)
+		mdd_shards_destroy_remote(env, mdd, shards, nr_shards);
 out_free:
 	if (ldata->ld_buf && ldata->ld_buf->lb_len > OBD_ALLOC_BIG)
 		/* if we vmalloced a large buffer drop it */
 		lu_buf_free(ldata->ld_buf);
 
+	if (shards != NULL)
+		mdd_shards_put(env, shards, nr_shards);
+
         /* The child object shouldn't be cached anymore */
         if (rc)
 		set_bit(LU_OBJECT_HEARD_BANSHEE,
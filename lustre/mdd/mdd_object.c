@@ -1786,10 +1786,92 @@ static int mdd_readpage_sanity_check(const struct lu_env *env,
         RETURN(rc);
 }
 
+/* readdir-plus state of mdd_dir_page_build() */
+struct mdd_dir_page_arg {
+	struct mdd_device	*mpa_mdd;
+	/* number of entries left to pack LUDA_ATTRS for */
+	__u32			 mpa_attrs_count;
+};
+
+/**
+ * Readdir-plus: reserve room in \a ent for the attributes, which the MDT
+ * fills once the client is granted the entry lock, and append the LOV EA
+ * of a regular file. \a nob is the room left in the page for \a ent.
+ *
+ * LUDA_ATTRS is cleared if the entry is "." or "..", a remote object, or
+ * if the LOV EA does not fit.
+ */
+static void mdd_dir_page_plus(const struct lu_env *env,
+			      struct mdd_dir_page_arg *mpa,
+			      struct lu_dirent *ent, int nob)
+{
+	struct lu_fid		*fid = &mdd_env_info(env)->mti_fid2;
+	struct lu_buf		*buf = &mdd_env_info(env)->mti_buf;
+	struct mdd_object	*obj;
+	struct luda_attrs	*lda;
+	__u16			 namelen = le16_to_cpu(ent->lde_namelen);
+	__u32			 attrs = le32_to_cpu(ent->lde_attrs) &
+					 ~LUDA_ATTRS;
+	int			 recsize = lu_dirent_calc_size(namelen, attrs);
+	int			 size;
+	int			 rc = 0;
+	ENTRY;
+
+	/* the osd may or may not have accounted LUDA_ATTRS */
+	ent->lde_attrs = cpu_to_le32(attrs);
+	ent->lde_reclen = cpu_to_le16(recsize);
+
+	if (ent->lde_name[0] == '.' &&
+	    (namelen == 1 || (namelen == 2 && ent->lde_name[1] == '.')))
+		RETURN_EXIT;
+
+	fid_le_to_cpu(fid, &ent->lde_fid);
+	obj = mdd_object_find(env, mpa->mpa_mdd, fid);
+	if (IS_ERR(obj))
+		RETURN_EXIT;
+
+	if (!mdd_object_exists(obj) || mdd_object_remote(obj))
+		GOTO(out, rc = -ENOENT);
+
+	lda = (void *)ent + recsize;
+	memset(lda, 0, sizeof(*lda));
+	size = recsize + sizeof(*lda);
+
+	if (S_ISREG(mdd_object_type(obj))) {
+		/* a zero length buffer would query the EA size only */
+		if (nob - size < (int)sizeof(struct lov_mds_md_v1))
+			GOTO(out, rc = -ERANGE);
+
+		buf->lb_buf = lda + 1;
+		buf->lb_len = nob - size;
+
+		rc = mdo_xattr_get(env, obj, buf, XATTR_NAME_LOV, BYPASS_CAPA);
+		if (rc == -ENODATA)
+			rc = 0;
+		if (rc < 0)
+			GOTO(out, rc);
+
+		lda->lda_lmm_size = cpu_to_le32(rc);
+		size += rc;
+	}
+
+	size = (size + 7) & ~7;
+	if (size > nob)
+		GOTO(out, rc = -ERANGE);
+
+	ent->lde_attrs = cpu_to_le32(attrs | LUDA_ATTRS);
+	ent->lde_reclen = cpu_to_le16(size);
+	mpa->mpa_attrs_count--;
+	EXIT;
+out:
+	mdd_object_put(env, obj);
+}
+
 static int mdd_dir_page_build(const struct lu_env *env, union lu_page *lp,
 			      int nob, const struct dt_it_ops *iops,
 			      struct dt_it *it, __u32 attr, void *arg)
 {
+	struct mdd_dir_page_arg	*mpa = arg;
 	struct lu_dirpage	*dp = &lp->lp_dir;
 	void			*area = dp;
 	int			 result;
@@ -1806,6 +1888,7 @@ static int mdd_dir_page_build(const struct lu_env *env, union lu_page *lp,
         do {
                 int    len;
                 int    recsize;
+		__u32  rattr = attr;
 
                 len = iops->key_size(env, it);
 
@@ -1819,16 +1902,22 @@ static int mdd_dir_page_build(const struct lu_env *env, union lu_page *lp,
                         dp->ldp_hash_start = cpu_to_le64(hash);
                 }
 
+		if (mpa->mpa_attrs_count == 0)
+			rattr &= ~LUDA_ATTRS;
+
                 /* calculate max space required for lu_dirent */
-                recsize = lu_dirent_calc_size(len, attr);
+                recsize = lu_dirent_calc_size(len, rattr);
 
                 if (nob >= recsize) {
-                        result = iops->rec(env, it, (struct dt_rec *)ent, attr);
+                        result = iops->rec(env, it, (struct dt_rec *)ent, rattr);
                         if (result == -ESTALE)
                                 goto next;
                         if (result != 0)
                                 goto out;
 
+			if (rattr & LUDA_ATTRS)
+				mdd_dir_page_plus(env, mpa, ent, nob);
+
                         /* osd might not able to pack all attributes,
                          * so recheck rec length */
                         recsize = le16_to_cpu(ent->lde_reclen);
@@ -1865,6 +1954,11 @@ int mdd_readpage(const struct lu_env *env, struct md_object *obj,
                  const struct lu_rdpg *rdpg)
 {
         struct mdd_object *mdd_obj = md2mdd_obj(obj);
+	struct mdd_dir_page_arg mpa = {
+		.mpa_mdd	 = mdo2mdd(obj),
+		.mpa_attrs_count = rdpg->rp_attrs & LUDA_ATTRS ?
+				   rdpg->rp_attrs_count : 0,
+	};
         int rc;
         ENTRY;
 
@@ -1905,7 +1999,7 @@ int mdd_readpage(const struct lu_env *env, struct md_object *obj,
         }
 
 	rc = dt_index_walk(env, mdd_object_child(mdd_obj), rdpg,
-			   mdd_dir_page_build, NULL);
+			   mdd_dir_page_build, &mpa);
 	if (rc >= 0) {
 		struct lu_dirpage	*dp;
 
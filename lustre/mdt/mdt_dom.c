@@ -0,0 +1,362 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 021110-1307, USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ * Use is subject to license terms.
+ *
+ * lustre/mdt/mdt_dom.c
+ *
+ * Data-on-MDT: the body of small regular files with a LOV_PATTERN_MDT
+ * layout is kept in the MDT inode itself and is read and written through
+ * the MDS_READPAGE and MDS_WRITEPAGE RPCs, saving the OST round trips for
+ * files that fit in a single bulk.
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include <obd_class.h>
+#include <lustre_net.h>
+#include "mdt_internal.h"
+
+/**
+ * Return the maximum file size of a Data-on-MDT object \a o (the stripe
+ * size of its layout), or 0 if \a o is not a DoM file.
+ */
+__u32 mdt_dom_stripesize(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct lu_buf		*buf = &info->mti_buf;
+	struct lov_mds_md	*lmm;
+	int			 rc;
+
+	if (!S_ISREG(lu_object_attr(&o->mot_obj.mo_lu)))
+		return 0;
+
+	/* a DoM layout has no stripes and always fits in mti_xattr_buf,
+	 * -ERANGE just means this is a striped file */
+	buf->lb_buf = info->mti_xattr_buf;
+	buf->lb_len = sizeof(info->mti_xattr_buf);
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(o), buf,
+			  XATTR_NAME_LOV);
+	if (rc < (int)sizeof(*lmm))
+		return 0;
+
+	lmm = buf->lb_buf;
+	if (lov_pattern(le32_to_cpu(lmm->lmm_pattern)) != LOV_PATTERN_MDT)
+		return 0;
+
+	return le32_to_cpu(lmm->lmm_stripe_size);
+}
+
+static int mdt_dom_lock(struct mdt_thread_info *info, struct mdt_object *o,
+			struct mdt_lock_handle *lh, ldlm_mode_t mode,
+			__u64 ibits)
+{
+	mdt_lock_reg_init(lh, mode);
+	return mdt_object_lock(info, o, lh, ibits, MDT_LOCAL_LOCK);
+}
+
+/**
+ * Fill \a rdpg with the body of a DoM file starting at rdpg->rp_hash.
+ *
+ * \retval number of bytes read, 0 at or beyond EOF
+ * \retval negative errno on failure
+ */
+int mdt_dom_read(struct mdt_thread_info *info, struct mdt_object *o,
+		 struct lu_rdpg *rdpg)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct mdt_lock_handle	*lh = &info->mti_lh[MDT_LH_CHILD];
+	struct dt_object	*next = mdt_obj2dt(o);
+	struct lu_attr		*la = &info->mti_attr.ma_attr;
+	struct lu_buf		*buf = &info->mti_buf;
+	loff_t			 pos = rdpg->rp_hash;
+	int			 count;
+	int			 nob = 0;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	if (mdt_dom_stripesize(info, o) == 0)
+		RETURN(-EBADF);
+
+	rc = mdt_dom_lock(info, o, lh, LCK_PR, MDS_INODELOCK_DOM);
+	if (rc)
+		RETURN(rc);
+
+	rc = dt_attr_get(env, next, la, BYPASS_CAPA);
+	if (rc)
+		GOTO(unlock, rc);
+
+	if (pos >= la->la_size)
+		GOTO(unlock, rc = 0);
+
+	count = min_t(__u64, rdpg->rp_count, la->la_size - pos);
+	for (i = 0; i < rdpg->rp_npages && nob < count; i++) {
+		buf->lb_buf = kmap(rdpg->rp_pages[i]);
+		buf->lb_len = min_t(int, count - nob, PAGE_CACHE_SIZE);
+		rc = dt_read(env, next, buf, &pos);
+		if (rc >= 0 && rc < PAGE_CACHE_SIZE)
+			/* don't leak stale page contents to the client */
+			memset(buf->lb_buf + rc, 0, PAGE_CACHE_SIZE - rc);
+		kunmap(rdpg->rp_pages[i]);
+		if (rc < 0)
+			GOTO(unlock, rc);
+		nob += rc;
+		if (rc < buf->lb_len)
+			break;
+	}
+	rc = nob;
+	EXIT;
+unlock:
+	mdt_object_unlock(info, o, lh, 1);
+	return rc;
+}
+
+/**
+ * Punch a DoM file body down to \a size after a truncate.
+ */
+int mdt_dom_punch(struct mdt_thread_info *info, struct mdt_object *o,
+		  __u64 size)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct mdt_device	*mdt = info->mti_mdt;
+	struct mdt_lock_handle	*lh = &info->mti_lh[MDT_LH_RMT];
+	struct dt_object	*next = mdt_obj2dt(o);
+	struct thandle		*th;
+	int			 rc;
+	ENTRY;
+
+	rc = mdt_dom_lock(info, o, lh, LCK_PW, MDS_INODELOCK_DOM);
+	if (rc)
+		RETURN(rc);
+
+	th = dt_trans_create(env, mdt->mdt_bottom);
+	if (IS_ERR(th))
+		GOTO(unlock, rc = PTR_ERR(th));
+
+	rc = dt_declare_punch(env, next, size, OBD_OBJECT_EOF, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	rc = dt_trans_start_local(env, mdt->mdt_bottom, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	rc = dt_punch(env, next, size, OBD_OBJECT_EOF, th, BYPASS_CAPA);
+	EXIT;
+stop:
+	dt_trans_stop(env, mdt->mdt_bottom, th);
+unlock:
+	mdt_object_unlock(info, o, lh, 1);
+	return rc;
+}
+
+/* Each DoM write transaction journals the data of at most this many pages,
+ * so that its credits fit in the journal of a small MDT */
+#define MDT_DOM_TXN_PAGES	16
+
+static int mdt_dom_write_chunk(struct mdt_thread_info *info,
+			       struct mdt_object *o, struct page **pages,
+			       int npages, int count, loff_t pos, int sync)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct mdt_device	*mdt = info->mti_mdt;
+	struct dt_object	*next = mdt_obj2dt(o);
+	struct lu_attr		*la = &info->mti_attr.ma_attr;
+	struct lu_buf		*buf = &info->mti_buf;
+	struct thandle		*th;
+	int			 nob = 0;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	la->la_valid = LA_MTIME | LA_CTIME;
+	la->la_mtime = la->la_ctime = cfs_time_current_sec();
+
+	th = dt_trans_create(env, mdt->mdt_bottom);
+	if (IS_ERR(th))
+		RETURN(PTR_ERR(th));
+
+	th->th_sync = sync;
+
+	rc = dt_declare_record_write(env, next, count, pos, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	rc = dt_declare_attr_set(env, next, la, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	rc = dt_trans_start_local(env, mdt->mdt_bottom, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	for (i = 0; i < npages && nob < count; i++) {
+		buf->lb_buf = kmap(pages[i]);
+		buf->lb_len = min_t(int, count - nob, PAGE_CACHE_SIZE);
+		/* charged to quota by the declare above */
+		rc = next->do_body_ops->dbo_write(env, next, buf, &pos, th,
+						  BYPASS_CAPA, 0);
+		kunmap(pages[i]);
+		if (rc >= 0 && rc != buf->lb_len)
+			rc = -EFAULT;
+		if (rc < 0)
+			GOTO(stop, rc);
+		nob += buf->lb_len;
+	}
+
+	rc = dt_attr_set(env, next, la, th, BYPASS_CAPA);
+	EXIT;
+stop:
+	dt_trans_stop(env, mdt->mdt_bottom, th);
+	return rc;
+}
+
+static int mdt_dom_write_pages(struct mdt_thread_info *info,
+			       struct mdt_object *o, struct lu_rdpg *rdpg)
+{
+	loff_t	pos = rdpg->rp_hash;
+	int	count;
+	int	nob = 0;
+	int	i;
+	int	rc = 0;
+
+	for (i = 0; i < rdpg->rp_npages && rc == 0;
+	     i += MDT_DOM_TXN_PAGES) {
+		count = min_t(int, rdpg->rp_count - nob,
+			      MDT_DOM_TXN_PAGES << PAGE_CACHE_SHIFT);
+		/* DoM writes are not replayed, so they must be on disk before
+		 * the client sees the reply, like O_DIRECT writes to an OST:
+		 * the sync of the last transaction commits the others too */
+		rc = mdt_dom_write_chunk(info, o, rdpg->rp_pages + i,
+					 min_t(int, rdpg->rp_npages - i,
+					       MDT_DOM_TXN_PAGES),
+					 count, pos + nob,
+					 nob + count == rdpg->rp_count);
+		nob += count;
+	}
+	return rc;
+}
+
+/**
+ * Handler for MDS_WRITEPAGE: write the bulk into the body of a DoM file.
+ *
+ * As for MDS_READPAGE, reqbody->size holds the file offset and
+ * reqbody->nlink the number of bytes, the bulk pages are filled from
+ * offset 0. The new file size is returned in the reply body.
+ */
+int mdt_writepage(struct mdt_thread_info *info)
+{
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct mdt_object	*o = info->mti_object;
+	struct lu_rdpg		*rdpg = &info->mti_u.rdpg.mti_rdpg;
+	struct l_wait_info	*lwi = &info->mti_u.rdpg.mti_wait_info;
+	struct mdt_lock_handle	*lh = &info->mti_lh[MDT_LH_CHILD];
+	struct ptlrpc_bulk_desc	*desc = NULL;
+	struct lu_attr		*la = &info->mti_attr.ma_attr;
+	struct mdt_body		*reqbody;
+	struct mdt_body		*repbody;
+	__u32			 maxsize;
+	int			 nob;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	reqbody = req_capsule_client_get(info->mti_pill, &RMF_MDT_BODY);
+	repbody = req_capsule_server_get(info->mti_pill, &RMF_MDT_BODY);
+	if (reqbody == NULL || repbody == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	maxsize = mdt_dom_stripesize(info, o);
+	if (maxsize == 0)
+		RETURN(-EBADF);
+
+	rdpg->rp_hash = reqbody->size;
+	rdpg->rp_count = reqbody->nlink;
+	if (rdpg->rp_count == 0 ||
+	    rdpg->rp_count > exp_max_brw_size(info->mti_exp))
+		RETURN(-EINVAL);
+	if (rdpg->rp_hash + rdpg->rp_count > maxsize)
+		RETURN(-EFBIG);
+
+	rdpg->rp_npages = (rdpg->rp_count + PAGE_CACHE_SIZE - 1) >>
+			  PAGE_CACHE_SHIFT;
+	OBD_ALLOC(rdpg->rp_pages, rdpg->rp_npages * sizeof(rdpg->rp_pages[0]));
+	if (rdpg->rp_pages == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < rdpg->rp_npages; i++) {
+		rdpg->rp_pages[i] = alloc_page(GFP_IOFS);
+		if (rdpg->rp_pages[i] == NULL)
+			GOTO(free_rdpg, rc = -ENOMEM);
+	}
+
+	desc = ptlrpc_prep_bulk_exp(req, rdpg->rp_npages, 1, BULK_GET_SINK,
+				    MDS_BULK_PORTAL);
+	if (desc == NULL)
+		GOTO(free_rdpg, rc = -ENOMEM);
+
+	for (i = 0, nob = rdpg->rp_count; i < rdpg->rp_npages; i++) {
+		ptlrpc_prep_bulk_page_pin(desc, rdpg->rp_pages[i], 0,
+					  min_t(int, nob, PAGE_CACHE_SIZE));
+		nob -= PAGE_CACHE_SIZE;
+	}
+
+	rc = sptlrpc_svc_prep_bulk(req, desc);
+	if (rc)
+		GOTO(free_desc, rc);
+
+	rc = target_bulk_io(req->rq_export, desc, lwi);
+	if (rc)
+		GOTO(free_desc, rc);
+
+	/* revoke the client UPDATE locks so that cached sizes and times are
+	 * refreshed from the MDT on the next stat */
+	rc = mdt_dom_lock(info, o, lh, LCK_PW,
+			  MDS_INODELOCK_DOM | MDS_INODELOCK_UPDATE);
+	if (rc)
+		GOTO(free_desc, rc);
+
+	rc = mdt_dom_write_pages(info, o, rdpg);
+	if (rc == 0)
+		rc = dt_attr_get(info->mti_env, mdt_obj2dt(o), la,
+				 BYPASS_CAPA);
+	if (rc == 0) {
+		repbody->size = la->la_size;
+		repbody->blocks = la->la_blocks;
+		repbody->mtime = la->la_mtime;
+		repbody->ctime = la->la_ctime;
+		repbody->valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS |
+				  OBD_MD_FLMTIME | OBD_MD_FLCTIME;
+	}
+	mdt_object_unlock(info, o, lh, 1);
+	EXIT;
+free_desc:
+	ptlrpc_free_bulk_pin(desc);
+free_rdpg:
+	for (i = 0; i < rdpg->rp_npages; i++)
+		if (rdpg->rp_pages[i] != NULL)
+			__free_page(rdpg->rp_pages[i]);
+	OBD_FREE(rdpg->rp_pages, rdpg->rp_npages * sizeof(rdpg->rp_pages[0]));
+	return rc;
+}
@@ -287,8 +287,12 @@ int mdt_statfs(struct mdt_thread_info *info)
 {
 	struct ptlrpc_request		*req = mdt_info_req(info);
 	struct md_device		*next = info->mti_mdt->mdt_child;
+	struct mdt_device		*mdt = info->mti_mdt;
 	struct ptlrpc_service_part	*svcpt;
 	struct obd_statfs		*osfs;
+	__u64				 now;
+	__u64				 reqs;
+	__u64				 rate;
 	int				rc;
 
 	ENTRY;
@@ -312,21 +316,35 @@ int mdt_statfs(struct mdt_thread_info *info)
 		RETURN(-EPROTO);
 
 	/** statfs information are cached in the mdt_device */
-	if (cfs_time_before_64(info->mti_mdt->mdt_osfs_age,
+	if (cfs_time_before_64(mdt->mdt_osfs_age,
 			       cfs_time_shift_64(-OBD_STATFS_CACHE_SECONDS))) {
 		/** statfs data is too old, get up-to-date one */
 		rc = next->md_ops->mdo_statfs(info->mti_env, next, osfs);
 		if (rc)
 			RETURN(rc);
-		spin_lock(&info->mti_mdt->mdt_osfs_lock);
-		info->mti_mdt->mdt_osfs = *osfs;
-		info->mti_mdt->mdt_osfs_age = cfs_time_current_64();
-		spin_unlock(&info->mti_mdt->mdt_osfs_lock);
+		/* the load of this MDT since the last refresh, which LMV
+		 * weighs in its QOS placement of new directories */
+		now = cfs_time_current_64();
+		reqs = mdt_counter_sum(mdt);
+		spin_lock(&mdt->mdt_osfs_lock);
+		osfs->os_req_rate = 0;
+		/* an MDT idle for more than 2^32 ticks has no load anyway */
+		if (mdt->mdt_osfs_age != 0 && now > mdt->mdt_osfs_age &&
+		    now - mdt->mdt_osfs_age <= ~0U &&
+		    reqs >= mdt->mdt_osfs_reqs) {
+			rate = (reqs - mdt->mdt_osfs_reqs) * CFS_HZ;
+			do_div(rate, (__u32)(now - mdt->mdt_osfs_age));
+			osfs->os_req_rate = min_t(__u64, ~0U, rate);
+		}
+		mdt->mdt_osfs = *osfs;
+		mdt->mdt_osfs_age = now;
+		mdt->mdt_osfs_reqs = reqs;
+		spin_unlock(&mdt->mdt_osfs_lock);
 	} else {
 		/** use cached statfs data */
-		spin_lock(&info->mti_mdt->mdt_osfs_lock);
-		*osfs = info->mti_mdt->mdt_osfs;
-		spin_unlock(&info->mti_mdt->mdt_osfs_lock);
+		spin_lock(&mdt->mdt_osfs_lock);
+		*osfs = mdt->mdt_osfs;
+		spin_unlock(&mdt->mdt_osfs_lock);
 	}
 
 	if (rc == 0)
@@ -389,6 +407,11 @@ void mdt_pack_attr2body(struct mdt_thread_info *info, struct mdt_body *b,
 
         if (!S_ISREG(attr->la_mode)) {
                 b->valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS | OBD_MD_FLRDEV;
+	} else if (ma->ma_valid & MA_LOV && ma->ma_lmm != NULL &&
+		   lov_pattern(le32_to_cpu(ma->ma_lmm->lmm_pattern)) ==
+		   LOV_PATTERN_MDT) {
+		/* Data-on-MDT file, the MDT inode holds the data */
+		b->valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
 	} else if (ma->ma_need & MA_LOV && !(ma->ma_valid & MA_LOV)) {
                 /* means no objects are allocated on osts. */
                 LASSERT(!(ma->ma_valid & MA_LOV));
@@ -765,6 +788,9 @@ static int mdt_getattr_internal(struct mdt_thread_info *info,
         else
                 RETURN(-EFAULT);
 
+	if (reqbody->valid & OBD_MD_FLLAZYSIZE)
+		mdt_lsom_pack(info, o, repbody);
+
         if (mdt_body_has_lov(la, reqbody)) {
                 if (ma->ma_valid & MA_LOV) {
                         LASSERT(ma->ma_lmm_size);
@@ -1068,6 +1094,11 @@ int mdt_swap_layouts(struct mdt_thread_info *info)
 	if (rc < 0)
 		swap(o1, o2);
 
+	/* the body of a Data-on-MDT file can't move with its layout */
+	if (mdt_dom_stripesize(info, o1) != 0 ||
+	    mdt_dom_stripesize(info, o2) != 0)
+		GOTO(put, rc = -EOPNOTSUPP);
+
 	/* permission check. Make sure the calling process having permission
 	 * to write both files. */
 	rc = mo_permission(info->mti_env, NULL, mdt_object_child(o1), NULL,
@@ -1644,6 +1675,168 @@ static int mdt_sendpage(struct mdt_thread_info *info,
         RETURN(rc);
 }
 
+/**
+ * Number of entries to pack readdir-plus attributes for: one per lock handle
+ * supplied by the client.
+ */
+static __u32 mdt_readdir_plus_count(struct mdt_thread_info *info)
+{
+	struct req_capsule *pill = info->mti_pill;
+
+	if (!(exp_connect_flags(info->mti_exp) & OBD_CONNECT_READDIR_PLUS) ||
+	    exp_connect_rmtclient(info->mti_exp) ||
+	    !req_capsule_field_present(pill, &RMF_DLM_HANDLES, RCL_CLIENT))
+		return 0;
+
+	return req_capsule_get_size(pill, &RMF_DLM_HANDLES, RCL_CLIENT) /
+	       sizeof(struct lustre_handle);
+}
+
+/**
+ * Grant the client a PR LOOKUP|UPDATE lock on the entry \a ent with the
+ * lock handle \a remote the client supplied, then fill the readdir-plus
+ * attributes \a lda of the entry, now protected by that lock.
+ */
+static int mdt_readdir_plus_entry(struct mdt_thread_info *info,
+				  struct lu_dirent *ent, struct luda_attrs *lda,
+				  const struct lustre_handle *remote, __u32 idx)
+{
+	struct mdt_device	*mdt = info->mti_mdt;
+	struct lu_fid		*fid = &info->mti_tmp_fid1;
+	struct md_attr		*ma = &info->mti_attr;
+	struct lu_attr		*la = &ma->ma_attr;
+	struct lov_mds_md	*lmm = (struct lov_mds_md *)(lda + 1);
+	struct mdt_object	*o;
+	struct ldlm_lock	*lock;
+	struct lustre_handle	 lockh;
+	__u64			 valid;
+	int			 rc;
+	ENTRY;
+
+	fid_le_to_cpu(fid, &ent->lde_fid);
+	o = mdt_object_find(info->mti_env, mdt, fid);
+	if (IS_ERR(o))
+		RETURN(PTR_ERR(o));
+
+	if (!mdt_object_exists(o) || mdt_object_remote(o))
+		GOTO(out, rc = -ENOENT);
+
+#ifdef CONFIG_FS_POSIX_ACL
+	/* the ACL does not fit into the entry, leave it to getattr */
+	if (exp_connect_flags(info->mti_exp) & OBD_CONNECT_ACL) {
+		rc = mo_xattr_get(info->mti_env, mdt_object_child(o),
+				  &LU_BUF_NULL, XATTR_NAME_ACL_ACCESS);
+		if (rc != -ENODATA && rc != -EOPNOTSUPP)
+			GOTO(out, rc = rc < 0 ? rc : -EEXIST);
+	}
+#endif
+
+	fid_build_reg_res_name(fid, &info->mti_res_id);
+	info->mti_policy.l_inodebits.bits = MDS_INODELOCK_LOOKUP |
+					    MDS_INODELOCK_UPDATE;
+	rc = ldlm_lock_grant_remote(mdt->mdt_namespace, info->mti_exp,
+				    &info->mti_res_id, LDLM_IBITS,
+				    &info->mti_policy, LCK_PR, remote, &lockh);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	ma->ma_need = MA_INODE;
+	ma->ma_valid = 0;
+	rc = mo_attr_get(info->mti_env, mdt_object_child(o), ma);
+	if (rc != 0) {
+		/* the client drops its lock as the entry has no attributes */
+		lock = ldlm_handle2lock(&lockh);
+		if (lock != NULL) {
+			ldlm_lock_cancel(lock);
+			LDLM_LOCK_PUT(lock);
+		}
+		GOTO(out, rc);
+	}
+
+	valid = OBD_MD_FLCTIME | OBD_MD_FLUID | OBD_MD_FLGID | OBD_MD_FLTYPE |
+		OBD_MD_FLMODE | OBD_MD_FLNLINK | OBD_MD_FLFLAGS |
+		OBD_MD_FLATIME | OBD_MD_FLMTIME;
+	/* see mdt_pack_attr2body() */
+	if (!S_ISREG(la->la_mode)) {
+		valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS | OBD_MD_FLRDEV;
+	} else if (lda->lda_lmm_size == 0) {
+		/* no objects are allocated on osts, the MDT size is valid */
+		la->la_blocks = 0;
+		valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
+	} else if (lov_pattern(le32_to_cpu(lmm->lmm_pattern)) ==
+		   LOV_PATTERN_MDT) {
+		valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
+	}
+
+	lda->lda_cookie = cpu_to_le64(lockh.cookie);
+	lda->lda_valid = cpu_to_le64(valid);
+	lda->lda_size = cpu_to_le64(la->la_size);
+	lda->lda_blocks = cpu_to_le64(la->la_blocks);
+	lda->lda_mtime = cpu_to_le64(la->la_mtime);
+	lda->lda_atime = cpu_to_le64(la->la_atime);
+	lda->lda_ctime = cpu_to_le64(la->la_ctime);
+	lda->lda_mode = cpu_to_le32(la->la_mode);
+	lda->lda_uid = cpu_to_le32(la->la_uid);
+	lda->lda_gid = cpu_to_le32(la->la_gid);
+	lda->lda_flags = cpu_to_le32(la->la_flags);
+	lda->lda_nlink = cpu_to_le32(la->la_nlink);
+	lda->lda_rdev = cpu_to_le32(la->la_rdev);
+	lda->lda_lock_idx = cpu_to_le32(idx);
+	EXIT;
+out:
+	mdt_object_put(info->mti_env, o);
+	return rc;
+}
+
+/**
+ * Readdir-plus: the lower layers packed room for the attributes of the
+ * first rdpg->rp_attrs_count entries at most, grant the lock and fill the
+ * attributes of each of them, using the client lock handles in order.
+ */
+static void mdt_readdir_plus(struct mdt_thread_info *info,
+			     struct lu_rdpg *rdpg, int nob)
+{
+	const struct lustre_handle	*handles;
+	__u32				 idx = 0;
+	int				 granted = 0;
+	int				 i;
+	ENTRY;
+
+	handles = req_capsule_client_get(info->mti_pill, &RMF_DLM_HANDLES);
+	LASSERT(handles != NULL);
+
+	for (i = 0; i < rdpg->rp_npages && nob > 0; i++) {
+		union lu_page	*lp = kmap(rdpg->rp_pages[i]);
+		int		 j;
+
+		for (j = 0; j < LU_PAGE_COUNT && nob > 0;
+		     j++, lp++, nob -= LU_PAGE_SIZE) {
+			struct lu_dirent	*ent;
+			struct luda_attrs	*lda;
+
+			for (ent = lu_dirent_start(&lp->lp_dir); ent != NULL;
+			     ent = lu_dirent_next(ent)) {
+				lda = lu_dirent_attrs(ent);
+				if (lda == NULL)
+					continue;
+
+				LASSERT(idx < rdpg->rp_attrs_count);
+				if (mdt_readdir_plus_entry(info, ent, lda,
+							   &handles[idx],
+							   idx) == 0)
+					granted++;
+				idx++;
+			}
+		}
+		kunmap(rdpg->rp_pages[i]);
+	}
+
+	CDEBUG(D_INODE, "%s: readdir-plus "DFID" granted %d/%u locks\n",
+	       mdt_obd_name(info->mti_mdt),
+	       PFID(mdt_object_fid(info->mti_object)), granted, idx);
+	EXIT;
+}
+
 int mdt_readpage(struct mdt_thread_info *info)
 {
         struct mdt_object *object = info->mti_object;
@@ -1677,6 +1870,12 @@ int mdt_readpage(struct mdt_thread_info *info)
         rdpg->rp_attrs = reqbody->mode;
 	if (exp_connect_flags(info->mti_exp) & OBD_CONNECT_64BITHASH)
 		rdpg->rp_attrs |= LUDA_64BITHASH;
+	rdpg->rp_attrs_count = 0;
+	if (rdpg->rp_attrs & LUDA_ATTRS) {
+		rdpg->rp_attrs_count = mdt_readdir_plus_count(info);
+		if (rdpg->rp_attrs_count == 0)
+			rdpg->rp_attrs &= ~LUDA_ATTRS;
+	}
 	rdpg->rp_count  = min_t(unsigned int, reqbody->nlink,
 				exp_max_brw_size(info->mti_exp));
 	rdpg->rp_npages = (rdpg->rp_count + PAGE_CACHE_SIZE - 1) >>
@@ -1691,10 +1890,24 @@ int mdt_readpage(struct mdt_thread_info *info)
                         GOTO(free_rdpg, rc = -ENOMEM);
         }
 
-        /* call lower layers to fill allocated pages with directory data */
-        rc = mo_readpage(info->mti_env, mdt_object_child(object), rdpg);
-        if (rc < 0)
-                GOTO(free_rdpg, rc);
+	if (S_ISREG(lu_object_attr(&object->mot_obj.mo_lu))) {
+		/* Data-on-MDT file body */
+		rc = mdt_dom_read(info, object, rdpg);
+		if (rc == 0) /* nothing to send at or beyond EOF */
+			rc = -ENODATA;
+		if (rc < 0)
+			GOTO(free_rdpg, rc);
+	} else {
+		/* call lower layers to fill allocated pages with directory
+		 * data */
+		rc = mo_readpage(info->mti_env, mdt_object_child(object),
+				 rdpg);
+		if (rc < 0)
+			GOTO(free_rdpg, rc);
+
+		if (rdpg->rp_attrs & LUDA_ATTRS)
+			mdt_readdir_plus(info, rdpg, rc);
+	}
 
         /* send pages to client */
         rc = mdt_sendpage(info, rdpg, rc);
@@ -1820,7 +2033,8 @@ int mdt_reint(struct mdt_thread_info *info)
 		[REINT_RENAME]   = &RQF_MDS_REINT_RENAME,
 		[REINT_OPEN]     = &RQF_MDS_REINT_OPEN,
 		[REINT_SETXATTR] = &RQF_MDS_REINT_SETXATTR,
-		[REINT_RMENTRY] = &RQF_MDS_REINT_UNLINK
+		[REINT_RMENTRY] = &RQF_MDS_REINT_UNLINK,
+		[REINT_UNLINK_BATCH] = &RQF_MDS_REINT_UNLINK_BATCH
 	};
 
         ENTRY;
@@ -4709,6 +4923,7 @@ static int mdt_init0(const struct lu_env *env, struct mdt_device *m,
         m->mdt_max_mdsize = MAX_MD_SIZE; /* 4 stripes */
 
         m->mdt_som_conf = 0;
+	m->mdt_lazy_size = 1;
 
         m->mdt_opts.mo_cos = MDT_COS_DEFAULT;
 	lmi = server_get_mount(dev);
@@ -154,6 +154,8 @@ struct mdt_device {
         struct lustre_capa_key     mdt_capa_keys[2];
 	unsigned int               mdt_capa_conf:1,
 				   mdt_som_conf:1,
+				   /* lazy size-on-MDT in trusted.lsom */
+				   mdt_lazy_size:1,
 				   /* Enable remote dir on non-MDT0 */
 				   mdt_enable_remote_dir:1;
 
@@ -161,6 +163,8 @@ struct mdt_device {
 	/* statfs optimization: we cache a bit  */
 	struct obd_statfs	   mdt_osfs;
 	__u64			   mdt_osfs_age;
+	/* md_stats requests handled as of mdt_osfs_age, for os_req_rate */
+	__u64			   mdt_osfs_reqs;
 	spinlock_t		   mdt_osfs_lock;
 
         /* root squash */
@@ -261,6 +265,7 @@ struct mdt_reint_record {
         const struct lu_fid    *rr_fid2;
         const char             *rr_name;
         int                     rr_namelen;
+	int			rr_namecount;
         const char             *rr_tgt;
         int                     rr_tgtlen;
         const void             *rr_eadata;
@@ -859,6 +864,21 @@ int mdt_hsm_ct_register(struct mdt_thread_info *info);
 int mdt_hsm_ct_unregister(struct mdt_thread_info *info);
 int mdt_hsm_request(struct mdt_thread_info *info);
 
+/* mdt/mdt_dom.c */
+__u32 mdt_dom_stripesize(struct mdt_thread_info *info, struct mdt_object *o);
+int mdt_dom_read(struct mdt_thread_info *info, struct mdt_object *o,
+		 struct lu_rdpg *rdpg);
+int mdt_dom_punch(struct mdt_thread_info *info, struct mdt_object *o,
+		  __u64 size);
+int mdt_writepage(struct mdt_thread_info *info);
+
+/* mdt/mdt_lsom.c */
+void mdt_lsom_pack(struct mdt_thread_info *info, struct mdt_object *o,
+		   struct mdt_body *repbody);
+void mdt_lsom_close(struct mdt_thread_info *info, struct mdt_object *o);
+void mdt_lsom_truncate(struct mdt_thread_info *info, struct mdt_object *o);
+int mdt_lsom_sync(struct mdt_thread_info *info);
+
 extern struct lu_context_key       mdt_thread_key;
 /* debug issues helper starts here*/
 static inline int mdt_fail_write(const struct lu_env *env,
@@ -1006,6 +1026,7 @@ enum {
         LPROC_MDT_LAST,
 };
 void mdt_counter_incr(struct ptlrpc_request *req, int opcode);
+__u64 mdt_counter_sum(struct mdt_device *mdt);
 void mdt_stats_counter_init(struct lprocfs_stats *stats);
 void lprocfs_mdt_init_vars(struct lprocfs_static_vars *lvars);
 void lprocfs_mds_init_vars(struct lprocfs_static_vars *lvars);
@@ -890,6 +890,46 @@ int mdt_close_unpack(struct mdt_thread_info *info)
 	RETURN(mdt_init_ucred_reint(info));
 }
 
+/**
+ * Take the stripe EA the client built for a striped mkdir, see
+ * lmv_create(). Any other data sent with mkdir is the lmv_user_md of a
+ * remote directory, which the MDT does not need.
+ */
+static int mdt_create_stripes_unpack(struct mdt_thread_info *info)
+{
+	struct req_capsule	*pill = info->mti_pill;
+	struct md_op_spec	*sp = &info->mti_spec;
+	struct lmv_stripe_md	*mea;
+	struct lu_fid		 fid;
+	int			 size;
+	__u32			 count;
+	int			 i;
+
+	size = req_capsule_get_size(pill, &RMF_EADATA, RCL_CLIENT);
+	if (size < sizeof(*mea))
+		return 0;
+
+	mea = req_capsule_client_get(pill, &RMF_EADATA);
+	if (le32_to_cpu(mea->mea_magic) != MEA_MAGIC_ALL_CHARS)
+		return 0;
+
+	count = le32_to_cpu(mea->mea_count);
+	if (count < 2 ||
+	    count != (size - sizeof(*mea)) / sizeof(mea->mea_ids[0]) ||
+	    size != lmv_stripe_md_size(count))
+		return -EPROTO;
+
+	for (i = 0; i < count; i++) {
+		fid_le_to_cpu(&fid, &mea->mea_ids[i]);
+		if (!fid_is_sane(&fid))
+			return -EPROTO;
+	}
+
+	sp->u.sp_ea.eadata = mea;
+	sp->u.sp_ea.eadatalen = size;
+	return 0;
+}
+
 static int mdt_create_unpack(struct mdt_thread_info *info)
 {
 	struct lu_ucred         *uc  = mdt_ucred(info);
@@ -950,6 +990,11 @@ static int mdt_create_unpack(struct mdt_thread_info *info)
                         RETURN(-EFAULT);
         } else {
                 req_capsule_extend(pill, &RQF_MDS_REINT_CREATE_RMT_ACL);
+		if (S_ISDIR(attr->la_mode)) {
+			rc = mdt_create_stripes_unpack(info);
+			if (rc != 0)
+				RETURN(rc);
+		}
         }
 
         rc = mdt_dlmreq_unpack(info);
@@ -1004,7 +1049,7 @@ static int mdt_link_unpack(struct mdt_thread_info *info)
         RETURN(rc);
 }
 
-static int mdt_unlink_unpack(struct mdt_thread_info *info)
+static int mdt_unlink_common_unpack(struct mdt_thread_info *info)
 {
 	struct lu_ucred         *uc  = mdt_ucred(info);
         struct mdt_rec_unlink   *rec;
@@ -1040,11 +1085,6 @@ static int mdt_unlink_unpack(struct mdt_thread_info *info)
                 mdt_set_capainfo(info, 0, rr->rr_fid1,
                                  req_capsule_client_get(pill, &RMF_CAPA1));
 
-	rr->rr_name = req_capsule_client_get(pill, &RMF_NAME);
-	rr->rr_namelen = req_capsule_get_size(pill, &RMF_NAME, RCL_CLIENT) - 1;
-	if (rr->rr_name == NULL || rr->rr_namelen == 0)
-		RETURN(-EFAULT);
-
         if (rec->ul_bias & MDS_VTX_BYPASS)
                 ma->ma_attr_flags |= MDS_VTX_BYPASS;
         else
@@ -1056,12 +1096,58 @@ static int mdt_unlink_unpack(struct mdt_thread_info *info)
         RETURN(rc);
 }
 
+static int mdt_unlink_unpack(struct mdt_thread_info *info)
+{
+	struct mdt_reint_record	*rr = &info->mti_rr;
+	struct req_capsule	*pill = info->mti_pill;
+
+	rr->rr_name = req_capsule_client_get(pill, &RMF_NAME);
+	rr->rr_namelen = req_capsule_get_size(pill, &RMF_NAME, RCL_CLIENT) - 1;
+	if (rr->rr_name == NULL || rr->rr_namelen == 0)
+		return -EFAULT;
+
+	return mdt_unlink_common_unpack(info);
+}
+
 static int mdt_rmentry_unpack(struct mdt_thread_info *info)
 {
 	info->mti_spec.sp_rm_entry = 1;
 	return mdt_unlink_unpack(info);
 }
 
+/**
+ * Unpack REINT_UNLINK_BATCH, whose names are packed one after the other in
+ * RMF_NAMES, and size the RMF_RCS reply buffer for their results.
+ */
+static int mdt_unlink_batch_unpack(struct mdt_thread_info *info)
+{
+	struct mdt_reint_record	*rr = &info->mti_rr;
+	struct req_capsule	*pill = info->mti_pill;
+	const char		*name;
+	const char		*end;
+	int			 rc;
+	ENTRY;
+
+	rr->rr_name = req_capsule_client_get(pill, &RMF_NAMES);
+	rr->rr_namelen = req_capsule_get_size(pill, &RMF_NAMES, RCL_CLIENT);
+	if (rr->rr_name == NULL || rr->rr_namelen == 0 ||
+	    rr->rr_namelen > MDS_UNLINK_BATCH_SIZE ||
+	    rr->rr_name[rr->rr_namelen - 1] != '\0')
+		RETURN(-EFAULT);
+
+	end = rr->rr_name + rr->rr_namelen;
+	for (name = rr->rr_name; name < end; name += strlen(name) + 1) {
+		if (*name == '\0' || ++rr->rr_namecount > MDS_UNLINK_BATCH_MAX)
+			RETURN(-EFAULT);
+	}
+
+	req_capsule_set_size(pill, &RMF_RCS, RCL_SERVER,
+			     rr->rr_namecount * sizeof(__u32));
+
+	rc = mdt_unlink_common_unpack(info);
+	RETURN(rc);
+}
+
 static int mdt_rename_unpack(struct mdt_thread_info *info)
 {
 	struct lu_ucred         *uc = mdt_ucred(info);
@@ -1312,6 +1398,7 @@ static reint_unpacker mdt_reint_unpackers[REINT_MAX] = {
 	[REINT_OPEN]     = mdt_open_unpack,
 	[REINT_SETXATTR] = mdt_setxattr_unpack,
 	[REINT_RMENTRY]  = mdt_rmentry_unpack,
+	[REINT_UNLINK_BATCH] = mdt_unlink_batch_unpack,
 };
 
 int mdt_reint_unpack(struct mdt_thread_info *info, __u32 op)
@@ -997,6 +997,34 @@ static int lprocfs_wr_enable_remote_dir_gid(struct file *file,
 	return count;
 }
 
+static int lprocfs_rd_lazy_size(char *page, char **start, off_t off,
+				int count, int *eof, void *data)
+{
+	struct obd_device *obd = data;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return snprintf(page, count, "%u\n", mdt->mdt_lazy_size);
+}
+
+static int lprocfs_wr_lazy_size(struct file *file, const char *buffer,
+				unsigned long count, void *data)
+{
+	struct obd_device *obd = data;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	__u32 val;
+	int rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val > 1)
+		return -ERANGE;
+
+	mdt->mdt_lazy_size = val;
+	return count;
+}
+
 static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
         { "uuid",                       lprocfs_rd_uuid,                 0, 0 },
         { "recovery_status",            lprocfs_obd_rd_recovery_status,  0, 0 },
@@ -1038,6 +1066,8 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
 					lprocfs_wr_enable_remote_dir,	    0},
 	{ "enable_remote_dir_gid",	lprocfs_rd_enable_remote_dir_gid,
 					lprocfs_wr_enable_remote_dir_gid,   0},
+	{ "lazy_size",			lprocfs_rd_lazy_size,
+					lprocfs_wr_lazy_size,		    0},
 	{ 0 }
 };
 
@@ -1077,6 +1107,25 @@ void mdt_counter_incr(struct ptlrpc_request *req, int opcode)
 				      opcode, 1);
 }
 
+/**
+ * Number of requests counted in md_stats since the MDT was set up, which
+ * mdt_statfs() turns into the request rate reported to the clients.
+ */
+__u64 mdt_counter_sum(struct mdt_device *mdt)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	__u64			 sum = 0;
+	int			 i;
+
+	if (obd->md_stats == NULL)
+		return 0;
+
+	for (i = 0; i < LPROC_MDT_LAST; i++)
+		sum += lprocfs_stats_collector(obd->md_stats, i,
+					       LPROCFS_FIELDS_FLAGS_COUNT);
+	return sum;
+}
+
 void mdt_stats_counter_init(struct lprocfs_stats *stats)
 {
         lprocfs_counter_init(stats, LPROC_MDT_OPEN, 0, "open", "reqs");
@@ -0,0 +1,218 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 021110-1307, USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ * Use is subject to license terms.
+ *
+ * lustre/mdt/mdt_lsom.c
+ *
+ * Lazy size-on-MDT: the size and blocks of a striped file are kept in the
+ * trusted.lsom xattr of its MDT inode, updated when a writer closes the
+ * file and by "lfs som_sync". Clients mounted with -o lazy_size return them
+ * from stat instead of glimpsing every stripe, accepting that they may lag
+ * behind the OST objects while the file is being written.
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include <obd_class.h>
+#include "mdt_internal.h"
+
+/**
+ * Read the lazy SOM attributes of \a o into \a lsa.
+ *
+ * \retval -ENODATA	\a o has none
+ */
+static int mdt_lsom_get(struct mdt_thread_info *info, struct mdt_object *o,
+			struct lsom_attrs *lsa)
+{
+	struct lu_buf	buf;
+	int		rc;
+
+	/* not mti_buf, which getattr may still be using for the reply */
+	CLASSERT(sizeof(info->mti_xattr_buf) >= sizeof(*lsa));
+	buf.lb_buf = info->mti_xattr_buf;
+	buf.lb_len = sizeof(info->mti_xattr_buf);
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(o), &buf,
+			  XATTR_NAME_LSOM);
+	if (rc < 0)
+		return rc;
+	if (rc != sizeof(*lsa))
+		return -ENODATA;
+
+	memcpy(lsa, info->mti_xattr_buf, sizeof(*lsa));
+	lustre_lsom_swab(lsa);
+	return 0;
+}
+
+/**
+ * Store \a size and \a blocks as the lazy SOM attributes of \a o, stale if
+ * the file is still open for write.
+ */
+static int mdt_lsom_set(struct mdt_thread_info *info, struct mdt_object *o,
+			__u64 size, __u64 blocks, __u32 flags)
+{
+	struct lu_ucred		*uc = mdt_ucred(info);
+	struct lu_buf		*buf = &info->mti_buf;
+	struct lsom_attrs	*lsa;
+	cfs_cap_t		 cap;
+	int			 rc;
+	ENTRY;
+
+	if (mdt_write_read(o) > 0)
+		flags |= LSOM_FL_STALE;
+
+	lsa = (struct lsom_attrs *)info->mti_xattr_buf;
+	memset(lsa, 0, sizeof(*lsa));
+	lsa->lsa_flags = flags;
+	lsa->lsa_size = size;
+	lsa->lsa_blocks = blocks;
+	lsa->lsa_time = cfs_time_current_sec();
+	lustre_lsom_swab(lsa);
+
+	buf->lb_buf = lsa;
+	buf->lb_len = sizeof(*lsa);
+
+	/* this is not a change of the file by the user, who may be a writer
+	 * that does not own it */
+	cap = uc->uc_cap;
+	uc->uc_cap |= 1 << CFS_CAP_FOWNER;
+	rc = mo_xattr_set(info->mti_env, mdt_object_child(o), buf,
+			  XATTR_NAME_LSOM, 0);
+	uc->uc_cap = cap;
+
+	CDEBUG(D_INODE, "%s: lazy size "LPU64", blocks "LPU64", flags %#x of "
+	       DFID": rc = %d\n", mdt_obd_name(info->mti_mdt), size, blocks,
+	       flags, PFID(mdt_object_fid(o)), rc);
+	RETURN(rc);
+}
+
+/**
+ * Pack the lazy size of \a o into \a repbody for a client that asked for
+ * it with OBD_MD_FLLAZYSIZE. A zero lazytime tells the client there is no
+ * usable one and it has to glimpse the OSTs.
+ */
+void mdt_lsom_pack(struct mdt_thread_info *info, struct mdt_object *o,
+		   struct mdt_body *repbody)
+{
+	struct md_attr		*ma = &info->mti_attr;
+	struct lsom_attrs	 lsa;
+
+	if (!S_ISREG(ma->ma_attr.la_mode) ||
+	    !(exp_connect_flags(info->mti_exp) & OBD_CONNECT_LAZY_SIZE))
+		return;
+
+	repbody->valid |= OBD_MD_FLLAZYSIZE;
+	repbody->lazytime = 0;
+
+	/* the MDT inode holds the size of files without OST objects */
+	if (!info->mti_mdt->mdt_lazy_size || repbody->valid & OBD_MD_FLSIZE ||
+	    mdt_write_read(o) > 0)
+		return;
+
+	if (mdt_lsom_get(info, o, &lsa) != 0 || lsa.lsa_flags & LSOM_FL_STALE)
+		return;
+
+	repbody->size = lsa.lsa_size;
+	repbody->blocks = lsa.lsa_blocks;
+	repbody->lazytime = lsa.lsa_time;
+}
+
+/**
+ * Update the lazy size of \a o from the attributes its last writer sent on
+ * close, if the writer changed the file data.
+ */
+void mdt_lsom_close(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct md_attr	*ma = &info->mti_attr;
+	struct lu_attr	*la = &ma->ma_attr;
+
+	if (!info->mti_mdt->mdt_lazy_size ||
+	    !(ma->ma_valid & MA_INODE) ||
+	    !(ma->ma_attr_flags & MDS_DATA_MODIFIED) ||
+	    !(la->la_valid & LA_SIZE) ||
+	    !S_ISREG(lu_object_attr(&o->mot_obj.mo_lu)) ||
+	    mdt_dom_stripesize(info, o) != 0)
+		return;
+
+	mdt_lsom_set(info, o, la->la_size,
+		     la->la_valid & LA_BLOCKS ? la->la_blocks : 0, 0);
+}
+
+/**
+ * Mark the lazy size of \a o stale after a truncate, until the next writer
+ * closes the file or it is reconciled.
+ */
+void mdt_lsom_truncate(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct lsom_attrs lsa;
+
+	if (!S_ISREG(lu_object_attr(&o->mot_obj.mo_lu)) ||
+	    mdt_lsom_get(info, o, &lsa) != 0 ||
+	    lsa.lsa_flags & LSOM_FL_STALE)
+		return;
+
+	mdt_lsom_set(info, o, lsa.lsa_size, lsa.lsa_blocks, LSOM_FL_STALE);
+}
+
+/**
+ * Reconcile the lazy size of the file, on setxattr of XATTR_NAME_LSOM by
+ * "lfs som_sync" with the size and blocks the client glimpsed.
+ */
+int mdt_lsom_sync(struct mdt_thread_info *info)
+{
+	struct lu_ucred		*uc = mdt_ucred(info);
+	struct mdt_reint_record	*rr = &info->mti_rr;
+	struct lsom_attrs	 lsa;
+	struct mdt_object	*o;
+	int			 rc;
+	ENTRY;
+
+	if (!md_capable(uc, CFS_CAP_SYS_ADMIN))
+		RETURN(-EPERM);
+
+	if (rr->rr_eadatalen != sizeof(lsa))
+		RETURN(-EINVAL);
+
+	if (!info->mti_mdt->mdt_lazy_size)
+		RETURN(-EOPNOTSUPP);
+
+	memcpy(&lsa, rr->rr_eadata, sizeof(lsa));
+	lustre_lsom_swab(&lsa);
+
+	o = mdt_object_find(info->mti_env, info->mti_mdt, rr->rr_fid1);
+	if (IS_ERR(o))
+		RETURN(PTR_ERR(o));
+
+	if (!mdt_object_exists(o) || mdt_object_remote(o))
+		GOTO(out, rc = -ENOENT);
+
+	if (!S_ISREG(lu_object_attr(&o->mot_obj.mo_lu)))
+		GOTO(out, rc = -EINVAL);
+
+	rc = mdt_lsom_set(info, o, lsa.lsa_size, lsa.lsa_blocks, 0);
+	EXIT;
+out:
+	mdt_object_put(info->mti_env, o);
+	return rc;
+}
@@ -247,6 +247,8 @@ struct mdt_opc_slice mdt_regular_handlers[] = {
 static struct mdt_handler mdt_readpage_ops[] = {
 DEF_MDT_HDL(0,			MDS_CONNECT,  mdt_connect),
 DEF_MDT_HDL(HABEO_CORPUS | HABEO_REFERO, MDS_READPAGE, mdt_readpage),
+DEF_MDT_HDL(HABEO_CORPUS | HABEO_REFERO | MUTABOR, MDS_WRITEPAGE,
+							mdt_writepage),
 /* XXX: this is ugly and should be fixed one day, see mdc_close() for
  * detailed comments. --umka */
 DEF_MDT_HDL(HABEO_CORPUS,		MDS_CLOSE,	  mdt_close),
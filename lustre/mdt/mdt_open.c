@@ -1761,6 +1761,10 @@ int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd)
                 ret = mdt_som_au_close(info, o);
         }
 
+	/* before the atime update below resets la_valid */
+	if (mode & FMODE_WRITE)
+		mdt_lsom_close(info, o);
+
         /* Update atime on close only. */
         if ((mode & MDS_FMODE_EXEC || mode & FMODE_READ || mode & FMODE_WRITE)
             && (ma->ma_valid & MA_INODE) && (ma->ma_attr.la_valid & LA_ATIME)) {
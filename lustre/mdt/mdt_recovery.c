@@ -806,6 +806,47 @@ static void mdt_reconstruct_setattr(struct mdt_thread_info *mti,
 	mdt_object_put(mti->mti_env, obj);
 }
 
+/**
+ * The per-name results of a batch are not kept in last_rcvd, rebuild them
+ * from the directory: a name gone was unlinked, any other one goes back
+ * -EAGAIN for the client to send it again and get its real result.
+ */
+static void mdt_reconstruct_unlink_batch(struct mdt_thread_info *mti,
+					 struct mdt_lock_handle *lhc)
+{
+	struct ptlrpc_request	*req = mdt_info_req(mti);
+	struct mdt_reint_record	*rr = &mti->mti_rr;
+	struct mdt_object	*mp;
+	struct lu_name		*lname;
+	const char		*name;
+	__s32			*rcs;
+	int			 i;
+	int			 rc;
+
+	mdt_reconstruct_generic(mti, lhc);
+	if (req->rq_status != 0)
+		return;
+
+	rcs = req_capsule_server_get(mti->mti_pill, &RMF_RCS);
+	LASSERT(rcs != NULL);
+
+	mp = mdt_object_find(mti->mti_env, mti->mti_mdt, rr->rr_fid1);
+	for (i = 0, name = rr->rr_name; i < rr->rr_namecount;
+	     i++, name += strlen(name) + 1) {
+		if (IS_ERR(mp)) {
+			rcs[i] = -EAGAIN;
+			continue;
+		}
+
+		lname = mdt_name(mti->mti_env, (char *)name, strlen(name));
+		rc = mdo_lookup(mti->mti_env, mdt_object_child(mp), lname,
+				&mti->mti_tmp_fid1, &mti->mti_spec);
+		rcs[i] = rc == -ENOENT ? 0 : -EAGAIN;
+	}
+	if (!IS_ERR(mp))
+		mdt_object_put(mti->mti_env, mp);
+}
+
 typedef void (*mdt_reconstructor)(struct mdt_thread_info *mti,
                                   struct mdt_lock_handle *lhc);
 
@@ -816,7 +857,8 @@ static mdt_reconstructor reconstructors[REINT_MAX] = {
         [REINT_UNLINK]   = mdt_reconstruct_generic,
         [REINT_RENAME]   = mdt_reconstruct_generic,
         [REINT_OPEN]     = mdt_reconstruct_open,
-        [REINT_SETXATTR] = mdt_reconstruct_generic
+        [REINT_SETXATTR] = mdt_reconstruct_generic,
+	[REINT_UNLINK_BATCH] = mdt_reconstruct_unlink_batch
 };
 
 void mdt_reconstruct(struct mdt_thread_info *mti,
@@ -306,7 +306,9 @@ static int mdt_md_create(struct mdt_thread_info *info)
         if (likely(!IS_ERR(child))) {
                 struct md_object *next = mdt_object_child(parent);
 
-		if (mdt_object_remote(child)) {
+		/* the shards of a striped directory are remote dirs too */
+		if (mdt_object_remote(child) ||
+		    info->mti_spec.u.sp_ea.eadatalen > 0) {
 			struct seq_server_site *ss;
 			struct lu_ucred *uc  = mdt_ucred(info);
 
@@ -493,6 +495,7 @@ static int mdt_reint_setattr(struct mdt_thread_info *info,
         struct mdt_object       *mo;
         struct mdt_body         *repbody;
         int                      som_au, rc, rc2;
+	int			 dom = 0;
         ENTRY;
 
         DEBUG_REQ(D_INODE, req, "setattr "DFID" %x", PFID(rr->rr_fid1),
@@ -571,6 +574,17 @@ static int mdt_reint_setattr(struct mdt_thread_info *info,
                 rc = mdt_attr_set(info, mo, ma, rr->rr_flags);
                 if (rc)
                         GOTO(out_put, rc);
+
+		/* truncate the body of a Data-on-MDT file */
+		if (ma->ma_attr.la_valid & LA_SIZE &&
+		    mdt_dom_stripesize(info, mo) != 0) {
+			rc = mdt_dom_punch(info, mo, ma->ma_attr.la_size);
+			if (rc)
+				GOTO(out_put, rc);
+			dom = 1;
+		} else if (ma->ma_attr.la_valid & LA_SIZE) {
+			mdt_lsom_truncate(info, mo);
+		}
 	} else if ((ma->ma_valid & MA_LOV) && (ma->ma_valid & MA_INODE)) {
 		struct lu_buf *buf  = &info->mti_buf;
 		LASSERT(ma->ma_attr.la_valid == 0);
@@ -594,6 +608,9 @@ static int mdt_reint_setattr(struct mdt_thread_info *info,
                 GOTO(out_put, rc);
 
         mdt_pack_attr2body(info, repbody, &ma->ma_attr, mdt_object_fid(mo));
+	/* the MDT holds the size of a Data-on-MDT file */
+	if (dom)
+		repbody->valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
 
 	if (info->mti_mdt->mdt_opts.mo_oss_capa &&
 	    exp_connect_flags(info->mti_exp) & OBD_CONNECT_OSS_CAPA &&
@@ -662,6 +679,107 @@ static int mdt_reint_create(struct mdt_thread_info *info,
 	RETURN(rc);
 }
 
+struct mdt_shard_lock {
+	struct mdt_object	*msl_obj;
+	struct mdt_lock_handle	 msl_lh;
+};
+
+static void mdt_shards_unlock(struct mdt_thread_info *info,
+			      struct mdt_shard_lock *sl, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (sl[i].msl_obj == NULL)
+			continue;
+		mdt_object_unlock(info, sl[i].msl_obj, &sl[i].msl_lh, 1);
+		mdt_object_put(info->mti_env, sl[i].msl_obj);
+	}
+	OBD_FREE(sl, sizeof(*sl) * count);
+}
+
+/**
+ * Lock the shards of striped directory \a o, so that nothing is created in
+ * them while mdd_unlink() checks they are empty and removes them.
+ *
+ * \retval	the \a count locked shards, to be released with
+ *		mdt_shards_unlock()
+ * \retval	NULL if \a o is not striped
+ */
+static struct mdt_shard_lock *mdt_shards_lock(struct mdt_thread_info *info,
+					      struct mdt_object *o, int *count)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct lu_fid		*fid = &info->mti_tmp_fid2;
+	struct mdt_shard_lock	*sl = NULL;
+	struct mdt_lock_handle	*lh;
+	struct lmv_stripe_md	*mea;
+	struct mdt_object	*shard;
+	struct lu_buf		 buf;
+	int			 size;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	size = mo_xattr_get(env, mdt_object_child(o), &LU_BUF_NULL,
+			    XATTR_NAME_LMV);
+	if (size == -ENODATA)
+		RETURN(NULL);
+	if (size < 0)
+		RETURN(ERR_PTR(size));
+	if (size < sizeof(*mea))
+		RETURN(ERR_PTR(-EINVAL));
+
+	OBD_ALLOC_LARGE(mea, size);
+	if (mea == NULL)
+		RETURN(ERR_PTR(-ENOMEM));
+
+	buf.lb_buf = mea;
+	buf.lb_len = size;
+	rc = mo_xattr_get(env, mdt_object_child(o), &buf, XATTR_NAME_LMV);
+	if (rc >= 0 && (rc != size || le32_to_cpu(mea->mea_count) == 0 ||
+			size != lmv_stripe_md_size(le32_to_cpu(mea->mea_count))))
+		rc = -EINVAL;
+	if (rc < 0)
+		GOTO(out, sl = ERR_PTR(rc));
+
+	*count = le32_to_cpu(mea->mea_count);
+	OBD_ALLOC(sl, sizeof(*sl) * *count);
+	if (sl == NULL)
+		GOTO(out, sl = ERR_PTR(-ENOMEM));
+
+	for (i = 0; i < *count; i++) {
+		fid_le_to_cpu(fid, &mea->mea_ids[i]);
+		shard = mdt_object_find(env, info->mti_mdt, fid);
+		if (IS_ERR(shard))
+			GOTO(unlock, rc = PTR_ERR(shard));
+
+		lh = &sl[i].msl_lh;
+		mdt_lock_reg_init(lh, LCK_EX);
+		if (mdt_object_remote(shard))
+			rc = mdt_remote_object_lock(info, shard,
+						    &lh->mlh_rreg_lh,
+						    lh->mlh_rreg_mode,
+						    MDS_INODELOCK_UPDATE);
+		else
+			rc = mdt_object_lock(info, shard, lh,
+					     MDS_INODELOCK_UPDATE,
+					     MDT_LOCAL_LOCK);
+		if (rc != 0) {
+			mdt_object_put(env, shard);
+			GOTO(unlock, rc);
+		}
+		sl[i].msl_obj = shard;
+	}
+	GOTO(out, rc = 0);
+unlock:
+	mdt_shards_unlock(info, sl, *count);
+	sl = ERR_PTR(rc);
+out:
+	OBD_FREE_LARGE(mea, size);
+	return sl;
+}
+
 /*
  * VBR: save parent version in reply and child version getting by its name.
  * Version of child is getting and checking during its lookup. If
@@ -677,9 +795,11 @@ static int mdt_reint_unlink(struct mdt_thread_info *info,
         struct mdt_object       *mc;
         struct mdt_lock_handle  *parent_lh;
         struct mdt_lock_handle  *child_lh;
+	struct mdt_shard_lock	*shards = NULL;
         struct lu_name          *lname;
         int                      rc;
 	int			 no_name = 0;
+	int			 nr_shards = 0;
 	ENTRY;
 
         DEBUG_REQ(D_INODE, req, "unlink "DFID"/%s", PFID(rr->rr_fid1),
@@ -826,6 +946,17 @@ static int mdt_reint_unlink(struct mdt_thread_info *info,
 		GOTO(put_child, rc);
 	}
 
+	/* a striped directory is removed with its shards by mdd_unlink() */
+	if (mdt_object_exists(mc) &&
+	    S_ISDIR(lu_object_attr(&mc->mot_obj.mo_lu))) {
+		shards = mdt_shards_lock(info, mc, &nr_shards);
+		if (IS_ERR(shards)) {
+			rc = PTR_ERR(shards);
+			shards = NULL;
+			GOTO(unlock_child, rc);
+		}
+	}
+
         mdt_fail_write(info->mti_env, info->mti_mdt->mdt_bottom,
                        OBD_FAIL_MDS_REINT_UNLINK_WRITE);
         /* save version when object is locked */
@@ -866,6 +997,8 @@ static int mdt_reint_unlink(struct mdt_thread_info *info,
 
         EXIT;
 unlock_child:
+	if (shards != NULL)
+		mdt_shards_unlock(info, shards, nr_shards);
 	mdt_object_unlock(info, mc, child_lh, rc);
 put_child:
 	mdt_object_put(info->mti_env, mc);
@@ -1342,6 +1475,191 @@ out_rename_lock:
 	return rc;
 }
 
+/**
+ * Unlink \a lname from the locked local directory \a mp for a batch.
+ *
+ * Remote children are left for the client to unlink by name, with
+ * -EREMOTE.
+ */
+static int mdt_unlink_batch_one(struct mdt_thread_info *info,
+				struct mdt_object *mp, struct lu_name *lname)
+{
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct md_attr		*ma = &info->mti_attr;
+	struct lu_fid		*child_fid = &info->mti_tmp_fid1;
+	struct mdt_lock_handle	*child_lh = &info->mti_lh[MDT_LH_CHILD];
+	struct mdt_object	*mc;
+	int			 rc;
+	ENTRY;
+
+	if (lname->ln_name[0] == '.' &&
+	    (lname->ln_namelen == 1 ||
+	     (lname->ln_namelen == 2 && lname->ln_name[1] == '.')))
+		RETURN(-EINVAL);
+
+	fid_zero(child_fid);
+	rc = mdo_lookup(info->mti_env, mdt_object_child(mp), lname, child_fid,
+			&info->mti_spec);
+	if (rc != 0)
+		RETURN(rc);
+
+	if (fid_is_obf(child_fid) || fid_is_dot_lustre(child_fid))
+		RETURN(-EPERM);
+
+	mc = mdt_object_find(info->mti_env, info->mti_mdt, child_fid);
+	if (IS_ERR(mc))
+		RETURN(PTR_ERR(mc));
+
+	if (mdt_object_remote(mc))
+		GOTO(put_child, rc = -EREMOTE);
+
+	mdt_lock_reg_init(child_lh, LCK_EX);
+	rc = mdt_object_lock(info, mc, child_lh, MDS_INODELOCK_FULL,
+			     MDT_CROSS_LOCK);
+	if (rc != 0)
+		GOTO(put_child, rc);
+
+	ma->ma_need = MA_INODE;
+	ma->ma_valid = 0;
+	mdt_set_capainfo(info, 1, child_fid, BYPASS_CAPA);
+	rc = mdo_unlink(info->mti_env, mdt_object_child(mp),
+			mdt_object_child(mc), lname, ma, 0);
+	if (rc == 0 && ma->ma_valid & MA_INODE)
+		mdt_counter_incr(req, S_ISDIR(ma->ma_attr.la_mode) ?
+				 LPROC_MDT_RMDIR : LPROC_MDT_UNLINK);
+
+	/* a destroyed child has no dependent operation to order, only the
+	 * lock of a surviving one is kept until commit or ack, but for a
+	 * replay, which does not stop for the room left in the reply */
+	mdt_object_unlock(info, mc, child_lh,
+			  rc != 0 || req_is_replay(req) ||
+			  lu_object_is_dying(&mc->mot_header));
+	EXIT;
+put_child:
+	mdt_object_put(info->mti_env, mc);
+	return rc;
+}
+
+/**
+ * Give the unlinks of a batch the single transno of an empty transaction
+ * started after all of them: its callbacks set the version of \a mp and
+ * the last_rcvd slot of the client, and as it commits after every unlink,
+ * the client only drops the batch from its replay list once they are all
+ * on disk.
+ */
+static int mdt_unlink_batch_record(struct mdt_thread_info *info,
+				   struct mdt_object *mp)
+{
+	struct mdt_device	*mdt = info->mti_mdt;
+	struct thandle		*th;
+	int			 rc;
+	int			 rc2;
+	ENTRY;
+
+	th = dt_trans_create(info->mti_env, mdt->mdt_bottom);
+	if (IS_ERR(th))
+		RETURN(PTR_ERR(th));
+
+	info->mti_mos = mp;
+	rc = dt_trans_start(info->mti_env, mdt->mdt_bottom, th);
+	rc2 = dt_trans_stop(info->mti_env, mdt->mdt_bottom, th);
+	info->mti_mos = NULL;
+
+	RETURN(rc != 0 ? rc : rc2);
+}
+
+/**
+ * Unlink a batch of names from one directory under a single PDO lock on
+ * the whole directory, instead of one RPC and lock per name.
+ *
+ * Each name is removed in its own transaction, but the batch gets one
+ * transno, see mdt_unlink_batch_record(), so that it is replayed as a
+ * whole at its place. RMF_RCS carries the result of each name, -EAGAIN for
+ * the names left once the reply cannot save more child locks.
+ */
+static int mdt_reint_unlink_batch(struct mdt_thread_info *info,
+				  struct mdt_lock_handle *lhc)
+{
+	struct mdt_reint_record	*rr = &info->mti_rr;
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct lu_attr		*la = &info->mti_attr.ma_attr;
+	struct lu_attr		 saved_la;
+	struct mdt_lock_handle	*parent_lh = &info->mti_lh[MDT_LH_PARENT];
+	struct mdt_object	*mp;
+	struct lu_name		*lname;
+	const char		*name;
+	__s32			*rcs;
+	int			 unlinked = 0;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	DEBUG_REQ(D_INODE, req, "unlink %d names from "DFID,
+		  rr->rr_namecount, PFID(rr->rr_fid1));
+
+	if (info->mti_dlm_req)
+		ldlm_request_cancel(req, info->mti_dlm_req, 0);
+
+	if (fid_is_obf(rr->rr_fid1) || fid_is_dot_lustre(rr->rr_fid1))
+		RETURN(-EPERM);
+
+	rcs = req_capsule_server_get(info->mti_pill, &RMF_RCS);
+	LASSERT(rcs != NULL);
+
+	mp = mdt_object_find(info->mti_env, info->mti_mdt, rr->rr_fid1);
+	if (IS_ERR(mp))
+		RETURN(PTR_ERR(mp));
+
+	if (mdt_object_remote(mp))
+		GOTO(put_parent, rc = -EREMOTE);
+
+	mdt_lock_pdo_init(parent_lh, LCK_PW, NULL, 0);
+	rc = mdt_object_lock(info, mp, parent_lh, MDS_INODELOCK_UPDATE,
+			     MDT_LOCAL_LOCK);
+	if (rc != 0)
+		GOTO(put_parent, rc);
+
+	rc = mdt_version_get_check_save(info, mp, 0);
+	if (rc != 0)
+		GOTO(unlock_parent, rc);
+
+	/* keep mdt_txn_stop_cb() from giving the unlinks a transno, and let
+	 * mdt_save_lock() keep the child locks */
+	info->mti_has_trans = 1;
+	/* mdo_unlink() replaces the attributes with the child's */
+	saved_la = *la;
+	for (i = 0, name = rr->rr_name; i < rr->rr_namecount;
+	     i++, name += strlen(name) + 1) {
+		/* room for a child lock and the parent's regular and PDO
+		 * ones, a replay runs the whole batch again */
+		if (!req_is_replay(req) &&
+		    req->rq_reply_state->rs_nlocks >= RS_MAX_LOCKS - 2) {
+			rcs[i] = -EAGAIN;
+			continue;
+		}
+
+		*la = saved_la;
+		lname = mdt_name(info->mti_env, (char *)name, strlen(name));
+		rcs[i] = mdt_unlink_batch_one(info, mp, lname);
+		if (rcs[i] == 0)
+			unlinked++;
+		else if (rcs[i] != -ENOENT && rcs[i] != -EREMOTE)
+			CDEBUG(D_INODE, "%s: unlink "DFID"/%s: rc = %d\n",
+			       mdt_obd_name(info->mti_mdt), PFID(rr->rr_fid1),
+			       name, rcs[i]);
+	}
+	info->mti_has_trans = 0;
+
+	if (unlinked > 0)
+		rc = mdt_unlink_batch_record(info, mp);
+	EXIT;
+unlock_parent:
+	mdt_object_unlock(info, mp, parent_lh, rc);
+put_parent:
+	mdt_object_put(info->mti_env, mp);
+	return rc;
+}
+
 typedef int (*mdt_reinter)(struct mdt_thread_info *info,
                            struct mdt_lock_handle *lhc);
 
@@ -1353,7 +1671,8 @@ static mdt_reinter reinters[REINT_MAX] = {
 	[REINT_RENAME]   = mdt_reint_rename,
 	[REINT_OPEN]     = mdt_reint_open,
 	[REINT_SETXATTR] = mdt_reint_setxattr,
-	[REINT_RMENTRY]  = mdt_reint_unlink
+	[REINT_RMENTRY]  = mdt_reint_unlink,
+	[REINT_UNLINK_BATCH] = mdt_reint_unlink_batch
 };
 
 int mdt_reint_rec(struct mdt_thread_info *info,
@@ -80,6 +80,14 @@ static int mdt_getxattr_pack_reply(struct mdt_thread_info * info)
                 size = mo_xattr_list(info->mti_env,
                                      mdt_object_child(info->mti_object),
                                      &LU_BUF_NULL);
+	} else if (valid & OBD_MD_FLXATTRALL) {
+		/* the values are packed along with the list */
+		if (exp_connect_rmtclient(info->mti_exp))
+			RETURN(-EOPNOTSUPP);
+
+		size = mo_xattr_list(info->mti_env,
+				     mdt_object_child(info->mti_object),
+				     &LU_BUF_NULL);
         } else {
                 CDEBUG(D_INFO, "Valid bits: "LPX64"\n", info->mti_body->valid);
                 RETURN(-EINVAL);
@@ -98,6 +106,18 @@ static int mdt_getxattr_pack_reply(struct mdt_thread_info * info)
 
         req_capsule_set_size(pill, &RMF_EADATA, RCL_SERVER,
                              info->mti_body->eadatasize == 0 ? 0 : size);
+	if (valid & OBD_MD_FLXATTRALL && info->mti_body->eadatasize != 0) {
+		/* the values get what is left of the client buffer, and
+		 * there are at most size / 2 names; both are shrunk to fit
+		 * by mdt_getxattr_all() */
+		req_capsule_set_size(pill, &RMF_EAVALS, RCL_SERVER,
+				     info->mti_body->eadatasize - size);
+		req_capsule_set_size(pill, &RMF_EAVALS_LENS, RCL_SERVER,
+				     size / 2 * sizeof(__u32));
+	} else {
+		req_capsule_set_size(pill, &RMF_EAVALS, RCL_SERVER, 0);
+		req_capsule_set_size(pill, &RMF_EAVALS_LENS, RCL_SERVER, 0);
+	}
         rc = req_capsule_server_pack(pill);
         if (rc) {
                 LASSERT(rc < 0);
@@ -107,6 +127,83 @@ static int mdt_getxattr_pack_reply(struct mdt_thread_info * info)
         RETURN(size);
 }
 
+/**
+ * Pack all the xattrs of the object, for the client to cache them: the
+ * names in RMF_EADATA as for listxattr, the values in RMF_EAVALS and their
+ * lengths in RMF_EAVALS_LENS. The user xattrs are left out for the clients
+ * which do not support them.
+ *
+ * \retval	length of the names
+ * \retval	-ERANGE if the values do not fit in the client buffer
+ */
+static int mdt_getxattr_all(struct mdt_thread_info *info,
+			    struct md_object *next, struct lu_buf *buf)
+{
+	struct req_capsule	*pill	  = info->mti_pill;
+	struct ptlrpc_request	*req	  = mdt_info_req(info);
+	static const char	 user_string[] = "user.";
+	char			*names	  = buf->lb_buf;
+	struct lu_buf		 vbuf;
+	char			*vals;
+	__u32			*lens;
+	int			 vals_size;
+	int			 lens_max;
+	int			 names_len;
+	int			 vals_len = 0;
+	int			 count	  = 0;
+	int			 len	  = 0;
+	int			 off	  = 0;
+	int			 rc;
+	ENTRY;
+
+	rc = mo_xattr_list(info->mti_env, next, buf);
+	if (rc < 0)
+		RETURN(rc);
+	names_len = rc;
+
+	vals = req_capsule_server_get(pill, &RMF_EAVALS);
+	vals_size = req_capsule_get_size(pill, &RMF_EAVALS, RCL_SERVER);
+	lens = req_capsule_server_get(pill, &RMF_EAVALS_LENS);
+	lens_max = req_capsule_get_size(pill, &RMF_EAVALS_LENS, RCL_SERVER) /
+		   sizeof(*lens);
+
+	while (off < names_len) {
+		char	*name	 = names + off;
+		int	 namelen = strnlen(name, names_len - off) + 1;
+
+		off += namelen;
+		if (!(exp_connect_flags(req->rq_export) & OBD_CONNECT_XATTR) &&
+		    !strncmp(name, user_string, sizeof(user_string) - 1))
+			continue;
+
+		if (count == lens_max)
+			RETURN(-ERANGE);
+
+		vbuf.lb_buf = vals + vals_len;
+		vbuf.lb_len = vals_size - vals_len;
+		rc = mo_xattr_get(info->mti_env, next, &vbuf, name);
+		/* removed since it was listed */
+		if (rc == -ENODATA)
+			continue;
+		if (rc < 0)
+			RETURN(rc);
+
+		memmove(names + len, name, namelen);
+		len += namelen;
+		lens[count++] = rc;
+		vals_len += rc;
+	}
+
+	CDEBUG(D_INODE, "getxattr all "DFID": %d xattrs, %d bytes\n",
+	       PFID(mdt_object_fid(info->mti_object)), count, len + vals_len);
+
+	req_capsule_shrink(pill, &RMF_EADATA, len, RCL_SERVER);
+	req_capsule_shrink(pill, &RMF_EAVALS, vals_len, RCL_SERVER);
+	req_capsule_shrink(pill, &RMF_EAVALS_LENS, count * sizeof(*lens),
+			   RCL_SERVER);
+	RETURN(len);
+}
+
 int mdt_getxattr(struct mdt_thread_info *info)
 {
         struct ptlrpc_request  *req = mdt_info_req(info);
@@ -204,6 +301,12 @@ int mdt_getxattr(struct mdt_thread_info *info)
                 rc = mo_xattr_list(info->mti_env, next, buf);
                 if (rc < 0)
                         CDEBUG(D_INFO, "listxattr failed: %d\n", rc);
+	} else if (info->mti_body->valid & OBD_MD_FLXATTRALL) {
+		CDEBUG(D_INODE, "getxattr all\n");
+
+		rc = mdt_getxattr_all(info, next, buf);
+		if (rc < 0)
+			CDEBUG(D_INFO, "getxattr all failed: %d\n", rc);
         } else
                 LBUG();
 
@@ -310,6 +413,11 @@ int mdt_reint_setxattr(struct mdt_thread_info *info,
                         GOTO(out, rc = err_serious(-EPERM));
         }
 
+	/* lazy size-on-MDT reconciliation, stamped and stored by the MDT
+	 * without changing ctime or revoking the UPDATE lock */
+	if ((valid & OBD_MD_FLXATTR) && strcmp(xattr_name, XATTR_NAME_LSOM) == 0)
+		GOTO(out, rc = mdt_lsom_sync(info));
+
         if (strncmp(xattr_name, XATTR_USER_PREFIX,
                     sizeof(XATTR_USER_PREFIX) - 1) == 0) {
 		if (!(exp_connect_flags(req->rq_export) & OBD_CONNECT_XATTR))
@@ -109,6 +109,94 @@ EXPORT_SYMBOL(at_extra);
 cfs_atomic_t obd_dirty_transit_pages;
 EXPORT_SYMBOL(obd_dirty_transit_pages);
 
+/* Disk I/Os submitted by the OSDs of this node and not completed yet. */
+cfs_atomic_t obd_io_in_flight;
+EXPORT_SYMBOL(obd_io_in_flight);
+
+/* Moving average of the time the requests handled on this node took from
+ * their arrival to their reply, in microseconds. Updated without locking:
+ * a sample lost now and then does not matter. */
+static long obd_svc_latency_avg;
+static cfs_time_t obd_svc_latency_time;
+
+void obd_svc_latency_add(long usec)
+{
+	long avg = obd_svc_latency_avg;
+
+	obd_svc_latency_avg = avg + (usec - avg) / 8;
+	obd_svc_latency_time = cfs_time_current();
+}
+EXPORT_SYMBOL(obd_svc_latency_add);
+
+long obd_svc_latency(void)
+{
+	/* No request handled for a second: the node is idle. */
+	if (cfs_time_before(cfs_time_add(obd_svc_latency_time,
+					 cfs_time_seconds(1)),
+			    cfs_time_current()))
+		return 0;
+
+	return obd_svc_latency_avg;
+}
+EXPORT_SYMBOL(obd_svc_latency);
+
+void obd_scan_rate_init(struct obd_scan_rate *osr)
+{
+	osr->osr_rate = 0;
+	osr->osr_scanned = 0;
+	osr->osr_time = cfs_time_current();
+}
+EXPORT_SYMBOL(obd_scan_rate_init);
+
+/**
+ * Account an object scanned, and once a second adapt the speed of the scan
+ * to keep the latency of the requests handled on the node under \a target
+ * microseconds: halve the speed reached over the last second if the latency
+ * is above the target or if the disks are busy, else raise the speed by a
+ * quarter, and lift the limit when the scan does not even reach it.
+ *
+ * \retval true	if osr::osr_rate changed
+ */
+bool obd_scan_rate_update(struct obd_scan_rate *osr, __u32 target)
+{
+	cfs_time_t	now = cfs_time_current();
+	cfs_duration_t	elapsed;
+	__u64		reached;
+	__u32		rate = osr->osr_rate;
+
+	osr->osr_scanned++;
+	elapsed = cfs_time_sub(now, osr->osr_time);
+	if (elapsed < cfs_time_seconds(1))
+		return false;
+
+	reached = (__u64)osr->osr_scanned * CFS_HZ;
+	do_div(reached, elapsed);
+	osr->osr_scanned = 0;
+	osr->osr_time = now;
+
+	if (obd_svc_latency() > target ||
+	    cfs_atomic_read(&obd_io_in_flight) > OBD_SCAN_IO_DEPTH) {
+		if (rate == 0 || rate > reached)
+			rate = reached;
+		rate = max_t(__u32, rate / 2, OBD_SCAN_RATE_MIN);
+	} else if (rate != 0) {
+		rate += rate / 4 + OBD_SCAN_RATE_MIN;
+		if (rate > reached * 2)
+			rate = 0;
+	}
+
+	if (rate == osr->osr_rate)
+		return false;
+
+	CDEBUG(D_INFO, "scan rate %u -> %u objs/sec, reached "LPU64", "
+	       "latency %ld/%u usec, %d I/Os in flight\n", osr->osr_rate,
+	       rate, reached, obd_svc_latency(), target,
+	       cfs_atomic_read(&obd_io_in_flight));
+	osr->osr_rate = rate;
+	return true;
+}
+EXPORT_SYMBOL(obd_scan_rate_update);
+
 char obd_jobid_var[JOBSTATS_JOBID_VAR_MAX_LEN + 1] = JOBSTATS_DISABLE;
 EXPORT_SYMBOL(obd_jobid_var);
 
@@ -134,6 +134,62 @@ void dt_txn_hook_commit(struct thandle *txn)
 }
 EXPORT_SYMBOL(dt_txn_hook_commit);
 
+void dt_txn_transno_init(struct dt_txn_commit_transno *dtct,
+			 dt_transno_cb_t func)
+{
+	spin_lock_init(&dtct->dtct_lock);
+	CFS_INIT_LIST_HEAD(&dtct->dtct_linkage);
+	dtct->dtct_transno = 0;
+	dtct->dtct_count = 0;
+	dtct->dtct_queued = 0;
+	dtct->dtct_func = func;
+}
+EXPORT_SYMBOL(dt_txn_transno_init);
+
+/**
+ * Account the commit of \a count registrations to \a dtct up to \a transno,
+ * and queue the callback to \a batch unless another batch reports it
+ * already: that one will report them all.
+ */
+void dt_txn_transno_commit(struct dt_txn_commit_transno *dtct, __u64 transno,
+			   int count, cfs_list_t *batch)
+{
+	spin_lock(&dtct->dtct_lock);
+	if (transno > dtct->dtct_transno)
+		dtct->dtct_transno = transno;
+	dtct->dtct_count += count;
+	if (!dtct->dtct_queued) {
+		dtct->dtct_queued = 1;
+		cfs_list_add_tail(&dtct->dtct_linkage, batch);
+	}
+	spin_unlock(&dtct->dtct_lock);
+}
+EXPORT_SYMBOL(dt_txn_transno_commit);
+
+/** Run the coalesced callbacks of \a batch, once the batch is committed. */
+void dt_txn_transno_run(cfs_list_t *batch)
+{
+	struct dt_txn_commit_transno	*dtct;
+	__u64				 transno;
+	int				 count;
+
+	while (!cfs_list_empty(batch)) {
+		dtct = cfs_list_entry(batch->next, struct dt_txn_commit_transno,
+				      dtct_linkage);
+		spin_lock(&dtct->dtct_lock);
+		cfs_list_del_init(&dtct->dtct_linkage);
+		dtct->dtct_queued = 0;
+		transno = dtct->dtct_transno;
+		count = dtct->dtct_count;
+		dtct->dtct_count = 0;
+		spin_unlock(&dtct->dtct_lock);
+
+		/* may release \a dtct */
+		dtct->dtct_func(dtct, transno, count);
+	}
+}
+EXPORT_SYMBOL(dt_txn_transno_run);
+
 int dt_device_init(struct dt_device *dev, struct lu_device_type *t)
 {
 
@@ -542,5 +542,7 @@ void ofd_stats_counter_init(struct lprocfs_stats *stats)
 			     0, "punch", "reqs");
 	lprocfs_counter_init(stats, LPROC_OFD_STATS_SYNC,
 			     0, "sync", "reqs");
+	lprocfs_counter_init(stats, LPROC_OFD_STATS_FALLOCATE,
+			     0, "fallocate", "reqs");
 }
 #endif /* LPROCFS */
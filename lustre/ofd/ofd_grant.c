@@ -1001,6 +1001,53 @@ int ofd_grant_create(const struct lu_env *env, struct obd_export *exp, int *nr)
 	RETURN(0);
 }
 
+/**
+ * Reserve space for fallocate of \a bytes. It is taken from the space not
+ * granted to the clients, so that the writes they cached still fit, and is
+ * accounted as pending until ofd_grant_commit().
+ *
+ * \param env - is the lu environment provided by the caller
+ * \param exp - is the export of the client which sent the request
+ * \param bytes - is the size of the range to be allocated
+ */
+int ofd_grant_fallocate(const struct lu_env *env, struct obd_export *exp,
+			obd_size bytes)
+{
+	struct ofd_thread_info		*info = ofd_info(env);
+	struct ofd_device		*ofd = ofd_exp(exp);
+	struct filter_export_data	*fed = &exp->exp_filter_data;
+	obd_size			 left;
+
+	ENTRY;
+
+	info->fti_used = 0;
+
+	if (exp->exp_obd->obd_recovering)
+		/* don't enforce grant during recovery */
+		RETURN(0);
+
+	/* Update statfs data if required */
+	ofd_grant_statfs(env, exp, 1, NULL);
+
+	/* protect all grant counters */
+	spin_lock(&ofd->ofd_grant_lock);
+	left = ofd_grant_space_left(exp);
+	if (bytes > left) {
+		spin_unlock(&ofd->ofd_grant_lock);
+		CDEBUG(D_CACHE, "%s: cli %s/%p no space to fallocate "LPU64
+		       ", left "LPU64"\n", exp->exp_obd->obd_name,
+		       exp->exp_client_uuid.uuid, exp, bytes, left);
+		RETURN(-ENOSPC);
+	}
+
+	ofd->ofd_tot_granted += bytes;
+	info->fti_used = bytes;
+	fed->fed_pending += info->fti_used;
+	ofd->ofd_tot_pending += info->fti_used;
+	spin_unlock(&ofd->ofd_grant_lock);
+	RETURN(0);
+}
+
 /**
  * Called at commit time to update pending grant counter for writes in flight
  *
@@ -56,6 +56,9 @@
 #define OFD_PRECREATE_SMALL_FS		(1024ULL * 1024 * 1024)
 #define OFD_PRECREATE_BATCH_SMALL	8
 
+/* fallocate allocates at most that many bytes with the object locked */
+#define OFD_FALLOCATE_CHUNK		(128ULL << 20)
+
 /* Limit the returned fields marked valid to those that we actually might set */
 #define OFD_VALID_FLAGS (LA_TYPE | LA_MODE | LA_SIZE | LA_BLOCKS | \
 			 LA_BLKSIZE | LA_ATIME | LA_MTIME | LA_CTIME)
@@ -85,6 +88,7 @@ enum {
 	LPROC_OFD_STATS_SETATTR = 2,
 	LPROC_OFD_STATS_PUNCH = 3,
 	LPROC_OFD_STATS_SYNC = 4,
+	LPROC_OFD_STATS_FALLOCATE = 5,
 	LPROC_OFD_STATS_LAST,
 };
 
@@ -409,6 +413,8 @@ int ofd_attr_set(const struct lu_env *env, struct ofd_object *fo,
 int ofd_object_punch(const struct lu_env *env, struct ofd_object *fo,
 		     __u64 start, __u64 end, struct lu_attr *la,
 		     struct filter_fid *ff);
+int ofd_object_fallocate(const struct lu_env *env, struct ofd_object *fo,
+			 __u64 start, __u64 end, int mode, struct lu_attr *la);
 int ofd_object_destroy(const struct lu_env *, struct ofd_object *, int);
 int ofd_attr_get(const struct lu_env *env, struct ofd_object *fo,
 		 struct lu_attr *la);
@@ -468,6 +474,8 @@ void ofd_grant_prepare_write(const struct lu_env *env, struct obd_export *exp,
 			     int niocount);
 void ofd_grant_commit(const struct lu_env *env, struct obd_export *exp, int rc);
 int ofd_grant_create(const struct lu_env *env, struct obd_export *exp, int *nr);
+int ofd_grant_fallocate(const struct lu_env *env, struct obd_export *exp,
+			obd_size bytes);
 
 /* ofd_fmd.c */
 int ofd_fmd_init(void);
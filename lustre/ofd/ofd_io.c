@@ -490,6 +490,12 @@ out_stop:
 
 out:
 	dt_bufs_put(env, o, lnb, niocount);
+	if (oti->oti_brw_partial) {
+		/* the other pages prepared by ofd_preprw_write() follow, keep
+		 * the object locked and referenced, and the grant pending */
+		ofd_object_put(env, fo);
+		RETURN(rc);
+	}
 	ofd_read_unlock(env, fo);
 	ofd_object_put(env, fo);
 	/* second put is pair to object_get in ofd_preprw_write */
@@ -995,6 +995,80 @@ out_env:
 	return rc;
 }
 
+static int ofd_fallocate(const struct lu_env *env, struct obd_export *exp,
+			 struct obd_info *oinfo, struct obd_trans_info *oti)
+{
+	struct ofd_thread_info	*info;
+	struct ofd_device	*ofd = ofd_exp(exp);
+	struct ldlm_namespace	*ns = ofd->ofd_namespace;
+	struct ldlm_resource	*res;
+	struct ofd_object	*fo;
+	int			 mode = oinfo->oi_oa->o_falloc_mode;
+	int			 rc = 0;
+
+	ENTRY;
+
+	info = ofd_info_init(env, exp);
+	ofd_oti2info(info, oti);
+
+	rc = ostid_to_fid(&info->fti_fid, &oinfo->oi_oa->o_oi, 0);
+	if (rc != 0)
+		RETURN(rc);
+	ost_fid_build_resid(&info->fti_fid, &info->fti_resid);
+
+	CDEBUG(D_INODE, "calling fallocate for object "DFID", mode = %#x"
+	       ", start = "LPD64", end = "LPD64"\n", PFID(&info->fti_fid),
+	       mode, oinfo->oi_policy.l_extent.start,
+	       oinfo->oi_policy.l_extent.end);
+
+	rc = ofd_auth_capa(exp, &info->fti_fid, ostid_seq(&oinfo->oi_oa->o_oi),
+			   oinfo_capa(oinfo), CAPA_OPC_OSS_WRITE);
+	if (rc)
+		GOTO(out_env, rc);
+
+	fo = ofd_object_find(env, ofd, &info->fti_fid);
+	if (IS_ERR(fo)) {
+		CERROR("%s: error finding object "DFID": rc = %ld\n",
+		       exp->exp_obd->obd_name, PFID(&info->fti_fid),
+		       PTR_ERR(fo));
+		GOTO(out_env, rc = PTR_ERR(fo));
+	}
+
+	/* the size only changes if the range is allocated past it */
+	la_from_obdo(&info->fti_attr, oinfo->oi_oa,
+		     mode & OST_FALLOC_KEEP_SIZE ? OBD_MD_FLCTIME :
+		     OBD_MD_FLMTIME | OBD_MD_FLCTIME);
+	info->fti_attr.la_valid &= ~LA_TYPE;
+
+	rc = ofd_object_fallocate(env, fo, oinfo->oi_policy.l_extent.start,
+				  oinfo->oi_policy.l_extent.end, mode,
+				  &info->fti_attr);
+	if (rc)
+		GOTO(out, rc);
+
+	if (!(mode & OST_FALLOC_KEEP_SIZE)) {
+		res = ldlm_resource_get(ns, NULL, &info->fti_resid,
+					LDLM_EXTENT, 0);
+		if (res != NULL) {
+			ldlm_res_lvbo_update(res, NULL, 0);
+			ldlm_resource_putref(res);
+		}
+	}
+
+	oinfo->oi_oa->o_valid = OBD_MD_FLID;
+	rc = ofd_attr_get(env, fo, &info->fti_attr);
+	obdo_from_la(oinfo->oi_oa, &info->fti_attr,
+		     OFD_VALID_FLAGS | LA_UID | LA_GID);
+	ofd_info2oti(info, oti);
+
+	ofd_counter_incr(exp, LPROC_OFD_STATS_FALLOCATE, oti->oti_jobid, 1);
+	EXIT;
+out:
+	ofd_object_put(env, fo);
+out_env:
+	return rc;
+}
+
 static int ofd_destroy_by_fid(const struct lu_env *env,
 			      struct ofd_device *ofd,
 			      const struct lu_fid *fid, int orphan)
@@ -1682,6 +1756,7 @@ struct obd_ops ofd_obd_ops = {
 	.o_destroy_export	= ofd_destroy_export,
 	.o_postrecov		= ofd_obd_postrecov,
 	.o_punch		= ofd_punch,
+	.o_fallocate		= ofd_fallocate,
 	.o_getattr		= ofd_getattr,
 	.o_sync			= ofd_sync,
 	.o_iocontrol		= ofd_iocontrol,
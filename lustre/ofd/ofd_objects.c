@@ -518,6 +518,100 @@ unlock:
 	RETURN(rc);
 }
 
+/*
+ * Allocate [start, end) of \a fo, one chunk of fallocate. The space is
+ * taken from the grant and the quota is reserved in the transaction, which
+ * only starts once the OSD is done: the OSD allocates the blocks in
+ * transactions of its own. Ours sets the times and gives the request a
+ * transno to be replayed with, replaying the allocation is harmless.
+ */
+static int ofd_object_fallocate_chunk(const struct lu_env *env,
+				      struct ofd_object *fo, __u64 start,
+				      __u64 end, int mode, struct lu_attr *la,
+				      int check_version)
+{
+	struct ofd_thread_info	*info = ofd_info(env);
+	struct ofd_device	*ofd = ofd_obj2dev(fo);
+	struct dt_object	*dob = ofd_object_child(fo);
+	struct thandle		*th;
+	int			 rc;
+
+	ENTRY;
+
+	rc = ofd_grant_fallocate(env, info->fti_exp, end - start);
+	if (rc)
+		RETURN(rc);
+
+	ofd_write_lock(env, fo);
+	if (!ofd_object_exists(fo))
+		GOTO(unlock, rc = -ENOENT);
+
+	/* VBR: version recovery check, the version changes with the first
+	 * chunk */
+	if (check_version) {
+		rc = ofd_version_get_check(info, fo);
+		if (rc)
+			GOTO(unlock, rc);
+	}
+
+	th = ofd_trans_create(env, ofd);
+	if (IS_ERR(th))
+		GOTO(unlock, rc = PTR_ERR(th));
+
+	rc = dt_declare_fallocate(env, dob, start, end, mode, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	rc = dt_declare_attr_set(env, dob, la, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	rc = dt_fallocate(env, dob, start, end, mode);
+	if (rc)
+		GOTO(stop, rc);
+
+	rc = ofd_trans_start(env, ofd, fo, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	rc = dt_attr_set(env, dob, la, th, ofd_object_capa(env, fo));
+stop:
+	ofd_trans_stop(env, ofd, th, rc);
+unlock:
+	ofd_write_unlock(env, fo);
+	ofd_grant_commit(env, info->fti_exp, rc);
+	RETURN(rc);
+}
+
+/**
+ * Allocate the blocks of [start, end) of \a fo and update its times from
+ * \a la, OFD_FALLOCATE_CHUNK at a time so that the object is not locked
+ * for the whole range.
+ */
+int ofd_object_fallocate(const struct lu_env *env, struct ofd_object *fo,
+			 __u64 start, __u64 end, int mode, struct lu_attr *la)
+{
+	struct ofd_thread_info	*info = ofd_info(env);
+	struct ofd_mod_data	*fmd;
+	__u64			 pos;
+	__u64			 next;
+	int			 rc = 0;
+
+	ENTRY;
+
+	fmd = ofd_fmd_get(info->fti_exp, &fo->ofo_header.loh_fid);
+	if (fmd && fmd->fmd_mactime_xid < info->fti_xid)
+		fmd->fmd_mactime_xid = info->fti_xid;
+	ofd_fmd_put(info->fti_exp, fmd);
+
+	for (pos = start; rc == 0 && pos < end; pos = next) {
+		next = min(end, pos + OFD_FALLOCATE_CHUNK);
+		rc = ofd_object_fallocate_chunk(env, fo, pos, next, mode, la,
+						pos == start);
+	}
+	RETURN(rc);
+}
+
 int ofd_object_destroy(const struct lu_env *env, struct ofd_object *fo,
 		       int orphan)
 {
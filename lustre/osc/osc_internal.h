@@ -122,6 +122,9 @@ int osc_setattr_async_base(struct obd_export *exp, struct obd_info *oinfo,
 int osc_punch_base(struct obd_export *exp, struct obd_info *oinfo,
                    obd_enqueue_update_f upcall, void *cookie,
                    struct ptlrpc_request_set *rqset);
+int osc_fallocate_base(struct obd_export *exp, struct obd_info *oinfo,
+		       obd_enqueue_update_f upcall, void *cookie,
+		       struct ptlrpc_request_set *rqset);
 int osc_sync_base(struct obd_export *exp, struct obd_info *oinfo,
 		  obd_enqueue_update_f upcall, void *cookie,
 		  struct ptlrpc_request_set *rqset);
@@ -187,6 +190,7 @@ static inline struct osc_device *obd2osc_dev(const struct obd_device *d)
 }
 
 int osc_dlm_lock_pageref(struct ldlm_lock *dlm);
+void osc_lock_build_einfo_bare(struct ldlm_enqueue_info *einfo);
 
 extern struct kmem_cache *osc_quota_kmem;
 struct osc_quota_info {
@@ -455,7 +455,12 @@ static int osc_io_setattr_start(const struct lu_env *env,
 		oa->o_ctime = attr->cat_ctime;
 		oa->o_valid = OBD_MD_FLID | OBD_MD_FLGROUP | OBD_MD_FLATIME |
 			OBD_MD_FLCTIME | OBD_MD_FLMTIME;
-                if (ia_valid & ATTR_SIZE) {
+		if (cl_io_is_fallocate(io)) {
+			oa->o_size = io->u.ci_setattr.sa_falloc_offset;
+			oa->o_blocks = io->u.ci_setattr.sa_falloc_end;
+			oa->o_falloc_mode = io->u.ci_setattr.sa_falloc_mode;
+			oa->o_valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
+		} else if (ia_valid & ATTR_SIZE) {
                         oa->o_size = size;
                         oa->o_blocks = OBD_OBJECT_EOF;
                         oa->o_valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
@@ -472,7 +477,11 @@ static int osc_io_setattr_start(const struct lu_env *env,
                 oinfo.oi_capa = io->u.ci_setattr.sa_capa;
 		init_completion(&cbargs->opc_sync);
 
-                if (ia_valid & ATTR_SIZE)
+		if (cl_io_is_fallocate(io))
+			result = osc_fallocate_base(osc_export(cl2osc(obj)),
+						    &oinfo, osc_async_upcall,
+						    cbargs, PTLRPCD_SET);
+		else if (ia_valid & ATTR_SIZE)
                         result = osc_punch_base(osc_export(cl2osc(obj)),
 						&oinfo, osc_async_upcall,
                                                 cbargs, PTLRPCD_SET);
@@ -510,6 +519,22 @@ static void osc_io_setattr_end(const struct lu_env *env,
                 }
         }
 
+	if (result == 0 && cl_io_is_fallocate(io) &&
+	    !(io->u.ci_setattr.sa_falloc_mode & OST_FALLOC_KEEP_SIZE)) {
+		struct cl_attr *attr = &osc_env_info(env)->oti_attr;
+		__u64 end = io->u.ci_setattr.sa_falloc_end;
+
+		/* the object was extended to the end of the range */
+		cl_object_attr_lock(obj);
+		result = cl_object_attr_get(env, obj, attr);
+		if (result == 0 && attr->cat_size < end) {
+			attr->cat_size = attr->cat_kms = end;
+			result = cl_object_attr_set(env, obj, attr,
+						    CAT_SIZE | CAT_KMS);
+		}
+		cl_object_attr_unlock(obj);
+	}
+
 	if (cl_io_is_trunc(io)) {
 		__u64 size = io->u.ci_setattr.sa_attr.lvb_size;
 		osc_trunc_check(env, io, oio, size);
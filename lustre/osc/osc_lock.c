@@ -938,6 +938,21 @@ static void osc_lock_build_einfo(const struct lu_env *env,
         einfo->ei_cbdata = lock; /* value to be put into ->l_ast_data */
 }
 
+/**
+ * Build \a einfo for a read lock with no osc_lock attached, such as the
+ * locks granted by OST_GLIMPSE_BATCH. An osc_lock is attached to it when a
+ * later enqueue matches it, see osc_set_lock_data_with_check().
+ */
+void osc_lock_build_einfo_bare(struct ldlm_enqueue_info *einfo)
+{
+	memset(einfo, 0, sizeof(*einfo));
+	einfo->ei_type   = LDLM_EXTENT;
+	einfo->ei_mode   = LCK_PR;
+	einfo->ei_cb_bl  = osc_ldlm_blocking_ast;
+	einfo->ei_cb_cp  = osc_ldlm_completion_ast;
+	einfo->ei_cb_gl  = osc_ldlm_glimpse_ast;
+}
+
 /**
  * Determine if the lock should be converted into a lockless lock.
  *
@@ -305,6 +305,178 @@ static int osc_getattr(const struct lu_env *env, struct obd_export *exp,
         return rc;
 }
 
+static int osc_glimpse_batch_interpret(const struct lu_env *env,
+				       struct ptlrpc_request *req,
+				       struct osc_glimpse_args *ga, int rc)
+{
+	ldlm_policy_data_t	 policy = { .l_extent = { 0, OBD_OBJECT_EOF } };
+	struct ost_glimpse	*req_og;
+	struct ost_glimpse	*rep_og = NULL;
+	int			 i;
+	ENTRY;
+
+	req_og = req_capsule_client_get(&req->rq_pill, &RMF_OST_GLIMPSE);
+	if (rc == 0) {
+		rep_og = req_capsule_server_sized_get(&req->rq_pill,
+						&RMF_OST_GLIMPSE,
+						ga->ga_count * sizeof(*rep_og));
+		if (rep_og == NULL)
+			rc = -EPROTO;
+	}
+
+	for (i = 0; i < ga->ga_count; i++) {
+		struct obd_glimpse	*og = &ga->ga_ogs[i];
+		struct lov_oinfo	*loi = og->og_oinfo;
+		struct lustre_handle	*lockh = &req_og[i].og_handle;
+		struct ldlm_lock	*lock;
+		struct ldlm_res_id	 res_id;
+		int			 rc2 = rc;
+
+		if (rc2 == 0)
+			rc2 = rep_og[i].og_rc;
+		if (rc2 == 0 && lustre_handle_is_used(lockh)) {
+			ostid_build_res_name(&loi->loi_oi, &res_id);
+			rc2 = ldlm_cli_lock_adopt(ga->ga_exp, lockh, &res_id,
+						  &policy, &rep_og[i].og_handle,
+						  &rep_og[i].og_lvb,
+						  sizeof(rep_og[i].og_lvb));
+			/* no osc_lock is attached to it yet */
+			if (rc2 == -ELDLM_NO_LOCK_DATA)
+				rc2 = 0;
+		}
+		if (rc2 != 0) {
+			if (lustre_handle_is_used(lockh))
+				ldlm_cli_lock_abort(lockh, LCK_PR);
+			og->og_rc = rc2;
+			continue;
+		}
+
+		og->og_lvb = rep_og[i].og_lvb;
+		og->og_rc = 0;
+		if (!lustre_handle_is_used(lockh))
+			continue;
+
+		/* The lock covers the whole object, make it matchable by the
+		 * next glimpse as osc_lock_lvb_update() would. The caller holds
+		 * lli_glimpse_sem, no other glimpse updates the oinfo. */
+		lock = ldlm_handle2lock(lockh);
+		LASSERT(lock != NULL);
+		loi->loi_lvb = og->og_lvb;
+		if (og->og_lvb.lvb_size >= loi->loi_kms)
+			loi->loi_kms = og->og_lvb.lvb_size;
+		loi->loi_kms_valid = 1;
+		ldlm_lock_allow_match(lock);
+		LDLM_LOCK_PUT(lock);
+		ldlm_lock_decref(lockh, LCK_PR);
+	}
+
+	CDEBUG(D_INODE, "%s: glimpsed %d objects: rc = %d\n",
+	       ga->ga_exp->exp_obd->obd_name, ga->ga_count, rc);
+	RETURN(0);
+}
+
+static int osc_glimpse_batch_send(struct obd_export *exp,
+				  struct obd_glimpse *ogs, int count,
+				  __u32 flags, struct ldlm_enqueue_info *einfo,
+				  struct ptlrpc_request_set *set)
+{
+	struct ptlrpc_request	*req;
+	struct osc_glimpse_args	*ga;
+	struct ost_glimpse	*og;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_OST_GLIMPSE_BATCH);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_OST_GLIMPSE, RCL_CLIENT,
+			     count * sizeof(*og));
+	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, OST_GLIMPSE_BATCH);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+
+	og = req_capsule_client_get(&req->rq_pill, &RMF_OST_GLIMPSE);
+	memset(og, 0, count * sizeof(*og));
+	for (i = 0; i < count; i++) {
+		struct ldlm_res_id res_id;
+
+		og[i].og_oi = ogs[i].og_oinfo->loi_oi;
+		if (flags & OBD_GLIMPSE_NOLOCK)
+			continue;
+
+		/* the OST grants the lock under this handle, see
+		 * osc_glimpse_batch_interpret() */
+		ostid_build_res_name(&og[i].og_oi, &res_id);
+		rc = ldlm_cli_lock_prep(exp, &res_id, einfo,
+					sizeof(struct ost_lvb), LVB_T_OST,
+					&og[i].og_handle);
+		if (rc != 0) {
+			while (--i >= 0)
+				ldlm_cli_lock_abort(&og[i].og_handle, LCK_PR);
+			ptlrpc_req_finished(req);
+			RETURN(rc);
+		}
+	}
+
+	req_capsule_set_size(&req->rq_pill, &RMF_OST_GLIMPSE, RCL_SERVER,
+			     count * sizeof(*og));
+	ptlrpc_request_set_replen(req);
+	req->rq_interpret_reply =
+		(ptlrpc_interpterer_t)osc_glimpse_batch_interpret;
+
+	CLASSERT(sizeof(*ga) <= sizeof(req->rq_async_args));
+	ga = ptlrpc_req_async_args(req);
+	ga->ga_exp = exp;
+	ga->ga_ogs = ogs;
+	ga->ga_count = count;
+
+	ptlrpc_set_add_req(set, req);
+	RETURN(0);
+}
+
+/**
+ * Glimpse the objects of \a ogs with OST_GLIMPSE_BATCH RPCs of up to
+ * OST_GLIMPSE_BATCH_MAX objects added to \a set. Unless OBD_GLIMPSE_NOLOCK
+ * is set, the OST grants a PR lock on each object it can, which is cached
+ * like the lock of a regular glimpse. The result of each object is in its
+ * og_rc once \a set completes, failures to send are reported there too.
+ */
+static int osc_glimpse_batch(const struct lu_env *env, struct obd_export *exp,
+			     struct obd_glimpse *ogs, int count, __u32 flags,
+			     struct ptlrpc_request_set *set)
+{
+	struct ldlm_enqueue_info	einfo;
+	int				n;
+	int				i;
+	int				rc = 0;
+	ENTRY;
+
+	LASSERT(set != NULL);
+
+	if (!(exp_connect_flags(exp) & OBD_CONNECT_GLIMPSE_BATCH))
+		GOTO(out, rc = -EOPNOTSUPP);
+
+	osc_lock_build_einfo_bare(&einfo);
+	while (count > 0) {
+		n = min(count, OST_GLIMPSE_BATCH_MAX);
+		rc = osc_glimpse_batch_send(exp, ogs, n, flags, &einfo, set);
+		if (rc != 0)
+			break;
+		ogs += n;
+		count -= n;
+	}
+	EXIT;
+out:
+	for (i = 0; i < count && rc != 0; i++)
+		ogs[i].og_rc = rc;
+	return rc;
+}
+
 static int osc_setattr(const struct lu_env *env, struct obd_export *exp,
                        struct obd_info *oinfo, struct obd_trans_info *oti)
 {
@@ -557,6 +729,59 @@ int osc_punch_base(struct obd_export *exp, struct obd_info *oinfo,
         RETURN(0);
 }
 
+/**
+ * Send OST_FALLOCATE for the range [o_size, o_blocks) of oinfo->oi_oa,
+ * completed by \a upcall like a punch.
+ */
+int osc_fallocate_base(struct obd_export *exp, struct obd_info *oinfo,
+		       obd_enqueue_update_f upcall, void *cookie,
+		       struct ptlrpc_request_set *rqset)
+{
+	struct ptlrpc_request	*req;
+	struct osc_setattr_args	*sa;
+	struct ost_body		*body;
+	int			 rc;
+	ENTRY;
+
+	if (!(exp_connect_flags(exp) & OBD_CONNECT_FALLOCATE))
+		RETURN(-EOPNOTSUPP);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp), &RQF_OST_FALLOCATE);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	osc_set_capa_size(req, &RMF_CAPA1, oinfo->oi_capa);
+	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, OST_FALLOCATE);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+	/* allocating a large range takes as long as a punch */
+	req->rq_request_portal = OST_IO_PORTAL;
+	ptlrpc_at_set_req_timeout(req);
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	LASSERT(body);
+	lustre_set_wire_obdo(&req->rq_import->imp_connect_data, &body->oa,
+			     oinfo->oi_oa);
+	osc_pack_capa(req, body, oinfo->oi_capa);
+
+	ptlrpc_request_set_replen(req);
+
+	req->rq_interpret_reply = (ptlrpc_interpterer_t)osc_setattr_interpret;
+	CLASSERT(sizeof(*sa) <= sizeof(req->rq_async_args));
+	sa = ptlrpc_req_async_args(req);
+	sa->sa_oa     = oinfo->oi_oa;
+	sa->sa_upcall = upcall;
+	sa->sa_cookie = cookie;
+	if (rqset == PTLRPCD_SET)
+		ptlrpcd_add_req(req, PDL_POLICY_ROUND, -1);
+	else
+		ptlrpc_set_add_req(rqset, req);
+
+	RETURN(0);
+}
+
 static int osc_punch(const struct lu_env *env, struct obd_export *exp,
                      struct obd_info *oinfo, struct obd_trans_info *oti,
                      struct ptlrpc_request_set *rqset)
@@ -3651,6 +3876,7 @@ struct obd_ops osc_obd_ops = {
         .o_destroy              = osc_destroy,
         .o_getattr              = osc_getattr,
         .o_getattr_async        = osc_getattr_async,
+	.o_glimpse_batch	= osc_glimpse_batch,
         .o_setattr              = osc_setattr,
         .o_setattr_async        = osc_setattr_async,
         .o_brw                  = osc_brw,
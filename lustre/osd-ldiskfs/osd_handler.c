@@ -77,6 +77,11 @@ int ldiskfs_track_declares_assert;
 CFS_MODULE_PARM(ldiskfs_track_declares_assert, "i", int, 0644,
 		"LBUG during tracking of declares");
 
+static int osd_commit_threads = 1;
+CFS_MODULE_PARM(osd_commit_threads, "i", int, 0444,
+		"Threads per CPT running the transaction commit callbacks, "
+		"0 to run them from the journal thread");
+
 static const char dot[] = ".";
 static const char dotdot[] = "..";
 static const char remote_obj_dir[] = "REM_OBJ_DIR";
@@ -311,6 +316,55 @@ osd_iget_verify(struct osd_thread_info *info, struct osd_device *dev,
 	return inode;
 }
 
+/*
+ * The content of the small directories, of the symlinks too long to be
+ * kept in the inode and of the small Data-on-MDT files is one more block to
+ * read once their inode is read, by the lookup, readdir or read which
+ * usually follows. Read their blocks ahead when the object is looked up, so
+ * that this read is under way while the request is handled, rather than
+ * waited for afterwards.
+ */
+static void osd_small_dir_readahead(struct osd_device *dev,
+				    const struct lu_fid *fid,
+				    struct inode *inode)
+{
+	struct buffer_head	*bh;
+	sector_t		 count;
+	sector_t		 i;
+	int			 rc;
+
+	if (S_ISLNK(inode->i_mode)) {
+		if (i_size_read(inode) < sizeof(LDISKFS_I(inode)->i_data))
+			return; /* fast symlink */
+	} else if (S_ISREG(inode->i_mode)) {
+		/* only the files of the MDT have their data in its blocks */
+		if (!fid_is_norm(fid))
+			return;
+	} else if (!S_ISDIR(inode->i_mode)) {
+		return;
+	}
+
+	count = (i_size_read(inode) + inode->i_sb->s_blocksize - 1) >>
+		inode->i_blkbits;
+	if (count > dev->od_small_dir_blocks)
+		return;
+
+	/* Directories have no a_ops->bmap, so map the blocks through
+	 * ldiskfs the way its own directory lookup reads ahead. */
+	for (i = 0; i < count; i++) {
+		bh = ldiskfs_getblk(NULL, inode, i, 0, &rc);
+		if (bh == NULL)
+			continue;
+
+		if (!buffer_uptodate(bh)) {
+			ll_rw_block(READA, 1, &bh);
+			lprocfs_counter_add(dev->od_stats,
+					    LPROC_OSD_SMALL_DIR_RA, 1);
+		}
+		brelse(bh);
+	}
+}
+
 static int osd_fid_lookup(const struct lu_env *env, struct osd_object *obj,
 			  const struct lu_fid *fid,
 			  const struct lu_object_conf *conf)
@@ -411,6 +465,7 @@ iget:
 			 *	It is diffcult to distinguish the 2nd from the
 			 *	1st case. Relatively speaking, the 1st case is
 			 *	common than the 2nd case, trigger OI scrub. */
+			osd_oi_cache_del(dev, fid);
 			result = osd_oi_lookup(info, dev, fid, id, true);
 			if (result == 0)
 				/* It is the case 1 or 2. */
@@ -472,6 +527,7 @@ trigger:
 
         obj->oo_inode = inode;
         LASSERT(obj->oo_inode->i_sb == osd_sb(dev));
+	osd_small_dir_readahead(dev, fid, inode);
 
 	obj->oo_compat_dot_created = 1;
 	obj->oo_compat_dotdot_created = 1;
@@ -721,16 +777,42 @@ static int osd_param_is_not_sane(const struct osd_device *dev,
 	return oh->ot_credits > osd_journal(dev)->j_max_transaction_buffers;
 }
 
+/*
+ * The commit callbacks of the transactions are not run from the journal
+ * thread, which would become the bottleneck of the whole server, but
+ * gathered per CPT, where the transactions stopped, and run by a thread per
+ * CPT a batch at a time. The callbacks coalesced through
+ * dt_trans_transno_add() run once per batch.
+ */
+#define OSD_COMMIT_QUEUES_MAX	16
+
+struct osd_commit_queue {
+	spinlock_t		ocq_lock;
+	/* committed osd_thandles */
+	cfs_list_t		ocq_list;
+	/* how many were queued, how many of them were run */
+	__u64			ocq_queued;
+	__u64			ocq_done;
+	struct ptlrpc_thread	ocq_thread;
+	int			ocq_cpt;
+};
+
+static struct osd_commit_queue	*osd_commit_queues;
+static int			 osd_commit_queue_count;
+static cfs_waitq_t		 osd_commit_waitq;
+/* commit callbacks which may still be using osd_commit_queues */
+static cfs_atomic_t		 osd_commit_inflight = CFS_ATOMIC_INIT(0);
+
 /*
  * Concurrency: shouldn't matter.
  */
-static void osd_trans_commit_cb(struct super_block *sb,
-                                struct ldiskfs_journal_cb_entry *jcb, int error)
+static void osd_trans_commit_run(struct osd_thandle *oh, cfs_list_t *batch)
 {
-        struct osd_thandle *oh = container_of0(jcb, struct osd_thandle, ot_jcb);
         struct thandle     *th  = &oh->ot_super;
         struct lu_device   *lud = &th->th_dev->dd_lu_dev;
         struct dt_txn_commit_cb *dcb, *tmp;
+	int		    error = oh->ot_commit_error;
+	int		    i;
 
         LASSERT(oh->ot_handle == NULL);
 
@@ -748,6 +830,11 @@ static void osd_trans_commit_cb(struct super_block *sb,
 		dcb->dcb_func(NULL, th, dcb, error);
 	}
 
+	for (i = 0; i < oh->ot_transno_cnt; i++)
+		dt_txn_transno_commit(oh->ot_transno[i].ott_dtct,
+				      oh->ot_transno[i].ott_transno,
+				      oh->ot_transno[i].ott_count, batch);
+
 	lu_ref_del_at(&lud->ld_reference, &oh->ot_dev_link, "osd-tx", th);
         lu_device_put(lud);
         th->th_dev = NULL;
@@ -757,6 +844,221 @@ static void osd_trans_commit_cb(struct super_block *sb,
         OBD_FREE_PTR(oh);
 }
 
+static void osd_trans_commit_cb(struct super_block *sb,
+                                struct ldiskfs_journal_cb_entry *jcb, int error)
+{
+        struct osd_thandle	*oh = container_of0(jcb, struct osd_thandle,
+						    ot_jcb);
+	struct osd_commit_queue *ocq;
+	CFS_LIST_HEAD		(batch);
+	bool			 wakeup;
+	int			 count;
+
+	oh->ot_commit_error = error;
+
+	/* pairs with the barrier in osd_commit_threads_stop() */
+	cfs_atomic_inc(&osd_commit_inflight);
+	smp_mb__after_atomic_inc();
+	count = ACCESS_ONCE(osd_commit_queue_count);
+	if (count == 0) {
+		osd_trans_commit_run(oh, &batch);
+		dt_txn_transno_run(&batch);
+		goto out;
+	}
+
+	ocq = &osd_commit_queues[oh->ot_cpt % count];
+	spin_lock(&ocq->ocq_lock);
+	wakeup = cfs_list_empty(&ocq->ocq_list);
+	cfs_list_add_tail(&oh->ot_commit_list, &ocq->ocq_list);
+	ocq->ocq_queued++;
+	spin_unlock(&ocq->ocq_lock);
+
+	/* the thread takes the whole queue at once */
+	if (wakeup)
+		cfs_waitq_signal(&ocq->ocq_thread.t_ctl_waitq);
+out:
+	if (cfs_atomic_dec_and_test(&osd_commit_inflight))
+		cfs_waitq_broadcast(&osd_commit_waitq);
+}
+
+static int osd_commit_main(void *args)
+{
+	struct osd_commit_queue *ocq	= args;
+	struct ptlrpc_thread	*thread = &ocq->ocq_thread;
+	struct osd_thandle	*oh;
+	struct l_wait_info	 lwi	= { 0 };
+	CFS_LIST_HEAD		(items);
+	CFS_LIST_HEAD		(batch);
+	__u64			 queued;
+	int			 rc;
+
+	rc = cfs_cpt_bind(cfs_cpt_table, ocq->ocq_cpt);
+	if (rc != 0)
+		CWARN("fail to bind commit thread on CPT %d, rc = %d\n",
+		      ocq->ocq_cpt, rc);
+
+	spin_lock(&ocq->ocq_lock);
+	thread_set_flags(thread, SVC_RUNNING);
+	spin_unlock(&ocq->ocq_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+	while (1) {
+		l_wait_event(thread->t_ctl_waitq,
+			     !cfs_list_empty(&ocq->ocq_list) ||
+			     !thread_is_running(thread),
+			     &lwi);
+
+		spin_lock(&ocq->ocq_lock);
+		cfs_list_splice_init(&ocq->ocq_list, &items);
+		queued = ocq->ocq_queued;
+		spin_unlock(&ocq->ocq_lock);
+
+		if (cfs_list_empty(&items)) {
+			if (!thread_is_running(thread))
+				break;
+			continue;
+		}
+
+		while (!cfs_list_empty(&items)) {
+			oh = cfs_list_entry(items.next, struct osd_thandle,
+					    ot_commit_list);
+			cfs_list_del_init(&oh->ot_commit_list);
+			osd_trans_commit_run(oh, &batch);
+		}
+		dt_txn_transno_run(&batch);
+
+		spin_lock(&ocq->ocq_lock);
+		ocq->ocq_done = queued;
+		spin_unlock(&ocq->ocq_lock);
+		cfs_waitq_broadcast(&osd_commit_waitq);
+	}
+
+	spin_lock(&ocq->ocq_lock);
+	thread_set_flags(thread, SVC_STOPPED);
+	spin_unlock(&ocq->ocq_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	return 0;
+}
+
+static bool osd_commit_done(__u64 *queued)
+{
+	struct osd_commit_queue *ocq;
+	bool			 done = true;
+	int			 i;
+
+	for (i = 0; i < osd_commit_queue_count && done; i++) {
+		ocq = &osd_commit_queues[i];
+		spin_lock(&ocq->ocq_lock);
+		done = ocq->ocq_done >= queued[i];
+		spin_unlock(&ocq->ocq_lock);
+	}
+	return done;
+}
+
+/*
+ * Wait for the callbacks of the transactions committed so far to be run, so
+ * that the callers of dt_sync() see their effects, and that the device can
+ * go away.
+ */
+static void osd_commit_flush(void)
+{
+	struct l_wait_info	 lwi = { 0 };
+	__u64			 queued[OSD_COMMIT_QUEUES_MAX];
+	int			 i;
+
+	for (i = 0; i < osd_commit_queue_count; i++) {
+		spin_lock(&osd_commit_queues[i].ocq_lock);
+		queued[i] = osd_commit_queues[i].ocq_queued;
+		spin_unlock(&osd_commit_queues[i].ocq_lock);
+	}
+
+	l_wait_event(osd_commit_waitq, osd_commit_done(queued), &lwi);
+}
+
+static void osd_commit_threads_stop(void)
+{
+	struct osd_commit_queue *ocq;
+	struct l_wait_info	 lwi = { 0 };
+	int			 count = osd_commit_queue_count;
+	int			 i;
+
+	if (osd_commit_queues == NULL)
+		return;
+
+	/* the commit callbacks run from the journal thread from now on, wait
+	 * for those which picked a queue already to be done with it */
+	osd_commit_queue_count = 0;
+	smp_mb();
+	l_wait_event(osd_commit_waitq,
+		     cfs_atomic_read(&osd_commit_inflight) == 0, &lwi);
+
+	/* the threads run what is left in their queues before stopping */
+	for (i = 0; i < count; i++) {
+		ocq = &osd_commit_queues[i];
+		if (!thread_is_running(&ocq->ocq_thread))
+			continue;
+
+		spin_lock(&ocq->ocq_lock);
+		thread_set_flags(&ocq->ocq_thread, SVC_STOPPING);
+		spin_unlock(&ocq->ocq_lock);
+		cfs_waitq_broadcast(&ocq->ocq_thread.t_ctl_waitq);
+		l_wait_event(ocq->ocq_thread.t_ctl_waitq,
+			     thread_is_stopped(&ocq->ocq_thread),
+			     &lwi);
+		LASSERT(cfs_list_empty(&ocq->ocq_list));
+	}
+
+	OBD_FREE(osd_commit_queues, OSD_COMMIT_QUEUES_MAX * sizeof(*ocq));
+	osd_commit_queues = NULL;
+}
+
+static void osd_commit_threads_start(void)
+{
+	struct osd_commit_queue *ocq;
+	struct l_wait_info	 lwi	= { 0 };
+	cfs_task_t		*task;
+	int			 ncpt	= cfs_cpt_number(cfs_cpt_table);
+	int			 count;
+	int			 i;
+
+	cfs_waitq_init(&osd_commit_waitq);
+	if (osd_commit_threads <= 0)
+		return;
+
+	count = min(ncpt * osd_commit_threads, OSD_COMMIT_QUEUES_MAX);
+	OBD_ALLOC(osd_commit_queues, OSD_COMMIT_QUEUES_MAX * sizeof(*ocq));
+	if (osd_commit_queues == NULL)
+		return;
+
+	for (i = 0; i < count; i++) {
+		ocq = &osd_commit_queues[i];
+		ocq->ocq_cpt = i % ncpt;
+		spin_lock_init(&ocq->ocq_lock);
+		CFS_INIT_LIST_HEAD(&ocq->ocq_list);
+		cfs_waitq_init(&ocq->ocq_thread.t_ctl_waitq);
+		thread_set_flags(&ocq->ocq_thread, 0);
+
+		task = kthread_run(osd_commit_main, ocq, "osd_commit_%02d", i);
+		if (IS_ERR(task)) {
+			CERROR("cannot start commit thread %d, rc = %ld\n",
+			       i, PTR_ERR(task));
+			break;
+		}
+
+		l_wait_event(ocq->ocq_thread.t_ctl_waitq,
+			     thread_is_running(&ocq->ocq_thread) ||
+			     thread_is_stopped(&ocq->ocq_thread),
+			     &lwi);
+		if (!thread_is_running(&ocq->ocq_thread))
+			break;
+	}
+
+	/* the transactions queue on CPT % count */
+	osd_commit_queue_count = i;
+	if (i == 0)
+		osd_commit_threads_stop();
+}
+
 static struct thandle *osd_trans_create(const struct lu_env *env,
                                         struct dt_device *d)
 {
@@ -781,6 +1083,8 @@ static struct thandle *osd_trans_create(const struct lu_env *env,
                 oh->ot_credits = 0;
                 oti->oti_dev = osd_dt_dev(d);
                 CFS_INIT_LIST_HEAD(&oh->ot_dcb_list);
+		CFS_INIT_LIST_HEAD(&oh->ot_commit_list);
+		oh->ot_transno_cnt = 0;
                 osd_th_alloced(oh);
 
 		memset(oti->oti_declare_ops, 0,
@@ -925,6 +1229,7 @@ static int osd_trans_stop(const struct lu_env *env, struct thandle *th)
                  */
                 ldiskfs_journal_callback_add(hdl, osd_trans_commit_cb,
                                          &oh->ot_jcb);
+		oh->ot_cpt = cfs_cpt_current(cfs_cpt_table, 0);
 
                 LASSERT(oti->oti_txns == 1);
                 oti->oti_txns--;
@@ -973,6 +1278,33 @@ static int osd_trans_cb_add(struct thandle *th, struct dt_txn_commit_cb *dcb)
 	return 0;
 }
 
+static int osd_trans_transno_add(struct thandle *th,
+				 struct dt_txn_commit_transno *dtct,
+				 __u64 transno)
+{
+	struct osd_thandle *oh = container_of0(th, struct osd_thandle,
+					       ot_super);
+	int		    i;
+
+	for (i = 0; i < oh->ot_transno_cnt; i++) {
+		if (oh->ot_transno[i].ott_dtct == dtct) {
+			if (transno > oh->ot_transno[i].ott_transno)
+				oh->ot_transno[i].ott_transno = transno;
+			oh->ot_transno[i].ott_count++;
+			return 0;
+		}
+	}
+
+	if (oh->ot_transno_cnt == OSD_TRANSNO_CB_MAX)
+		return -EOPNOTSUPP;
+
+	oh->ot_transno[i].ott_dtct = dtct;
+	oh->ot_transno[i].ott_transno = transno;
+	oh->ot_transno[i].ott_count = 1;
+	oh->ot_transno_cnt++;
+	return 0;
+}
+
 /*
  * Called just before object is freed. Releases all resources except for
  * object itself (that is released by osd_object_free()).
@@ -1145,8 +1477,12 @@ static void osd_conf_get(const struct lu_env *env,
  */
 static int osd_sync(const struct lu_env *env, struct dt_device *d)
 {
+	int rc;
+
 	CDEBUG(D_HA, "syncing OSD %s\n", LUSTRE_OSD_LDISKFS_NAME);
-        return ldiskfs_force_commit(osd_sb(osd_dt_dev(d)));
+	rc = ldiskfs_force_commit(osd_sb(osd_dt_dev(d)));
+	osd_commit_flush();
+	return rc;
 }
 
 /**
@@ -1284,6 +1620,7 @@ static const struct dt_device_operations osd_dt_ops = {
         .dt_trans_start    = osd_trans_start,
         .dt_trans_stop     = osd_trans_stop,
         .dt_trans_cb_add   = osd_trans_cb_add,
+	.dt_trans_transno_add = osd_trans_transno_add,
         .dt_conf_get       = osd_conf_get,
         .dt_sync           = osd_sync,
         .dt_ro             = osd_ro,
@@ -3316,6 +3653,70 @@ static int osd_remote_fid(const struct lu_env *env, struct osd_device *osd,
 	RETURN(ss->ss_node_id != range->lsr_index);
 }
 
+/**
+ * Take the pdirops lock of the directory \a obj, accounting the time waited
+ * for it in the dir_stats of the device.
+ */
+static void osd_htree_lock(struct htree_lock *hlock, struct osd_object *obj,
+			   struct inode *dir, unsigned flags)
+{
+	struct timeval start;
+	struct timeval end;
+
+	cfs_gettimeofday(&start);
+	ldiskfs_htree_lock(hlock, obj->oo_hl_head, dir, flags);
+	cfs_gettimeofday(&end);
+	lprocfs_oh_tally_log2(&osd_obj2dev(obj)->od_dir_stats[OSD_DIR_LOCK_WAIT],
+			      cfs_timeval_sub(&end, &start, NULL));
+}
+
+/* the htree index levels of \a dir, 0 if it is not indexed */
+static int osd_dir_levels(struct inode *dir)
+{
+	struct ldiskfs_dir_entry_2	*de;
+	struct buffer_head		*bh;
+	int				 levels;
+	int				 rc;
+
+	if (!(LDISKFS_I(dir)->i_flags & LDISKFS_INDEX_FL))
+		return 0;
+
+	bh = ldiskfs_bread(NULL, dir, 0, 0, &rc);
+	if (bh == NULL)
+		return 0;
+
+	/* the dx_root_info follows the "." and ".." entries */
+	de = (struct ldiskfs_dir_entry_2 *)bh->b_data;
+	de = (void *)de + LDISKFS_DIR_REC_LEN(de);
+	de = (void *)de + LDISKFS_DIR_REC_LEN(de);
+	levels = ((struct dx_root_info *)de)->indirect_levels + 1;
+	brelse(bh);
+
+	return levels;
+}
+
+/**
+ * Account an insert into the directory \a pobj in the dir_stats: the size
+ * and the depth of the directories the names go to. The depth is only read
+ * again once the directory grew, since a level is only added by a split.
+ */
+static void osd_dir_stats_insert(struct osd_object *pobj)
+{
+	struct osd_device	*osd = osd_obj2dev(pobj);
+	struct inode		*dir = pobj->oo_inode;
+	loff_t			 size = i_size_read(dir);
+
+	if (size != pobj->oo_dir_size) {
+		pobj->oo_dir_levels = osd_dir_levels(dir);
+		pobj->oo_dir_size = size;
+	}
+
+	lprocfs_oh_tally_log2(&osd->od_dir_stats[OSD_DIR_BLOCKS],
+			      size >> dir->i_blkbits);
+	lprocfs_oh_tally(&osd->od_dir_stats[OSD_DIR_LEVELS],
+			 pobj->oo_dir_levels);
+}
+
 /**
  * Index delete function for interoperability mode (b11826).
  * It will remove the directory entry added by osd_index_ea_insert().
@@ -3362,7 +3763,7 @@ static int osd_index_ea_delete(const struct lu_env *env, struct dt_object *dt,
 
         if (obj->oo_hl_head != NULL) {
                 hlock = osd_oti_get(env)->oti_hlock;
-                ldiskfs_htree_lock(hlock, obj->oo_hl_head,
+                osd_htree_lock(hlock, obj,
                                    dir, LDISKFS_HLOCK_DEL);
         } else {
 		down_write(&obj->oo_ext_idx_sem);
@@ -3734,7 +4135,7 @@ static int osd_ea_add_rec(const struct lu_env *env, struct osd_object *pobj,
         if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' &&
                                                    name[2] =='\0'))) {
                 if (hlock != NULL) {
-                        ldiskfs_htree_lock(hlock, pobj->oo_hl_head,
+                        osd_htree_lock(hlock, pobj,
                                            pobj->oo_inode, 0);
                 } else {
 			down_write(&pobj->oo_ext_idx_sem);
@@ -3744,7 +4145,7 @@ static int osd_ea_add_rec(const struct lu_env *env, struct osd_object *pobj,
                                         fid, th);
         } else {
                 if (hlock != NULL) {
-                        ldiskfs_htree_lock(hlock, pobj->oo_hl_head,
+                        osd_htree_lock(hlock, pobj,
                                            pobj->oo_inode, LDISKFS_HLOCK_ADD);
                 } else {
 			down_write(&pobj->oo_ext_idx_sem);
@@ -3762,6 +4163,8 @@ static int osd_ea_add_rec(const struct lu_env *env, struct osd_object *pobj,
 			rc = __osd_ea_add_rec(info, pobj, cinode, name, fid,
 					      hlock, th);
 		}
+		if (rc == 0)
+			osd_dir_stats_insert(pobj);
         }
         if (hlock != NULL)
                 ldiskfs_htree_unlock(hlock);
@@ -3786,6 +4189,8 @@ osd_consistency_check(struct osd_thread_info *oti, struct osd_device *dev,
 		RETURN_EXIT;
 
 again:
+	/* the mapping in the OI is what is being checked */
+	osd_oi_cache_del(dev, fid);
 	rc = osd_oi_lookup(oti, dev, fid, id, true);
 	if (rc != 0 && rc != -ENOENT)
 		RETURN_EXIT;
@@ -3884,7 +4289,7 @@ static int osd_ea_lookup_rec(const struct lu_env *env, struct osd_object *obj,
 
         if (obj->oo_hl_head != NULL) {
                 hlock = osd_oti_get(env)->oti_hlock;
-                ldiskfs_htree_lock(hlock, obj->oo_hl_head,
+                osd_htree_lock(hlock, obj,
                                    dir, LDISKFS_HLOCK_LOOKUP);
         } else {
 		down_read(&obj->oo_ext_idx_sem);
@@ -4617,7 +5022,7 @@ static int osd_ldiskfs_it_fill(const struct lu_env *env,
 
         if (obj->oo_hl_head != NULL) {
                 hlock = osd_oti_get(env)->oti_hlock;
-                ldiskfs_htree_lock(hlock, obj->oo_hl_head,
+                osd_htree_lock(hlock, obj,
                                    inode, LDISKFS_HLOCK_READDIR);
         } else {
 		down_read(&obj->oo_ext_idx_sem);
@@ -4902,14 +5307,14 @@ again:
 			 * We need to prevent others access such name entry
 			 * during the delete + insert. Neither HLOCK_ADD nor
 			 * HLOCK_DEL cannot guarantee the atomicity. */
-			ldiskfs_htree_lock(hlock, obj->oo_hl_head, dir, 0);
+			osd_htree_lock(hlock, obj, dir, 0);
 		} else {
 			down_write(&obj->oo_ext_idx_sem);
 		}
 	} else {
 		if (obj->oo_hl_head != NULL) {
 			hlock = osd_oti_get(env)->oti_hlock;
-			ldiskfs_htree_lock(hlock, obj->oo_hl_head, dir,
+			osd_htree_lock(hlock, obj, dir,
 					   LDISKFS_HLOCK_LOOKUP);
 		} else {
 			down_read(&obj->oo_ext_idx_sem);
@@ -5272,6 +5677,7 @@ static void osd_key_fini(const struct lu_context *ctx,
 	OBD_FREE(info->oti_it_ea_buf, OSD_IT_EA_BUFSIZE);
 	lu_buf_free(&info->oti_iobuf.dr_pg_buf);
 	lu_buf_free(&info->oti_iobuf.dr_bl_buf);
+	lu_buf_free(&info->oti_iobuf.dr_seg_buf);
 	OBD_FREE_PTR(info);
 }
 
@@ -5450,6 +5856,8 @@ static struct lu_device *osd_device_fini(const struct lu_env *env,
 	osd_scrub_cleanup(env, o);
 	osd_obj_map_fini(o);
 	osd_umount(env, o);
+	/* the journal committed the last transactions on umount */
+	osd_commit_flush();
 
 	RETURN(NULL);
 }
@@ -5474,6 +5882,7 @@ static int osd_device_init0(const struct lu_env *env,
 	o->od_dt_dev.dd_ops = &osd_dt_ops;
 
 	spin_lock_init(&o->od_osfs_lock);
+	spin_lock_init(&o->od_stream_lock);
 	mutex_init(&o->od_otable_mutex);
 	o->od_osfs_age = cfs_time_shift_64(-1000);
 
@@ -5484,6 +5893,8 @@ static int osd_device_init0(const struct lu_env *env,
 	o->od_read_cache = 1;
 	o->od_writethrough_cache = 1;
 	o->od_readcache_max_filesize = OSD_MAX_CACHE_SIZE;
+	o->od_stream_region_mb = OSD_STREAM_REGION_MB;
+	o->od_small_dir_blocks = OSD_SMALL_DIR_BLOCKS;
 
 	rc = osd_mount(env, o, cfg);
 	if (rc)
@@ -5750,17 +6161,29 @@ static struct obd_ops osd_obd_device_ops = {
 
 static int __init osd_mod_init(void)
 {
-        struct lprocfs_static_vars lvars;
+	struct lprocfs_static_vars lvars;
+	int rc;
+
+	rc = osd_oi_mod_init();
+	if (rc != 0)
+		return rc;
 
-        osd_oi_mod_init();
+	osd_commit_threads_start();
         lprocfs_osd_init_vars(&lvars);
-        return class_register_type(&osd_obd_device_ops, NULL, lvars.module_vars,
-				   LUSTRE_OSD_LDISKFS_NAME, &osd_device_type);
+	rc = class_register_type(&osd_obd_device_ops, NULL, lvars.module_vars,
+				 LUSTRE_OSD_LDISKFS_NAME, &osd_device_type);
+	if (rc != 0) {
+		osd_commit_threads_stop();
+		osd_oi_mod_exit();
+	}
+	return rc;
 }
 
 static void __exit osd_mod_exit(void)
 {
 	class_unregister_type(LUSTRE_OSD_LDISKFS_NAME);
+	osd_commit_threads_stop();
+	osd_oi_mod_exit();
 }
 
 MODULE_AUTHOR("Sun Microsystems, Inc. <http://www.lustre.org/>");
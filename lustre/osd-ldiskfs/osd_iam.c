@@ -485,6 +485,45 @@ static int iam_leaf_load(struct iam_path *path)
         return err;
 }
 
+/*
+ * Leaves read ahead by iterators: when the leaf under the iterator is the
+ * first of a window of IAM_LEAF_READAHEAD entries of its index node, the
+ * leaves of the next window are read asynchronously, so that a full scan
+ * of the container does not wait for each of its leaves in turn.
+ */
+enum {
+	IAM_LEAF_READAHEAD = 16
+};
+
+static void iam_leaf_readahead(struct iam_path *path)
+{
+	struct iam_frame	*frame = path->ip_frame;
+	struct inode		*inode = path->ip_container->ic_object;
+	struct iam_entry	*entry;
+	sector_t		 block;
+	int			 count;
+	int			 pos;
+	int			 i;
+	sector_t (*fs_bmap)(struct address_space *, sector_t);
+
+	fs_bmap = inode->i_mapping->a_ops->bmap;
+	if (fs_bmap == NULL || frame == NULL || frame->entries == NULL ||
+	    frame->at == NULL)
+		return;
+
+	count = dx_get_count(frame->entries);
+	pos = iam_entry_diff(path, frame->at, frame->entries);
+	if (pos % IAM_LEAF_READAHEAD != 0)
+		return;
+
+	for (i = 1; i <= IAM_LEAF_READAHEAD && pos + i < count; i++) {
+		entry = iam_entry_shift(path, frame->at, i);
+		block = fs_bmap(inode->i_mapping, dx_get_block(path, entry));
+		if (block != 0)
+			sb_breadahead(inode->i_sb, block);
+	}
+}
+
 static void iam_unlock_htree(struct iam_container *ic,
 			     struct dynlock_handle *lh)
 {
@@ -1109,6 +1148,9 @@ static int __iam_it_get(struct iam_iterator *it, int index)
         if (result >= 0) {
                 int collision;
 
+		if (it->ii_flags & IAM_IT_MOVE)
+			iam_leaf_readahead(&it->ii_path);
+
                 collision = result & IAM_LOOKUP_LAST;
                 switch (result & ~IAM_LOOKUP_LAST) {
                 case IAM_LOOKUP_EXACT:
@@ -1534,8 +1576,10 @@ int iam_it_next(struct iam_iterator *it)
                                         iam_leaf_fini(leaf);
                                         leaf->il_lock = lh;
                                         result = iam_leaf_load(path);
-                                        if (result == 0)
-                                                iam_leaf_start(leaf);
+					if (result == 0) {
+						iam_leaf_start(leaf);
+						iam_leaf_readahead(path);
+					}
                                 } else
                                         result = -ENOMEM;
                         } else if (result == 0)
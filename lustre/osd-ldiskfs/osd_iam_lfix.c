@@ -42,6 +42,7 @@
 
 #include <linux/types.h>
 #include "osd_internal.h"
+#include "osd_iam_search.h"
 
 /*
  * Leaf operations.
@@ -78,7 +79,7 @@ static inline int lfix_keycmp(const struct iam_container *c,
                               const struct iam_key *k1,
                               const struct iam_key *k2)
 {
-        return memcmp(k1, k2, c->ic_descr->id_key_size);
+	return iam_keycmp_words(k1, k2, c->ic_descr->id_key_size);
 }
 
 static struct iam_leaf_head *iam_get_head(const struct iam_leaf *l)
@@ -270,10 +271,10 @@ static void lfix_print(struct iam_leaf *leaf)
 
 static int iam_lfix_lookup(struct iam_leaf *l, const struct iam_key *k)
 {
-        struct iam_lentry *p, *q, *m, *t;
         struct iam_container *c;
         int count;
         int result;
+	int pos;
 
         count = lentry_count_get(l);
         if (count == 0)
@@ -282,42 +283,17 @@ static int iam_lfix_lookup(struct iam_leaf *l, const struct iam_key *k)
         result = IAM_LOOKUP_OK;
         c = iam_leaf_container(l);
 
-        p = l->il_entries;
-        q = iam_lfix_shift(l, p, count - 1);
-        if (lfix_keycmp(c, k, iam_leaf_key_at(p)) < 0) {
-                /*
-                 * @k is less than the least key in the leaf
-                 */
-                l->il_at = p;
-                result = IAM_LOOKUP_BEFORE;
-        } else if (lfix_keycmp(c, iam_leaf_key_at(q), k) <= 0) {
-                l->il_at = q;
-        } else {
-                /*
-                 * EWD1293
-                 */
-                while (iam_lfix_shift(l, p, 1) != q) {
-                        m = iam_lfix_shift(l, p, iam_lfix_diff(l, q, p) / 2);
-                        assert_corr(p < m && m < q);
-                        if (lfix_keycmp(c, iam_leaf_key_at(m), k) <= 0)
-                                p = m;
-                        else
-                                q = m;
-                }
-                assert_corr(lfix_keycmp(c, iam_leaf_key_at(p), k) <= 0 &&
-                            lfix_keycmp(c, k, iam_leaf_key_at(q)) < 0);
-                /*
-                 * skip over records with duplicate keys.
-                 */
-                while (p > l->il_entries) {
-                        t = iam_lfix_shift(l, p, -1);
-                        if (lfix_keycmp(c, iam_leaf_key_at(t), k) == 0)
-                                p = t;
-                        else
-                                break;
-                }
-                l->il_at = p;
-        }
+	pos = iam_lfix_search(l->il_entries, count, iam_lfix_entry_size(l),
+			      c->ic_descr->id_key_size, k);
+	if (pos < 0) {
+		/*
+		 * @k is less than the least key in the leaf
+		 */
+		l->il_at = l->il_entries;
+		result = IAM_LOOKUP_BEFORE;
+	} else {
+		l->il_at = iam_lfix_shift(l, l->il_entries, pos);
+	}
         assert_corr(iam_leaf_at_rec(l));
 
         if (lfix_keycmp(c, iam_leaf_key_at(l->il_at), k) == 0)
@@ -655,7 +631,7 @@ static int iam_lfix_ikeycmp(const struct iam_container *c,
                             const struct iam_ikey *k1,
                             const struct iam_ikey *k2)
 {
-        return memcmp(k1, k2, c->ic_descr->id_ikey_size);
+	return iam_keycmp_words(k1, k2, c->ic_descr->id_ikey_size);
 }
 
 static struct iam_path_descr *iam_lfix_ipd_alloc(const struct iam_container *c,
@@ -0,0 +1,120 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/osd-ldiskfs/osd_iam_search.h
+ *
+ * Key compare and search of the sorted arrays of fixed size entries in the
+ * leaves and index nodes of IAM lfix containers, such as the OI files. Keys
+ * are compared a 64-bit word at a time rather than byte by byte, and the
+ * binary search ends with a linear scan of a few entries. Also built in
+ * userspace by lustre/tests/iam_search_test.
+ */
+
+#ifndef _OSD_IAM_SEARCH_H
+#define _OSD_IAM_SEARCH_H
+
+#include <libcfs/libcfs.h>
+
+/* entries left to the linear scan which ends the binary search */
+#define IAM_SEARCH_SCAN		8
+
+/**
+ * Compare the keys \a k1 and \a k2 of \a size bytes in the order memcmp()
+ * does, a big-endian word at a time.
+ */
+static inline int iam_keycmp_words(const void *k1, const void *k2, int size)
+{
+	__u64 w1;
+	__u64 w2;
+	int   i;
+
+	for (i = 0; i + sizeof(w1) <= size; i += sizeof(w1)) {
+		/* constant size copies are plain, possibly unaligned loads */
+		memcpy(&w1, k1 + i, sizeof(w1));
+		memcpy(&w2, k2 + i, sizeof(w2));
+		if (w1 != w2) {
+			w1 = be64_to_cpu(w1);
+			w2 = be64_to_cpu(w2);
+			return w1 < w2 ? -1 : 1;
+		}
+	}
+	return i < size ? memcmp(k1 + i, k2 + i, size - i) : 0;
+}
+
+/**
+ * Search the \a count entries at \a entries, each of \a esize bytes and
+ * starting with a key of \a ksize bytes, sorted by their keys.
+ *
+ * \retval -1	\a key is below the first entry
+ * \retval i	otherwise: the last entry when \a key is not below it, or
+ *		else the first of the entries with \a key, or else the last
+ *		entry below \a key
+ */
+static inline int iam_lfix_search(const void *entries, int count, int esize,
+				  int ksize, const void *key)
+{
+	int lo = 0;
+	int hi = count - 1;
+	int m;
+
+#define IAM_SEARCH_KEY(i) (entries + (i) * esize)
+
+	if (iam_keycmp_words(key, IAM_SEARCH_KEY(lo), ksize) < 0)
+		return -1;
+	if (iam_keycmp_words(IAM_SEARCH_KEY(hi), key, ksize) <= 0)
+		return hi;
+
+	/* key(lo) <= key < key(hi) */
+	while (hi - lo > IAM_SEARCH_SCAN) {
+		m = lo + (hi - lo) / 2;
+		/* the next probe is one of these two */
+		prefetch(IAM_SEARCH_KEY(lo + (m - lo) / 2));
+		prefetch(IAM_SEARCH_KEY(m + (hi - m) / 2));
+		if (iam_keycmp_words(IAM_SEARCH_KEY(m), key, ksize) <= 0)
+			lo = m;
+		else
+			hi = m;
+	}
+	while (lo + 1 < hi &&
+	       iam_keycmp_words(IAM_SEARCH_KEY(lo + 1), key, ksize) <= 0)
+		lo++;
+
+	/* skip back over the entries with duplicate keys */
+	while (lo > 0 &&
+	       iam_keycmp_words(IAM_SEARCH_KEY(lo - 1), key, ksize) == 0)
+		lo--;
+
+#undef IAM_SEARCH_KEY
+	return lo;
+}
+
+#endif /* _OSD_IAM_SEARCH_H */
@@ -112,6 +112,15 @@ struct osd_oi {
 
 extern const int osd_dto_credits_noquota[];
 
+/* The sequential writes to a data object, see osd_stream_goal() */
+struct osd_stream {
+	loff_t			oss_end;	/* where the last write ended */
+	__u64			oss_rate;	/* bytes/sec */
+	cfs_time_t		oss_time;	/* of the last write */
+	/* the logical block past the blocks reserved for the stream */
+	unsigned long		oss_resv_end;
+};
+
 struct osd_object {
         struct dt_object        oo_dt;
         /**
@@ -126,6 +135,12 @@ struct osd_object {
          * to protect index ops.
          */
         struct htree_lock_head *oo_hl_head;
+	/**
+	 * htree index levels of the directory, read from its root block
+	 * when its size was oo_dir_size, for the dir_stats
+	 */
+	loff_t			oo_dir_size;
+	int			oo_dir_levels;
 	struct rw_semaphore	oo_ext_idx_sem;
 	struct rw_semaphore	oo_sem;
 	struct osd_directory	*oo_dir;
@@ -140,6 +155,8 @@ struct osd_object {
         int                     oo_compat_dotdot_created;
 
         const struct lu_env    *oo_owner;
+	/** write stream of a data object, under oo_guard */
+	struct osd_stream	oo_stream;
 #ifdef CONFIG_LOCKDEP
         struct lockdep_map      oo_dep_map;
 #endif
@@ -225,6 +242,14 @@ struct osd_otable_it {
 
 extern const int osd_dto_credits_noquota[];
 
+/* histograms of the dir_stats proc file */
+enum {
+	OSD_DIR_BLOCKS,		/* directory size in blocks, per insert */
+	OSD_DIR_LEVELS,		/* htree index levels, per insert */
+	OSD_DIR_LOCK_WAIT,	/* usecs waiting for the htree lock */
+	OSD_DIR_LAST,
+};
+
 /*
  * osd device.
  */
@@ -237,6 +262,8 @@ struct osd_device {
         struct osd_oi           **od_oi_table;
         /* total number of OI containers */
         int                       od_oi_count;
+	/* FID to inode cache in front of the OI */
+	struct osd_oi_cache	 *od_oi_cache;
         /*
          * Fid Capability
          */
@@ -273,9 +300,23 @@ struct osd_device {
         int                       od_writethrough_cache;
 
         struct brw_stats          od_brw_stats;
+	struct obd_histogram	  od_dir_stats[OSD_DIR_LAST];
         cfs_atomic_t              od_r_in_flight;
         cfs_atomic_t              od_w_in_flight;
 
+	/* The regions of the disk reserved for the write streams are handed
+	 * out from od_stream_cursor on, none larger than od_stream_region_mb,
+	 * under od_stream_lock. */
+	spinlock_t		  od_stream_lock;
+	unsigned long		  od_stream_cursor;
+	unsigned int		  od_stream_region_mb;
+	__u64			  od_stream_regions;
+
+	/* size in blocks up to which the blocks of the directories, of the
+	 * symlinks and of the Data-on-MDT files are read ahead when their
+	 * inode is looked up */
+	unsigned int		  od_small_dir_blocks;
+
 	struct mutex		  od_otable_mutex;
 	struct osd_otable_it	 *od_otable_it;
 	struct osd_scrub	  od_scrub;
@@ -317,11 +358,24 @@ enum {
 	OSD_OT_MAX		= 11
 };
 
+/* coalesced commit callbacks a transaction can be registered to */
+#define OSD_TRANSNO_CB_MAX	2
+
 struct osd_thandle {
         struct thandle          ot_super;
         handle_t               *ot_handle;
         struct ldiskfs_journal_cb_entry ot_jcb;
         cfs_list_t              ot_dcb_list;
+	struct {
+		struct dt_txn_commit_transno	*ott_dtct;
+		__u64				 ott_transno;
+		int				 ott_count;
+	}			ot_transno[OSD_TRANSNO_CB_MAX];
+	int			ot_transno_cnt;
+	/* in the commit queue of CPT ot_cpt, once committed */
+	cfs_list_t		ot_commit_list;
+	int			ot_commit_error;
+	int			ot_cpt;
 	/* Link to the device, for debugging. */
 	struct lu_ref_link      ot_dev_link;
         unsigned short          ot_credits;
@@ -370,6 +424,7 @@ enum {
         LPROC_OSD_CACHE_ACCESS  = 4,
         LPROC_OSD_CACHE_HIT     = 5,
         LPROC_OSD_CACHE_MISS    = 6,
+	LPROC_OSD_SMALL_DIR_RA	= 7,
 
 #if OSD_THANDLE_STATS
         LPROC_OSD_THANDLE_STARTING,
@@ -459,6 +514,15 @@ struct osd_it_quota {
 
 #define MAX_BLOCKS_PER_PAGE (PAGE_CACHE_SIZE / 512)
 
+/* A run of blocks contiguous on disk within a page of an osd_iobuf, the
+ * unit osd_do_bio() sorts by disk position and builds the bios from. */
+struct osd_iobuf_seg {
+	sector_t	   obs_sector;
+	int		   obs_page;	/* index in osd_iobuf::dr_pages */
+	unsigned int	   obs_offset;	/* in the page, bytes */
+	unsigned int	   obs_len;	/* bytes */
+};
+
 struct osd_iobuf {
 	cfs_waitq_t        dr_wait;
 	cfs_atomic_t       dr_numreqs;  /* number of reqs being processed */
@@ -473,6 +537,9 @@ struct osd_iobuf {
 	struct page      **dr_pages;
 	struct lu_buf	   dr_bl_buf;
 	unsigned long     *dr_blocks;
+	struct lu_buf	   dr_seg_buf;
+	struct osd_iobuf_seg *dr_segs;
+	unsigned long      dr_bytes;	/* submitted to the disk */
 	unsigned long      dr_start_time;
 	unsigned long      dr_elapsed;  /* how long io took */
 	struct osd_device *dr_dev;
@@ -735,6 +802,14 @@ static inline int osd_invariant(const struct osd_object *obj)
 
 #define OSD_MAX_CACHE_SIZE OBD_OBJECT_EOF
 
+/* largest region of the disk reserved for a write stream, and how many
+ * seconds of writes a region is sized for */
+#define OSD_STREAM_REGION_MB	256
+#define OSD_STREAM_WINDOW	4
+
+/* the directories of up to this many blocks are read ahead on lookup */
+#define OSD_SMALL_DIR_BLOCKS	4
+
 extern const struct dt_index_operations osd_otable_ops;
 
 static inline int osd_oi_fid2idx(struct osd_device *dev,
@@ -48,6 +48,10 @@
 #include <linux/types.h>
 /* prerequisite for linux/xattr.h */
 #include <linux/fs.h>
+/* FALLOC_FL_KEEP_SIZE */
+#include <linux/falloc.h>
+/* sort() */
+#include <linux/sort.h>
 
 /*
  * struct OBD_{ALLOC,FREE}*()
@@ -108,6 +112,7 @@ static int __osd_init_iobuf(struct osd_device *d, struct osd_iobuf *iobuf,
         iobuf->dr_error = 0;
         iobuf->dr_dev = d;
         iobuf->dr_frags = 0;
+        iobuf->dr_bytes = 0;
         iobuf->dr_elapsed = 0;
         /* must be counted before, so assert */
         iobuf->dr_rw = rw;
@@ -117,6 +122,8 @@ static int __osd_init_iobuf(struct osd_device *d, struct osd_iobuf *iobuf,
 	if (iobuf->dr_bl_buf.lb_len >= blocks * sizeof(iobuf->dr_blocks[0])) {
 		LASSERT(iobuf->dr_pg_buf.lb_len >=
 			pages * sizeof(iobuf->dr_pages[0]));
+		LASSERT(iobuf->dr_seg_buf.lb_len >=
+			blocks * sizeof(iobuf->dr_segs[0]));
 		return 0;
 	}
 
@@ -143,6 +150,11 @@ static int __osd_init_iobuf(struct osd_device *d, struct osd_iobuf *iobuf,
 	if (unlikely(iobuf->dr_pages == NULL))
 		return -ENOMEM;
 
+	lu_buf_realloc(&iobuf->dr_seg_buf, blocks * sizeof(iobuf->dr_segs[0]));
+	iobuf->dr_segs = iobuf->dr_seg_buf.lb_buf;
+	if (unlikely(iobuf->dr_segs == NULL))
+		return -ENOMEM;
+
 	iobuf->dr_max_pages = pages;
 
 	return 0;
@@ -169,6 +181,11 @@ void osd_fini_iobuf(struct osd_device *d, struct osd_iobuf *iobuf)
                                  iobuf->dr_frags);
                 lprocfs_oh_tally_log2(&d->od_brw_stats.hist[BRW_R_IO_TIME+rw],
                                       iobuf->dr_elapsed);
+                lprocfs_oh_tally_log2(&d->od_brw_stats.hist[BRW_R_RPC_BIOS+rw],
+                                      iobuf->dr_frags);
+                lprocfs_oh_tally_log2(&d->od_brw_stats.
+                                      hist[BRW_R_RPC_BIOSIZE+rw],
+                                      iobuf->dr_bytes / iobuf->dr_frags);
         }
 }
 
@@ -218,6 +235,7 @@ static int dio_complete_routine(struct bio *bio, unsigned int done, int error)
                         ClearPageConstant(bvl->bv_page);
                 }
                 cfs_atomic_dec(&iobuf->dr_dev->od_r_in_flight);
+                cfs_atomic_dec(&obd_io_in_flight);
         } else {
                 struct page *p = iobuf->dr_pages[0];
                 if (p->mapping) {
@@ -228,6 +246,7 @@ static int dio_complete_routine(struct bio *bio, unsigned int done, int error)
                         }
                 }
                 cfs_atomic_dec(&iobuf->dr_dev->od_w_in_flight);
+                cfs_atomic_dec(&obd_io_in_flight);
         }
 
         /* any real error is good enough -bzzz */
@@ -263,7 +282,9 @@ static void record_start_io(struct osd_iobuf *iobuf, int size)
         struct obd_histogram *h = osd->od_brw_stats.hist;
 
         iobuf->dr_frags++;
+        iobuf->dr_bytes += size;
         cfs_atomic_inc(&iobuf->dr_numreqs);
+        cfs_atomic_inc(&obd_io_in_flight);
 
         if (iobuf->dr_rw == 0) {
                 cfs_atomic_inc(&osd->od_r_in_flight);
@@ -300,6 +321,35 @@ static int can_be_merged(struct bio *bio, sector_t sector)
         return bio->bi_sector + size == sector ? 1 : 0;
 }
 
+static int osd_iobuf_seg_cmp(const void *a, const void *b)
+{
+	const struct osd_iobuf_seg *s1 = a;
+	const struct osd_iobuf_seg *s2 = b;
+
+	if (s1->obs_sector < s2->obs_sector)
+		return -1;
+	return s1->obs_sector > s2->obs_sector;
+}
+
+/* How many bio_vecs the run of segments contiguous on disk at \a seg takes */
+static int osd_iobuf_seg_run(struct osd_iobuf_seg *seg, int count)
+{
+	int i;
+
+	for (i = 1; i < count && i < BIO_MAX_PAGES; i++)
+		if (seg[i].obs_sector !=
+		    seg[i - 1].obs_sector + (seg[i - 1].obs_len >> 9))
+			break;
+	return i;
+}
+
+/*
+ * Map the pages of \a iobuf to segments contiguous on disk, sort these by
+ * disk position so that the blocks of a fragmented file which are adjacent
+ * on disk land in the same bio, whatever their order in the file, and
+ * submit the bios under a plug for the block layer to merge them into
+ * requests as large as the device takes.
+ */
 static int osd_do_bio(struct osd_device *osd, struct inode *inode,
                       struct osd_iobuf *iobuf)
 {
@@ -307,6 +357,8 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
         struct page  **pages = iobuf->dr_pages;
         int            npages = iobuf->dr_npages;
         unsigned long *blocks = iobuf->dr_blocks;
+	struct osd_iobuf_seg *segs = iobuf->dr_segs;
+	struct osd_iobuf_seg *seg;
         int            total_blocks = npages * blocks_per_page;
         int            sector_bits = inode->i_sb->s_blocksize_bits - 9;
         unsigned int   blocksize = inode->i_sb->s_blocksize;
@@ -314,11 +366,16 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
         struct page   *page;
         unsigned int   page_offset;
         sector_t       sector;
+	int            nsegs = 0;
+	int            sorted = 1;
         int            nblocks;
         int            block_idx;
         int            page_idx;
         int            i;
         int            rc = 0;
+#ifdef HAVE_BLK_PLUG
+	struct blk_plug plug;
+#endif
         ENTRY;
 
         LASSERT(iobuf->dr_npages == npages);
@@ -366,62 +423,80 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
                             mapping_cap_page_constant_write(inode->i_mapping))
                                 SetPageConstant(page);
 
-                        if (bio != NULL &&
-                            can_be_merged(bio, sector) &&
-                            bio_add_page(bio, page,
-                                         blocksize * nblocks, page_offset) != 0)
-                                continue;       /* added this frag OK */
-
-                        if (bio != NULL) {
-                                struct request_queue *q =
-                                        bdev_get_queue(bio->bi_bdev);
-
-                                /* Dang! I have to fragment this I/O */
-                                CDEBUG(D_INODE, "bio++ sz %d vcnt %d(%d) "
-                                       "sectors %d(%d) psg %d(%d) hsg %d(%d)\n",
-                                       bio->bi_size,
-                                       bio->bi_vcnt, bio->bi_max_vecs,
-                                       bio->bi_size >> 9, queue_max_sectors(q),
-                                       bio_phys_segments(q, bio),
-                                       queue_max_phys_segments(q),
-                                       bio_hw_segments(q, bio),
-                                       queue_max_hw_segments(q));
-
-                                record_start_io(iobuf, bio->bi_size);
-                                osd_submit_bio(iobuf->dr_rw, bio);
-                        }
+                        if (nsegs > 0 && segs[nsegs - 1].obs_sector > sector)
+                                sorted = 0;
+                        seg = &segs[nsegs++];
+                        seg->obs_sector = sector;
+                        seg->obs_page = page_idx;
+                        seg->obs_offset = page_offset;
+                        seg->obs_len = blocksize * nblocks;
+                }
+        }
 
-			/* allocate new bio */
-			bio = bio_alloc(GFP_NOIO, min(BIO_MAX_PAGES,
-						      (npages - page_idx) *
-						      blocks_per_page));
-                        if (bio == NULL) {
-                                CERROR("Can't allocate bio %u*%u = %u pages\n",
-                                       (npages - page_idx), blocks_per_page,
-                                       (npages - page_idx) * blocks_per_page);
-                                rc = -ENOMEM;
-                                goto out;
-                        }
+	/* the blocks of a file written at once are mostly in order already */
+	if (!sorted)
+		sort(segs, nsegs, sizeof(*segs), osd_iobuf_seg_cmp, NULL);
 
-                        bio->bi_bdev = inode->i_sb->s_bdev;
-                        bio->bi_sector = sector;
-			bio->bi_rw = (iobuf->dr_rw == 0) ? READ : WRITE;
-                        bio->bi_end_io = dio_complete_routine;
-                        bio->bi_private = iobuf;
+#ifdef HAVE_BLK_PLUG
+	blk_start_plug(&plug);
+#endif
+	for (i = 0; i < nsegs; i++) {
+		seg = &segs[i];
+		page = pages[seg->obs_page];
+
+		if (bio != NULL &&
+		    can_be_merged(bio, seg->obs_sector) &&
+		    bio_add_page(bio, page, seg->obs_len,
+				 seg->obs_offset) != 0)
+			continue;	/* added this frag OK */
+
+		if (bio != NULL) {
+			struct request_queue *q = bdev_get_queue(bio->bi_bdev);
+
+			/* Dang! I have to fragment this I/O */
+			CDEBUG(D_INODE, "bio++ sz %d vcnt %d(%d) "
+			       "sectors %d(%d) psg %d(%d) hsg %d(%d)\n",
+			       bio->bi_size,
+			       bio->bi_vcnt, bio->bi_max_vecs,
+			       bio->bi_size >> 9, queue_max_sectors(q),
+			       bio_phys_segments(q, bio),
+			       queue_max_phys_segments(q),
+			       bio_hw_segments(q, bio),
+			       queue_max_hw_segments(q));
+
+			record_start_io(iobuf, bio->bi_size);
+			osd_submit_bio(iobuf->dr_rw, bio);
+		}
 
-                        rc = bio_add_page(bio, page,
-                                          blocksize * nblocks, page_offset);
-                        LASSERT(rc != 0);
-                }
-        }
+		/* allocate new bio, as large as the run of segments contiguous
+		 * on disk ahead of it */
+		nblocks = osd_iobuf_seg_run(seg, nsegs - i);
+		bio = bio_alloc(GFP_NOIO, nblocks);
+		if (bio == NULL) {
+			CERROR("Can't allocate bio of %u pages\n", nblocks);
+			rc = -ENOMEM;
+			break;
+		}
+
+		bio->bi_bdev = inode->i_sb->s_bdev;
+		bio->bi_sector = seg->obs_sector;
+		bio->bi_rw = (iobuf->dr_rw == 0) ? READ : WRITE;
+		bio->bi_end_io = dio_complete_routine;
+		bio->bi_private = iobuf;
+
+		rc = bio_add_page(bio, page, seg->obs_len, seg->obs_offset);
+		LASSERT(rc != 0);
+	}
 
         if (bio != NULL) {
                 record_start_io(iobuf, bio->bi_size);
                 osd_submit_bio(iobuf->dr_rw, bio);
                 rc = 0;
         }
+#ifdef HAVE_BLK_PLUG
+	blk_finish_plug(&plug);
+#endif
 
- out:
         /* in order to achieve better IO throughput, we don't wait for writes
          * completion here. instead we proceed with transaction commit in
          * parallel and wait for IO completion once transaction is stopped
@@ -638,7 +713,7 @@ static int osd_write_prep(const struct lu_env *env, struct dt_object *dt,
 		rc = osd->od_fsops->fs_map_inode_pages(inode, iobuf->dr_pages,
 						       iobuf->dr_npages,
 						       iobuf->dr_blocks,
-						       0, NULL);
+						       0, 0, NULL);
                 if (likely(rc == 0)) {
                         rc = osd_do_bio(osd, inode, iobuf);
                         /* do IO stats for preparation reads */
@@ -781,6 +856,91 @@ static int osd_declare_write_commit(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/*
+ * Where to allocate the new blocks of a write to \a obj from, 0 to let
+ * ldiskfs follow the nearest extent of the object.
+ *
+ * With hundreds of objects written at once, mballoc interleaves their
+ * blocks. Each object written sequentially gets instead a region of the disk
+ * of its own, as large as a few seconds of its writes and at least a few of
+ * its RPCs, and its blocks follow each other in the region. A new region is
+ * handed out once the stream runs past the end of the last one.
+ */
+static unsigned long osd_stream_goal(struct osd_device *osd,
+				     struct osd_object *obj,
+				     struct niobuf_local *lnb, int npages)
+{
+	struct osd_stream	   *oss   = &obj->oo_stream;
+	struct inode		   *inode = obj->oo_inode;
+	struct super_block	   *sb    = osd_sb(osd);
+	struct ldiskfs_super_block *es    = LDISKFS_SB(sb)->s_es;
+	cfs_time_t		    now   = cfs_time_current();
+	loff_t			    start = lnb[0].lnb_file_offset;
+	loff_t			    end;
+	unsigned long		    first;
+	unsigned long		    count;
+	unsigned long		    goal;
+	__u64			    region;
+	__u64			    rate;
+
+	if (osd->od_stream_region_mb == 0 ||
+	    !(LDISKFS_I(inode)->i_flags & LDISKFS_EXTENTS_FL))
+		return 0;
+
+	end = lnb[npages - 1].lnb_file_offset + lnb[npages - 1].len;
+	spin_lock(&obj->oo_guard);
+	if (start != oss->oss_end) {
+		/* not a stream, or not any more */
+		oss->oss_end = end;
+		oss->oss_rate = 0;
+		oss->oss_time = now;
+		oss->oss_resv_end = 0;
+		spin_unlock(&obj->oo_guard);
+		return 0;
+	}
+
+	if (oss->oss_time != 0) {
+		rate = (end - start) * CFS_HZ;
+		do_div(rate, max_t(cfs_duration_t, 1,
+				   cfs_time_sub(now, oss->oss_time)));
+		if (oss->oss_rate != 0)
+			rate = (oss->oss_rate * 3 + rate) >> 2;
+		oss->oss_rate = rate;
+	}
+	oss->oss_end = end;
+	oss->oss_time = now;
+
+	/* overwrite, or still in the region of the stream */
+	if (end <= i_size_read(inode) ||
+	    ((end - 1) >> sb->s_blocksize_bits) < oss->oss_resv_end) {
+		spin_unlock(&obj->oo_guard);
+		return 0;
+	}
+
+	region = max_t(__u64, oss->oss_rate * OSD_STREAM_WINDOW,
+		       (end - start) * 4);
+	region = min_t(__u64, region, (__u64)osd->od_stream_region_mb << 20);
+	region >>= sb->s_blocksize_bits;
+	oss->oss_resv_end = (start >> sb->s_blocksize_bits) + region;
+	spin_unlock(&obj->oo_guard);
+
+	first = le32_to_cpu(es->s_first_data_block);
+	count = ldiskfs_blocks_count(es);
+	spin_lock(&osd->od_stream_lock);
+	if (osd->od_stream_cursor < first ||
+	    osd->od_stream_cursor + region > count)
+		osd->od_stream_cursor = first;
+	goal = osd->od_stream_cursor;
+	osd->od_stream_cursor += region;
+	osd->od_stream_regions++;
+	spin_unlock(&osd->od_stream_lock);
+
+	CDEBUG(D_INODE, "inode %lu: region of "LPU64" blocks at %lu for "
+	       "the stream at %llu, "LPU64" bytes/sec\n", inode->i_ino,
+	       region, goal, (unsigned long long)start, oss->oss_rate);
+	return goal;
+}
+
 /* Check if a block is allocated or not */
 static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
                             struct niobuf_local *lnb, int npages,
@@ -790,6 +950,7 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
         struct osd_iobuf *iobuf = &oti->oti_iobuf;
         struct inode *inode = osd_dt_obj(dt)->oo_inode;
         struct osd_device  *osd = osd_obj2dev(osd_dt_obj(dt));
+        unsigned long goal;
         loff_t isize;
         int rc = 0, i;
 
@@ -839,10 +1000,11 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
         if (OBD_FAIL_CHECK(OBD_FAIL_OST_MAPBLK_ENOSPC)) {
                 rc = -ENOSPC;
         } else if (iobuf->dr_npages > 0) {
+		goal = osd_stream_goal(osd, osd_dt_obj(dt), lnb, npages);
                 rc = osd->od_fsops->fs_map_inode_pages(inode, iobuf->dr_pages,
 						       iobuf->dr_npages,
 						       iobuf->dr_blocks,
-						       1, NULL);
+						       1, goal, NULL);
         } else {
                 /* no pages to write, no transno is needed */
                 thandle->th_local = 1;
@@ -930,7 +1092,7 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 		rc = osd->od_fsops->fs_map_inode_pages(inode, iobuf->dr_pages,
 						       iobuf->dr_npages,
 						       iobuf->dr_blocks,
-						       0, NULL);
+						       0, 0, NULL);
                 rc = osd_do_bio(osd, inode, iobuf);
 
                 /* IO stats will be done in osd_bufs_put() */
@@ -1040,6 +1202,10 @@ static ssize_t osd_declare_write(const struct lu_env *env, struct dt_object *dt,
         struct osd_thandle *oh;
         int                 credits;
 	struct inode	   *inode;
+	long long	    quota_space = 0;
+	bool		    ignore_quota = true;
+	loff_t		    offset;
+	int		    nblocks = 1;
 	int		    rc;
 	ENTRY;
 
@@ -1048,21 +1214,36 @@ static ssize_t osd_declare_write(const struct lu_env *env, struct dt_object *dt,
         oh = container_of0(handle, struct osd_thandle, ot_super);
         LASSERT(oh->ot_handle == NULL);
 
-	credits = osd_dto_credits_noquota[DTO_WRITE_BLOCK];
+	inode = osd_dt_obj(dt)->oo_inode;
+
+	/* The body of a Data-on-MDT file is written over ranges of many
+	 * blocks, each journaled, and charged to the owner of the file. */
+	if (inode != NULL && S_ISREG(inode->i_mode) &&
+	    fid_is_norm(lu_object_fid(&dt->do_lu)) && size > 0 && pos >= 0) {
+		nblocks = ((pos + size - 1) >> inode->i_blkbits) -
+			  (pos >> inode->i_blkbits) + 1;
+		for (offset = pos & ~((loff_t)inode->i_sb->s_blocksize - 1);
+		     offset < pos + size; offset += inode->i_sb->s_blocksize)
+			if (!osd_is_mapped(inode, offset))
+				quota_space += inode->i_sb->s_blocksize;
+		quota_space = toqb(quota_space);
+		ignore_quota = false;
+	}
 
-	osd_trans_declare_op(env, oh, OSD_OT_WRITE, credits);
+	credits = osd_dto_credits_noquota[DTO_WRITE_BLOCK] * nblocks;
 
-	inode = osd_dt_obj(dt)->oo_inode;
+	osd_trans_declare_op(env, oh, OSD_OT_WRITE, credits);
 
 	/* we may declare write to non-exist llog */
 	if (inode == NULL)
 		RETURN(0);
 
-	/* dt_declare_write() is usually called for system objects, such
+	/* dt_declare_write() is otherwise called for system objects, such
 	 * as llog or last_rcvd files. We needn't enforce quota on those
-	 * objects, so always set the lqi_space as 0. */
-	rc = osd_declare_inode_qid(env, inode->i_uid, inode->i_gid, 0, oh,
-				   true, true, NULL, false);
+	 * objects, so their lqi_space is 0. */
+	rc = osd_declare_inode_qid(env, inode->i_uid, inode->i_gid,
+				   quota_space, oh, true, true, NULL,
+				   ignore_quota);
 	RETURN(rc);
 }
 
@@ -1319,6 +1500,81 @@ static int osd_fiemap_get(const struct lu_env *env, struct dt_object *dt,
         return rc;
 }
 
+/*
+ * The whole range is charged, the blocks already allocated in it included:
+ * the reservation is given back once \a handle stops and the usage is then
+ * taken from the accounting of ldiskfs.
+ */
+static int osd_declare_fallocate(const struct lu_env *env,
+				 struct dt_object *dt, __u64 start, __u64 end,
+				 int mode, struct thandle *handle)
+{
+	struct osd_thandle	*oh;
+	struct inode		*inode = osd_dt_obj(dt)->oo_inode;
+	int			 rc;
+	ENTRY;
+
+	LASSERT(handle != NULL);
+	LASSERT(inode != NULL);
+
+	oh = container_of0(handle, struct osd_thandle, ot_super);
+	LASSERT(oh->ot_handle == NULL);
+
+	rc = osd_declare_inode_qid(env, inode->i_uid, inode->i_gid,
+				   toqb(end - start), oh, true, true, NULL,
+				   false);
+	RETURN(rc);
+}
+
+/*
+ * ldiskfs allocates the range as unwritten extents, which read back as
+ * zeroes, and starts as many journal handles of its own as it needs.
+ */
+static int osd_fallocate(const struct lu_env *env, struct dt_object *dt,
+			 __u64 start, __u64 end, int mode)
+{
+	struct inode		*inode = osd_dt_obj(dt)->oo_inode;
+#ifdef HAVE_FILE_FALLOCATE
+	struct osd_thread_info	*info = osd_oti_get(env);
+	struct dentry		*dentry = &info->oti_obj_dentry;
+	struct file		*file = &info->oti_file;
+#endif
+	int			 flags = 0;
+	int			 rc;
+	ENTRY;
+
+	LASSERT(dt_object_exists(dt));
+	LASSERT(inode != NULL);
+	LASSERT(journal_current_handle() == NULL);
+
+	if (mode & OST_FALLOC_KEEP_SIZE)
+		flags |= FALLOC_FL_KEEP_SIZE;
+
+	ll_vfs_dq_init(inode);
+#if defined(HAVE_FILE_FALLOCATE)
+	dentry->d_inode = inode;
+	dentry->d_sb = inode->i_sb;
+	file->f_dentry = dentry;
+	file->f_mapping = inode->i_mapping;
+	file->f_op = inode->i_fop;
+	file->f_flags = O_WRONLY;
+	file->f_mode = FMODE_WRITE;
+
+	if (inode->i_fop->fallocate != NULL)
+		rc = inode->i_fop->fallocate(file, flags, start, end - start);
+	else
+		rc = -EOPNOTSUPP;
+#elif defined(HAVE_INODE_FALLOCATE)
+	if (inode->i_op->fallocate != NULL)
+		rc = inode->i_op->fallocate(inode, flags, start, end - start);
+	else
+		rc = -EOPNOTSUPP;
+#else
+	rc = -EOPNOTSUPP;
+#endif
+	RETURN(rc);
+}
+
 /*
  * in some cases we may need declare methods for objects being created
  * e.g., when we create symlink
@@ -1340,5 +1596,7 @@ const struct dt_body_operations osd_body_ops = {
         .dbo_declare_punch         = osd_declare_punch,
         .dbo_punch                 = osd_punch,
         .dbo_fiemap_get           = osd_fiemap_get,
+	.dbo_fallocate		  = osd_fallocate,
+	.dbo_declare_fallocate	  = osd_declare_fallocate,
 };
 
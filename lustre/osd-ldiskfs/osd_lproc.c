@@ -159,10 +159,86 @@ static void brw_stats_show(struct seq_file *seq, struct brw_stats *brw_stats)
         display_brw_stats(seq, "disk I/O size", "ios",
                           &brw_stats->hist[BRW_R_DISK_IOSIZE],
                           &brw_stats->hist[BRW_W_DISK_IOSIZE], 1);
+
+        display_brw_stats(seq, "disk I/Os per bulk r/w", "rpcs",
+                          &brw_stats->hist[BRW_R_RPC_BIOS],
+                          &brw_stats->hist[BRW_W_RPC_BIOS], 1);
+
+        display_brw_stats(seq, "avg disk I/O size", "rpcs",
+                          &brw_stats->hist[BRW_R_RPC_BIOSIZE],
+                          &brw_stats->hist[BRW_W_RPC_BIOSIZE], 1);
+}
+
+static void display_dir_stats(struct seq_file *seq, char *name, char *units,
+			      struct obd_histogram *hist, int scale)
+{
+	unsigned long tot, n, cum = 0;
+	int i;
+
+	seq_printf(seq, "\n%-22s %-5s %% cum %%\n", name, units);
+
+	tot = lprocfs_oh_sum(hist);
+	for (i = 0; i < OBD_HIST_MAX; i++) {
+		n = hist->oh_buckets[i];
+		cum += n;
+		if (cum == 0)
+			continue;
+
+		if (!scale)
+			seq_printf(seq, "%u", i);
+		else if (i < 10)
+			seq_printf(seq, "%u", scale << i);
+		else if (i < 20)
+			seq_printf(seq, "%uK", scale << (i-10));
+		else
+			seq_printf(seq, "%uM", scale << (i-20));
+
+		seq_printf(seq, ":\t\t%10lu %3lu %3lu\n",
+			   n, pct(n, tot), pct(cum, tot));
+
+		if (cum == tot)
+			break;
+	}
 }
 
 #undef pct
 
+static int osd_dir_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct osd_device *osd = seq->private;
+	struct timeval	   now;
+
+	/* this sampling races with updates */
+	cfs_gettimeofday(&now);
+	seq_printf(seq, "snapshot_time:         %lu.%lu (secs.usecs)\n",
+		   now.tv_sec, now.tv_usec);
+	seq_printf(seq, "max_htree_levels:      %d\n",
+		   ldiskfs_dir_htree_level(osd_sb(osd)));
+
+	display_dir_stats(seq, "directory blocks", "names",
+			  &osd->od_dir_stats[OSD_DIR_BLOCKS], 1);
+	display_dir_stats(seq, "htree levels", "names",
+			  &osd->od_dir_stats[OSD_DIR_LEVELS], 0);
+	display_dir_stats(seq, "htree lock wait (us)", "locks",
+			  &osd->od_dir_stats[OSD_DIR_LOCK_WAIT], 1);
+	return 0;
+}
+
+static ssize_t osd_dir_stats_seq_write(struct file *file, const char *buf,
+				       size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct osd_device *osd = seq->private;
+	int i;
+
+	for (i = 0; i < OSD_DIR_LAST; i++)
+		lprocfs_oh_clear(&osd->od_dir_stats[i]);
+
+	return len;
+}
+
+LPROC_SEQ_FOPS(osd_dir_stats);
+
 static int osd_brw_stats_seq_show(struct seq_file *seq, void *v)
 {
         struct osd_device *osd = seq->private;
@@ -194,6 +270,8 @@ static int osd_stats_init(struct osd_device *osd)
 
         for (i = 0; i < BRW_LAST; i++)
 		spin_lock_init(&osd->od_brw_stats.hist[i].oh_lock);
+	for (i = 0; i < OSD_DIR_LAST; i++)
+		spin_lock_init(&osd->od_dir_stats[i].oh_lock);
 
         osd->od_stats = lprocfs_alloc_stats(LPROC_OSD_LAST, 0);
         if (osd->od_stats != NULL) {
@@ -217,6 +295,9 @@ static int osd_stats_init(struct osd_device *osd)
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_CACHE_MISS,
                                      LPROCFS_CNTR_AVGMINMAX,
                                      "cache_miss", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_SMALL_DIR_RA,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "small_dir_readahead", "blocks");
 #if OSD_THANDLE_STATS
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_THANDLE_STARTING,
                                      LPROCFS_CNTR_AVGMINMAX,
@@ -230,6 +311,10 @@ static int osd_stats_init(struct osd_device *osd)
 #endif
 		result = lprocfs_seq_create(osd->od_proc_entry, "brw_stats",
 					    0644, &osd_brw_stats_fops, osd);
+		if (result == 0)
+			result = lprocfs_seq_create(osd->od_proc_entry,
+						    "dir_stats", 0644,
+						    &osd_dir_stats_fops, osd);
         } else
                 result = -ENOMEM;
 
@@ -442,6 +527,48 @@ static int lprocfs_osd_wr_auto_scrub(struct file *file, const char *buffer,
 	return count;
 }
 
+static int lprocfs_osd_rd_scrub_latency_target(char *page, char **start,
+					       off_t off, int count, int *eof,
+					       void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return snprintf(page, count, "%u\n", dev->od_scrub.os_latency_target);
+}
+
+static int lprocfs_osd_wr_scrub_latency_target(struct file *file,
+					       const char *buffer,
+					       unsigned long count, void *data)
+{
+	struct osd_device *dev	 = osd_dt_dev(data);
+	struct osd_scrub  *scrub;
+	int		   val;
+	int		   rc;
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	if (val < 0)
+		return -EINVAL;
+
+	scrub = &dev->od_scrub;
+	spin_lock(&scrub->os_lock);
+	scrub->os_latency_target = val;
+	obd_scan_rate_init(&scrub->os_rate);
+	spin_unlock(&scrub->os_lock);
+	return count;
+}
+
 static int lprocfs_osd_rd_track_declares_assert(char *page, char **start,
 						off_t off, int count,
 						int *eof, void *data)
@@ -480,6 +607,57 @@ static int lprocfs_osd_rd_oi_scrub(char *page, char **start, off_t off,
 	return osd_scrub_dump(dev, page, count);
 }
 
+static int lprocfs_osd_rd_oi_cache(char *page, char **start, off_t off,
+				   int count, int *eof, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return osd_oi_cache_dump(dev, page, count);
+}
+
+static int lprocfs_osd_rd_oi_cache_mb(char *page, char **start, off_t off,
+				      int count, int *eof, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return snprintf(page, count, "%u\n", osd_oi_cache_budget(dev));
+}
+
+static int lprocfs_osd_wr_oi_cache_mb(struct file *file, const char *buffer,
+				      unsigned long count, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+	int val, rc;
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -EINVAL;
+
+	/* a cache disabled at mount by the module parameter stays so */
+	if (dev->od_oi_cache == NULL)
+		return -EOPNOTSUPP;
+
+	osd_oi_cache_set_budget(dev, val);
+	return count;
+}
+
 int lprocfs_osd_rd_readcache(char *page, char **start, off_t off, int count,
 			     int *eof, void *data)
 {
@@ -514,6 +692,94 @@ int lprocfs_osd_wr_readcache(struct file *file, const char *buffer,
 	return count;
 }
 
+static int lprocfs_osd_rd_stream_region_mb(char *page, char **start,
+					   off_t off, int count, int *eof,
+					   void *data)
+{
+	struct osd_device *osd = osd_dt_dev(data);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return snprintf(page, count, "%u\n", osd->od_stream_region_mb);
+}
+
+static int lprocfs_osd_wr_stream_region_mb(struct file *file,
+					   const char *buffer,
+					   unsigned long count, void *data)
+{
+	struct osd_device *osd = osd_dt_dev(data);
+	int		   val;
+	int		   rc;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	if (val < 0 || val > 4096)
+		return -EINVAL;
+
+	osd->od_stream_region_mb = val;
+	return count;
+}
+
+static int lprocfs_osd_rd_stream_regions(char *page, char **start,
+					 off_t off, int count, int *eof,
+					 void *data)
+{
+	struct osd_device *osd = osd_dt_dev(data);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return snprintf(page, count, LPU64"\n", osd->od_stream_regions);
+}
+
+static int lprocfs_osd_rd_small_dir_blocks(char *page, char **start,
+					   off_t off, int count, int *eof,
+					   void *data)
+{
+	struct osd_device *osd = osd_dt_dev(data);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return snprintf(page, count, "%u\n", osd->od_small_dir_blocks);
+}
+
+static int lprocfs_osd_wr_small_dir_blocks(struct file *file,
+					   const char *buffer,
+					   unsigned long count, void *data)
+{
+	struct osd_device *osd = osd_dt_dev(data);
+	int		   val;
+	int		   rc;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	if (val < 0 || val > 64)
+		return -EINVAL;
+
+	osd->od_small_dir_blocks = val;
+	return count;
+}
+
 struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	{ "blocksize",		lprocfs_dt_rd_blksize,	0, 0 },
 	{ "kbytestotal",	lprocfs_dt_rd_kbytestotal,	0, 0 },
@@ -528,12 +794,23 @@ struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	{ "auto_scrub",      lprocfs_osd_rd_auto_scrub,
 			     lprocfs_osd_wr_auto_scrub,  0 },
 	{ "oi_scrub",	     lprocfs_osd_rd_oi_scrub,    0, 0 },
+	{ "scrub_latency_target",
+			     lprocfs_osd_rd_scrub_latency_target,
+			     lprocfs_osd_wr_scrub_latency_target, 0 },
+	{ "oi_cache",	     lprocfs_osd_rd_oi_cache,    0, 0 },
+	{ "oi_cache_mb",     lprocfs_osd_rd_oi_cache_mb,
+			     lprocfs_osd_wr_oi_cache_mb, 0 },
 	{ "force_sync",		0, lprocfs_osd_wr_force_sync },
 	{ "read_cache_enable",	lprocfs_osd_rd_cache, lprocfs_osd_wr_cache, 0 },
 	{ "writethrough_cache_enable",	lprocfs_osd_rd_wcache,
 					lprocfs_osd_wr_wcache, 0 },
 	{ "readcache_max_filesize",	lprocfs_osd_rd_readcache,
 					lprocfs_osd_wr_readcache, 0 },
+	{ "stream_region_mb",		lprocfs_osd_rd_stream_region_mb,
+					lprocfs_osd_wr_stream_region_mb, 0 },
+	{ "stream_regions",		lprocfs_osd_rd_stream_regions, 0, 0 },
+	{ "small_dir_blocks",		lprocfs_osd_rd_small_dir_blocks,
+					lprocfs_osd_wr_small_dir_blocks, 0 },
 	{ 0 }
 };
 
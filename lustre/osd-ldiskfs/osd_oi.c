@@ -67,9 +67,27 @@ CFS_MODULE_PARM(osd_oi_count, "i", int, 0444,
                 "Number of Object Index containers to be created, "
                 "it's only valid for new filesystem.");
 
+static unsigned int osd_oi_cache_mb = 32;
+CFS_MODULE_PARM(osd_oi_cache_mb, "i", int, 0444,
+		"Memory budget in MB of the FID to inode cache of each "
+		"device, 0 to disable it.");
+
 /** to serialize concurrent OI index initialization */
 static struct mutex oi_init_lock;
 
+static struct kmem_cache *osd_oi_cache_kmem;
+
+static struct lu_kmem_descr osd_oi_caches[] = {
+	{
+		.ckd_cache = &osd_oi_cache_kmem,
+		.ckd_name  = "osd_oi_cache",
+		.ckd_size  = sizeof(struct osd_oi_cache_entry)
+	},
+	{
+		.ckd_cache = NULL
+	}
+};
+
 static struct dt_index_features oi_feat = {
         .dif_flags       = DT_IND_UPDATE,
         .dif_recsize_min = sizeof(struct osd_inode_id),
@@ -329,6 +347,269 @@ osd_oi_table_open(struct osd_thread_info *info, struct osd_device *osd,
 	RETURN(count);
 }
 
+static inline struct osd_oi_cache_shard *
+osd_oi_cache_shard(struct osd_oi_cache *cache, const struct lu_fid *fid,
+		   cfs_hlist_head_t **head)
+{
+	__u32 hash = fid_hash(fid, OSD_OI_CACHE_SHARD_BITS +
+				   OSD_OI_CACHE_HASH_BITS);
+	struct osd_oi_cache_shard *shard;
+
+	shard = &cache->oc_shards[hash >> OSD_OI_CACHE_HASH_BITS];
+	*head = &shard->ocs_hash[hash & (OSD_OI_CACHE_HASH_SIZE - 1)];
+	return shard;
+}
+
+static struct osd_oi_cache_entry *
+osd_oi_cache_find(cfs_hlist_head_t *head, const struct lu_fid *fid)
+{
+	struct osd_oi_cache_entry *oce;
+	cfs_hlist_node_t	  *pos;
+
+	cfs_hlist_for_each_entry(oce, pos, head, oce_hash) {
+		if (lu_fid_eq(&oce->oce_fid, fid))
+			return oce;
+	}
+	return NULL;
+}
+
+static void osd_oi_cache_unlink(struct osd_oi_cache_shard *shard,
+				struct osd_oi_cache_entry *oce)
+{
+	cfs_hlist_del(&oce->oce_hash);
+	cfs_list_del(&oce->oce_lru);
+	shard->ocs_count--;
+	OBD_SLAB_FREE_PTR(oce, osd_oi_cache_kmem);
+}
+
+/* evict the least recently used entries of \a shard down to \a max */
+static void osd_oi_cache_shrink(struct osd_oi_cache_shard *shard,
+				unsigned int max)
+{
+	struct osd_oi_cache_entry *oce;
+
+	while (shard->ocs_count > max) {
+		oce = cfs_list_entry(shard->ocs_lru.prev,
+				     struct osd_oi_cache_entry, oce_lru);
+		osd_oi_cache_unlink(shard, oce);
+		shard->ocs_evictions++;
+	}
+}
+
+/**
+ * Look \a fid up in the cache. On a miss, \a seq is set to the removal
+ * sequence of its shard, to be given back to osd_oi_cache_add().
+ *
+ * \retval 0		found, \a id is set
+ * \retval -ENOENT	not cached
+ */
+static int osd_oi_cache_lookup(struct osd_device *osd, const struct lu_fid *fid,
+			       struct osd_inode_id *id, unsigned long *seq)
+{
+	struct osd_oi_cache	  *cache = osd->od_oi_cache;
+	struct osd_oi_cache_shard *shard;
+	struct osd_oi_cache_entry *oce;
+	cfs_hlist_head_t	  *head;
+	int			   rc = -ENOENT;
+
+	if (cache == NULL)
+		return -ENOENT;
+
+	shard = osd_oi_cache_shard(cache, fid, &head);
+	spin_lock(&shard->ocs_lock);
+	shard->ocs_lookups++;
+	oce = osd_oi_cache_find(head, fid);
+	if (oce != NULL) {
+		*id = oce->oce_id;
+		cfs_list_move(&oce->oce_lru, &shard->ocs_lru);
+		shard->ocs_hits++;
+		rc = 0;
+	} else {
+		*seq = shard->ocs_seq;
+	}
+	spin_unlock(&shard->ocs_lock);
+	return rc;
+}
+
+/**
+ * Cache the mapping of \a fid to \a id. If \a seq is not NULL, the mapping
+ * was read from the OI after a miss, and is dropped if an entry of the
+ * shard has been removed since, in case it was the one for \a fid.
+ */
+static void osd_oi_cache_add(struct osd_device *osd, const struct lu_fid *fid,
+			     const struct osd_inode_id *id,
+			     const unsigned long *seq)
+{
+	struct osd_oi_cache	  *cache = osd->od_oi_cache;
+	struct osd_oi_cache_shard *shard;
+	struct osd_oi_cache_entry *oce;
+	struct osd_oi_cache_entry *new;
+	cfs_hlist_head_t	  *head;
+
+	if (cache == NULL || cache->oc_shard_max == 0)
+		return;
+
+	OBD_SLAB_ALLOC_PTR_GFP(new, osd_oi_cache_kmem, __GFP_IO);
+	if (new == NULL)
+		return;
+	new->oce_fid = *fid;
+	new->oce_id = *id;
+
+	shard = osd_oi_cache_shard(cache, fid, &head);
+	spin_lock(&shard->ocs_lock);
+	if (seq != NULL && *seq != shard->ocs_seq) {
+		spin_unlock(&shard->ocs_lock);
+		OBD_SLAB_FREE_PTR(new, osd_oi_cache_kmem);
+		return;
+	}
+
+	oce = osd_oi_cache_find(head, fid);
+	if (oce != NULL) {
+		oce->oce_id = *id;
+		cfs_list_move(&oce->oce_lru, &shard->ocs_lru);
+		spin_unlock(&shard->ocs_lock);
+		OBD_SLAB_FREE_PTR(new, osd_oi_cache_kmem);
+		return;
+	}
+
+	cfs_hlist_add_head(&new->oce_hash, head);
+	cfs_list_add(&new->oce_lru, &shard->ocs_lru);
+	shard->ocs_count++;
+	shard->ocs_inserts++;
+	osd_oi_cache_shrink(shard, cache->oc_shard_max);
+	spin_unlock(&shard->ocs_lock);
+}
+
+/**
+ * Drop the cached mapping of \a fid, when it is removed from the OI, or
+ * changed by OI scrub, or found stale.
+ */
+void osd_oi_cache_del(struct osd_device *osd, const struct lu_fid *fid)
+{
+	struct osd_oi_cache	  *cache = osd->od_oi_cache;
+	struct osd_oi_cache_shard *shard;
+	struct osd_oi_cache_entry *oce;
+	cfs_hlist_head_t	  *head;
+
+	if (cache == NULL)
+		return;
+
+	shard = osd_oi_cache_shard(cache, fid, &head);
+	spin_lock(&shard->ocs_lock);
+	shard->ocs_seq++;
+	oce = osd_oi_cache_find(head, fid);
+	if (oce != NULL) {
+		osd_oi_cache_unlink(shard, oce);
+		shard->ocs_invalidations++;
+	}
+	spin_unlock(&shard->ocs_lock);
+}
+
+void osd_oi_cache_set_budget(struct osd_device *osd, unsigned int mb)
+{
+	struct osd_oi_cache	  *cache = osd->od_oi_cache;
+	struct osd_oi_cache_shard *shard;
+	int			   i;
+
+	if (cache == NULL)
+		return;
+
+	cache->oc_budget_mb = mb;
+	cache->oc_shard_max = ((__u64)mb << 20) / OSD_OI_CACHE_SHARDS /
+			      sizeof(struct osd_oi_cache_entry);
+	for (i = 0; i < OSD_OI_CACHE_SHARDS; i++) {
+		shard = &cache->oc_shards[i];
+		spin_lock(&shard->ocs_lock);
+		osd_oi_cache_shrink(shard, cache->oc_shard_max);
+		spin_unlock(&shard->ocs_lock);
+	}
+}
+
+unsigned int osd_oi_cache_budget(struct osd_device *osd)
+{
+	return osd->od_oi_cache != NULL ? osd->od_oi_cache->oc_budget_mb : 0;
+}
+
+int osd_oi_cache_dump(struct osd_device *osd, char *buf, int len)
+{
+	struct osd_oi_cache	  *cache = osd->od_oi_cache;
+	struct osd_oi_cache_shard *shard;
+	__u64			   lookups = 0;
+	__u64			   hits = 0;
+	__u64			   inserts = 0;
+	__u64			   evictions = 0;
+	__u64			   invalidations = 0;
+	__u64			   count = 0;
+	int			   i;
+
+	if (cache == NULL)
+		return snprintf(buf, len, "disabled\n");
+
+	for (i = 0; i < OSD_OI_CACHE_SHARDS; i++) {
+		shard = &cache->oc_shards[i];
+		spin_lock(&shard->ocs_lock);
+		count += shard->ocs_count;
+		lookups += shard->ocs_lookups;
+		hits += shard->ocs_hits;
+		inserts += shard->ocs_inserts;
+		evictions += shard->ocs_evictions;
+		invalidations += shard->ocs_invalidations;
+		spin_unlock(&shard->ocs_lock);
+	}
+
+	return snprintf(buf, len,
+			"entries: "LPU64"\n"
+			"max_entries: "LPU64"\n"
+			"lookups: "LPU64"\n"
+			"hits: "LPU64"\n"
+			"hit_rate: "LPU64"%%\n"
+			"inserts: "LPU64"\n"
+			"evictions: "LPU64"\n"
+			"invalidations: "LPU64"\n",
+			count, (__u64)cache->oc_shard_max * OSD_OI_CACHE_SHARDS,
+			lookups, hits, lookups != 0 ? hits * 100 / lookups : 0,
+			inserts, evictions, invalidations);
+}
+
+static int osd_oi_cache_init(struct osd_device *osd)
+{
+	struct osd_oi_cache	  *cache;
+	struct osd_oi_cache_shard *shard;
+	int			   i, j;
+
+	if (osd_oi_cache_mb == 0)
+		return 0;
+
+	OBD_ALLOC_LARGE(cache, sizeof(*cache));
+	if (cache == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < OSD_OI_CACHE_SHARDS; i++) {
+		shard = &cache->oc_shards[i];
+		spin_lock_init(&shard->ocs_lock);
+		CFS_INIT_LIST_HEAD(&shard->ocs_lru);
+		for (j = 0; j < OSD_OI_CACHE_HASH_SIZE; j++)
+			CFS_INIT_HLIST_HEAD(&shard->ocs_hash[j]);
+	}
+	osd->od_oi_cache = cache;
+	osd_oi_cache_set_budget(osd, osd_oi_cache_mb);
+	return 0;
+}
+
+static void osd_oi_cache_fini(struct osd_device *osd)
+{
+	struct osd_oi_cache *cache = osd->od_oi_cache;
+	int		     i;
+
+	if (cache == NULL)
+		return;
+
+	for (i = 0; i < OSD_OI_CACHE_SHARDS; i++)
+		osd_oi_cache_shrink(&cache->oc_shards[i], 0);
+	osd->od_oi_cache = NULL;
+	OBD_FREE_LARGE(cache, sizeof(*cache));
+}
+
 int osd_oi_init(struct osd_thread_info *info, struct osd_device *osd)
 {
 	struct osd_scrub  *scrub = &osd->od_scrub;
@@ -395,14 +676,17 @@ create:
 	GOTO(out, rc);
 
 out:
-	if (rc < 0) {
-		OBD_FREE(oi, sizeof(*oi) * OSD_OI_FID_NR_MAX);
-	} else {
+	if (rc >= 0) {
 		LASSERT((rc & (rc - 1)) == 0);
-		osd->od_oi_table = oi;
 		osd->od_oi_count = rc;
-		rc = 0;
+		rc = osd_oi_cache_init(osd);
+		if (rc < 0)
+			osd_oi_table_put(info, oi, osd->od_oi_count);
 	}
+	if (rc < 0)
+		OBD_FREE(oi, sizeof(*oi) * OSD_OI_FID_NR_MAX);
+	else
+		osd->od_oi_table = oi;
 
 	mutex_unlock(&oi_init_lock);
 	return rc;
@@ -413,6 +697,7 @@ void osd_oi_fini(struct osd_thread_info *info, struct osd_device *osd)
 	if (unlikely(osd->od_oi_table == NULL))
 		return;
 
+	osd_oi_cache_fini(osd);
         osd_oi_table_put(info, osd->od_oi_table, osd->od_oi_count);
 
         OBD_FREE(osd->od_oi_table,
@@ -512,11 +797,22 @@ int osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
 		  const struct lu_fid *fid, struct osd_inode_id *id,
 		  bool check_fld)
 {
+	unsigned long	seq;
+	int		rc;
+
 	if (unlikely(fid_is_last_id(fid)))
 		return osd_obj_spec_lookup(info, osd, fid, id);
 
-	if ((check_fld && fid_is_on_ost(info, osd, fid)) || fid_is_llog(fid))
-		return osd_obj_map_lookup(info, osd, fid, id);
+	/* without check_fld, the caller wants the mapping stored on disk,
+	 * so the cache is bypassed */
+	if ((check_fld && fid_is_on_ost(info, osd, fid)) || fid_is_llog(fid)) {
+		if (check_fld && osd_oi_cache_lookup(osd, fid, id, &seq) == 0)
+			return 0;
+		rc = osd_obj_map_lookup(info, osd, fid, id);
+		if (rc == 0 && check_fld)
+			osd_oi_cache_add(osd, fid, id, &seq);
+		return rc;
+	}
 
 	if (fid_is_fs_root(fid)) {
 		osd_id_gen(id, osd_sb(osd)->s_root->d_inode->i_ino,
@@ -532,7 +828,12 @@ int osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
 		return 0;
 	}
 
-	return __osd_oi_lookup(info, osd, fid, id);
+	if (check_fld && osd_oi_cache_lookup(osd, fid, id, &seq) == 0)
+		return 0;
+	rc = __osd_oi_lookup(info, osd, fid, id);
+	if (rc == 0 && check_fld)
+		osd_oi_cache_add(osd, fid, id, &seq);
+	return rc;
 }
 
 static int osd_oi_iam_refresh(struct osd_thread_info *oti, struct osd_oi *oi,
@@ -579,8 +880,12 @@ int osd_oi_insert(struct osd_thread_info *info, struct osd_device *osd,
 	if (unlikely(fid_is_last_id(fid)))
 		return osd_obj_spec_insert(info, osd, fid, id, th);
 
-	if (fid_is_on_ost(info, osd, fid) || fid_is_llog(fid))
-		return osd_obj_map_insert(info, osd, fid, id, th);
+	if (fid_is_on_ost(info, osd, fid) || fid_is_llog(fid)) {
+		rc = osd_obj_map_insert(info, osd, fid, id, th);
+		if (rc == 0)
+			osd_oi_cache_add(osd, fid, id, NULL);
+		return rc;
+	}
 
 	fid_cpu_to_be(oi_fid, fid);
 	osd_id_pack(oi_id, id);
@@ -640,6 +945,7 @@ update:
 			return rc;
 	}
 
+	osd_oi_cache_add(osd, fid, id, NULL);
 	if (unlikely(fid_seq(fid) == FID_SEQ_LOCAL_FILE))
 		rc = osd_obj_spec_insert(info, osd, fid, id, th);
 	return rc;
@@ -678,6 +984,7 @@ int osd_oi_delete(struct osd_thread_info *info,
 		  struct thandle *th)
 {
 	struct lu_fid *oi_fid = &info->oti_fid2;
+	int	       rc;
 
 	/* clear idmap cache */
 	if (lu_fid_eq(fid, &info->oti_cache.oic_fid))
@@ -686,12 +993,19 @@ int osd_oi_delete(struct osd_thread_info *info,
 	if (fid_is_last_id(fid))
 		return 0;
 
-	if (fid_is_on_ost(info, osd, fid) || fid_is_llog(fid))
-		return osd_obj_map_delete(info, osd, fid, th);
+	if (fid_is_on_ost(info, osd, fid) || fid_is_llog(fid)) {
+		rc = osd_obj_map_delete(info, osd, fid, th);
+	} else {
+		fid_cpu_to_be(oi_fid, fid);
+		rc = osd_oi_iam_delete(info, osd_fid2oi(osd, fid),
+				       (const struct dt_key *)oi_fid, th);
+	}
 
-	fid_cpu_to_be(oi_fid, fid);
-	return osd_oi_iam_delete(info, osd_fid2oi(osd, fid),
-				 (const struct dt_key *)oi_fid, th);
+	/* only once the mapping is gone from disk, so that a lookup racing
+	 * with the delete cannot cache it again */
+	if (rc == 0)
+		osd_oi_cache_del(osd, fid);
+	return rc;
 }
 
 int osd_oi_mod_init(void)
@@ -706,5 +1020,10 @@ int osd_oi_mod_init(void)
         }
 
 	mutex_init(&oi_init_lock);
-        return 0;
+	return lu_kmem_init(osd_oi_caches);
+}
+
+void osd_oi_mod_exit(void)
+{
+	lu_kmem_fini(osd_oi_caches);
 }
@@ -89,6 +89,47 @@ struct osd_idmap_cache {
 	struct osd_inode_id	oic_lid;
 };
 
+/*
+ * FID to inode cache of the device, in front of the OI files and of the
+ * /O directories of OST objects. It is split into shards by the hash of
+ * the FID, each with its own lock, hash table and LRU list. The cache is
+ * bounded by a memory budget, in osd_oi_cache_mb.
+ */
+#define OSD_OI_CACHE_SHARD_BITS	6
+#define OSD_OI_CACHE_SHARDS	(1 << OSD_OI_CACHE_SHARD_BITS)
+#define OSD_OI_CACHE_HASH_BITS	10
+#define OSD_OI_CACHE_HASH_SIZE	(1 << OSD_OI_CACHE_HASH_BITS)
+
+struct osd_oi_cache_entry {
+	cfs_hlist_node_t	oce_hash;
+	cfs_list_t		oce_lru;
+	struct lu_fid		oce_fid;
+	struct osd_inode_id	oce_id;
+};
+
+struct osd_oi_cache_shard {
+	spinlock_t		ocs_lock;
+	/* bumped by each removal, so that a lookup of the OI which raced
+	 * with the removal of its FID does not cache the old mapping */
+	unsigned long		ocs_seq;
+	unsigned int		ocs_count;
+	cfs_list_t		ocs_lru;
+	/* statistics, updated under ocs_lock */
+	__u64			ocs_lookups;
+	__u64			ocs_hits;
+	__u64			ocs_inserts;
+	__u64			ocs_evictions;
+	__u64			ocs_invalidations;
+	cfs_hlist_head_t	ocs_hash[OSD_OI_CACHE_HASH_SIZE];
+} ____cacheline_aligned;
+
+struct osd_oi_cache {
+	/* memory budget in MB, and the most entries in each shard from it */
+	unsigned int			oc_budget_mb;
+	unsigned int			oc_shard_max;
+	struct osd_oi_cache_shard	oc_shards[OSD_OI_CACHE_SHARDS];
+};
+
 static inline void osd_id_pack(struct osd_inode_id *tgt,
 			       const struct osd_inode_id *src)
 {
@@ -132,6 +173,7 @@ static inline int osd_id_eq_strict(const struct osd_inode_id *id0,
 }
 
 int osd_oi_mod_init(void);
+void osd_oi_mod_exit(void);
 int osd_oi_init(struct osd_thread_info *info, struct osd_device *osd);
 void osd_oi_fini(struct osd_thread_info *info, struct osd_device *osd);
 int __osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
@@ -148,5 +190,10 @@ int  osd_oi_delete(struct osd_thread_info *info,
 
 int fid_is_on_ost(struct osd_thread_info *info, struct osd_device *osd,
 		  const struct lu_fid *fid);
+
+void osd_oi_cache_del(struct osd_device *osd, const struct lu_fid *fid);
+void osd_oi_cache_set_budget(struct osd_device *osd, unsigned int mb);
+unsigned int osd_oi_cache_budget(struct osd_device *osd);
+int osd_oi_cache_dump(struct osd_device *osd, char *buf, int len);
 #endif /* __KERNEL__ */
 #endif /* _OSD_OI_H */
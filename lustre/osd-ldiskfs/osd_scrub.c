@@ -61,6 +61,10 @@
 #define SCRUB_NEXT_NOSCRUB	7 /* new created object, no scrub on it */
 #define SCRUB_NEXT_NOLMA	8 /* the inode has no FID-in-LMA */
 
+static int osd_scrub_threads = 4;
+CFS_MODULE_PARM(osd_scrub_threads, "i", int, 0644,
+		"Threads of the OI scrub when it runs at full speed");
+
 /* misc functions */
 
 static inline struct osd_device *osd_scrub2dev(struct osd_scrub *scrub)
@@ -99,6 +103,7 @@ static int osd_scrub_refresh_mapping(struct osd_thread_info *info,
 	int		       rc;
 	ENTRY;
 
+	osd_oi_cache_del(dev, fid);
 	fid_cpu_to_be(oi_fid, fid);
 	if (id != NULL)
 		osd_id_pack(oi_id, id);
@@ -391,6 +396,8 @@ static int osd_scrub_prep(struct osd_device *dev)
 	scrub->os_waiting = 0;
 	scrub->os_paused = 0;
 	scrub->os_new_checked = 0;
+	scrub->os_scanned = 0;
+	obd_scan_rate_init(&scrub->os_rate);
 	if (sf->sf_pos_last_checkpoint != 0)
 		sf->sf_pos_latest_start = sf->sf_pos_last_checkpoint + 1;
 	else
@@ -412,9 +419,13 @@ static int osd_scrub_prep(struct osd_device *dev)
 	RETURN(rc);
 }
 
+/* Check the OI mapping of \a oic, which is an inconsistent item found by
+ * RPC if \a prior. Several threads may check items at the same time: the
+ * scrub file is updated under os_lock, and os_rwsem is held for read to
+ * keep the checkpoints consistent. */
 static int
 osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
-		       struct osd_idmap_cache *oic, int val)
+		       struct osd_idmap_cache *oic, int val, bool prior)
 {
 	struct osd_scrub	     *scrub  = &dev->od_scrub;
 	struct scrub_file	     *sf     = &scrub->os_file;
@@ -428,20 +439,25 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 	int			      rc;
 	ENTRY;
 
-	down_write(&scrub->os_rwsem);
+	down_read(&scrub->os_rwsem);
+	spin_lock(&scrub->os_lock);
 	scrub->os_new_checked++;
+	spin_unlock(&scrub->os_lock);
 	if (val < 0)
 		GOTO(out, rc = val);
 
-	if (scrub->os_in_prior)
+	if (prior)
 		oii = cfs_list_entry(oic, struct osd_inconsistent_item,
 				     oii_cache);
 
 	if (lid->oii_ino < sf->sf_pos_latest_start && oii == NULL)
 		GOTO(out, rc = 0);
 
-	if (fid_is_igif(fid))
+	if (fid_is_igif(fid)) {
+		spin_lock(&scrub->os_lock);
 		sf->sf_items_igif++;
+		spin_unlock(&scrub->os_lock);
+	}
 
 	if ((val == SCRUB_NEXT_NOLMA) &&
 	    (!dev->od_handle_nolma || OBD_FAIL_CHECK(OBD_FAIL_FID_NOLMA)))
@@ -479,23 +495,30 @@ iget:
 		ops = DTO_INDEX_INSERT;
 		idx = osd_oi_fid2idx(dev, fid);
 		if (val == SCRUB_NEXT_NOLMA) {
+			spin_lock(&scrub->os_lock);
 			sf->sf_flags |= SF_UPGRADE;
 			scrub->os_full_speed = 1;
+			spin_unlock(&scrub->os_lock);
 			rc = osd_ea_fid_set(info, inode, fid, 0);
 			if (rc != 0)
 				GOTO(out, rc);
 
+			spin_lock(&scrub->os_lock);
 			if (!(sf->sf_flags & SF_INCONSISTENT))
 				dev->od_igif_inoi = 0;
+			spin_unlock(&scrub->os_lock);
 		} else {
+			spin_lock(&scrub->os_lock);
 			sf->sf_flags |= SF_RECREATED;
 			scrub->os_full_speed = 1;
 			if (unlikely(!ldiskfs_test_bit(idx, sf->sf_oi_bitmap)))
 				ldiskfs_set_bit(idx, sf->sf_oi_bitmap);
+			spin_unlock(&scrub->os_lock);
 		}
 	} else if (osd_id_eq(lid, lid2)) {
 		GOTO(out, rc = 0);
 	} else {
+		spin_lock(&scrub->os_lock);
 		sf->sf_flags |= SF_INCONSISTENT;
 		scrub->os_full_speed = 1;
 
@@ -512,24 +535,29 @@ iget:
 		 *	then ask the client to retry after upgrading completed.
 		 *	No better choice. */
 		dev->od_igif_inoi = 1;
+		spin_unlock(&scrub->os_lock);
 	}
 
 	rc = osd_scrub_refresh_mapping(info, dev, fid, lid, ops);
 	if (rc == 0) {
-		if (scrub->os_in_prior)
+		spin_lock(&scrub->os_lock);
+		if (prior)
 			sf->sf_items_updated_prior++;
 		else
 			sf->sf_items_updated++;
+		spin_unlock(&scrub->os_lock);
 	}
 
 	GOTO(out, rc);
 
 out:
 	if (rc < 0) {
+		spin_lock(&scrub->os_lock);
 		sf->sf_items_failed++;
 		if (sf->sf_pos_first_inconsistent == 0 ||
 		    sf->sf_pos_first_inconsistent > lid->oii_ino)
 			sf->sf_pos_first_inconsistent = lid->oii_ino;
+		spin_unlock(&scrub->os_lock);
 	} else {
 		rc = 0;
 	}
@@ -542,7 +570,7 @@ out:
 						  DTO_INDEX_DELETE);
 		iput(inode);
 	}
-	up_write(&scrub->os_rwsem);
+	up_read(&scrub->os_rwsem);
 
 	if (oii != NULL) {
 		LASSERT(!cfs_list_empty(&oii->oii_list));
@@ -646,6 +674,47 @@ typedef int (*osd_iit_exec_policy)(struct osd_thread_info *info,
 				   struct osd_idmap_cache *oic,
 				   int *noslot, int rc);
 
+static inline ldiskfs_fsblk_t osd_gd_block(struct super_block *sb,
+					    __le32 lo, __le32 hi)
+{
+	return le32_to_cpu(lo) |
+	       (LDISKFS_DESC_SIZE(sb) >= LDISKFS_MIN_DESC_SIZE_64BIT ?
+		(ldiskfs_fsblk_t)le32_to_cpu(hi) << 32 : 0);
+}
+
+/* Read the inode bitmap and the used part of the inode table of the group
+ * \a bg ahead, so that they are in memory when the scan reaches it. */
+static void osd_scrub_group_readahead(struct super_block *sb,
+				      ldiskfs_group_t bg)
+{
+	struct ldiskfs_group_desc *gdp;
+	ldiskfs_fsblk_t		   block;
+	__u32			   used;
+	__u32			   blocks;
+	__u32			   i;
+
+	if (bg >= LDISKFS_SB(sb)->s_groups_count)
+		return;
+
+	gdp = ldiskfs_get_group_desc(sb, bg, NULL);
+	if (gdp == NULL || gdp->bg_flags & cpu_to_le16(LDISKFS_BG_INODE_UNINIT))
+		return;
+
+	sb_breadahead(sb, osd_gd_block(sb, gdp->bg_inode_bitmap_lo,
+				       gdp->bg_inode_bitmap_hi));
+
+	used = LDISKFS_INODES_PER_GROUP(sb);
+	if (LDISKFS_HAS_RO_COMPAT_FEATURE(sb,
+					  LDISKFS_FEATURE_RO_COMPAT_GDT_CSUM))
+		used -= ldiskfs_itable_unused_count(sb, gdp);
+	blocks = (used * LDISKFS_INODE_SIZE(sb) + sb->s_blocksize - 1) >>
+		 sb->s_blocksize_bits;
+	block = osd_gd_block(sb, gdp->bg_inode_table_lo,
+			     gdp->bg_inode_table_hi);
+	for (i = 0; i < blocks; i++)
+		sb_breadahead(sb, block + i);
+}
+
 static int osd_iit_next(struct osd_iit_param *param, __u32 *pos)
 {
 	param->offset = ldiskfs_find_next_bit(param->bitmap->b_data,
@@ -817,6 +886,50 @@ osd_scrub_wakeup(struct osd_scrub *scrub, struct osd_otable_it *it)
 	return !scrub->os_waiting;
 }
 
+/* With a service latency target set, sleep between the objects checked so
+ * as to keep under the scan rate adapted to the load of the node, shared by
+ * the threads of the scrub. \a scanned counts the objects the calling thread
+ * checked since its last sleep. */
+static void osd_scrub_control_speed(struct osd_scrub *scrub, __u32 *scanned)
+{
+	struct ptlrpc_thread	*thread = &scrub->os_thread;
+	struct l_wait_info	 lwi;
+	cfs_duration_t		 jif;
+	__u32			 batch;
+	__u32			 rate;
+	int			 threads;
+
+	if (scrub->os_latency_target == 0)
+		return;
+
+	spin_lock(&scrub->os_lock);
+	obd_scan_rate_update(&scrub->os_rate, scrub->os_latency_target);
+	rate = scrub->os_rate.osr_rate;
+	spin_unlock(&scrub->os_lock);
+
+	if (rate == 0) {
+		*scanned = 0;
+		return;
+	}
+
+	threads = max(cfs_atomic_read(&scrub->os_workers_running), 1);
+	rate = max_t(__u32, rate / threads, 1);
+	if (rate > CFS_HZ) {
+		batch = rate / CFS_HZ;
+		jif = 1;
+	} else {
+		batch = 1;
+		jif = CFS_HZ / rate;
+	}
+
+	if (++(*scanned) < batch)
+		return;
+
+	*scanned = 0;
+	lwi = LWI_TIMEOUT_INTR(jif, NULL, LWI_ON_SIGNAL_NOOP, NULL);
+	l_wait_event(thread->t_ctl_waitq, !thread_is_running(thread), &lwi);
+}
+
 static int osd_scrub_exec(struct osd_thread_info *info, struct osd_device *dev,
 			  struct osd_iit_param *param,
 			  struct osd_idmap_cache *oic, int *noslot, int rc)
@@ -841,7 +954,7 @@ static int osd_scrub_exec(struct osd_thread_info *info, struct osd_device *dev,
 		goto next;
 	}
 
-	rc = osd_scrub_check_update(info, dev, oic, rc);
+	rc = osd_scrub_check_update(info, dev, oic, rc, scrub->os_in_prior);
 	if (rc != 0)
 		return rc;
 
@@ -870,6 +983,9 @@ wait:
 		spin_unlock(&scrub->os_lock);
 	}
 
+	if (scrub->os_full_speed && rc != SCRUB_NEXT_CONTINUE)
+		osd_scrub_control_speed(scrub, &scrub->os_scanned);
+
 	if (scrub->os_full_speed || rc == SCRUB_NEXT_CONTINUE)
 		return 0;
 
@@ -916,6 +1032,7 @@ static int osd_inode_iteration(struct osd_thread_info *info,
 	struct osd_iit_param  param;
 	__u32		      limit;
 	int		      noslot = 0;
+	bool		      first  = true;
 	int		      rc;
 	ENTRY;
 
@@ -943,6 +1060,10 @@ static int osd_inode_iteration(struct osd_thread_info *info,
 		param.bg = (*pos - 1) / LDISKFS_INODES_PER_GROUP(param.sb);
 		param.offset = (*pos - 1) % LDISKFS_INODES_PER_GROUP(param.sb);
 		param.gbase = 1 + param.bg * LDISKFS_INODES_PER_GROUP(param.sb);
+		/* once for each group, whatever the batches of preload */
+		if (param.offset == 0 || first)
+			osd_scrub_group_readahead(param.sb, param.bg + 1);
+		first = false;
 		param.bitmap = ldiskfs_read_inode_bitmap(param.sb, param.bg);
 		if (param.bitmap == NULL) {
 			CERROR("%.16s: fail to read bitmap for %u, "
@@ -1011,6 +1132,313 @@ static int osd_otable_it_preload(const struct lu_env *env,
 	RETURN(rc < 0 ? rc : ooc->ooc_cached_items);
 }
 
+/* parallel scrub */
+
+#define SCRUB_WORKER_DONE	(~0U)
+
+/* Take for \a osw the next range of inodes to check, up to the end of the
+ * SCRUB_GROUP_BATCH-th block group after the one it starts in. */
+static bool osd_scrub_take_range(struct osd_scrub *scrub,
+				 struct osd_scrub_worker *osw, __u32 *end)
+{
+	struct super_block *sb	  = osd_scrub2sb(scrub);
+	__u32		    ipg	  = LDISKFS_INODES_PER_GROUP(sb);
+	__u32		    limit;
+	bool		    taken = false;
+
+	limit = le32_to_cpu(LDISKFS_SB(sb)->s_es->s_inodes_count);
+	spin_lock(&scrub->os_lock);
+	if (scrub->os_pos_next <= limit && scrub->os_workers_rc == 0 &&
+	    thread_is_running(&scrub->os_thread)) {
+		osw->osw_pos = scrub->os_pos_next;
+		*end = 1 + ((osw->osw_pos - 1) / ipg + SCRUB_GROUP_BATCH) * ipg;
+		if (*end > limit + 1)
+			*end = limit + 1;
+		scrub->os_pos_next = *end;
+		taken = true;
+	} else {
+		osw->osw_pos = SCRUB_WORKER_DONE;
+	}
+	spin_unlock(&scrub->os_lock);
+
+	return taken;
+}
+
+/* The inodes before the returned one have all been checked. */
+static __u32 osd_scrub_workers_pos(struct osd_scrub *scrub)
+{
+	__u32 pos;
+	int   i;
+
+	spin_lock(&scrub->os_lock);
+	pos = scrub->os_pos_next;
+	for (i = 0; i < scrub->os_worker_count; i++)
+		pos = min(pos, scrub->os_workers[i].osw_pos);
+	spin_unlock(&scrub->os_lock);
+
+	return pos;
+}
+
+static int osd_scrub_worker_fail(struct osd_scrub *scrub)
+{
+	struct ptlrpc_thread *thread = &scrub->os_thread;
+
+	if (OBD_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_DELAY) && cfs_fail_val > 0) {
+		struct l_wait_info lwi;
+
+		lwi = LWI_TIMEOUT(cfs_time_seconds(cfs_fail_val), NULL, NULL);
+		l_wait_event(thread->t_ctl_waitq,
+			     !thread_is_running(thread),
+			     &lwi);
+	}
+
+	if (OBD_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_CRASH)) {
+		spin_lock(&scrub->os_lock);
+		thread_set_flags(thread, SVC_STOPPING);
+		spin_unlock(&scrub->os_lock);
+		return SCRUB_IT_CRASH;
+	}
+
+	if (OBD_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_FATAL))
+		return -EINVAL;
+
+	return 0;
+}
+
+/* Check the inodes of \a osw from osw_pos up to \a end. */
+static int osd_scrub_range(struct osd_thread_info *info,
+			   struct osd_scrub_worker *osw, __u32 end)
+{
+	struct osd_device	*dev   = osw->osw_dev;
+	struct osd_scrub	*scrub = &dev->od_scrub;
+	struct scrub_file	*sf    = &scrub->os_file;
+	struct super_block	*sb    = osd_sb(dev);
+	struct osd_idmap_cache	*oic   = &osw->osw_oic;
+	__u32			 ipg   = LDISKFS_INODES_PER_GROUP(sb);
+	struct buffer_head	*bitmap;
+	ldiskfs_group_t		 bg;
+	__u32			 gbase;
+	__u32			 offset;
+	__u32			 pos;
+	int			 rc    = 0;
+
+	while (osw->osw_pos < end) {
+		bg = (osw->osw_pos - 1) / ipg;
+		gbase = 1 + bg * ipg;
+		osd_scrub_group_readahead(sb, bg + 1);
+		bitmap = ldiskfs_read_inode_bitmap(sb, bg);
+		if (bitmap == NULL) {
+			CERROR("%.16s: fail to read bitmap for %u, "
+			       "scrub will stop, urgent mode\n",
+			       LDISKFS_SB(sb)->s_es->s_volume_name, (__u32)bg);
+			return -EIO;
+		}
+
+		for (offset = osw->osw_pos - gbase; ; offset++) {
+			offset = ldiskfs_find_next_bit(bitmap->b_data, ipg,
+						       offset);
+			pos = gbase + offset;
+			if (offset >= ipg || pos >= end)
+				break;
+
+			osw->osw_pos = pos;
+			rc = osd_scrub_worker_fail(scrub);
+			if (rc == 0 && (!thread_is_running(&scrub->os_thread) ||
+					scrub->os_workers_rc != 0))
+				rc = SCRUB_NEXT_EXIT;
+			if (rc != 0)
+				break;
+
+			rc = osd_iit_iget(info, dev, &oic->oic_fid,
+					  &oic->oic_lid, pos, sb, true);
+			if (rc == SCRUB_NEXT_CONTINUE) {
+				rc = 0;
+				continue;
+			}
+
+			if (rc == SCRUB_NEXT_NOSCRUB) {
+				spin_lock(&scrub->os_lock);
+				scrub->os_new_checked++;
+				sf->sf_items_noscrub++;
+				spin_unlock(&scrub->os_lock);
+				rc = 0;
+			} else {
+				rc = osd_scrub_check_update(info, dev, oic, rc,
+							    false);
+				if (rc != 0)
+					break;
+			}
+			osw->osw_checked++;
+			osd_scrub_control_speed(scrub, &osw->osw_scanned);
+		}
+		brelse(bitmap);
+		if (rc != 0)
+			return rc;
+
+		osw->osw_pos = min(gbase + ipg, end);
+	}
+
+	return 0;
+}
+
+static int osd_scrub_worker_main(void *args)
+{
+	struct osd_scrub_worker *osw   = args;
+	struct osd_scrub	*scrub = &osw->osw_dev->od_scrub;
+	struct lu_env		 env;
+	__u32			 end;
+	int			 rc;
+
+	rc = lu_env_init(&env, LCT_DT_THREAD);
+	if (rc == 0) {
+		while (osd_scrub_take_range(scrub, osw, &end)) {
+			rc = osd_scrub_range(osd_oti_get(&env), osw, end);
+			if (rc != 0)
+				break;
+		}
+		lu_env_fini(&env);
+	}
+
+	spin_lock(&scrub->os_lock);
+	if (rc != 0 && rc != SCRUB_NEXT_EXIT && scrub->os_workers_rc == 0)
+		scrub->os_workers_rc = rc;
+	if (cfs_atomic_dec_and_test(&scrub->os_workers_running))
+		cfs_waitq_broadcast(&scrub->os_thread.t_ctl_waitq);
+	spin_unlock(&scrub->os_lock);
+
+	return rc;
+}
+
+static void osd_scrub_workers_set(struct osd_scrub *scrub,
+				  struct osd_scrub_worker *workers, int count)
+{
+	/* os_rwsem: osd_scrub_dump() reads the threads */
+	down_write(&scrub->os_rwsem);
+	spin_lock(&scrub->os_lock);
+	scrub->os_workers = workers;
+	scrub->os_worker_count = count;
+	spin_unlock(&scrub->os_lock);
+	up_write(&scrub->os_rwsem);
+}
+
+/**
+ * Scrub with osd_scrub_threads threads, each of which checks the inodes of
+ * a range of block groups at a time, while this one checks the items found
+ * inconsistent by RPC, and records the position before which all inodes
+ * have been checked in the checkpoints. Only used at full speed: the scan
+ * is not in step with the preload of the otable iterator then.
+ */
+static int osd_scrub_parallel(struct osd_thread_info *info,
+			      struct osd_device *dev)
+{
+	struct osd_scrub	*scrub  = &dev->od_scrub;
+	struct ptlrpc_thread	*thread = &scrub->os_thread;
+	struct super_block	*sb	= osd_sb(dev);
+	struct osd_scrub_worker *workers;
+	struct osd_otable_it	*it;
+	struct l_wait_info	 lwi;
+	__u32			 limit;
+	__u32			 pos;
+	int			 count;
+	int			 started = 0;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	limit = le32_to_cpu(LDISKFS_SB(sb)->s_es->s_inodes_count);
+	count = min(osd_scrub_threads, SCRUB_THREADS_MAX);
+	OBD_ALLOC(workers, sizeof(*workers) * count);
+	if (workers == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		workers[i].osw_dev = dev;
+		workers[i].osw_index = i;
+		workers[i].osw_pos = SCRUB_WORKER_DONE;
+		workers[i].osw_time_start = cfs_time_current();
+	}
+	scrub->os_pos_next = scrub->os_pos_current;
+	scrub->os_workers_rc = 0;
+	cfs_atomic_set(&scrub->os_workers_running, count);
+	osd_scrub_workers_set(scrub, workers, count);
+
+	for (i = 0; i < count; i++) {
+		rc = PTR_ERR(kthread_run(osd_scrub_worker_main, &workers[i],
+					 "OI_scrub_%02d", i));
+		if (IS_ERR_VALUE(rc)) {
+			CERROR("%.16s: cannot start OI scrub thread %d, "
+			       "rc = %d\n",
+			       LDISKFS_SB(sb)->s_es->s_volume_name, i, rc);
+			cfs_atomic_dec(&scrub->os_workers_running);
+		} else {
+			started++;
+		}
+	}
+
+	if (started == 0) {
+		osd_scrub_workers_set(scrub, NULL, 0);
+		OBD_FREE(workers, sizeof(*workers) * count);
+		RETURN(osd_inode_iteration(info, dev, ~0U, false));
+	}
+
+	CDEBUG(D_LFSCK, "OI scrub: %d threads, pos = %u\n",
+	       started, scrub->os_pos_current);
+
+	while (cfs_atomic_read(&scrub->os_workers_running) > 0) {
+		lwi = LWI_TIMEOUT(cfs_time_seconds(1), NULL, NULL);
+		l_wait_event(thread->t_ctl_waitq,
+			     cfs_atomic_read(&scrub->os_workers_running) == 0 ||
+			     (!cfs_list_empty(&scrub->os_inconsistent_items) &&
+			      thread_is_running(thread)),
+			     &lwi);
+
+		while (thread_is_running(thread) &&
+		       !cfs_list_empty(&scrub->os_inconsistent_items)) {
+			struct osd_inconsistent_item *oii;
+
+			oii = cfs_list_entry(scrub->os_inconsistent_items.next,
+					     struct osd_inconsistent_item,
+					     oii_list);
+			rc = osd_scrub_check_update(info, dev, &oii->oii_cache,
+						    0, true);
+			if (rc != 0) {
+				spin_lock(&scrub->os_lock);
+				if (scrub->os_workers_rc == 0)
+					scrub->os_workers_rc = rc;
+				spin_unlock(&scrub->os_lock);
+				break;
+			}
+		}
+
+		scrub->os_pos_current = osd_scrub_workers_pos(scrub) - 1;
+		it = dev->od_otable_it;
+		if (it != NULL && it->ooi_waiting &&
+		    it->ooi_cache.ooc_pos_preload < scrub->os_pos_current) {
+			spin_lock(&scrub->os_lock);
+			it->ooi_waiting = 0;
+			cfs_waitq_broadcast(&thread->t_ctl_waitq);
+			spin_unlock(&scrub->os_lock);
+		}
+
+		rc = osd_scrub_checkpoint(scrub);
+		if (rc != 0)
+			CERROR("%.16s: fail to checkpoint, pos = %u, rc = %d\n",
+			       LDISKFS_SB(sb)->s_es->s_volume_name,
+			       scrub->os_pos_current, rc);
+	}
+
+	pos = osd_scrub_workers_pos(scrub);
+	scrub->os_pos_current = pos - 1;
+	rc = scrub->os_workers_rc;
+	if (rc == 0 && pos > limit)
+		rc = SCRUB_IT_ALL;
+
+	osd_scrub_workers_set(scrub, NULL, 0);
+	OBD_FREE(workers, sizeof(*workers) * count);
+
+	RETURN(rc);
+}
+
 static int osd_scrub_main(void *args)
 {
 	struct lu_env	      env;
@@ -1052,7 +1480,10 @@ static int osd_scrub_main(void *args)
 	CDEBUG(D_LFSCK, "OI scrub: flags = 0x%x, pos = %u\n",
 	       scrub->os_start_flags, scrub->os_pos_current);
 
-	rc = osd_inode_iteration(osd_oti_get(&env), dev, ~0U, false);
+	if (scrub->os_full_speed && osd_scrub_threads > 1)
+		rc = osd_scrub_parallel(osd_oti_get(&env), dev);
+	else
+		rc = osd_inode_iteration(osd_oti_get(&env), dev, ~0U, false);
 	if (unlikely(rc == SCRUB_IT_CRASH))
 		GOTO(out, rc = -EINVAL);
 	GOTO(post, rc);
@@ -2207,6 +2638,50 @@ static int scrub_pos_dump(char **buf, int *len, __u64 pos, const char *prefix)
 	return rc;
 }
 
+/* progress and speed of each thread of the parallel scrub */
+static int scrub_workers_dump(char **buf, int *len, struct osd_scrub *scrub)
+{
+	struct osd_scrub_worker *osw;
+	cfs_duration_t		 duration;
+	__u64			 speed;
+	int			 save = *len;
+	int			 rc;
+	int			 i;
+
+	if (scrub->os_workers == NULL)
+		return 0;
+
+	rc = snprintf(*buf, *len, "threads: %d\n", scrub->os_worker_count);
+	if (rc <= 0)
+		return -ENOSPC;
+
+	*buf += rc;
+	*len -= rc;
+	for (i = 0; i < scrub->os_worker_count; i++) {
+		osw = &scrub->os_workers[i];
+		duration = cfs_time_current() - osw->osw_time_start;
+		speed = osw->osw_checked * CFS_HZ;
+		if (duration != 0)
+			do_div(speed, duration);
+		if (osw->osw_pos == SCRUB_WORKER_DONE)
+			rc = snprintf(*buf, *len, "thread_%02d: position: N/A, "
+				      "checked: "LPU64", speed: "LPU64
+				      " objects/sec\n", osw->osw_index,
+				      osw->osw_checked, speed);
+		else
+			rc = snprintf(*buf, *len, "thread_%02d: position: %u, "
+				      "checked: "LPU64", speed: "LPU64
+				      " objects/sec\n", osw->osw_index,
+				      osw->osw_pos, osw->osw_checked, speed);
+		if (rc <= 0)
+			return -ENOSPC;
+
+		*buf += rc;
+		*len -= rc;
+	}
+	return save - *len;
+}
+
 int osd_scrub_dump(struct osd_device *dev, char *buf, int len)
 {
 	struct osd_scrub  *scrub   = &dev->od_scrub;
@@ -2320,6 +2795,20 @@ int osd_scrub_dump(struct osd_device *dev, char *buf, int len)
 
 	buf += rc;
 	len -= rc;
+	if (scrub->os_latency_target != 0 && scrub->os_rate.osr_rate != 0)
+		rc = snprintf(buf, len, "speed_limit: %u objects/sec\n",
+			      scrub->os_rate.osr_rate);
+	else
+		rc = snprintf(buf, len, "speed_limit: N/A\n");
+	if (rc <= 0)
+		goto out;
+
+	buf += rc;
+	len -= rc;
+	rc = scrub_workers_dump(&buf, &len, scrub);
+	if (rc < 0)
+		goto out;
+
 	ret = save - len;
 
 out:
@@ -33,12 +33,16 @@
 #ifndef _OSD_SCRUB_H
 # define _OSD_SCRUB_H
 
+#include <obd_class.h>
 #include "osd_oi.h"
 
 #define SCRUB_MAGIC_V1			0x4C5FD252
 #define SCRUB_CHECKPOINT_INTERVAL	60
 #define SCRUB_OI_BITMAP_SIZE		(OSD_OI_FID_NR_MAX >> 3)
 #define SCRUB_WINDOW_SIZE		1024
+#define SCRUB_THREADS_MAX		32
+/* block groups handed out at once to a thread of the parallel scrub */
+#define SCRUB_GROUP_BATCH		16
 
 enum scrub_status {
 	/* The scrub file is new created, for new MDT, upgrading from old disk,
@@ -167,6 +171,29 @@ struct scrub_file {
 	__u8    sf_oi_bitmap[SCRUB_OI_BITMAP_SIZE];
 };
 
+struct osd_device;
+
+/* A thread of the parallel OI scrub, which checks the inodes of the ranges
+ * of block groups it takes in turn. */
+struct osd_scrub_worker {
+	struct osd_device	*osw_dev;
+	struct osd_idmap_cache	 osw_oic;
+
+	/* The inode to be checked next, all those before it in the ranges
+	 * taken by the thread have been checked. */
+	__u32			 osw_pos;
+	int			 osw_index;
+
+	/* How many objects the thread has checked. */
+	__u64			 osw_checked;
+
+	/* Objects checked since the last adaptive speed control. */
+	__u32			 osw_scanned;
+
+	/* When the thread started, jiffies */
+	cfs_time_t		 osw_time_start;
+};
+
 struct osd_scrub {
 	struct lvfs_run_ctxt    os_ctxt;
 	struct ptlrpc_thread    os_thread;
@@ -197,6 +224,21 @@ struct osd_scrub {
 	__u32			os_new_checked;
 	__u32			os_pos_current;
 	__u32			os_start_flags;
+
+	/* Threads of the parallel scrub, with the first inode of the range
+	 * to be taken next and the first failure, under os_lock. */
+	struct osd_scrub_worker *os_workers;
+	int			os_worker_count;
+	cfs_atomic_t		os_workers_running;
+	__u32			os_pos_next;
+	int			os_workers_rc;
+
+	/* Scan rate adapted to the load of the node when a service latency
+	 * target (usec) is set, under os_lock. */
+	struct obd_scan_rate	os_rate;
+	__u32			os_latency_target;
+	__u32			os_scanned;
+
 	unsigned int		os_in_prior:1, /* process inconsistent item
 						* found by RPC prior */
 				os_waiting:1, /* Waiting for scan window. */
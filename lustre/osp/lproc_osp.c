@@ -195,6 +195,40 @@ static int osp_wr_max_rpcs_in_prog(struct file *file, const char *buffer,
 	return count;
 }
 
+static int osp_rd_max_sync_batch(char *page, char **start, off_t off,
+				 int count, int *eof, void *data)
+{
+	struct obd_device *dev = data;
+	struct osp_device *osp = lu2osp_dev(dev->obd_lu_dev);
+
+	if (osp == NULL)
+		return -EINVAL;
+
+	return snprintf(page, count, "%d\n", osp->opd_syn_max_batch);
+}
+
+static int osp_wr_max_sync_batch(struct file *file, const char *buffer,
+				 unsigned long count, void *data)
+{
+	struct obd_device	*dev = data;
+	struct osp_device	*osp = lu2osp_dev(dev->obd_lu_dev);
+	int			 val, rc;
+
+	if (osp == NULL)
+		return -EINVAL;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	/* 0 or 1 sends one RPC per change */
+	if (val < 0 || val > OST_SYNC_BATCH_MAX)
+		return -ERANGE;
+
+	osp->opd_syn_max_batch = val;
+	return count;
+}
+
 static int osp_rd_create_count(char *page, char **start, off_t off, int count,
 			       int *eof, void *data)
 {
@@ -238,7 +272,12 @@ static int osp_wr_create_count(struct file *file, const char *buffer,
 
 	for (i = 1; (i << 1) <= val; i <<= 1)
 		;
+	/* the precreates are sized from the create rate, but never
+	 * below the count set here */
+	spin_lock(&osp->opd_pre_lock);
+	osp->opd_pre_min_grow_count = i;
 	osp->opd_pre_grow_count = i;
+	spin_unlock(&osp->opd_pre_lock);
 
 	return count;
 }
@@ -274,10 +313,14 @@ static int osp_wr_max_create_count(struct file *file, const char *buffer,
 	if (val > OST_MAX_PRECREATE)
 		return -ERANGE;
 
+	spin_lock(&osp->opd_pre_lock);
 	if (osp->opd_pre_grow_count > val)
 		osp->opd_pre_grow_count = val;
+	if (osp->opd_pre_min_grow_count > val)
+		osp->opd_pre_min_grow_count = val;
 
 	osp->opd_pre_max_grow_count = val;
+	spin_unlock(&osp->opd_pre_lock);
 
 	return count;
 }
@@ -346,6 +389,59 @@ static int osp_rd_prealloc_reserved(char *page, char **start, off_t off,
 	return snprintf(page, count, LPU64"\n", osp->opd_pre_reserved);
 }
 
+/* the create rate forecast the precreates are sized from, and how often
+ * and long creates had to wait for them */
+static int osp_rd_prealloc_stats(char *page, char **start, off_t off,
+				 int count, int *eof, void *data)
+{
+	struct obd_device *obd = data;
+	struct osp_device *osp = lu2osp_dev(obd->obd_lu_dev);
+	int		   rc;
+
+	if (osp == NULL)
+		return 0;
+
+	spin_lock(&osp->opd_pre_lock);
+	rc = snprintf(page, count,
+		      "create_rate: %d\n"
+		      "create_count: %d\n"
+		      "rpc_usec: %ld\n"
+		      "depth: "LPD64"\n"
+		      "waiters: %d\n"
+		      "waits: "LPU64"\n"
+		      "wait_usec: "LPU64"\n"
+		      "wait_max_usec: %ld\n",
+		      osp->opd_pre_create_rate, osp->opd_pre_grow_count,
+		      osp->opd_pre_rpc_usec,
+		      lu_fid_diff(&osp->opd_pre_last_created_fid,
+				  &osp->opd_pre_used_fid) -
+		      (__s64)osp->opd_pre_reserved,
+		      osp->opd_pre_waiters, osp->opd_pre_waits,
+		      osp->opd_pre_wait_usec, osp->opd_pre_wait_max_usec);
+	spin_unlock(&osp->opd_pre_lock);
+
+	return rc;
+}
+
+/* any write clears the wait counters */
+static int osp_wr_prealloc_stats(struct file *file, const char *buffer,
+				 unsigned long count, void *data)
+{
+	struct obd_device *obd = data;
+	struct osp_device *osp = lu2osp_dev(obd->obd_lu_dev);
+
+	if (osp == NULL)
+		return 0;
+
+	spin_lock(&osp->opd_pre_lock);
+	osp->opd_pre_waits = 0;
+	osp->opd_pre_wait_usec = 0;
+	osp->opd_pre_wait_max_usec = 0;
+	spin_unlock(&osp->opd_pre_lock);
+
+	return count;
+}
+
 static int osp_rd_maxage(char *page, char **start, off_t off,
 			 int count, int *eof, void *data)
 {
@@ -437,6 +533,8 @@ static struct lprocfs_vars lprocfs_osp_obd_vars[] = {
 				osp_wr_max_rpcs_in_flight, 0 },
 	{ "max_rpcs_in_progress", osp_rd_max_rpcs_in_prog,
 				  osp_wr_max_rpcs_in_prog, 0 },
+	{ "max_sync_batch",	osp_rd_max_sync_batch,
+				osp_wr_max_sync_batch, 0 },
 	{ "create_count",	osp_rd_create_count,
 				osp_wr_create_count, 0 },
 	{ "max_create_count",	osp_rd_max_create_count,
@@ -446,6 +544,8 @@ static struct lprocfs_vars lprocfs_osp_obd_vars[] = {
 	{ "prealloc_last_id",   osp_rd_prealloc_last_id,  0, 0 },
 	{ "prealloc_last_seq",  osp_rd_prealloc_last_seq, 0, 0 },
 	{ "prealloc_reserved",	osp_rd_prealloc_reserved, 0, 0 },
+	{ "prealloc_stats",	osp_rd_prealloc_stats,
+				osp_wr_prealloc_stats, 0 },
 	{ "timeouts",		lprocfs_rd_timeouts, 0, 0 },
 	{ "import",		lprocfs_rd_import, lprocfs_wr_import, 0 },
 	{ "state",		lprocfs_rd_state, 0, 0 },
@@ -132,6 +132,20 @@ struct osp_device {
 	int				 opd_pre_grow_slow;
 	/* cleaning up orphans or recreating missing objects */
 	int				 opd_pre_recovering;
+	/* forecast of the create rate the precreates are sized from:
+	 * objects reserved since opd_pre_rate_start, and their moving
+	 * average in objects per second */
+	int				 opd_pre_rate_used;
+	cfs_time_t			 opd_pre_rate_start;
+	int				 opd_pre_create_rate;
+	/* moving average of the precreate RPC time, in usec */
+	long				 opd_pre_rpc_usec;
+	/* threads waiting in osp_precreate_reserve() for objects, how
+	 * often they had to, and for how long */
+	int				 opd_pre_waiters;
+	__u64				 opd_pre_waits;
+	__u64				 opd_pre_wait_usec;
+	long				 opd_pre_wait_max_usec;
 
 	/*
 	 * OST synchronization
@@ -156,6 +170,11 @@ struct osp_device {
 	/* number of RPC in processing (including non-committed by OST) */
 	int				 opd_syn_rpc_in_progress;
 	int				 opd_syn_max_rpc_in_progress;
+	/* OST_SYNC_BATCH being filled with changes by the sync thread,
+	 * how many changes it holds, and how many it may hold */
+	struct ptlrpc_request		*opd_syn_batch;
+	int				 opd_syn_batch_count;
+	int				 opd_syn_max_batch;
 	/* osd api's commit cb control structure */
 	struct dt_txn_callback		 opd_syn_txn_cb;
 	/* last used change number -- semantically similar to transno */
@@ -1066,14 +1066,24 @@ static int osp_md_declare_object_destroy(const struct lu_env *env,
 					 struct dt_object *dt,
 					 struct thandle *th)
 {
-	struct osp_object  *o = dt2osp_obj(dt);
-	int                 rc = 0;
+	struct update_request	*update;
+	struct lu_fid		*fid;
+	int			 rc;
 	ENTRY;
 
-	/*
-	 * track objects to be destroyed via llog
-	 */
-	rc = osp_sync_declare_add(env, o, MDS_UNLINK64_REC, th);
+	/* the llog of osp_sync_add() is only set up for OSTs, a remote MDT
+	 * object is destroyed by an update like the other changes */
+	update = osp_find_create_update_loc(th, dt);
+	if (IS_ERR(update)) {
+		CERROR("%s: Get OSP update buf failed: rc = %d\n",
+		       dt->do_lu.lo_dev->ld_obd->obd_name,
+		       (int)PTR_ERR(update));
+		RETURN(PTR_ERR(update));
+	}
+
+	fid = (struct lu_fid *)lu_object_fid(&dt->do_lu);
+
+	rc = osp_insert_update(env, update, OBJ_DESTROY, fid, 0, NULL, NULL);
 
 	RETURN(rc);
 }
@@ -1081,20 +1091,14 @@ static int osp_md_declare_object_destroy(const struct lu_env *env,
 static int osp_md_object_destroy(const struct lu_env *env,
 				 struct dt_object *dt, struct thandle *th)
 {
-	struct osp_object  *o = dt2osp_obj(dt);
-	int                 rc = 0;
-	ENTRY;
-
-	/*
-	 * once transaction is committed put proper command on
-	 * the queue going to our OST
-	 */
-	rc = osp_sync_add(env, o, MDS_UNLINK64_REC, th, NULL);
+	CDEBUG(D_INFO, "destroy object "DFID"\n",
+	       PFID(&dt->do_lu.lo_header->loh_fid));
 
+	dt->do_lu.lo_header->loh_attr &= ~LOHA_EXISTS;
 	/* not needed in cache any more */
 	set_bit(LU_OBJECT_HEARD_BANSHEE, &dt->do_lu.lo_header->loh_flags);
 
-	RETURN(rc);
+	return 0;
 }
 
 static int osp_md_object_lock(const struct lu_env *env,
@@ -245,6 +245,72 @@ static inline int osp_precreate_near_empty(const struct lu_env *env,
 	return rc;
 }
 
+/* interval the create rate is sampled over */
+#define OSP_PRE_RATE_INTERVAL	cfs_time_seconds(1)
+/* precreate enough objects for this many precreate RPC times... */
+#define OSP_PRE_AHEAD_RPCS	4
+/* ...and for no less than this long, in usec */
+#define OSP_PRE_AHEAD_MIN_USEC	200000
+
+/*
+ * Fold the objects reserved over the last intervals into the forecast of
+ * the create rate, a moving average weighing each interval by 1/4, so that
+ * it decays when the creates stop.
+ */
+static void osp_pre_rate_update_nolock(struct osp_device *d)
+{
+	cfs_duration_t	elapsed;
+	__u64		rate;
+	int		i;
+
+	elapsed = cfs_time_sub(cfs_time_current(), d->opd_pre_rate_start);
+	if (elapsed < OSP_PRE_RATE_INTERVAL)
+		return;
+
+	rate = (__u64)d->opd_pre_rate_used * CFS_HZ;
+	do_div(rate, elapsed);
+	for (i = 0; i < elapsed / OSP_PRE_RATE_INTERVAL && i < 16; i++)
+		d->opd_pre_create_rate = (3 * d->opd_pre_create_rate +
+					  (int)rate) / 4;
+	/* round the tail of a decay down to nothing */
+	if (rate == 0 && d->opd_pre_create_rate < 4)
+		d->opd_pre_create_rate = 0;
+
+	d->opd_pre_rate_used = 0;
+	d->opd_pre_rate_start = cfs_time_current();
+}
+
+/*
+ * How many objects to precreate next: as many as the forecast create rate
+ * uses over a few precreate RPC times, so that the next precreate is sent
+ * and back before the pool runs dry. A burst is caught up with from the
+ * rate of the interval in progress, before it shows in the average.
+ */
+static int osp_pre_forecast_nolock(struct osp_device *d)
+{
+	cfs_duration_t	elapsed;
+	__u64		rate, cur;
+	long		ahead;
+
+	osp_pre_rate_update_nolock(d);
+
+	rate = d->opd_pre_create_rate;
+	elapsed = max_t(cfs_duration_t, OSP_PRE_RATE_INTERVAL / 10,
+			cfs_time_sub(cfs_time_current(),
+				     d->opd_pre_rate_start));
+	cur = (__u64)d->opd_pre_rate_used * CFS_HZ;
+	do_div(cur, elapsed);
+	rate = max(rate, cur);
+
+	ahead = max_t(long, OSP_PRE_AHEAD_MIN_USEC,
+		      OSP_PRE_AHEAD_RPCS * d->opd_pre_rpc_usec);
+	rate *= ahead;
+	do_div(rate, 1000000);
+
+	rate = max_t(__u64, rate, d->opd_pre_min_grow_count);
+	return min_t(__u64, rate, d->opd_pre_max_grow_count / 2);
+}
+
 static inline int osp_create_end_seq(const struct lu_env *env,
 				     struct osp_device *osp)
 {
@@ -414,6 +480,8 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	struct ptlrpc_request	*req;
 	struct obd_import	*imp;
 	struct ost_body		*body;
+	struct timeval		 start, end;
+	long			 usec;
 	int			 rc, grow, diff;
 	struct lu_fid		*fid = &oti->osi_fid;
 	ENTRY;
@@ -446,9 +514,11 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	}
 
 	spin_lock(&d->opd_pre_lock);
-	if (d->opd_pre_grow_count > d->opd_pre_max_grow_count / 2)
-		d->opd_pre_grow_count = d->opd_pre_max_grow_count / 2;
-	grow = d->opd_pre_grow_count;
+	grow = osp_pre_forecast_nolock(d);
+	/* the OST did not manage the last batch, don't ask for more */
+	if (d->opd_pre_grow_slow && grow > d->opd_pre_grow_count)
+		grow = d->opd_pre_grow_count;
+	d->opd_pre_grow_count = grow;
 	spin_unlock(&d->opd_pre_lock);
 
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
@@ -478,6 +548,7 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 
 	ptlrpc_request_set_replen(req);
 
+	cfs_gettimeofday(&start);
 	rc = ptlrpc_queue_wait(req);
 	if (rc) {
 		CERROR("%s: can't precreate: rc = %d\n", d->opd_obd->obd_name,
@@ -485,6 +556,8 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 		GOTO(out_req, rc);
 	}
 	LASSERT(req->rq_transno == 0);
+	cfs_gettimeofday(&end);
+	usec = cfs_timeval_sub(&end, &start, NULL);
 
 	body = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
 	if (body == NULL)
@@ -498,6 +571,8 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	diff = lu_fid_diff(fid, &d->opd_pre_last_created_fid);
 
 	spin_lock(&d->opd_pre_lock);
+	d->opd_pre_rpc_usec = d->opd_pre_rpc_usec == 0 ? usec :
+			      (3 * d->opd_pre_rpc_usec + usec) / 4;
 	if (diff < grow) {
 		/* the OST has not managed to create all the
 		 * objects we asked for */
@@ -1039,7 +1114,10 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d)
 {
 	struct l_wait_info	 lwi;
 	cfs_time_t		 expire = cfs_time_shift(obd_timeout);
-	int			 precreated, rc;
+	struct timeval		 start, end;
+	long			 usec;
+	int			 precreated, grow, rc;
+	int			 waited = 0;
 
 	ENTRY;
 
@@ -1057,24 +1135,18 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d)
 	while ((rc = d->opd_pre_status) == 0 || rc == -ENOSPC ||
 		rc == -ENODEV || rc == -EAGAIN) {
 
-		/*
-		 * increase number of precreations
-		 */
-		precreated = osp_objs_precreated(env, d);
-		if (d->opd_pre_grow_count < d->opd_pre_max_grow_count &&
-		    d->opd_pre_grow_slow == 0 &&
-		    precreated <= (d->opd_pre_grow_count / 4 + 1)) {
-			spin_lock(&d->opd_pre_lock);
-			d->opd_pre_grow_slow = 1;
-			d->opd_pre_grow_count *= 2;
-			spin_unlock(&d->opd_pre_lock);
-		}
-
 		spin_lock(&d->opd_pre_lock);
 		precreated = osp_objs_precreated(env, d);
 		if (precreated > d->opd_pre_reserved &&
 		    !d->opd_pre_recovering) {
 			d->opd_pre_reserved++;
+			d->opd_pre_rate_used++;
+			/* raise the batch as soon as the forecast does, so
+			 * that the next precreate starts early enough */
+			grow = osp_pre_forecast_nolock(d);
+			if (grow > d->opd_pre_grow_count &&
+			    d->opd_pre_grow_slow == 0)
+				d->opd_pre_grow_count = grow;
 			spin_unlock(&d->opd_pre_lock);
 			rc = 0;
 
@@ -1119,8 +1191,31 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d)
 			break;
 		}
 
+		if (!waited) {
+			cfs_gettimeofday(&start);
+			waited = 1;
+		}
+		spin_lock(&d->opd_pre_lock);
+		d->opd_pre_waiters++;
+		spin_unlock(&d->opd_pre_lock);
+
 		l_wait_event(d->opd_pre_user_waitq,
 			     osp_precreate_ready_condition(env, d), &lwi);
+
+		spin_lock(&d->opd_pre_lock);
+		d->opd_pre_waiters--;
+		spin_unlock(&d->opd_pre_lock);
+	}
+
+	if (waited) {
+		cfs_gettimeofday(&end);
+		usec = cfs_timeval_sub(&end, &start, NULL);
+		spin_lock(&d->opd_pre_lock);
+		d->opd_pre_waits++;
+		d->opd_pre_wait_usec += usec;
+		if (usec > d->opd_pre_wait_max_usec)
+			d->opd_pre_wait_max_usec = usec;
+		spin_unlock(&d->opd_pre_lock);
 	}
 
 	RETURN(rc);
@@ -1251,6 +1346,14 @@ int osp_init_precreate(struct osp_device *d)
 	d->opd_pre_grow_count = OST_MIN_PRECREATE;
 	d->opd_pre_min_grow_count = OST_MIN_PRECREATE;
 	d->opd_pre_max_grow_count = OST_MAX_PRECREATE;
+	d->opd_pre_rate_used = 0;
+	d->opd_pre_rate_start = cfs_time_current();
+	d->opd_pre_create_rate = 0;
+	d->opd_pre_rpc_usec = 0;
+	d->opd_pre_waiters = 0;
+	d->opd_pre_waits = 0;
+	d->opd_pre_wait_usec = 0;
+	d->opd_pre_wait_max_usec = 0;
 
 	spin_lock_init(&d->opd_pre_lock);
 	cfs_waitq_init(&d->opd_pre_waitq);
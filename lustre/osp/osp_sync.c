@@ -85,6 +85,13 @@ static void osp_sync_remove_from_tracker(struct osp_device *d);
  *
  * opd_syn_rpc_in_flight is a number of RPC in flight.
  * we control this with OSP_MAX_IN_FLIGHT
+ *
+ * if the OST supports OBD_CONNECT_SYNC_BATCH, the changes are not sent one
+ * per RPC but gathered into OST_SYNC_BATCH requests of up to
+ * opd_syn_max_batch changes. a batch is sent once full, or when the thread
+ * has no more changes to add to it for now. it counts as one RPC in the
+ * limits above, and its llog records are cancelled together once the OST
+ * commits it.
  */
 
 /* XXX: do math to learn reasonable threshold
@@ -93,6 +100,7 @@ static void osp_sync_remove_from_tracker(struct osp_device *d);
 #define OSP_SYN_THRESHOLD	10
 #define OSP_MAX_IN_FLIGHT	8
 #define OSP_MAX_IN_PROGRESS	4096
+#define OSP_SYNC_BATCH		64
 
 #define OSP_JOB_MAGIC		0x26112005
 
@@ -149,14 +157,23 @@ void __osp_sync_check_for_work(struct osp_device *d)
 	osp_sync_check_for_work(d);
 }
 
+static inline int osp_sync_batching(struct osp_device *d)
+{
+	struct obd_import *imp = d->opd_obd->u.cli.cl_import;
+
+	return d->opd_syn_max_batch > 1 &&
+	       imp->imp_connect_data.ocd_connect_flags & OBD_CONNECT_SYNC_BATCH;
+}
+
 static inline int osp_sync_can_process_new(struct osp_device *d,
 					   struct llog_rec_hdr *rec)
 {
 	LASSERT(d);
 
-	if (!osp_sync_low_in_progress(d))
+	/* a batch being filled has room for one more change */
+	if (d->opd_syn_batch == NULL && !osp_sync_low_in_progress(d))
 		return 0;
-	if (!osp_sync_low_in_flight(d))
+	if (d->opd_syn_batch == NULL && !osp_sync_low_in_flight(d))
 		return 0;
 	if (!d->opd_imp_connected)
 		return 0;
@@ -554,6 +571,269 @@ static int osp_sync_new_unlink64_job(struct osp_device *d,
 	RETURN(0);
 }
 
+/*
+ * send the change of llog record \a rec in an RPC of its own
+ */
+static int osp_sync_send_job(struct osp_device *d, struct llog_handle *llh,
+			     struct llog_rec_hdr *rec)
+{
+	int rc;
+
+	/* notice we increment counters before sending RPC, to be consistent
+	 * in RPC interpret callback which may happen very quickly */
+	spin_lock(&d->opd_syn_lock);
+	d->opd_syn_rpc_in_flight++;
+	d->opd_syn_rpc_in_progress++;
+	spin_unlock(&d->opd_syn_lock);
+
+	switch (rec->lrh_type) {
+	/* case MDS_UNLINK_REC is kept for compatibility */
+	case MDS_UNLINK_REC:
+		rc = osp_sync_new_unlink_job(d, llh, rec);
+		break;
+	case MDS_UNLINK64_REC:
+		rc = osp_sync_new_unlink64_job(d, llh, rec);
+		break;
+	case MDS_SETATTR64_REC:
+		rc = osp_sync_new_setattr_job(d, llh, rec);
+		break;
+	default:
+		CERROR("unknown record type: %x\n", rec->lrh_type);
+		       rc = -EINVAL;
+		       break;
+	}
+
+	if (rc != 0) {
+		spin_lock(&d->opd_syn_lock);
+		d->opd_syn_rpc_in_flight--;
+		d->opd_syn_rpc_in_progress--;
+		spin_unlock(&d->opd_syn_lock);
+	}
+	return rc;
+}
+
+static struct ptlrpc_request *osp_sync_new_batch(struct osp_device *d)
+{
+	struct ptlrpc_request	*req;
+	struct obd_import	*imp;
+	int			 max;
+	int			 rc;
+
+	imp = d->opd_obd->u.cli.cl_import;
+	LASSERT(imp);
+	req = ptlrpc_request_alloc(imp, &RQF_OST_SYNC_BATCH);
+	if (req == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	/* room for a full batch, shrunk to the changes it got once sent */
+	max = min(d->opd_syn_max_batch, OST_SYNC_BATCH_MAX);
+	req_capsule_set_size(&req->rq_pill, &RMF_OST_SYNC_REC, RCL_CLIENT,
+			     max * sizeof(struct ost_sync_rec));
+	req_capsule_set_size(&req->rq_pill, &RMF_LOGCOOKIES, RCL_CLIENT,
+			     max * sizeof(struct llog_cookie));
+	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, OST_SYNC_BATCH);
+	if (rc) {
+		ptlrpc_request_free(req);
+		return ERR_PTR(rc);
+	}
+
+	CFS_INIT_LIST_HEAD(&req->rq_exp_list);
+	req->rq_svc_thread = (void *) OSP_JOB_MAGIC;
+
+	req->rq_interpret_reply = osp_sync_interpret;
+	req->rq_commit_cb = osp_sync_request_commit_cb;
+	req->rq_cb_data = d;
+
+	return req;
+}
+
+/*
+ * drop the batch being filled when the thread stops: its llog records are
+ * not cancelled and will be processed again on the next mount
+ */
+static void osp_sync_drop_batch(struct osp_device *d)
+{
+	if (d->opd_syn_batch == NULL)
+		return;
+
+	ptlrpc_req_finished(d->opd_syn_batch);
+	d->opd_syn_batch = NULL;
+	d->opd_syn_batch_count = 0;
+
+	spin_lock(&d->opd_syn_lock);
+	d->opd_syn_rpc_in_flight--;
+	d->opd_syn_rpc_in_progress--;
+	spin_unlock(&d->opd_syn_lock);
+}
+
+/*
+ * send the batch being filled, if any
+ */
+static void osp_sync_send_batch(struct osp_device *d)
+{
+	struct ptlrpc_request	*req = d->opd_syn_batch;
+	struct req_capsule	*pill;
+	int			 count = d->opd_syn_batch_count;
+
+	if (req == NULL)
+		return;
+
+	/* the first change of the batch could not be added */
+	if (count == 0) {
+		osp_sync_drop_batch(d);
+		return;
+	}
+
+	d->opd_syn_batch = NULL;
+	d->opd_syn_batch_count = 0;
+
+	pill = &req->rq_pill;
+	req_capsule_shrink(pill, &RMF_OST_SYNC_REC,
+			   count * sizeof(struct ost_sync_rec), RCL_CLIENT);
+	req_capsule_shrink(pill, &RMF_LOGCOOKIES,
+			   count * sizeof(struct llog_cookie), RCL_CLIENT);
+	req_capsule_set_size(pill, &RMF_OST_SYNC_REC, RCL_SERVER,
+			     count * sizeof(struct ost_sync_rec));
+	ptlrpc_request_set_replen(req);
+
+	CDEBUG(D_HA, "%s: send batch of %d changes\n", d->opd_obd->obd_name,
+	       count);
+	osp_sync_send_new_rpc(d, req);
+}
+
+/*
+ * add the change of llog record \a h to the batch being filled, starting
+ * a new one if needed, and send the batch once full
+ */
+static int osp_sync_batch_add(struct osp_device *d, struct llog_handle *llh,
+			      struct llog_rec_hdr *h)
+{
+	struct req_capsule	*pill;
+	struct ost_sync_rec	*osr;
+	struct llog_cookie	*cookie;
+	int			 max;
+	int			 rc;
+
+	if (d->opd_syn_batch == NULL) {
+		struct ptlrpc_request *req;
+
+		/* the batch is one RPC in flight and in progress, from its
+		 * first change on, see osp_sync_process_record() */
+		spin_lock(&d->opd_syn_lock);
+		d->opd_syn_rpc_in_flight++;
+		d->opd_syn_rpc_in_progress++;
+		spin_unlock(&d->opd_syn_lock);
+
+		req = osp_sync_new_batch(d);
+		if (IS_ERR(req)) {
+			spin_lock(&d->opd_syn_lock);
+			d->opd_syn_rpc_in_flight--;
+			d->opd_syn_rpc_in_progress--;
+			spin_unlock(&d->opd_syn_lock);
+			return PTR_ERR(req);
+		}
+		d->opd_syn_batch = req;
+		d->opd_syn_batch_count = 0;
+	}
+
+	pill = &d->opd_syn_batch->rq_pill;
+	osr = req_capsule_client_get(pill, &RMF_OST_SYNC_REC);
+	cookie = req_capsule_client_get(pill, &RMF_LOGCOOKIES);
+	LASSERT(osr != NULL && cookie != NULL);
+	osr += d->opd_syn_batch_count;
+	cookie += d->opd_syn_batch_count;
+
+	memset(osr, 0, sizeof(*osr));
+	switch (h->lrh_type) {
+	/* case MDS_UNLINK_REC is kept for compatibility */
+	case MDS_UNLINK_REC: {
+		struct llog_unlink_rec *rec = (struct llog_unlink_rec *)h;
+
+		osr->osr_opc = OST_DESTROY;
+		ostid_set_seq(&osr->osr_oi, rec->lur_oseq);
+		ostid_set_id(&osr->osr_oi, rec->lur_oid);
+		osr->osr_count = rec->lur_count;
+		break;
+	}
+	case MDS_UNLINK64_REC: {
+		struct llog_unlink64_rec *rec = (struct llog_unlink64_rec *)h;
+
+		osr->osr_opc = OST_DESTROY;
+		rc = fid_to_ostid(&rec->lur_fid, &osr->osr_oi);
+		if (rc < 0)
+			return rc;
+		osr->osr_count = rec->lur_count;
+		break;
+	}
+	case MDS_SETATTR64_REC: {
+		struct llog_setattr64_rec *rec = (struct llog_setattr64_rec *)h;
+
+		osr->osr_opc = OST_SETATTR;
+		osr->osr_oi = rec->lsr_oi;
+		osr->osr_uid = rec->lsr_uid;
+		osr->osr_gid = rec->lsr_gid;
+		break;
+	}
+	default:
+		CERROR("unknown record type: %x\n", h->lrh_type);
+		return -EINVAL;
+	}
+
+	cookie->lgc_lgl = llh->lgh_id;
+	cookie->lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
+	cookie->lgc_index = h->lrh_index;
+
+	max = req_capsule_get_size(pill, &RMF_OST_SYNC_REC, RCL_CLIENT) /
+	      sizeof(*osr);
+	if (++d->opd_syn_batch_count == max)
+		osp_sync_send_batch(d);
+
+	return 0;
+}
+
+/*
+ * cancel the llog records of the changes of a committed OST_SYNC_BATCH that
+ * were applied or found no object, the others are kept for the next mount
+ */
+static void osp_sync_batch_cancel(const struct lu_env *env,
+				  struct osp_device *d,
+				  struct llog_handle *llh,
+				  struct ptlrpc_request *req)
+{
+	struct req_capsule	*pill = &req->rq_pill;
+	struct ost_sync_rec	*osr = NULL;
+	struct llog_cookie	*cookies;
+	int			 count;
+	int			 i;
+	int			 rc;
+
+	cookies = req_capsule_client_get(pill, &RMF_LOGCOOKIES);
+	LASSERT(cookies != NULL);
+	count = req_capsule_get_size(pill, &RMF_LOGCOOKIES, RCL_CLIENT) /
+		sizeof(*cookies);
+
+	if (req->rq_repmsg != NULL &&
+	    req_capsule_get_size(pill, &RMF_OST_SYNC_REC, RCL_SERVER) ==
+	    count * sizeof(*osr))
+		osr = req_capsule_server_get(pill, &RMF_OST_SYNC_REC);
+
+	for (i = 0; i < count; i++) {
+		if (osr != NULL && osr[i].osr_rc != 0 &&
+		    osr[i].osr_rc != -ENOENT) {
+			CDEBUG(D_HA, "%s: change %u of "DOSTID" failed: "
+			       "rc = %d\n", d->opd_obd->obd_name,
+			       osr[i].osr_opc, POSTID(&osr[i].osr_oi),
+			       osr[i].osr_rc);
+			continue;
+		}
+
+		rc = llog_cat_cancel_records(env, llh, 1, &cookies[i]);
+		if (rc)
+			CERROR("%s: can't cancel record: %d\n",
+			       d->opd_obd->obd_name, rc);
+	}
+}
+
 static int osp_sync_process_record(const struct lu_env *env,
 				   struct osp_device *d,
 				   struct llog_handle *llh,
@@ -589,29 +869,10 @@ static int osp_sync_process_record(const struct lu_env *env,
 	 * and fire after next commit callback
 	 */
 
-	/* notice we increment counters before sending RPC, to be consistent
-	 * in RPC interpret callback which may happen very quickly */
-	spin_lock(&d->opd_syn_lock);
-	d->opd_syn_rpc_in_flight++;
-	d->opd_syn_rpc_in_progress++;
-	spin_unlock(&d->opd_syn_lock);
-
-	switch (rec->lrh_type) {
-	/* case MDS_UNLINK_REC is kept for compatibility */
-	case MDS_UNLINK_REC:
-		rc = osp_sync_new_unlink_job(d, llh, rec);
-		break;
-	case MDS_UNLINK64_REC:
-		rc = osp_sync_new_unlink64_job(d, llh, rec);
-		break;
-	case MDS_SETATTR64_REC:
-		rc = osp_sync_new_setattr_job(d, llh, rec);
-		break;
-	default:
-		CERROR("unknown record type: %x\n", rec->lrh_type);
-		       rc = -EINVAL;
-		       break;
-	}
+	if (osp_sync_batching(d))
+		rc = osp_sync_batch_add(d, llh, rec);
+	else
+		rc = osp_sync_send_job(d, llh, rec);
 
 	if (likely(rc == 0)) {
 		spin_lock(&d->opd_syn_lock);
@@ -631,11 +892,6 @@ static int osp_sync_process_record(const struct lu_env *env,
 		       d->opd_obd->obd_name, d->opd_syn_rpc_in_flight,
 		       d->opd_syn_rpc_in_progress);
 		spin_unlock(&d->opd_syn_lock);
-	} else {
-		spin_lock(&d->opd_syn_lock);
-		d->opd_syn_rpc_in_flight--;
-		d->opd_syn_rpc_in_progress--;
-		spin_unlock(&d->opd_syn_lock);
 	}
 
 	CDEBUG(D_HA, "found record %x, %d, idx %u, id %u: %d\n",
@@ -692,19 +948,22 @@ static void osp_sync_process_committed(const struct lu_env *env,
 		LASSERT(req->rq_svc_thread == (void *) OSP_JOB_MAGIC);
 		cfs_list_del_init(&req->rq_exp_list);
 
-		body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
-		LASSERT(body);
-
 		/* import can be closing, thus all commit cb's are
 		 * called we can check committness directly */
-		if (req->rq_transno <= imp->imp_peer_committed_transno) {
+		if (req->rq_transno > imp->imp_peer_committed_transno) {
+			DEBUG_REQ(D_HA, req, "not committed");
+		} else if (lustre_msg_get_opc(req->rq_reqmsg) ==
+			   OST_SYNC_BATCH) {
+			osp_sync_batch_cancel(env, d, llh, req);
+		} else {
+			body = req_capsule_client_get(&req->rq_pill,
+						      &RMF_OST_BODY);
+			LASSERT(body);
 			rc = llog_cat_cancel_records(env, llh, 1,
 						     &body->oa.o_lcookie);
 			if (rc)
 				CERROR("%s: can't cancel record: %d\n",
 				       obd->obd_name, rc);
-		} else {
-			DEBUG_REQ(D_HA, req, "not committed");
 		}
 
 		ptlrpc_req_finished(req);
@@ -747,6 +1006,7 @@ static int osp_sync_process_queues(const struct lu_env *env,
 
 		if (!osp_sync_running(d)) {
 			CDEBUG(D_HA, "stop llog processing\n");
+			osp_sync_drop_batch(d);
 			return LLOG_PROC_BREAK;
 		}
 
@@ -792,6 +1052,10 @@ static int osp_sync_process_queues(const struct lu_env *env,
 		if (d->opd_syn_last_processed_id == d->opd_syn_last_used_id)
 			osp_sync_remove_from_tracker(d);
 
+		/* no more changes to add to the batch for now */
+		if (!osp_sync_can_process_new(d, rec))
+			osp_sync_send_batch(d);
+
 		l_wait_event(d->opd_syn_waitq,
 			     !osp_sync_running(d) ||
 			     osp_sync_can_process_new(d, rec) ||
@@ -1033,6 +1297,9 @@ int osp_sync_init(const struct lu_env *env, struct osp_device *d)
 	 */
 	d->opd_syn_max_rpc_in_flight = OSP_MAX_IN_FLIGHT;
 	d->opd_syn_max_rpc_in_progress = OSP_MAX_IN_PROGRESS;
+	d->opd_syn_batch = NULL;
+	d->opd_syn_batch_count = 0;
+	d->opd_syn_max_batch = OSP_SYNC_BATCH;
 	spin_lock_init(&d->opd_syn_lock);
 	cfs_waitq_init(&d->opd_syn_waitq);
 	cfs_waitq_init(&d->opd_syn_thread.t_ctl_waitq);
@@ -78,6 +78,10 @@ static char *oss_io_cpts;
 CFS_MODULE_PARM(oss_io_cpts, "s", charp, 0444,
 		"CPU partitions OSS IO threads should run on");
 
+static int oss_write_stages = 1;
+CFS_MODULE_PARM(oss_write_stages, "i", int, 0644,
+		"commit large writes MD by MD while the bulk is arriving");
+
 /*
  * this page is allocated statically when module is initializing
  * it is used to simulate data corruptions, see ost_checksum_bulk()
@@ -361,6 +365,281 @@ unlock:
         RETURN(rc);
 }
 
+/**
+ * Check if a lock conflicting with a glimpse, i.e. a write lock, is held or
+ * requested on \a res_id. Its holder may have cached data the OST does not
+ * know about yet.
+ */
+static int ost_glimpse_contended(struct ldlm_namespace *ns,
+				 const struct ldlm_res_id *res_id)
+{
+	struct ldlm_resource	*res;
+	struct ldlm_lock	*lock;
+	int			 contended = 0;
+
+	res = ldlm_resource_get(ns, NULL, res_id, LDLM_EXTENT, 0);
+	if (res == NULL)
+		return 0;
+
+	lock_res(res);
+	cfs_list_for_each_entry(lock, &res->lr_granted, l_res_link) {
+		if (!lockmode_compat(lock->l_granted_mode, LCK_PR)) {
+			contended = 1;
+			break;
+		}
+	}
+	if (!contended && !cfs_list_empty(&res->lr_waiting))
+		contended = 1;
+	unlock_res(res);
+	ldlm_resource_putref(res);
+
+	return contended;
+}
+
+/**
+ * Glimpse one object of an OST_GLIMPSE_BATCH request: grant the lock the
+ * client offered, if any, and return the object attributes in \a og.
+ */
+static int ost_glimpse_one(struct obd_export *exp, struct ptlrpc_request *req,
+			   struct ost_glimpse *og, struct obd_info *oinfo)
+{
+	struct ldlm_namespace	*ns = exp->exp_obd->obd_namespace;
+	struct obdo		*oa = oinfo->oi_oa;
+	struct ldlm_res_id	 res_id;
+	ldlm_policy_data_t	 policy;
+	struct lustre_handle	 remote = og->og_handle;
+	struct lustre_handle	 lockh = { 0 };
+	struct ldlm_lock	*lock;
+	int			 rc;
+	ENTRY;
+
+	og->og_handle.cookie = 0;
+	memset(oa, 0, sizeof(*oa));
+	oa->o_oi = og->og_oi;
+	oa->o_valid = OBD_MD_FLID | OBD_MD_FLGROUP;
+	rc = ost_validate_obdo(exp, oa, NULL);
+	if (rc)
+		RETURN(rc);
+
+	ostid_build_res_name(&oa->o_oi, &res_id);
+	/* if a writer holds a conflicting lock, the client has to glimpse
+	 * the object through a regular enqueue, which glimpses the writer */
+	if (lustre_handle_is_used(&remote)) {
+		policy.l_extent.start = 0;
+		policy.l_extent.end = OBD_OBJECT_EOF;
+		rc = ldlm_lock_grant_remote(ns, exp, &res_id, LDLM_EXTENT,
+					    &policy, LCK_PR, &remote, &lockh);
+		if (rc == -EWOULDBLOCK)
+			rc = -EAGAIN;
+		if (rc)
+			RETURN(rc);
+	} else if (ost_glimpse_contended(ns, &res_id)) {
+		RETURN(-EAGAIN);
+	}
+
+	rc = obd_getattr(req->rq_svc_thread->t_env, exp, oinfo);
+	if (rc) {
+		/* the client drops its lock as there are no attributes */
+		lock = ldlm_handle2lock(&lockh);
+		if (lock != NULL) {
+			ldlm_lock_cancel(lock);
+			LDLM_LOCK_PUT(lock);
+		}
+		RETURN(rc);
+	}
+
+	og->og_handle = lockh;
+	og->og_lvb.lvb_size = oa->o_size;
+	og->og_lvb.lvb_blocks = oa->o_blocks;
+	og->og_lvb.lvb_mtime = oa->o_mtime;
+	og->og_lvb.lvb_atime = oa->o_atime;
+	og->og_lvb.lvb_ctime = oa->o_ctime;
+	RETURN(0);
+}
+
+/**
+ * Handle OST_GLIMPSE_BATCH: return the attributes of many objects at once,
+ * granting PR locks on them if the client offered lock handles. Objects on
+ * which a write lock is held are not glimpsed (og_rc is -EAGAIN).
+ */
+static int ost_glimpse_batch(struct obd_export *exp, struct ptlrpc_request *req)
+{
+	struct req_capsule	*pill = &req->rq_pill;
+	struct ost_glimpse	*req_og;
+	struct ost_glimpse	*rep_og;
+	struct obd_info		*oinfo;
+	struct obdo		*oa;
+	int			 count;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	if (!(exp_connect_flags(exp) & OBD_CONNECT_GLIMPSE_BATCH))
+		RETURN(-EOPNOTSUPP);
+
+	req_og = req_capsule_client_get(pill, &RMF_OST_GLIMPSE);
+	if (req_og == NULL)
+		RETURN(-EFAULT);
+
+	count = req_capsule_get_size(pill, &RMF_OST_GLIMPSE, RCL_CLIENT) /
+		sizeof(*req_og);
+	if (count == 0 || count > OST_GLIMPSE_BATCH_MAX)
+		RETURN(-EPROTO);
+
+	req_capsule_set_size(pill, &RMF_OST_GLIMPSE, RCL_SERVER,
+			     count * sizeof(*rep_og));
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(rc);
+
+	rep_og = req_capsule_server_get(pill, &RMF_OST_GLIMPSE);
+	memcpy(rep_og, req_og, count * sizeof(*rep_og));
+
+	OBD_ALLOC_PTR(oinfo);
+	if (oinfo == NULL)
+		RETURN(-ENOMEM);
+	OBDO_ALLOC(oa);
+	if (oa == NULL)
+		GOTO(out, rc = -ENOMEM);
+	oinfo->oi_oa = oa;
+
+	for (i = 0; i < count; i++) {
+		memset(&rep_og[i].og_lvb, 0, sizeof(rep_og[i].og_lvb));
+		rep_og[i].og_rc = ost_glimpse_one(exp, req, &rep_og[i], oinfo);
+	}
+	CDEBUG(D_INODE, "%s: glimpsed %d objects for %s\n",
+	       exp->exp_obd->obd_name, count, obd_export_nid2str(exp));
+
+	OBDO_FREE(oa);
+out:
+	OBD_FREE_PTR(oinfo);
+	RETURN(rc);
+}
+
+/**
+ * Apply one change of an OST_SYNC_BATCH request, the way OST_DESTROY or
+ * OST_SETATTR does for a single one.
+ */
+static int ost_sync_one(struct obd_export *exp, struct ptlrpc_request *req,
+			struct ost_sync_rec *osr, struct obd_info *oinfo,
+			struct obd_trans_info *oti)
+{
+	const struct lu_env	*env = req->rq_svc_thread->t_env;
+	struct obdo		*oa = oinfo->oi_oa;
+	int			 rc;
+
+	if (ostid_id(&osr->osr_oi) == 0)
+		return -EPROTO;
+
+	memset(oa, 0, sizeof(*oa));
+	oa->o_oi = osr->osr_oi;
+	oa->o_valid = OBD_MD_FLID | OBD_MD_FLGROUP;
+	rc = ost_validate_obdo(exp, oa, NULL);
+	if (rc)
+		return rc;
+
+	switch (osr->osr_opc) {
+	case OST_DESTROY:
+		if (osr->osr_count != 0) {
+			oa->o_misc = osr->osr_count;
+			oa->o_valid |= OBD_MD_FLOBJCOUNT;
+		}
+		return obd_destroy(env, exp, oa, NULL, oti, NULL, NULL);
+	case OST_SETATTR:
+		oa->o_uid = osr->osr_uid;
+		oa->o_gid = osr->osr_gid;
+		oa->o_valid |= OBD_MD_FLUID | OBD_MD_FLGID;
+		oinfo->oi_capa = NULL;
+		return obd_setattr(env, exp, oinfo, oti);
+	default:
+		return -EPROTO;
+	}
+}
+
+/**
+ * Handle OST_SYNC_BATCH: apply the object destroys and ownership changes
+ * an MDT synchronizes from its llog, each in its own transaction, and
+ * return their results in osr_rc.
+ *
+ * The reply carries the highest transno, so that the MDT cancels the llog
+ * records of the changes once they are all committed. It fails only if no
+ * change made a transaction, with -ENOENT if none found its object.
+ */
+static int ost_sync_batch(struct obd_export *exp, struct ptlrpc_request *req,
+			  struct obd_trans_info *oti)
+{
+	struct req_capsule	*pill = &req->rq_pill;
+	struct ost_sync_rec	*req_osr;
+	struct ost_sync_rec	*rep_osr;
+	struct obd_info		*oinfo;
+	struct obdo		*oa;
+	__u64			 replay = oti->oti_transno;
+	__u64			 transno = 0;
+	int			 status = 0;
+	int			 count;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	if (!(exp_connect_flags(exp) & OBD_CONNECT_SYNC_BATCH))
+		RETURN(-EOPNOTSUPP);
+
+	req_osr = req_capsule_client_get(pill, &RMF_OST_SYNC_REC);
+	if (req_osr == NULL)
+		RETURN(-EFAULT);
+
+	count = req_capsule_get_size(pill, &RMF_OST_SYNC_REC, RCL_CLIENT) /
+		sizeof(*req_osr);
+	if (count == 0 || count > OST_SYNC_BATCH_MAX)
+		RETURN(-EPROTO);
+
+	req_capsule_set_size(pill, &RMF_OST_SYNC_REC, RCL_SERVER,
+			     count * sizeof(*rep_osr));
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(rc);
+
+	rep_osr = req_capsule_server_get(pill, &RMF_OST_SYNC_REC);
+	memcpy(rep_osr, req_osr, count * sizeof(*rep_osr));
+
+	OBD_ALLOC_PTR(oinfo);
+	if (oinfo == NULL)
+		RETURN(-ENOMEM);
+	OBDO_ALLOC(oa);
+	if (oa == NULL)
+		GOTO(out, rc = -ENOMEM);
+	oinfo->oi_oa = oa;
+
+	for (i = 0; i < count; i++) {
+		/* a replay redoes the first change under its transno, the
+		 * others get new ones */
+		oti->oti_transno = i == 0 ? replay : 0;
+		rep_osr[i].osr_rc = ost_sync_one(exp, req, &rep_osr[i], oinfo,
+						 oti);
+		if (oti->oti_transno > transno)
+			transno = oti->oti_transno;
+
+		if (rep_osr[i].osr_rc == -ENOENT) {
+			if (status == 0)
+				status = -ENOENT;
+		} else if (rep_osr[i].osr_rc != 0 &&
+			   (status == 0 || status == -ENOENT)) {
+			status = rep_osr[i].osr_rc;
+		}
+	}
+	CDEBUG(D_INODE, "%s: synced %d changes for %s, transno "LPU64
+	       ": rc = %d\n", exp->exp_obd->obd_name, count,
+	       obd_export_nid2str(exp), transno, status);
+
+	oti->oti_transno = replay != 0 ? replay : transno;
+	req->rq_status = transno != 0 ? 0 : status;
+
+	OBDO_FREE(oa);
+out:
+	OBD_FREE_PTR(oinfo);
+	RETURN(rc);
+}
+
 static int ost_statfs(struct ptlrpc_request *req)
 {
         struct obd_statfs *osfs;
@@ -495,6 +774,83 @@ unlock:
         RETURN(rc);
 }
 
+/**
+ * Handle OST_FALLOCATE: allocate the blocks of [o_size, o_blocks) of an
+ * object, extending its size to o_blocks unless OST_FALLOC_KEEP_SIZE is set
+ * in o_falloc_mode. The client holds a PW lock on the range.
+ */
+static int ost_fallocate(struct obd_export *exp, struct ptlrpc_request *req,
+			 struct obd_trans_info *oti)
+{
+	struct ost_body		*body, *repbody;
+	struct lustre_handle	 lh = { 0 };
+	struct lustre_capa	*capa = NULL;
+	struct obd_info		*oinfo;
+	int			 rc;
+	ENTRY;
+
+	if (!(exp_connect_flags(exp) & OBD_CONNECT_FALLOCATE))
+		RETURN(-EOPNOTSUPP);
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	if (body == NULL)
+		RETURN(-EFAULT);
+
+	rc = ost_validate_obdo(exp, &body->oa, NULL);
+	if (rc)
+		RETURN(rc);
+
+	if ((body->oa.o_valid & (OBD_MD_FLSIZE | OBD_MD_FLBLOCKS)) !=
+	    (OBD_MD_FLSIZE | OBD_MD_FLBLOCKS) ||
+	    body->oa.o_size >= body->oa.o_blocks)
+		RETURN(-EPROTO);
+
+	if (body->oa.o_falloc_mode & ~OST_FALLOC_KEEP_SIZE)
+		RETURN(-EOPNOTSUPP);
+
+	rc = req_capsule_server_pack(&req->rq_pill);
+	if (rc)
+		RETURN(rc);
+
+	repbody = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
+	repbody->oa = body->oa;
+
+	rc = ost_lock_get(exp, &repbody->oa, repbody->oa.o_size,
+			  repbody->oa.o_blocks - 1, &lh, LCK_PW, 0);
+	if (rc)
+		GOTO(out, rc);
+
+	if (repbody->oa.o_valid & OBD_MD_FLFLAGS &&
+	    repbody->oa.o_flags == OBD_FL_SRVLOCK)
+		repbody->oa.o_valid &= ~OBD_MD_FLFLAGS;
+
+	if (repbody->oa.o_valid & OBD_MD_FLOSSCAPA) {
+		capa = req_capsule_client_get(&req->rq_pill, &RMF_CAPA1);
+		if (capa == NULL) {
+			CERROR("Missing capability for OST FALLOCATE");
+			GOTO(unlock, rc = -EFAULT);
+		}
+	}
+
+	OBD_ALLOC_PTR(oinfo);
+	if (oinfo == NULL)
+		GOTO(unlock, rc = -ENOMEM);
+	oinfo->oi_oa = &repbody->oa;
+	oinfo->oi_policy.l_extent.start = repbody->oa.o_size;
+	oinfo->oi_policy.l_extent.end = repbody->oa.o_blocks;
+	oinfo->oi_capa = capa;
+
+	req->rq_status = obd_fallocate(req->rq_svc_thread->t_env, exp,
+				       oinfo, oti);
+	OBD_FREE_PTR(oinfo);
+	EXIT;
+unlock:
+	ost_lock_put(exp, &lh, LCK_PW);
+out:
+	ost_drop_id(exp, &repbody->oa);
+	return rc;
+}
+
 static int ost_sync(struct obd_export *exp, struct ptlrpc_request *req,
 		    struct obd_trans_info *oti)
 {
@@ -590,23 +946,14 @@ static int ost_setattr(struct obd_export *exp, struct ptlrpc_request *req,
         RETURN(0);
 }
 
-static __u32 ost_checksum_bulk(struct ptlrpc_bulk_desc *desc, int opc,
-			       cksum_type_t cksum_type)
+/* hash pages [\a first, \a last) of \a desc */
+static void ost_checksum_pages(struct cfs_crypto_hash_desc *hdesc,
+			       struct ptlrpc_bulk_desc *desc, int opc,
+			       int first, int last)
 {
-	struct cfs_crypto_hash_desc	*hdesc;
-	unsigned int			bufsize;
-	int				i, err;
-	unsigned char			cfs_alg = cksum_obd2cfs(cksum_type);
-	__u32				cksum;
+	int i;
 
-	hdesc = cfs_crypto_hash_init(cfs_alg, NULL, 0);
-	if (IS_ERR(hdesc)) {
-		CERROR("Unable to initialize checksum hash %s\n",
-		       cfs_crypto_hash_name(cfs_alg));
-		return PTR_ERR(hdesc);
-	}
-	CDEBUG(D_INFO, "Checksum for algo %s\n", cfs_crypto_hash_name(cfs_alg));
-	for (i = 0; i < desc->bd_iov_count; i++) {
+	for (i = first; i < last; i++) {
 
 		/* corrupt the data before we compute the checksum, to
 		 * simulate a client->OST data error */
@@ -653,6 +1000,28 @@ static __u32 ost_checksum_bulk(struct ptlrpc_bulk_desc *desc, int opc,
 			}
 		}
 	}
+}
+
+static struct cfs_crypto_hash_desc *ost_checksum_init(cksum_type_t cksum_type)
+{
+	struct cfs_crypto_hash_desc	*hdesc;
+	unsigned char			cfs_alg = cksum_obd2cfs(cksum_type);
+
+	hdesc = cfs_crypto_hash_init(cfs_alg, NULL, 0);
+	if (IS_ERR(hdesc)) {
+		CERROR("Unable to initialize checksum hash %s\n",
+		       cfs_crypto_hash_name(cfs_alg));
+		return hdesc;
+	}
+	CDEBUG(D_INFO, "Checksum for algo %s\n", cfs_crypto_hash_name(cfs_alg));
+	return hdesc;
+}
+
+static __u32 ost_checksum_final(struct cfs_crypto_hash_desc *hdesc)
+{
+	unsigned int	bufsize;
+	int		err;
+	__u32		cksum;
 
 	bufsize = 4;
 	err = cfs_crypto_hash_final(hdesc, (unsigned char *)&cksum, &bufsize);
@@ -662,6 +1031,19 @@ static __u32 ost_checksum_bulk(struct ptlrpc_bulk_desc *desc, int opc,
 	return cksum;
 }
 
+static __u32 ost_checksum_bulk(struct ptlrpc_bulk_desc *desc, int opc,
+			       cksum_type_t cksum_type)
+{
+	struct cfs_crypto_hash_desc *hdesc;
+
+	hdesc = ost_checksum_init(cksum_type);
+	if (IS_ERR(hdesc))
+		return PTR_ERR(hdesc);
+
+	ost_checksum_pages(hdesc, desc, opc, 0, desc->bd_iov_count);
+	return ost_checksum_final(hdesc);
+}
+
 static int ost_brw_lock_get(int mode, struct obd_export *exp,
                             struct obd_ioobj *obj, struct niobuf_remote *nb,
                             struct lustre_handle *lh)
@@ -1002,6 +1384,102 @@ static void ost_warn_on_cksum(struct ptlrpc_request *req,
 			   client_cksum, server_cksum);
 }
 
+/**
+ * Number of stages to commit a bulk write in: one per MD of the bulk when
+ * the pages of an MD can be written as soon as it arrived, 1 otherwise.
+ */
+static int ost_brw_write_stages(struct ptlrpc_request *req,
+				struct ptlrpc_bulk_desc *desc,
+				struct obd_trans_info *oti)
+{
+	__u64	xid = req->rq_xid & ~((__u64)desc->bd_md_max_brw - 1);
+	int	total_md = req->rq_xid - xid + 1;
+
+	/* bulk security unwraps the whole bulk at once, and a replay has
+	 * a single transno to commit under */
+	if (!oss_write_stages || req->rq_pack_bulk || oti->oti_transno != 0)
+		return 1;
+
+	/* the client must have split its pages into MDs as we did */
+	if (total_md != (desc->bd_iov_count + LNET_MAX_IOV - 1) / LNET_MAX_IOV)
+		return 1;
+
+	return total_md;
+}
+
+/**
+ * Commit the pages of all but the last MD of a bulk write started by
+ * target_bulk_start(), each MD in its own transaction as soon as it arrived,
+ * so that the disk writes the first MBs of the RPC while the network is
+ * still transferring the next ones. The pages of the last MD are left to
+ * the caller to commit once the whole bulk is in.
+ *
+ * \a done is set to the number of pages committed, successfully or not,
+ * oti_transno to the highest transno of the stages. The bulk is aborted on
+ * failure.
+ */
+static int ost_brw_commit_stages(struct ptlrpc_request *req,
+				 struct ptlrpc_bulk_desc *desc, int stages,
+				 struct obdo *oa, struct obd_ioobj *ioo,
+				 struct niobuf_remote *remote_nb,
+				 struct niobuf_local *local_nb,
+				 struct cfs_crypto_hash_desc *hdesc,
+				 struct obd_trans_info *oti,
+				 struct l_wait_info *lwi, int *done,
+				 int *no_reply)
+{
+	struct obd_export	*exp = req->rq_export;
+	struct obdo		*stage_oa;
+	__u64			 transno = 0;
+	int			 rc = 0;
+	int			 i;
+	ENTRY;
+
+	OBDO_ALLOC(stage_oa);
+	if (stage_oa == NULL) {
+		ptlrpc_abort_bulk(desc);
+		RETURN(-ENOMEM);
+	}
+
+	for (i = 0; i < stages - 1; i++) {
+		rc = target_bulk_wait(exp, desc, lwi, i);
+		if (rc != 0) {
+			*no_reply = 1;
+			break;
+		}
+
+		if (hdesc != NULL)
+			ost_checksum_pages(hdesc, desc, OST_WRITE, *done,
+					   *done + LNET_MAX_IOV);
+
+		/* obd_commitrw() returns the object attributes in the obdo,
+		 * each stage starts from what obd_preprw() left there */
+		*stage_oa = *oa;
+		oti->oti_brw_partial = 1;
+		oti->oti_transno = 0;
+		rc = obd_commitrw(req->rq_svc_thread->t_env, OBD_BRW_WRITE,
+				  exp, stage_oa, 1, ioo, remote_nb,
+				  LNET_MAX_IOV, local_nb + *done, oti, 0);
+		oti->oti_brw_partial = 0;
+		if (oti->oti_transno > transno)
+			transno = oti->oti_transno;
+		/* the pages are released whatever the result */
+		*done += LNET_MAX_IOV;
+		if (rc != 0) {
+			ptlrpc_abort_bulk(desc);
+			break;
+		}
+	}
+	oti->oti_transno = transno;
+
+	CDEBUG(D_INODE, "%s: committed %d/%d pages of x"LPU64" from %s in %d "
+	       "stages: rc = %d\n", exp->exp_obd->obd_name, *done,
+	       desc->bd_iov_count, req->rq_xid, obd_export_nid2str(exp), i,
+	       rc);
+	OBDO_FREE(stage_oa);
+	RETURN(rc);
+}
+
 static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
 {
         struct ptlrpc_bulk_desc *desc = NULL;
@@ -1021,6 +1499,10 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
         int                      no_reply = 0, mmap = 0;
         __u32                    o_uid = 0, o_gid = 0;
         struct ost_thread_local_cache *tls;
+	struct cfs_crypto_hash_desc *hdesc = NULL;
+	__u64			 transno = 0;
+	int			 stages;
+	int			 done = 0;
         ENTRY;
 
         req->rq_bulk_write = 1;
@@ -1153,8 +1635,37 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
         if (rc != 0)
                 GOTO(out_lock, rc);
 
-        rc = target_bulk_io(exp, desc, &lwi);
-        no_reply = rc != 0;
+	stages = ost_brw_write_stages(req, desc, oti);
+	if (stages > 1 && client_cksum != 0) {
+		/* the pages of a stage are released once committed */
+		hdesc = ost_checksum_init(cksum_type);
+		if (IS_ERR(hdesc)) {
+			hdesc = NULL;
+			stages = 1;
+		}
+	}
+
+	if (stages > 1) {
+		rc = target_bulk_start(exp, desc, &lwi);
+		no_reply = rc != 0;
+		if (rc == 0)
+			rc = ost_brw_commit_stages(req, desc, stages,
+						   &repbody->oa, ioo,
+						   remote_nb, local_nb, hdesc,
+						   oti, &lwi, &done,
+						   &no_reply);
+		if (rc == 0) {
+			rc = target_bulk_wait(exp, desc, &lwi, -1);
+			no_reply = rc != 0;
+		}
+		/* the stages committed their own transactions, the reply
+		 * carries the last one */
+		transno = oti->oti_transno;
+		oti->oti_transno = 0;
+	} else {
+		rc = target_bulk_io(exp, desc, &lwi);
+		no_reply = rc != 0;
+	}
 
 skip_transfer:
         if (client_cksum != 0 && rc == 0) {
@@ -1162,7 +1673,15 @@ skip_transfer:
                 repbody->oa.o_valid |= OBD_MD_FLCKSUM | OBD_MD_FLFLAGS;
                 repbody->oa.o_flags &= ~OBD_FL_CKSUM_ALL;
                 repbody->oa.o_flags |= cksum_type_pack(cksum_type);
-                server_cksum = ost_checksum_bulk(desc, OST_WRITE, cksum_type);
+		if (hdesc != NULL) {
+			ost_checksum_pages(hdesc, desc, OST_WRITE, done,
+					   npages);
+			server_cksum = ost_checksum_final(hdesc);
+			hdesc = NULL;
+		} else {
+			server_cksum = ost_checksum_bulk(desc, OST_WRITE,
+							 cksum_type);
+		}
                 repbody->oa.o_cksum = server_cksum;
                 cksum_counter++;
                 if (unlikely(client_cksum != server_cksum)) {
@@ -1177,10 +1696,15 @@ skip_transfer:
                 }
         }
 
+	if (hdesc != NULL)
+		cfs_crypto_hash_final(hdesc, NULL, NULL);
+
         /* Must commit after prep above in all cases */
         rc = obd_commitrw(req->rq_svc_thread->t_env, OBD_BRW_WRITE, exp,
-                          &repbody->oa, objcount, ioo, remote_nb, npages,
-                          local_nb, oti, rc);
+			  &repbody->oa, objcount, ioo, remote_nb,
+			  npages - done, local_nb + done, oti, rc);
+	if (oti->oti_transno < transno)
+		oti->oti_transno = transno;
         if (rc == -ENOTCONN)
                 /* quota acquire process has been given up because
                  * either the client has been evicted or the client
@@ -1784,7 +2308,9 @@ static int ost_filter_recovery_request(struct ptlrpc_request *req,
         case OST_CREATE:
         case OST_DESTROY:
         case OST_PUNCH:
+	case OST_FALLOCATE:
         case OST_SETATTR:
+	case OST_SYNC_BATCH:
         case OST_SYNC:
         case OST_WRITE:
         case OBD_LOG_CANCEL:
@@ -1829,10 +2355,13 @@ int ost_msg_check_version(struct lustre_msg *msg)
         case OST_CREATE:
         case OST_DESTROY:
         case OST_GETATTR:
+	case OST_GLIMPSE_BATCH:
         case OST_SETATTR:
+	case OST_SYNC_BATCH:
         case OST_WRITE:
         case OST_READ:
         case OST_PUNCH:
+	case OST_FALLOCATE:
         case OST_STATFS:
         case OST_SYNC:
         case OST_SET_INFO:
@@ -2383,6 +2912,22 @@ int ost_handle(struct ptlrpc_request *req)
                         RETURN(0);
                 rc = ost_getattr(req->rq_export, req);
                 break;
+	case OST_GLIMPSE_BATCH:
+		CDEBUG(D_INODE, "glimpse batch\n");
+		req_capsule_set(&req->rq_pill, &RQF_OST_GLIMPSE_BATCH);
+		if (OBD_FAIL_CHECK(OBD_FAIL_OST_GETATTR_NET))
+			RETURN(0);
+		rc = ost_glimpse_batch(req->rq_export, req);
+		break;
+	case OST_SYNC_BATCH:
+		CDEBUG(D_INODE, "sync batch\n");
+		req_capsule_set(&req->rq_pill, &RQF_OST_SYNC_BATCH);
+		if (OBD_FAIL_CHECK(OBD_FAIL_OST_DESTROY_NET))
+			RETURN(0);
+		if (OBD_FAIL_CHECK(OBD_FAIL_OST_EROFS))
+			GOTO(out, rc = -EROFS);
+		rc = ost_sync_batch(req->rq_export, req, oti);
+		break;
         case OST_SETATTR:
                 CDEBUG(D_INODE, "setattr\n");
                 req_capsule_set(&req->rq_pill, &RQF_OST_SETATTR);
@@ -2437,6 +2982,13 @@ int ost_handle(struct ptlrpc_request *req)
                         GOTO(out, rc = -EROFS);
                 rc = ost_punch(req->rq_export, req, oti);
                 break;
+	case OST_FALLOCATE:
+		CDEBUG(D_INODE, "fallocate\n");
+		req_capsule_set(&req->rq_pill, &RQF_OST_FALLOCATE);
+		if (OBD_FAIL_CHECK(OBD_FAIL_OST_EROFS))
+			GOTO(out, rc = -EROFS);
+		rc = ost_fallocate(req->rq_export, req, oti);
+		break;
         case OST_STATFS:
                 CDEBUG(D_INODE, "statfs\n");
                 req_capsule_set(&req->rq_pill, &RQF_OST_STATFS);
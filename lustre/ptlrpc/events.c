@@ -436,6 +436,7 @@ void server_bulk_callback (lnet_event_t *ev)
 {
 	struct ptlrpc_cb_id     *cbid = ev->md.user_ptr;
 	struct ptlrpc_bulk_desc *desc = cbid->cbid_arg;
+	int			 mdidx;
 	ENTRY;
 
 	LASSERT(ev->type == LNET_EVENT_SEND ||
@@ -453,6 +454,10 @@ void server_bulk_callback (lnet_event_t *ev)
 
 	LASSERT(desc->bd_md_count > 0);
 
+	for (mdidx = 0; mdidx < desc->bd_md_max_brw; mdidx++)
+		if (LNetHandleIsEqual(ev->md_handle, desc->bd_mds[mdidx]))
+			break;
+
 	if ((ev->type == LNET_EVENT_ACK ||
 	     ev->type == LNET_EVENT_REPLY) &&
 	    ev->status == 0) {
@@ -460,6 +465,8 @@ void server_bulk_callback (lnet_event_t *ev)
 		 * before the SENT event (oh yes we can), we know we
 		 * read/wrote the peer buffer and how much... */
 		desc->bd_nob_transferred += ev->mlength;
+		if (mdidx < desc->bd_md_max_brw)
+			desc->bd_md_nob[mdidx] += ev->mlength;
 		desc->bd_sender = ev->sender;
 	}
 
@@ -468,9 +475,11 @@ void server_bulk_callback (lnet_event_t *ev)
 
 	if (ev->unlinked) {
 		desc->bd_md_count--;
-		/* This is the last callback no matter what... */
-		if (desc->bd_md_count == 0)
-			cfs_waitq_signal(&desc->bd_waitq);
+		if (mdidx < desc->bd_md_max_brw)
+			desc->bd_md_done |= 1UL << mdidx;
+		/* This is the last callback of this MD no matter what, and
+		 * a pipelined write may be waiting for it alone */
+		cfs_waitq_signal(&desc->bd_waitq);
 	}
 
 	spin_unlock(&desc->bd_lock);
@@ -118,6 +118,13 @@ static const struct req_msg_field *mdt_body_capa[] = {
         &RMF_CAPA1
 };
 
+static const struct req_msg_field *mds_readpage_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MDT_BODY,
+	&RMF_CAPA1,
+	&RMF_DLM_HANDLES
+};
+
 static const struct req_msg_field *quotactl_only[] = {
         &RMF_PTLRPC_BODY,
         &RMF_OBD_QUOTACTL
@@ -248,6 +255,20 @@ static const struct req_msg_field *mds_reint_unlink_client[] = {
         &RMF_DLM_REQ
 };
 
+static const struct req_msg_field *mds_reint_unlink_batch_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_REC_REINT,
+	&RMF_CAPA1,
+	&RMF_NAMES,
+	&RMF_DLM_REQ
+};
+
+static const struct req_msg_field *mds_reint_unlink_batch_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MDT_BODY,
+	&RMF_RCS
+};
+
 static const struct req_msg_field *mds_reint_link_client[] = {
         &RMF_PTLRPC_BODY,
         &RMF_REC_REINT,
@@ -469,7 +490,9 @@ static const struct req_msg_field *mds_getxattr_client[] = {
 static const struct req_msg_field *mds_getxattr_server[] = {
         &RMF_PTLRPC_BODY,
         &RMF_MDT_BODY,
-        &RMF_EADATA
+	&RMF_EADATA,
+	&RMF_EAVALS,
+	&RMF_EAVALS_LENS
 };
 
 static const struct req_msg_field *mds_getattr_server[] = {
@@ -542,6 +565,22 @@ static const struct req_msg_field *ost_body_only[] = {
         &RMF_OST_BODY
 };
 
+static const struct req_msg_field *ost_glimpse_batch[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_GLIMPSE
+};
+
+static const struct req_msg_field *ost_sync_batch_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_SYNC_REC,
+	&RMF_LOGCOOKIES
+};
+
+static const struct req_msg_field *ost_sync_batch_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_SYNC_REC
+};
+
 static const struct req_msg_field *ost_body_capa[] = {
         &RMF_PTLRPC_BODY,
         &RMF_OST_BODY,
@@ -683,6 +722,7 @@ static struct req_format *req_formats[] = {
         &RQF_MDS_REINT_CREATE_SYM,
         &RQF_MDS_REINT_OPEN,
         &RQF_MDS_REINT_UNLINK,
+	&RQF_MDS_REINT_UNLINK_BATCH,
         &RQF_MDS_REINT_LINK,
         &RQF_MDS_REINT_RENAME,
         &RQF_MDS_REINT_SETATTR,
@@ -704,9 +744,12 @@ static struct req_format *req_formats[] = {
         &RQF_OST_QUOTACHECK,
         &RQF_OST_QUOTACTL,
         &RQF_OST_GETATTR,
+	&RQF_OST_GLIMPSE_BATCH,
+	&RQF_OST_SYNC_BATCH,
         &RQF_OST_SETATTR,
         &RQF_OST_CREATE,
         &RQF_OST_PUNCH,
+	&RQF_OST_FALLOCATE,
         &RQF_OST_SYNC,
         &RQF_OST_DESTROY,
         &RQF_OST_BRW_READ,
@@ -901,6 +944,10 @@ struct req_msg_field RMF_NAME =
         DEFINE_MSGF("name", RMF_F_STRING, -1, NULL, NULL);
 EXPORT_SYMBOL(RMF_NAME);
 
+struct req_msg_field RMF_NAMES =
+	DEFINE_MSGF("names", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_NAMES);
+
 struct req_msg_field RMF_SYMTGT =
         DEFINE_MSGF("symtgt", RMF_F_STRING, -1, NULL, NULL);
 EXPORT_SYMBOL(RMF_SYMTGT);
@@ -969,6 +1016,11 @@ struct req_msg_field RMF_DLM_REQ =
                     lustre_swab_ldlm_request, NULL);
 EXPORT_SYMBOL(RMF_DLM_REQ);
 
+struct req_msg_field RMF_DLM_HANDLES =
+	DEFINE_MSGF("dlm_handles", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct lustre_handle), NULL, NULL);
+EXPORT_SYMBOL(RMF_DLM_HANDLES);
+
 struct req_msg_field RMF_DLM_REP =
         DEFINE_MSGF("dlm_rep", 0,
                     sizeof(struct ldlm_reply), lustre_swab_ldlm_reply, NULL);
@@ -1002,6 +1054,15 @@ struct req_msg_field RMF_EADATA = DEFINE_MSGF("eadata", 0, -1,
                                                     NULL, NULL);
 EXPORT_SYMBOL(RMF_EADATA);
 
+/* xattr values and their lengths, for getxattr with OBD_MD_FLXATTRALL */
+struct req_msg_field RMF_EAVALS = DEFINE_MSGF("eavals", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_EAVALS);
+
+struct req_msg_field RMF_EAVALS_LENS =
+	DEFINE_MSGF("eavals_lens", RMF_F_STRUCT_ARRAY, sizeof(__u32),
+		    lustre_swab_generic_32s, NULL);
+EXPORT_SYMBOL(RMF_EAVALS_LENS);
+
 struct req_msg_field RMF_ACL =
         DEFINE_MSGF("acl", RMF_F_NO_SIZE_CHECK,
                     LUSTRE_POSIX_ACL_MAX_SIZE, NULL, NULL);
@@ -1042,6 +1103,17 @@ struct req_msg_field RMF_OBD_IOOBJ =
                     sizeof(struct obd_ioobj), lustre_swab_obd_ioobj, dump_ioo);
 EXPORT_SYMBOL(RMF_OBD_IOOBJ);
 
+struct req_msg_field RMF_OST_GLIMPSE =
+	DEFINE_MSGF("ost_glimpse", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct ost_glimpse), lustre_swab_ost_glimpse, NULL);
+EXPORT_SYMBOL(RMF_OST_GLIMPSE);
+
+struct req_msg_field RMF_OST_SYNC_REC =
+	DEFINE_MSGF("ost_sync_rec", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct ost_sync_rec), lustre_swab_ost_sync_rec,
+		    NULL);
+EXPORT_SYMBOL(RMF_OST_SYNC_REC);
+
 struct req_msg_field RMF_NIOBUF_REMOTE =
         DEFINE_MSGF("niobuf_remote", RMF_F_STRUCT_ARRAY,
                     sizeof(struct niobuf_remote), lustre_swab_niobuf_remote,
@@ -1295,6 +1367,12 @@ struct req_format RQF_MDS_REINT_UNLINK =
                         mds_last_unlink_server);
 EXPORT_SYMBOL(RQF_MDS_REINT_UNLINK);
 
+struct req_format RQF_MDS_REINT_UNLINK_BATCH =
+	DEFINE_REQ_FMT0("MDS_REINT_UNLINK_BATCH",
+			mds_reint_unlink_batch_client,
+			mds_reint_unlink_batch_server);
+EXPORT_SYMBOL(RQF_MDS_REINT_UNLINK_BATCH);
+
 struct req_format RQF_MDS_REINT_LINK =
         DEFINE_REQ_FMT0("MDS_REINT_LINK",
                         mds_reint_link_client, mdt_body_only);
@@ -1431,7 +1509,7 @@ EXPORT_SYMBOL(RQF_MDS_DONE_WRITING);
 
 struct req_format RQF_MDS_READPAGE =
         DEFINE_REQ_FMT0("MDS_READPAGE",
-                        mdt_body_capa, mdt_body_only);
+			mds_readpage_client, mdt_body_only);
 EXPORT_SYMBOL(RQF_MDS_READPAGE);
 
 struct req_format RQF_MDS_HSM_ACTION =
@@ -1468,7 +1546,7 @@ struct req_format RQF_MDS_SWAP_LAYOUTS =
 			mdt_swap_layouts, empty);
 EXPORT_SYMBOL(RQF_MDS_SWAP_LAYOUTS);
 
-/* This is for split */
+/* Data-on-MDT file body write */
 struct req_format RQF_MDS_WRITEPAGE =
         DEFINE_REQ_FMT0("MDS_WRITEPAGE",
                         mdt_body_capa, mdt_body_only);
@@ -1521,6 +1599,16 @@ struct req_format RQF_OST_GETATTR =
         DEFINE_REQ_FMT0("OST_GETATTR", ost_body_capa, ost_body_only);
 EXPORT_SYMBOL(RQF_OST_GETATTR);
 
+struct req_format RQF_OST_GLIMPSE_BATCH =
+	DEFINE_REQ_FMT0("OST_GLIMPSE_BATCH", ost_glimpse_batch,
+			ost_glimpse_batch);
+EXPORT_SYMBOL(RQF_OST_GLIMPSE_BATCH);
+
+struct req_format RQF_OST_SYNC_BATCH =
+	DEFINE_REQ_FMT0("OST_SYNC_BATCH", ost_sync_batch_client,
+			ost_sync_batch_server);
+EXPORT_SYMBOL(RQF_OST_SYNC_BATCH);
+
 struct req_format RQF_OST_SETATTR =
         DEFINE_REQ_FMT0("OST_SETATTR", ost_body_capa, ost_body_only);
 EXPORT_SYMBOL(RQF_OST_SETATTR);
@@ -1533,6 +1621,10 @@ struct req_format RQF_OST_PUNCH =
         DEFINE_REQ_FMT0("OST_PUNCH", ost_body_capa, ost_body_only);
 EXPORT_SYMBOL(RQF_OST_PUNCH);
 
+struct req_format RQF_OST_FALLOCATE =
+	DEFINE_REQ_FMT0("OST_FALLOCATE", ost_body_capa, ost_body_only);
+EXPORT_SYMBOL(RQF_OST_FALLOCATE);
+
 struct req_format RQF_OST_SYNC =
         DEFINE_REQ_FMT0("OST_SYNC", ost_body_capa, ost_body_only);
 EXPORT_SYMBOL(RQF_OST_SYNC);
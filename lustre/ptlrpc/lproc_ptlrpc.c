@@ -73,6 +73,9 @@ struct ll_rpc_opcode {
         { OST_QUOTACHECK,   "ost_quotacheck" },
         { OST_QUOTACTL,     "ost_quotactl" },
         { OST_QUOTA_ADJUST_QUNIT, "ost_quota_adjust_qunit" },
+	{ OST_GLIMPSE_BATCH, "ost_glimpse_batch" },
+	{ OST_SYNC_BATCH,   "ost_sync_batch" },
+	{ OST_FALLOCATE,    "ost_fallocate" },
         { MDS_GETATTR,      "mds_getattr" },
         { MDS_GETATTR_NAME, "mds_getattr_lock" },
         { MDS_CLOSE,        "mds_close" },
@@ -181,6 +181,8 @@ int ptlrpc_start_bulk_transfer(struct ptlrpc_bulk_desc *desc)
 	total_md = desc->bd_req->rq_xid - xid + 1;
 
 	desc->bd_md_count = total_md;
+	desc->bd_md_done = 0;
+	memset(desc->bd_md_nob, 0, sizeof(desc->bd_md_nob));
 	desc->bd_failure = 0;
 
 	md.user_ptr = &desc->bd_cbid;
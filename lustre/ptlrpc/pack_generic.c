@@ -1777,7 +1777,7 @@ void lustre_swab_obd_statfs (struct obd_statfs *os)
         __swab64s (&os->os_maxbytes);
         __swab32s (&os->os_state);
 	CLASSERT(offsetof(typeof(*os), os_fprecreated) != 0);
-        CLASSERT(offsetof(typeof(*os), os_spare2) != 0);
+        CLASSERT(offsetof(typeof(*os), os_req_rate) != 0);
         CLASSERT(offsetof(typeof(*os), os_spare3) != 0);
         CLASSERT(offsetof(typeof(*os), os_spare4) != 0);
         CLASSERT(offsetof(typeof(*os), os_spare5) != 0);
@@ -1857,6 +1857,28 @@ void lustre_swab_ost_lvb(struct ost_lvb *lvb)
 }
 EXPORT_SYMBOL(lustre_swab_ost_lvb);
 
+void lustre_swab_ost_glimpse(struct ost_glimpse *og)
+{
+	lustre_swab_ost_id(&og->og_oi);
+	/* og_handle is opaque */
+	lustre_swab_ost_lvb(&og->og_lvb);
+	__swab32s(&og->og_rc);
+	CLASSERT(offsetof(typeof(*og), og_padding) != 0);
+}
+EXPORT_SYMBOL(lustre_swab_ost_glimpse);
+
+void lustre_swab_ost_sync_rec(struct ost_sync_rec *osr)
+{
+	lustre_swab_ost_id(&osr->osr_oi);
+	__swab32s(&osr->osr_opc);
+	__swab32s(&osr->osr_count);
+	__swab32s(&osr->osr_uid);
+	__swab32s(&osr->osr_gid);
+	__swab32s(&osr->osr_rc);
+	CLASSERT(offsetof(typeof(*osr), osr_padding) != 0);
+}
+EXPORT_SYMBOL(lustre_swab_ost_sync_rec);
+
 void lustre_swab_lquota_lvb(struct lquota_lvb *lvb)
 {
 	__swab64s(&lvb->lvb_flags);
@@ -1898,6 +1920,7 @@ void lustre_swab_mdt_body (struct mdt_body *b)
         __swab32s (&b->uid_h);
         __swab32s (&b->gid_h);
         CLASSERT(offsetof(typeof(*b), padding_5) != 0);
+	__swab64s(&b->lazytime);
 }
 EXPORT_SYMBOL(lustre_swab_mdt_body);
 
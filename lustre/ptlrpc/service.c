@@ -2053,6 +2053,12 @@ put_conn:
                 request->rq_status,
                 (request->rq_repmsg ?
                  lustre_msg_get_status(request->rq_repmsg) : -999));
+	/* Foreground load for the speed of the background scans. */
+	if (likely(request->rq_reqmsg != NULL) &&
+	    lustre_msg_get_opc(request->rq_reqmsg) != OBD_PING)
+		obd_svc_latency_add(cfs_timeval_sub(&work_end,
+						&request->rq_arrival_time,
+						NULL));
         if (likely(svc->srv_stats != NULL && request->rq_reqmsg != NULL)) {
                 __u32 op = lustre_msg_get_opc(request->rq_reqmsg);
                 int opc = opcode_offset(op);
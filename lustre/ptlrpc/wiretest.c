@@ -108,7 +108,13 @@ void lustre_assert_wire_constants(void)
 		 (long long)OST_QUOTACTL);
 	LASSERTF(OST_QUOTA_ADJUST_QUNIT == 20, "found %lld\n",
 		 (long long)OST_QUOTA_ADJUST_QUNIT);
-	LASSERTF(OST_LAST_OPC == 21, "found %lld\n",
+	LASSERTF(OST_GLIMPSE_BATCH == 21, "found %lld\n",
+		 (long long)OST_GLIMPSE_BATCH);
+	LASSERTF(OST_SYNC_BATCH == 22, "found %lld\n",
+		 (long long)OST_SYNC_BATCH);
+	LASSERTF(OST_FALLOCATE == 23, "found %lld\n",
+		 (long long)OST_FALLOCATE);
+	LASSERTF(OST_LAST_OPC == 24, "found %lld\n",
 		 (long long)OST_LAST_OPC);
 	LASSERTF(OBD_OBJECT_EOF == 0xffffffffffffffffULL, "found 0x%.16llxULL\n",
 		 OBD_OBJECT_EOF);
@@ -198,7 +204,9 @@ void lustre_assert_wire_constants(void)
 		 (long long)REINT_SETXATTR);
 	LASSERTF(REINT_RMENTRY == 8, "found %lld\n",
 		 (long long)REINT_RMENTRY);
-	LASSERTF(REINT_MAX == 9, "found %lld\n",
+	LASSERTF(REINT_UNLINK_BATCH == 10, "found %lld\n",
+		 (long long)REINT_UNLINK_BATCH);
+	LASSERTF(REINT_MAX == 11, "found %lld\n",
 		 (long long)REINT_MAX);
 	LASSERTF(DISP_IT_EXECD == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)DISP_IT_EXECD);
@@ -490,6 +498,32 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct som_attrs *)0)->som_mountid) == 8, "found %lld\n",
 		 (long long)(int)sizeof(((struct som_attrs *)0)->som_mountid));
 
+	/* Checks for struct lsom_attrs */
+	LASSERTF((int)sizeof(struct lsom_attrs) == 32, "found %lld\n",
+		 (long long)(int)sizeof(struct lsom_attrs));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_flags) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_flags));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_flags) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_flags));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_padding) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_padding));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_padding));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_size) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_size));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_size) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_size));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_blocks) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_blocks));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_blocks) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_blocks));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_time) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_time));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_time) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_time));
+	LASSERTF(LSOM_FL_STALE == 0x00000001UL, "found 0x%.8xUL\n",
+		(unsigned)LSOM_FL_STALE);
+
 	/* Checks for struct hsm_attrs */
 	LASSERTF((int)sizeof(struct hsm_attrs) == 24, "found %lld\n",
 		 (long long)(int)sizeof(struct hsm_attrs));
@@ -597,6 +631,8 @@ void lustre_assert_wire_constants(void)
 		(unsigned)LUDA_TYPE);
 	LASSERTF(LUDA_64BITHASH == 0x00000004UL, "found 0x%.8xUL\n",
 		(unsigned)LUDA_64BITHASH);
+	LASSERTF(LUDA_ATTRS == 0x00000008UL, "found 0x%.8xUL\n",
+		(unsigned)LUDA_ATTRS);
 
 	/* Checks for struct luda_type */
 	LASSERTF((int)sizeof(struct luda_type) == 2, "found %lld\n",
@@ -606,6 +642,70 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct luda_type *)0)->lt_type) == 2, "found %lld\n",
 		 (long long)(int)sizeof(((struct luda_type *)0)->lt_type));
 
+	/* Checks for struct luda_attrs */
+	LASSERTF((int)sizeof(struct luda_attrs) == 88, "found %lld\n",
+		 (long long)(int)sizeof(struct luda_attrs));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_cookie) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_cookie));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_cookie) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_cookie));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_valid) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_valid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_valid) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_valid));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_size) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_size));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_size) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_size));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_blocks) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_blocks));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_blocks) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_blocks));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_mtime) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_mtime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_mtime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_mtime));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_atime) == 40, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_atime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_atime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_atime));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_ctime) == 48, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_ctime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_ctime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_ctime));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_mode) == 56, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_mode));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_mode) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_mode));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_uid) == 60, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_uid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_uid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_uid));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_gid) == 64, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_gid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_gid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_gid));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_flags) == 68, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_flags));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_flags) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_flags));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_nlink) == 72, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_nlink));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_nlink) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_nlink));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_rdev) == 76, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_rdev));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_rdev) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_rdev));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_lock_idx) == 80, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_lock_idx));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_lock_idx) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_lock_idx));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_lmm_size) == 84, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_lmm_size));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_lmm_size) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_lmm_size));
+
 	/* Checks for struct lu_dirpage */
 	LASSERTF((int)sizeof(struct lu_dirpage) == 24, "found %lld\n",
 		 (long long)(int)sizeof(struct lu_dirpage));
@@ -1154,6 +1254,22 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT_SHORTIO);
 	LASSERTF(OBD_CONNECT_PINGLESS == 0x4000000000000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT_PINGLESS);
+	LASSERTF(OBD_CONNECT_READDIR_PLUS == 0x8000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_READDIR_PLUS);
+	LASSERTF(OBD_CONNECT_XATTR_ALL == 0x10000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_XATTR_ALL);
+	LASSERTF(OBD_CONNECT_LAZY_SIZE == 0x20000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_LAZY_SIZE);
+	LASSERTF(OBD_CONNECT_GLIMPSE_BATCH == 0x40000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_GLIMPSE_BATCH);
+	LASSERTF(OBD_CONNECT_UNLINK_BATCH == 0x80000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_UNLINK_BATCH);
+	LASSERTF(OBD_CONNECT_DIR_STRIPE == 0x100000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_DIR_STRIPE);
+	LASSERTF(OBD_CONNECT_SYNC_BATCH == 0x200000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_SYNC_BATCH);
+	LASSERTF(OBD_CONNECT_FALLOCATE == 0x400000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_FALLOCATE);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -1360,6 +1476,8 @@ void lustre_assert_wire_constants(void)
 		 OBD_MD_FLCROSSREF);
 	LASSERTF(OBD_MD_FLGETATTRLOCK == (0x0000200000000000ULL), "found 0x%.16llxULL\n",
 		 OBD_MD_FLGETATTRLOCK);
+	LASSERTF(OBD_MD_FLXATTRALL == (0x0000800000000000ULL), "found 0x%.16llxULL\n",
+		 OBD_MD_FLXATTRALL);
 	LASSERTF(OBD_MD_FLRMTLSETFACL == (0x0001000000000000ULL), "found 0x%.16llxULL\n",
 		 OBD_MD_FLRMTLSETFACL);
 	LASSERTF(OBD_MD_FLRMTLGETFACL == (0x0002000000000000ULL), "found 0x%.16llxULL\n",
@@ -1370,6 +1488,8 @@ void lustre_assert_wire_constants(void)
 		 OBD_MD_FLRMTRGETFACL);
 	LASSERTF(OBD_MD_FLDATAVERSION == (0x0010000000000000ULL), "found 0x%.16llxULL\n",
 		 OBD_MD_FLDATAVERSION);
+	LASSERTF(OBD_MD_FLLAZYSIZE == (0x0020000000000000ULL), "found 0x%.16llxULL\n",
+		 OBD_MD_FLLAZYSIZE);
 	CLASSERT(OBD_FL_INLINEDATA == 0x00000001);
 	CLASSERT(OBD_FL_OBDMDEXISTS == 0x00000002);
 	CLASSERT(OBD_FL_DELORPHAN == 0x00000004);
@@ -1391,6 +1511,7 @@ void lustre_assert_wire_constants(void)
 	CLASSERT(OBD_FL_RECOV_RESEND == 0x00080000);
 	CLASSERT(OBD_FL_NOSPC_BLK == 0x00100000);
 	CLASSERT(OBD_FL_LOCAL_MASK == 0xf0000000);
+	CLASSERT(OST_FALLOC_KEEP_SIZE == 0x01);
 
 	/* Checks for struct lov_ost_data_v1 */
 	LASSERTF((int)sizeof(struct lov_ost_data_v1) == 24, "found %lld\n",
@@ -1486,6 +1607,8 @@ void lustre_assert_wire_constants(void)
 		(unsigned)LOV_PATTERN_FIRST);
 	LASSERTF(LOV_PATTERN_CMOBD == 0x00000200UL, "found 0x%.8xUL\n",
 		(unsigned)LOV_PATTERN_CMOBD);
+	LASSERTF(LOV_PATTERN_MDT == 0x00000400UL, "found 0x%.8xUL\n",
+		(unsigned)LOV_PATTERN_MDT);
 
 	/* Checks for struct obd_statfs */
 	LASSERTF((int)sizeof(struct obd_statfs) == 144, "found %lld\n",
@@ -1530,10 +1653,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obd_statfs, os_fprecreated));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_fprecreated) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_fprecreated));
-	LASSERTF((int)offsetof(struct obd_statfs, os_spare2) == 112, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_statfs, os_spare2));
-	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare2) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_spare2));
+	LASSERTF((int)offsetof(struct obd_statfs, os_req_rate) == 112, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_statfs, os_req_rate));
+	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_req_rate) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_req_rate));
 	LASSERTF((int)offsetof(struct obd_statfs, os_spare3) == 116, "found %lld\n",
 		 (long long)(int)offsetof(struct obd_statfs, os_spare3));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare3) == 4, "found %lld\n",
@@ -1999,10 +2122,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct mdt_body, padding_5));
 	LASSERTF((int)sizeof(((struct mdt_body *)0)->padding_5) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct mdt_body *)0)->padding_5));
-	LASSERTF((int)offsetof(struct mdt_body, padding_6) == 176, "found %lld\n",
-		 (long long)(int)offsetof(struct mdt_body, padding_6));
-	LASSERTF((int)sizeof(((struct mdt_body *)0)->padding_6) == 8, "found %lld\n",
-		 (long long)(int)sizeof(((struct mdt_body *)0)->padding_6));
+	LASSERTF((int)offsetof(struct mdt_body, lazytime) == 176, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_body, lazytime));
+	LASSERTF((int)sizeof(((struct mdt_body *)0)->lazytime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_body *)0)->lazytime));
 	LASSERTF((int)offsetof(struct mdt_body, padding_7) == 184, "found %lld\n",
 		 (long long)(int)offsetof(struct mdt_body, padding_7));
 	LASSERTF((int)sizeof(((struct mdt_body *)0)->padding_7) == 8, "found %lld\n",
@@ -2083,6 +2206,8 @@ void lustre_assert_wire_constants(void)
 		MDS_INODELOCK_OPEN);
 	LASSERTF(MDS_INODELOCK_LAYOUT == 0x000008, "found 0x%.8x\n",
 		MDS_INODELOCK_LAYOUT);
+	LASSERTF(MDS_INODELOCK_DOM == 0x000020, "found 0x%.8x\n",
+		MDS_INODELOCK_DOM);
 
 	/* Checks for struct mdt_ioepoch */
 	LASSERTF((int)sizeof(struct mdt_ioepoch) == 24, "found %lld\n",
@@ -2533,6 +2658,8 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct mdt_rec_unlink, ul_padding_9));
 	LASSERTF((int)sizeof(((struct mdt_rec_unlink *)0)->ul_padding_9) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct mdt_rec_unlink *)0)->ul_padding_9));
+	CLASSERT(MDS_UNLINK_BATCH_MAX == 256);
+	CLASSERT(MDS_UNLINK_BATCH_SIZE == 32768);
 
 	/* Checks for struct mdt_rec_rename */
 	LASSERTF((int)sizeof(struct mdt_rec_rename) == 136, "found %lld\n",
@@ -3169,6 +3296,64 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct ost_lvb *)0)->lvb_padding) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct ost_lvb *)0)->lvb_padding));
 
+	/* Checks for struct ost_glimpse */
+	LASSERTF((int)sizeof(struct ost_glimpse) == 88, "found %lld\n",
+		 (long long)(int)sizeof(struct ost_glimpse));
+	LASSERTF((int)offsetof(struct ost_glimpse, og_oi) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_glimpse, og_oi));
+	LASSERTF((int)sizeof(((struct ost_glimpse *)0)->og_oi) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_glimpse *)0)->og_oi));
+	LASSERTF((int)offsetof(struct ost_glimpse, og_handle) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_glimpse, og_handle));
+	LASSERTF((int)sizeof(((struct ost_glimpse *)0)->og_handle) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_glimpse *)0)->og_handle));
+	LASSERTF((int)offsetof(struct ost_glimpse, og_lvb) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_glimpse, og_lvb));
+	LASSERTF((int)sizeof(((struct ost_glimpse *)0)->og_lvb) == 56, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_glimpse *)0)->og_lvb));
+	LASSERTF((int)offsetof(struct ost_glimpse, og_rc) == 80, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_glimpse, og_rc));
+	LASSERTF((int)sizeof(((struct ost_glimpse *)0)->og_rc) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_glimpse *)0)->og_rc));
+	LASSERTF((int)offsetof(struct ost_glimpse, og_padding) == 84, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_glimpse, og_padding));
+	LASSERTF((int)sizeof(((struct ost_glimpse *)0)->og_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_glimpse *)0)->og_padding));
+	CLASSERT(OST_GLIMPSE_BATCH_MAX == 128);
+
+	/* Checks for struct ost_sync_rec */
+	LASSERTF((int)sizeof(struct ost_sync_rec) == 40, "found %lld\n",
+		 (long long)(int)sizeof(struct ost_sync_rec));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_oi) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_oi));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_oi) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_oi));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_opc) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_opc));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_opc) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_opc));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_count) == 20, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_count));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_count) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_count));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_uid) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_uid));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_uid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_uid));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_gid) == 28, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_gid));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_gid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_gid));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_rc) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_rc));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_rc) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_rc));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_padding) == 36, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_padding));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_padding));
+	CLASSERT(OST_SYNC_BATCH_MAX == 128);
+
 	/* Checks for struct lquota_lvb */
 	LASSERTF((int)sizeof(struct lquota_lvb) == 40, "found %lld\n",
 		 (long long)(int)sizeof(struct lquota_lvb));
@@ -58,19 +58,70 @@ static inline struct lu_buf *tti_buf_lcd(struct tgt_thread_info *tti)
 	return &tti->tti_buf;
 }
 
+struct tgt_export_committed {
+	struct dt_txn_commit_transno	 tec_dtct;
+	struct obd_export		*tec_exp;
+};
+
+/**
+ * Coalesced commit callback of an export, run once for its \a count
+ * transactions committed together, see tgt_last_commit_cb_add().
+ */
+static void tgt_cb_exp_committed(struct dt_txn_commit_transno *dtct,
+				 __u64 transno, int count)
+{
+	struct tgt_export_committed	*tec;
+	struct obd_export		*exp;
+	struct lu_target		*tgt;
+
+	tec = container_of0(dtct, struct tgt_export_committed, tec_dtct);
+	exp = tec->tec_exp;
+	tgt = class_exp2tgt(exp);
+
+	spin_lock(&tgt->lut_translock);
+	if (transno > tgt->lut_obd->obd_last_committed)
+		tgt->lut_obd->obd_last_committed = transno;
+
+	if (transno > exp->exp_last_committed) {
+		exp->exp_last_committed = transno;
+		spin_unlock(&tgt->lut_translock);
+		ptlrpc_commit_replies(exp);
+	} else {
+		spin_unlock(&tgt->lut_translock);
+	}
+	CDEBUG(D_HA, "%s: transno "LPD64" is committed\n",
+	       tgt->lut_obd->obd_name, transno);
+
+	/* the last reference frees \a tec */
+	while (count-- > 0)
+		class_export_cb_put(exp);
+}
+
 /**
  * Allocate in-memory data for client slot related to export.
  */
 int tgt_client_alloc(struct obd_export *exp)
 {
+	struct tg_export_data *ted = &exp->exp_target_data;
 	ENTRY;
 	LASSERT(exp != exp->exp_obd->obd_self_export);
 
-	OBD_ALLOC_PTR(exp->exp_target_data.ted_lcd);
-	if (exp->exp_target_data.ted_lcd == NULL)
+	OBD_ALLOC_PTR(ted->ted_lcd);
+	if (ted->ted_lcd == NULL)
 		RETURN(-ENOMEM);
+
+	OBD_ALLOC_PTR(ted->ted_committed);
+	if (ted->ted_committed == NULL) {
+		OBD_FREE_PTR(ted->ted_lcd);
+		ted->ted_lcd = NULL;
+		RETURN(-ENOMEM);
+	}
+	dt_txn_transno_init(&ted->ted_committed->tec_dtct,
+			    tgt_cb_exp_committed);
+	ted->ted_committed->tec_exp = exp;
+
 	/* Mark that slot is not yet valid, 0 doesn't work here */
-	exp->exp_target_data.ted_lr_idx = -1;
+	ted->ted_lr_idx = -1;
 	RETURN(0);
 }
 EXPORT_SYMBOL(tgt_client_alloc);
@@ -87,6 +138,9 @@ void tgt_client_free(struct obd_export *exp)
 
 	OBD_FREE_PTR(ted->ted_lcd);
 	ted->ted_lcd = NULL;
+	/* the coalesced callbacks hold the export until they ran */
+	OBD_FREE_PTR(ted->ted_committed);
+	ted->ted_committed = NULL;
 
 	/* Slot may be not yet assigned */
 	if (ted->ted_lr_idx < 0)
@@ -441,6 +495,18 @@ int tgt_last_commit_cb_add(struct thandle *th, struct lu_target *tgt,
 	struct dt_txn_commit_cb			*dcb;
 	int					 rc;
 
+	/* one callback for the transactions of the export committed
+	 * together, holding the export for each of them */
+	if (exp->exp_target_data.ted_committed != NULL) {
+		class_export_cb_get(exp);
+		rc = dt_trans_transno_add(th,
+				&exp->exp_target_data.ted_committed->tec_dtct,
+				transno);
+		if (rc == 0)
+			goto out;
+		class_export_cb_put(exp);
+	}
+
 	OBD_ALLOC_PTR(ccb);
 	if (ccb == NULL)
 		return -ENOMEM;
@@ -460,7 +526,7 @@ int tgt_last_commit_cb_add(struct thandle *th, struct lu_target *tgt,
 		class_export_cb_put(exp);
 		OBD_FREE_PTR(ccb);
 	}
-
+out:
 	if (exp_connect_flags(exp) & OBD_CONNECT_LIGHTWEIGHT)
 		/* report failure to force synchronous operation */
 		return -EPERM;
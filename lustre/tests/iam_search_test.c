@@ -0,0 +1,320 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/tests/iam_search_test.c
+ *
+ * Unit test and microbenchmark of the key search in the leaves of IAM lfix
+ * containers, on leaves laid out as create_iam.c does, full of OI entries:
+ * checks that the word-wise search finds the same entries as the bytewise
+ * binary search it replaced, and compares their costs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <libcfs/libcfs.h>
+/* prefetch() is a no-op in the userspace libcfs */
+#undef prefetch
+#define prefetch(a) __builtin_prefetch(a)
+#include <../osd-ldiskfs/osd_iam_search.h>
+
+#define error(fmt, args...) do {                        \
+	fflush(stdout), fflush(stderr);                 \
+	fprintf(stderr, "\nError:" fmt, ##args);        \
+	exit(1);                                        \
+} while (0)
+
+enum {
+	IAM_LEAF_HEADER_MAGIC = 0x1976 /* as in lustre/utils/create_iam.c */
+};
+
+/* as in lustre/utils/create_iam.c */
+struct iam_leaf_head {
+	__u16 ill_magic;
+	__u16 ill_count;
+};
+
+/* OI entries: a big-endian FID, then the inode number and generation */
+#define OI_KEY_SIZE	16
+#define OI_REC_SIZE	8
+#define OI_ENTRY_SIZE	(OI_KEY_SIZE + OI_REC_SIZE)
+
+static int	 blocksize = 4096;
+static int	 leaves = 1024;
+static char	*blocks;
+static char	*keys;
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void *leaf_entries(int leaf)
+{
+	return blocks + leaf * blocksize + sizeof(struct iam_leaf_head);
+}
+
+static int leaf_count(int leaf)
+{
+	struct iam_leaf_head *head = (void *)(blocks + leaf * blocksize);
+
+	return le16_to_cpu(head->ill_count);
+}
+
+/* a FID of a few sequences, in the big-endian layout of the OI keys */
+static void oi_key(void *key)
+{
+	__u64 seq = cpu_to_be64(0x200000400ULL + random() % 4);
+	__u32 oid = cpu_to_be32(random());
+	__u32 ver = 0;
+
+	memcpy(key, &seq, sizeof(seq));
+	memcpy(key + 8, &oid, sizeof(oid));
+	memcpy(key + 12, &ver, sizeof(ver));
+}
+
+static int sign(int x)
+{
+	return (x > 0) - (x < 0);
+}
+
+static int oi_keycmp(const void *k1, const void *k2)
+{
+	return memcmp(k1, k2, OI_KEY_SIZE);
+}
+
+/* fill each leaf with sorted entries, as full as IAM leaves get */
+static void leaves_build(void)
+{
+	struct iam_leaf_head	*head;
+	int			 limit;
+	int			 count;
+	int			 i, j;
+
+	limit = (blocksize - sizeof(*head)) / OI_ENTRY_SIZE;
+	for (i = 0; i < leaves; i++) {
+		head = (void *)(blocks + i * blocksize);
+		count = limit / 2 + random() % (limit / 2 + 1);
+		for (j = 0; j < count; j++)
+			oi_key(keys + j * OI_KEY_SIZE);
+		qsort(keys, count, OI_KEY_SIZE, oi_keycmp);
+		for (j = 0; j < count; j++)
+			memcpy(leaf_entries(i) + j * OI_ENTRY_SIZE,
+			       keys + j * OI_KEY_SIZE, OI_KEY_SIZE);
+		head->ill_magic = cpu_to_le16(IAM_LEAF_HEADER_MAGIC);
+		head->ill_count = cpu_to_le16(count);
+	}
+}
+
+/* the generic memcmp() of the kernel, which compares a byte at a time */
+static int kernel_memcmp(const void *cs, const void *ct, size_t count)
+{
+	const unsigned char *su1, *su2;
+	int res = 0;
+
+	for (su1 = cs, su2 = ct; 0 < count; ++su1, ++su2, count--)
+		if ((res = *su1 - *su2) != 0)
+			break;
+	return res;
+}
+
+/* what iam_lfix_lookup() did: binary search comparing keys with memcmp() */
+static int bytewise_search(const void *entries, int count, const void *key)
+{
+	int p = 0;
+	int q = count - 1;
+	int m;
+
+#define KEY(i) (entries + (i) * OI_ENTRY_SIZE)
+	if (kernel_memcmp(key, KEY(p), OI_KEY_SIZE) < 0)
+		return -1;
+	if (kernel_memcmp(KEY(q), key, OI_KEY_SIZE) <= 0)
+		return q;
+	while (p + 1 != q) {
+		m = p + (q - p) / 2;
+		if (kernel_memcmp(KEY(m), key, OI_KEY_SIZE) <= 0)
+			p = m;
+		else
+			q = m;
+	}
+	while (p > 0 && kernel_memcmp(KEY(p - 1), key, OI_KEY_SIZE) == 0)
+		p--;
+#undef KEY
+	return p;
+}
+
+/* keys to look up: the first of a leaf, others in it, or random ones */
+static void *probe_key(int leaf, char *buf)
+{
+	int count = leaf_count(leaf);
+
+	switch (random() % 4) {
+	case 0:
+		return leaf_entries(leaf);
+	case 1:
+		oi_key(buf);
+		return buf;
+	default:
+		return leaf_entries(leaf) + random() % count * OI_ENTRY_SIZE;
+	}
+}
+
+static void iam_search_check(int probes)
+{
+	char	 buf[OI_KEY_SIZE];
+	void	*key;
+	int	 leaf;
+	int	 count;
+	int	 i, j;
+
+	for (i = 0; i < probes; i++) {
+		leaf = random() % leaves;
+		count = leaf_count(leaf);
+		key = probe_key(leaf, buf);
+		j = iam_lfix_search(leaf_entries(leaf), count, OI_ENTRY_SIZE,
+				    OI_KEY_SIZE, key);
+		if (j != bytewise_search(leaf_entries(leaf), count, key))
+			error("leaf %d: found entry %d, not %d\n", leaf, j,
+			      bytewise_search(leaf_entries(leaf), count, key));
+	}
+
+	/* and keys differing by a single bit */
+	for (i = 0; i < probes; i++) {
+		char a[OI_KEY_SIZE];
+		char b[OI_KEY_SIZE];
+
+		oi_key(a);
+		memcpy(b, a, sizeof(b));
+		b[random() % OI_KEY_SIZE] ^= 1 << (random() % 8);
+		if (sign(iam_keycmp_words(a, b, OI_KEY_SIZE)) !=
+		    sign(memcmp(a, b, OI_KEY_SIZE)))
+			error("keys compare otherwise than memcmp()\n");
+	}
+	printf("%d probes of %d leaves of %d bytes: same entries found\n",
+	       probes, leaves, blocksize);
+}
+
+static void iam_search_bench(int probes)
+{
+	double	  start, words, bytes;
+	char	  buf[OI_KEY_SIZE];
+	void	**key;
+	int	 *leaf;
+	long	  sum = 0;
+	int	  i;
+
+	key = calloc(probes, sizeof(*key));
+	leaf = calloc(probes, sizeof(*leaf));
+	if (key == NULL || leaf == NULL)
+		error("cannot allocate %d probes\n", probes);
+	for (i = 0; i < probes; i++) {
+		leaf[i] = random() % leaves;
+		key[i] = probe_key(leaf[i], buf);
+		if (key[i] == buf)
+			key[i] = leaf_entries(leaf[i]) + OI_ENTRY_SIZE;
+	}
+
+	start = now();
+	for (i = 0; i < probes; i++)
+		sum += iam_lfix_search(leaf_entries(leaf[i]),
+				       leaf_count(leaf[i]), OI_ENTRY_SIZE,
+				       OI_KEY_SIZE, key[i]);
+	words = (now() - start) / probes;
+
+	start = now();
+	for (i = 0; i < probes; i++)
+		sum -= bytewise_search(leaf_entries(leaf[i]),
+				       leaf_count(leaf[i]), key[i]);
+	bytes = (now() - start) / probes;
+
+	if (sum != 0)
+		error("searches disagree\n");
+	printf("leaf search: %.1fns, bytewise search %.1fns (x%.2f)\n",
+	       words * 1e9, bytes * 1e9, bytes / words);
+	free(key);
+	free(leaf);
+}
+
+static void usage(char *prog)
+{
+	fprintf(stderr, "usage: %s [-b blocksize] [-l leaves] "
+		"[-p probes] [-r seed]\n", prog);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	int probes = 1000000;
+	int c;
+
+	srandom(time(NULL));
+	while ((c = getopt(argc, argv, "b:l:p:r:")) != -1) {
+		switch (c) {
+		case 'b':
+			blocksize = atoi(optarg);
+			if (blocksize < 1024 || blocksize > 65536)
+				usage(argv[0]);
+			break;
+		case 'l':
+			leaves = atoi(optarg);
+			if (leaves < 1)
+				usage(argv[0]);
+			break;
+		case 'p':
+			probes = atoi(optarg);
+			if (probes < 1)
+				usage(argv[0]);
+			break;
+		case 'r':
+			srandom(atoi(optarg));
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+
+	blocks = calloc(leaves, blocksize);
+	keys = calloc(blocksize / OI_ENTRY_SIZE, OI_KEY_SIZE);
+	if (blocks == NULL || keys == NULL)
+		error("cannot allocate %d leaves\n", leaves);
+
+	leaves_build();
+	iam_search_check(probes);
+	iam_search_bench(probes);
+	return 0;
+}
@@ -980,6 +980,86 @@ test_10()
 }
 run_test 10 "System is available during LFSCK scanning"
 
+test_11() {
+	local param=/sys/module/lfsck/parameters/lfsck_threads_per_cpt
+	local saved=$(do_facet $SINGLEMDS "cat $param")
+
+	lfsck_prep 10 10
+	echo "start $SINGLEMDS"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_SCRUB > /dev/null ||
+		error "(1) Fail to start MDS!"
+
+	mount_client $MOUNT || error "(2) Fail to start client!"
+
+	#define OBD_FAIL_LFSCK_LINKEA_CRASH	0x1603
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x1603
+	for ((i = 0; i < 10; i++)); do
+		touch $DIR/$tdir/d${i}/dummy
+	done
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+
+	for ((i = 0; i < 10; i++)); do
+		ln $DIR/$tdir/d${i}/f0 $DIR/$tdir/e${i}/l0 ||
+			error "(3) Fail to hardlink!"
+	done
+
+	umount_client $MOUNT
+	do_facet $SINGLEMDS "echo 4 > $param"
+	$START_NAMESPACE || error "(4) Fail to start LFSCK for namespace!"
+
+	sleep 3
+	do_facet $SINGLEMDS "echo $saved > $param"
+	local STATUS=$($SHOW_NAMESPACE | awk '/^status/ { print $2 }')
+	[ "$STATUS" == "completed" ] ||
+		error "(5) Expect 'completed', but got '$STATUS'"
+
+	local repaired=$($SHOW_NAMESPACE |
+			 awk '/^updated_phase1/ { print $2 }')
+	[ $repaired -eq 10 ] ||
+		error "(6) Fail to repair crashed linkEA: $repaired"
+
+	mount_client $MOUNT || error "(7) Fail to start client!"
+
+	local dummyfid
+	local dummyname
+	for ((i = 0; i < 10; i++)); do
+		dummyfid=$($LFS path2fid $DIR/$tdir/d${i}/dummy)
+		dummyname=$($LFS fid2path $DIR $dummyfid)
+		[ "$dummyname" == "$DIR/$tdir/d${i}/dummy" ] ||
+			error "(8) Fail to repair linkEA: $dummyfid $dummyname"
+
+		stat $DIR/$tdir/e${i}/l0 | grep "Links: 2" > /dev/null ||
+			error "(9) Fail to stat $DIR/$tdir/e${i}/l0"
+	done
+}
+run_test 11 "LFSCK checks the name entries on several threads"
+
+test_12() {
+	lfsck_prep 10 10
+	echo "start $SINGLEMDS"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_SCRUB > /dev/null ||
+		error "(1) Fail to start MDS!"
+
+	do_facet $SINGLEMDS \
+		$LCTL set_param -n mdd.${MDT_DEV}.lfsck_latency_target 1000
+	local target=$(do_facet $SINGLEMDS \
+		$LCTL get_param -n mdd.${MDT_DEV}.lfsck_latency_target)
+	[ "$target" == "1000" ] ||
+		error "(2) Expect latency target 1000, but got '$target'"
+
+	$START_NAMESPACE || error "(3) Fail to start LFSCK for namespace!"
+	$SHOW_NAMESPACE | grep -q "^speed_limit" ||
+		error "(4) No speed limit in the LFSCK status"
+
+	sleep 3
+	do_facet $SINGLEMDS \
+		$LCTL set_param -n mdd.${MDT_DEV}.lfsck_latency_target 0
+	local STATUS=$($SHOW_NAMESPACE | awk '/^status/ { print $2 }')
+	[ "$STATUS" == "completed" ] ||
+		error "(5) Expect 'completed', but got '$STATUS'"
+}
+run_test 12 "LFSCK adapts its speed to the service latency target"
+
 $LCTL set_param debug=-lfsck > /dev/null || true
 
 # restore MDS/OST size
@@ -2308,6 +2308,45 @@ test_36() {
 }
 run_test 36 "Migrate old admin files into new global indexes"
 
+# fallocate on the OSTs is charged to the block quota
+test_37() {
+	[ $(facet_fstype ost1) != ldiskfs ] &&
+		skip "only ldiskfs OSTs preallocate" && return
+	$LCTL get_param -n osc.*.import | grep -q fallocate ||
+		{ skip "OSTs without OST_FALLOCATE" && return; }
+	which fallocate > /dev/null 2>&1 || { skip "no fallocate" && return; }
+
+	local LIMIT=10  # 10M
+	local TESTFILE="$DIR/$tdir/$tfile-0"
+
+	setup_quota_test
+	trap cleanup_quota_test EXIT
+
+	set_ost_qtype "ug" || error "enable ost quota failed"
+
+	log "User quota (block hardlimit:$LIMIT MB)"
+	$LFS setquota -u $TSTUSR -b 0 -B ${LIMIT}M -i 0 -I 0 $DIR ||
+		error "set user quota failed"
+
+	$LFS setstripe $TESTFILE -c 1
+	chown $TSTUSR.$TSTUSR $TESTFILE
+
+	$RUNAS fallocate -l $((LIMIT / 2))M $TESTFILE ||
+		quota_error u $TSTUSR "fallocate failure, but expect success"
+	$RUNAS fallocate -o $((LIMIT / 2))M -l $((LIMIT * 2))M $TESTFILE &&
+		quota_error u $TSTUSR "fallocate success, but expect EDQUOT"
+
+	rm -f $TESTFILE
+	wait_delete_completed
+	sync_all_data || true
+	local USED=$(getquota -u $TSTUSR global curspace)
+	[ $USED -ne 0 ] && quota_error u $TSTUSR \
+		"user quota isn't released after deletion"
+	resetquota -u $TSTUSR
+	cleanup_quota_test
+}
+run_test 37 "fallocate is limited by the block quota"
+
 quota_fini()
 {
         do_nodes $(comma_list $(nodes_list)) "lctl set_param debug=-quota"
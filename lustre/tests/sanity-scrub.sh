@@ -793,6 +793,43 @@ test_11() {
 }
 run_test 11 "OI scrub skips the new created objects only once"
 
+test_12() {
+	local param=/sys/module/osd_ldiskfs/parameters/osd_scrub_threads
+	local saved=$(do_facet $SINGLEMDS "cat $param")
+
+	scrub_prep 0
+	mds_remove_ois || error "(1) Fail to remove/recreate!"
+
+	do_facet $SINGLEMDS "echo 8 > $param"
+	#define OBD_FAIL_OSD_SCRUB_DELAY	 0x190
+	do_facet $SINGLEMDS $LCTL set_param fail_val=1 fail_loc=0x190
+
+	echo "start $SINGLEMDS with OI scrub of 8 threads"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_SCRUB > /dev/null ||
+		error "(2) Fail to start MDS!"
+
+	local STATUS=$($SHOW_SCRUB | awk '/^status/ { print $2 }')
+	[ "$STATUS" == "scanning" ] ||
+		error "(3) Expect 'scanning', but got '$STATUS'"
+
+	local THREADS=$($SHOW_SCRUB | awk '/^threads/ { print $2 }')
+	[ -n "$THREADS" ] && [ $THREADS -gt 1 ] ||
+		error "(4) Expect several threads, but got '$THREADS'"
+
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0 fail_val=0
+	do_facet $SINGLEMDS "echo $saved > $param"
+	sleep 3
+	STATUS=$($SHOW_SCRUB | awk '/^status/ { print $2 }')
+	[ "$STATUS" == "completed" ] ||
+		error "(5) Expect 'completed', but got '$STATUS'"
+
+	mount_client $MOUNT || error "(6) Fail to start client!"
+
+	diff -q $LUSTRE/tests/test-framework.sh $DIR/$tdir/test-framework.sh ||
+		error "(7) File diff failed unexpected!"
+}
+run_test 12 "OI scrub with several threads rebuilds the OI files"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
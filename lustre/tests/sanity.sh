@@ -11299,6 +11299,723 @@ test_233() {
 }
 run_test 233 "checking that OBF of the FS root succeeds"
 
+test_234() {
+	local dom=$DIR/$tdir/dom
+	local ref=$TMP/$tfile.ref
+	local param=lod.$FSNAME-MDT0000-mdtlov.dom_stripesize
+	local save
+
+	[ $(lustre_version_code $SINGLEMDS) -lt $(version_code 2.4.51) ] &&
+		skip "needs MDS with Data-on-MDT support" && return
+
+	save=$(do_facet $SINGLEMDS $LCTL get_param -n $param)
+	do_facet $SINGLEMDS $LCTL set_param $param=1048576
+	mkdir -p $DIR/$tdir
+	$SETSTRIPE -L mdt -S 1M $dom || error "create DoM file failed"
+	$GETSTRIPE -c $dom | grep -q "^0$" ||
+		error "DoM file should have no OST stripes"
+
+	dd if=/dev/urandom of=$ref bs=4k count=50 2>/dev/null
+	cp $ref $dom || error "write DoM file failed"
+	cancel_lru_locks mdc
+	cmp $ref $dom || error "DoM file content mismatch"
+	[ $(stat -c %s $dom) -eq $(stat -c %s $ref) ] ||
+		error "DoM file size $(stat -c %s $dom) is wrong"
+
+	echo -n "tail" >> $dom || error "append to DoM file failed"
+	echo -n "tail" >> $ref
+	cmp $ref $dom || error "DoM file mismatch after append"
+
+	$TRUNCATE $dom 1000 || error "truncate DoM file failed"
+	$TRUNCATE $ref 1000
+	cancel_lru_locks mdc
+	cmp $ref $dom || error "DoM file mismatch after truncate"
+
+	dd if=/dev/zero of=$dom bs=1M count=2 2>/dev/null &&
+		error "write beyond DoM size should fail"
+
+	rm -f $dom $ref || error "unlink DoM file failed"
+	do_facet $SINGLEMDS $LCTL set_param $param=$save
+	do_facet $SINGLEMDS $LCTL set_param $param=2097152 &&
+		error "DoM size above 1MB should be refused"
+	return 0
+}
+run_test 234 "Data-on-MDT file create, read, write and truncate"
+
+test_235() {
+	local dir=$DIR/$tdir
+	local count=100
+	local save=$($LCTL get_param -n llite.*.readdir_plus 2>/dev/null |
+		     head -1)
+	local locks=0
+	local n
+
+	[ -z "$save" ] && skip "client does not support readdir-plus" &&
+		return
+	[ $(lustre_version_code $SINGLEMDS) -lt $(version_code 2.4.51) ] &&
+		skip "needs MDS with readdir-plus support" && return
+
+	mkdir -p $dir
+	createmany -o $dir/f $count || error "createmany failed"
+	mkdir $dir/subdir || error "mkdir failed"
+	ln -s f0 $dir/link || error "symlink failed"
+
+	$LCTL set_param -n llite.*.readdir_plus=0
+	cancel_lru_locks mdc
+	ls -l --time-style=+%s $dir > $TMP/$tfile.ref ||
+		error "ls -l without readdir-plus failed"
+
+	$LCTL set_param -n llite.*.readdir_plus=1
+	cancel_lru_locks mdc
+	ls -U $dir > /dev/null || error "readdir-plus failed"
+	for n in $($LCTL get_param -n ldlm.namespaces.*mdc*.lock_count); do
+		locks=$((locks + n))
+	done
+	echo "$locks MDC locks after readdir-plus"
+	ls -l --time-style=+%s $dir > $TMP/$tfile.plus ||
+		error "ls -l with readdir-plus failed"
+	$LCTL set_param -n llite.*.readdir_plus=$save
+
+	[ $locks -ge $count ] ||
+		error "readdir-plus granted $locks locks, expect $count+"
+	diff -u $TMP/$tfile.ref $TMP/$tfile.plus ||
+		error "attributes from readdir-plus differ"
+	rm -rf $dir $TMP/$tfile.ref $TMP/$tfile.plus
+}
+run_test 235 "readdir-plus returns attributes and locks of the entries"
+
+sa_pattern_started() {
+	$LCTL get_param -n llite.*.statahead_stats |
+		awk '/^'$1' started:/ { n += $3 } END { print n + 0 }'
+}
+
+test_236() {
+	local dir=$DIR/$tdir
+	local count=200
+	local first
+	local before
+	local after
+	local pattern
+
+	$LCTL get_param -n llite.*.statahead_stats | grep -q "hash started" ||
+		{ skip "client does not predict statahead patterns" && return; }
+
+	mkdir -p $dir
+	createmany -o $dir/f $count || error "createmany failed"
+	# skip the first dirent, so that the "ls -l" statahead does not start
+	first=$(ls -U $dir | head -1)
+
+	for pattern in hash name; do
+		before=$(sa_pattern_started $pattern)
+		cancel_lru_locks mdc
+		if [ $pattern = hash ]; then
+			ls -U $dir
+		else
+			ls -U $dir | LC_ALL=C sort
+		fi | grep -v "^$first\$" | (cd $dir; xargs stat > /dev/null) ||
+			error "stat in $pattern order failed"
+		after=$(sa_pattern_started $pattern)
+		$LCTL get_param -n llite.*.statahead_stats | grep "^$pattern"
+		[ $after -gt $before ] ||
+			error "no statahead for stat in $pattern order"
+	done
+	rm -rf $dir
+}
+run_test 236 "statahead for stat in readdir or name order without ls -l"
+
+mdc_close_count() {
+	$LCTL get_param -n mdc.*.stats |
+		awk '/^mds_close/ { n += $2 } END { print n + 0 }'
+}
+
+test_237() {
+	local file=$DIR/$tfile
+	local save=$($LCTL get_param -n llite.*.opencache_threshold_count \
+		     2>/dev/null | head -1)
+	local opens=20
+	local closes
+	local i
+
+	[ -z "$save" ] && skip "client does not cache open handles" && return
+
+	echo data > $file || error "write $file failed"
+	cancel_lru_locks mdc
+
+	$LCTL set_param -n llite.*.opencache_threshold_count=2
+	$LCTL set_param -n mdc.*.stats=clear
+	for i in $(seq $opens); do
+		cat $file > /dev/null || error "cat $file failed"
+	done
+	closes=$(mdc_close_count)
+	echo "$closes MDS closes for $opens opens with the open cache"
+	# the cached open handle is closed when the OPEN lock is cancelled
+	cancel_lru_locks mdc
+	[ $closes -lt $((opens / 2)) ] ||
+		error "$closes MDS closes for $opens opens, open handle not cached"
+
+	$LCTL set_param -n llite.*.opencache_threshold_count=0
+	$LCTL set_param -n mdc.*.stats=clear
+	for i in $(seq $opens); do
+		cat $file > /dev/null || error "cat $file failed"
+	done
+	closes=$(mdc_close_count)
+	$LCTL set_param -n llite.*.opencache_threshold_count=$save
+	[ $closes -ge $opens ] ||
+		error "$closes MDS closes for $opens opens without the open cache"
+	rm -f $file
+}
+run_test 237 "open handle cached under OPEN lock for repeated opens"
+
+llite_stats_count() {
+	$LCTL get_param -n llite.*.stats |
+		awk '/^'$1' / { n += $2 } END { print n + 0 }'
+}
+
+test_238() {
+	local file=$DIR/$tfile
+	local save=$($LCTL get_param -n llite.*.xattr_cache 2>/dev/null |
+		     head -1)
+	local gets=20
+	local hits
+	local i
+
+	[ -z "$save" ] && skip "client does not cache xattrs" && return
+
+	touch $file || error "touch $file failed"
+	setfattr -n user.$tfile -v v1 $file ||
+		{ skip "user xattrs not supported" && return; }
+	cancel_lru_locks mdc
+
+	$LCTL set_param -n llite.*.xattr_cache=1
+	$LCTL set_param -n llite.*.stats=clear
+	for i in $(seq $gets); do
+		getfattr -n user.$tfile --only-values $file > /dev/null ||
+			error "getfattr $file failed"
+	done
+	hits=$(llite_stats_count getxattr_hits)
+	echo "$hits xattr cache hits for $gets getxattrs"
+	[ $hits -gt $((gets / 2)) ] ||
+		error "$hits xattr cache hits for $gets getxattrs"
+
+	# a change must not be hidden by the cached value
+	setfattr -n user.$tfile -v v2 $file || error "setfattr $file failed"
+	[ "$(getfattr -n user.$tfile --only-values $file)" == "v2" ] ||
+		error "stale xattr value after setfattr"
+	setfattr -x user.$tfile $file || error "setfattr -x $file failed"
+	getfattr -n user.$tfile $file 2>/dev/null &&
+		error "removed xattr still cached"
+
+	$LCTL set_param -n llite.*.xattr_cache=$save
+	rm -f $file
+}
+run_test 238 "xattrs cached on the client under the UPDATE lock"
+
+test_239() {
+	local file=$DIR/$tfile
+	local save=$($LCTL get_param -n llite.*.lazy_size 2>/dev/null |
+		     head -1)
+	local stats=10
+	local size
+	local lazy
+	local i
+
+	[ -z "$save" ] && skip "client does not support lazy size" && return
+	[ $OSTCOUNT -lt 2 ] && skip "needs >= 2 OSTs" && return
+
+	$SETSTRIPE -c 2 $file || error "setstripe $file failed"
+	dd if=/dev/zero of=$file bs=1M count=3 || error "dd $file failed"
+	size=$(stat -c %s $file)
+
+	$LCTL set_param -n llite.*.lazy_size=1
+	cancel_lru_locks osc
+	cancel_lru_locks mdc
+	$LCTL set_param -n llite.*.stats=clear
+	for i in $(seq $stats); do
+		[ $(stat -c %s $file) -eq $size ] ||
+			error "lazy size of $file is not $size"
+	done
+	lazy=$(llite_stats_count getattr_lazy)
+	echo "$lazy lazy getattrs for $stats stats"
+	[ $lazy -gt 0 ] || error "no lazy getattr for $stats stats"
+
+	$LFS lazystat -l $file | grep -q "size=$size .*age=" ||
+		error "lazystat -l $file does not report a lazy size"
+
+	# a truncate makes the lazy size stale until it is reconciled
+	$TRUNCATE $file 4096 || error "truncate $file failed"
+	cancel_lru_locks mdc
+	[ $(stat -c %s $file) -eq 4096 ] ||
+		error "stale lazy size after truncate"
+	$LFS som_sync $file || error "som_sync $file failed"
+	$LFS lazystat -l $file | grep -q "size=4096 .*age=" ||
+		error "lazy size of $file not updated by som_sync"
+
+	$LCTL set_param -n llite.*.lazy_size=$save
+	rm -f $file
+}
+run_test 239 "lazy size-on-MDT for stat of striped files"
+
+test_240() {
+	local dir=$DIR/$tdir
+	local save=$($LCTL get_param -n llite.*.statahead_agl_batch \
+		     2>/dev/null | head -1)
+	local nr=100
+	local rpcs
+	local i
+
+	[ -z "$save" ] && skip "client does not support batched glimpse" &&
+		return
+	[ $OSTCOUNT -lt 2 ] && skip "needs >= 2 OSTs" && return
+
+	test_mkdir -p $dir
+	$SETSTRIPE -c 2 $dir || error "setstripe $dir failed"
+	for i in $(seq $nr); do
+		dd if=/dev/zero of=$dir/f$i bs=1k count=$i 2>/dev/null ||
+			error "dd $dir/f$i failed"
+	done
+
+	$LCTL set_param -n llite.*.statahead_agl_batch=32
+	cancel_lru_locks osc
+	cancel_lru_locks mdc
+	$LCTL set_param -n osc.*.stats=clear
+	ls -l $dir > /dev/null || error "ls -l $dir failed"
+	rpcs=$($LCTL get_param -n osc.*.stats |
+	       awk '/^ost_glimpse_batch / { sum += $2 } END { print sum + 0 }')
+	echo "$rpcs batched glimpse RPCs for $nr files"
+	[ $rpcs -gt 0 ] || error "no batched glimpse for $nr files"
+
+	for i in $(seq $nr); do
+		[ $(stat -c %s $dir/f$i) -eq $((i * 1024)) ] ||
+			error "wrong size of $dir/f$i"
+	done
+
+	$LCTL set_param -n llite.*.statahead_agl_batch=$save
+	rm -rf $dir
+}
+run_test 240 "batched glimpse of striped files by AGL"
+
+test_241() {
+	local dir=$DIR/$tdir
+	local nr=600
+	local rpcs
+
+	$LCTL get_param -n mdc.*.connect_flags | grep -q unlink_batch ||
+		{ skip "MDS does not support batched unlink" && return; }
+
+	test_mkdir -p $dir/sub
+	createmany -m $dir/f $nr || error "createmany in $dir failed"
+	createmany -m $dir/sub/f 10 || error "createmany in $dir/sub failed"
+	ln -s f0 $dir/link || error "symlink in $dir failed"
+
+	$LFS rm $dir 2>/dev/null && error "rm of $dir without -r succeeded"
+	$LFS rm $dir/f0 || error "rm of $dir/f0 failed"
+	[ -e $dir/f0 ] && error "$dir/f0 not removed"
+
+	$LCTL set_param -n mdc.*.md_stats=clear
+	$LFS rm -r $dir || error "rm -r of $dir failed"
+	[ -e $dir ] && error "$dir not removed"
+
+	rpcs=$($LCTL get_param -n mdc.*.md_stats |
+	       awk '/^unlink_batch / { sum += $2 } END { print sum + 0 }')
+	echo "$rpcs batched unlink RPCs for $((nr + 11)) entries"
+	[ $rpcs -gt 0 -a $rpcs -lt 10 ] ||
+		error "$rpcs batched unlink RPCs for $((nr + 11)) entries"
+}
+run_test 241 "batched unlink of a directory tree"
+
+test_242() {
+	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return
+	$LCTL get_param -n mdc.*.connect_flags | grep -q dir_stripe ||
+		{ skip "MDS does not support striped directories" && return; }
+
+	local dir=$DIR/$tdir/striped
+	local nr=200
+	local count
+
+	test_mkdir -p $DIR/$tdir
+	$LFS setdirstripe -c $MDSCOUNT $dir ||
+		error "setdirstripe -c $MDSCOUNT $dir failed"
+	count=$($LFS getdirstripe -c $dir)
+	[ $count -eq $MDSCOUNT ] ||
+		error "$dir has $count stripes, not $MDSCOUNT"
+	count=$($LFS getdirstripe $dir | awk 'NR > 1 { print $1 }' |
+		sort -u | wc -l)
+	[ $count -eq $MDSCOUNT ] || error "$dir striped over $count MDTs"
+
+	createmany -o $dir/f $nr || error "createmany in $dir failed"
+	mkdir $dir/sub || error "mkdir in $dir failed"
+	count=$(ls $dir | wc -l)
+	[ $count -eq $((nr + 1)) ] ||
+		error "ls of $dir shows $count entries, not $((nr + 1))"
+	count=$(ls -a $dir | wc -l)
+	[ $count -eq $((nr + 3)) ] ||
+		error "ls -a of $dir shows $count entries, not $((nr + 3))"
+
+	mv $dir/f0 $dir/g0 || error "rename in $dir failed"
+	[ -e $dir/g0 -a ! -e $dir/f0 ] || error "rename in $dir lost a name"
+
+	rmdir $dir 2>/dev/null && error "rmdir of non-empty $dir succeeded"
+	count=$(ls $dir | wc -l)
+	[ $count -eq $((nr + 1)) ] ||
+		error "failed rmdir of $dir left $count entries, not $((nr + 1))"
+	createmany -o $dir/h 10 || error "create after failed rmdir failed"
+	unlinkmany $dir/h 10 || error "unlinkmany of $dir/h failed"
+	unlinkmany $dir/f 1 $((nr - 1)) || error "unlinkmany in $dir failed"
+	rm -f $dir/g0 || error "unlink in $dir failed"
+	rmdir $dir/sub $dir || error "rmdir of $dir failed"
+	[ -e $dir ] && error "$dir not removed"
+	return 0
+}
+run_test 242 "directory striped over all MDTs"
+
+test_243() {
+	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return
+	local placement=$($LCTL get_param -n lmv.*.placement | head -1)
+	local nr=40
+	local used
+
+	$LCTL get_param -n lmv.*.qos_weights | grep -q weight= ||
+		{ skip "client does not support QOS placement" && return; }
+	test_mkdir -p $DIR/$tdir
+	$LCTL set_param lmv.*.placement=QOS || error "set placement=QOS failed"
+	for i in $(seq $nr); do
+		$LFS mkdir -c 1 $DIR/$tdir/d$i ||
+			{ $LCTL set_param lmv.*.placement=$placement;
+			  error "lfs mkdir -c 1 $DIR/$tdir/d$i failed"; }
+	done
+	$LCTL set_param lmv.*.placement=$placement
+
+	$LCTL get_param lmv.*.qos_weights
+	[ $($LCTL get_param -n lmv.*.qos_weights | wc -l) -eq $MDSCOUNT ] ||
+		error "qos_weights does not list all $MDSCOUNT MDTs"
+	used=$(for i in $(seq $nr); do
+		$LFS getdirstripe -i $DIR/$tdir/d$i; done | sort -u | wc -l)
+	[ $used -gt 1 ] || error "$nr directories all placed on one MDT"
+	rm -rf $DIR/$tdir || error "rm -rf $DIR/$tdir failed"
+}
+run_test 243 "QOS placement of new directories over the MDTs"
+
+test_244() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	local mdtosc=$(get_mdtosc_proc_path $SINGLEMDS $FSNAME-OST0000)
+	local stats="osc.$mdtosc.prealloc_stats"
+	local nr=2000
+	local rate
+	local count
+
+	do_facet $SINGLEMDS $LCTL get_param -n $stats > /dev/null 2>&1 ||
+		{ skip "MDS does not export $stats" && return; }
+	do_facet $SINGLEMDS $LCTL set_param $stats=clear
+
+	test_mkdir -p $DIR/$tdir
+	$SETSTRIPE -c 1 -i 0 $DIR/$tdir || error "setstripe $DIR/$tdir failed"
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+
+	do_facet $SINGLEMDS $LCTL get_param $stats
+	count=$(do_facet $SINGLEMDS $LCTL get_param -n $stats |
+		awk '/^create_count:/ { print $2 }')
+	[ $count -ge 32 ] || error "precreate count $count below the minimum"
+	# the forecast is only folded in after a second of creates
+	sleep 2
+	touch $DIR/$tdir/last || error "touch $DIR/$tdir/last failed"
+	rate=$(do_facet $SINGLEMDS $LCTL get_param -n $stats |
+		awk '/^create_rate:/ { print $2 }')
+	[ $rate -gt 0 ] || error "no create rate forecast after $nr creates"
+	unlinkmany $DIR/$tdir/f $nr || error "unlinkmany failed"
+	rm -rf $DIR/$tdir
+}
+run_test 244 "precreate sized from the create rate forecast"
+
+test_245() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	local mdtosc=$(get_mdtosc_proc_path $SINGLEMDS $FSNAME-OST0000)
+	local param="osc.$mdtosc.max_sync_batch"
+	local stats="ost.OSS.ost.stats"
+	local nr=1000
+	local before
+	local after
+
+	do_facet $SINGLEMDS $LCTL get_param -n $param > /dev/null 2>&1 ||
+		{ skip "MDS does not export $param" && return; }
+
+	test_mkdir -p $DIR/$tdir
+	$SETSTRIPE -c 1 -i 0 $DIR/$tdir || error "setstripe $DIR/$tdir failed"
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	wait_delete_completed
+	before=$(do_facet ost1 $LCTL get_param -n $stats |
+		awk '/^ost_sync_batch / { print $2 }')
+
+	unlinkmany $DIR/$tdir/f $nr || error "unlinkmany failed"
+	wait_delete_completed
+	after=$(do_facet ost1 $LCTL get_param -n $stats |
+		awk '/^ost_sync_batch / { print $2 }')
+	echo "ost_sync_batch RPCs: ${before:-0} -> ${after:-0}"
+	[ ${after:-0} -gt ${before:-0} ] ||
+		error "no batched destroys sent to OST0000"
+	[ $((${after:-0} - ${before:-0})) -lt $nr ] ||
+		error "one RPC sent per destroyed object"
+	rm -rf $DIR/$tdir
+}
+run_test 245 "batched OST object destroys from OSP sync"
+
+test_246() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	local param=/sys/module/ost/parameters/oss_write_stages
+	local osc_mppc=osc.$(get_osc_import_name client ost1).max_pages_per_rpc
+	local orig_mppc=$($LCTL get_param -n $osc_mppc)
+	local orig_stages
+	local sum
+	local stages
+
+	orig_stages=$(do_facet ost1 cat $param 2> /dev/null) ||
+		{ skip "OSS has no write stages" && return; }
+	# several MDs per RPC
+	$LCTL set_param $osc_mppc=1024 > /dev/null
+	[ $($LCTL get_param -n $osc_mppc) -ge 512 ] ||
+		{ $LCTL set_param $osc_mppc=$orig_mppc
+		  skip "RPCs of a single MD" && return; }
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe $DIR/$tfile failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=32 ||
+		error "dd to $TMP/$tfile failed"
+	sum=$(md5sum < $TMP/$tfile)
+	for stages in 1 0; do
+		do_facet ost1 "echo $stages > $param"
+		dd if=$TMP/$tfile of=$DIR/$tfile bs=4M ||
+			error "dd with oss_write_stages=$stages failed"
+		cancel_lru_locks osc
+		[ "$(md5sum < $DIR/$tfile)" == "$sum" ] ||
+			error "data differs with oss_write_stages=$stages"
+	done
+	do_facet ost1 "echo $orig_stages > $param"
+	$LCTL set_param $osc_mppc=$orig_mppc > /dev/null
+	rm -f $DIR/$tfile $TMP/$tfile
+}
+run_test 246 "writes committed MD by MD while the bulk arrives"
+
+test_247() {
+	which fallocate > /dev/null 2>&1 || { skip "no fallocate" && return; }
+	[ "$(facet_fstype ost1)" = "zfs" ] &&
+		skip "zfs OSTs cannot preallocate" && return
+	$LCTL get_param -n osc.*.import | grep -q fallocate ||
+		{ skip "OSTs without OST_FALLOCATE" && return; }
+	local size
+	local blocks
+
+	$SETSTRIPE -c 2 -S 1M $DIR/$tfile || error "setstripe $DIR/$tfile failed"
+	fallocate -l 8M $DIR/$tfile || error "fallocate $DIR/$tfile failed"
+	size=$(stat -c %s $DIR/$tfile)
+	[ $size -eq 8388608 ] || error "size $size after fallocate, not 8M"
+	cancel_lru_locks osc
+	blocks=$(stat -c %b $DIR/$tfile)
+	[ $blocks -ge 16384 ] || error "only $blocks blocks allocated for 8M"
+	cmp -n 8388608 /dev/zero $DIR/$tfile ||
+		error "preallocated blocks do not read back as zeroes"
+
+	fallocate -n -o 8M -l 4M $DIR/$tfile ||
+		error "fallocate --keep-size $DIR/$tfile failed"
+	size=$(stat -c %s $DIR/$tfile)
+	[ $size -eq 8388608 ] || error "size $size after --keep-size, not 8M"
+
+	$SETSTRIPE -c 1 --prealloc 4M $DIR/$tfile-2 ||
+		error "setstripe --prealloc $DIR/$tfile-2 failed"
+	size=$(stat -c %s $DIR/$tfile-2)
+	[ $size -eq 4194304 ] || error "size $size after --prealloc, not 4M"
+	rm -f $DIR/$tfile $DIR/$tfile-2
+}
+run_test 247 "fallocate and setstripe --prealloc allocate OST blocks"
+
+oi_cache_stat() {
+	do_facet $SINGLEMDS $LCTL get_param -n osd-ldiskfs.$FSNAME-MDT0000.oi_cache |
+		awk '/^'$1':/ { print $2 }'
+}
+
+test_248() {
+	[ "$(facet_fstype $SINGLEMDS)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+	local param=osd-ldiskfs.$FSNAME-MDT0000.oi_cache_mb
+	local orig_mb
+	local inserts
+	local hits
+
+	orig_mb=$(do_facet $SINGLEMDS $LCTL get_param -n $param 2> /dev/null) ||
+		{ skip "MDT without OI cache" && return; }
+	[ $orig_mb -eq 0 ] && skip "OI cache disabled" && return
+
+	inserts=$(oi_cache_stat inserts)
+	mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f 100 || error "create files failed"
+	[ $(oi_cache_stat inserts) -ge $((inserts + 100)) ] ||
+		error "new files not cached"
+
+	# drop the objects from the lu cache, to look their FIDs up again
+	cancel_lru_locks mdc
+	do_facet $SINGLEMDS "echo 3 > /proc/sys/vm/drop_caches"
+	hits=$(oi_cache_stat hits)
+	ls -l $DIR/$tdir > /dev/null || error "ls $DIR/$tdir failed"
+	[ $(oi_cache_stat hits) -gt $hits ] || error "no OI cache hit"
+
+	do_facet $SINGLEMDS $LCTL set_param $param=0
+	[ $(oi_cache_stat entries) -eq 0 ] ||
+		error "entries left in the OI cache without a budget"
+	do_facet $SINGLEMDS $LCTL set_param $param=$orig_mb
+	unlinkmany $DIR/$tdir/f 100 || error "unlink files failed"
+	rm -rf $DIR/$tdir
+}
+run_test 248 "FID to inode cache in front of the OI"
+
+test_249() {
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+	local param=osd-ldiskfs.$FSNAME-OST0000.brw_stats
+	local i
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe $DIR/$tfile failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=4 2> /dev/null ||
+		error "dd to $TMP/$tfile failed"
+	do_facet ost1 $LCTL set_param $param=0
+
+	# written backwards, the blocks of the file are out of order on disk
+	for i in 3 2 1 0; do
+		dd if=$TMP/$tfile of=$DIR/$tfile bs=1M count=1 skip=$i seek=$i \
+			conv=notrunc oflag=direct 2> /dev/null ||
+			error "dd to $DIR/$tfile at ${i}M failed"
+	done
+	do_facet ost1 $LCTL get_param -n $param |
+		grep -q "disk I/Os per bulk r/w" ||
+		error "no disk I/Os per bulk r/w in $param"
+
+	cancel_lru_locks osc
+	cmp $TMP/$tfile $DIR/$tfile || error "$DIR/$tfile reads back corrupted"
+	rm -f $TMP/$tfile $DIR/$tfile
+}
+run_test 249 "bios of fragmented writes, brw_stats per bulk r/w"
+
+test_250() {
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+	local filefrag_op=$(filefrag -e 2>&1 | grep "invalid option")
+	[ -n "$filefrag_op" ] && skip_env "filefrag does not support FIEMAP" &&
+		return
+	local param=osd-ldiskfs.$FSNAME-OST0000.stream_regions
+	local regions
+	local extents
+	local pids=""
+	local i
+
+	regions=$(do_facet ost1 $LCTL get_param -n $param)
+	mkdir -p $DIR/$tdir
+	$SETSTRIPE -c 1 -i 0 $DIR/$tdir || error "setstripe $DIR/$tdir failed"
+	for ((i = 0; i < 8; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=1M count=32 \
+			oflag=direct 2> /dev/null &
+		pids="$pids $!"
+	done
+	for i in $pids; do
+		wait $i || error "dd to $DIR/$tdir failed"
+	done
+
+	[ $(do_facet ost1 $LCTL get_param -n $param) -gt $regions ] ||
+		error "no region reserved for the write streams"
+	for ((i = 0; i < 8; i++)); do
+		extents=$(filefrag $DIR/$tdir/f$i | awk '{ print $2 }')
+		echo "$DIR/$tdir/f$i: $extents extents"
+		[ $extents -le 16 ] ||
+			error "$DIR/$tdir/f$i written in $extents extents"
+	done
+	rm -rf $DIR/$tdir
+}
+run_test 250 "concurrent write streams get contiguous blocks on the OST"
+
+test_251() {
+	[ "$(facet_fstype $SINGLEMDS)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+	local param=osd-ldiskfs.$FSNAME-MDT0000.dir_stats
+	local names
+
+	do_facet $SINGLEMDS $LCTL set_param $param=clear
+	mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f 10000 || error "createmany failed"
+	do_facet $SINGLEMDS $LCTL get_param $param
+
+	names=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+		awk '/^htree levels/ { hist = 1; next }
+		     /^$/ { hist = 0 }
+		     hist && /^[1-9]:/ { n += $2 }
+		     END { print n + 0 }')
+	[ $names -ge 9000 ] ||
+		error "$names names accounted in indexed directories"
+	unlinkmany $DIR/$tdir/f 10000 || error "unlinkmany failed"
+	rm -rf $DIR/$tdir
+}
+run_test 251 "dir_stats account the inserts into htree directories"
+
+mdc_peer_committed() {
+	$LCTL get_param -n mdc.$FSNAME-MDT0000-mdc-*.import |
+		awk '/peer_committed:/ { print $2 }'
+}
+
+test_252() {
+	local nr=1000
+	local before
+	local after
+	local pids=""
+	local i
+
+	mkdir -p $DIR/$tdir
+	before=$(mdc_peer_committed)
+	for ((i = 0; i < 8; i++)); do
+		mkdir $DIR/$tdir/d$i || error "mkdir $DIR/$tdir/d$i failed"
+		createmany -o $DIR/$tdir/d$i/f $nr &
+		pids="$pids $!"
+	done
+	for i in $pids; do
+		wait $i || error "createmany in $DIR/$tdir failed"
+	done
+
+	# the next reply carries the last committed transno
+	do_facet $SINGLEMDS sync
+	cancel_lru_locks mdc
+	stat $DIR/$tdir > /dev/null || error "stat $DIR/$tdir failed"
+	after=$(mdc_peer_committed)
+	echo "peer_committed $before -> $after"
+	[ $((after - before)) -ge $((8 * (nr + 1))) ] ||
+		error "only $((after - before)) transactions reported committed"
+}
+run_test 252 "last_committed advances with concurrent creates"
+
+test_253() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	[ "$(facet_fstype $SINGLEMDS)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+	local MDT_DEV=$(mdsdevname ${SINGLEMDS//mds/})
+	local param=osd-ldiskfs.$FSNAME-MDT0000
+	local before
+	local after
+
+	mkdir -p $DIR/$tdir/small || error "mkdir $DIR/$tdir/small failed"
+	createmany -o $DIR/$tdir/small/f 20 || error "createmany failed"
+
+	# the directory is looked up again from disk after the restart
+	stop $SINGLEMDS || error "Fail to stop MDT."
+	start $SINGLEMDS $MDT_DEV $MDS_MOUNT_OPTS || error "Fail to start MDT."
+	df $MOUNT > /dev/null || error "Fail to df."
+	cancel_lru_locks mdc
+
+	do_facet $SINGLEMDS $LCTL set_param $param.small_dir_blocks=4
+	before=$(do_facet $SINGLEMDS $LCTL get_param -n $param.stats |
+		 awk '/^small_dir_readahead/ { print $2 }')
+	ls $DIR/$tdir/small > /dev/null || error "ls $DIR/$tdir/small failed"
+	after=$(do_facet $SINGLEMDS $LCTL get_param -n $param.stats |
+		awk '/^small_dir_readahead/ { print $2 }')
+	echo "small_dir_readahead ${before:-0} -> ${after:-0}"
+	[ ${after:-0} -gt ${before:-0} ] ||
+		error "no block read ahead on lookup of $DIR/$tdir/small"
+	rm -rf $DIR/$tdir
+}
+run_test 253 "the blocks of a small directory are read ahead on lookup"
+
 #
 # tests that do cleanup/setup should be run at the end
 #
@@ -0,0 +1,319 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/tests/wrand_test.c
+ *
+ * Unit test and microbenchmark of the alias table the LOD QoS allocator
+ * picks OSTs from, on synthetic sets of OSTs: checks that each OST is
+ * picked in proportion to its weight, and compares the cost of striping
+ * a file with the linear scan of every OST the allocator used to do.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <libcfs/libcfs.h>
+#include <../lod/wrand_table.c>
+
+#define error(fmt, args...) do {                        \
+	fflush(stdout), fflush(stderr);                 \
+	fprintf(stderr, "\nError:" fmt, ##args);        \
+	exit(1);                                        \
+} while (0)
+
+/* largest deviation from its weight allowed for the share of an OST */
+#define WRAND_TEST_TOLERANCE	0.1
+
+static __u64	*ost_weight;
+static __u64	*ost_penalty;
+static __u64	*ost_penalty_per_obj;
+static __u64	*build_weight;
+static __u32	*build_work;
+static struct wrand_table table;
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static __u32 rand32(void)
+{
+	return (__u32)random() << 1 ^ (__u32)random();
+}
+
+/* free space of a synthetic OST: one in four nearly full, others 1-16TB */
+static void wrand_test_osts(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		ost_weight[i] = (1 + random() % 16) << 40;
+		if (random() % 4 == 0)
+			ost_weight[i] >>= 6;
+		ost_penalty[i] = 0;
+		ost_penalty_per_obj[i] = ost_weight[i] / 2 / (count - 1);
+	}
+}
+
+static void wrand_test_build(int count)
+{
+	memcpy(build_weight, ost_weight, count * sizeof(ost_weight[0]));
+	if (wrand_build(&table, build_weight, build_work, count) != 0)
+		error("cannot build the table of %d osts\n", count);
+}
+
+/* pick @stripes distinct OSTs from the alias table */
+static int wrand_test_alloc(int *stripe, int stripes)
+{
+	int nfound = 0;
+	int idx;
+	int j;
+
+	while (nfound < stripes) {
+		idx = wrand_pick(&table, rand32(), rand32());
+		for (j = 0; j < nfound; j++)
+			if (stripe[j] == idx)
+				break;
+		if (j == nfound)
+			stripe[nfound++] = idx;
+	}
+	return nfound;
+}
+
+static __u64 linear_test_weight(int i)
+{
+	if (ost_weight[i] < ost_penalty[i])
+		return 0;
+	return ost_weight[i] - ost_penalty[i];
+}
+
+/* what lod_alloc_qos() did: scan the weights of every OST for each stripe,
+ * then walk them all again to decay their penalties */
+static int linear_test_alloc(int *stripe, int stripes, int count)
+{
+	__u64 total = 0;
+	__u64 cur;
+	__u64 rand;
+	int   nfound = 0;
+	int   i, j;
+
+	for (i = 0; i < count; i++)
+		total += linear_test_weight(i);
+
+	while (nfound < stripes && total > 0) {
+		rand = ((__u64)rand32() << 32 | rand32()) % total;
+		cur = 0;
+		for (i = 0; i < count; i++) {
+			cur += linear_test_weight(i);
+			if (cur < rand)
+				continue;
+			for (j = 0; j < nfound; j++)
+				if (stripe[j] == i)
+					break;
+			if (j == nfound)
+				break;
+		}
+		if (i == count)
+			break;
+		stripe[nfound++] = i;
+
+		ost_penalty[i] += ost_penalty_per_obj[i] * count;
+		total = 0;
+		for (j = 0; j < count; j++) {
+			if (ost_penalty[j] < ost_penalty_per_obj[j])
+				ost_penalty[j] = 0;
+			else
+				ost_penalty[j] -= ost_penalty_per_obj[j];
+			total += linear_test_weight(j);
+		}
+	}
+	return nfound;
+}
+
+/* check that the OSTs are picked in proportion to their weights */
+static void wrand_test_check(int count, int draws)
+{
+	__u64	 total = 0;
+	double	 expect, dev, max_dev = 0;
+	int	*hits;
+	int	 i;
+
+	hits = calloc(count, sizeof(*hits));
+	if (hits == NULL)
+		error("cannot allocate %d counters\n", count);
+
+	for (i = 0; i < count; i++)
+		total += ost_weight[i];
+	for (i = 0; i < draws; i++)
+		hits[wrand_pick(&table, rand32(), rand32())]++;
+
+	for (i = 0; i < count; i++) {
+		expect = (double)draws * ost_weight[i] / total;
+		if (expect < 10000)
+			continue;
+		dev = (hits[i] - expect) / expect;
+		if (dev < 0)
+			dev = -dev;
+		if (dev > max_dev)
+			max_dev = dev;
+	}
+	free(hits);
+
+	printf("%6d osts: max deviation of the shares %.2f%%\n",
+	       count, max_dev * 100);
+	if (max_dev > WRAND_TEST_TOLERANCE)
+		error("share of an ost off by %.2f%% of its weight\n",
+		      max_dev * 100);
+}
+
+static void wrand_test_bench(int count, int stripes, int iters)
+{
+	double	 start, build, wrand, linear;
+	int	*stripe;
+	int	 i;
+
+	stripe = calloc(stripes, sizeof(*stripe));
+	if (stripe == NULL)
+		error("cannot allocate %d stripes\n", stripes);
+
+	start = now();
+	for (i = 0; i < 100; i++)
+		wrand_test_build(count);
+	build = (now() - start) / 100;
+
+	start = now();
+	for (i = 0; i < iters; i++)
+		wrand_test_alloc(stripe, stripes);
+	wrand = (now() - start) / iters;
+
+	start = now();
+	for (i = 0; i < iters; i++)
+		linear_test_alloc(stripe, stripes, count);
+	linear = (now() - start) / iters;
+
+	printf("%6d osts %4d stripes: build %8.1fus, alloc %8.3fus, "
+	       "linear alloc %8.3fus (x%.0f)\n", count, stripes,
+	       build * 1e6, wrand * 1e6, linear * 1e6, linear / wrand);
+	free(stripe);
+}
+
+static void wrand_test_run(int osts, int stripes, int iters)
+{
+	int stripe_counts[] = { 1, 4, 8 };
+	int i;
+
+	wrand_test_osts(osts);
+	wrand_test_build(osts);
+	wrand_test_check(osts, 10000 * osts);
+
+	if (stripes != 0) {
+		wrand_test_bench(osts, stripes, iters);
+		return;
+	}
+	for (i = 0; i < ARRAY_SIZE(stripe_counts); i++)
+		wrand_test_bench(osts, stripe_counts[i], iters);
+}
+
+static void usage(char *prog)
+{
+	fprintf(stderr, "usage: %s [-n ost_count] [-s stripe_count] "
+		"[-i iterations] [-r seed]\n", prog);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	int	ost_counts[] = { 16, 160, 2000, 8000 };
+	int	max_osts = 8000;
+	int	osts = 0;
+	int	stripes = 0;
+	int	iters = 2000;
+	int	c, i;
+
+	srandom(time(NULL));
+	while ((c = getopt(argc, argv, "n:s:i:r:")) != -1) {
+		switch (c) {
+		case 'n':
+			osts = atoi(optarg);
+			if (osts < 2)
+				usage(argv[0]);
+			max_osts = osts;
+			break;
+		case 's':
+			stripes = atoi(optarg);
+			if (stripes < 1)
+				usage(argv[0]);
+			break;
+		case 'i':
+			iters = atoi(optarg);
+			if (iters < 1)
+				usage(argv[0]);
+			break;
+		case 'r':
+			srandom(atoi(optarg));
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	/* lod_alloc_qos() leaves wider stripes to round-robin */
+	if (stripes * 2 > (osts ?: ost_counts[0]))
+		error("%d stripes over %d osts would be allocated "
+		      "round-robin\n", stripes, osts ?: ost_counts[0]);
+
+	ost_weight = calloc(max_osts, sizeof(*ost_weight));
+	ost_penalty = calloc(max_osts, sizeof(*ost_penalty));
+	ost_penalty_per_obj = calloc(max_osts, sizeof(*ost_penalty_per_obj));
+	build_weight = calloc(max_osts, sizeof(*build_weight));
+	build_work = calloc(max_osts, sizeof(*build_work));
+	table.wt_thresh = calloc(max_osts, sizeof(*table.wt_thresh));
+	table.wt_alias = calloc(max_osts, sizeof(*table.wt_alias));
+	if (ost_weight == NULL || ost_penalty == NULL ||
+	    ost_penalty_per_obj == NULL || build_weight == NULL ||
+	    build_work == NULL || table.wt_thresh == NULL ||
+	    table.wt_alias == NULL)
+		error("cannot allocate tables of %d osts\n", max_osts);
+
+	if (osts != 0) {
+		wrand_test_run(osts, stripes, iters);
+		return 0;
+	}
+	for (i = 0; i < ARRAY_SIZE(ost_counts); i++)
+		wrand_test_run(ost_counts[i], stripes, iters);
+	return 0;
+}
@@ -109,6 +109,9 @@ static int lfs_changelog_clear(int argc, char **argv);
 static int lfs_fid2path(int argc, char **argv);
 static int lfs_path2fid(int argc, char **argv);
 static int lfs_data_version(int argc, char **argv);
+static int lfs_lazystat(int argc, char **argv);
+static int lfs_som_sync(int argc, char **argv);
+static int lfs_rm(int argc, char **argv);
 static int lfs_hsm_state(int argc, char **argv);
 static int lfs_hsm_set(int argc, char **argv);
 static int lfs_hsm_clear(int argc, char **argv);
@@ -125,6 +128,8 @@ static int lfs_swap_layouts(int argc, char **argv);
 	"                 [--stripe-index|-i <start_ost_idx>]\n"\
 	"                 [--stripe-size|-S <stripe_size>]\n"\
 	"                 [--pool|-p <pool_name>]\n"\
+	"                 [--layout|-L <raid0|mdt>]\n"\
+	"                 [--prealloc|-a <size>]\n"\
 	"                 [--block|-b] "_tgt"\n"\
 	"\tstripe_size:  Number of bytes on each OST (0 filesystem default)\n"\
 	"\t              Can be specified with k, m or g (in KB, MB and GB\n"\
@@ -132,6 +137,11 @@ static int lfs_swap_layouts(int argc, char **argv);
 	"\tstart_ost_idx: OST index of first stripe (-1 default)\n"\
 	"\tstripe_count: Number of OSTs to stripe over (0 default, -1 all)\n"\
 	"\tpool_name:    Name of OST pool to use (default none)\n"\
+	"\tlayout:       raid0 (default) to stripe over OSTs, or mdt to\n"\
+	"\t              store the data on the MDT, stripe_size is then\n"\
+	"\t              the maximum file size (Data-on-MDT)\n"\
+	"\tsize:         Bytes to allocate on the OSTs when creating a\n"\
+	"\t              file, which is sized to them (k, m, g, t units)\n"\
 	"\tblock:	 Block file access during data migration"
 
 /* all avaialable commands */
@@ -152,9 +162,13 @@ command_t cmdlist[] = {
 	 "                 [--mdt-index|-M] [--recursive|-r] [--raw|-R]\n"
 	 "                 <directory|filename> ..."},
 	{"setdirstripe", lfs_setdirstripe, 0,
-	 "To create a remote directory on a specified MDT.\n"
+	 "To create a remote directory on a specified MDT, or a directory\n"
+	 "striped over several MDTs.\n"
 	 "usage: setdirstripe <--index|-i mdt_index> <dir>\n"
-	 "\tmdt_index:    MDT index of first stripe\n"},
+	 "   or: setdirstripe <--count|-c stripe_count> [--index|-i mdt_index]"
+	 " <dir>\n"
+	 "\tmdt_index:    MDT index of first stripe\n"
+	 "\tstripe_count: number of MDTs to stripe the directory over\n"},
 	{"getdirstripe", lfs_getdirstripe, 0,
 	 "To list the striping info for a given directory\n"
 	 "or recursively for all directories in a directory tree.\n"
@@ -165,7 +179,9 @@ command_t cmdlist[] = {
 	 "To create a remote directory on a specified MDT. And this can only\n"
 	 "be done on MDT0 by administrator.\n"
 	 "usage: mkdir <--index|-i mdt_index> <dir>\n"
-	 "\tmdt_index:    MDT index of the remote directory.\n"},
+	 "   or: mkdir <--count|-c stripe_count> [--index|-i mdt_index] <dir>\n"
+	 "\tmdt_index:    MDT index of the remote directory.\n"
+	 "\tstripe_count: number of MDTs to stripe the directory over\n"},
 	{"rm_entry", lfs_rmentry, 0,
 	 "To remove the name entry of the remote directory. Note: This\n"
 	 "command will only delete the name entry, i.e. the remote directory\n"
@@ -279,6 +295,14 @@ command_t cmdlist[] = {
          "usage: path2fid <path>"},
         {"data_version", lfs_data_version, 0, "Display file data version for "
          "a given path.\n" "usage: data_version [-n] <path>"},
+	{"lazystat", lfs_lazystat, 0, "Display the size and blocks of given "
+	 "files, from the lazy size-on-MDT and its age in seconds if -l is "
+	 "given and the MDT has one.\n" "usage: lazystat [-l] <file> ..."},
+	{"som_sync", lfs_som_sync, 0, "Update the lazy size-on-MDT of given "
+	 "files from their OST objects.\n" "usage: som_sync <file> ..."},
+	{"rm", lfs_rm, 0, "Remove files, and directory trees with -r, "
+	 "unlinking the entries of each directory in batches.\n"
+	 "usage: rm [-r] <path> ..."},
 	{"hsm_state", lfs_hsm_state, 0, "Display the HSM information (states, "
 	 "undergoing actions) for given files.\n usage: hsm_state <file> ..."},
 	{"hsm_set", lfs_hsm_set, 0, "Set HSM user flag on specified files.\n"
@@ -548,6 +572,22 @@ free:
 }
 
 /* functions */
+/* allocate the blocks of the first \a size bytes of the file just created,
+ * setting its size */
+static int lfs_prealloc(const char *fname, unsigned long long size)
+{
+	int fd;
+	int rc = 0;
+
+	fd = open(fname, O_WRONLY);
+	if (fd < 0)
+		return -errno;
+	if (fallocate(fd, 0, 0, size) < 0)
+		rc = -errno;
+	close(fd);
+	return rc;
+}
+
 static int lfs_setstripe(int argc, char **argv)
 {
 	char			*fname;
@@ -561,11 +601,16 @@ static int lfs_setstripe(int argc, char **argv)
 	char			*stripe_off_arg = NULL;
 	char			*stripe_count_arg = NULL;
 	char			*pool_name_arg = NULL;
+	char			*layout_arg = NULL;
+	char			*prealloc_arg = NULL;
+	unsigned long long	 prealloc_size = 0;
+	int			 st_pattern = 0;
 	unsigned long long	 size_units = 1;
 	int			 migrate_mode = 0;
 	__u64			 migration_flags = 0;
 
 	struct option		 long_opts[] = {
+		{"prealloc",	 required_argument, 0, 'a'},
 		/* valid only in migrate mode */
 		{"block",	 no_argument,	    0, 'b'},
 #if LUSTRE_VERSION >= OBD_OCD_VERSION(2,9,50,0)
@@ -589,6 +634,7 @@ static int lfs_setstripe(int argc, char **argv)
 #endif
 		{"stripe-index", required_argument, 0, 'i'},
 		{"stripe_index", required_argument, 0, 'i'},
+		{"layout",	 required_argument, 0, 'L'},
 #if LUSTRE_VERSION >= OBD_OCD_VERSION(2,9,50,0)
 #warning "remove deprecated --offset option"
 #else
@@ -630,12 +676,15 @@ static int lfs_setstripe(int argc, char **argv)
 #endif
         {
                 optind = 0;
-                while ((c = getopt_long(argc, argv, "c:di:o:p:s:S:",
+                while ((c = getopt_long(argc, argv, "a:c:di:L:o:p:s:S:",
                                         long_opts, NULL)) >= 0) {
                 switch (c) {
                 case 0:
                         /* Long options. */
                         break;
+		case 'a':
+			prealloc_arg = optarg;
+			break;
 		case 'b':
 			if (migrate_mode == 0) {
 				fprintf(stderr, "--block is valid only for"
@@ -691,6 +740,9 @@ static int lfs_setstripe(int argc, char **argv)
                 case 'p':
                         pool_name_arg = optarg;
                         break;
+		case 'L':
+			layout_arg = optarg;
+			break;
                 default:
                         return CMD_HELP;
                 }
@@ -700,9 +752,10 @@ static int lfs_setstripe(int argc, char **argv)
 
                 if (delete &&
                     (stripe_size_arg != NULL || stripe_off_arg != NULL ||
-                     stripe_count_arg != NULL || pool_name_arg != NULL)) {
+                     stripe_count_arg != NULL || pool_name_arg != NULL ||
+		     layout_arg != NULL || prealloc_arg != NULL)) {
                         fprintf(stderr, "error: %s: cannot specify -d with "
-                                        "-s, -c, -o, or -p options\n",
+                                        "-s, -c, -o, -p, -L or -a options\n",
                                         argv[0]);
                         return CMD_HELP;
                 }
@@ -741,6 +794,42 @@ static int lfs_setstripe(int argc, char **argv)
                         return CMD_HELP;
                 }
         }
+	/* get the layout pattern */
+	if (layout_arg != NULL) {
+		if (strcmp(layout_arg, "raid0") == 0) {
+			st_pattern = LOV_PATTERN_RAID0;
+		} else if (strcmp(layout_arg, "mdt") == 0) {
+			st_pattern = LOV_PATTERN_MDT;
+		} else {
+			fprintf(stderr, "error: %s: bad layout '%s'\n",
+				argv[0], layout_arg);
+			return CMD_HELP;
+		}
+	}
+	/* get the size to preallocate */
+	if (prealloc_arg != NULL) {
+		unsigned long long prealloc_units = 1;
+
+		if (migrate_mode) {
+			fprintf(stderr, "error: %s: cannot specify -a in "
+				"migrate mode\n", argv[0]);
+			return CMD_HELP;
+		}
+		result = parse_size(prealloc_arg, &prealloc_size,
+				    &prealloc_units, 0);
+		if (result || prealloc_size == 0) {
+			fprintf(stderr, "error: %s: bad prealloc size '%s'\n",
+				argv[0], prealloc_arg);
+			return CMD_HELP;
+		}
+	}
+	if (st_pattern == LOV_PATTERN_MDT &&
+	    (migrate_mode || stripe_off_arg != NULL ||
+	     stripe_count_arg != NULL || pool_name_arg != NULL)) {
+		fprintf(stderr, "error: %s: cannot specify -c, -i or -p "
+			"with the mdt layout\n", argv[0]);
+		return CMD_HELP;
+	}
 
 	do {
 		if (migrate_mode)
@@ -750,7 +839,8 @@ static int lfs_setstripe(int argc, char **argv)
 		else
 			result = llapi_file_create_pool(fname, st_size,
 							st_offset, st_count,
-							0, pool_name_arg);
+							st_pattern,
+							pool_name_arg);
 		if (result) {
 			fprintf(stderr,
 				"error: %s: %s stripe file '%s' failed\n",
@@ -758,6 +848,16 @@ static int lfs_setstripe(int argc, char **argv)
 				fname);
 			break;
 		}
+		if (prealloc_size != 0) {
+			result = lfs_prealloc(fname, prealloc_size);
+			if (result) {
+				fprintf(stderr, "error: %s: preallocate %llu "
+					"bytes of '%s' failed: %s\n", argv[0],
+					prealloc_size, fname,
+					strerror(-result));
+				break;
+			}
+		}
 		fname = argv[++optind];
 	} while (fname != NULL);
 
@@ -1433,9 +1533,11 @@ static int lfs_setdirstripe(int argc, char **argv)
 	char *end;
 	int c;
 	char *stripe_off_arg = NULL;
+	char *stripe_count_arg = NULL;
 	int  flags = 0;
 
 	struct option long_opts[] = {
+		{"count",    required_argument, 0, 'c'},
 		{"index",    required_argument, 0, 'i'},
 		{0, 0, 0, 0}
 	};
@@ -1443,12 +1545,15 @@ static int lfs_setdirstripe(int argc, char **argv)
 	st_offset = -1;
 	st_count = 1;
 	optind = 0;
-	while ((c = getopt_long(argc, argv, "i:o",
+	while ((c = getopt_long(argc, argv, "c:i:o",
 				long_opts, NULL)) >= 0) {
 		switch (c) {
 		case 0:
 			/* Long options. */
 			break;
+		case 'c':
+			stripe_count_arg = optarg;
+			break;
 		case 'i':
 			stripe_off_arg = optarg;
 			break;
@@ -1467,17 +1572,28 @@ static int lfs_setdirstripe(int argc, char **argv)
 	}
 
 	dname = argv[optind];
-	if (stripe_off_arg == NULL) {
+	if (stripe_off_arg == NULL && stripe_count_arg == NULL) {
 		fprintf(stderr, "error: %s: missing stripe_off.\n",
 			argv[0]);
 		return CMD_HELP;
 	}
-	/* get the stripe offset */
-	st_offset = strtoul(stripe_off_arg, &end, 0);
-	if (*end != '\0') {
-		fprintf(stderr, "error: %s: bad stripe offset '%s'\n",
-			argv[0], stripe_off_arg);
-		return CMD_HELP;
+	/* get the stripe offset, the MDT of the parent by default */
+	if (stripe_off_arg != NULL) {
+		st_offset = strtoul(stripe_off_arg, &end, 0);
+		if (*end != '\0') {
+			fprintf(stderr, "error: %s: bad stripe offset '%s'\n",
+				argv[0], stripe_off_arg);
+			return CMD_HELP;
+		}
+	}
+	/* get the stripe count */
+	if (stripe_count_arg != NULL) {
+		st_count = strtoul(stripe_count_arg, &end, 0);
+		if (*end != '\0' || st_count < 1) {
+			fprintf(stderr, "error: %s: bad stripe count '%s'\n",
+				argv[0], stripe_count_arg);
+			return CMD_HELP;
+		}
 	}
 	do {
 		result = llapi_dir_create_pool(dname, flags, st_offset,
@@ -3132,6 +3248,135 @@ static int lfs_data_version(int argc, char **argv)
 	return rc;
 }
 
+static int lfs_lazystat(int argc, char **argv)
+{
+	struct ioc_lazystat	 ils;
+	__u64			 flags = 0;
+	char			*path;
+	int			 fd;
+	int			 rc = 0;
+	int			 rc2;
+	int			 c;
+
+	optind = 0;
+	while ((c = getopt(argc, argv, "l")) != -1) {
+		switch (c) {
+		case 'l':
+			flags |= LL_LAZY_OK;
+			break;
+		default:
+			return CMD_HELP;
+		}
+	}
+	if (optind == argc)
+		return CMD_HELP;
+
+	for (; optind < argc; optind++) {
+		path = argv[optind];
+		fd = open(path, O_RDONLY | O_NONBLOCK);
+		if (fd < 0) {
+			rc2 = -errno;
+			fprintf(stderr, "can't open %s: %s\n", path,
+				strerror(-rc2));
+			rc = rc2;
+			continue;
+		}
+
+		memset(&ils, 0, sizeof(ils));
+		ils.ils_flags = flags;
+		rc2 = llapi_get_lazystat(fd, &ils);
+		close(fd);
+		if (rc2 < 0) {
+			fprintf(stderr, "can't get size of %s: %s\n", path,
+				strerror(-rc2));
+			rc = rc2;
+			continue;
+		}
+
+		if (ils.ils_flags & LL_LAZY_OK)
+			printf("%s: size="LPU64" blocks="LPU64" age="LPU64"\n",
+			       path, ils.ils_size, ils.ils_blocks, ils.ils_age);
+		else
+			printf("%s: size="LPU64" blocks="LPU64"\n", path,
+			       ils.ils_size, ils.ils_blocks);
+	}
+
+	return rc;
+}
+
+static int lfs_som_sync(int argc, char **argv)
+{
+	char	*path;
+	int	 fd;
+	int	 rc = 0;
+	int	 rc2;
+	int	 i;
+
+	if (argc < 2)
+		return CMD_HELP;
+
+	for (i = 1; i < argc; i++) {
+		path = argv[i];
+		fd = open(path, O_RDONLY | O_NONBLOCK);
+		if (fd < 0) {
+			rc2 = -errno;
+			fprintf(stderr, "can't open %s: %s\n", path,
+				strerror(-rc2));
+			rc = rc2;
+			continue;
+		}
+
+		rc2 = llapi_som_sync(fd);
+		close(fd);
+		if (rc2 < 0) {
+			fprintf(stderr, "can't sync size of %s: %s\n", path,
+				strerror(-rc2));
+			rc = rc2;
+		}
+	}
+
+	return rc;
+}
+
+static int lfs_rm(int argc, char **argv)
+{
+	struct stat	st;
+	int		recursive = 0;
+	int		rc = 0;
+	int		rc2;
+	int		c;
+	int		i;
+
+	optind = 0;
+	while ((c = getopt(argc, argv, "r")) != -1) {
+		switch (c) {
+		case 'r':
+			recursive = 1;
+			break;
+		default:
+			return CMD_HELP;
+		}
+	}
+
+	if (optind == argc)
+		return CMD_HELP;
+
+	for (i = optind; i < argc; i++) {
+		if (!recursive && lstat(argv[i], &st) == 0 &&
+		    S_ISDIR(st.st_mode))
+			rc2 = -EISDIR;
+		else
+			rc2 = llapi_remove_tree(argv[i]);
+		if (rc2 < 0) {
+			fprintf(stderr, "can't remove %s: %s\n", argv[i],
+				strerror(-rc2));
+			rc = rc2;
+		}
+	}
+
+	return rc;
+}
+
 static int lfs_hsm_state(int argc, char **argv)
 {
 	int rc;
@@ -267,6 +267,12 @@ int llapi_stripe_limit_check(unsigned long long stripe_size, int stripe_offset,
 				"is not currently supported and would wrap");
 		return rc;
 	}
+	if (stripe_pattern == LOV_PATTERN_MDT && stripe_count != 0) {
+		rc = -EINVAL;
+		llapi_error(LLAPI_MSG_ERROR, rc, "error: a Data-on-MDT file "
+			    "can't have OST stripes (count %d)", stripe_count);
+		return rc;
+	}
 	return 0;
 }
 
@@ -4185,6 +4191,250 @@ int llapi_get_data_version(int fd, __u64 *data_version, __u64 flags)
         return rc;
 }
 
+/*
+ * Get the size and blocks of an open file, from the lazy size-on-MDT if
+ * LL_LAZY_OK is set in ils->ils_flags and the MDT has one (ils_age is then
+ * the age of the values in seconds), otherwise from the OSTs.
+ */
+int llapi_get_lazystat(int fd, struct ioc_lazystat *ils)
+{
+	int rc;
+
+	rc = ioctl(fd, LL_IOC_LAZYSTAT, ils);
+	if (rc)
+		rc = -errno;
+
+	return rc;
+}
+
+/*
+ * Store the current size and blocks of an open file as its lazy
+ * size-on-MDT, e.g. after writers were evicted. Needs CAP_SYS_ADMIN.
+ */
+int llapi_som_sync(int fd)
+{
+	int rc;
+
+	rc = ioctl(fd, LL_IOC_SOM_SYNC, 0);
+	if (rc)
+		rc = -errno;
+
+	return rc;
+}
+
+static int unlink_one(int dirfd, const char *name)
+{
+	int rc;
+
+	rc = unlinkat(dirfd, name, 0);
+	if (rc < 0 && errno == EISDIR)
+		rc = unlinkat(dirfd, name, AT_REMOVEDIR);
+
+	return rc < 0 ? -errno : 0;
+}
+
+/*
+ * Unlink \a count names from the directory open as \a dirfd, sending them
+ * to the MDT in batches if it supports it and falling back to unlinkat()
+ * otherwise, and for names it cannot remove itself, e.g. on another MDT.
+ * Files and empty directories are unlinked alike.
+ *
+ * \retval	0 and the result of each name in \a rcs, as -errno.
+ * \retval	-errno if the names could not be sent at all.
+ */
+int llapi_unlink_batch(int dirfd, char **names, int count, int *rcs)
+{
+	struct ll_unlink_batch	*lub;
+	size_t			 namelen = 0;
+	char			*ptr;
+	int			 rc;
+	int			 i;
+
+	if (count <= 0)
+		return count < 0 ? -EINVAL : 0;
+
+	for (i = 0; i < count; i++)
+		namelen += strlen(names[i]) + 1;
+	if (namelen > LL_UNLINK_BATCH_MAX_SIZE)
+		return -E2BIG;
+
+	lub = malloc(ll_unlink_batch_size(count, namelen));
+	if (lub == NULL)
+		return -ENOMEM;
+
+	lub->lub_count = count;
+	lub->lub_namelen = namelen;
+	ptr = ll_unlink_batch_names(lub);
+	for (i = 0; i < count; i++)
+		ptr = stpcpy(ptr, names[i]) + 1;
+
+	rc = ioctl(dirfd, LL_IOC_UNLINK_BATCH, lub);
+	if (rc < 0 && errno != ENOTTY && errno != EOPNOTSUPP) {
+		rc = -errno;
+		goto out;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (rc < 0 || lub->lub_rcs[i] == -EREMOTE)
+			rcs[i] = unlink_one(dirfd, names[i]);
+		else
+			rcs[i] = lub->lub_rcs[i];
+	}
+	rc = 0;
+out:
+	free(lub);
+	return rc;
+}
+
+#define LLAPI_UNLINK_BATCH	1024
+
+struct remove_batch {
+	char	*rb_names[LLAPI_UNLINK_BATCH];
+	int	 rb_rcs[LLAPI_UNLINK_BATCH];
+	int	 rb_count;
+};
+
+static int remove_batch_flush(int dirfd, const char *path,
+			      struct remove_batch *rb)
+{
+	int sent;
+	int rc;
+	int i;
+
+	rc = sent = llapi_unlink_batch(dirfd, rb->rb_names, rb->rb_count,
+				       rb->rb_rcs);
+	if (sent < 0)
+		llapi_error(LLAPI_MSG_ERROR, sent,
+			    "cannot remove entries of '%s'", path);
+
+	for (i = 0; i < rb->rb_count; i++) {
+		if (sent == 0 && rb->rb_rcs[i] != 0 &&
+		    rb->rb_rcs[i] != -ENOENT) {
+			llapi_error(LLAPI_MSG_ERROR, rb->rb_rcs[i],
+				    "cannot remove '%s/%s'", path,
+				    rb->rb_names[i]);
+			if (rc == 0)
+				rc = rb->rb_rcs[i];
+		}
+		free(rb->rb_names[i]);
+	}
+	rb->rb_count = 0;
+	return rc;
+}
+
+static int remove_tree_dir(const char *path, int dirfd)
+{
+	struct remove_batch	*rb;
+	struct dirent		*ent;
+	struct stat		 st;
+	DIR			*dir;
+	int			 rc = 0;
+	int			 rc2;
+
+	dir = fdopendir(dirfd);
+	if (dir == NULL) {
+		rc = -errno;
+		close(dirfd);
+		return rc;
+	}
+
+	rb = malloc(sizeof(*rb));
+	if (rb == NULL) {
+		closedir(dir);
+		return -ENOMEM;
+	}
+	rb->rb_count = 0;
+
+	while ((ent = readdir(dir)) != NULL) {
+		if (strcmp(ent->d_name, ".") == 0 ||
+		    strcmp(ent->d_name, "..") == 0)
+			continue;
+
+		if (ent->d_type == DT_UNKNOWN &&
+		    fstatat(dirfd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+		    S_ISDIR(st.st_mode))
+			ent->d_type = DT_DIR;
+
+		/* empty subdirectories first, then unlink them with the rest */
+		if (ent->d_type == DT_DIR) {
+			char	subpath[PATH_MAX];
+			int	fd;
+
+			snprintf(subpath, sizeof(subpath), "%s/%s", path,
+				 ent->d_name);
+			fd = openat(dirfd, ent->d_name,
+				    O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+			if (fd < 0) {
+				rc2 = -errno;
+				llapi_error(LLAPI_MSG_ERROR, rc2,
+					    "cannot open '%s'", subpath);
+			} else {
+				rc2 = remove_tree_dir(subpath, fd);
+			}
+			if (rc2 < 0) {
+				if (rc == 0)
+					rc = rc2;
+				continue;
+			}
+		}
+
+		rb->rb_names[rb->rb_count] = strdup(ent->d_name);
+		if (rb->rb_names[rb->rb_count] == NULL) {
+			rc = -ENOMEM;
+			break;
+		}
+		if (++rb->rb_count == LLAPI_UNLINK_BATCH) {
+			rc2 = remove_batch_flush(dirfd, path, rb);
+			if (rc == 0)
+				rc = rc2;
+		}
+	}
+
+	rc2 = remove_batch_flush(dirfd, path, rb);
+	if (rc == 0)
+		rc = rc2;
+
+	free(rb);
+	closedir(dir);
+	return rc;
+}
+
+/*
+ * Remove \a path and, if it is a directory, everything below it, like
+ * "rm -rf" but unlinking the entries of each directory in batches with
+ * llapi_unlink_batch().
+ *
+ * \retval	0 on success.
+ * \retval	-errno of the first failure, after trying to remove the rest.
+ */
+int llapi_remove_tree(const char *path)
+{
+	struct stat	st;
+	int		fd;
+	int		rc;
+
+	if (lstat(path, &st) < 0)
+		return -errno;
+
+	if (!S_ISDIR(st.st_mode)) {
+		if (unlink(path) < 0)
+			return -errno;
+		return 0;
+	}
+
+	fd = open(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+	if (fd < 0)
+		return -errno;
+
+	rc = remove_tree_dir(path, fd);
+	if (rc < 0)
+		return rc;
+
+	if (rmdir(path) < 0)
+		return -errno;
+	return 0;
+}
+
 /*
  * Create a volatile file and open it for write:
  * - file is created as a standard file in the directory
@@ -452,6 +452,12 @@ static int enable_default_ext4_features(struct mkfs_opts *mop, char *anchor,
 		return EINVAL;
 	}
 
+	/* Allow a third htree level, for directories of tens of millions of
+	 * names, which would run out of index blocks with two levels. */
+	if (IS_MDT(&mop->mo_ldd) &&
+	    is_e2fsprogs_feature_supp("-O large_dir") == 0)
+		append_unique(anchor, ",", "large_dir", NULL, maxbuflen);
+
 	/* Allow files larger than 2TB.  Also needs LU-16, but not harmful. */
 	if (is_e2fsprogs_feature_supp("-O huge_file") == 0)
 		append_unique(anchor, ",", "huge_file", NULL, maxbuflen);
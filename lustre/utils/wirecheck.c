@@ -225,6 +225,19 @@ check_som_attrs(void)
 	CHECK_MEMBER(som_attrs, som_mountid);
 }
 
+static void
+check_lsom_attrs(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(lsom_attrs);
+	CHECK_MEMBER(lsom_attrs, lsa_flags);
+	CHECK_MEMBER(lsom_attrs, lsa_padding);
+	CHECK_MEMBER(lsom_attrs, lsa_size);
+	CHECK_MEMBER(lsom_attrs, lsa_blocks);
+	CHECK_MEMBER(lsom_attrs, lsa_time);
+	CHECK_VALUE_X(LSOM_FL_STALE);
+}
+
 static void
 check_hsm_attrs(void)
 {
@@ -285,6 +298,7 @@ check_lu_dirent(void)
 	CHECK_VALUE_X(LUDA_FID);
 	CHECK_VALUE_X(LUDA_TYPE);
 	CHECK_VALUE_X(LUDA_64BITHASH);
+	CHECK_VALUE_X(LUDA_ATTRS);
 }
 
 static void
@@ -295,6 +309,28 @@ check_luda_type(void)
 	CHECK_MEMBER(luda_type, lt_type);
 }
 
+static void
+check_luda_attrs(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(luda_attrs);
+	CHECK_MEMBER(luda_attrs, lda_cookie);
+	CHECK_MEMBER(luda_attrs, lda_valid);
+	CHECK_MEMBER(luda_attrs, lda_size);
+	CHECK_MEMBER(luda_attrs, lda_blocks);
+	CHECK_MEMBER(luda_attrs, lda_mtime);
+	CHECK_MEMBER(luda_attrs, lda_atime);
+	CHECK_MEMBER(luda_attrs, lda_ctime);
+	CHECK_MEMBER(luda_attrs, lda_mode);
+	CHECK_MEMBER(luda_attrs, lda_uid);
+	CHECK_MEMBER(luda_attrs, lda_gid);
+	CHECK_MEMBER(luda_attrs, lda_flags);
+	CHECK_MEMBER(luda_attrs, lda_nlink);
+	CHECK_MEMBER(luda_attrs, lda_rdev);
+	CHECK_MEMBER(luda_attrs, lda_lock_idx);
+	CHECK_MEMBER(luda_attrs, lda_lmm_size);
+}
+
 static void
 check_lu_dirpage(void)
 {
@@ -520,6 +556,14 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT_LIGHTWEIGHT);
 	CHECK_DEFINE_64X(OBD_CONNECT_SHORTIO);
 	CHECK_DEFINE_64X(OBD_CONNECT_PINGLESS);
+	CHECK_DEFINE_64X(OBD_CONNECT_READDIR_PLUS);
+	CHECK_DEFINE_64X(OBD_CONNECT_XATTR_ALL);
+	CHECK_DEFINE_64X(OBD_CONNECT_LAZY_SIZE);
+	CHECK_DEFINE_64X(OBD_CONNECT_GLIMPSE_BATCH);
+	CHECK_DEFINE_64X(OBD_CONNECT_UNLINK_BATCH);
+	CHECK_DEFINE_64X(OBD_CONNECT_DIR_STRIPE);
+	CHECK_DEFINE_64X(OBD_CONNECT_SYNC_BATCH);
+	CHECK_DEFINE_64X(OBD_CONNECT_FALLOCATE);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -602,11 +646,13 @@ check_obdo(void)
 	CHECK_DEFINE_64X(OBD_MD_FLCKSPLIT);
 	CHECK_DEFINE_64X(OBD_MD_FLCROSSREF);
 	CHECK_DEFINE_64X(OBD_MD_FLGETATTRLOCK);
+	CHECK_DEFINE_64X(OBD_MD_FLXATTRALL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTLSETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTLGETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTRSETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTRGETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLDATAVERSION);
+	CHECK_DEFINE_64X(OBD_MD_FLLAZYSIZE);
 
 	CHECK_CVALUE_X(OBD_FL_INLINEDATA);
 	CHECK_CVALUE_X(OBD_FL_OBDMDEXISTS);
@@ -629,6 +675,8 @@ check_obdo(void)
 	CHECK_CVALUE_X(OBD_FL_RECOV_RESEND);
 	CHECK_CVALUE_X(OBD_FL_NOSPC_BLK);
 	CHECK_CVALUE_X(OBD_FL_LOCAL_MASK);
+
+	CHECK_CDEFINE(OST_FALLOC_KEEP_SIZE);
 }
 
 static void
@@ -678,6 +726,7 @@ check_lov_mds_md_v3(void)
 	CHECK_VALUE_X(LOV_PATTERN_RAID1);
 	CHECK_VALUE_X(LOV_PATTERN_FIRST);
 	CHECK_VALUE_X(LOV_PATTERN_CMOBD);
+	CHECK_VALUE_X(LOV_PATTERN_MDT);
 }
 
 static void
@@ -695,7 +744,7 @@ check_obd_statfs(void)
 	CHECK_MEMBER(obd_statfs, os_namelen);
 	CHECK_MEMBER(obd_statfs, os_state);
 	CHECK_MEMBER(obd_statfs, os_fprecreated);
-	CHECK_MEMBER(obd_statfs, os_spare2);
+	CHECK_MEMBER(obd_statfs, os_req_rate);
 	CHECK_MEMBER(obd_statfs, os_spare3);
 	CHECK_MEMBER(obd_statfs, os_spare4);
 	CHECK_MEMBER(obd_statfs, os_spare5);
@@ -889,7 +938,7 @@ check_mdt_body(void)
 	CHECK_MEMBER(mdt_body, uid_h);
 	CHECK_MEMBER(mdt_body, gid_h);
 	CHECK_MEMBER(mdt_body, padding_5);
-	CHECK_MEMBER(mdt_body, padding_6);
+	CHECK_MEMBER(mdt_body, lazytime);
 	CHECK_MEMBER(mdt_body, padding_7);
 	CHECK_MEMBER(mdt_body, padding_8);
 	CHECK_MEMBER(mdt_body, padding_9);
@@ -932,6 +981,7 @@ check_mdt_body(void)
 	CHECK_DEFINE_X(MDS_INODELOCK_UPDATE);
 	CHECK_DEFINE_X(MDS_INODELOCK_OPEN);
 	CHECK_DEFINE_X(MDS_INODELOCK_LAYOUT);
+	CHECK_DEFINE_X(MDS_INODELOCK_DOM);
 }
 
 static void
@@ -1084,6 +1134,8 @@ check_mdt_rec_unlink(void)
 	CHECK_MEMBER(mdt_rec_unlink, ul_padding_7);
 	CHECK_MEMBER(mdt_rec_unlink, ul_padding_8);
 	CHECK_MEMBER(mdt_rec_unlink, ul_padding_9);
+	CHECK_CDEFINE(MDS_UNLINK_BATCH_MAX);
+	CHECK_CDEFINE(MDS_UNLINK_BATCH_SIZE);
 }
 
 static void
@@ -1350,6 +1402,34 @@ check_ldlm_ost_lvb(void)
 	CHECK_MEMBER(ost_lvb, lvb_padding);
 }
 
+static void
+check_ost_glimpse(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(ost_glimpse);
+	CHECK_MEMBER(ost_glimpse, og_oi);
+	CHECK_MEMBER(ost_glimpse, og_handle);
+	CHECK_MEMBER(ost_glimpse, og_lvb);
+	CHECK_MEMBER(ost_glimpse, og_rc);
+	CHECK_MEMBER(ost_glimpse, og_padding);
+	CHECK_CDEFINE(OST_GLIMPSE_BATCH_MAX);
+}
+
+static void
+check_ost_sync_rec(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(ost_sync_rec);
+	CHECK_MEMBER(ost_sync_rec, osr_oi);
+	CHECK_MEMBER(ost_sync_rec, osr_opc);
+	CHECK_MEMBER(ost_sync_rec, osr_count);
+	CHECK_MEMBER(ost_sync_rec, osr_uid);
+	CHECK_MEMBER(ost_sync_rec, osr_gid);
+	CHECK_MEMBER(ost_sync_rec, osr_rc);
+	CHECK_MEMBER(ost_sync_rec, osr_padding);
+	CHECK_CDEFINE(OST_SYNC_BATCH_MAX);
+}
+
 static void
 check_ldlm_lquota_lvb(void)
 {
@@ -2120,6 +2200,9 @@ main(int argc, char **argv)
 	CHECK_VALUE(OST_QUOTACHECK);
 	CHECK_VALUE(OST_QUOTACTL);
 	CHECK_VALUE(OST_QUOTA_ADJUST_QUNIT);
+	CHECK_VALUE(OST_GLIMPSE_BATCH);
+	CHECK_VALUE(OST_SYNC_BATCH);
+	CHECK_VALUE(OST_FALLOCATE);
 	CHECK_VALUE(OST_LAST_OPC);
 
 	CHECK_DEFINE_64X(OBD_OBJECT_EOF);
@@ -2170,6 +2253,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(REINT_OPEN);
 	CHECK_VALUE(REINT_SETXATTR);
 	CHECK_VALUE(REINT_RMENTRY);
+	CHECK_VALUE(REINT_UNLINK_BATCH);
 	CHECK_VALUE(REINT_MAX);
 
 	CHECK_VALUE_X(DISP_IT_EXECD);
@@ -2312,10 +2396,12 @@ main(int argc, char **argv)
 	CHECK_VALUE(OBJ_INDEX_DELETE);
 
 	check_som_attrs();
+	check_lsom_attrs();
 	check_hsm_attrs();
 	check_ost_id();
 	check_lu_dirent();
 	check_luda_type();
+	check_luda_attrs();
 	check_lu_dirpage();
 	check_lustre_handle();
 	check_lustre_msg_v2();
@@ -2356,6 +2442,8 @@ main(int argc, char **argv)
 	check_ldlm_reply();
 	check_ldlm_ost_lvb_v1();
 	check_ldlm_ost_lvb();
+	check_ost_glimpse();
+	check_ost_sync_rec();
 	check_ldlm_lquota_lvb();
 	check_ldlm_gl_lquota_desc();
 	check_mgs_send_param();